@@ -0,0 +1,450 @@
+/**
+ Program for checking (and optionally dumping) a large number of EMF, EMF+, and WMF files in one run.
+ The files are distributed over a pool of worker threads.  Each thread owns a queue of files and when
+ that runs dry it steals half of the remaining files from another thread's queue, so that a few very
+ large files do not leave the other threads idle.
+
+ Every record of every file is checked with U_emf_record_safe() or U_WMRRECSAFE_get(), and the EMF+
+ records inside EMF comments are walked.  Optionally each file is also converted to the other byte
+ order and back (as would happen when reading or writing it on a Big Endian machine) and the result
+ compared with the original.
+
+ Run like:
+    batchmeta [-t threads] [-e] [-d] [-q] [-l listfile] file1 file2 ... fileN
+
+       -t N         Use N worker threads.  Default is the number of processors.
+       -e           Also check that byte order conversion of each file round trips.
+       -d           Also dump each file, as reademf/readwmf would.  The print functions write to stdout,
+                    so dumps are serialized, one whole file at a time.  Checking is still parallel.
+       -q           Only report files which fail.
+       -l listfile  Read file names, one per line, from listfile ("-" for stdin), in addition to any
+                    given on the command line.
+
+ Writes one line per file with its status, type, size, record counts, and throughput, followed by a
+ summary.  The exit status is 0 if all files passed, 1 if any failed, and 2 on a usage or system error.
+
+ Build with:  gcc -Wall -std=c99 -pthread -o batchmeta batchmeta.c uemf.c uwmf.c uemf_print.c uwmf_print.c
+              upmf.c upmf_print.c uemf_endian.c uwmf_endian.c uemf_safe.c uemf_utf.c -lm
+*/
+
+/*
+File:      batchmeta.c
+Version:   0.0.1
+Date:      17-OCT-2026
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h> /* for offsetof() */
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "upmf_print.h" /* includes upmf.h and uemf.h */
+#include "uemf_print.h"
+#include "uemf_safe.h"
+#include "uemf_endian.h"
+#include "uwmf.h"
+#include "uwmf_print.h"
+#include "uwmf_endian.h"
+
+#define BM_UNKNOWN  0
+#define BM_EMF      1
+#define BM_EMFPLUS  2
+#define BM_WMF      3
+
+/* Result for one file */
+typedef struct {
+   const char *name;
+   int         kind;      /* BM_* */
+   const char *error;     /* NULL if the file passed */
+   size_t      bytes;
+   uint32_t    records;   /* EMF or WMF records */
+   uint32_t    precords;  /* EMF+ records */
+   double      seconds;
+} BM_RESULT;
+
+/* One thread's share of the files, indices [head,tail) into the file list */
+typedef struct {
+   pthread_mutex_t lock;
+   size_t          head;
+   size_t          tail;
+} BM_QUEUE;
+
+/* Everything shared by the workers */
+typedef struct {
+   BM_RESULT      *results;
+   BM_QUEUE       *queues;
+   int             nthreads;
+   int             endian;
+   int             dump;
+   pthread_mutex_t dumplock;
+} BM_POOL;
+
+/* Argument for one worker */
+typedef struct {
+   BM_POOL        *pool;
+   int             id;
+} BM_WORKER;
+
+static double now(void){
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec);
+}
+
+static uint32_t le32(const unsigned char *p){
+   return((uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24));
+}
+
+static uint16_t le16(const unsigned char *p){
+   return((uint16_t)(p[0] | (p[1] << 8)));
+}
+
+/*
+  Determine the file type from the first bytes of the file, which are always Little Endian.  This must be
+  known before the file is loaded, since on a Big Endian machine loading it also converts the byte order.
+*/
+static int sniff(const char *name){
+   unsigned char buf[44];
+   size_t        n;
+   FILE         *fp = fopen(name, "rb");
+   if(!fp)return(BM_UNKNOWN);
+   n = fread(buf, 1, sizeof(buf), fp);
+   fclose(fp);
+   if(n >= 44 && le32(buf) == U_EMR_HEADER && le32(buf + offsetof(U_EMRHEADER, dSignature)) == U_ENHMETA_SIGNATURE)return(BM_EMF);
+   if(n >= 4  && le32(buf) == 0x9AC6CDD7)return(BM_WMF);  /* placeable WMF */
+   if(n >= 6  && (le16(buf) == 1 || le16(buf) == 2) && le16(buf + 2) == U_SIZE_WMRHEADER/2 &&
+      (le16(buf + 4) == U_METAVERSION100 || le16(buf + 4) == U_METAVERSION300))return(BM_WMF);
+   return(BM_UNKNOWN);
+}
+
+/* Walk the EMF+ records in an EMF comment.  Returns NULL or a description of the problem. */
+static const char *check_emfplus(const char *record, uint32_t nSize, BM_RESULT *res){
+   PU_EMRCOMMENT_EMFPLUS pEmr = (PU_EMRCOMMENT_EMFPLUS) record;
+   const char   *blimit;
+   const char   *prec;
+   const char   *contents;
+   U_PMF_CMN_HDR Header;
+
+   /* The EMF+ records end at cbData, any padding after that up to nSize is not part of them, as in U_EMRCOMMENT_print() */
+   if(pEmr->cbData > nSize - sizeof(U_EMR) - sizeof(U_CBDATA))return("bad EMF+ comment size");
+   blimit = record + sizeof(U_EMR) + sizeof(U_CBDATA) + pEmr->cbData;
+   res->kind = BM_EMFPLUS;
+   prec = (const char *) &(pEmr->Data);
+   while(prec < blimit){
+      contents = prec;
+      if(IS_MEM_UNSAFE(prec, sizeof(U_PMF_CMN_HDR), blimit))return("truncated EMF+ record");
+      if(!U_PMF_CMN_HDR_get(&contents, &Header))return("bad EMF+ record header");
+      if(Header.Size < sizeof(U_PMF_CMN_HDR) || IS_MEM_UNSAFE(prec, Header.Size, blimit))return("bad EMF+ record size");
+      if((Header.Type & U_PMR_TYPE_MASK) < U_PMR_MIN || (Header.Type & U_PMR_TYPE_MASK) > U_PMR_MAX)return("unknown EMF+ record type");
+      res->precords++;
+      prec += Header.Size;
+   }
+   return(NULL);
+}
+
+/* Check every record in an EMF in memory.  Returns NULL or a description of the problem. */
+static const char *check_emf(const char *contents, size_t length, BM_RESULT *res){
+   const char *blimit = contents + length;
+   const char *record = contents;
+   const char *error;
+   uint32_t    nSize, iType, cIdent;
+
+   while(1){
+      if(!U_emf_record_sizeok(record, blimit, &nSize, &iType, 1))return("bad record size");
+      if(!res->records && iType != U_EMR_HEADER)return("does not begin with EMR_HEADER");
+      if(!U_emf_record_safe(record))return("unsafe record");
+      res->records++;
+      if(iType == U_EMR_EOF)break;
+      if(iType == U_EMR_COMMENT && nSize >= sizeof(U_EMRCOMMENT_EMFPLUS) - 1){
+         cIdent = le32((const unsigned char *) record + offsetof(U_EMRCOMMENT_EMFPLUS, cIdent));  /* comment payloads are never swapped */
+         if(cIdent == U_EMR_COMMENT_EMFPLUSRECORD && (error = check_emfplus(record, nSize, res)))return(error);
+      }
+      record += nSize;
+   }
+   return(NULL);
+}
+
+/* Check every record in a WMF in memory.  Returns NULL or a description of the problem. */
+static const char *check_wmf(const char *contents, size_t length, BM_RESULT *res){
+   const char    *blimit = contents + length;
+   size_t         off, size;
+   U_WMRPLACEABLE Placeable;
+   U_WMRHEADER    Header;
+
+   off = wmfheader_get(contents, blimit, &Placeable, &Header);
+   if(!off)return("bad WMF header");
+   while(1){
+      if(off >= length)return("no U_WMR_EOF record");
+      size = U_WMRRECSAFE_get(contents + off, blimit);
+      if(!size)return("bad record size");
+      res->records++;
+      if(*(uint8_t *)(contents + off + offsetof(U_METARECORD, iType)) == U_WMR_EOF)break;
+      off += size;
+   }
+   return(NULL);
+}
+
+/* Convert to the other byte order and back, the data must not change.  Returns NULL or a description of the problem. */
+static const char *check_endian(char *contents, size_t length, int kind){
+   uint32_t crc = lu_crc32(contents, (uint32_t) length);
+   if(kind == BM_WMF){
+      if(!U_wmf_endian(contents, length, 1, 0) || !U_wmf_endian(contents, length, 0, 0))return("byte order conversion failed");
+   }
+   else {
+      if(!U_emf_endian(contents, length, 1) || !U_emf_endian(contents, length, 0))return("byte order conversion failed");
+   }
+   if(crc != lu_crc32(contents, (uint32_t) length))return("byte order conversion does not round trip");
+   return(NULL);
+}
+
+/* Print the whole file as reademf/readwmf would.  Called with dumplock held. */
+static void dump(const char *name, const char *contents, size_t length, int kind){
+   const char     *blimit = contents + length;
+   size_t          off = 0;
+   int             recnum = 0;
+   int             result;
+   U_PMF_PARSE_CTX ctx;
+
+   printf("==== %s\n", name);
+   if(kind == BM_WMF){
+      off = wmfheader_print(contents, blimit);
+      while(off && off < length && (result = U_wmf_onerec_print(contents, blimit, recnum, off)) > 0){
+         off += result;
+         recnum++;
+      }
+   }
+   else {
+      (void) U_PCTX_init(&ctx);
+      while(off < length && (result = U_emf_onerec_print_r(&ctx, contents, blimit, recnum, off)) > 0){
+         off += result;
+         recnum++;
+      }
+      (void) U_PCTX_release(&ctx);
+   }
+   fflush(stdout);
+}
+
+/* Check (and maybe dump) one file */
+static void process(BM_POOL *pool, BM_RESULT *res){
+   char   *contents = NULL;
+   size_t  length   = 0;
+   int     status;
+   double  start    = now();
+
+   res->kind = sniff(res->name);
+   if(res->kind == BM_UNKNOWN){
+      res->error = "not an EMF or WMF file";
+   }
+   else {
+      /* The byte order check modifies the data so it needs a private copy, otherwise map the file */
+      if(res->kind == BM_WMF){ status = pool->endian ? wmf_readdata(res->name, &contents, &length) : wmf_mapdata(res->name, &contents, &length); }
+      else {                   status = pool->endian ? emf_readdata(res->name, &contents, &length) : emf_mapdata(res->name, &contents, &length); }
+      if(status){
+         res->error = "could not read file";
+         contents = NULL;
+      }
+      else {
+         res->bytes = length;
+         res->error = (res->kind == BM_WMF ? check_wmf(contents, length, res) : check_emf(contents, length, res));
+         if(!res->error && pool->endian)res->error = check_endian(contents, length, res->kind);
+         if(pool->dump){
+            pthread_mutex_lock(&pool->dumplock);
+            dump(res->name, contents, length, res->kind);
+            pthread_mutex_unlock(&pool->dumplock);
+         }
+         if(pool->endian){ free(contents); }
+         else {            (void) emf_unmapdata(contents, length); }
+      }
+   }
+   res->seconds = now() - start;
+}
+
+/* Take the next file from the front of a queue.  Returns 1 and sets *idx, or 0 if the queue is empty. */
+static int queue_pop(BM_QUEUE *q, size_t *idx){
+   int found = 0;
+   pthread_mutex_lock(&q->lock);
+   if(q->head < q->tail){
+      *idx  = q->head++;
+      found = 1;
+   }
+   pthread_mutex_unlock(&q->lock);
+   return(found);
+}
+
+/*
+  Move half of the files left in some other queue (from its back end) into this worker's (empty) queue.
+  Returns 1 if any were moved, 0 if every queue is empty, in which case all work has been handed out.
+*/
+static int queue_steal(BM_POOL *pool, int self){
+   BM_QUEUE *mine = &pool->queues[self];
+   BM_QUEUE *victim;
+   size_t    n, head, tail;
+   int       i;
+
+   for(i = 1; i < pool->nthreads; i++){
+      victim = &pool->queues[(self + i) % pool->nthreads];
+      pthread_mutex_lock(&victim->lock);
+      n = victim->tail - victim->head;
+      n = (n + 1)/2;
+      tail = victim->tail;
+      victim->tail -= n;
+      head = victim->tail;
+      pthread_mutex_unlock(&victim->lock);
+      if(n){
+         pthread_mutex_lock(&mine->lock);
+         mine->head = head;
+         mine->tail = tail;
+         pthread_mutex_unlock(&mine->lock);
+         return(1);
+      }
+   }
+   return(0);
+}
+
+static void *worker(void *arg){
+   BM_WORKER *w    = (BM_WORKER *) arg;
+   BM_POOL   *pool = w->pool;
+   size_t     idx;
+
+   while(1){
+      if(queue_pop(&pool->queues[w->id], &idx)){
+         process(pool, &pool->results[idx]);
+      }
+      else if(!queue_steal(pool, w->id)){
+         break;
+      }
+   }
+   return(NULL);
+}
+
+/* Append a file name to the list, growing it as needed.  Returns 0 on success. */
+static int add_name(char ***names, size_t *count, size_t *space, const char *name){
+   char **tmp;
+   if(*count == *space){
+      *space = (*space ? 2 * *space : 1024);
+      tmp = (char **) realloc(*names, *space * sizeof(char *));
+      if(!tmp)return(1);
+      *names = tmp;
+   }
+   (*names)[*count] = malloc(strlen(name) + 1);
+   if(!(*names)[*count])return(1);
+   strcpy((*names)[*count], name);
+   (*count)++;
+   return(0);
+}
+
+/* Read file names, one per line, into the list.  Returns 0 on success. */
+static int read_list(char ***names, size_t *count, size_t *space, const char *listfile){
+   char   line[4096];
+   size_t len;
+   FILE  *fp = (strcmp(listfile, "-") ? fopen(listfile, "r") : stdin);
+   if(!fp)return(1);
+   while(fgets(line, sizeof(line), fp)){
+      len = strlen(line);
+      while(len && (line[len-1] == '\n' || line[len-1] == '\r'))line[--len] = '\0';
+      if(len && add_name(names, count, space, line))return(1);
+   }
+   if(fp != stdin)fclose(fp);
+   return(0);
+}
+
+static void usage(void){
+   fprintf(stderr, "Usage: batchmeta [-t threads] [-e] [-d] [-q] [-l listfile] file1 ... fileN\n");
+   exit(2);
+}
+
+int main(int argc, char *argv[]){
+   static const char *kinds[] = { "?", "EMF", "EMF+", "WMF" };
+   BM_POOL    pool;
+   BM_WORKER *workers;
+   pthread_t *threads;
+   BM_RESULT *res;
+   char     **names = NULL;
+   size_t     count = 0, space = 0, i, per, bytes = 0, failed = 0;
+   int        quiet = 0, t, argi;
+   long       ncpu;
+   double     start, elapsed;
+
+   memset(&pool, 0, sizeof(pool));
+   ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+   pool.nthreads = (ncpu > 0 ? (int) ncpu : 1);
+   for(argi = 1; argi < argc && argv[argi][0] == '-' && argv[argi][1]; argi++){
+      if(     !strcmp(argv[argi], "-t") && argi + 1 < argc){ pool.nthreads = atoi(argv[++argi]);  }
+      else if(!strcmp(argv[argi], "-l") && argi + 1 < argc){
+         if(read_list(&names, &count, &space, argv[++argi])){
+            fprintf(stderr, "batchmeta: fatal error: could not read list file %s\n", argv[argi]);
+            exit(2);
+         }
+      }
+      else if(!strcmp(argv[argi], "-e")){ pool.endian = 1; }
+      else if(!strcmp(argv[argi], "-d")){ pool.dump   = 1; }
+      else if(!strcmp(argv[argi], "-q")){ quiet       = 1; }
+      else { usage(); }
+   }
+   for(; argi < argc; argi++){
+      if(add_name(&names, &count, &space, argv[argi])){
+         fprintf(stderr, "batchmeta: fatal error: out of memory\n");
+         exit(2);
+      }
+   }
+   if(!count || pool.nthreads < 1)usage();
+   if((size_t) pool.nthreads > count)pool.nthreads = (int) count;
+
+   pool.results = (BM_RESULT *) calloc(count, sizeof(BM_RESULT));
+   pool.queues  = (BM_QUEUE *)  calloc(pool.nthreads, sizeof(BM_QUEUE));
+   workers      = (BM_WORKER *) calloc(pool.nthreads, sizeof(BM_WORKER));
+   threads      = (pthread_t *) calloc(pool.nthreads, sizeof(pthread_t));
+   if(!pool.results || !pool.queues || !workers || !threads){
+      fprintf(stderr, "batchmeta: fatal error: out of memory\n");
+      exit(2);
+   }
+   for(i = 0; i < count; i++){ pool.results[i].name = names[i]; }
+
+   /* Start each thread with an equal contiguous block, stealing evens out the load */
+   per = count / pool.nthreads;
+   pthread_mutex_init(&pool.dumplock, NULL);
+   for(t = 0; t < pool.nthreads; t++){
+      pthread_mutex_init(&pool.queues[t].lock, NULL);
+      pool.queues[t].head = t * per;
+      pool.queues[t].tail = (t == pool.nthreads - 1 ? count : (t + 1) * per);
+   }
+
+   start = now();
+   for(t = 0; t < pool.nthreads; t++){
+      workers[t].pool = &pool;
+      workers[t].id   = t;
+      if(pthread_create(&threads[t], NULL, worker, &workers[t])){
+         fprintf(stderr, "batchmeta: fatal error: could not start thread %d\n", t);
+         exit(2);
+      }
+   }
+   for(t = 0; t < pool.nthreads; t++){ pthread_join(threads[t], NULL); }
+   elapsed = now() - start;
+
+   for(i = 0; i < count; i++){
+      res = &pool.results[i];
+      bytes += res->bytes;
+      if(res->error)failed++;
+      if(quiet && !res->error)continue;
+      printf("%-4s %-4s bytes:%10lu records:%8u emf+:%8u MB/s:%9.2f %s%s%s\n",
+         (res->error ? "FAIL" : "OK"), kinds[res->kind], (unsigned long) res->bytes, res->records, res->precords,
+         (res->seconds > 0 ? (double) res->bytes / res->seconds / 1.0e6 : 0.0), res->name,
+         (res->error ? "  " : ""), (res->error ? res->error : ""));
+   }
+   printf("batchmeta: files:%lu failed:%lu bytes:%lu threads:%d seconds:%.3f files/s:%.1f MB/s:%.2f\n",
+      (unsigned long) count, (unsigned long) failed, (unsigned long) bytes, pool.nthreads, elapsed,
+      (elapsed > 0 ? (double) count / elapsed : 0.0), (elapsed > 0 ? (double) bytes / elapsed / 1.0e6 : 0.0));
+
+   for(t = 0; t < pool.nthreads; t++){ pthread_mutex_destroy(&pool.queues[t].lock); }
+   pthread_mutex_destroy(&pool.dumplock);
+   for(i = 0; i < count; i++){ free(names[i]); }
+   free(names);
+   free(pool.results);
+   free(pool.queues);
+   free(workers);
+   free(threads);
+   exit(failed ? 1 : 0);
+}
@@ -0,0 +1,237 @@
+/**
+ Micro-benchmark for the pixel conversions DIB_to_RGBA() and RGBA_to_DIB(), which are used for every bitmap
+ record that is drawn or created.  For each DIB format it checks that a round trip through the conversions
+ gives back the original pixels (except for 1 bit, where RGBA_to_DIB() packs the pixels of each byte in the
+ opposite order from DIB_to_RGBA()) and reports the throughput of each direction.  For the formats with a color
+ table it then times RGBA_to_DIB() against a reference which finds each color with a linear search, as the code
+ did before the color lookup was hashed, and checks that both build the same table.  The reference only builds
+ the table and an index per pixel, it does not pack the DIB, so where there are few colors it is the faster.  Finally it converts a smooth
+ gradient, which has far too many colors for any table, with U_CT_QUANTIZE and checks that every pixel comes back
+ from DIB_to_RGBA() quantized as documented, with no channel off by more than half of the dropped range.
+
+ Run like:
+    bench_dib [width [height [repeats]]]
+
+ Defaults are a 1024 x 1024 image (use an even width for the 4 bit check) converted 20 times.  To time the per pixel reference implementation
+ build uemf.c with -DU_DIB_REFERENCE.
+
+ Build with:  gcc -Wall -std=c99 -O2 -o bench_dib bench_dib.c uemf.c uemf_endian.c uemf_utf.c uemf_safe.c -lm
+*/
+
+/*
+File:      bench_dib.c
+Version:   0.0.1
+Date:      17-OCT-2026
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "uemf.h"
+
+static double now(void){
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec);
+}
+
+/* A smooth gradient, which has a different color at nearly every pixel */
+static void make_gradient(char *rgba, int w, int h){
+   int       i, j;
+   uint8_t  *p = (uint8_t *) rgba;
+   for(i = 0; i < h; i++){
+      for(j = 0; j < w; j++, p += 4){
+         p[0] = (255 * j) / (w > 1 ? w - 1 : 1);
+         p[1] = (255 * i) / (h > 1 ? h - 1 : 1);
+         p[2] = (255 * (i + j)) / (w + h > 2 ? w + h - 2 : 1);
+         p[3] = 0;
+      }
+   }
+}
+
+/* The color table lookup as it was before it was hashed: a linear search of the colors found so far, in
+   first seen order, with the rows taken last to first as RGBA_to_DIB() does when inverting.  Builds the table 
+   and one index per pixel.  Returns the number of colors, -1 if too many. */
+static int ref_colortable(const char *rgba, int w, int h, U_RGBQUAD *ct, int numCt, uint8_t *index){
+   const uint8_t *p;
+   U_RGBQUAD      color;
+   int            found = 0, i, j, k;
+   for(i = h - 1; i >= 0; i--){
+      p = (const uint8_t *) rgba + 4 * (size_t) w * i;
+      for(j = 0; j < w; j++, p += 4){
+         color = U_BGRA(p[0], p[1], p[2], p[3]);
+         for(k = 0; k < found; k++){ if(!memcmp(&ct[k], &color, sizeof(U_RGBQUAD)))break; }
+         if(k == found){
+            if(found == numCt)return(-1);
+            ct[found++] = color;
+         }
+         *index++ = k;
+      }
+   }
+   return(found);
+}
+
+/* The bits dropped from each channel if back is rgba quantized by U_CT_QUANTIZE, else -1 */
+static int quantized_by(const char *rgba, const char *back, int w, int h){
+   const uint8_t *p, *q;
+   uint8_t        mask, mid;
+   size_t         i;
+   int            drop;
+   for(drop = 0; drop <= 8; drop++){
+      mask = (drop == 8 ? 0 : (uint8_t)(0xFF << drop));
+      mid  = (drop ? (uint8_t)(1 << (drop - 1)) : 0);
+      p    = (const uint8_t *) rgba;
+      q    = (const uint8_t *) back;
+      for(i = 0; i < 4 * (size_t) w * h; i++){
+         if(q[i] != ((p[i] & mask) | mid))break;
+      }
+      if(i == 4 * (size_t) w * h)return(drop);
+   }
+   return(-1);
+}
+
+/* Largest difference in any channel of any pixel */
+static int max_error(const char *rgba, const char *back, int w, int h){
+   const uint8_t *p = (const uint8_t *) rgba, *q = (const uint8_t *) back;
+   size_t         i;
+   int            d, worst = 0;
+   for(i = 0; i < 4 * (size_t) w * h; i++){
+      d = (p[i] > q[i] ? p[i] - q[i] : q[i] - p[i]);
+      if(d > worst)worst = d;
+   }
+   return(worst);
+}
+
+/* An RGBA image whose colors all survive the conversion to colortype and back. */
+static void make_rgba(char *rgba, int w, int h, uint32_t colortype){
+   uint32_t  seed = 12345;
+   int       i, ncolors = (colortype < U_BCBM_COLOR16 ? 1 << colortype : 0);
+   uint8_t  *p = (uint8_t *) rgba;
+   for(i = 0; i < w*h; i++, p += 4){
+      seed = seed * 1103515245U + 12345U;
+      if(ncolors){    seed %= ncolors; p[0] = seed; p[1] = 255 - seed; p[2] = seed * 7; p[3] = 0; }
+      else {          memcpy(p, &seed, 4); }
+      if(colortype == U_BCBM_COLOR16){ p[0] &= 0xF8; p[1] &= 0xF8; p[2] &= 0xF8; }
+      if(colortype <= U_BCBM_COLOR24){ p[3] = 0; }
+   }
+}
+
+int main(int argc, char *argv[]){
+   static const uint32_t types[] = { U_BCBM_MONOCHROME, U_BCBM_COLOR4, U_BCBM_COLOR8,
+                                     U_BCBM_COLOR16, U_BCBM_COLOR24, U_BCBM_COLOR32 };
+   int          w = 1024, h = 1024, reps = 20, r, use_ct;
+   unsigned int t;
+   char        *rgba, *back, *px;
+   PU_RGBQUAD   ct;
+   int          numCt;
+   uint32_t     cbPx;
+   double       start, to_dib, to_rgba, mpx;
+   U_RGBQUAD   *ref_ct;
+   uint8_t     *index;
+   int          found = 0, drop, err;
+
+   if(argc > 1)w    = atoi(argv[1]);
+   if(argc > 2)h    = atoi(argv[2]);
+   if(argc > 3)reps = atoi(argv[3]);
+   if(w <= 0 || h <= 0 || reps <= 0){
+      printf("bench_dib: width, height, and repeats must be positive\n");
+      exit(EXIT_FAILURE);
+   }
+   rgba = malloc(4 * (size_t) w * h);
+   if(!rgba)exit(EXIT_FAILURE);
+   mpx = (double) w * h * reps / 1.0e6;
+   printf("%6s %18s %18s\n", "bits", "RGBA_to_DIB Mpx/s", "DIB_to_RGBA Mpx/s");
+   for(t = 0; t < sizeof(types)/sizeof(types[0]); t++){
+      use_ct = (types[t] < U_BCBM_COLOR16 ? U_CT_BGRA : U_CT_NO);
+      make_rgba(rgba, w, h, types[t]);
+
+      start = now();
+      for(r = 0; r < reps; r++){
+         if(RGBA_to_DIB(&px, &cbPx, &ct, &numCt, rgba, w, h, 4*w, types[t], use_ct, 1))exit(EXIT_FAILURE);
+         if(r < reps - 1){ free(px); free(ct); }
+      }
+      to_dib = now() - start;
+
+      start = now();
+      for(r = 0; r < reps; r++){
+         if(DIB_to_RGBA(px, ct, numCt, &back, w, h, types[t], (use_ct ? numCt : 0), 1))exit(EXIT_FAILURE);
+         if(r < reps - 1)free(back);
+      }
+      to_rgba = now() - start;
+
+      if(types[t] != U_BCBM_MONOCHROME && memcmp(rgba, back, 4 * (size_t) w * h)){
+         printf("bench_dib: FAILED, %u bit round trip changed the image\n", types[t]);
+         exit(EXIT_FAILURE);
+      }
+      printf("%6u %18.0f %18.0f\n", types[t], mpx / to_dib, mpx / to_rgba);
+      free(back);
+      free(px);
+      free(ct);
+   }
+
+   /* The color table lookup, with every color of the table in use */
+   index  = malloc((size_t) w * h);
+   ref_ct = malloc(256 * sizeof(U_RGBQUAD));
+   if(!index || !ref_ct)exit(EXIT_FAILURE);
+   printf("\n%6s %8s %18s %18s\n", "bits", "colors", "RGBA_to_DIB Mpx/s", "linear only Mpx/s");
+   for(t = 0; t < 3; t++){
+      make_rgba(rgba, w, h, types[t]);
+      start = now();
+      for(r = 0; r < reps; r++){
+         if(RGBA_to_DIB(&px, &cbPx, &ct, &numCt, rgba, w, h, 4*w, types[t], U_CT_BGRA, 1))exit(EXIT_FAILURE);
+         if(r < reps - 1){ free(px); free(ct); }
+      }
+      to_dib = now() - start;
+      start = now();
+      for(r = 0; r < reps; r++){
+         found = ref_colortable(rgba, w, h, ref_ct, 1 << types[t], index);
+      }
+      to_rgba = now() - start;
+      if(found < 0 || found > numCt || memcmp(ct, ref_ct, found * sizeof(U_RGBQUAD))){
+         printf("bench_dib: FAILED, %u bit color table differs from the linear search\n", types[t]);
+         exit(EXIT_FAILURE);
+      }
+      printf("%6u %8d %18.0f %18.0f\n", types[t], found, mpx / to_dib, mpx / to_rgba);
+      free(px);
+      free(ct);
+   }
+
+   /* Too many colors, U_CT_BGRA must fail and U_CT_QUANTIZE must reduce them */
+   make_gradient(rgba, w, h);
+   printf("\n%6s %8s %8s %10s %18s\n", "bits", "colors", "dropped", "max error", "QUANTIZE Mpx/s");
+   for(t = 0; t < 3; t++){
+      if(w*h > (1 << types[t]) && RGBA_to_DIB(&px, &cbPx, &ct, &numCt, rgba, w, h, 4*w, types[t], U_CT_BGRA, 1) != 6){
+         printf("bench_dib: FAILED, %u bit U_CT_BGRA accepted a gradient with too many colors\n", types[t]);
+         exit(EXIT_FAILURE);
+      }
+      start = now();
+      for(r = 0; r < reps; r++){
+         if(RGBA_to_DIB(&px, &cbPx, &ct, &numCt, rgba, w, h, 4*w, types[t], U_CT_QUANTIZE, 1))exit(EXIT_FAILURE);
+         if(r < reps - 1){ free(px); free(ct); }
+      }
+      to_dib = now() - start;
+      if(DIB_to_RGBA(px, ct, numCt, &back, w, h, types[t], numCt, 1))exit(EXIT_FAILURE);
+      if(types[t] == U_BCBM_MONOCHROME){  // pixel order within each byte differs, see above
+         printf("%6u %8d %8s %10s %18.0f\n", types[t], numCt, "-", "-", mpx / to_dib);
+      }
+      else {
+         drop = quantized_by(rgba, back, w, h);
+         err  = max_error(rgba, back, w, h);
+         if(drop < 0 || err > (drop ? 1 << (drop - 1) : 0)){
+            printf("bench_dib: FAILED, %u bit U_CT_QUANTIZE round trip is not within tolerance\n", types[t]);
+            exit(EXIT_FAILURE);
+         }
+         printf("%6u %8d %8d %10d %18.0f\n", types[t], numCt, drop, err, mpx / to_dib);
+      }
+      free(back);
+      free(px);
+      free(ct);
+   }
+   free(index);
+   free(ref_ct);
+   free(rgba);
+   exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,111 @@
+/**
+ Micro-benchmark for building EMF+ paths, which for drawings with long polylines is where most of the time
+ goes when writing EMF+.  For several path lengths it builds the same path point by point with U_PATH_moveto()
+ and U_PATH_lineto(), in blocks with U_PATH_polylineto(), and all at once with U_PATH_append(), checks that the
+ three give identical points and types, and reports the rate of each.
+
+ Run like:
+    bench_path [points]
+
+ points is the length of the longest path, default 1000000.
+
+ Build with:  gcc -Wall -std=c99 -O2 -o bench_path bench_path.c upmf.c uemf.c uemf_endian.c uemf_utf.c uemf_safe.c -lm
+*/
+
+/*
+File:      bench_path.c
+Version:   0.0.1
+Date:      17-OCT-2026
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "upmf.h"
+
+#define BLOCK 64  /* points per U_PATH_polylineto() call */
+
+static double now(void){
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec);
+}
+
+/* One point at a time */
+static U_DPSEUDO_OBJ *by_point(const U_PMF_POINTF *pts, uint32_t count){
+   U_DPSEUDO_OBJ *path = U_PATH_create(0, NULL, 0, 0);
+   uint32_t       i;
+   if(!path || !U_PATH_moveto(path, pts[0], U_PTP_None))exit(EXIT_FAILURE);
+   for(i = 1; i < count; i++){
+      if(!U_PATH_lineto(path, pts[i], U_PTP_None))exit(EXIT_FAILURE);
+   }
+   return(path);
+}
+
+/* BLOCK points at a time */
+static U_DPSEUDO_OBJ *by_block(const U_PMF_POINTF *pts, uint32_t count){
+   U_DPSEUDO_OBJ *path = U_PATH_create(0, NULL, 0, 0);
+   uint32_t       i, n;
+   if(!path)exit(EXIT_FAILURE);
+   for(i = 0; i < count; i += n){
+      n = (count - i < BLOCK ? count - i : BLOCK);
+      if(!U_PATH_polylineto(path, n, pts + i, U_PTP_None, (i ? U_SEG_OLD : U_SEG_NEW)))exit(EXIT_FAILURE);
+   }
+   return(path);
+}
+
+/* All at once */
+static U_DPSEUDO_OBJ *by_append(const U_PMF_POINTF *pts, const uint8_t *types, uint32_t count){
+   U_DPSEUDO_OBJ *path = U_PATH_create(0, NULL, 0, 0);
+   if(!path || !U_PATH_append(path, count, pts, types))exit(EXIT_FAILURE);
+   return(path);
+}
+
+static int same(const U_DPSEUDO_OBJ *a, const U_DPSEUDO_OBJ *b){
+   return(a->Elements == b->Elements &&
+      a->poPoints->Used == b->poPoints->Used && !memcmp(a->poPoints->Data, b->poPoints->Data, a->poPoints->Used) &&
+      a->poTypes->Used  == b->poTypes->Used  && !memcmp(a->poTypes->Data,  b->poTypes->Data,  a->poTypes->Used));
+}
+
+int main(int argc, char *argv[]){
+   uint32_t       max = 1000000, count, i;
+   U_PMF_POINTF  *pts;
+   uint8_t       *types;
+   U_DPSEUDO_OBJ *p1, *p2, *p3;
+   double         t0, t1, t2, t3;
+
+   if(argc > 1)max = atoi(argv[1]);
+   if(max < 2)max = 2;
+   pts   = malloc(max * sizeof(U_PMF_POINTF));
+   types = malloc(max);
+   if(!pts || !types)exit(EXIT_FAILURE);
+   for(i = 0; i < max; i++){
+      pts[i].X = (float)(i % 1000) * 0.5f;
+      pts[i].Y = (float)(i / 1000) * 0.25f;
+      types[i] = (i ? U_PPT_Line : U_PPT_Start);
+   }
+   printf("%10s %16s %16s %16s\n", "points", "lineto Mpt/s", "polyline Mpt/s", "append Mpt/s");
+   for(count = 1000; ; count *= 10){
+      if(count > max)count = max;
+      t0 = now(); p1 = by_point(pts, count);
+      t1 = now(); p2 = by_block(pts, count);
+      t2 = now(); p3 = by_append(pts, types, count);
+      t3 = now();
+      if(!same(p1, p2) || !same(p1, p3)){
+         printf("bench_path: FAILED, paths differ for %u points\n", count);
+         exit(EXIT_FAILURE);
+      }
+      printf("%10u %16.1f %16.1f %16.1f\n", count,
+         count / (t1 - t0) / 1.0e6, count / (t2 - t1) / 1.0e6, count / (t3 - t2) / 1.0e6);
+      U_DPO_free(&p1);
+      U_DPO_free(&p2);
+      U_DPO_free(&p3);
+      if(count == max)break;
+   }
+   free(pts);
+   free(types);
+   exit(EXIT_SUCCESS);
+}
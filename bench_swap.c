@@ -0,0 +1,112 @@
+/**
+ Micro-benchmark for the byte swapping functions U_swap2() and U_swap4(), which are used for every record
+ when converting EMF, EMF+, and WMF data between Big and Little Endian order.  For several array sizes it
+ checks the results against a simple byte at a time loop and reports the throughput of each.
+
+ Run like:
+    bench_swap [megabytes]
+
+ megabytes is the amount of data swapped for each measurement, default 256.
+
+ Build with:  gcc -Wall -std=c99 -O2 -o bench_swap bench_swap.c uemf_endian.c uemf.c uemf_utf.c uemf_safe.c -lm
+
+ The reference loops are compiled here, and at -O2 or above the compiler vectorizes them, so this program
+ must be compiled with the same optimization as the library it links to, or the comparison is meaningless.
+ The CMake target uses the library's flags for that reason.
+*/
+
+/*
+File:      bench_swap.c
+Version:   0.0.1
+Date:      17-OCT-2026
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+/* These are not in any public header, end user code should never need them */
+void U_swap2(void *ul, unsigned int count);
+void U_swap4(void *ul, unsigned int count);
+
+/* The byte at a time reference implementations */
+static void ref_swap2(void *ul, unsigned int count){
+   uint8_t  ctmp;
+   uint8_t *cl = (uint8_t *) ul;
+   for(; count; count--,cl+=2){
+      ctmp = cl[0]; cl[0] = cl[1]; cl[1] = ctmp;
+   }
+}
+
+static void ref_swap4(void *ul, unsigned int count){
+   uint8_t  ctmp;
+   uint8_t *cl = (uint8_t *) ul;
+   for(; count; count--,cl+=4){
+      ctmp = cl[0]; cl[0] = cl[3]; cl[3] = ctmp;
+      ctmp = cl[1]; cl[1] = cl[2]; cl[2] = ctmp;
+   }
+}
+
+static double now(void){
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec);
+}
+
+/* Compare one swap function with its reference for all counts up to max, at every alignment.  Returns 0 if they agree. */
+static int check(void (*fn)(void *, unsigned int), void (*ref)(void *, unsigned int), int size, unsigned int max){
+   uint8_t      *a = malloc(size*max + 16);
+   uint8_t      *b = malloc(size*max + 16);
+   unsigned int  count, align, i;
+   int           status = 0;
+
+   for(count = 0; count <= max && !status; count++){
+      for(align = 0; align < 16; align++){
+         for(i = 0; i < size*max + 16; i++){ a[i] = b[i] = (uint8_t)(i * 37 + count); }
+         fn(a + align, count);
+         ref(b + align, count);
+         if(memcmp(a, b, size*max + 16)){ status = 1; break; }
+      }
+   }
+   free(a);
+   free(b);
+   return(status);
+}
+
+/* Time swapping total bytes of data in arrays of count elements.  Returns MB/s. */
+static double timeit(void (*fn)(void *, unsigned int), int size, unsigned int count, size_t total, uint8_t *buf){
+   size_t  reps = total / (size * count), r;
+   double  start;
+   if(!reps)reps = 1;
+   start = now();
+   for(r = 0; r < reps; r++){ fn(buf, count); }
+   return((double)(reps * size * count) / (now() - start) / 1.0e6);
+}
+
+int main(int argc, char *argv[]){
+   static const unsigned int counts[] = { 1, 2, 6, 16, 64, 1024, 65536 };
+   size_t       total = 256;
+   uint8_t     *buf;
+   unsigned int i;
+
+   if(argc > 1)total = atoi(argv[1]);
+   total *= 1000000;
+   if(check(U_swap2, ref_swap2, 2, 300) || check(U_swap4, ref_swap4, 4, 300)){
+      printf("bench_swap: FAILED, results differ from the reference\n");
+      exit(EXIT_FAILURE);
+   }
+   buf = malloc(4 * 65536);
+   if(!buf)exit(EXIT_FAILURE);
+   memset(buf, 0x5A, 4 * 65536);
+   printf("%10s %14s %14s %14s %14s\n", "elements", "swap2 MB/s", "ref2 MB/s", "swap4 MB/s", "ref4 MB/s");
+   for(i = 0; i < sizeof(counts)/sizeof(counts[0]); i++){
+      printf("%10u %14.0f %14.0f %14.0f %14.0f\n", counts[i],
+         timeit(U_swap2,   2, counts[i], total, buf), timeit(ref_swap2, 2, counts[i], total, buf),
+         timeit(U_swap4,   4, counts[i], total, buf), timeit(ref_swap4, 4, counts[i], total, buf));
+   }
+   free(buf);
+   exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,235 @@
+/**
+ Benchmark for the text conversions, which for text heavy EMF files are a large part of the time spent
+ reading them.  It collects every UTF-16LE string from the U_EMR_EXTTEXTOUTW and U_EMR_EXTCREATEFONTINDIRECTW
+ records of the files given, then converts all of them to UTF-8 with iconv() one string at a time (as this
+ library used to), with U_Utf16leToUtf8(), and with U_Utf_convert() into one reused buffer, checks that the
+ three agree, and reports the rate of each.  Finally it times U_Utf_convert() back to UTF-16LE and checks
+ that the round trip is exact.
+
+ Run like:
+    bench_utf [-r repeats] file1.emf ... fileN.emf
+
+ repeats is the number of times the whole set of strings is converted for each measurement, default 100.
+ Build uemf_utf.c with -DU_UTF_REFERENCE to time U_Utf_convert() without its vector code.
+
+ Build with:  gcc -Wall -std=c99 -O2 -o bench_utf bench_utf.c uemf.c uemf_endian.c uemf_utf.c uemf_safe.c -lm
+*/
+
+/*
+File:      bench_utf.c
+Version:   0.0.1
+Date:      17-OCT-2026
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <iconv.h>
+#include "uemf.h"
+
+typedef struct {
+   uint16_t  *text;     /* all strings, each followed by a terminator */
+   size_t    *start;    /* offset in text of each string */
+   size_t    *count;    /* characters in each string */
+   size_t     strings;
+   size_t     used;     /* elements used in text */
+   size_t     allocated;
+   size_t     slots;    /* elements allocated in start and count */
+} STRPOOL;
+
+static double now(void){
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((double) ts.tv_sec + 1.0e-9 * (double) ts.tv_nsec);
+}
+
+/* Add a string of n UTF-16LE characters, stored at src (which need not be aligned).  Returns 0 on success. */
+static int pool_add(STRPOOL *sp, const char *src, size_t n){
+   void *tmp;
+   if(!n)return(0);
+   if(sp->used + n + 1 > sp->allocated){
+      sp->allocated = 2*(sp->used + n + 1);
+      tmp = realloc(sp->text, sp->allocated * sizeof(uint16_t));
+      if(!tmp)return(1);
+      sp->text = tmp;
+   }
+   if(sp->strings == sp->slots){
+      sp->slots = (sp->slots ? 2*sp->slots : 1024);
+      tmp = realloc(sp->start, sp->slots * sizeof(size_t));
+      if(!tmp)return(1);
+      sp->start = tmp;
+      tmp = realloc(sp->count, sp->slots * sizeof(size_t));
+      if(!tmp)return(1);
+      sp->count = tmp;
+   }
+   memcpy(sp->text + sp->used, src, 2*n);
+   sp->text[sp->used + n] = 0;
+   sp->start[sp->strings] = sp->used;
+   sp->count[sp->strings] = n;
+   sp->strings++;
+   sp->used += n + 1;
+   return(0);
+}
+
+/* Collect the strings from one EMF file.  Returns 0 on success. */
+static int collect(STRPOOL *sp, const char *filename){
+   char                         *contents;
+   size_t                        length, off = 0, n;
+   uint32_t                      iType, nSize, offString;
+   PU_EMREXTTEXTOUTW             pEmr;
+   PU_EMREXTCREATEFONTINDIRECTW  pFont;
+   int                           status = 0;
+
+   if(emf_readdata(filename, &contents, &length)){
+      printf("bench_utf: could not read %s\n", filename);
+      return(1);
+   }
+   while(!status && off + 8 <= length){
+      memcpy(&iType, contents + off,     4);
+      memcpy(&nSize, contents + off + 4, 4);
+      if(nSize < 8 || nSize > length - off)break;
+      if(iType == U_EMR_EXTTEXTOUTW && nSize >= sizeof(U_EMREXTTEXTOUTW)){
+         pEmr      = (PU_EMREXTTEXTOUTW) (contents + off);
+         n         = pEmr->emrtext.nChars;
+         offString = pEmr->emrtext.offString;
+         if(offString <= nSize && n <= (nSize - offString)/2){
+            status = pool_add(sp, contents + off + offString, n);
+         }
+      }
+      else if(iType == U_EMR_EXTCREATEFONTINDIRECTW && nSize >= U_SIZE_EMREXTCREATEFONTINDIRECTW_LOGFONT){
+         pFont = (PU_EMREXTCREATEFONTINDIRECTW) (contents + off);
+         for(n = 0; n < U_LF_FACESIZE && pFont->elfw.elfLogFont.lfFaceName[n]; n++){}
+         status = pool_add(sp, (const char *) pFont->elfw.elfLogFont.lfFaceName, n);
+      }
+      if(iType == U_EMR_EOF)break;
+      off += nSize;
+   }
+   free(contents);
+   return(status);
+}
+
+/* What the conversion functions did before U_Utf_convert(): open, convert, and close iconv for every string */
+static char *ref_Utf16leToUtf8(const uint16_t *src, size_t n){
+   char    *dst, *out;
+   char    *in = (char *) src;
+   size_t   inleft = 2*n, outleft = 1 + 3*n;
+   iconv_t  conv = iconv_open("UTF-8", "UTF-16LE");
+   if(conv == (iconv_t) -1)return(NULL);
+   out = dst = calloc(outleft, 1);
+   if(dst && iconv(conv, &in, &inleft, &out, &outleft) == (size_t) -1){
+      free(dst);
+      dst = NULL;
+   }
+   iconv_close(conv);
+   return(dst);
+}
+
+int main(int argc, char *argv[]){
+   STRPOOL   sp;
+   char     *u8, *a, *b;
+   uint16_t *u16;
+   size_t   *u8start, *u8count;
+   size_t    i, r, chars = 0, u8total = 0, n;
+   int       repeats = 100;
+   int       first   = 1;
+   double    start, t_ref, t_alloc, t_to8, t_to16;
+
+   if(argc > 2 && !strcmp(argv[1], "-r")){
+      repeats = atoi(argv[2]);
+      first   = 3;
+   }
+   if(first >= argc || repeats < 1){
+      printf("Usage: bench_utf [-r repeats] file1.emf ... fileN.emf\n");
+      exit(EXIT_FAILURE);
+   }
+   memset(&sp, 0, sizeof(sp));
+   for(; first < argc; first++){
+      if(collect(&sp, argv[first]))exit(EXIT_FAILURE);
+   }
+   if(!sp.strings){
+      printf("bench_utf: no UTF-16LE text found\n");
+      exit(EXIT_FAILURE);
+   }
+
+   /* Check that all three ways to UTF-8 agree, and keep the UTF-8 for the reverse direction */
+   u8start = malloc(sp.strings * sizeof(size_t));
+   u8count = malloc(sp.strings * sizeof(size_t));
+   u8      = malloc(3*sp.used + 1);
+   u16     = malloc((sp.used + 1) * sizeof(uint16_t));
+   if(!u8start || !u8count || !u8 || !u16)exit(EXIT_FAILURE);
+   for(i = 0; i < sp.strings; i++){
+      chars     += sp.count[i];
+      a          = ref_Utf16leToUtf8(sp.text + sp.start[i], sp.count[i]);
+      b          = U_Utf16leToUtf8(sp.text + sp.start[i], 0, NULL);
+      u8start[i] = u8total;
+      if(U_Utf_convert(U_UTF_8, u8 + u8total, 3*sp.used + 1 - u8total, &n, U_UTF_16LE, sp.text + sp.start[i], sp.count[i]) ||
+         !a || !b || strcmp(a, b) || strcmp(a, u8 + u8total)){
+         printf("bench_utf: FAILED, conversions of string %lu differ\n", (unsigned long) i);
+         exit(EXIT_FAILURE);
+      }
+      u8count[i] = n;
+      u8total   += n + 1;
+      free(a);
+      free(b);
+   }
+   printf("%lu strings, %lu characters, %lu bytes of UTF-8, %d repeats\n",
+      (unsigned long) sp.strings, (unsigned long) chars, (unsigned long) u8total, repeats);
+
+   start = now();
+   for(r = 0; r < (size_t) repeats; r++){
+      for(i = 0; i < sp.strings; i++){ free(ref_Utf16leToUtf8(sp.text + sp.start[i], sp.count[i])); }
+   }
+   t_ref = now() - start;
+
+   start = now();
+   for(r = 0; r < (size_t) repeats; r++){
+      for(i = 0; i < sp.strings; i++){ free(U_Utf16leToUtf8(sp.text + sp.start[i], sp.count[i], NULL)); }
+   }
+   t_alloc = now() - start;
+
+   start = now();
+   for(r = 0; r < (size_t) repeats; r++){
+      for(i = 0; i < sp.strings; i++){
+         (void) U_Utf_convert(U_UTF_8, u8, 3*sp.used + 1, NULL, U_UTF_16LE, sp.text + sp.start[i], sp.count[i]);
+      }
+   }
+   t_to8 = now() - start;
+
+   /* Restore the UTF-8, which the loop above overwrote, and time the reverse */
+   for(i = 0; i < sp.strings; i++){
+      (void) U_Utf_convert(U_UTF_8, u8 + u8start[i], u8count[i] + 1, NULL, U_UTF_16LE, sp.text + sp.start[i], sp.count[i]);
+   }
+   start = now();
+   for(r = 0; r < (size_t) repeats; r++){
+      for(i = 0; i < sp.strings; i++){
+         (void) U_Utf_convert(U_UTF_16LE, u16, sp.used + 1, NULL, U_UTF_8, u8 + u8start[i], u8count[i]);
+      }
+   }
+   t_to16 = now() - start;
+   for(i = 0; i < sp.strings; i++){
+      if(U_Utf_convert(U_UTF_16LE, u16, sp.used + 1, &n, U_UTF_8, u8 + u8start[i], u8count[i]) ||
+         n != sp.count[i] || memcmp(u16, sp.text + sp.start[i], 2*(n + 1))){
+         printf("bench_utf: FAILED, round trip of string %lu differs\n", (unsigned long) i);
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   chars *= repeats;
+   printf("%-36s %14s\n", "UTF-16LE to UTF-8", "Mchars/s");
+   printf("%-36s %14.1f\n", "iconv, opened per string",      chars / t_ref   / 1.0e6);
+   printf("%-36s %14.1f\n", "U_Utf16leToUtf8()",              chars / t_alloc / 1.0e6);
+   printf("%-36s %14.1f\n", "U_Utf_convert(), reused buffer", chars / t_to8   / 1.0e6);
+   printf("%-36s %14s\n", "UTF-8 to UTF-16LE", "Mchars/s");
+   printf("%-36s %14.1f\n", "U_Utf_convert(), reused buffer", chars / t_to16  / 1.0e6);
+   free(u8start);
+   free(u8count);
+   free(u8);
+   free(u16);
+   free(sp.text);
+   free(sp.start);
+   free(sp.count);
+   exit(EXIT_SUCCESS);
+}
@@ -163,7 +163,24 @@ extern "C" {
 #define U_CT_NO                       0               //!< For RGBA_to_DIB, do not use color table
 #define U_CT_BGRA                     1               //!< For RGBA_to_DIB, use color table (16 bits or less only) BGRA colors, compatible with EMF+ ARGB
 #define U_CT_ARGB                     1               //!< For RGBA_to_DIB, use color table (16 bits or less only) BGRA colors, compatible with EMF+ ARGB
+#define U_CT_QUANTIZE                 2               //!< For RGBA_to_DIB, as U_CT_BGRA, but reduce color precision if there are too many colors for the table
+#define U_CT_RLE                      4               //!< For RGBA_to_DIB, add to U_CT_BGRA or U_CT_QUANTIZE to compress 4 or 8 bit DIBs with RLE
+#define U_IMG_UNKNOWN                 0               //!< For U_IMAGEDESC, image format not recognized
+#define U_IMG_DIB                     1               //!< For U_IMAGEDESC, uncompressed DIB, see DIB_to_RGBA
+#define U_IMG_RLE8                    2               //!< For U_IMAGEDESC, U_BI_RLE8 DIB, see RLE_to_RGBA
+#define U_IMG_RLE4                    3               //!< For U_IMAGEDESC, U_BI_RLE4 DIB, see RLE_to_RGBA
+#define U_IMG_PNG                     4               //!< For U_IMAGEDESC, PNG file
+#define U_IMG_JPEG                    5               //!< For U_IMAGEDESC, JPEG file
+#define U_IMG_GIF                     6               //!< For U_IMAGEDESC, GIF file (EMF+ only)
+#define U_IMG_BMP                     7               //!< For U_IMAGEDESC, BMP file (EMF+ only)
+#define U_IMG_TIFF                    8               //!< For U_IMAGEDESC, TIFF file (EMF+ only)
+#define U_IMG_PMFPIXELS               9               //!< For U_IMAGEDESC, EMF+ uncompressed bitmap, pixels in a U_PF_* PixelFormat
+#define U_IMG_EMF                     10              //!< For U_IMAGEDESC, EMF or EMF+ metafile (EMF+ only)
+#define U_IMG_WMF                     11              //!< For U_IMAGEDESC, WMF metafile, possibly placeable (EMF+ only)
 #define U_EMR_COMMENT_SPOOLFONTDEF    0x544F4E46      //!< For U_EMRCOMMENT record that is U_EMR_COMMENT_SPOOL, comment holds font definition informtion.
+#define U_XF_POINT                    1               //!< For U_xform_pairs, int32_t pairs (U_POINT, U_POINTL)
+#define U_XF_POINT16                  2               //!< For U_xform_pairs, int16_t pairs (U_POINT16)
+#define U_XF_POINTF                   3               //!< For U_xform_pairs, float pairs (U_PMF_POINTF)
 /** Solaris 8 has problems with round/roundf, just use this everywhere  */
 #define U_ROUND(A)  ( (A) > 0 ? floor((A)+0.5) : ( (A) < 0 ? -floor(-(A)+0.5) : (A) ) )
 
@@ -301,8 +318,8 @@ typedef uint32_t   U_NUM_RGBQUAD;           //!< Number of U_RGBQUAD (in bmciCol
 */
 #define U_BI_UNKNOWN      -1  //!< not defined in EMF standard, not to be used in EMF files
 #define U_BI_RGB           0  //!< Supported by libUEMF
-#define U_BI_RLE8          1  //!< NOT supported by libUEMF
-#define U_BI_RLE4          2  //!< NOT supported by libUEMF
+#define U_BI_RLE8          1  //!< Supported by libUEMF, see RLE_to_RGBA() and DIB_to_RLE()
+#define U_BI_RLE4          2  //!< Supported by libUEMF, see RLE_to_RGBA() and DIB_to_RLE()
 #define U_BI_BITFIELDS     3  //!< Supported by libUEMF
 #define U_BI_JPEG          4  //!< Supported by libUEMF
 #define U_BI_PNG           5  //!< Supported by libUEMF
@@ -3310,10 +3327,69 @@ typedef struct {
     uint32_t            records;            //!< Number of records already contained
     uint16_t            ignore;             //!< size padding,not used
     uint32_t            PalEntries;         //!< Number of PalEntries (set from U_EMREOF)
-    uint32_t            chunk;              //!< Number of bytes to add when more space is needed
-    char               *buf;                //!< Buffer for constructing the EMF in memory 
+    uint32_t            chunk;              //!< Minimum number of bytes to add when more space is needed, see emf_reserve()
+    char               *buf;                //!< Buffer for constructing the EMF in memory (streaming: holds only the header)
+    int                 stream;             //!< If true records are written to fp as they are appended, see emf_start_stream()
+    uint32_t            reallocs;           //!< Statistics: number of times buf was reallocated
+    size_t              copied;             //!< Statistics: bytes of buf which realloc may have had to copy
+    size_t              open;               //!< Size of the last record if it may still be extended, else 0, see emf_extend_space()
+    uint32_t            pmfpack;            //!< Largest EMR_COMMENT into which consecutive EMF+ records are packed, 0 for one per comment, see U_PMR_pack()
 } EMFTRACK;
 
+/**
+  Location of one record in an EMF in memory, see emf_index_build().
+*/
+typedef struct {
+    uint32_t            offset;             //!< Offset in bytes from the start of the EMF to the record
+    uint32_t            iType;              //!< Record type, U_EMR_*
+    uint32_t            nSize;              //!< Record size in bytes
+} EMFINDEXREC;
+
+/**
+  Index of every record in an EMF, so that any record, or any run of records, may be located without walking the file.
+  Built by emf_index_build() or read back from a sidecar file by emf_index_load().
+*/
+typedef struct {
+    uint32_t            length;             //!< Size in bytes of the EMF this index describes
+    uint32_t            count;              //!< Number of records
+    EMFINDEXREC        *recs;               //!< One entry per record, in file order
+} EMFINDEX;
+
+/**
+  Description of an image stored in an EMF, WMF, or EMF+ record, made without decoding the image, see
+  get_DIB_desc(), wget_DIB_desc(), and U_PMF_IMAGE_desc().  Points into the record, nothing is copied.
+*/
+typedef struct {
+    uint32_t            format;             //!< U_IMG_* image format
+    int32_t             width;              //!< Width in pixels, 0 if not known
+    int32_t             height;             //!< Height in pixels (always positive), 0 if not known
+    uint32_t            bitcount;           //!< Bits per pixel, 0 if not known
+    uint32_t            invert;             //!< If rows are in opposite order from RGBA rows (DIB formats only)
+    const U_RGBQUAD    *ct;                 //!< Color table, or NULL
+    uint32_t            numCt;              //!< Color table number of entries
+    const char         *data;               //!< The pixels (DIB formats) or the whole encoded image (other formats)
+    uint32_t            cbData;             //!< Bytes in data, 0 if not known
+} U_IMAGEDESC;
+
+/**
+  State for converting a DIB pixmap to RGBA one row at a time, see DIB_rows_init().  Refers to, but does not
+  copy, the DIB pixels and color table.
+*/
+typedef struct {
+    const char         *px;                 //!< DIB pixel array
+    const U_RGBQUAD    *ct;                 //!< DIB color table, or NULL
+    int                 numCt;              //!< DIB color table number of entries
+    int                 w;                  //!< Width of pixel array
+    int                 h;                  //!< Height of pixel array
+    uint32_t            colortype;          //!< DIB BitCount Enumeration
+    int                 use_ct;             //!< If the DIB uses the color table
+    int                 invert;             //!< If DIB rows are in opposite order from RGBA rows
+    int                 usedbytes;          //!< Bytes of pixel data in each DIB row
+    int                 rowbytes;           //!< Bytes in each DIB row, including the padding
+    int                 row;                //!< Next RGBA row for DIB_rows_next()
+    uint8_t             lut[256][4];        //!< Color table as RGBA, indexed by color number
+} U_DIBROWS;
+
 /**
   The various create functions need a place to put their handles, these are stored in the table below.
   We don't actually do anything much with these handles, that is up to whatever program finally plays back the EMF, but
@@ -3334,6 +3410,109 @@ typedef struct {
     uint32_t            peak;               //!< Highest slot occupied (ever)
 } EMFHANDLES;
 
+/**
+  One object in an EMFOBJCACHE.
+*/
+typedef struct {
+    uint64_t            hash;               //!< Hash of the creating record, handle field excluded
+    uint32_t            ih;                 //!< Handle of the object, 0 if the slot is empty
+    char               *rec;                //!< Copy of the creating record, used to confirm a match
+} EMFCACHEENTRY;
+
+/**
+  Cache of the objects created so far, so that a pen, brush, font, palette, or color space identical to
+  one which already has a handle can reuse that handle instead of being written again, see emf_objcache_use().
+  The objects are found by a hash of the creating record, so the cost of a lookup does not depend on the number
+  of objects or on the size of their bitmaps.
+*/
+typedef struct {
+    EMFCACHEENTRY      *slots;              //!< Open addressing hash table of objects
+    uint32_t            allocated;          //!< Slots in the table, a power of 2
+    uint32_t            used;               //!< Slots occupied
+    uint64_t           *ihhash;             //!< Hash of the object holding each handle, indexed by handle
+    uint32_t            ihallocated;        //!< Entries in ihhash
+    uint32_t            hits;               //!< Number of objects which reused a handle
+    uint64_t            saved;              //!< Bytes not written because of those hits
+} EMFOBJCACHE;
+
+/**
+  One object in a U_OBJTABLE.
+*/
+typedef struct {
+    uint32_t            type;               //!< Type (U_EMR_* or U_WMR_*) of the record which created the object, 0 if the slot is empty
+    uint32_t            offset;             //!< Offset of that record from the start of the file
+    const char         *record;             //!< That record
+} U_OBJENTRY;
+
+/**
+  The objects defined at some point while reading an EMF or WMF file, indexed by handle, see emf_objtable_record()
+  and wmf_objtable_record().  The pen, brush, font, palette, or region a record refers to is found with U_objtable_get()
+  in constant time, without looking back through the file for the record which created it.
+*/
+typedef struct {
+    U_OBJENTRY         *objects;            //!< Objects, indexed by handle
+    uint32_t            allocated;          //!< Entries in objects
+    uint32_t            count;              //!< Objects currently defined
+    uint32_t            next;               //!< Lowest handle never assigned by U_objtable_insert()
+    uint32_t           *free;               //!< Min heap of the handles below next which are free
+    uint32_t            nfree;              //!< Entries in free
+} U_OBJTABLE;
+
+/**
+  One level of the device context tracked by U_DC_STATE.  Coordinates are in logical units unless noted.
+*/
+typedef struct {
+    uint32_t            pen;                //!< Handle of the selected pen, stock objects have U_STOCK_OBJECT set
+    uint32_t            brush;              //!< Handle of the selected brush
+    uint32_t            font;               //!< Handle of the selected font
+    uint32_t            palette;            //!< Handle of the selected palette
+    const char         *penRecord;          //!< Record which created the selected pen, NULL for a stock pen
+    const char         *brushRecord;        //!< Record which created the selected brush, NULL for a stock brush
+    const char         *fontRecord;         //!< Record which created the selected font, NULL for a stock font
+    const char         *paletteRecord;      //!< Record which created the selected palette, NULL for the stock palette
+    uint32_t            mapMode;            //!< MapMode Enumeration
+    uint32_t            bkMode;             //!< BackgroundMode Enumeration
+    uint32_t            polyFillMode;       //!< PolygonFillMode Enumeration
+    uint32_t            rop2;               //!< Binary Raster Operation Enumeration
+    uint32_t            stretchMode;        //!< StretchMode Enumeration
+    uint32_t            textAlign;          //!< TextAlignment Enumeration
+    uint32_t            arcDirection;       //!< ArcDirection Enumeration
+    uint32_t            miterLimit;         //!< Miter limit
+    U_COLORREF          textColor;          //!< Text color
+    U_COLORREF          bkColor;            //!< Background color
+    U_POINTL            windowOrg;          //!< Window origin
+    U_SIZEL             windowExt;          //!< Window extent
+    U_POINTL            viewportOrg;        //!< Viewport origin, in device units
+    U_SIZEL             viewportExt;        //!< Viewport extent, in device units
+    U_XFORM             worldTransform;     //!< World to page transform
+    U_POINTL            cur;                //!< Current position
+    int                 clipSet;            //!< 0 if there is no clipping region, else 1
+    int                 clipExact;          //!< 1 if the clipping region is exactly clip, 0 if it only lies within it
+    U_RECTL             clip;               //!< Bounds of the clipping region in device units, see U_DC_UNBOUNDED
+} U_DC;
+
+/**
+  Bound of a U_DC clip which is not limited on some side, for instance after U_EMR_EXCLUDECLIPRECT with no
+  clipping region set.
+*/
+#define U_DC_UNBOUNDED_MIN  INT32_MIN       //!< Left or top of an unbounded clip
+#define U_DC_UNBOUNDED_MAX  INT32_MAX       //!< Right or bottom of an unbounded clip
+
+/**
+  Device context state for reading an EMF file, see emf_dcstate_record().  Each record is passed in turn and the
+  selected objects, modes, colors, transforms, current position, and clip are updated, with a stack of saved
+  states for U_EMR_SAVEDC and U_EMR_RESTOREDC.  The current state is dc[level].
+*/
+typedef struct {
+    U_DC               *dc;                 //!< dc[0] to dc[level], those below level were saved by U_EMR_SAVEDC
+    int                 level;              //!< Index of the current state
+    int                 allocated;          //!< Entries in dc
+    int                 inPath;             //!< 1 between U_EMR_BEGINPATH and U_EMR_ENDPATH or U_EMR_ABORTPATH
+    U_FLOAT             pxPerMmX;           //!< Reference device pixels per mm, horizontal, from the header
+    U_FLOAT             pxPerMmY;           //!< Reference device pixels per mm, vertical, from the header
+    U_OBJTABLE         *objects;            //!< Objects defined so far
+} U_DC_STATE;
+
 /**
   2 x 2 matrix, used by xform_alt_set() function.
 */
@@ -3372,16 +3551,45 @@ int       get_DIB_params( const char *record, uint32_t offBitsSrc, uint32_t offB
                uint32_t *width, uint32_t *height, uint32_t *colortype, uint32_t *invert );
 int       DIB_to_RGBA(const char *px, const U_RGBQUAD *ct, int numCt,
                char **rgba_px, int w, int h, uint32_t colortype, int use_ct, int invert);
+int       DIB_to_RGBA_mt(const char *px, const U_RGBQUAD *ct, int numCt,
+               char **rgba_px, int w, int h, uint32_t colortype, int use_ct, int invert, int nthreads);
+int       RGBA_to_DIB_mt(char **px, uint32_t *cbPx, PU_RGBQUAD *ct, int *numCt, 
+               const char *rgba_px, int w, int h, int stride, uint32_t colortype, int use_ct, int invert, int nthreads);
+int       image_desc_data(const char *data, uint32_t size, U_IMAGEDESC *id);
+int       image_desc_dib(const char *Bmih, const char *px, uint32_t cbPx, U_IMAGEDESC *id);
+int       get_DIB_desc(const char *record, uint32_t offBitsSrc, uint32_t offBmiSrc, uint32_t cbBitsSrc, U_IMAGEDESC *id);
+int       RLE_to_RGBA(const char *rle, uint32_t cbRle, const U_RGBQUAD *ct, int numCt,
+               char **rgba_px, int w, int h, uint32_t compression, int invert);
+int       DIB_to_RLE(const char *px, int w, int h, uint32_t colortype, char **rle, uint32_t *cbRle);
+int       DIB_rows_init(U_DIBROWS *dr, const char *px, const U_RGBQUAD *ct, int numCt,
+               int w, int h, uint32_t colortype, int use_ct, int invert);
+int       DIB_rows_from_record(U_DIBROWS *dr, const char *record, uint32_t offBitsSrc, uint32_t offBmiSrc);
+int       DIB_rows_get(const U_DIBROWS *dr, int row, char *rgba_row);
+int       DIB_rows_next(U_DIBROWS *dr, char *rgba_row);
 char     *RGBA_to_RGBA(char *rgba_px, int w, int h, int sl, int st, int *ew, int *eh);
 
 int   device_size(const int xmm, const int ymm, const float dpmm, U_SIZEL *szlDev, U_SIZEL *szlMm);
 int   drawing_size(const int xmm, const int yum, const float dpmm, U_RECTL *rclBounds, U_RECTL *rclFrame);
 
 int   emf_start(const char *name, const uint32_t initsize, const uint32_t chunksize, EMFTRACK **et);
+int   emf_start_stream(const char *name, const uint32_t initsize, EMFTRACK **et);
 int   emf_finish(EMFTRACK *et, EMFHANDLES *eht);
 int   emf_free(EMFTRACK **et);
 int   emf_append(U_ENHMETARECORD *rec, EMFTRACK *et, int freerec);
+int   emf_reserve(EMFTRACK *et, size_t size);
+char *emf_append_space(EMFTRACK *et, size_t size);
+int   emf_append_commit(EMFTRACK *et);
+char *emf_extend_space(EMFTRACK *et, size_t size);
+int   emf_extend_commit(EMFTRACK *et);
 int   emf_readdata(const char *filename, char **contents, size_t *length);   
+int   emf_mapdata(const char *filename, char **contents, size_t *length);
+int   emf_unmapdata(char *contents, size_t length);
+int   emf_index_build(const char *contents, size_t length, EMFINDEX **ei);
+int   emf_index_free(EMFINDEX **ei);
+const char *emf_index_record(const char *contents, const EMFINDEX *ei, uint32_t recnum);
+int   emf_index_span(const EMFINDEX *ei, uint32_t first, uint32_t last, size_t *offset, size_t *length);
+int   emf_index_save(const char *filename, const EMFINDEX *ei);
+int   emf_index_load(const char *filename, EMFINDEX **ei);
 FILE *emf_fopen(const char *filename, const int mode);
 
 
@@ -3390,6 +3598,21 @@ int   emf_htable_create(uint32_t initsize, uint32_t chunksize, EMFHANDLES **eht)
 int   emf_htable_delete(uint32_t *ih, EMFHANDLES *eht);
 int   emf_htable_insert(uint32_t *ih, EMFHANDLES *eht);
 int   emf_htable_free(EMFHANDLES **eht);
+int   emf_objcache_create(uint32_t initsize, EMFOBJCACHE **eoc);
+int   emf_objcache_use(EMFOBJCACHE *eoc, EMFHANDLES *eht, char **rec, uint32_t *ih);
+int   emf_objcache_forget(EMFOBJCACHE *eoc, uint32_t ih);
+int   emf_objcache_free(EMFOBJCACHE **eoc);
+int   U_objtable_create(uint32_t initsize, U_OBJTABLE **ot);
+int   U_objtable_set(U_OBJTABLE *ot, uint32_t ih, uint32_t type, const char *record, uint32_t offset);
+int   U_objtable_insert(U_OBJTABLE *ot, uint32_t type, const char *record, uint32_t offset, uint32_t *ih);
+int   U_objtable_delete(U_OBJTABLE *ot, uint32_t ih);
+const U_OBJENTRY *U_objtable_get(const U_OBJTABLE *ot, uint32_t ih);
+int   U_objtable_free(U_OBJTABLE **ot);
+int   emf_objtable_record(U_OBJTABLE *ot, const char *record, uint32_t offset);
+int   emf_dcstate_create(U_DC_STATE **ds);
+int   emf_dcstate_record(U_DC_STATE *ds, const char *record, uint32_t offset);
+int   emf_dcstate_xform(const U_DC_STATE *ds, U_XFORM *xf);
+int   emf_dcstate_free(U_DC_STATE **ds);
 /* Deprecated forms */
 #define   htable_create  emf_htable_create
 #define   htable_delete  emf_htable_delete
@@ -3452,6 +3675,10 @@ U_PIXELFORMATDESCRIPTOR pixelformatdescriptor_set( uint32_t dwFlags, uint8_t iPi
 PU_POINT     points_transform(PU_POINT points, int count, U_XFORM xform);
 PU_POINT16   point16_transform(PU_POINT16 points, int count, U_XFORM xform);
 PU_TRIVERTEX trivertex_transform(PU_TRIVERTEX tv, int count, U_XFORM xform);
+int          U_xform_pairs(const void *src, void *dst, int count, int kind, U_XFORM xform, double *bounds);
+int          points_transform_into(const U_POINT *src, U_POINT *dst, int count, U_XFORM xform, PU_RECTL bounds);
+int          point16_transform_into(const U_POINT16 *src, U_POINT16 *dst, int count, U_XFORM xform, PU_RECTL bounds);
+int          trivertex_transform_into(const U_TRIVERTEX *src, U_TRIVERTEX *dst, int count, U_XFORM xform, PU_RECTL bounds);
 PU_POINT     point16_to_point(PU_POINT16 points, int count);
 PU_POINT16   point_to_point16(PU_POINT   points, int count);
 
@@ -3644,6 +3871,78 @@ char *U_EMRGRADIENTFILL_set(const U_RECTL rclBounds, const U_NUM_TRIVERTEX nTriV
 char *U_EMRCREATECOLORSPACEW_set(const uint32_t ihCS, const U_LOGCOLORSPACEW lcs, const uint32_t dwFlags,
                     const U_CBDATA cbData, const uint8_t *Data);
 
+// U_EMR*_emplace, same arguments as the U_EMR*_set functions preceded by the EMFTRACK
+int U_EMRPOLYBEZIER_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t cptl, const U_POINTL *points);
+int U_EMRPOLYGON_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t cptl, const U_POINTL *points);
+int U_EMRPOLYLINE_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t cptl, const U_POINTL *points);
+int U_EMRPOLYBEZIERTO_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t cptl, const U_POINTL *points);
+int U_EMRPOLYLINETO_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t cptl, const U_POINTL *points);
+int U_EMRPOLYPOLYLINE_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts, const uint32_t cptl, const U_POINTL *points);
+int U_EMRPOLYPOLYGON_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts, const uint32_t cptl, const U_POINTL *points);
+int U_EMRSETWINDOWEXTEX_emplace(EMFTRACK *et, const U_SIZEL szlExtent);
+int U_EMRSETWINDOWORGEX_emplace(EMFTRACK *et, const U_POINTL ptlOrigin);
+int U_EMRSETVIEWPORTEXTEX_emplace(EMFTRACK *et, const U_SIZEL szlExtent);
+int U_EMRSETVIEWPORTORGEX_emplace(EMFTRACK *et, const U_POINTL ptlOrigin);
+int U_EMRSETBRUSHORGEX_emplace(EMFTRACK *et, const U_POINTL ptlOrigin);
+int U_EMRSETMAPMODE_emplace(EMFTRACK *et, const uint32_t iMode);
+int U_EMRSETBKMODE_emplace(EMFTRACK *et, const uint32_t iMode);
+int U_EMRSETPOLYFILLMODE_emplace(EMFTRACK *et, const uint32_t iMode);
+int U_EMRSETROP2_emplace(EMFTRACK *et, const uint32_t iMode);
+int U_EMRSETSTRETCHBLTMODE_emplace(EMFTRACK *et, const uint32_t iMode);
+int U_EMRSETTEXTALIGN_emplace(EMFTRACK *et, const uint32_t iMode);
+int U_EMRSETTEXTCOLOR_emplace(EMFTRACK *et, const U_COLORREF crColor);
+int U_EMRSETBKCOLOR_emplace(EMFTRACK *et, const U_COLORREF crColor);
+int U_EMROFFSETCLIPRGN_emplace(EMFTRACK *et, const U_POINTL ptl);
+int U_EMRMOVETOEX_emplace(EMFTRACK *et, const U_POINTL ptl);
+int U_EMRSETMETARGN_emplace(EMFTRACK *et);
+int U_EMREXCLUDECLIPRECT_emplace(EMFTRACK *et, const U_RECTL rclClip);
+int U_EMRINTERSECTCLIPRECT_emplace(EMFTRACK *et, const U_RECTL rclClip);
+int U_EMRSCALEVIEWPORTEXTEX_emplace(EMFTRACK *et, const int32_t xNum, const int32_t xDenom, const int32_t yNum, const int32_t yDenom);
+int U_EMRSCALEWINDOWEXTEX_emplace(EMFTRACK *et, const int32_t xNum, const int32_t xDenom, const int32_t yNum, const int32_t yDenom);
+int U_EMRSAVEDC_emplace(EMFTRACK *et);
+int U_EMRRESTOREDC_emplace(EMFTRACK *et, const int32_t iRelative);
+int U_EMRELLIPSE_emplace(EMFTRACK *et, const U_RECTL rclBox);
+int U_EMRRECTANGLE_emplace(EMFTRACK *et, const U_RECTL rclBox);
+int U_EMRARC_emplace(EMFTRACK *et, const U_RECTL rclBox, const U_POINTL ptlStart, const U_POINTL ptlEnd);
+int U_EMRCHORD_emplace(EMFTRACK *et, const U_RECTL rclBox, const U_POINTL ptlStart, const U_POINTL ptlEnd);
+int U_EMRPIE_emplace(EMFTRACK *et, const U_RECTL rclBox, const U_POINTL ptlStart, const U_POINTL ptlEnd);
+int U_EMRSELECTPALETTE_emplace(EMFTRACK *et, const uint32_t ihPal);
+int U_EMRRESIZEPALETTE_emplace(EMFTRACK *et, const uint32_t ihPal, const uint32_t cEntries);
+int U_EMRREALIZEPALETTE_emplace(EMFTRACK *et);
+int U_EMRLINETO_emplace(EMFTRACK *et, const U_POINTL ptl);
+int U_EMRARCTO_emplace(EMFTRACK *et, U_RECTL rclBox, U_POINTL ptlStart, U_POINTL ptlEnd);
+int U_EMRSETARCDIRECTION_emplace(EMFTRACK *et, const uint32_t iArcDirection);
+int U_EMRSETMITERLIMIT_emplace(EMFTRACK *et, const uint32_t eMiterLimit);
+int U_EMRBEGINPATH_emplace(EMFTRACK *et);
+int U_EMRENDPATH_emplace(EMFTRACK *et);
+int U_EMRCLOSEFIGURE_emplace(EMFTRACK *et);
+int U_EMRFILLPATH_emplace(EMFTRACK *et, const U_RECTL rclBox);
+int U_EMRSTROKEANDFILLPATH_emplace(EMFTRACK *et, const U_RECTL rclBox);
+int U_EMRSTROKEPATH_emplace(EMFTRACK *et, const U_RECTL rclBox);
+int U_EMRFLATTENPATH_emplace(EMFTRACK *et);
+int U_EMRWIDENPATH_emplace(EMFTRACK *et);
+int U_EMRSELECTCLIPPATH_emplace(EMFTRACK *et, const uint32_t iMode);
+int U_EMRABORTPATH_emplace(EMFTRACK *et);
+int U_EMRINVERTRGN_emplace(EMFTRACK *et, const PU_RGNDATA RgnData);
+int U_EMRPAINTRGN_emplace(EMFTRACK *et, const PU_RGNDATA RgnData);
+int U_EMREXTTEXTOUTA_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t iGraphicsMode, const U_FLOAT exScale, const U_FLOAT eyScale, const PU_EMRTEXT emrtext);
+int U_EMREXTTEXTOUTW_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t iGraphicsMode, const U_FLOAT exScale, const U_FLOAT eyScale, const PU_EMRTEXT emrtext);
+int U_EMRPOLYBEZIER16_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t cpts, const U_POINT16 *points);
+int U_EMRPOLYGON16_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t cpts, const U_POINT16 *points);
+int U_EMRPOLYLINE16_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t cpts, const U_POINT16 *points);
+int U_EMRPOLYBEZIERTO16_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t cpts, const U_POINT16 *points);
+int U_EMRPOLYLINETO16_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t cpts, const U_POINT16 *points);
+int U_EMRPOLYPOLYLINE16_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts, const uint32_t cpts, const U_POINT16 *points);
+int U_EMRPOLYPOLYGON16_emplace(EMFTRACK *et, const U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts, const uint32_t cpts, const U_POINT16 *points);
+int U_EMRCREATEMONOBRUSH_emplace(EMFTRACK *et, const uint32_t ihBrush, const uint32_t iUsage, const PU_BITMAPINFO Bmi, const uint32_t cbPx, const char *Px);
+int U_EMRCREATEDIBPATTERNBRUSHPT_emplace(EMFTRACK *et, const uint32_t ihBrush, const uint32_t iUsage, const PU_BITMAPINFO Bmi, const uint32_t cbPx, const char *Px);
+int U_EMRSETICMMODE_emplace(EMFTRACK *et, const uint32_t iMode);
+int U_EMRSETCOLORSPACE_emplace(EMFTRACK *et, const uint32_t ihCS);
+int U_EMRDELETECOLORSPACE_emplace(EMFTRACK *et, const uint32_t ihCS);
+int U_EMRALPHABLEND_emplace(EMFTRACK *et, const U_RECTL rclBounds, const U_POINTL Dest, const U_POINTL cDest, const U_POINTL Src, const U_POINTL cSrc, const U_XFORM xformSrc, const U_COLORREF crBkColorSrc, const uint32_t iUsageSrc, const U_BLEND Blend, const PU_BITMAPINFO Bmi, const uint32_t cbPx, char *Px);
+int U_EMRSETLAYOUT_emplace(EMFTRACK *et, uint32_t iMode);
+int U_EMRTRANSPARENTBLT_emplace(EMFTRACK *et, const U_RECTL rclBounds, const U_POINTL Dest, const U_POINTL cDest, const U_POINTL Src, const U_POINTL cSrc, const U_XFORM xformSrc, const U_COLORREF crBkColorSrc, const uint32_t iUsageSrc, const uint32_t TColor, const PU_BITMAPINFO Bmi, const uint32_t cbPx, char *Px);
+
 //! \endcond
 
 #ifdef __cplusplus
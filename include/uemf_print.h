@@ -20,6 +20,8 @@ Copyright: 2015 David Mathog and California Institute of Technology (Caltech)
 extern "C" {
 #endif
 
+#include "upmf.h" /* for U_PMF_PARSE_CTX, includes uemf.h */
+
 //! \cond
 /* prototypes for miscellaneous  */
 uint32_t lu_crc32(const char *record, uint32_t Size);
@@ -46,7 +48,7 @@ void logcolorspacew_print(U_LOGCOLORSPACEW lcsa);
 void panose_print(U_PANOSE panose);
 void logfont_print(U_LOGFONT lf);
 void logfont_panose_print(U_LOGFONT_PANOSE lfp); 
-void bitmapinfoheader_print(const char *Bmih);
+int  bitmapinfoheader_print(const char *Bmih);
 void bitmapinfo_print(const char *Bmi, const char *blimit);
 void blend_print(U_BLEND blend);
 void extlogpen_print(const PU_EXTLOGPEN elp);
@@ -60,7 +62,7 @@ void pixelformatdescriptor_print(U_PIXELFORMATDESCRIPTOR pfd);
 void emrtext_print(const char *emt, const char *record, const char *blimit, int type);
 
 /* prototypes for EMR records */
-void U_EMRNOTIMPLEMENTED_print(const char *name, const char *contents, int recnum, int off);
+void U_EMRNOTIMPLEMENTED_print(const char *name, const char *contents);
 void U_EMRHEADER_print(const char *contents);
 void U_EMRPOLYBEZIER_print(const char *contents);
 void U_EMRPOLYGON_print(const char *contents);
@@ -130,6 +132,7 @@ void U_EMRWIDENPATH_print(const char *contents);
 void U_EMRSELECTCLIPPATH_print(const char *contents);
 void U_EMRABORTPATH_print(const char *contents);
 void U_EMRCOMMENT_print(const char *contents, size_t off);
+void U_EMRCOMMENT_print_r(U_PMF_PARSE_CTX *ctx, const char *contents, size_t off);
 void U_EMRFILLRGN_print(const char *contents);
 void U_EMRFRAMERGN_print(const char *contents);
 void U_EMRINVERTRGN_print(const char *contents);
@@ -166,7 +169,8 @@ void U_EMRSETLAYOUT_print(const char *contents);
 void U_EMRTRANSPARENTBLT_print(const char *contents);
 void U_EMRGRADIENTFILL_print(const char *contents);
 void U_EMRCREATECOLORSPACEW_print(const char *contents);
-int  U_emf_onerec_print(const char *contents, char *blimit, int recnum, int off);
+int  U_emf_onerec_print(const char *contents, const char *blimit, int recnum, size_t off);
+int  U_emf_onerec_print_r(U_PMF_PARSE_CTX *ctx, const char *contents, const char *blimit, int recnum, size_t off);
 //! \endcond
 
 
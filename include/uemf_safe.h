@@ -20,9 +20,34 @@ Copyright: 2015 David Mathog and California Institute of Technology (Caltech)
 extern "C" {
 #endif
 
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+  State for reading an EMF file one record at a time, see emf_reader_open().  Only the record
+  being examined (and any read ahead) is held in memory, never the whole file.
+*/
+typedef struct {
+    FILE               *fp;                 //!< Source file, or NULL if fd is used
+    int                 fd;                 //!< Source file descriptor, or -1 if fp is used
+    char               *buf;                //!< Buffer holding (at least) the current record
+    size_t              allocated;          //!< Size of the buffer
+    size_t              used;               //!< Number of bytes of file data in the buffer
+    size_t              next;               //!< Offset in buf of the next record
+    size_t              maxrec;             //!< Largest record accepted, anything larger is treated as corrupt
+    size_t              foffset;            //!< File offset of buf[0]
+    size_t              offset;             //!< File offset of the most recently returned record
+    uint32_t            recnum;             //!< Number of records returned so far
+    int                 status;             //!< 0 while reading, 1 after U_EMR_EOF or end of file, >=2 after an error
+} EMFREADER;
+
 // prototypes
 int U_emf_record_safe(const char *record);
 int bitmapinfo_safe(const char *Bmi, const char *blimit);
+int emf_reader_open(FILE *fp, size_t chunksize, size_t maxrecsize, EMFREADER **er);
+int emf_reader_fdopen(int fd, size_t chunksize, size_t maxrecsize, EMFREADER **er);
+int emf_reader_next(EMFREADER *er, char **record);
+int emf_reader_close(EMFREADER **er);
 //! \endcond
 
 #ifdef __cplusplus
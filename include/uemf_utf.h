@@ -25,6 +25,15 @@ extern "C" {
 #include <stdbool.h>
 #include "uemf_endian.h"
 
+/** \defgroup U_UTF_Codes Text encodings for U_Utf_convert()
+  @{
+*/
+#define U_UTF_LATIN1      1     //!< ISO-8859-1, one byte per character
+#define U_UTF_8           2     //!< UTF-8, code units are bytes
+#define U_UTF_16LE        3     //!< UTF-16 Little Endian, code units are uint16_t
+#define U_UTF_32LE        4     //!< UTF-32 Little Endian, code units are uint32_t
+/** @} */
+
 void      wchar8show(const char *src);
 void      wchar16show(const uint16_t *src);
 void      wchar32show(const uint32_t *src);
@@ -44,6 +53,8 @@ char     *U_Utf16leToUtf8( const uint16_t *src, size_t max, size_t *len );
 char     *U_Utf16leToLatin1( const uint16_t *src, size_t max, size_t *len );
 char     *U_Utf8ToLatin1( const char *src, size_t max, size_t *len );
 char     *U_Latin1ToUtf8( const char *src, size_t max, size_t *len );
+int       U_Utf_convert(int dstcode, void *dst, size_t dstmax, size_t *dstlen, int srccode, const void *src, size_t max);
+void      U_Utf_cleanup(void);
 uint16_t  U_Utf16le(const uint16_t src);
 int       U_Utf16leEdit( uint16_t *src, uint16_t find, uint16_t replace );
 char     *U_strdup(const char *s);
@@ -167,6 +167,7 @@ int U_PMR_MULTIFORMATSECTION_print(const char *contents);  /* last of reserved b
 int U_PMR_MULTIFORMATEND_print(const char *contents);      /* last of reserved but not used */
 
 int U_pmf_onerec_print(const char *contents, const char *blimit, int recnum, int off);
+int U_pmf_onerec_print_r(U_PMF_PARSE_CTX *ctx, const char *contents, const char *blimit, int recnum, int off);
 
 
 
@@ -2049,10 +2049,13 @@ typedef struct {
     uint32_t            records;            //!< Number of records already contained
     uint16_t            ignore;             //!< size padding,not used
     uint32_t            PalEntries;         //!< Number of PalEntries (set from U_EMREOF)
-    uint32_t            chunk;              //!< Number of bytes to add when more space is needed
+    uint32_t            chunk;              //!< Minimum number of bytes to add when more space is needed, see wmf_reserve()
     char               *buf;                //!< Buffer for constructing the EMF in memory 
     uint32_t            largest;            //!< Largest record size, in bytes (used by WMF, not by EMF)
     uint32_t            sumObjects;         //!< Number of objects appended  (used by WMF, not by EMF) [ also see wmf_highwater() ]
+    int                 stream;             //!< If true records are written to fp as they are appended, see wmf_start_stream()
+    uint32_t            reallocs;           //!< Statistics: number of times buf was reallocated
+    size_t              copied;             //!< Statistics: bytes of buf which realloc may have had to copy
 } WMFTRACK;
 
 /**
@@ -2078,17 +2081,22 @@ typedef struct {
 // Prototypes (_set first, then _get)
 char        *wmr_dup(const char *wmr);
 int          wmf_start(const char *name, uint32_t initsize, uint32_t chunksize, WMFTRACK **wt);
+int          wmf_start_stream(const char *name, uint32_t initsize, WMFTRACK **wt);
 int          wmf_free(WMFTRACK **wt);
 int          wmf_finish(WMFTRACK *wt);
 int          wmf_append(U_METARECORD *rec, WMFTRACK *wt, int freerec);
 int          wmf_header_append(U_METARECORD *rec,WMFTRACK *et, int freerec);
+int          wmf_reserve(WMFTRACK *wt, size_t size);
 int          wmf_readdata(const char *filename, char **contents, size_t*length);
+int          wmf_mapdata(const char *filename, char **contents, size_t *length);
+#define      wmf_unmapdata emf_unmapdata
 #define      wmf_fopen    emf_fopen
 int          wmf_highwater(uint32_t setval);
 int          wmf_htable_create(uint32_t initsize, uint32_t chunksize, WMFHANDLES **wht);
 int          wmf_htable_delete(uint32_t *ih, WMFHANDLES *wht);
 int          wmf_htable_insert(uint32_t *ih, WMFHANDLES *wht);
 int          wmf_htable_free(WMFHANDLES **wht);
+int          wmf_objtable_record(U_OBJTABLE *ot, const char *record, uint32_t offset);
 int16_t      U_16_checksum(int16_t *buf, int count);
 int16_t     *dx16_set( int32_t  height, uint32_t weight, uint32_t members);
 uint32_t     U_wmr_properties(uint32_t type);
@@ -2411,6 +2419,7 @@ void         U_BITMAPINFOHEADER_get(const char *Bmih, uint32_t *Size, int32_t *W
 void         U_BITMAPCOREHEADER_get(const char *BmiCh, uint32_t *Size, int32_t *Width, int32_t *Height, int32_t *BitCount);
 int          wget_DIB_params(const char *dib, const char **px, const U_RGBQUAD **ct, uint32_t *numCt, 
                 int32_t *width, int32_t *height, int32_t *colortype, int32_t *invert);
+int          wget_DIB_desc(const char *dib, U_IMAGEDESC *id);
 int          U_WMREOF_get(const char *contents);
 int          U_WMRSETBKCOLOR_get(const char *contents, U_COLORREF *Color);
 int          U_WMRSETBKMODE_get(const char *contents, uint16_t *Mode);
@@ -37,12 +37,15 @@ int myEnhMetaFileProc(char *contents, size_t length)
     int      recnum=0;
     PU_ENHMETARECORD pEmr;
     char     *blimit;
+    U_PMF_PARSE_CTX ctx;  /* EMF+ state for this file */
     
     blimit = contents + length;
+    (void) U_PCTX_init(&ctx);
 
     while(OK){
        if(off>=length){ //normally should exit from while after EMREOF sets OK to false, this is most likely a corrupt EMF
           printf("WARNING: record claims to extend beyond the end of the EMF file\n");
+          (void) U_PCTX_release(&ctx);
           return(0); 
        }
 
@@ -52,7 +55,7 @@ int myEnhMetaFileProc(char *contents, size_t length)
           printf("WARNING: EMF file does not begin with an EMR_HEADER record\n");
        }
        
-       result = U_emf_onerec_print(contents, blimit, recnum, off);
+       result = U_emf_onerec_print_r(&ctx, contents, blimit, recnum, off);
        if(result == (size_t) -1){
           printf("ABORTING on invalid record - corrupt file?\n");
           OK=0;
@@ -66,6 +69,7 @@ int myEnhMetaFileProc(char *contents, size_t length)
        }
     }  //end of while
 
+    (void) U_PCTX_release(&ctx);
     return 1;
 }
 
@@ -74,14 +78,14 @@ int main(int argc, char *argv[]){
 size_t    length;
 char     *contents=NULL;
 
-   if(emf_readdata(argv[1],&contents,&length)){
+   if(emf_mapdata(argv[1],&contents,&length)){
       printf("reademf: fatal error: could not open or successfully read file:%s\n",argv[1]);
       exit(EXIT_FAILURE);
    }
 
    (void) myEnhMetaFileProc(contents,length);
 
-   free(contents);
+   (void) emf_unmapdata(contents,length);
 
    exit(EXIT_SUCCESS);
 }
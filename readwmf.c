@@ -64,14 +64,14 @@ int main(int argc, char *argv[]){
 size_t    length;
 char     *contents=NULL;
 
-   if(wmf_readdata(argv[1],&contents,&length)){
+   if(wmf_mapdata(argv[1],&contents,&length)){
       printf("readwmf: fatal error: could not open or successfully read file:%s\n",argv[1]);
       exit(EXIT_FAILURE);
    }
 
    (void) myMetaFileProc(contents,length);
 
-   free(contents);
+   (void) wmf_unmapdata(contents,length);
 
    exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,227 @@
+/**
+ Program used for testing the device context tracking in libUEMF, emf_dcstate_record() and U_DC_STATE.
+ It writes a short EMF file, test_dcstate.emf, which selects and deletes objects, saves and restores the
+ device context (also with a negative relative restore past more than one level), uses SETWORLDTRANSFORM
+ and every MODIFYWORLDTRANSFORM mode, and each of the clip records.  It then reads the file back, passes
+ each record to emf_dcstate_record(), and emits the tracked state after each one in text form.  That output
+ should be identical to test_dcstate_ref_emf.txt.
+
+ Run like:
+    test_dcstate_emf >test_dcstate_emf.txt
+
+ Compile with
+
+    gcc -O0 -g -std=c99 -Wall -pedantic -o test_dcstate_emf -I. test_dcstate_emf.c uemf.c uemf_endian.c uemf_safe.c uemf_utf.c -lm
+
+File:      test_dcstate_emf.c
+Version:   0.0.1
+Date:      17-OCT-2026
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "uemf.h"
+#include "uemf_safe.h"
+
+void taf(char *rec,EMFTRACK *et, char *text){  // Test, append, free
+    if(!rec){ printf("%s failed\n",text); return; }
+    (void) emf_append((PU_ENHMETARECORD)rec, et, 1);
+}
+
+/* Handle of an object, and where the record which created it is in the file, "stock" for a stock object */
+void print_object(const char *name, uint32_t ih, const char *record, const char *contents){
+    if(record){ printf(" %s:%u@%u", name, ih, (unsigned int)(record - contents)); }
+    else {      printf(" %s:%08X(stock)", name, ih);                           }
+}
+
+void print_xform(const char *name, U_XFORM xf){
+    printf("   %s: {%.4f,%.4f,%.4f,%.4f,%.4f,%.4f}\n", name, xf.eM11, xf.eM12, xf.eM21, xf.eM22, xf.eDx, xf.eDy);
+}
+
+void print_colorref(const char *name, U_COLORREF c){
+    printf(" %s:{%u,%u,%u}", name, c.Red, c.Green, c.Blue);
+}
+
+/* Emit the state in effect for the records which follow */
+void print_state(const U_DC_STATE *ds, const char *contents){
+    const U_DC *dc = &ds->dc[ds->level];
+    U_XFORM     xf;
+
+    printf("   level:%d inPath:%d objects:%u\n", ds->level, ds->inPath, ds->objects->count);
+    printf("  ");
+    print_object("pen",     dc->pen,     dc->penRecord,     contents);
+    print_object("brush",   dc->brush,   dc->brushRecord,   contents);
+    print_object("font",    dc->font,    dc->fontRecord,    contents);
+    print_object("palette", dc->palette, dc->paletteRecord, contents);
+    printf("\n");
+    printf("   mapMode:%u bkMode:%u polyFillMode:%u rop2:%u stretchMode:%u textAlign:%u arcDirection:%u miterLimit:%u\n",
+       dc->mapMode, dc->bkMode, dc->polyFillMode, dc->rop2, dc->stretchMode, dc->textAlign, dc->arcDirection, dc->miterLimit);
+    printf("  ");
+    print_colorref("textColor", dc->textColor);
+    print_colorref("bkColor",   dc->bkColor);
+    printf(" cur:{%d,%d}\n", dc->cur.x, dc->cur.y);
+    printf("   window org:{%d,%d} ext:{%d,%d} viewport org:{%d,%d} ext:{%d,%d}\n",
+       dc->windowOrg.x,   dc->windowOrg.y,   dc->windowExt.cx,   dc->windowExt.cy,
+       dc->viewportOrg.x, dc->viewportOrg.y, dc->viewportExt.cx, dc->viewportExt.cy);
+    print_xform("worldTransform", dc->worldTransform);
+    (void) emf_dcstate_xform(ds, &xf);
+    print_xform("device xform", xf);
+    if(dc->clipSet){
+       printf("   clip:{%d,%d,%d,%d} clipExact:%d\n", dc->clip.left, dc->clip.top, dc->clip.right, dc->clip.bottom, dc->clipExact);
+    }
+    else {
+       printf("   clip:none\n");
+    }
+}
+
+/* Write the test file, returns 0 on success */
+int write_test(const char *filename){
+    EMFTRACK           *et;
+    EMFHANDLES         *eht;
+    char               *rec;
+    U_SIZEL             szlDev, szlMm;
+    U_RECTL             rclBounds, rclFrame, rclRgn;
+    U_RGNDATAHEADER     rdh;
+    PU_RGNDATA          RgnData;
+    uint16_t           *Description;
+    uint32_t            cbDesc;
+    uint32_t            pen, brush, deleted;
+    U_XFORM             scale2   = xform_set(2.0, 0.0, 0.0, 2.0,    0.0,   0.0);
+    U_XFORM             shift    = xform_set(1.0, 0.0, 0.0, 1.0,  100.0,  50.0);
+    U_XFORM             rotate90 = xform_set(0.0, 1.0,-1.0, 0.0,   10.0,  20.0);
+    U_XFORM             mirror   = xform_set(-1.0,0.0, 0.0, 1.0, 1000.0,   0.0);
+
+    if(emf_start(filename, 10000, 10000, &et))return(1);
+    if(emf_htable_create(128, 128, &eht))return(1);
+
+    (void) device_size(216, 279, 47.244094, &szlDev, &szlMm);
+    (void) drawing_size(297, 210, 47.244094, &rclBounds, &rclFrame);
+    Description = U_Utf8ToUtf16le("Test EMF\1produced by libUEMF test_dcstate_emf program\1",0, NULL);
+    cbDesc = 2 + wchar16len(Description);  // also count the final terminator
+    (void) U_Utf16leEdit(Description, U_Utf16le(1), 0);
+    rec = U_EMRHEADER_set( rclBounds,  rclFrame,  NULL, cbDesc, Description, szlDev, szlMm, 0);
+    taf(rec,et,"U_EMRHEADER_set");
+    free(Description);
+
+    // page transform, modes, and colors
+    rec = U_EMRSETMAPMODE_set(U_MM_ANISOTROPIC);                          taf(rec,et,"U_EMRSETMAPMODE_set");
+    rec = U_EMRSETWINDOWEXTEX_set(sizel_set(2000,1000));                  taf(rec,et,"U_EMRSETWINDOWEXTEX_set");
+    rec = U_EMRSETVIEWPORTEXTEX_set(sizel_set(1000,1000));                taf(rec,et,"U_EMRSETVIEWPORTEXTEX_set");
+    rec = U_EMRSETWINDOWORGEX_set(point32_set(100,200));                  taf(rec,et,"U_EMRSETWINDOWORGEX_set");
+    rec = U_EMRSETVIEWPORTORGEX_set(point32_set(10,20));                  taf(rec,et,"U_EMRSETVIEWPORTORGEX_set");
+    rec = U_EMRSETBKMODE_set(U_TRANSPARENT);                              taf(rec,et,"U_EMRSETBKMODE_set");
+    rec = U_EMRSETTEXTCOLOR_set(U_RGB(255,0,0));                          taf(rec,et,"U_EMRSETTEXTCOLOR_set");
+    rec = U_EMRSETBKCOLOR_set(U_RGB(0,0,255));                            taf(rec,et,"U_EMRSETBKCOLOR_set");
+
+    // objects, selected, saved with the DC, then deleted
+    rec = createpen_set(&pen, eht, logpen_set(U_PS_SOLID, point_set(5,5), U_RGB(0,255,0)));
+    taf(rec,et,"createpen_set");
+    rec = createbrushindirect_set(&brush, eht, logbrush_set(U_BS_SOLID, U_RGB(255,255,0), U_HS_SOLIDCLR));
+    taf(rec,et,"createbrushindirect_set");
+    rec = selectobject_set(pen, eht);                                     taf(rec,et,"selectobject_set");
+    rec = selectobject_set(brush, eht);                                   taf(rec,et,"selectobject_set");
+    rec = selectobject_set(U_ANSI_VAR_FONT, eht);                         taf(rec,et,"selectobject_set");
+    rec = U_EMRMOVETOEX_set(point32_set(30,40));                          taf(rec,et,"U_EMRMOVETOEX_set");
+
+    // level 1: world transforms, every MODIFYWORLDTRANSFORM mode, and a clip through a rotation
+    rec = U_EMRSAVEDC_set();                                              taf(rec,et,"U_EMRSAVEDC_set");
+    rec = U_EMRSETWORLDTRANSFORM_set(scale2);                             taf(rec,et,"U_EMRSETWORLDTRANSFORM_set");
+    rec = U_EMRMODIFYWORLDTRANSFORM_set(shift, U_MWT_LEFTMULTIPLY);       taf(rec,et,"U_EMRMODIFYWORLDTRANSFORM_set");
+    rec = U_EMRMODIFYWORLDTRANSFORM_set(rotate90, U_MWT_RIGHTMULTIPLY);   taf(rec,et,"U_EMRMODIFYWORLDTRANSFORM_set");
+    rec = U_EMRINTERSECTCLIPRECT_set(rectl_set(point32_set(0,0),point32_set(400,300)));
+    taf(rec,et,"U_EMRINTERSECTCLIPRECT_set");
+    rec = U_EMRSELECTOBJECT_set(U_BLACK_PEN);                             taf(rec,et,"U_EMRSELECTOBJECT_set");
+    rec = U_EMRSETTEXTCOLOR_set(U_RGB(0,128,0));                          taf(rec,et,"U_EMRSETTEXTCOLOR_set");
+
+    // level 2: a region replaces the clip, then axis aligned clips
+    rec = U_EMRSAVEDC_set();                                              taf(rec,et,"U_EMRSAVEDC_set");
+    rec = U_EMRMODIFYWORLDTRANSFORM_set(scale2, U_MWT_IDENTITY);          taf(rec,et,"U_EMRMODIFYWORLDTRANSFORM_set");
+    rec = U_EMRSETMAPMODE_set(U_MM_TEXT);                                 taf(rec,et,"U_EMRSETMAPMODE_set");
+    rclRgn  = rectl_set(point32_set(0,0),point32_set(1000,1000));
+    rdh     = rgndataheader_set(1, rclRgn);
+    RgnData = rgndata_set(rdh, &rclRgn);
+    rec = U_EMREXTSELECTCLIPRGN_set(U_RGN_COPY, RgnData);                 taf(rec,et,"U_EMREXTSELECTCLIPRGN_set");
+    free(RgnData);
+    rec = U_EMRINTERSECTCLIPRECT_set(rectl_set(point32_set(100,100),point32_set(500,400)));
+    taf(rec,et,"U_EMRINTERSECTCLIPRECT_set");
+    rec = U_EMRINTERSECTCLIPRECT_set(rectl_set(point32_set(200,250),point32_set(600,500)));
+    taf(rec,et,"U_EMRINTERSECTCLIPRECT_set");
+    rec = U_EMROFFSETCLIPRGN_set(point32_set(-50,25));                    taf(rec,et,"U_EMROFFSETCLIPRGN_set");
+    rec = U_EMREXCLUDECLIPRECT_set(rectl_set(point32_set(260,280),point32_set(300,300)));
+    taf(rec,et,"U_EMREXCLUDECLIPRECT_set");
+
+    // level 3: region union and path clips, and the non standard U_MWT_SET mode
+    rec = U_EMRSAVEDC_set();                                              taf(rec,et,"U_EMRSAVEDC_set");
+    rclRgn  = rectl_set(point32_set(50,50),point32_set(150,150));
+    rdh     = rgndataheader_set(1, rclRgn);
+    RgnData = rgndata_set(rdh, &rclRgn);
+    rec = U_EMREXTSELECTCLIPRGN_set(U_RGN_OR, RgnData);                   taf(rec,et,"U_EMREXTSELECTCLIPRGN_set");
+    free(RgnData);
+    rec = U_EMRBEGINPATH_set();                                           taf(rec,et,"U_EMRBEGINPATH_set");
+    rec = U_EMRMOVETOEX_set(point32_set(20,20));                          taf(rec,et,"U_EMRMOVETOEX_set");
+    rec = U_EMRLINETO_set(point32_set(80,20));                            taf(rec,et,"U_EMRLINETO_set");
+    rec = U_EMRLINETO_set(point32_set(80,60));                            taf(rec,et,"U_EMRLINETO_set");
+    rec = U_EMRENDPATH_set();                                             taf(rec,et,"U_EMRENDPATH_set");
+    rec = U_EMRSELECTCLIPPATH_set(U_RGN_AND);                             taf(rec,et,"U_EMRSELECTCLIPPATH_set");
+    rec = U_EMRMODIFYWORLDTRANSFORM_set(mirror, 4);                       taf(rec,et,"U_EMRMODIFYWORLDTRANSFORM_set");
+
+    // back to level 1 in one step, then level 0, then one restore too many, which must fail
+    rec = U_EMRRESTOREDC_set(-2);                                         taf(rec,et,"U_EMRRESTOREDC_set");
+    rec = U_EMRRESTOREDC_set(-1);                                         taf(rec,et,"U_EMRRESTOREDC_set");
+    rec = U_EMRRESTOREDC_set(-1);                                         taf(rec,et,"U_EMRRESTOREDC_set");
+
+    // delete the selected pen, a later selection of it must fail
+    deleted = pen;
+    rec = deleteobject_set(&pen, eht);                                    taf(rec,et,"deleteobject_set");
+    rec = U_EMRSELECTOBJECT_set(deleted);                                 taf(rec,et,"U_EMRSELECTOBJECT_set");
+    rec = deleteobject_set(&brush, eht);                                  taf(rec,et,"deleteobject_set");
+
+    rec = U_EMREOF_set(0,NULL,et);                                        taf(rec,et,"U_EMREOF_set");
+    if(emf_finish(et, eht))return(1);
+    emf_free(&et);
+    emf_htable_free(&eht);
+    return(0);
+}
+
+int main(void){
+    char               *contents;
+    const char         *record;
+    size_t              length;
+    size_t              off;
+    uint32_t            nSize;
+    uint32_t            iType;
+    int                 recnum;
+    int                 status;
+    U_DC_STATE         *ds;
+    const char         *filename = "test_dcstate.emf";
+
+    if(write_test(filename)){
+       printf("test_dcstate_emf: could not write %s\n", filename);
+       exit(EXIT_FAILURE);
+    }
+    if(emf_readdata(filename, &contents, &length)){
+       printf("test_dcstate_emf: could not read %s\n", filename);
+       exit(EXIT_FAILURE);
+    }
+    if(emf_dcstate_create(&ds)){
+       printf("test_dcstate_emf: could not create the device context state\n");
+       exit(EXIT_FAILURE);
+    }
+    for(off = 0, recnum = 0; off + sizeof(U_EMR) <= length; off += nSize, recnum++){
+       record = contents + off;
+       memcpy(&iType, record,     4);
+       memcpy(&nSize, record + 4, 4);
+       if(nSize < sizeof(U_EMR) || nSize > length - off || !U_emf_record_safe(record)){
+          printf("test_dcstate_emf: bad record %d at offset %u\n", recnum, (unsigned int) off);
+          break;
+       }
+       status = emf_dcstate_record(ds, record, (uint32_t) off);
+       printf("%-30s record:%5d offset:%8u status:%d\n", U_emr_names(iType), recnum, (unsigned int) off, status);
+       print_state(ds, contents);
+       if(iType == U_EMR_EOF)break;
+    }
+    emf_dcstate_free(&ds);
+    free(contents);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,1032 @@
+/**
+ Program used for testing libUEMF functions which the testbeds do not reach by writing a file: indexes,
+ readers, caches, tables, and the like.  Each check is run against the reference files, or against data
+ made here, and one line is emitted per check, ending in OK or FAILED.  That output should be identical to
+ test_libuemf_api_ref.txt.
+
+ Run like:
+    test_libuemf_api [refdir] >test_libuemf_api.txt
+
+ refdir is the directory holding test_libuemf_ref.emf and the other reference files, default ".".  Scratch
+ files are written to the current directory and removed.  The exit status is EXIT_FAILURE if any check failed.
+
+ Compile with
+
+    gcc -O0 -g -std=c99 -Wall -pedantic -o test_libuemf_api -I. test_libuemf_api.c uemf.c uemf_endian.c uemf_safe.c uemf_utf.c -lm
+
+File:      test_libuemf_api.c
+Version:   0.0.1
+Date:      17-OCT-2026
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "uemf.h"
+#include "uemf_safe.h"
+#include "uwmf.h"       // U_WMR_* record types, for the WMF style object table
+
+#define SCRATCH_IDX  "test_libuemf_api.idx"
+#define SCRATCH_EMF  "test_libuemf_api.emf"
+
+static int failures = 0;
+
+/* Emit one check */
+void report(const char *section, const char *what, int ok){
+    printf("%-16s %-64s %s\n", section, what, (ok ? "OK" : "FAILED"));
+    if(!ok)failures++;
+}
+
+/* Read a reference file from refdir.  Returns 0 on success. */
+int read_ref(const char *refdir, const char *name, char **contents, size_t *length){
+    char path[4096];
+    if((size_t) snprintf(path, sizeof(path), "%s/%s", refdir, name) >= sizeof(path))return(1);
+    if(emf_readdata(path, contents, length)){
+       printf("test_libuemf_api: could not read %s\n", path);
+       failures++;
+       return(1);
+    }
+    return(0);
+}
+
+/* Write bytes to a scratch file.  Returns 0 on success. */
+int write_scratch(const char *name, const void *data, size_t bytes){
+    FILE *fp = fopen(name, "wb");
+    int   status = 0;
+    if(!fp)return(1);
+    if(bytes && 1 != fwrite(data, bytes, 1, fp))status = 1;
+    if(fclose(fp))status = 1;
+    return(status);
+}
+
+/* Read a whole scratch file.  Returns 0 on success. */
+int read_scratch(const char *name, char **data, size_t *bytes){
+    FILE *fp = fopen(name, "rb");
+    long  size;
+    *data = NULL;
+    if(!fp)return(1);
+    if(fseek(fp, 0, SEEK_END) || (size = ftell(fp)) < 0){ fclose(fp); return(1); }
+    rewind(fp);
+    *bytes = size;
+    *data  = malloc(size + 1);
+    if(!*data || (size && 1 != fread(*data, size, 1, fp))){ free(*data); *data = NULL; fclose(fp); return(1); }
+    fclose(fp);
+    return(0);
+}
+
+/* Compare an index with a walk of the records by nSize.  Returns 1 if every entry matches. */
+int index_matches(const EMFINDEX *ei, const char *contents, size_t length){
+    size_t    off;
+    uint32_t  i, iType, nSize;
+    size_t    spanoff, spanlen;
+
+    if(ei->length != length)return(0);
+    for(off = 0, i = 0; off + 8 <= length; i++){
+       memcpy(&iType, contents + off,     4);
+       memcpy(&nSize, contents + off + 4, 4);
+       if(nSize < 8 || i >= ei->count || ei->recs[i].offset != off || ei->recs[i].iType != iType || ei->recs[i].nSize != nSize)return(0);
+       if(emf_index_record(contents, ei, i) != contents + off)return(0);
+       off += nSize;
+       if(iType == U_EMR_EOF){ i++; break; }
+    }
+    if(!i || i != ei->count || emf_index_record(contents, ei, i))return(0);
+    if(emf_index_span(ei, 0, ei->count - 1, &spanoff, &spanlen) || spanoff != 0 || spanlen != off)return(0);
+    return(1);
+}
+
+/* Set a 32 bit field in file data to v, Little Endian as in EMF files and in the files emf_index_save() writes */
+void put_le32(char *p, uint32_t v){
+    p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; p[2] = (v >> 16) & 0xFF; p[3] = (v >> 24) & 0xFF;
+}
+
+/* Get a 32 bit Little Endian field, as in EMF+ records, which stay Little Endian in memory */
+uint32_t get_le32(const char *p){
+    const unsigned char *u = (const unsigned char *) p;
+    return(u[0] | (u[1] << 8) | (u[2] << 16) | ((uint32_t) u[3] << 24));
+}
+
+/* emf_index_build(), emf_index_save(), and emf_index_load(), also with damaged sidecars and records */
+void test_index(const char *refdir){
+    char       *contents, *bad, *sidecar, *other;
+    size_t      length, bytes, otherlen;
+    uint32_t    nSize;
+    EMFINDEX   *ei, *ei2;
+    uint32_t    i;
+    int         ok;
+
+    if(read_ref(refdir, "test_libuemf_ref.emf", &contents, &length))return;
+
+    ok = !emf_index_build(contents, length, &ei);
+    report("emf_index", "build test_libuemf_ref.emf", ok);
+    if(!ok){ free(contents); return; }
+    report("emf_index", "every entry matches a walk by nSize", index_matches(ei, contents, length));
+
+    ok = !emf_index_save(SCRATCH_IDX, ei) && !emf_index_load(SCRATCH_IDX, &ei2);
+    report("emf_index", "save and load", ok);
+    if(ok){
+       report("emf_index", "loaded index matches a walk by nSize", index_matches(ei2, contents, length));
+       for(ok = (ei2->count == ei->count), i = 0; ok && i < ei->count; i++){
+          ok = !memcmp(&ei->recs[i], &ei2->recs[i], sizeof(EMFINDEXREC));
+       }
+       report("emf_index", "loaded index equals the built one", ok);
+       if(!read_ref(refdir, "test_libuemf_p_ref.emf", &other, &otherlen)){
+          report("emf_index", "stale sidecar detected by its length", ei2->length != otherlen);
+          report("emf_index", "stale sidecar does not match another EMF", !index_matches(ei2, other, otherlen));
+          free(other);
+       }
+       emf_index_free(&ei2);
+    }
+
+    if(!read_scratch(SCRATCH_IDX, &sidecar, &bytes)){
+       (void) write_scratch(SCRATCH_IDX, sidecar, 10);
+       report("emf_index", "sidecar truncated in its header rejected", emf_index_load(SCRATCH_IDX, &ei2) == 3 && !ei2);
+       (void) write_scratch(SCRATCH_IDX, sidecar, bytes - 12);
+       report("emf_index", "sidecar missing its last entry rejected", emf_index_load(SCRATCH_IDX, &ei2) == 3 && !ei2);
+       sidecar[0] ^= 0xFF;
+       (void) write_scratch(SCRATCH_IDX, sidecar, bytes);
+       report("emf_index", "sidecar with a bad magic number rejected", emf_index_load(SCRATCH_IDX, &ei2) == 4 && !ei2);
+       sidecar[0] ^= 0xFF;
+       put_le32(sidecar + 12, UINT32_MAX);
+       (void) write_scratch(SCRATCH_IDX, sidecar, bytes);
+       report("emf_index", "sidecar with an impossible count rejected", emf_index_load(SCRATCH_IDX, &ei2) == 4 && !ei2);
+       put_le32(sidecar + 12, ei->count);
+       put_le32(sidecar + 16 + 12*3 + 8, ei->recs[3].nSize + 4);   // nSize of record 3
+       (void) write_scratch(SCRATCH_IDX, sidecar, bytes);
+       report("emf_index", "sidecar with a wrong record size rejected", emf_index_load(SCRATCH_IDX, &ei2) == 4 && !ei2);
+       put_le32(sidecar + 16 + 12*3 + 8, ei->recs[3].nSize);
+       put_le32(sidecar + 16 + 12*(ei->count - 1) + 8, length);   // last record runs past the end of the EMF
+       (void) write_scratch(SCRATCH_IDX, sidecar, bytes);
+       report("emf_index", "sidecar with a record past the end rejected", emf_index_load(SCRATCH_IDX, &ei2) == 4 && !ei2);
+       free(sidecar);
+    }
+    else {
+       report("emf_index", "read back the sidecar", 0);
+    }
+    remove(SCRATCH_IDX);
+
+    bad = malloc(length);
+    if(bad){
+       memcpy(bad, contents, length);
+       nSize = ei->recs[5].nSize + 2;
+       memcpy(bad + ei->recs[5].offset + 4, &nSize, 4);
+       report("emf_index", "record size not a multiple of 4 rejected", emf_index_build(bad, length, &ei2) == 3 && !ei2);
+       nSize = length;
+       memcpy(bad + ei->recs[5].offset + 4, &nSize, 4);
+       report("emf_index", "record past the end of the EMF rejected", emf_index_build(bad, length, &ei2) == 3 && !ei2);
+       nSize = 4;
+       memcpy(bad + ei->recs[5].offset + 4, &nSize, 4);
+       report("emf_index", "record smaller than U_EMR rejected", emf_index_build(bad, length, &ei2) == 3 && !ei2);
+       free(bad);
+    }
+    emf_index_free(&ei);
+    free(contents);
+}
+
+/*  Read the EMF file name with an EMFREADER, using a FILE or, if usefd, its file descriptor, and compare each
+    record with the one at the same place in contents, from emf_readdata().  Returns the status of the last
+    emf_reader_next() call, -1 if a record differs, -2 if the file could not be opened.  *records is set to
+    the number of records returned. */
+int reader_walk(const char *name, size_t chunksize, size_t maxrecsize, int usefd,
+      const char *contents, size_t length, uint32_t *records){
+    FILE       *fp;
+    EMFREADER  *er;
+    char       *rec;
+    size_t      off = 0;
+    uint32_t    nSize;
+    int         status;
+
+    *records = 0;
+    fp = fopen(name, "rb");
+    if(!fp)return(-2);
+    if(usefd){ status = emf_reader_fdopen(fileno(fp), chunksize, maxrecsize, &er); }
+    else {     status = emf_reader_open(fp, chunksize, maxrecsize, &er);          }
+    if(status){ fclose(fp); return(-2); }
+    while(!(status = emf_reader_next(er, &rec))){
+       memcpy(&nSize, rec + 4, 4);
+       if(er->offset != off || off + nSize > length || memcmp(rec, contents + off, nSize) || er->recnum != *records + 1){
+          status = -1;
+          break;
+       }
+       off += nSize;
+       (*records)++;
+    }
+    emf_reader_close(&er);
+    fclose(fp);
+    return(status);
+}
+
+/* emf_reader_open(), emf_reader_fdopen(), and emf_reader_next() compared with emf_readdata(), and truncated or corrupt files */
+void test_reader(const char *refdir){
+    static const char *names[] = { "test_libuemf_ref.emf", "test_libuemf_ref30.emf", "test_libuemf_p_ref.emf" };
+    char       *contents, *bad;
+    char        path[4096];
+    char        what[128];
+    size_t      length, rawlength;
+    uint32_t    records, expected, nSize;
+    EMFINDEX   *ei;
+    int         i, status;
+
+    for(i = 0; i < (int)(sizeof(names)/sizeof(names[0])); i++){
+       if(read_ref(refdir, names[i], &contents, &length))continue;
+       if(emf_index_build(contents, length, &ei)){
+          report("emf_reader", "index the reference file", 0);
+          free(contents);
+          continue;
+       }
+       expected = ei->count;
+       (void) snprintf(path, sizeof(path), "%s/%s", refdir, names[i]);
+       status = reader_walk(path, 8, 0, 0, contents, length, &records);
+       (void) snprintf(what, sizeof(what), "%s, FILE, smallest chunks", names[i]);
+       report("emf_reader", what, status == 1 && records == expected);
+       status = reader_walk(path, 65536, 0, 1, contents, length, &records);
+       (void) snprintf(what, sizeof(what), "%s, file descriptor, 64k chunks", names[i]);
+       report("emf_reader", what, status == 1 && records == expected);
+       emf_index_free(&ei);
+       free(contents);
+    }
+
+    if(read_ref(refdir, "test_libuemf_ref.emf", &contents, &length))return;
+    (void) snprintf(path, sizeof(path), "%s/%s", refdir, "test_libuemf_ref.emf");
+    if(emf_index_build(contents, length, &ei) || read_scratch(path, &bad, &rawlength)){
+       report("emf_reader", "read test_libuemf_ref.emf", 0);
+       free(contents);
+       return;
+    }
+
+    // cut the file in the middle of record 10, the records before it must still be returned
+    (void) write_scratch(SCRATCH_EMF, bad, ei->recs[10].offset + ei->recs[10].nSize/2);
+    status = reader_walk(SCRATCH_EMF, 1024, 0, 0, contents, length, &records);
+    report("emf_reader", "file truncated inside a record", status == 3 && records == 10);
+    (void) write_scratch(SCRATCH_EMF, bad, ei->recs[10].offset + 6);
+    status = reader_walk(SCRATCH_EMF, 1024, 0, 1, contents, length, &records);
+    report("emf_reader", "file truncated inside a record header", status == 3 && records == 10);
+    (void) write_scratch(SCRATCH_EMF, bad, ei->recs[ei->count - 1].offset);
+    status = reader_walk(SCRATCH_EMF, 1024, 0, 0, contents, length, &records);
+    report("emf_reader", "file ending without U_EMR_EOF", status == 1 && records == ei->count - 1);
+
+    // a record larger than maxrecsize, and records with impossible sizes
+    for(nSize = 0, i = 0; i < (int) ei->count; i++){ if(ei->recs[i].nSize > nSize)nSize = ei->recs[i].nSize; }
+    status = reader_walk(path, 1024, nSize - 4, 0, contents, length, &records);
+    report("emf_reader", "record larger than maxrecsize rejected", status == 4);
+    put_le32(bad + ei->recs[10].offset + 4, 4);
+    (void) write_scratch(SCRATCH_EMF, bad, rawlength);
+    status = reader_walk(SCRATCH_EMF, 1024, 0, 0, contents, length, &records);
+    report("emf_reader", "record smaller than U_EMR rejected", status == 4 && records == 10);
+    put_le32(bad + ei->recs[10].offset + 4, UINT32_MAX - 3);
+    (void) write_scratch(SCRATCH_EMF, bad, rawlength);
+    status = reader_walk(SCRATCH_EMF, 1024, 0, 0, contents, length, &records);
+    report("emf_reader", "record larger than the file rejected", status == 3 && records == 10);
+    free(bad);
+    remove(SCRATCH_EMF);
+    emf_index_free(&ei);
+    free(contents);
+}
+
+/*  Walks the records of an EMF in memory as one stream, ignoring how EMF+ records are grouped into U_EMRCOMMENTs. */
+typedef struct {
+    const char *contents;
+    size_t      length;
+    size_t      off;           // next EMF record
+    size_t      poff;          // next EMF+ record in the current EMF+ comment
+    size_t      pend;          // end of the EMF+ records in the current EMF+ comment
+    uint32_t    comments;      // EMF+ comments seen
+} RECSTREAM;
+
+/*  Get the next record, EMF or EMF+, from rs.  Returns 1 and sets *rec and *size, 0 at the end, -1 on a bad record. */
+int recstream_next(RECSTREAM *rs, const char **rec, uint32_t *size){
+    uint32_t  iType, nSize, cbData;
+    while(1){
+       if(rs->poff < rs->pend){
+          if(rs->poff + 12 > rs->pend)return(-1);
+          *size = get_le32(rs->contents + rs->poff + 4);
+          if(*size < 12 || *size > rs->pend - rs->poff)return(-1);
+          *rec      = rs->contents + rs->poff;
+          rs->poff += UP4(*size);   // a packed comment pads each EMF+ record
+          return(1);
+       }
+       if(rs->off + 8 > rs->length)return(0);
+       memcpy(&iType, rs->contents + rs->off,     4);
+       memcpy(&nSize, rs->contents + rs->off + 4, 4);
+       if(nSize < 8 || nSize > rs->length - rs->off)return(-1);
+       if(iType == U_EMR_COMMENT && nSize >= 16 && !memcmp(rs->contents + rs->off + 12, "EMF+", 4)){
+          memcpy(&cbData, rs->contents + rs->off + 8, 4);
+          if(cbData < 4 || cbData > nSize - 12)return(-1);
+          rs->poff = rs->off + 16;
+          rs->pend = rs->off + 12 + cbData;
+          rs->off += nSize;
+          rs->comments++;
+          continue;
+       }
+       *rec     = rs->contents + rs->off;
+       *size    = nSize;
+       rs->off += nSize;
+       if(iType == U_EMR_EOF)rs->length = rs->off;
+       return(1);
+    }
+}
+
+/*  Compare two EMFs as record streams.  The headers may differ only in nBytes and nRecords, and U_EMR_EOF only in
+    nSizeLast, its last field.  Returns the number of records compared, or -1 if the streams differ. */
+int recstream_compare(RECSTREAM *rs1, RECSTREAM *rs2){
+    const char *rec1, *rec2;
+    uint32_t    size1, size2, iType;
+    int         status1, status2;
+    int         count;
+    for(count = 0; ; count++){
+       status1 = recstream_next(rs1, &rec1, &size1);
+       status2 = recstream_next(rs2, &rec2, &size2);
+       if(status1 != status2 || status1 < 0)return(-1);
+       if(!status1)break;
+       if(size1 != size2)return(-1);
+       if(!count){   // U_EMRHEADER, nBytes and nRecords are at 48 and 52
+          if(size1 < 56 || memcmp(rec1, rec2, 48) || memcmp(rec1 + 56, rec2 + 56, size1 - 56))return(-1);
+       }
+       else {
+          memcpy(&iType, rec1, 4);
+          if(iType == U_EMR_EOF){ size1 -= 4; }   // EMF+ record types are never this small
+          if(memcmp(rec1, rec2, size1))return(-1);
+       }
+    }
+    return(count);
+}
+
+/* Output of testbed_pmf with and without U_PMR_pack() */
+void test_pack(const char *refdir){
+    char       *contents, *packed;
+    size_t      length, packedlen;
+    RECSTREAM   rs1, rs2;
+    EMFINDEX   *ei1 = NULL, *ei2 = NULL;
+    uint32_t    i;
+    int         count, ok;
+
+    if(read_ref(refdir, "test_libuemf_p_ref.emf", &contents, &length))return;
+    if(read_ref(refdir, "test_libuemf_p_pack_ref.emf", &packed, &packedlen)){ free(contents); return; }
+
+    memset(&rs1, 0, sizeof(RECSTREAM)); rs1.contents = contents; rs1.length = length;
+    memset(&rs2, 0, sizeof(RECSTREAM)); rs2.contents = packed;   rs2.length = packedlen;
+    count = recstream_compare(&rs1, &rs2);
+    report("U_PMR_pack", "packed and unpacked decode to the same records", count > 0);
+    report("U_PMR_pack", "packing leaves fewer EMF+ comments", rs2.comments < rs1.comments);
+
+    ok = !emf_index_build(contents, length, &ei1) && !emf_index_build(packed, packedlen, &ei2);
+    report("U_PMR_pack", "index both files", ok);
+    if(ok){
+       report("U_PMR_pack", "packing leaves fewer EMF records", ei2->count < ei1->count);
+       for(i = 0; ok && i < ei2->count; i++){   // 64k limit, unless a comment holds only one EMF+ record
+          if(ei2->recs[i].iType != U_EMR_COMMENT || ei2->recs[i].nSize <= 65536)continue;
+          ok = (UP4(get_le32(packed + ei2->recs[i].offset + 16 + 4)) + 16 + 4 == ei2->recs[i].nSize);
+       }
+       report("U_PMR_pack", "no packed comment larger than 64k", ok);
+    }
+    emf_index_free(&ei1);
+    emf_index_free(&ei2);
+    free(packed);
+    free(contents);
+}
+
+/* Fill buf with bytes from a fixed pseudo random sequence, so that every run makes the same images */
+void fill_random(char *buf, size_t bytes, uint32_t seed){
+    for(; bytes; bytes--, buf++){
+       seed = seed * 1103515245 + 12345;
+       *buf = (seed >> 16) & 0xFF;
+    }
+}
+
+/*  Convert px, a DIB, to RGBA with DIB_to_RGBA() and with DIB_to_RGBA_mt() using each of nthreads[], both row orders.
+    Returns 1 if every result is identical. */
+int dib_to_rgba_same(const char *px, const U_RGBQUAD *ct, int numCt, int w, int h, uint32_t colortype,
+      const int *nthreads, int nn){
+    char   *rgba1, *rgba2;
+    int     invert, i, ok = 1;
+    for(invert = 0; ok && invert < 2; invert++){
+       if(DIB_to_RGBA(px, ct, numCt, &rgba1, w, h, colortype, numCt, invert))return(0);
+       for(i = 0; ok && i < nn; i++){
+          ok = !DIB_to_RGBA_mt(px, ct, numCt, &rgba2, w, h, colortype, numCt, invert, nthreads[i]) &&
+               !memcmp(rgba1, rgba2, (size_t) w * 4 * h);
+          free(rgba2);
+       }
+       free(rgba1);
+    }
+    return(ok);
+}
+
+/*  Convert rgba to a DIB with RGBA_to_DIB() and with RGBA_to_DIB_mt() using each of nthreads[], both row orders.
+    Returns 1 if every result, pixels and color table, is identical. */
+int rgba_to_dib_same(const char *rgba, int w, int h, uint32_t colortype, int use_ct, const int *nthreads, int nn){
+    char       *px1, *px2;
+    uint32_t    cbPx1, cbPx2;
+    PU_RGBQUAD  ct1, ct2;
+    int         numCt1, numCt2;
+    int         invert, i, ok = 1;
+    for(invert = 0; ok && invert < 2; invert++){
+       if(RGBA_to_DIB(&px1, &cbPx1, &ct1, &numCt1, rgba, w, h, w*4, colortype, use_ct, invert))return(0);
+       for(i = 0; ok && i < nn; i++){
+          ok = !RGBA_to_DIB_mt(&px2, &cbPx2, &ct2, &numCt2, rgba, w, h, w*4, colortype, use_ct, invert, nthreads[i]) &&
+               cbPx1 == cbPx2 && !memcmp(px1, px2, cbPx1) && numCt1 == numCt2 &&
+               (!numCt1 || !memcmp(ct1, ct2, numCt1 * sizeof(U_RGBQUAD)));
+          free(px2);
+          free(ct2);
+       }
+       free(px1);
+       free(ct1);
+    }
+    return(ok);
+}
+
+/*  DIB_to_RGBA_mt() and RGBA_to_DIB_mt() against the single thread versions.  The large image is big enough for 7
+    bands, with a height that no thread count divides evenly.  The small one is always done on the calling thread. */
+void test_dib_mt(void){
+    static const int  nthreads[] = { 1, 2, 3, 4, 7, 0 };
+    static const int  bits[]     = { U_BCBM_MONOCHROME, U_BCBM_COLOR4, U_BCBM_COLOR8, U_BCBM_COLOR16, U_BCBM_COLOR24, U_BCBM_COLOR32 };
+    const int         nn = sizeof(nthreads)/sizeof(nthreads[0]);
+    const int         W = 1283, H = 1531, w = 17, h = 13;
+    U_RGBQUAD         ct[256];
+    char             *big, *small;
+    int               numCt, i;
+    char              what[128];
+
+    big   = malloc((size_t) W * 4 * H);   // large enough for any DIB of the same size
+    small = malloc((size_t) w * 4 * h);
+    if(!big || !small){ report("DIB_mt", "allocate the test images", 0); free(big); free(small); return; }
+    fill_random((char *) ct, sizeof(ct), 1);
+    fill_random(big,   (size_t) W * 4 * H, 2);
+    fill_random(small, (size_t) w * 4 * h, 3);
+
+    for(i = 0; i < (int)(sizeof(bits)/sizeof(bits[0])); i++){
+       numCt = (bits[i] <= U_BCBM_COLOR8 ? 1 << bits[i] : 0);
+       (void) snprintf(what, sizeof(what), "DIB_to_RGBA_mt %2d bit %dx%d, 1,2,3,4,7,all threads", bits[i], W, H);
+       report("DIB_mt", what, dib_to_rgba_same(big, (numCt ? ct : NULL), numCt, W, H, bits[i], nthreads, nn));
+    }
+    report("DIB_mt", "DIB_to_RGBA_mt 24 bit 17x13, single thread fallback",
+       dib_to_rgba_same(small, NULL, 0, w, h, U_BCBM_COLOR24, nthreads, nn));
+
+    for(i = 3; i < (int)(sizeof(bits)/sizeof(bits[0])); i++){
+       (void) snprintf(what, sizeof(what), "RGBA_to_DIB_mt %2d bit %dx%d, 1,2,3,4,7,all threads", bits[i], W, H);
+       report("DIB_mt", what, rgba_to_dib_same(big, W, H, bits[i], U_CT_NO, nthreads, nn));
+    }
+    report("DIB_mt", "RGBA_to_DIB_mt 32 bit 17x13, single thread fallback",
+       rgba_to_dib_same(small, w, h, U_BCBM_COLOR32, U_CT_NO, nthreads, nn));
+
+    // color tables are built serially, RGBA_to_DIB_mt() hands these to RGBA_to_DIB().  16 grays fit in the table.
+    for(i = 0; i < W * 64; i++){ big[4*i] = big[4*i + 1] = big[4*i + 2] = (big[4*i] & 0xF0); big[4*i + 3] = 0; }
+    report("DIB_mt", "RGBA_to_DIB_mt  8 bit with a color table",
+       rgba_to_dib_same(big, W, 64, U_BCBM_COLOR8, U_CT_BGRA, nthreads, nn));
+
+    free(big);
+    free(small);
+}
+
+/*  Convert DIB row k to RGBA pixel by pixel, independently of DIB_rows_get(), which DIB_to_RGBA() also uses.
+    16 bit pixels are 5,5,5 with the top bit ignored, pixels without an alpha value get 0. */
+void dib_row_reference(const uint8_t *px, const U_RGBQUAD *ct, int w, uint32_t colortype, uint8_t *rgba){
+    U_RGBQUAD  color;
+    uint16_t   v16;
+    int        j, index;
+    for(j = 0; j < w; j++, rgba += 4){
+       switch(colortype){
+          case U_BCBM_MONOCHROME: index = (px[j/8] >> (7 - j%8)) & 0x1;       break;
+          case U_BCBM_COLOR4:     index = (px[j/2] >> (j%2 ? 0 : 4)) & 0xF;   break;
+          case U_BCBM_COLOR8:     index = px[j];                              break;
+          default:                index = -1;                                 break;
+       }
+       if(index >= 0){
+          color = ct[index];
+       }
+       else if(colortype == U_BCBM_COLOR16){
+          v16            = px[2*j] | (px[2*j + 1] << 8);
+          color.Blue     = ( v16        & 0x1F) << 3;
+          color.Green    = ((v16 >>  5) & 0x1F) << 3;
+          color.Red      = ((v16 >> 10) & 0x1F) << 3;
+          color.Reserved = 0;
+       }
+       else if(colortype == U_BCBM_COLOR24){
+          color.Blue = px[3*j]; color.Green = px[3*j + 1]; color.Red = px[3*j + 2]; color.Reserved = 0;
+       }
+       else {
+          color.Blue = px[4*j]; color.Green = px[4*j + 1]; color.Red = px[4*j + 2]; color.Reserved = px[4*j + 3];
+       }
+       rgba[0] = color.Red;
+       rgba[1] = color.Green;
+       rgba[2] = color.Blue;
+       rgba[3] = color.Reserved;
+    }
+}
+
+/*  Read every row of the DIB in a U_EMRSTRETCHDIBITS record with DIB_rows_next(), then again in reverse order with
+    DIB_rows_get(), and compare them with dib_row_reference().  Returns 1 if all match and the ends are reported. */
+int dib_rows_match(const char *record, int w, int h, uint32_t colortype, int topdown){
+    PU_EMRSTRETCHDIBITS  pEmr = (PU_EMRSTRETCHDIBITS) record;
+    const uint8_t       *px   = (const uint8_t *) record + pEmr->offBitsSrc;
+    const U_RGBQUAD     *ct   = (const U_RGBQUAD *)(record + pEmr->offBmiSrc + sizeof(U_BITMAPINFOHEADER));
+    U_DIBROWS            dr, dr2;
+    uint8_t              expect[4*64], got[4*64];
+    int                  numCt = (colortype <= U_BCBM_COLOR8 ? 1 << colortype : 0);
+    int                  rowbytes = UP4((w*colortype + 7)/8);
+    int                  i, ok;
+
+    ok = !DIB_rows_from_record(&dr, record, pEmr->offBitsSrc, pEmr->offBmiSrc) &&
+         dr.w == w && dr.h == h && dr.invert == topdown && dr.rowbytes == rowbytes &&
+         !DIB_rows_init(&dr2, (const char *) px, (numCt ? ct : NULL), numCt, w, h, colortype, numCt, topdown) &&
+         !memcmp(&dr, &dr2, sizeof(U_DIBROWS));
+    for(i = 0; ok && i < h; i++){
+       dib_row_reference(px + rowbytes * (topdown ? h - 1 - i : i), ct, w, colortype, expect);
+       ok = !DIB_rows_next(&dr, (char *) got) && !memcmp(expect, got, 4*w);
+    }
+    ok = ok && DIB_rows_next(&dr, (char *) got) == 1;
+    for(i = h - 1; ok && i >= 0; i--){
+       dib_row_reference(px + rowbytes * (topdown ? h - 1 - i : i), ct, w, colortype, expect);
+       ok = !DIB_rows_get(&dr, i, (char *) got) && !memcmp(expect, got, 4*w);
+    }
+    return(ok && DIB_rows_get(&dr, h, (char *) got) == 1 && DIB_rows_get(&dr, -1, (char *) got) == 1);
+}
+
+/*  DIB_rows_init(), DIB_rows_from_record(), DIB_rows_get() and DIB_rows_next() for each bit depth, bottom up and top
+    down, on U_EMRSTRETCHDIBITS records.  The width leaves every row but the 32 bit ones padded.  Then the records
+    are cut short: U_emf_record_safe() must accept a last row without its padding and reject anything less. */
+void test_dib_rows(void){
+    static const int     bits[] = { U_BCBM_MONOCHROME, U_BCBM_COLOR4, U_BCBM_COLOR8, U_BCBM_COLOR16, U_BCBM_COLOR24, U_BCBM_COLOR32 };
+    const int            w = 13, h = 5;
+    U_RGBQUAD            ct[256];
+    U_BITMAPINFOHEADER   Bmih;
+    PU_BITMAPINFO        Bmi;
+    PU_EMRSTRETCHDIBITS  pEmr;
+    char                 px[4*13*5];
+    char                *rec;
+    int                  numCt, usedbytes, rowbytes, i, topdown;
+    uint32_t             nSize, cbBits;
+    char                 what[128];
+
+    fill_random((char *) ct, sizeof(ct), 4);
+    for(i = 0; i < (int)(sizeof(bits)/sizeof(bits[0])); i++){
+       numCt     = (bits[i] <= U_BCBM_COLOR8 ? 1 << bits[i] : 0);
+       usedbytes = (w*bits[i] + 7)/8;
+       rowbytes  = UP4(usedbytes);
+       for(topdown = 0; topdown < 2; topdown++){
+          fill_random(px, sizeof(px), 5 + i);
+          Bmih = bitmapinfoheader_set(w, (topdown ? -h : h), 1, bits[i], U_BI_RGB, rowbytes*h, 47244, 47244, numCt, 0);
+          Bmi  = bitmapinfo_set(Bmih, (numCt ? ct : NULL));
+          rec  = U_EMRSTRETCHDIBITS_set(U_RCL_DEF, pointl_set(0,0), pointl_set(w,h), pointl_set(0,0), pointl_set(w,h),
+                    U_DIB_RGB_COLORS, U_SRCCOPY, Bmi, rowbytes*h, px);
+          free(Bmi);
+          (void) snprintf(what, sizeof(what), "%2d bit %dx%d %s", bits[i], w, h, (topdown ? "top down" : "bottom up"));
+          if(!rec){ report("DIB_rows", what, 0); continue; }
+          report("DIB_rows", what, U_emf_record_safe(rec) && dib_rows_match(rec, w, h, bits[i], topdown));
+
+          pEmr   = (PU_EMRSTRETCHDIBITS) rec;
+          nSize  = pEmr->emr.nSize;
+          cbBits = pEmr->cbBitsSrc;
+          pEmr->emr.nSize = nSize  - (rowbytes - usedbytes);
+          pEmr->cbBitsSrc = cbBits - (rowbytes - usedbytes);
+          (void) snprintf(what, sizeof(what), "%2d bit %s, last row unpadded: accepted", bits[i], (topdown ? "top down" : "bottom up"));
+          report("DIB_rows", what, U_emf_record_safe(rec) && dib_rows_match(rec, w, h, bits[i], topdown));
+          pEmr->emr.nSize = nSize  - (rowbytes - usedbytes) - 1;
+          pEmr->cbBitsSrc = cbBits - (rowbytes - usedbytes) - 1;
+          (void) snprintf(what, sizeof(what), "%2d bit %s, last row short one byte: rejected", bits[i], (topdown ? "top down" : "bottom up"));
+          report("DIB_rows", what, !U_emf_record_safe(rec));
+          pEmr->emr.nSize = nSize  - rowbytes;
+          pEmr->cbBitsSrc = cbBits - rowbytes;
+          (void) snprintf(what, sizeof(what), "%2d bit %s, last row missing: rejected", bits[i], (topdown ? "top down" : "bottom up"));
+          report("DIB_rows", what, !U_emf_record_safe(rec));
+          free(rec);
+       }
+    }
+}
+
+/*  Check the description of the image in a U_EMRSTRETCHDIBITS record against its U_BITMAPINFOHEADER.  PNG and
+    JPEG images are also described from the payload alone, which must find the same 10x10 image.  Returns 1 if
+    everything matches, and counts the record under its format in counts[]. */
+int image_desc_matches(const char *record, uint32_t *counts){
+    PU_EMRSTRETCHDIBITS  pEmr = (PU_EMRSTRETCHDIBITS) record;
+    U_BITMAPINFOHEADER   Bmih;
+    U_IMAGEDESC          id, id2;
+    uint32_t             format;
+
+    memcpy(&Bmih, record + pEmr->offBmiSrc, sizeof(U_BITMAPINFOHEADER));
+    switch(Bmih.biCompression){
+       case U_BI_RGB:   format = U_IMG_DIB;     break;
+       case U_BI_RLE8:  format = U_IMG_RLE8;    break;
+       case U_BI_RLE4:  format = U_IMG_RLE4;    break;
+       case U_BI_JPEG:  format = U_IMG_JPEG;    break;
+       case U_BI_PNG:   format = U_IMG_PNG;     break;
+       default:         format = U_IMG_UNKNOWN; break;
+    }
+    if(get_DIB_desc(record, pEmr->offBitsSrc, pEmr->offBmiSrc, pEmr->cbBitsSrc, &id))return(0);
+    counts[id.format < 16 ? id.format : 0]++;
+    if(id.format != format || id.width != Bmih.biWidth || id.height != abs(Bmih.biHeight) ||
+       id.data != record + pEmr->offBitsSrc || id.cbData != pEmr->cbBitsSrc)return(0);
+    if(format == U_IMG_DIB || format == U_IMG_RLE8 || format == U_IMG_RLE4){  // row order is only known for these
+       return(id.bitcount == Bmih.biBitCount && id.invert == (Bmih.biHeight < 0) &&
+          id.numCt == (uint32_t) get_real_color_count((const char *) &Bmih));
+    }
+    return(!image_desc_data(id.data, id.cbData, &id2) && id2.format == format && id2.width == 10 && id2.height == 10 &&
+       id2.bitcount == id.bitcount && id2.data == id.data && id2.cbData == id.cbData);
+}
+
+/*  image_desc_dib() (through get_DIB_desc()) and image_desc_data() on the PNG, JPEG and DIB images which testbed_emf
+    places in U_EMRSTRETCHDIBITS records, then on PNG and JPEG headers cut short, which must give status 2. */
+void test_image_desc(const char *refdir){
+    static const char  *names[] = { "unknown", "DIB", "RLE8", "RLE4", "PNG", "JPEG" };
+    char               *contents, *rec, *png = NULL, *jpeg = NULL, *pngrec = NULL, *dibrec = NULL, *copy;
+    size_t              length;
+    EMFINDEX           *ei = NULL;
+    U_IMAGEDESC         id;
+    uint32_t            counts[16];
+    uint32_t            i, size, pngsize = 0, jpegsize = 0, sofend;
+    int                 ok, status;
+    char                what[128];
+
+    if(read_ref(refdir, "test_libuemf_ref.emf", &contents, &length))return;
+    if(emf_index_build(contents, length, &ei)){
+       report("image_desc", "index test_libuemf_ref.emf", 0);
+       free(contents);
+       return;
+    }
+    memset(counts, 0, sizeof(counts));
+    for(ok = 1, i = 0; i < ei->count; i++){
+       if(ei->recs[i].iType != U_EMR_STRETCHDIBITS)continue;
+       rec = contents + ei->recs[i].offset;
+       if(!image_desc_matches(rec, counts))ok = 0;
+       size = ((PU_EMRSTRETCHDIBITS) rec)->cbBitsSrc;
+       if(!dibrec && counts[U_IMG_DIB] == 1){ dibrec = rec; }
+       if(!png  && counts[U_IMG_PNG]  == 1){ png  = rec + ((PU_EMRSTRETCHDIBITS) rec)->offBitsSrc; pngsize  = size; pngrec = rec; }
+       if(!jpeg && counts[U_IMG_JPEG] == 1){ jpeg = rec + ((PU_EMRSTRETCHDIBITS) rec)->offBitsSrc; jpegsize = size; }
+    }
+    report("image_desc", "U_EMRSTRETCHDIBITS images, width, height and format", ok && !counts[U_IMG_UNKNOWN]);
+    for(i = U_IMG_DIB; i <= U_IMG_JPEG; i++){
+       (void) snprintf(what, sizeof(what), "%-4s images found: %u", names[i], counts[i]);
+       report("image_desc", what, counts[i] > 0);
+    }
+    if(!png || !jpeg || !dibrec){
+       emf_index_free(&ei);
+       free(contents);
+       return;
+    }
+
+    for(ok = (pngsize >= 26), size = 8; size < 26; size++){           // signature, then part of the IHDR chunk
+       ok = ok && image_desc_data(png, size, &id) == 2 && id.format == U_IMG_PNG && !id.width && !id.height;
+    }
+    report("image_desc", "PNG cut short in its IHDR chunk: status 2, no dimensions", ok);
+
+    for(sofend = 3; sofend <= jpegsize && image_desc_data(jpeg, sofend, &id); sofend++){}
+    for(ok = (sofend < jpegsize), size = 3; ok && size < sofend; size++){
+       ok = image_desc_data(jpeg, size, &id) == 2 && id.format == U_IMG_JPEG && !id.width && !id.height;
+    }
+    report("image_desc", "JPEG cut short before the end of its SOF segment: status 2", ok);
+    report("image_desc", "JPEG with a whole SOF segment: 10x10",
+       !image_desc_data(jpeg, sofend, &id) && id.width == 10 && id.height == 10);
+    report("image_desc", "JPEG without its SOI marker: status 1, unknown",
+       image_desc_data(jpeg + 2, jpegsize - 2, &id) == 1 && id.format == U_IMG_UNKNOWN);
+
+    // a U_BI_PNG DIB whose image is cut short takes its dimensions from the U_BITMAPINFOHEADER instead
+    status = image_desc_dib(pngrec + ((PU_EMRSTRETCHDIBITS) pngrec)->offBmiSrc, png, 20, &id);
+    report("image_desc", "U_BI_PNG DIB with its PNG cut short: header dimensions",
+       !status && id.format == U_IMG_PNG && id.width == 10 && id.height == 10 && id.cbData == 20);
+
+    // a record which ends inside its U_BITMAPINFOHEADER must be rejected before it is described
+    size = ((PU_EMRSTRETCHDIBITS) dibrec)->emr.nSize;
+    if((copy = malloc(size))){
+       memcpy(copy, dibrec, size);
+       ((PU_EMRSTRETCHDIBITS) copy)->emr.nSize = ((PU_EMRSTRETCHDIBITS) copy)->offBmiSrc + 20;
+       report("image_desc", "DIB record cut short in its U_BITMAPINFOHEADER: rejected", !U_emf_record_safe(copy));
+       free(copy);
+    }
+    emf_index_free(&ei);
+    free(contents);
+}
+
+/* A U_EMRCREATEPEN for a pen of the given color, with a new handle from eht. */
+char *cache_pen(EMFHANDLES *eht, uint32_t color, uint32_t *ih){
+    return(createpen_set(ih, eht, logpen_set(U_PS_SOLID, pointl_set(1,1), colorref_set(color & 0xFF, (color >> 8) & 0xFF, color >> 16))));
+}
+
+/*  Offer a pen to the cache and set *ih to the handle the caller would select.  Returns 1 if it was matched with a
+    cached pen, 0 if it was not, in which case it is now in the cache under its own handle, -1 on an error. */
+int cache_lookup(EMFOBJCACHE *eoc, EMFHANDLES *eht, uint32_t color, uint32_t *ih){
+    char      *rec;
+    if(!(rec = cache_pen(eht, color, ih)) || emf_objcache_use(eoc, eht, &rec, ih))return(-1);
+    if(rec){ free(rec); return(0); }
+    return(1);
+}
+
+/*  Home slot of each pen color in a 16 slot EMFOBJCACHE.  The hash is private, so each pen is put in a cache of its
+    own and the hash read back from the slot it landed in.  Returns 1 on success. */
+int cache_homes(uint32_t *home, int n){
+    EMFOBJCACHE  *eoc;
+    EMFHANDLES   *eht;
+    uint32_t      slot, ih;
+    int           i, ok = 1;
+    for(i = 0; ok && i < n; i++){
+       ok = !emf_htable_create(16, 16, &eht) && !emf_objcache_create(0, &eoc) && eoc->allocated == 16 &&
+            !cache_lookup(eoc, eht, i, &ih) && eoc->used == 1;
+       for(slot = 0; ok && slot < eoc->allocated; slot++){
+          if(eoc->slots[slot].ih)home[i] = eoc->slots[slot].hash & (eoc->allocated - 1);
+       }
+       emf_objcache_free(&eoc);
+       emf_htable_free(&eht);
+    }
+    return(ok);
+}
+
+/*  emf_objcache_use() and emf_objcache_forget() on pens chosen so that four share a home slot, one is home in the
+    middle of their probe run, and one is elsewhere.  Deleting from the middle of the run must move the rest of it
+    back (backshift deletion) so that every remaining pen is still found, and the deleted one is not. */
+void test_objcache(void){
+    enum { NCAND = 256, NPENS = 6 };
+    uint32_t      home[NCAND];
+    uint32_t      pen[NPENS], ih[NPENS];
+    EMFOBJCACHE  *eoc = NULL;
+    EMFHANDLES   *eht = NULL;
+    uint32_t      h, slot, mask, found;
+    int           i, n, ok;
+    char          what[128];
+
+    if(!cache_homes(home, NCAND)){ report("EMFOBJCACHE", "find the home slot of each pen", 0); return; }
+    // pen[0..3] share home h, pen[4] is home at h+2 (inside their run), pen[5] at h+8 (outside it)
+    for(h = 0, ok = 0; !ok && h < 16; h++){
+       for(n = 0, i = 0; i < NCAND && n < 4; i++){ if(home[i] == h)pen[n++] = i; }
+       for(i = 0; i < NCAND && home[i] != ((h + 2) & 15); i++){}
+       pen[4] = i;
+       for(i = 0; i < NCAND && home[i] != ((h + 8) & 15); i++){}
+       pen[5] = i;
+       ok = (n == 4 && pen[4] < NCAND && pen[5] < NCAND);
+    }
+    h--;
+    report("EMFOBJCACHE", "four pens with the same home slot", ok);
+    if(!ok)return;
+
+    ok = !emf_htable_create(16, 16, &eht) && !emf_objcache_create(0, &eoc);
+    for(i = 0; ok && i < NPENS; i++){
+       ok = !cache_lookup(eoc, eht, pen[i], &ih[i]);
+    }
+    mask = ok ? eoc->allocated - 1 : 0;
+    for(i = 0; ok && i < 5; i++){      // the four colliding pens, then the one displaced by them
+       ok = (eoc->slots[(h + i) & mask].ih == ih[i]);
+    }
+    report("EMFOBJCACHE", "colliding pens fill one probe run", ok && eoc->slots[(h + 8) & mask].ih == ih[5]);
+    for(i = 0; ok && i < NPENS; i++){
+       ok = (cache_lookup(eoc, eht, pen[i], &found) == 1 && found == ih[i]);
+    }
+    report("EMFOBJCACHE", "every pen is found", ok && eoc->hits == NPENS);
+
+    for(n = 1; ok && n < 3; n++){      // delete from the middle of the run, then from what is left of it
+       ok = !emf_objcache_forget(eoc, ih[n]) && eoc->used == (uint32_t)(NPENS - n);
+       for(slot = h; ok && slot != ((h + 5 - n) & mask); slot = (slot + 1) & mask){
+          ok = (eoc->slots[slot].ih != 0);
+       }
+       (void) snprintf(what, sizeof(what), "after deleting %d from the run it is %d shorter, no holes", n, n);
+       report("EMFOBJCACHE", what, ok && !eoc->slots[(h + 5 - n) & mask].ih);
+       for(i = 0; ok && i < NPENS; i++){
+          if(i >= 1 && i <= n)continue;
+          ok = (cache_lookup(eoc, eht, pen[i], &found) == 1 && found == ih[i]);
+       }
+       (void) snprintf(what, sizeof(what), "after deleting %d from the run every other pen is found", n);
+       report("EMFOBJCACHE", what, ok);
+    }
+    ok = ok && !cache_lookup(eoc, eht, pen[1], &ih[1]) && !cache_lookup(eoc, eht, pen[2], &ih[2]);
+    report("EMFOBJCACHE", "deleted pens are not found, and go back in", ok && eoc->used == NPENS);
+    for(i = 0; ok && i < NPENS; i++){
+       ok = (cache_lookup(eoc, eht, pen[i], &found) == 1 && found == ih[i]);
+    }
+    report("EMFOBJCACHE", "every pen is found again", ok);
+    emf_objcache_free(&eoc);
+    emf_htable_free(&eht);
+}
+
+/*  U_objtable_insert() and U_objtable_delete() used as WMF files use them: each new object takes the lowest free
+    handle.  A fixed sequence first, then a long pseudo random one checked against a plain array of handles. */
+void test_objtable(void){
+    static const uint32_t  types[] = { U_WMR_CREATEPENINDIRECT, U_WMR_CREATEBRUSHINDIRECT, U_WMR_CREATEFONTINDIRECT };
+    static const uint32_t  dels[]  = { 3, 1, 4 };
+    static const uint32_t  reuse[] = { 1, 3, 4, 6 };
+    static const char      records[200];          // stands in for the creating records, only the addresses matter
+    U_OBJTABLE            *ot = NULL;
+    const U_OBJENTRY      *oe;
+    char                   inuse[200];
+    uint32_t               ih, pick, seed, lowest, count;
+    int                    i, ok;
+
+    ok = !U_objtable_create(0, &ot);
+    for(i = 0; ok && i < 6; i++){
+       ok = !U_objtable_insert(ot, types[i % 3], records + i, 10*i, &ih) && ih == (uint32_t) i;
+    }
+    report("U_OBJTABLE", "six objects take handles 0 to 5", ok && ot->count == 6);
+    for(i = 0; ok && i < 3; i++){ ok = !U_objtable_delete(ot, dels[i]); }
+    ok = ok && !U_objtable_get(ot, 1) && !U_objtable_get(ot, 3) && !U_objtable_get(ot, 4) && ot->count == 3;
+    ok = ok && U_objtable_delete(ot, 3) == 2 && U_objtable_delete(ot, 6) == 2;
+    report("U_OBJTABLE", "delete 3, 1, 4, deleting them again fails", ok);
+    for(i = 0; ok && i < 4; i++){
+       ok = !U_objtable_insert(ot, types[i % 3], records + 10 + i, 100 + i, &ih) && ih == reuse[i];
+    }
+    report("U_OBJTABLE", "reinserted objects take handles 1, 3, 4, then 6", ok && ot->count == 7);
+    oe = U_objtable_get(ot, 3);
+    report("U_OBJTABLE", "handle 3 holds the reinserted object",
+       oe && oe->type == types[1] && oe->record == records + 11 && oe->offset == 101);
+    U_objtable_free(&ot);
+
+    // grow well past the initial 16 handles, and check every insert against the lowest unused entry of inuse[]
+    memset(inuse, 0, sizeof(inuse));
+    ok    = !U_objtable_create(0, &ot);
+    count = 0;
+    for(seed = 1, i = 0; ok && i < 20000; i++){
+       seed = seed * 1103515245 + 12345;
+       pick = (seed >> 16) % sizeof(inuse);
+       if(count < 150 && (seed >> 8) & 1){
+          for(lowest = 0; inuse[lowest]; lowest++){}
+          ok = !U_objtable_insert(ot, types[pick % 3], records + pick, pick, &ih) && ih == lowest;
+          inuse[lowest] = 1;
+          count++;
+       }
+       else {
+          ok = (U_objtable_delete(ot, pick) == (inuse[pick] ? 0 : 2));
+          if(inuse[pick]){ inuse[pick] = 0; count--; }
+       }
+       ok = ok && ot->count == count;
+    }
+    for(ih = 0; ok && ih < sizeof(inuse); ih++){ ok = (!U_objtable_get(ot, ih) == !inuse[ih]); }
+    report("U_OBJTABLE", "20000 random inserts and deletes reuse the lowest free handle", ok);
+    U_objtable_free(&ot);
+}
+
+/*  emf_objtable_record() over every record of test_libuemf_ref.emf.  Each U_EMR_SELECTOBJECT of a created object
+    must resolve to the last record which created that handle, found here by a plain array of offsets. */
+void test_emf_objtable(const char *refdir){
+    char              *contents, *rec;
+    size_t             length;
+    EMFINDEX          *ei = NULL;
+    U_OBJTABLE        *ot = NULL;
+    const U_OBJENTRY  *oe;
+    uint32_t          *created;         // offset of the record which created each handle, 0 if none.  EMF
+                                        // headers count handles in a uint16_t, so none is larger than 0xFFFF
+    uint32_t           i, ih, selects = 0;
+    int                ok;
+    char               what[128];
+
+    if(read_ref(refdir, "test_libuemf_ref.emf", &contents, &length))return;
+    created = calloc(0x10000, sizeof(uint32_t));
+    ok = created && !emf_index_build(contents, length, &ei) && !U_objtable_create(0, &ot);
+    for(i = 0; ok && i < ei->count; i++){
+       rec = contents + ei->recs[i].offset;
+       ok  = U_emf_record_safe(rec) && !emf_objtable_record(ot, rec, ei->recs[i].offset);
+       if(!ok || ei->recs[i].nSize < 12)continue;
+       memcpy(&ih, rec + 8, 4);
+       if(ih & U_STOCK_OBJECT)continue;
+       switch(ei->recs[i].iType){
+          case U_EMR_CREATEPEN:  case U_EMR_CREATEBRUSHINDIRECT:  case U_EMR_CREATEPALETTE:
+          case U_EMR_EXTCREATEFONTINDIRECTW:  case U_EMR_CREATEMONOBRUSH:  case U_EMR_CREATEDIBPATTERNBRUSHPT:
+          case U_EMR_EXTCREATEPEN:  case U_EMR_CREATECOLORSPACE:  case U_EMR_CREATECOLORSPACEW:
+             ok = (ih <= 0xFFFF);
+             if(ok)created[ih] = ei->recs[i].offset;
+             break;
+          case U_EMR_DELETEOBJECT:
+             ok = (ih <= 0xFFFF && created[ih] && !U_objtable_get(ot, ih));
+             if(ok)created[ih] = 0;
+             break;
+          case U_EMR_SELECTOBJECT:
+             oe = U_objtable_get(ot, ih);
+             ok = (ih <= 0xFFFF && created[ih] && oe && oe->offset == created[ih] &&
+                   oe->record == contents + created[ih] && oe->type == get_le32(contents + created[ih]));
+             selects++;
+             break;
+          default:
+             break;
+       }
+    }
+    (void) snprintf(what, sizeof(what), "test_libuemf_ref.emf: %u U_EMR_SELECTOBJECT resolved", selects);
+    report("U_OBJTABLE", what, ok && selects > 0);
+    emf_index_free(&ei);
+    U_objtable_free(&ot);
+    free(created);
+    free(contents);
+}
+
+/*  points_transform_into(), point16_transform_into(), or, for U_XF_POINTF, U_xform_pairs() (pointfs_transform_into()
+    is in upmf.c), with the bounds as {minX, minY, maxX, maxY}. */
+int transform_into(const void *src, void *dst, int n, int kind, U_XFORM xf, double *b){
+    U_RECTL  r;
+    int      status;
+    switch(kind){
+       case U_XF_POINT:   status = points_transform_into( (const U_POINT *)   src, (U_POINT *)   dst, n, xf, (b ? &r : NULL));  break;
+       case U_XF_POINT16: status = point16_transform_into((const U_POINT16 *) src, (U_POINT16 *) dst, n, xf, (b ? &r : NULL));  break;
+       default:           return(U_xform_pairs(src, dst, n, kind, xf, b));
+    }
+    if(b && !status){ b[0] = r.left;  b[1] = r.top;  b[2] = r.right;  b[3] = r.bottom; }
+    return(status);
+}
+
+/*  Transform n pairs at once, which uses the vector kernels when the CPU has them and n is large enough, into dst and
+    in place.  Then one pair at a time, which is always the scalar code.  Returns 1 if the pairs are bit identical and
+    the bounds equal. */
+int transform_same(const char *src, int n, int kind, U_XFORM xf){
+    static char  all[8*1001], inplace[8*1001], one[8*1001];
+    size_t       psize = (kind == U_XF_POINT16 ? 4 : 8);
+    double       ball[4], bone[4], b[4];
+    int          i;
+
+    if(transform_into(src, all, n, kind, xf, ball))return(0);
+    memcpy(inplace, src, n*psize);
+    if(transform_into(inplace, inplace, n, kind, xf, NULL) || memcmp(all, inplace, n*psize))return(0);
+    memset(bone, 0, sizeof(bone));
+    for(i = 0; i < n; i++){
+       if(transform_into(src + i*psize, one + i*psize, 1, kind, xf, b))return(0);
+       if(!i || b[0] < bone[0])bone[0] = b[0];
+       if(!i || b[1] < bone[1])bone[1] = b[1];
+       if(!i || b[2] > bone[2])bone[2] = b[2];
+       if(!i || b[3] > bone[3])bone[3] = b[3];
+    }
+    return(!memcmp(all, one, n*psize) && ball[0] == bone[0] && ball[1] == bone[1] && ball[2] == bone[2] && ball[3] == bone[3]);
+}
+
+/*  The vector kernels in U_xform_pairs() against its scalar code, over every length up to 37 (so none of the lengths
+    of the tails after 2 or 4 point vectors is missed) and 1001.  The transforms include one which puts every odd
+    coordinate exactly halfway between two integers, to check the rounding.  trivertex_transform_into() must give
+    the same coordinates as points_transform_into(). */
+void test_transform(void){
+    static const char  *names[] = { "", "points_transform_into", "point16_transform_into", "U_xform_pairs U_XF_POINTF" };
+    static int32_t      pt[2*1001];
+    static int16_t      pt16[2*1001];
+    static float        ptf[2*1001];
+    static U_TRIVERTEX  tv[37], tvx[37];
+    static U_POINT      tp[37];
+    const double        c = 1.5*0.86602540378443865, s = 1.5*0.5;   // scale by 1.5, rotate by 30 degrees
+    U_XFORM             xf[4];
+    const char         *src;
+    U_RECTL             r1, r2;
+    uint32_t            seed = 6;
+    int                 i, n, kind, ok;
+    char                what[128];
+
+    xf[0] = xform_set(1.0, 0.0, 0.0, 1.0,  0.0,    0.0);
+    xf[1] = xform_set(0.5, 0.0, 0.0, 0.5,  0.0,    0.0);      // odd coordinates land on .5
+    xf[2] = xform_set(  c,   s,  -s,   c,  1000.7, -333.3);
+    xf[3] = xform_set(1.0, 0.3, -0.7, 1.0, -0.5,    0.5);
+    for(i = 0; i < 2*1001; i++){
+       seed    = seed * 1103515245 + 12345;
+       pt[i]   = (int32_t)(seed >> 8) % 2000000 - 1000000;
+       pt16[i] = (int16_t)((seed >> 16) % 8000 - 4000);
+       ptf[i]  = (float) pt[i] / 16.0f;
+    }
+    for(kind = U_XF_POINT; kind <= U_XF_POINTF; kind++){
+       src = (kind == U_XF_POINT ? (const char *) pt : (kind == U_XF_POINT16 ? (const char *) pt16 : (const char *) ptf));
+       for(ok = 1, i = 0; ok && i < 4; i++){
+          for(n = 0; ok && n <= 37; n++){ ok = transform_same(src, n, kind, xf[i]); }
+          ok = ok && transform_same(src, 1001, kind, xf[i]);
+       }
+       (void) snprintf(what, sizeof(what), "%s, lengths 0 to 37 and 1001", names[kind]);
+       report("transform_into", what, ok);
+    }
+
+    for(i = 0; i < 37; i++){
+       tv[i].x     = tp[i].x = pt[2*i];
+       tv[i].y     = tp[i].y = pt[2*i + 1];
+       tv[i].Red   = i;
+       tv[i].Alpha = 37 - i;
+    }
+    ok = !trivertex_transform_into(tv, tvx, 37, xf[2], &r1) && !points_transform_into(tp, tp, 37, xf[2], &r2) &&
+         !memcmp(&r1, &r2, sizeof(U_RECTL));
+    for(i = 0; ok && i < 37; i++){
+       ok = (tvx[i].x == tp[i].x && tvx[i].y == tp[i].y && tvx[i].Red == i && tvx[i].Alpha == 37 - i);
+    }
+    report("transform_into", "trivertex_transform_into matches points_transform_into", ok);
+}
+
+/*  U_Utf_cleanup() closes the descriptors used to transliterate to Latin1.  Transliteration must give the same
+    result after it as before, from each source encoding, and calling it twice must do no harm. */
+void test_utf_cleanup(void){
+    static const char      u8[]  = "Euro \xE2\x82\xAC, dash \xE2\x80\x94";
+    static const uint16_t  u16[] = { 'E', 0x20AC, ' ', 0x2014, 0 };
+    static const uint32_t  u32[] = { 'E', 0x20AC, ' ', 0x2014, 0 };
+    const void            *src[3]  = { u8, u16, u32 };
+    const int              code[3] = { U_UTF_8, U_UTF_16LE, U_UTF_32LE };
+    char                   before[3][64], after[3][64];
+    int                    i, pass, ok = 1;
+
+    for(pass = 0; pass < 3; pass++){
+       for(i = 0; i < 3; i++){
+          ok = ok && !U_Utf_convert(U_UTF_LATIN1, (pass ? after[i] : before[i]), 64, NULL, code[i], src[i], 0);
+          if(pass)ok = ok && !strcmp(before[i], after[i]);
+       }
+       U_Utf_cleanup();
+       if(pass == 1)U_Utf_cleanup();
+    }
+    report("U_Utf_cleanup", "transliteration to Latin1 the same before and after", ok);
+}
+
+int main(int argc, char *argv[]){
+    const char *refdir = (argc > 1 ? argv[1] : ".");
+
+    test_index(refdir);
+    test_reader(refdir);
+    test_pack(refdir);
+    test_dib_mt();
+    test_dib_rows();
+    test_image_desc(refdir);
+    test_objcache();
+    test_objtable();
+    test_emf_objtable(refdir);
+    test_transform();
+    test_utf_cleanup();
+    printf("%d checks failed\n", failures);
+    exit(failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
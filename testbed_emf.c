@@ -6,6 +6,7 @@
    2  Enable tests that block EMF being displayed in Windows Preview (currently, GradientFill)
    4  Use a rotated, scaled, offset world transform
    8  Disable clipping tests.
+  10  Write the file with emf_start_stream() instead of building it in memory.
    Default is 0, no option set.
 
  Compile with 
@@ -42,6 +43,7 @@ Copyright: 2020 David Mathog and California Institute of Technology (Caltech)
 #define PREVIEW_BLOCKERS 2
 #define WORLDXFORM_TEST  4
 #define NO_CLIP_TEST     8
+#define STREAM_TEST     16
 #define STRALLOC        64
 
 
@@ -413,6 +415,84 @@ void label_row(int x1, int y1, uint32_t *font, EMFTRACK *et, EMFHANDLES *eht){
     return;
 }
 
+/* 
+Fill an RGBA image for the RLE tests: the top half of the rows are each one color, which RLE compresses into
+encoded runs, the bottom half is the FillImage() gradient, which it stores in absolute runs.
+*/
+void FillRLEImage(char *px, int w, int h){
+int        i,j;
+    FillImage(px, w, h, 4*w);
+    for(j=0; j<h/2; j++){
+       for(i=1; i<w; i++){ memcpy(px + 4*(j*w + i), px + 4*j*w, 4); }
+    }
+}
+
+/* 
+Write a U_BI_RLE8 or U_BI_RLE4 image made from an RGBA image with RGBA_to_DIB() and U_CT_RLE.  Both the RLE data
+and, through get_DIB_params(), the record must decode back to the RGBA image with RLE_to_RGBA().
+*/
+void rle_image(EMFTRACK *et, int x1, int y1, char *rgba_px, int w, int h, uint32_t colortype){
+    char               *rec;
+    char               *px;
+    char               *rgba_px2;
+    PU_RGBQUAD          ct;
+    int                 numCt;
+    uint32_t            cbPx;
+    U_BITMAPINFOHEADER  Bmih;
+    PU_BITMAPINFO       Bmi;
+    PU_EMRSTRETCHDIBITS pEmr;
+    const char         *rpx;
+    const U_RGBQUAD    *rct;
+    uint32_t            rnumCt, rw, rh, rtype, rinvert;
+    uint32_t            compression = (colortype == U_BCBM_COLOR8 ? U_BI_RLE8 : U_BI_RLE4);
+    const char         *name        = (colortype == U_BCBM_COLOR8 ? "U_BI_RLE8"   : "U_BI_RLE4");
+
+    if(RGBA_to_DIB(&px, &cbPx, &ct, &numCt, rgba_px, w, h, 4*w, colortype, U_CT_BGRA | U_CT_RLE, U_ROW_ORDER_SAME)){
+       printf("Error in RGBA->RLE for %s\n", name); fflush(stdout);
+       return;
+    }
+    if(RLE_to_RGBA(px, cbPx, ct, numCt, &rgba_px2, w, h, compression, U_ROW_ORDER_SAME)){
+       printf("Error in RLE->RGBA for %s\n", name); fflush(stdout);
+    }
+    else {
+       if(rgba_diff(rgba_px, rgba_px2, w * h * 4, 0)){
+          printf("Error in RGBA->RLE->RGBA for %s\n", name); fflush(stdout);
+       }
+       free(rgba_px2);
+    }
+    Bmih = bitmapinfoheader_set(w, h, 1, colortype, compression, cbPx, 47244, 47244, numCt, 0);
+    Bmi = bitmapinfo_set(Bmih, ct);
+    rec = U_EMRSTRETCHDIBITS_set(
+       U_RCL_DEF,
+       pointl_set(x1,y1),
+       pointl_set(200,200),
+       pointl_set(0,0), 
+       pointl_set(w,h),
+       U_DIB_RGB_COLORS, 
+       U_SRCCOPY,
+       Bmi, 
+       cbPx, 
+       px);
+    
+    // read it back as a reader of the EMF file would
+    pEmr = (PU_EMRSTRETCHDIBITS) rec;
+    if(get_DIB_params(rec, pEmr->offBitsSrc, pEmr->offBmiSrc, &rpx, &rct, &rnumCt, &rw, &rh, &rtype, &rinvert) != (int) compression ||
+       rw != (uint32_t) w || rh != (uint32_t) h || rtype != colortype ||
+       RLE_to_RGBA(rpx, rnumCt, rct, get_real_color_count(rec + pEmr->offBmiSrc), &rgba_px2, w, h, compression, U_ROW_ORDER_SAME)){
+       printf("Error in record->RGBA for %s\n", name); fflush(stdout);
+    }
+    else {
+       if(rgba_diff(rgba_px, rgba_px2, w * h * 4, 0)){
+          printf("Error in RGBA->record->RGBA for %s\n", name); fflush(stdout);
+       }
+       free(rgba_px2);
+    }
+    taf(rec,et,"U_EMRSTRETCHDIBITS_set");
+    free(Bmi);
+    free(ct);
+    free(px);
+}
+
 void image_column(EMFTRACK *et, int x1, int y1, int w, int h, PU_BITMAPINFO Bmi, uint32_t cbPx, char *px){
     char *rec;
     int   step=0;
@@ -1008,6 +1088,7 @@ int main(int argc, char *argv[]){
       printf("   2  Enable tests that block EMF being displayed in Windows Preview (currently, none)\n");
       printf("   4  Rotate and scale the test image within the page.\n");
       printf("   8  Disable clipping tests.\n");
+      printf("  10  Write the file with emf_start_stream() instead of building it in memory.\n");
       exit(EXIT_FAILURE);
     }
 
@@ -1047,8 +1128,14 @@ int main(int argc, char *argv[]){
     /* ********************************************************************** */
     // set up and begin the EMF
  
-    status=emf_start("test_libuemf.emf",1000000, 250000, &et);  // space allocation initial and increment 
-    if(status)printf_and_flush("error in emf_start\n");
+    if(mode & STREAM_TEST){
+       status=emf_start_stream("test_libuemf.emf", 250000, &et);  // records go straight to the file
+       if(status)printf_and_flush("error in emf_start_stream\n");
+    }
+    else {
+       status=emf_start("test_libuemf.emf",1000000, 250000, &et);  // space allocation initial and increment 
+       if(status)printf_and_flush("error in emf_start\n");
+    }
     status=emf_htable_create(128, 128, &eht);
     if(status)printf_and_flush("error in emf_htable\n");
 
@@ -1130,7 +1217,7 @@ int main(int argc, char *argv[]){
     textlabel(400, "libUEMF v0.2.2",      9700, 200, &font, et, eht);
     textlabel(400, "May 21, 2015",        9700, 500, &font, et, eht);
     rec = malloc(128);
-    (void)sprintf(rec,"EMF test: %2.2X",mode);
+    (void)sprintf(rec,"EMF test: %2.2X",mode & ~STREAM_TEST);  // streaming must not change the drawing
     textlabel(400, rec,                   9700, 800, &font, et, eht);
     free(rec);
 
@@ -1859,6 +1946,14 @@ int main(int argc, char *argv[]){
     free(ct);
     free(px);
 
+    // RLE compressed images, 8 bit in a 12 x 6 image, 4 bit in a 6 x 4 image (at most 14 colors)
+    free(rgba_px); 
+    rgba_px = (char *) malloc(12*6*4);
+    FillRLEImage(rgba_px, 12, 6);
+    rle_image(et, offset + 660, 5000, rgba_px, 12, 6, U_BCBM_COLOR8);
+    FillRLEImage(rgba_px, 6, 4);
+    rle_image(et, offset + 880, 5000, rgba_px, 6, 4, U_BCBM_COLOR4);
+
     free(rgba_px); 
 
     // Make another sacrificial image, this one the inverse of the background color
@@ -2548,11 +2643,12 @@ if(!(mode & PPT_BLOCKERS)){
 
     /* Test the endian routines (on either Big or Little Endian machines).
     This must be done before the call to emf_finish, as that will swap the byte
-    order of the EMF data before it writes it out on a BE machine.  */
+    order of the EMF data before it writes it out on a BE machine.  When streaming
+    only the header is still in memory, so there is nothing to test.  */
     
 #if 1
-    string = (char *) malloc(et->used);
-    if(!string){
+    if(mode & STREAM_TEST){ /* nothing to swap, the records are already in the file */ }
+    else if(!(string = (char *) malloc(et->used))){
        printf("Could not allocate enough memory to test u_emf_endian() function\n");
     }
     else {
@@ -2578,6 +2674,7 @@ if(!(mode & PPT_BLOCKERS)){
 
     emf_free(&et);
     emf_htable_free(&eht);
+    U_Utf_cleanup();
 
   exit(EXIT_SUCCESS);
 }
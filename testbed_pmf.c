@@ -6,6 +6,8 @@
    2  Enable tests that block EMF being displayed in Windows Preview (currently, GradientFill)
    4  Use a rotated, scaled, offset world transform
    8  Disable clipping tests.
+  10  Pack consecutive EMF+ records into shared EMF comments, see U_PMR_pack().
+  20  Write some records with U_PMR_SERIAL_write() and the U_PMR_*_write() functions.  The output must not change.
    Default is 0, no option set.
 
  Compile with 
@@ -42,6 +44,8 @@ Copyright: 2020 David Mathog and California Institute of Technology (Caltech)
 #define PREVIEW_BLOCKERS 2
 #define WORLDXFORM_TEST  4
 #define NO_CLIP_TEST     8
+#define PACK_TEST       16
+#define SERIAL_TEST     32
 #define ALPHA_YES        1
 #define ALPHA_NO         0
 #define CMP_IMG_YES      1
@@ -137,19 +141,16 @@ void taf(char *rec,EMFTRACK *et, char *text){  // Test, append, free
 #endif
 }
 
-/* accept the load of an EMF+ record, pack it into an EMF comment record, and append it */
+/* accept the load of an EMF+ record, pack it into an EMF comment record, and append it.
+   U_PMR_write() does the packing, so that U_PMR_pack() applies to these records too. */
 void paf(EMFTRACK *et,  U_PSEUDO_OBJ *sum, U_PSEUDO_OBJ *po, char *text){  // Test, append, free
     unsigned long int uu;
-    char *rec;
-    uu = po->Used;                                          /* printing size_t portably is a pain, this avoids the issue */
     if(!po){ printf("%s failed",text);                }
-    else {   printf("%s recsize: %lu",text, uu + 16); }
-    sum->Used = 0;                                          /* clean it out, retaining allocated memory         */
-    sum       = U_PO_append(sum, "EMF+", 4);                /* indicates that this comment holds an EMF+ record */
-    sum       = U_PO_append(sum,  po->Data, po->Used);      /* the EMF+ record itself                           */
-    U_PO_free(&po);                                         /* delete the PseudoObject                          */
-    rec       = U_EMRCOMMENT_set(sum->Used, sum->Data);     /* stuff it into the EMF comment                    */
-    (void) emf_append((PU_ENHMETARECORD)rec, et, 1);
+    else {
+       uu = po->Used;                                       /* printing size_t portably is a pain, this avoids the issue */
+       printf("%s recsize: %lu",text, uu + 16);
+       if(!U_PMR_write(po, sum, et))printf(" U_PMR_write failed"); /* po is deleted */
+    }
     printf("\n");
 #ifdef U_VALGRIND
     fflush(stdout);  // helps keep lines ordered within Valgrind
@@ -1371,6 +1372,8 @@ int main(int argc, char *argv[]){
       printf("   2  Enable tests that block EMF being displayed in Windows Preview (currently, GradientFill)\n");
       printf("   4  Rotate and scale the test image within the page.\n");
       printf("   8  Disable clipping tests.\n");
+      printf("  10  Pack consecutive EMF+ records into shared EMF comments.\n");
+      printf("  20  Write some records with U_PMR_SERIAL_write() and the U_PMR_*_write() functions.\n");
       exit(EXIT_FAILURE);
     }
  
@@ -1383,6 +1386,7 @@ int main(int argc, char *argv[]){
  
     status=emf_start("test_libuemf_p.emf",1000000, 250000, &et);  // space allocation initial and increment 
     if(status)printf_and_flush("error in emf_start\n");
+    if((mode & PACK_TEST) && !U_PMR_pack(et, 65536))printf_and_flush("error in U_PMR_pack\n");
     status=emf_htable_create(128, 128, &eht);
     if(status)printf_and_flush("error in emf_htable\n");
     (void) device_size(216, 279, 47.244094, &szlDev, &szlMm); // Example: device is Letter vertical, 1200 dpi = 47.244 DPmm
@@ -1694,7 +1698,7 @@ int main(int argc, char *argv[]){
     textlabel(poac, 400, "libUEMF v0.2.1",     9700, 200, U_SA_Near, U_SA_Near, poColor, et);
     textlabel(poac, 400, "April 23, 2015",     9700, 500, U_SA_Near, U_SA_Near, poColor, et);
     rec = malloc(128);
-    (void)sprintf(rec,"EMF+ test: %2.2X",mode);
+    (void)sprintf(rec,"EMF+ test: %2.2X",mode & ~(PACK_TEST | SERIAL_TEST));  // these must not change the drawing
     textlabel(poac, 400, rec,                   9700, 800, U_SA_Near, U_SA_Near, poColor, et);
     free(rec);
 
@@ -2232,20 +2236,39 @@ int main(int argc, char *argv[]){
 
     // beziers
     points = pointfs_transform(plarray, 7, xform_alt_set(0.5, 1.0, 0.0, 0.0, 3800, 1800));
-    poPoints = U_PMF_POINTF_set(7, points);
-       IfNullPtr(poPoints,__LINE__,"OOPS on U_PMF_POINTF_set\n");
-    po = U_PMR_DRAWBEZIERS_set(OBJ_PEN_RED_10, poPoints);
-    paf(et, poac, po, "U_PMR_DRAWBEZIERS_set");
-       U_PO_free(&poPoints);
+    if(mode & SERIAL_TEST){  // the same record as U_PMR_DRAWBEZIERS_set(), straight from the points
+       uint32_t Elements = 7;
+       const U_SERIAL_DESC List[] = {
+          {&Elements, 4, 1,          U_LE},
+          {points,    4, 2*Elements, U_LE},
+          {NULL,0,0,U_XX}
+       };
+       if(!U_PMR_SERIAL_write(U_PMR_DRAWBEZIERS, (OBJ_PEN_RED_10 & U_FF_MASK_OID8) << U_FF_SHFT_OID8, List, et)){
+          printf("U_PMR_SERIAL_write failed for U_PMR_DRAWBEZIERS\n");
+       }
+    }
+    else {
+       poPoints = U_PMF_POINTF_set(7, points);
+          IfNullPtr(poPoints,__LINE__,"OOPS on U_PMF_POINTF_set\n");
+       po = U_PMR_DRAWBEZIERS_set(OBJ_PEN_RED_10, poPoints);
+       paf(et, poac, po, "U_PMR_DRAWBEZIERS_set");
+          U_PO_free(&poPoints);
+    }
        free(points);
  
     // polygonfill
     points = pointfs_transform(plarray, 6, xform_alt_set(0.5, 1.0, 0.0, 0.0, 3800, 2300));
-    poPoints = U_PMF_POINTF_set(6, points);
-       IfNullPtr(poPoints,__LINE__,"OOPS on U_PMF_POINTF_set\n");
-    po = U_PMR_FILLPOLYGON_set(poBrushID,poPoints);
-    paf(et, poac, po, "U_PMR_FILLPOLYGON_set");
-       U_PO_free(&poPoints);
+    if(mode & SERIAL_TEST){  // poBrushID is U_PMF_ARGB_set(255, 128, 128, 128)
+       U_PMF_ARGB Gray = {128, 128, 128, 255};
+       if(!U_PMR_FILLPOLYGON_write(&Gray, 0, 6, points, et))printf("U_PMR_FILLPOLYGON_write failed\n");
+    }
+    else {
+       poPoints = U_PMF_POINTF_set(6, points);
+          IfNullPtr(poPoints,__LINE__,"OOPS on U_PMF_POINTF_set\n");
+       po = U_PMR_FILLPOLYGON_set(poBrushID,poPoints);
+       paf(et, poac, po, "U_PMR_FILLPOLYGON_set");
+          U_PO_free(&poPoints);
+    }
        free(points);
  
     // curves with varying tension
@@ -2321,6 +2344,50 @@ int main(int argc, char *argv[]){
     not_in_pmf(1.0, 4900 - 100, 2800 - 100, OBJ_PEN_RED_10, poBrushDarkRedID, et, dpath, poac);  /* PMF has no polypolygon  */
     not_in_pmf(1.0, 4900 - 100, 3300 - 100, OBJ_PEN_RED_10, poBrushDarkRedID, et, dpath, poac);  /* PMF has no polypolygon16  */
 
+    // U_PMF_PATH_set4() and U_PMF_POINTS_set() store the points in the smallest encoding which holds them exactly:
+    // float (fractional coordinates), int16, or relative (U_PMF_POINTR).  Draw the same figure each way, as a path and
+    // as closed lines, and check that the relative points decode back to the originals.
+    for(i=0; i<3; i++){
+       uint32_t expected[3] = { U_PMF_POINTF_OID, U_PMF_POINT_OID, U_PMF_POINTR_OID };
+       U_PMF_POINTF back[12];
+       const char  *cptr;
+       points = pointfs_transform(pl12, 12, xform_alt_set(1.0, 1.0, 0.0, 0.0, 7500 + i*400, 4350));
+       for(j=0; j<12; j++){  // fractional coordinates the first time, whole numbers after that
+          if(i){ points[j].X = U_ROUND(points[j].X); points[j].Y = U_ROUND(points[j].Y); }
+          else { points[j].X += 0.25;                                                    }
+       }
+       U_DPO_clear(dpath);
+       IfNotTrue(U_PATH_polygon(dpath, 12, points, U_PTP_None),__LINE__, "OOPS on U_PATH_polygon\n");
+       poPath = U_PMF_PATH_set4(Version, dpath, i==2);
+          IfNullPtr(poPath,__LINE__,"OOPS U_PMF_PATH_set4\n");
+       po = U_PMR_OBJECT_PO_set(OBJ_PATH_1, poPath);
+          IfNullPtr(po,__LINE__,"OOPS on U_PMR_OBJECT_PO_set\n");
+       paf(et, poac, po, "U_PMR_OBJECT_PO_set OBJ_PATH_1");
+       po = U_PMR_drawfill(OBJ_PATH_1,OBJ_PEN_RED_10, poBrushID);
+       paf(et, poac, po, "U_PMR_drawfill");
+          U_PO_free(&poPath);
+          free(points);
+
+       points = pointfs_transform(pl12, 12, xform_alt_set(1.0, 1.0, 0.0, 0.0, 7500 + i*400, 4650));
+       for(j=0; j<12; j++){  // fractional coordinates the first time, whole numbers after that
+          if(i){ points[j].X = U_ROUND(points[j].X); points[j].Y = U_ROUND(points[j].Y); }
+          else { points[j].X += 0.25;                                                    }
+       }
+       poPoints = U_PMF_POINTS_set(12, points, i==2);
+          IfNullPtr(poPoints,__LINE__,"OOPS on U_PMF_POINTS_set\n");
+       IfNotTrue((poPoints->Type & ~U_PMF_ARRAY_OID) == expected[i],__LINE__, "OOPS U_PMF_POINTS_set picked the wrong encoding\n");
+       if(poPoints->Type == U_PMF_POINTR_OID){
+          cptr = poPoints->Data + 4;  // after Elements
+          IfNotTrue(U_PMF_POINTR_array_get(&cptr, 12, back, poPoints->Data + poPoints->Used),__LINE__, "OOPS on U_PMF_POINTR_array_get\n");
+          IfNotTrue(!memcmp(back, points, sizeof(back)),__LINE__, "OOPS U_PMF_POINTR_array_get did not return the original points\n");
+       }
+       po = U_PMR_DRAWLINES_set(OBJ_PEN_RED_10, 1, poPoints);
+          IfNullPtr(po,__LINE__,"OOPS on U_PMR_DRAWLINES_set\n");
+       paf(et, poac, po, "U_PMR_DRAWLINES_set");
+          U_PO_free(&poPoints);
+          free(points);
+    }
+
     /* Done with OBJ_BRUSH_GRAY now */   
     U_PO_free(&poBrushID);
 
@@ -2764,11 +2831,16 @@ int main(int argc, char *argv[]){
              free(pRectfs);
 
           points = pointfs_transform(Pointfs, 2, xform_alt_set(1.0, 1.0, 0.0, 0.0, 2000+(i+54)*105, 3500 + k*310));
-          poPoints = U_PMF_POINTF_set(2, points);
-             IfNullPtr(poPoints,__LINE__,"OOPS on U_PMF_POINTR_set\n");
-          po = U_PMR_DRAWLINES_set(OBJ_PEN_GROUP1, 0, poPoints);
-          paf(et, poac, po, "U_PMR_DRAWLINES_set");
-             U_PO_free(&poPoints);
+          if(mode & SERIAL_TEST){
+             if(!U_PMR_DRAWLINES_write(OBJ_PEN_GROUP1, 0, 2, points, et))printf("U_PMR_DRAWLINES_write failed\n");
+          }
+          else {
+             poPoints = U_PMF_POINTF_set(2, points);
+                IfNullPtr(poPoints,__LINE__,"OOPS on U_PMF_POINTR_set\n");
+             po = U_PMR_DRAWLINES_set(OBJ_PEN_GROUP1, 0, poPoints);
+             paf(et, poac, po, "U_PMR_DRAWLINES_set");
+                U_PO_free(&poPoints);
+          }
              free(points);
 
        }
@@ -2851,12 +2923,17 @@ int main(int argc, char *argv[]){
     
     /* draw the image filled line (there is just 1) */
     points = pointfs_transform(Pointfs, 2, xform_alt_set(1.0, 1.0, 0.0, 0.0, 2000+i*330, 4160));
-    poPoints = U_PMF_POINTF_set(2, points);
-       IfNullPtr(poPoints,__LINE__,"OOPS on U_PMF_POINTR_set\n");
-    po = U_PMR_DRAWLINES_set(OBJ_PEN_GROUP1, 0, poPoints);
-       IfNullPtr(poPoints,__LINE__,"OOPS on U_PMR_DRAWLINES_set\n");
-    paf(et, poac, po, "U_PMR_DRAWLINES_set");
-       U_PO_free(&poPoints);
+    if(mode & SERIAL_TEST){
+       if(!U_PMR_DRAWLINES_write(OBJ_PEN_GROUP1, 0, 2, points, et))printf("U_PMR_DRAWLINES_write failed\n");
+    }
+    else {
+       poPoints = U_PMF_POINTF_set(2, points);
+          IfNullPtr(poPoints,__LINE__,"OOPS on U_PMF_POINTR_set\n");
+       po = U_PMR_DRAWLINES_set(OBJ_PEN_GROUP1, 0, poPoints);
+          IfNullPtr(poPoints,__LINE__,"OOPS on U_PMR_DRAWLINES_set\n");
+       paf(et, poac, po, "U_PMR_DRAWLINES_set");
+          U_PO_free(&poPoints);
+    }
        free(points);
     
     U_PO_free(&poBrushID);
@@ -2924,6 +3001,7 @@ int main(int argc, char *argv[]){
     
     emf_free(&et);
     emf_htable_free(&eht);
+    U_Utf_cleanup();
 
   exit(EXIT_SUCCESS);
 }
@@ -6,6 +6,7 @@
    2  Enable tests that block WMF being displayed in Windows Preview (none currently)
    4  Disable tests that block WMF import into LODraw (JPG/PNG images, Bitmap16 images)
    8  Disable clipping tests.
+  10  Write the file with wmf_start_stream() instead of building it in memory.
    Default is 0, neither option set.
 
  Compile with 
@@ -43,6 +44,7 @@ Copyright: 2020 David Mathog and California Institute of Technology (Caltech)
 #define PREVIEW_BLOCKERS 2
 #define LODRAW_BLOCKERS  4
 #define NO_CLIP_TEST     8
+#define STREAM_TEST     16
 #define STRALLOC        64
 
 void printf_and_flush(const char *string){
@@ -326,6 +328,87 @@ void label_row(int x1, int y1, uint32_t font, WMFTRACK *wt, WMFHANDLES *wht){
     return;
 }
 
+/* 
+Fill an RGBA image for the RLE tests: the top half of the rows are each one color, which RLE compresses into
+encoded runs, the bottom half is the FillImage() gradient, which it stores in absolute runs.
+*/
+void FillRLEImage(char *px, int w, int h){
+int        i,j;
+    FillImage(px, w, h, 4*w);
+    for(j=0; j<h/2; j++){
+       for(i=1; i<w; i++){ memcpy(px + 4*(j*w + i), px + 4*j*w, 4); }
+    }
+}
+
+/* 
+Write a U_BI_RLE8 or U_BI_RLE4 image made from an RGBA image with RGBA_to_DIB() and U_CT_RLE.  Both the RLE data
+and, through wget_DIB_params(), the record must decode back to the RGBA image with RLE_to_RGBA().
+*/
+void rle_image(WMFTRACK *wt, int x1, int y1, char *rgba_px, int w, int h, uint32_t colortype){
+    char               *rec;
+    char               *px;
+    char               *rgba_px2;
+    PU_RGBQUAD          ct;
+    int                 numCt;
+    uint32_t            cbPx;
+    U_BITMAPINFOHEADER  Bmih;
+    PU_BITMAPINFO       Bmi;
+    U_POINT16           Dst, cDst, Src, cSrc;
+    uint16_t            cUsage;
+    uint32_t            dwRop3;
+    const char         *dib;
+    const char         *rpx;
+    const U_RGBQUAD    *rct;
+    uint32_t            rnumCt;
+    int32_t             rw, rh, rtype, rinvert;
+    uint32_t            compression = (colortype == U_BCBM_COLOR8 ? U_BI_RLE8 : U_BI_RLE4);
+    const char         *name        = (colortype == U_BCBM_COLOR8 ? "U_BI_RLE8"   : "U_BI_RLE4");
+
+    if(RGBA_to_DIB(&px, &cbPx, &ct, &numCt, rgba_px, w, h, 4*w, colortype, U_CT_BGRA | U_CT_RLE, U_ROW_ORDER_SAME)){
+       printf("Error in RGBA->RLE for %s\n", name); fflush(stdout);
+       return;
+    }
+    if(RLE_to_RGBA(px, cbPx, ct, numCt, &rgba_px2, w, h, compression, U_ROW_ORDER_SAME)){
+       printf("Error in RLE->RGBA for %s\n", name); fflush(stdout);
+    }
+    else {
+       if(rgba_diff(rgba_px, rgba_px2, w * h * 4, 0)){
+          printf("Error in RGBA->RLE->RGBA for %s\n", name); fflush(stdout);
+       }
+       free(rgba_px2);
+    }
+    Bmih = bitmapinfoheader_set(w, h, 1, colortype, compression, cbPx, 47244, 47244, numCt, 0);
+    Bmi = bitmapinfo_set(Bmih, ct);
+    rec = U_WMRSTRETCHDIB_set(
+       point16_set(x1,y1),
+       point16_set(200,200),
+       point16_set(0,0), 
+       point16_set(w,h),
+       U_DIB_RGB_COLORS, 
+       U_SRCCOPY,
+       Bmi, 
+       cbPx, 
+       px);
+
+    // read it back as a reader of the WMF file would, px from wget_DIB_params() points past the color table
+    if(!U_WMRSTRETCHDIB_get(rec, &Dst, &cDst, &Src, &cSrc, &cUsage, &dwRop3, &dib) ||
+       wget_DIB_params(dib, &rpx, &rct, &rnumCt, &rw, &rh, &rtype, &rinvert) != (int) compression ||
+       rw != w || rh != h || rtype != (int32_t) colortype ||
+       RLE_to_RGBA(rpx, rnumCt, rct, get_real_color_count(dib), &rgba_px2, w, h, compression, U_ROW_ORDER_SAME)){
+       printf("Error in record->RGBA for %s\n", name); fflush(stdout);
+    }
+    else {
+       if(rgba_diff(rgba_px, rgba_px2, w * h * 4, 0)){
+          printf("Error in RGBA->record->RGBA for %s\n", name); fflush(stdout);
+       }
+       free(rgba_px2);
+    }
+    taf(rec,wt,"U_WMRSTRETCHDIB_set");
+    free(Bmi);
+    free(ct);
+    free(px);
+}
+
 void image_column(WMFTRACK *wt, int x1, int y1, int w, int h, U_BITMAPINFO *Bmi, uint32_t cbPx, char *px){
     char *rec;
     int   step=0;
@@ -704,14 +787,21 @@ int main(int argc, char *argv[]){
       printf("   2  Enable tests that block WMF being displayed in Windows Preview (none currently)\n");
       printf("   4  Disable tests that block WMF import into LibreOffice Draw (JPG/PNG compression, Bitmap16 images)\n");
       printf("   8  Disable clipping tests.\n");
+      printf("  10  Write the file with wmf_start_stream() instead of building it in memory.\n");
       exit(EXIT_FAILURE);
     } 
  
     /* ********************************************************************** */
     // set up and begin the WMF
  
-    status=wmf_start("test_libuemf.wmf",1000000, 250000, &wt);  // space allocation initial and increment 
-    if(status)printf_and_flush("error in wmf_start\n");
+    if(mode & STREAM_TEST){
+       status=wmf_start_stream("test_libuemf.wmf", 250000, &wt);  // records go straight to the file
+       if(status)printf_and_flush("error in wmf_start_stream\n");
+    }
+    else {
+       status=wmf_start("test_libuemf.wmf",1000000, 250000, &wt);  // space allocation initial and increment 
+       if(status)printf_and_flush("error in wmf_start\n");
+    }
     status=wmf_htable_create(128, 128, &wht);
     if(status)printf_and_flush("error in wmf_htable\n");
 
@@ -869,7 +959,7 @@ int main(int argc, char *argv[]){
     textlabel(400, "libUEMF v0.2.2",       9700, 200, font_courier_400, wt, wht);
     textlabel(400, "May 21, 2015",         9700, 500, font_courier_400, wt, wht);
     rec = malloc(128);
-    (void)sprintf(rec,"WMF test: %2.2X",mode);
+    (void)sprintf(rec,"WMF test: %2.2X",mode & ~STREAM_TEST);  // streaming must not change the drawing
     textlabel(400, rec,                    9700, 800, font_courier_400, wt, wht);
     free(rec);
 
@@ -1308,6 +1398,14 @@ int main(int argc, char *argv[]){
     free(Bmi);
     free(px);
 
+    // RLE compressed images, 8 bit in a 12 x 6 image, 4 bit in a 6 x 4 image (at most 14 colors)
+    free(rgba_px);
+    rgba_px = (char *) malloc(12*6*4);
+    FillRLEImage(rgba_px, 12, 6);
+    rle_image(wt, offset + 660, 5000, rgba_px, 12, 6, U_BCBM_COLOR8);
+    FillRLEImage(rgba_px, 6, 4);
+    rle_image(wt, offset + 880, 5000, rgba_px, 6, 4, U_BCBM_COLOR4);
+
     free(rgba_px);
 
 
@@ -1866,11 +1964,12 @@ int main(int argc, char *argv[]){
 
     /* Test the endian routines (on either Big or Little Endian machines).
     This must be done befoe the call to wmf_finish, as that will swap the byte
-    order of the WMF data before it writes it out on a BE machine.  */
+    order of the WMF data before it writes it out on a BE machine.  When streaming
+    only the header is still in memory, so there is nothing to test.  */
     
 #if 1 
-    string = (char *) malloc(wt->used);
-    if(!string){
+    if(mode & STREAM_TEST){ /* nothing to swap, the records are already in the file */ }
+    else if(!(string = (char *) malloc(wt->used))){
        printf("Could not allocate enough memory to test u_wmf_endian() function\n");
     }
     else {
@@ -1894,6 +1993,7 @@ int main(int argc, char *argv[]){
 
     wmf_free(&wt);
     wmf_htable_free(&wht);
+    U_Utf_cleanup();
 
   exit(EXIT_SUCCESS);
 }
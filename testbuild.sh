@@ -3,13 +3,19 @@
 # Builds applications directly, no libraries built.
 # (linux)
 COPTS="-Werror=format-security -Wall -Wformat -Wformat-security -W -Wno-pointer-sign -std=c99 -pedantic -Wall -g"
-CLIBS=-lm
+CLIBS="-lm -pthread"
 # (Sparc)
 # COPTS="-Werror=format-security -Wall -Wformat -Wformat-security -W -Wno-pointer-sign -DSOL8 -DWORDS_BIGENDIAN -std=c99 -pedantic -Wall -g"
 # CLIBS="-lm -L/opt/csw/lib -liconv"
 # (win32) Mingw
 # COPTS="-Werror=format-security -Wall -Wformat -Wformat-security -W -Wno-pointer-sign -DWIN32 -std=c99 -pedantic -Wall -g"
 # CLIBS="-lm -liconv"
+echo  batchmeta         ; gcc $COPTS -o batchmeta         batchmeta.c         uemf.c uemf_endian.c uemf_safe.c uemf_print.c uemf_utf.c upmf.c upmf_print.c uwmf.c uwmf_endian.c uwmf_print.c  $CLIBS
+echo  bench_swap        ; gcc $COPTS -o bench_swap        bench_swap.c        uemf.c uemf_endian.c uemf_safe.c uemf_utf.c $CLIBS
+echo  bench_dib         ; gcc $COPTS -o bench_dib         bench_dib.c         uemf.c uemf_endian.c uemf_safe.c uemf_utf.c $CLIBS
+echo  bench_path        ; gcc $COPTS -o bench_path        bench_path.c        uemf.c uemf_endian.c uemf_safe.c uemf_utf.c upmf.c $CLIBS
+echo  bench_utf         ; gcc $COPTS -o bench_utf         bench_utf.c         uemf.c uemf_endian.c uemf_safe.c uemf_utf.c $CLIBS
+echo  bench_emplace     ; gcc $COPTS -o bench_emplace     bench_emplace.c     uemf.c uemf_endian.c uemf_safe.c uemf_utf.c $CLIBS
 echo  cutemf            ; gcc $COPTS -o cutemf            cutemf.c            uemf.c uemf_endian.c uemf_utf.c        $CLIBS
 echo  pmfdual2single    ; gcc $COPTS -o pmfdual2single    pmfdual2single.c    uemf.c uemf_endian.c uemf_utf.c upmf.c $CLIBS
 echo  reademf           ; gcc $COPTS -o reademf           reademf.c           uemf.c uemf_endian.c uemf_safe.c uemf_print.c uemf_utf.c upmf.c upmf_print.c $CLIBS
@@ -18,3 +24,5 @@ echo  testbed_emf       ; gcc $COPTS -o testbed_emf       testbed_emf.c       ue
 echo  testbed_pmf       ; gcc $COPTS -o testbed_pmf       testbed_pmf.c       uemf.c uemf_endian.c uemf_safe.c uemf_utf.c upmf.c upmf.h $CLIBS
 echo  testbed_wmf       ; gcc $COPTS -o testbed_wmf       testbed_wmf.c       uemf.c uemf_endian.c uemf_safe.c uemf_print.c uemf_utf.c upmf.c upmf_print.c uwmf.c uwmf_endian.c $CLIBS
 echo  test_mapmodes_emf ; gcc $COPTS -o test_mapmodes_emf test_mapmodes_emf.c uemf.c uemf_endian.c uemf_safe.c uemf_print.c uemf_utf.c upmf.c upmf_print.c $CLIBS
+echo  test_dcstate_emf  ; gcc $COPTS -o test_dcstate_emf  test_dcstate_emf.c  uemf.c uemf_endian.c uemf_safe.c uemf_utf.c $CLIBS
+echo  test_libuemf_api  ; gcc $COPTS -o test_libuemf_api  test_libuemf_api.c  uemf.c uemf_endian.c uemf_safe.c uemf_utf.c $CLIBS
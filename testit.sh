@@ -42,23 +42,50 @@ fi
 #
 $EPATH/testbed_emf 4 >/dev/null
 mv test_libuemf.emf test_libuemf30.emf
+$EPATH/testbed_emf 10 >/dev/null
+mv test_libuemf.emf test_libuemf_stream.emf
+$EPATH/testbed_wmf 10 >/dev/null
+mv test_libuemf.wmf test_libuemf_stream.wmf
 $EPATH/testbed_emf 0 >/dev/null
 $EPATH/reademf test_libuemf.emf >test_libuemf_emf.txt
 $EPATH/reademf test_libuemf30.emf >test_libuemf30_emf.txt
 $EPATH/testbed_wmf 0  >/dev/null
 $EPATH/readwmf test_libuemf.wmf >test_libuemf_wmf.txt 
 $EPATH/test_mapmodes_emf -vX 2000 -vY 1000 >/dev/null
+$EPATH/test_dcstate_emf >test_dcstate_emf.txt
+$EPATH/test_libuemf_api >test_libuemf_api.txt
+$EPATH/testbed_pmf 10 >/dev/null
+mv test_libuemf_p.emf test_libuemf_p_pack.emf
+$EPATH/testbed_pmf 20 >/dev/null
+mv test_libuemf_p.emf test_libuemf_p_serial.emf
+$EPATH/testbed_pmf 30 >/dev/null
+mv test_libuemf_p.emf test_libuemf_p_pack_serial.emf
 $EPATH/testbed_pmf 0 >/dev/null
 $EPATH/reademf test_libuemf_p.emf >test_libuemf_p_emf.txt
 ls -1 test*ref* | \
   $EXTRACT -fmt " $USEDIFF -bqs [1,] [rtds_ref:1,]" | \
   $EXECINPUT
+# the streamed files must match the in memory ones exactly
+cmp -s test_libuemf_stream.emf test_libuemf_ref.emf && echo "Files test_libuemf_stream.emf and test_libuemf_ref.emf are identical" \
+  || echo "Files test_libuemf_stream.emf and test_libuemf_ref.emf differ"
+cmp -s test_libuemf_stream.wmf test_libuemf_ref.wmf && echo "Files test_libuemf_stream.wmf and test_libuemf_ref.wmf are identical" \
+  || echo "Files test_libuemf_stream.wmf and test_libuemf_ref.wmf differ"
+# records from U_PMR_SERIAL_write() and U_PMR_*_write() must match those from the *_set() functions and U_PMR_write()
+cmp -s test_libuemf_p_serial.emf test_libuemf_p_ref.emf && echo "Files test_libuemf_p_serial.emf and test_libuemf_p_ref.emf are identical" \
+  || echo "Files test_libuemf_p_serial.emf and test_libuemf_p_ref.emf differ"
+cmp -s test_libuemf_p_pack_serial.emf test_libuemf_p_pack_ref.emf && echo "Files test_libuemf_p_pack_serial.emf and test_libuemf_p_pack_ref.emf are identical" \
+  || echo "Files test_libuemf_p_pack_serial.emf and test_libuemf_p_pack_ref.emf differ"
 #
 # clean up
 #
 rm -f test_libuemf30.emf
 rm -f test_libuemf.emf
 rm -f test_libuemf_p.emf
+rm -f test_libuemf_p_pack.emf
+rm -f test_libuemf_p_serial.emf
+rm -f test_libuemf_p_pack_serial.emf
+rm -f test_libuemf_stream.emf
+rm -f test_libuemf_stream.wmf
 rm -f test_libuemf.wmf
 rm -f test_libuemf30_emf.txt
 rm -f test_libuemf_emf.txt
@@ -72,3 +99,6 @@ rm -f test_mm_loenglish.emf
 rm -f test_mm_lometric.emf
 rm -f test_mm_text.emf
 rm -f test_mm_twips.emf
+rm -f test_dcstate.emf
+rm -f test_dcstate_emf.txt
+rm -f test_libuemf_api.txt
@@ -12,6 +12,15 @@
   uninitialized data.
   
   Compile with "SOL8" defined for Solaris 8 or 9 (Sparc).
+  
+  Compile with "U_NO_THREADS" defined if POSIX threads are not available, DIB_to_RGBA_mt() and RGBA_to_DIB_mt()
+  then use only the calling thread.
+  
+  Compile with "U_DIB_REFERENCE" defined to convert DIB pixels in DIB_to_RGBA() and RGBA_to_DIB() one at a time,
+  without the row kernels.
+  
+  Compile with "U_XFORM_REFERENCE" defined to transform points in points_transform_into() and related functions
+  one at a time, without the vector kernels.
 */
 
 /*
@@ -37,6 +46,16 @@ extern "C" {
 #include <limits.h> // for INT_MAX, INT_MIN
 #include <math.h>   // for U_ROUND()
 #include <stddef.h> /* for offsetof() macro */
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h> // for emf_mapdata()
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifndef U_NO_THREADS
+#include <pthread.h>  // for DIB_to_RGBA_mt() and RGBA_to_DIB_mt()
+#endif
 #if 0
 #include <windef.h>    //Not actually used, looking for collisions
 #include <winnt.h>    //Not actually used, looking for collisions
@@ -332,151 +351,143 @@ uint32_t *dx_set(
     \brief Look up the properties (a bit map) of a type of EMR record.
           Bits that may be set are defined in "Draw Properties" in uemf.h, they are U_DRAW_NOTEMPTY, etc..
         
-    \return bitmap of EMR record properties, or U_EMR_INVALID on error or release of all memory
-    \param type EMR record type.  If U_EMR_INVALID release memory. (There is no U_EMR_INVALID EMR record type)
+          The table is constant, so this may be called from any thread and nothing needs to be released.
+        
+    \return bitmap of EMR record properties, or U_EMR_INVALID if type is out of range
+    \param type EMR record type.  (There is no U_EMR_INVALID EMR record type, passing it is harmless.)
     
 */
 uint32_t emr_properties(uint32_t type){
-   static uint32_t *table=NULL;
-   uint32_t result = U_EMR_INVALID;  // initialized to indicate an error (on a lookup) or nothing (on a memory release) 
-   if(type == U_EMR_INVALID){
-      if(table)free(table);
-      table=NULL;
-   }
-   else if(type>=1 && type<U_EMR_MAX){
-      if(!table){
-         table = (uint32_t *) malloc(sizeof(uint32_t)*(1 + U_EMR_MAX));
-         if(!table)return(result); 
+   static const uint8_t table[1 + U_EMR_MAX] = {
    //                                                               0x80 0x40 0x20 0x10 0x08 0x04 0x02 0x01
    //                 Path properties (U_DRAW_*)                    TEXT      ALTERS    ONLYTO    VISIBLE   
    //                                                                    PATH      FORCE     CLOSED    NOTEMPTY
-         table[  0] = 0x00;     //   Does not map to any EMR record
-         table[  1] = 0x80;     //   U_EMRHEADER                    1    0    0    0    0    0    0    0 
-         table[  2] = 0x83;     //   U_EMRPOLYBEZIER                1    0    0    0    0    0    1    1
-         table[  3] = 0x87;     //   U_EMRPOLYGON                   1    0    0    0    0    1    1    1
-         table[  4] = 0x83;     //   U_EMRPOLYLINE                  1    0    0    0    0    0    1    1
-         table[  5] = 0x8B;     //   U_EMRPOLYBEZIERTO              1    0    0    0    1    0    1    1
-         table[  6] = 0x8B;     //   U_EMRPOLYLINETO                1    0    0    0    1    0    1    1
-         table[  7] = 0x83;     //   U_EMRPOLYPOLYLINE              1    0    0    0    0    0    1    1
-         table[  8] = 0x87;     //   U_EMRPOLYPOLYGON               1    0    0    0    0    1    1    1
-         table[  9] = 0xA0;     //   U_EMRSETWINDOWEXTEX            1    0    1    0    0    0    0    0
-         table[ 10] = 0xA0;     //   U_EMRSETWINDOWORGEX            1    0    1    0    0    0    0    0
-         table[ 11] = 0xA0;     //   U_EMRSETVIEWPORTEXTEX          1    0    1    0    0    0    0    0
-         table[ 12] = 0xA0;     //   U_EMRSETVIEWPORTORGEX          1    0    1    0    0    0    0    0
-         table[ 13] = 0xA0;     //   U_EMRSETBRUSHORGEX             1    0    1    0    0    0    0    0
-         table[ 14] = 0x82;     //   U_EMREOF                       1    0    1    0    0    0    0    0  Force out any pending draw
-         table[ 15] = 0x82;     //   U_EMRSETPIXELV                 1    0    0    0    0    0    1    0
-         table[ 16] = 0xA0;     //   U_EMRSETMAPPERFLAGS            1    0    1    0    0    0    0    0
-         table[ 17] = 0xA0;     //   U_EMRSETMAPMODE                1    0    1    0    0    0    0    0
-         table[ 18] = 0x20;     //   U_EMRSETBKMODE                 0    0    1    0    0    0    0    0
-         table[ 19] = 0xA0;     //   U_EMRSETPOLYFILLMODE           1    0    1    0    0    0    0    0
-         table[ 20] = 0xA0;     //   U_EMRSETROP2                   1    0    1    0    0    0    0    0
-         table[ 21] = 0xA0;     //   U_EMRSETSTRETCHBLTMODE         1    0    1    0    0    0    0    0
-         table[ 22] = 0x20;     //   U_EMRSETTEXTALIGN              0    0    1    0    0    0    0    0
-         table[ 23] = 0xA0;     //   U_EMRSETCOLORADJUSTMENT        1    0    1    0    0    0    0    0
-         table[ 24] = 0x20;     //   U_EMRSETTEXTCOLOR              0    0    1    0    0    0    0    0
-         table[ 25] = 0x20;     //   U_EMRSETBKCOLOR                0    0    1    0    0    0    0    0
-         table[ 26] = 0xA0;     //   U_EMROFFSETCLIPRGN             1    0    1    0    0    0    0    0
-         table[ 27] = 0x89;     //   U_EMRMOVETOEX                  1    0    0    0    1    0    0    1
-         table[ 28] = 0xA0;     //   U_EMRSETMETARGN                1    0    1    0    0    0    0    0
-         table[ 29] = 0xA0;     //   U_EMREXCLUDECLIPRECT           1    0    1    0    0    0    0    0
-         table[ 30] = 0xA0;     //   U_EMRINTERSECTCLIPRECT         1    0    1    0    0    0    0    0
-         table[ 31] = 0xA0;     //   U_EMRSCALEVIEWPORTEXTEX        1    0    1    0    0    0    0    0
-         table[ 32] = 0xA0;     //   U_EMRSCALEWINDOWEXTEX          1    0    1    0    0    0    0    0
-         table[ 33] = 0xA0;     //   U_EMRSAVEDC                    1    0    1    0    0    0    0    0
-         table[ 34] = 0xA0;     //   U_EMRRESTOREDC                 1    0    1    0    0    0    0    0
-         table[ 35] = 0xA0;     //   U_EMRSETWORLDTRANSFORM         1    0    1    0    0    0    0    0
-         table[ 36] = 0xA0;     //   U_EMRMODIFYWORLDTRANSFORM      1    0    1    0    0    0    0    0
-         table[ 37] = 0x20;     //   U_EMRSELECTOBJECT              0    0    1    0    0    0    0    0
-         table[ 38] = 0x20;     //   U_EMRCREATEPEN                 0    0    1    0    0    0    0    0
-         table[ 39] = 0x20;     //   U_EMRCREATEBRUSHINDIRECT       0    0    1    0    0    0    0    0
-         table[ 40] = 0x20;     //   U_EMRDELETEOBJECT              0    0    1    0    0    0    0    0
-         table[ 41] = 0x83;     //   U_EMRANGLEARC                  1    0    0    0    0    0    1    1
-         table[ 42] = 0x87;     //   U_EMRELLIPSE                   1    0    0    0    0    1    1    1
-         table[ 43] = 0x87;     //   U_EMRRECTANGLE                 1    0    0    0    0    1    1    1
-         table[ 44] = 0x87;     //   U_EMRROUNDRECT                 1    0    0    0    0    1    1    1
-         table[ 45] = 0x83;     //   U_EMRARC                       1    0    0    0    0    0    1    1
-         table[ 46] = 0x87;     //   U_EMRCHORD                     1    0    0    0    0    1    1    1
-         table[ 47] = 0x87;     //   U_EMRPIE                       1    0    0    0    0    1    1    1
-         table[ 48] = 0xA0;     //   U_EMRSELECTPALETTE             1    0    1    0    0    0    0    0
-         table[ 49] = 0xA0;     //   U_EMRCREATEPALETTE             1    0    1    0    0    0    0    0
-         table[ 50] = 0xA0;     //   U_EMRSETPALETTEENTRIES         1    0    1    0    0    0    0    0
-         table[ 51] = 0xA0;     //   U_EMRRESIZEPALETTE             1    0    1    0    0    0    0    0
-         table[ 52] = 0xA0;     //   U_EMRREALIZEPALETTE            1    0    1    0    0    0    0    0
-         table[ 53] = 0x82;     //   U_EMREXTFLOODFILL              1    0    0    0    0    0    1    0
-         table[ 54] = 0x8B;     //   U_EMRLINETO                    1    0    0    0    1    0    1    1
-         table[ 55] = 0x8B;     //   U_EMRARCTO                     1    0    0    0    1    0    1    1
-         table[ 56] = 0x83;     //   U_EMRPOLYDRAW                  1    0    0    0    0    0    1    1
-         table[ 57] = 0xA0;     //   U_EMRSETARCDIRECTION           1    0    1    0    0    0    0    0
-         table[ 58] = 0xA0;     //   U_EMRSETMITERLIMIT             1    0    1    0    0    0    0    0
-         table[ 59] = 0xE0;     //   U_EMRBEGINPATH                 1    1    1    0    0    0    0    0
-         table[ 60] = 0x80;     //   U_EMRENDPATH                   1    0    0    0    0    0    0    0
-         table[ 61] = 0x84;     //   U_EMRCLOSEFIGURE               1    0    0    0    0    1    0    0
-         table[ 62] = 0x94;     //   U_EMRFILLPATH                  1    0    0    1    0    1    0    0
-         table[ 63] = 0x94;     //   U_EMRSTROKEANDFILLPATH         1    0    0    1    0    1    0    0
-         table[ 64] = 0x90;     //   U_EMRSTROKEPATH                1    0    0    1    0    0    0    0
-         table[ 65] = 0xA0;     //   U_EMRFLATTENPATH               1    0    1    0    0    0    0    0
-         table[ 66] = 0xA0;     //   U_EMRWIDENPATH                 1    0    1    0    0    0    0    0
-         table[ 67] = 0x80;     //   U_EMRSELECTCLIPPATH            1    0    0    0    0    0    0    0  consumes the path, draws nothing
-         table[ 68] = 0xA0;     //   U_EMRABORTPATH                 1    0    1    0    0    0    0    0
-         table[ 69] = 0xA0;     //   U_EMRUNDEF69                   1    0    1    0    0    0    0    0
-         table[ 70] = 0x00;     //   U_EMRCOMMENT                   0    0    0    0    0    0    0    0
-         table[ 71] = 0x82;     //   U_EMRFILLRGN                   1    0    0    0    0    0    1    0
-         table[ 72] = 0x82;     //   U_EMRFRAMERGN                  1    0    0    0    0    0    1    0
-         table[ 73] = 0x82;     //   U_EMRINVERTRGN                 1    0    0    0    0    0    1    0
-         table[ 74] = 0x82;     //   U_EMRPAINTRGN                  1    0    0    0    0    0    1    0
-         table[ 75] = 0xA0;     //   U_EMREXTSELECTCLIPRGN          1    0    1    0    0    0    0    0
-         table[ 76] = 0x82;     //   U_EMRBITBLT                    1    0    0    0    0    0    1    0
-         table[ 77] = 0x82;     //   U_EMRSTRETCHBLT                1    0    0    0    0    0    1    0
-         table[ 78] = 0x82;     //   U_EMRMASKBLT                   1    0    0    0    0    0    1    0
-         table[ 79] = 0x82;     //   U_EMRPLGBLT                    1    0    0    0    0    0    1    0
-         table[ 80] = 0xA0;     //   U_EMRSETDIBITSTODEVICE         1    0    1    0    0    0    0    0
-         table[ 81] = 0xA0;     //   U_EMRSTRETCHDIBITS             1    0    1    0    0    0    0    0
-         table[ 82] = 0x20;     //   U_EMREXTCREATEFONTINDIRECTW    0    0    1    0    0    0    0    0
-         table[ 83] = 0x02;     //   U_EMREXTTEXTOUTA               0    0    0    0    0    0    1    0
-         table[ 84] = 0x02;     //   U_EMREXTTEXTOUTW               0    0    0    0    0    0    1    0
-         table[ 85] = 0x83;     //   U_EMRPOLYBEZIER16              1    0    0    0    0    0    1    1
-         table[ 86] = 0x83;     //   U_EMRPOLYGON16                 1    0    0    0    0    0    1    1
-         table[ 87] = 0x83;     //   U_EMRPOLYLINE16                1    0    0    0    0    0    1    1
-         table[ 88] = 0x8B;     //   U_EMRPOLYBEZIERTO16            1    0    0    0    1    0    1    1
-         table[ 89] = 0x8B;     //   U_EMRPOLYLINETO16              1    0    0    0    1    0    1    1
-         table[ 90] = 0x83;     //   U_EMRPOLYPOLYLINE16            1    0    0    0    0    0    1    1
-         table[ 91] = 0x87;     //   U_EMRPOLYPOLYGON16             1    0    0    0    0    1    1    1
-         table[ 92] = 0x83;     //   U_EMRPOLYDRAW16                1    0    0    0    0    0    1    1
-         table[ 93] = 0x80;     //   U_EMRCREATEMONOBRUSH           1    0    0    0    0    0    0    0  Not selected yet, so no change in drawing conditions
-         table[ 94] = 0x80;     //   U_EMRCREATEDIBPATTERNBRUSHPT   1    0    0    0    0    0    0    0  "
-         table[ 95] = 0x00;     //   U_EMREXTCREATEPEN              0    0    0    0    0    0    0    0  "
-         table[ 96] = 0x02;     //   U_EMRPOLYTEXTOUTA              0    0    0    0    0    0    1    0
-         table[ 97] = 0x02;     //   U_EMRPOLYTEXTOUTW              0    0    0    0    0    0    1    0
-         table[ 98] = 0xA0;     //   U_EMRSETICMMODE                1    0    1    0    0    0    0    0
-         table[ 99] = 0xA0;     //   U_EMRCREATECOLORSPACE          1    0    1    0    0    0    0    0
-         table[100] = 0xA0;     //   U_EMRSETCOLORSPACE             1    0    1    0    0    0    0    0
-         table[101] = 0xA0;     //   U_EMRDELETECOLORSPACE          1    0    1    0    0    0    0    0
-         table[102] = 0xA0;     //   U_EMRGLSRECORD                 1    0    1    0    0    0    0    0
-         table[103] = 0xA0;     //   U_EMRGLSBOUNDEDRECORD          1    0    1    0    0    0    0    0
-         table[104] = 0xA0;     //   U_EMRPIXELFORMAT               1    0    1    0    0    0    0    0
-         table[105] = 0xA0;     //   U_EMRDRAWESCAPE                1    0    1    0    0    0    0    0
-         table[106] = 0xA0;     //   U_EMREXTESCAPE                 1    0    1    0    0    0    0    0
-         table[107] = 0xA0;     //   U_EMRUNDEF107                  1    0    1    0    0    0    0    0
-         table[108] = 0x02;     //   U_EMRSMALLTEXTOUT              0    0    0    0    0    0    1    0
-         table[109] = 0xA0;     //   U_EMRFORCEUFIMAPPING           1    0    1    0    0    0    0    0
-         table[110] = 0xA0;     //   U_EMRNAMEDESCAPE               1    0    1    0    0    0    0    0
-         table[111] = 0xA0;     //   U_EMRCOLORCORRECTPALETTE       1    0    1    0    0    0    0    0
-         table[112] = 0xA0;     //   U_EMRSETICMPROFILEA            1    0    1    0    0    0    0    0
-         table[113] = 0xA0;     //   U_EMRSETICMPROFILEW            1    0    1    0    0    0    0    0
-         table[114] = 0x82;     //   U_EMRALPHABLEND                1    0    0    0    0    0    1    0
-         table[115] = 0xA0;     //   U_EMRSETLAYOUT                 1    0    1    0    0    0    0    0
-         table[116] = 0x82;     //   U_EMRTRANSPARENTBLT            1    0    0    0    0    0    1    0
-         table[117] = 0xA0;     //   U_EMRUNDEF117                  1    0    1    0    0    0    0    0
-         table[118] = 0x82;     //   U_EMRGRADIENTFILL              1    0    1    0    0    0    1    0
-         table[119] = 0xA0;     //   U_EMRSETLINKEDUFIS             1    0    1    0    0    0    0    0
-         table[120] = 0x20;     //   U_EMRSETTEXTJUSTIFICATION      0    0    1    0    0    0    0    0
-         table[121] = 0xA0;     //   U_EMRCOLORMATCHTOTARGETW       1    0    1    0    0    0    0    0
-         table[122] = 0xA0;     //   U_EMRCREATECOLORSPACEW         1    0    1    0    0    0    0    0
-      }
-      result = table[type];
-   }
-   return(result);
+      [  0] = 0x00,     //   Does not map to any EMR record
+      [  1] = 0x80,     //   U_EMRHEADER                    1    0    0    0    0    0    0    0 
+      [  2] = 0x83,     //   U_EMRPOLYBEZIER                1    0    0    0    0    0    1    1
+      [  3] = 0x87,     //   U_EMRPOLYGON                   1    0    0    0    0    1    1    1
+      [  4] = 0x83,     //   U_EMRPOLYLINE                  1    0    0    0    0    0    1    1
+      [  5] = 0x8B,     //   U_EMRPOLYBEZIERTO              1    0    0    0    1    0    1    1
+      [  6] = 0x8B,     //   U_EMRPOLYLINETO                1    0    0    0    1    0    1    1
+      [  7] = 0x83,     //   U_EMRPOLYPOLYLINE              1    0    0    0    0    0    1    1
+      [  8] = 0x87,     //   U_EMRPOLYPOLYGON               1    0    0    0    0    1    1    1
+      [  9] = 0xA0,     //   U_EMRSETWINDOWEXTEX            1    0    1    0    0    0    0    0
+      [ 10] = 0xA0,     //   U_EMRSETWINDOWORGEX            1    0    1    0    0    0    0    0
+      [ 11] = 0xA0,     //   U_EMRSETVIEWPORTEXTEX          1    0    1    0    0    0    0    0
+      [ 12] = 0xA0,     //   U_EMRSETVIEWPORTORGEX          1    0    1    0    0    0    0    0
+      [ 13] = 0xA0,     //   U_EMRSETBRUSHORGEX             1    0    1    0    0    0    0    0
+      [ 14] = 0x82,     //   U_EMREOF                       1    0    1    0    0    0    0    0  Force out any pending draw
+      [ 15] = 0x82,     //   U_EMRSETPIXELV                 1    0    0    0    0    0    1    0
+      [ 16] = 0xA0,     //   U_EMRSETMAPPERFLAGS            1    0    1    0    0    0    0    0
+      [ 17] = 0xA0,     //   U_EMRSETMAPMODE                1    0    1    0    0    0    0    0
+      [ 18] = 0x20,     //   U_EMRSETBKMODE                 0    0    1    0    0    0    0    0
+      [ 19] = 0xA0,     //   U_EMRSETPOLYFILLMODE           1    0    1    0    0    0    0    0
+      [ 20] = 0xA0,     //   U_EMRSETROP2                   1    0    1    0    0    0    0    0
+      [ 21] = 0xA0,     //   U_EMRSETSTRETCHBLTMODE         1    0    1    0    0    0    0    0
+      [ 22] = 0x20,     //   U_EMRSETTEXTALIGN              0    0    1    0    0    0    0    0
+      [ 23] = 0xA0,     //   U_EMRSETCOLORADJUSTMENT        1    0    1    0    0    0    0    0
+      [ 24] = 0x20,     //   U_EMRSETTEXTCOLOR              0    0    1    0    0    0    0    0
+      [ 25] = 0x20,     //   U_EMRSETBKCOLOR                0    0    1    0    0    0    0    0
+      [ 26] = 0xA0,     //   U_EMROFFSETCLIPRGN             1    0    1    0    0    0    0    0
+      [ 27] = 0x89,     //   U_EMRMOVETOEX                  1    0    0    0    1    0    0    1
+      [ 28] = 0xA0,     //   U_EMRSETMETARGN                1    0    1    0    0    0    0    0
+      [ 29] = 0xA0,     //   U_EMREXCLUDECLIPRECT           1    0    1    0    0    0    0    0
+      [ 30] = 0xA0,     //   U_EMRINTERSECTCLIPRECT         1    0    1    0    0    0    0    0
+      [ 31] = 0xA0,     //   U_EMRSCALEVIEWPORTEXTEX        1    0    1    0    0    0    0    0
+      [ 32] = 0xA0,     //   U_EMRSCALEWINDOWEXTEX          1    0    1    0    0    0    0    0
+      [ 33] = 0xA0,     //   U_EMRSAVEDC                    1    0    1    0    0    0    0    0
+      [ 34] = 0xA0,     //   U_EMRRESTOREDC                 1    0    1    0    0    0    0    0
+      [ 35] = 0xA0,     //   U_EMRSETWORLDTRANSFORM         1    0    1    0    0    0    0    0
+      [ 36] = 0xA0,     //   U_EMRMODIFYWORLDTRANSFORM      1    0    1    0    0    0    0    0
+      [ 37] = 0x20,     //   U_EMRSELECTOBJECT              0    0    1    0    0    0    0    0
+      [ 38] = 0x20,     //   U_EMRCREATEPEN                 0    0    1    0    0    0    0    0
+      [ 39] = 0x20,     //   U_EMRCREATEBRUSHINDIRECT       0    0    1    0    0    0    0    0
+      [ 40] = 0x20,     //   U_EMRDELETEOBJECT              0    0    1    0    0    0    0    0
+      [ 41] = 0x83,     //   U_EMRANGLEARC                  1    0    0    0    0    0    1    1
+      [ 42] = 0x87,     //   U_EMRELLIPSE                   1    0    0    0    0    1    1    1
+      [ 43] = 0x87,     //   U_EMRRECTANGLE                 1    0    0    0    0    1    1    1
+      [ 44] = 0x87,     //   U_EMRROUNDRECT                 1    0    0    0    0    1    1    1
+      [ 45] = 0x83,     //   U_EMRARC                       1    0    0    0    0    0    1    1
+      [ 46] = 0x87,     //   U_EMRCHORD                     1    0    0    0    0    1    1    1
+      [ 47] = 0x87,     //   U_EMRPIE                       1    0    0    0    0    1    1    1
+      [ 48] = 0xA0,     //   U_EMRSELECTPALETTE             1    0    1    0    0    0    0    0
+      [ 49] = 0xA0,     //   U_EMRCREATEPALETTE             1    0    1    0    0    0    0    0
+      [ 50] = 0xA0,     //   U_EMRSETPALETTEENTRIES         1    0    1    0    0    0    0    0
+      [ 51] = 0xA0,     //   U_EMRRESIZEPALETTE             1    0    1    0    0    0    0    0
+      [ 52] = 0xA0,     //   U_EMRREALIZEPALETTE            1    0    1    0    0    0    0    0
+      [ 53] = 0x82,     //   U_EMREXTFLOODFILL              1    0    0    0    0    0    1    0
+      [ 54] = 0x8B,     //   U_EMRLINETO                    1    0    0    0    1    0    1    1
+      [ 55] = 0x8B,     //   U_EMRARCTO                     1    0    0    0    1    0    1    1
+      [ 56] = 0x83,     //   U_EMRPOLYDRAW                  1    0    0    0    0    0    1    1
+      [ 57] = 0xA0,     //   U_EMRSETARCDIRECTION           1    0    1    0    0    0    0    0
+      [ 58] = 0xA0,     //   U_EMRSETMITERLIMIT             1    0    1    0    0    0    0    0
+      [ 59] = 0xE0,     //   U_EMRBEGINPATH                 1    1    1    0    0    0    0    0
+      [ 60] = 0x80,     //   U_EMRENDPATH                   1    0    0    0    0    0    0    0
+      [ 61] = 0x84,     //   U_EMRCLOSEFIGURE               1    0    0    0    0    1    0    0
+      [ 62] = 0x94,     //   U_EMRFILLPATH                  1    0    0    1    0    1    0    0
+      [ 63] = 0x94,     //   U_EMRSTROKEANDFILLPATH         1    0    0    1    0    1    0    0
+      [ 64] = 0x90,     //   U_EMRSTROKEPATH                1    0    0    1    0    0    0    0
+      [ 65] = 0xA0,     //   U_EMRFLATTENPATH               1    0    1    0    0    0    0    0
+      [ 66] = 0xA0,     //   U_EMRWIDENPATH                 1    0    1    0    0    0    0    0
+      [ 67] = 0x80,     //   U_EMRSELECTCLIPPATH            1    0    0    0    0    0    0    0  consumes the path, draws nothing
+      [ 68] = 0xA0,     //   U_EMRABORTPATH                 1    0    1    0    0    0    0    0
+      [ 69] = 0xA0,     //   U_EMRUNDEF69                   1    0    1    0    0    0    0    0
+      [ 70] = 0x00,     //   U_EMRCOMMENT                   0    0    0    0    0    0    0    0
+      [ 71] = 0x82,     //   U_EMRFILLRGN                   1    0    0    0    0    0    1    0
+      [ 72] = 0x82,     //   U_EMRFRAMERGN                  1    0    0    0    0    0    1    0
+      [ 73] = 0x82,     //   U_EMRINVERTRGN                 1    0    0    0    0    0    1    0
+      [ 74] = 0x82,     //   U_EMRPAINTRGN                  1    0    0    0    0    0    1    0
+      [ 75] = 0xA0,     //   U_EMREXTSELECTCLIPRGN          1    0    1    0    0    0    0    0
+      [ 76] = 0x82,     //   U_EMRBITBLT                    1    0    0    0    0    0    1    0
+      [ 77] = 0x82,     //   U_EMRSTRETCHBLT                1    0    0    0    0    0    1    0
+      [ 78] = 0x82,     //   U_EMRMASKBLT                   1    0    0    0    0    0    1    0
+      [ 79] = 0x82,     //   U_EMRPLGBLT                    1    0    0    0    0    0    1    0
+      [ 80] = 0xA0,     //   U_EMRSETDIBITSTODEVICE         1    0    1    0    0    0    0    0
+      [ 81] = 0xA0,     //   U_EMRSTRETCHDIBITS             1    0    1    0    0    0    0    0
+      [ 82] = 0x20,     //   U_EMREXTCREATEFONTINDIRECTW    0    0    1    0    0    0    0    0
+      [ 83] = 0x02,     //   U_EMREXTTEXTOUTA               0    0    0    0    0    0    1    0
+      [ 84] = 0x02,     //   U_EMREXTTEXTOUTW               0    0    0    0    0    0    1    0
+      [ 85] = 0x83,     //   U_EMRPOLYBEZIER16              1    0    0    0    0    0    1    1
+      [ 86] = 0x83,     //   U_EMRPOLYGON16                 1    0    0    0    0    0    1    1
+      [ 87] = 0x83,     //   U_EMRPOLYLINE16                1    0    0    0    0    0    1    1
+      [ 88] = 0x8B,     //   U_EMRPOLYBEZIERTO16            1    0    0    0    1    0    1    1
+      [ 89] = 0x8B,     //   U_EMRPOLYLINETO16              1    0    0    0    1    0    1    1
+      [ 90] = 0x83,     //   U_EMRPOLYPOLYLINE16            1    0    0    0    0    0    1    1
+      [ 91] = 0x87,     //   U_EMRPOLYPOLYGON16             1    0    0    0    0    1    1    1
+      [ 92] = 0x83,     //   U_EMRPOLYDRAW16                1    0    0    0    0    0    1    1
+      [ 93] = 0x80,     //   U_EMRCREATEMONOBRUSH           1    0    0    0    0    0    0    0  Not selected yet, so no change in drawing conditions
+      [ 94] = 0x80,     //   U_EMRCREATEDIBPATTERNBRUSHPT   1    0    0    0    0    0    0    0  "
+      [ 95] = 0x00,     //   U_EMREXTCREATEPEN              0    0    0    0    0    0    0    0  "
+      [ 96] = 0x02,     //   U_EMRPOLYTEXTOUTA              0    0    0    0    0    0    1    0
+      [ 97] = 0x02,     //   U_EMRPOLYTEXTOUTW              0    0    0    0    0    0    1    0
+      [ 98] = 0xA0,     //   U_EMRSETICMMODE                1    0    1    0    0    0    0    0
+      [ 99] = 0xA0,     //   U_EMRCREATECOLORSPACE          1    0    1    0    0    0    0    0
+      [100] = 0xA0,     //   U_EMRSETCOLORSPACE             1    0    1    0    0    0    0    0
+      [101] = 0xA0,     //   U_EMRDELETECOLORSPACE          1    0    1    0    0    0    0    0
+      [102] = 0xA0,     //   U_EMRGLSRECORD                 1    0    1    0    0    0    0    0
+      [103] = 0xA0,     //   U_EMRGLSBOUNDEDRECORD          1    0    1    0    0    0    0    0
+      [104] = 0xA0,     //   U_EMRPIXELFORMAT               1    0    1    0    0    0    0    0
+      [105] = 0xA0,     //   U_EMRDRAWESCAPE                1    0    1    0    0    0    0    0
+      [106] = 0xA0,     //   U_EMREXTESCAPE                 1    0    1    0    0    0    0    0
+      [107] = 0xA0,     //   U_EMRUNDEF107                  1    0    1    0    0    0    0    0
+      [108] = 0x02,     //   U_EMRSMALLTEXTOUT              0    0    0    0    0    0    1    0
+      [109] = 0xA0,     //   U_EMRFORCEUFIMAPPING           1    0    1    0    0    0    0    0
+      [110] = 0xA0,     //   U_EMRNAMEDESCAPE               1    0    1    0    0    0    0    0
+      [111] = 0xA0,     //   U_EMRCOLORCORRECTPALETTE       1    0    1    0    0    0    0    0
+      [112] = 0xA0,     //   U_EMRSETICMPROFILEA            1    0    1    0    0    0    0    0
+      [113] = 0xA0,     //   U_EMRSETICMPROFILEW            1    0    1    0    0    0    0    0
+      [114] = 0x82,     //   U_EMRALPHABLEND                1    0    0    0    0    0    1    0
+      [115] = 0xA0,     //   U_EMRSETLAYOUT                 1    0    1    0    0    0    0    0
+      [116] = 0x82,     //   U_EMRTRANSPARENTBLT            1    0    0    0    0    0    1    0
+      [117] = 0xA0,     //   U_EMRUNDEF117                  1    0    1    0    0    0    0    0
+      [118] = 0x82,     //   U_EMRGRADIENTFILL              1    0    1    0    0    0    1    0
+      [119] = 0xA0,     //   U_EMRSETLINKEDUFIS             1    0    1    0    0    0    0    0
+      [120] = 0x20,     //   U_EMRSETTEXTJUSTIFICATION      0    0    1    0    0    0    0    0
+      [121] = 0xA0,     //   U_EMRCOLORMATCHTOTARGETW       1    0    1    0    0    0    0    0
+      [122] = 0xA0,     //   U_EMRCREATECOLORSPACEW         1    0    1    0    0    0    0    0
+   };
+   if(type>=1 && type<=U_EMR_MAX)return(table[type]);
+   return(U_EMR_INVALID);  // out of range, including U_EMR_INVALID
 }
 
 /**
@@ -603,13 +614,365 @@ int emr_arc_points(
     return emr_arc_points_common(&(pEmr->rclBox), &(pEmr->ptlStart), &(pEmr->ptlEnd), f1, f2, center, start, end, size );
 }
 
+//! \cond
+/*  Row kernels for DIB_to_RGBA() and RGBA_to_DIB().  Each converts as many pixels from the start of a row as it
+    can and returns that number, the per pixel code in those functions (the reference implementation) converts
+    the rest.  Vector versions are picked at run time from those the CPU supports.  All of these work on bytes,
+    so the results do not depend on the byte order of the machine.
+*/
+#if !defined(U_DIB_REFERENCE) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define U_DIB_X86 1
+#include <immintrin.h>
+#elif !defined(U_DIB_REFERENCE) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define U_DIB_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if U_DIB_X86
+/* BGRA <-> RGBA, exchange bytes 0 and 2 of each pixel. */
+__attribute__((target("avx2"))) static int dib_swap02_avx2(const uint8_t *src, uint8_t *dst, int w){
+   const __m256i mask = _mm256_setr_epi8(2,1,0,3,6,5,4,7,10,9,8,11,14,13,12,15,2,1,0,3,6,5,4,7,10,9,8,11,14,13,12,15);
+   int j;
+   for(j = 0; j + 8 <= w; j += 8){
+      _mm256_storeu_si256((__m256i *)(dst + 4*j), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(src + 4*j)), mask));
+   }
+   return(j);
+}
+
+__attribute__((target("sse2"))) static int dib_swap02_sse2(const uint8_t *src, uint8_t *dst, int w){
+   const __m128i ga = _mm_set1_epi32(0xFF00FF00);
+   const __m128i lo = _mm_set1_epi32(0x000000FF);
+   __m128i v;
+   int j;
+   for(j = 0; j + 4 <= w; j += 4){
+      v = _mm_loadu_si128((const __m128i *)(src + 4*j));
+      v = _mm_or_si128(_mm_and_si128(v, ga),
+          _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 16), lo), _mm_slli_epi32(_mm_and_si128(v, lo), 16)));
+      _mm_storeu_si128((__m128i *)(dst + 4*j), v);
+   }
+   return(j);
+}
+
+/* BGR -> RGBA with A = 0.  Each load reads 16 bytes for 4 pixels, so stop while 6 or more pixels remain. */
+__attribute__((target("ssse3"))) static int dib_bgr_to_rgba_ssse3(const uint8_t *src, uint8_t *dst, int w){
+   const __m128i mask = _mm_setr_epi8(2,1,0,-128,5,4,3,-128,8,7,6,-128,11,10,9,-128);
+   int j;
+   for(j = 0; j + 6 <= w; j += 4){
+      _mm_storeu_si128((__m128i *)(dst + 4*j), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 3*j)), mask));
+   }
+   return(j);
+}
+
+/* RGBA -> BGR.  Each store writes 16 bytes for 4 pixels, the last 4 are overwritten by the next pixels. */
+__attribute__((target("ssse3"))) static int dib_rgba_to_bgr_ssse3(const uint8_t *src, uint8_t *dst, int w){
+   const __m128i mask = _mm_setr_epi8(2,1,0,6,5,4,10,9,8,14,13,12,-128,-128,-128,-128);
+   int j;
+   for(j = 0; j + 6 <= w; j += 4){
+      _mm_storeu_si128((__m128i *)(dst + 3*j), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 4*j)), mask));
+   }
+   return(j);
+}
+
+/* 5-5-5 Little Endian 16 bit -> RGBA with A = 0. */
+__attribute__((target("sse2"))) static int dib_555_to_rgba_sse2(const uint8_t *src, uint8_t *dst, int w){
+   const __m128i m5 = _mm_set1_epi16(0x1F);
+   __m128i v, r, g, b, rg;
+   int j;
+   for(j = 0; j + 8 <= w; j += 8){
+      v  = _mm_loadu_si128((const __m128i *)(src + 2*j));
+      b  = _mm_slli_epi16(_mm_and_si128(v, m5), 3);
+      g  = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(v,  5), m5), 3);
+      r  = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(v, 10), m5), 3);
+      rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+      _mm_storeu_si128((__m128i *)(dst + 4*j),      _mm_unpacklo_epi16(rg, b));
+      _mm_storeu_si128((__m128i *)(dst + 4*j + 16), _mm_unpackhi_epi16(rg, b));
+   }
+   return(j);
+}
+
+/* RGBA -> 5-5-5 Little Endian 16 bit, the top bit is 0. */
+__attribute__((target("sse2"))) static __m128i dib_rgba4_to_555_sse2(__m128i p){
+   const __m128i m5 = _mm_set1_epi32(0xF8);
+   __m128i r, g, b;
+   r = _mm_slli_epi32(_mm_and_si128(p, m5), 7);                       // bits 3-7  -> 10-14
+   g = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(p,  8), m5), 2);   // bits 11-15 -> 5-9
+   b = _mm_srli_epi32(_mm_and_si128(_mm_srli_epi32(p, 16), m5), 3);   // bits 19-23 -> 0-4
+   return(_mm_or_si128(r, _mm_or_si128(g, b)));
+}
+
+__attribute__((target("sse2"))) static int dib_rgba_to_555_sse2(const uint8_t *src, uint8_t *dst, int w){
+   __m128i lo, hi;
+   int j;
+   for(j = 0; j + 8 <= w; j += 8){
+      lo = dib_rgba4_to_555_sse2(_mm_loadu_si128((const __m128i *)(src + 4*j)));
+      hi = dib_rgba4_to_555_sse2(_mm_loadu_si128((const __m128i *)(src + 4*j + 16)));
+      _mm_storeu_si128((__m128i *)(dst + 2*j), _mm_packs_epi32(lo, hi));  // values are < 0x8000, no saturation
+   }
+   return(j);
+}
+#endif /* U_DIB_X86 */
+
+#if U_DIB_NEON
+static int dib_swap02_neon(const uint8_t *src, uint8_t *dst, int w){
+   uint8x16x4_t v;
+   uint8x16_t   t;
+   int j;
+   for(j = 0; j + 16 <= w; j += 16){
+      v = vld4q_u8(src + 4*j);
+      t = v.val[0]; v.val[0] = v.val[2]; v.val[2] = t;
+      vst4q_u8(dst + 4*j, v);
+   }
+   return(j);
+}
+
+static int dib_bgr_to_rgba_neon(const uint8_t *src, uint8_t *dst, int w){
+   uint8x16x3_t s;
+   uint8x16x4_t d;
+   int j;
+   d.val[3] = vdupq_n_u8(0);
+   for(j = 0; j + 16 <= w; j += 16){
+      s = vld3q_u8(src + 3*j);
+      d.val[0] = s.val[2]; d.val[1] = s.val[1]; d.val[2] = s.val[0];
+      vst4q_u8(dst + 4*j, d);
+   }
+   return(j);
+}
+
+static int dib_rgba_to_bgr_neon(const uint8_t *src, uint8_t *dst, int w){
+   uint8x16x4_t s;
+   uint8x16x3_t d;
+   int j;
+   for(j = 0; j + 16 <= w; j += 16){
+      s = vld4q_u8(src + 4*j);
+      d.val[0] = s.val[2]; d.val[1] = s.val[1]; d.val[2] = s.val[0];
+      vst3q_u8(dst + 3*j, d);
+   }
+   return(j);
+}
+#endif /* U_DIB_NEON */
+
+/* Color table -> RGBA lookup table.  Indices past the end of the color table give 0,0,0,0. */
+static void dib_palette_lut(uint8_t lut[256][4], const U_RGBQUAD *ct, int numCt){
+   int k;
+   memset(lut, 0, 256*4);
+   if(numCt > 256)numCt = 256;
+   for(k = 0; k < numCt; k++){
+      lut[k][0] = U_BGRAGetR(ct[k]);
+      lut[k][1] = U_BGRAGetG(ct[k]);
+      lut[k][2] = U_BGRAGetB(ct[k]);
+      lut[k][3] = U_BGRAGetA(ct[k]);
+   }
+}
+
+#ifndef U_DIB_REFERENCE
+/* 1, 4, or 8 bit color table indices -> RGBA, always the whole row.  The first pixel is in the top bits of each byte. */
+static int dib_palette_to_rgba(const uint8_t *src, uint8_t *dst, int w, uint32_t colortype, const uint8_t lut[256][4]){
+   int j;
+   switch(colortype){
+      case U_BCBM_MONOCHROME:
+         for(j = 0; j < w; j++, dst += 4){ memcpy(dst, lut[(src[j >> 3] >> (7 - (j & 7))) & 1], 4); }
+         break;
+      case U_BCBM_COLOR4:
+         for(j = 0; j < w; j++, dst += 4){ memcpy(dst, lut[(src[j >> 1] >> ((j & 1) ? 0 : 4)) & 0xF], 4); }
+         break;
+      case U_BCBM_COLOR8:
+         for(j = 0; j < w; j++, dst += 4){ memcpy(dst, lut[src[j]], 4); }
+         break;
+      default:
+         return(0);
+   }
+   return(w);
+}
+#endif /* U_DIB_REFERENCE */
+
+/* One row of a DIB without a color table -> RGBA */
+static int dib_row_to_rgba(const uint8_t *src, uint8_t *dst, int w, uint32_t colortype){
+#if U_DIB_X86
+   switch(colortype){
+      case U_BCBM_COLOR16:
+         if(__builtin_cpu_supports("sse2"))return(dib_555_to_rgba_sse2(src, dst, w));
+         break;
+      case U_BCBM_COLOR24:
+         if(__builtin_cpu_supports("ssse3"))return(dib_bgr_to_rgba_ssse3(src, dst, w));
+         break;
+      case U_BCBM_COLOR32:
+         if(__builtin_cpu_supports("avx2"))return(dib_swap02_avx2(src, dst, w));
+         if(__builtin_cpu_supports("sse2"))return(dib_swap02_sse2(src, dst, w));
+         break;
+   }
+#elif U_DIB_NEON
+   switch(colortype){
+      case U_BCBM_COLOR24: return(dib_bgr_to_rgba_neon(src, dst, w));
+      case U_BCBM_COLOR32: return(dib_swap02_neon(src, dst, w));
+   }
+#else
+   (void) src; (void) dst; (void) w; (void) colortype;
+#endif
+   return(0);
+}
+
+/* One row of RGBA -> a DIB without a color table */
+static int rgba_row_to_dib(const uint8_t *src, uint8_t *dst, int w, uint32_t colortype){
+#if U_DIB_X86
+   switch(colortype){
+      case U_BCBM_COLOR16:
+         if(__builtin_cpu_supports("sse2"))return(dib_rgba_to_555_sse2(src, dst, w));
+         break;
+      case U_BCBM_COLOR24:
+         if(__builtin_cpu_supports("ssse3"))return(dib_rgba_to_bgr_ssse3(src, dst, w));
+         break;
+      case U_BCBM_COLOR32:
+         if(__builtin_cpu_supports("avx2"))return(dib_swap02_avx2(src, dst, w));
+         if(__builtin_cpu_supports("sse2"))return(dib_swap02_sse2(src, dst, w));
+         break;
+   }
+#elif U_DIB_NEON
+   switch(colortype){
+      case U_BCBM_COLOR24: return(dib_rgba_to_bgr_neon(src, dst, w));
+      case U_BCBM_COLOR32: return(dib_swap02_neon(src, dst, w));
+   }
+#else
+   (void) src; (void) dst; (void) w; (void) colortype;
+#endif
+   return(0);
+}
+
+/* One row of RGBA -> a DIB without a color table, including the padding.  Returns 0 on success, 7 if colortype
+   is not supported. */
+static int rgba_to_dib_row(const char *rptr, char *pxptr, int w, uint32_t colortype, int pad){
+   int          j;
+   uint8_t      r,g,b,a,tmp8;
+   j = rgba_row_to_dib((const uint8_t *) rptr, (uint8_t *) pxptr, w, colortype);
+   rptr  += 4*j;
+   pxptr += (colortype/8)*j;
+   for(; j<w; j++){
+       r = *rptr++;
+       g = *rptr++;
+       b = *rptr++;
+       a = *rptr++;
+       switch(colortype){
+          case U_BCBM_COLOR16:        // 2^16 colors. (Several different color methods)) 
+             b /= 8; g /= 8; r /= 8;
+             // Do it in this way so that the bytes are always stored Little Endian
+             tmp8  = b;
+             tmp8 |= g<<5;            // least significant 3 bits of green
+             *pxptr++ = tmp8;
+             tmp8  = g>>3;            // most  significant 2 bits of green (there are only 5 bits of data)
+             tmp8 |= r<<2;
+             *pxptr++ = tmp8;
+             break;           
+          case U_BCBM_COLOR24:        // 2^24 colors. bmiColors is not used. Pixels are U_RGBTRIPLE. 
+             *pxptr++ = b;
+             *pxptr++ = g;
+             *pxptr++ = r;
+             break;          
+          case U_BCBM_COLOR32:        // 2^32 colors. bmiColors is not used. Pixels are U_RGBQUAD.
+             *pxptr++ = b;
+             *pxptr++ = g;
+             *pxptr++ = r;
+             *pxptr++ = a;
+             break;           
+          case U_BCBM_MONOCHROME:     // 2 colors.    bmiColors array has two entries                
+          case U_BCBM_COLOR4:         // 2^4 colors.  bmiColors array has 16 entries                 
+          case U_BCBM_COLOR8:         // 2^8 colors.  bmiColors array has 256 entries                
+          case U_BCBM_EXPLICIT:       // Derinved from JPG or PNG compressed image or ?   
+          default:
+            return(7);                // This should not be possible, but might happen with memory corruption  
+       }
+   }
+   if(pad)memset(pxptr,0,pad);        // not strictly necessary, but set all bytes so that we can find important unset ones with valgrind
+   return(0);
+}
+//! \endcond
+
+//! \cond
+/*  Color table builder for RGBA_to_DIB().  Colors are found with an open addressing hash, so the cost per
+    pixel does not depend on the number of colors.  The color table holds at most 256 entries, so the hash
+    is never more than half full.
+*/
+#define U_CTHASH_BITS  9
+#define U_CTHASH_SIZE  (1 << U_CTHASH_BITS)
+typedef struct {
+    uint32_t   key[U_CTHASH_SIZE];          // color, as a uint32_t in U_RGBQUAD memory order
+    int16_t    index[U_CTHASH_SIZE];        // position in the color table, -1 if the slot is empty
+    int        found;                       // number of colors in the color table
+    int        last;                        // index of the most recent color, or -1 (runs of one color are common)
+    uint32_t   lastkey;                     // the most recent color
+} U_CTHASH;
+
+static void ct_hash_init(U_CTHASH *h){
+   memset(h->index, 0xFF, sizeof(h->index));  // all -1
+   h->found = 0;
+   h->last  = -1;
+}
+
+/* Return the index of color, adding it to the hash and to ct (if not NULL) when it is new.  Returns -1 if there are
+   already numCt colors. */
+static int ct_hash_lookup(U_CTHASH *h, PU_RGBQUAD ct, int numCt, U_RGBQUAD color){
+   uint32_t  key;
+   uint32_t  slot;
+   memcpy(&key, &color, 4);
+   if(h->last >= 0 && key == h->lastkey)return(h->last);
+   slot = (key * 0x9E3779B1U) >> (32 - U_CTHASH_BITS);
+   while(h->index[slot] >= 0){
+      if(h->key[slot] == key)break;
+      slot = (slot + 1) & (U_CTHASH_SIZE - 1);
+   }
+   if(h->index[slot] < 0){  // add a color
+      if(h->found >= numCt)return(-1);  // More colors found than are supported by the color table
+      h->key[slot]   = key;
+      h->index[slot] = h->found;
+      if(ct)ct[h->found] = color;
+      h->found++;
+   }
+   h->lastkey = key;
+   h->last    = h->index[slot];
+   return(h->last);
+}
+
+/* Keep the top bits of each channel, setting the dropped bits to the middle of their range. */
+static U_RGBQUAD ct_quantize(U_RGBQUAD color, int drop){
+   uint8_t  mask, mid;
+   if(!drop)return(color);
+   mask = (uint8_t)(0xFF << drop);
+   mid  = (uint8_t)(1 << (drop - 1));
+   color.Blue     = (color.Blue     & mask) | mid;
+   color.Green    = (color.Green    & mask) | mid;
+   color.Red      = (color.Red      & mask) | mid;
+   color.Reserved = (color.Reserved & mask) | mid;
+   return(color);
+}
+
+/* Find the fewest low order bits that must be dropped from every channel so that the image fits in numCt colors. */
+static int ct_quantize_bits(U_CTHASH *cth, int numCt, const char *rgba_px, int w, int h, int stride){
+   int            drop, i, j, fits;
+   const uint8_t *rptr;
+   for(drop = 0; drop < 8; drop++){
+      ct_hash_init(cth);
+      for(fits = 1, i = 0; fits && i < h; i++){
+         rptr = (const uint8_t *)(rgba_px + i*stride);
+         for(j = 0; j < w; j++, rptr += 4){
+            if(ct_hash_lookup(cth, NULL, numCt, ct_quantize(U_BGRA(rptr[0],rptr[1],rptr[2],rptr[3]), drop)) < 0){ fits = 0; break; }
+         }
+      }
+      if(fits)break;
+   }
+   return(drop);  // 8 leaves a single color, which always fits
+}
+//! \endcond
+
 /**
     \brief Convert a U_RGBA 32 bit pixmap to one of many different types of DIB pixmaps.
     
-    Conversions to formats using color tables assume that the color table can hold every color
-    in the input image.  If that assumption is false then the conversion will fail.  Conversion
+    Conversions to formats using color tables with use_ct = U_CT_BGRA assume that the color table can hold
+    every color in the input image.  If that assumption is false then the conversion will fail.  With
+    use_ct = U_CT_QUANTIZE the same number of low order bits is instead dropped from each channel, as few as
+    possible, until the colors fit.  Conversion
     from 8 bit color to N bit colors (N<8) do so by shifting the appropriate number of bits. 
     
+    Adding U_CT_RLE to use_ct for a 4 or 8 bit DIB returns px compressed by DIB_to_RLE(), the caller must
+    then set biCompression to U_BI_RLE4 or U_BI_RLE8 and biSizeImage to cbPx.
+    
     \return 0 on success, other values on errors.
     \param px         DIB pixel array
     \param cbPx       DIB pixel array size in bytes
@@ -620,7 +983,7 @@ int emr_arc_points(
     \param h          Height of pixel array
     \param stride     Row stride of input pixel array in bytes
     \param colortype  DIB BitCount Enumeration
-    \param use_ct     If true use color table (only for 1-16 bit DIBs).
+    \param use_ct     U_CT_NO, U_CT_BGRA (use color table, only for 1-16 bit DIBs), or U_CT_QUANTIZE, optionally plus U_CT_RLE.
     \param invert     If DIB rows are in opposite order from RGBA rows
 */
 int RGBA_to_DIB(
@@ -638,16 +1001,19 @@ int RGBA_to_DIB(
    ){
    int          bs;
    int          pad;
-   int          i,j,k;
+   int          i,j;
    int          istart, iend, iinc;
    uint8_t      r,g,b,a,tmp8;
    char        *pxptr;
    const char  *rptr;
-   int          found;
    int          usedbytes;
    U_RGBQUAD    color;
    PU_RGBQUAD   lct;
    int32_t      index;
+   int          drop = 0;
+   U_CTHASH     cthash;
+   int          rle;
+   char        *rlepx;
    
    *px=NULL;
    *ct=NULL;
@@ -655,8 +1021,11 @@ int RGBA_to_DIB(
    *cbPx=0;
    // sanity checking
    if(!w || !h || !stride || !colortype || !rgba_px)return(1);
+   rle     = use_ct & U_CT_RLE;
+   use_ct &= ~U_CT_RLE;
    if(use_ct && colortype  >= U_BCBM_COLOR16)return(2);  //color tables not used above 16 bit pixels
    if(!use_ct && colortype < U_BCBM_COLOR16)return(3);   //color tables mandatory for < 16 bit
+   if(rle && colortype != U_BCBM_COLOR4 && colortype != U_BCBM_COLOR8)return(8); //RLE only for 4 and 8 bit
 
    bs = colortype/8;
    if(bs<1){
@@ -672,9 +1041,11 @@ int RGBA_to_DIB(
    if(use_ct){
        *numCt = 1<< colortype;
        if(*numCt >w*h)*numCt=w*h;
-       lct = (PU_RGBQUAD) malloc(*numCt * sizeof(U_RGBQUAD));
+       lct = (PU_RGBQUAD) calloc(*numCt, sizeof(U_RGBQUAD));  // entries beyond the colors found stay 0
        if(!lct)return(5);
        *ct = lct;
+       if(use_ct == U_CT_QUANTIZE)drop = ct_quantize_bits(&cthash, *numCt, rgba_px, w, h, stride);
+       ct_hash_init(&cthash);
    }
    
    if(invert){
@@ -688,102 +1059,65 @@ int RGBA_to_DIB(
      iinc   = 1;
    }
 
-   found = 0;
    tmp8  = 0;
    pxptr = *px;
    for(i=istart; i!=iend; i+=iinc){
       rptr= rgba_px + i*stride;
+      if(!use_ct){
+         if(rgba_to_dib_row(rptr, pxptr, w, colortype, pad))return(7);
+         pxptr += usedbytes + pad;
+         continue;
+      }
       for(j=0; j<w; j++){
           r = *rptr++;
           g = *rptr++;
           b = *rptr++;
           a = *rptr++;
-          if(use_ct){
-             color = U_BGRA(r,g,b,a); // color has order in memory: b,g,r,a, same as EMF+ ARGB
-             index = -1;
-             for(lct = *ct, k=0; k<found; k++,lct++){  // Is this color in the table (VERY inefficient if there are a lot of colors!!!)
-                if(*(uint32_t *)lct != *(uint32_t *) &color)continue;
-                index =k;
-                break;
-             }
-             if(index==-1){  // add a color
-                found++;
-                if(found > *numCt){  // More colors found than are supported by the color table
-                   free(*ct);
-                   free(*px);
-                   *numCt=0;
-                   *cbPx=0;
-                   return(6);
-                }
-                index = found - 1;
-                *lct = color;
-             }
-             switch(colortype){
-                case U_BCBM_MONOCHROME: // 2 colors.    bmiColors array has two entries
-                    tmp8 = tmp8 >> 1;      // This seems wrong, as it fills from the top of each byte.  But it works.
-                    tmp8 |= index << 7;
-                    if(!((j+1) % 8)){
-                       *pxptr++ = tmp8;
-                       tmp8     = 0;
-                    }
-                    break;           
-                case U_BCBM_COLOR4:     // 2^4 colors.  bmiColors array has 16 entries                 
-                    tmp8 = tmp8 << 4;
-                    tmp8 |= index;
-                    if(!((j+1) % 2)){
-                       *pxptr++ = tmp8;
-                       tmp8     = 0;
-                    }
-                    break;           
-                case U_BCBM_COLOR8:     // 2^8 colors.  bmiColors array has 256 entries 
-                    tmp8     = index;               
-                    *pxptr++ = tmp8;
-                    break;           
-                case U_BCBM_COLOR16:    // 2^16 colors. (Several different color methods))
-                case U_BCBM_COLOR24:    // 2^24 colors. bmiColors is not used. Pixels are U_RGBTRIPLE.
-                case U_BCBM_COLOR32:    // 2^32 colors. bmiColors is not used. Pixels are U_RGBQUAD.
-                case U_BCBM_EXPLICIT:   // Derinved from JPG or PNG compressed image or ?   
-                default:
-                    return(7);            // This should not be possible, but might happen with memory corruption  
-             }
+          color = ct_quantize(U_BGRA(r,g,b,a), drop); // color has order in memory: b,g,r,a, same as EMF+ ARGB
+          index = ct_hash_lookup(&cthash, *ct, *numCt, color);
+          if(index==-1){  // More colors found than are supported by the color table
+             free(*ct);
+             free(*px);
+             *ct=NULL;
+             *px=NULL;
+             *numCt=0;
+             *cbPx=0;
+             return(6);
           }
-          else {
-             switch(colortype){
-                case U_BCBM_COLOR16:        // 2^16 colors. (Several different color methods)) 
-                   b /= 8; g /= 8; r /= 8;
-                   // Do it in this way so that the bytes are always stored Little Endian
-                   tmp8  = b;
-                   tmp8 |= g<<5;            // least significant 3 bits of green
-                   *pxptr++ = tmp8;
-                   tmp8  = g>>3;            // most  significant 2 bits of green (there are only 5 bits of data)
-                   tmp8 |= r<<2;
-                   *pxptr++ = tmp8;
-                   break;           
-                case U_BCBM_COLOR24:        // 2^24 colors. bmiColors is not used. Pixels are U_RGBTRIPLE. 
-                   *pxptr++ = b;
-                   *pxptr++ = g;
-                   *pxptr++ = r;
-                   break;          
-                case U_BCBM_COLOR32:        // 2^32 colors. bmiColors is not used. Pixels are U_RGBQUAD.
-                   *pxptr++ = b;
-                   *pxptr++ = g;
-                   *pxptr++ = r;
-                   *pxptr++ = a;
-                   break;           
-                case U_BCBM_MONOCHROME:     // 2 colors.    bmiColors array has two entries                
-                case U_BCBM_COLOR4:         // 2^4 colors.  bmiColors array has 16 entries                 
-                case U_BCBM_COLOR8:         // 2^8 colors.  bmiColors array has 256 entries                
-                case U_BCBM_EXPLICIT:       // Derinved from JPG or PNG compressed image or ?   
-                default:
-                  return(7);                // This should not be possible, but might happen with memory corruption  
-             }
+          switch(colortype){
+             case U_BCBM_MONOCHROME: // 2 colors.    bmiColors array has two entries
+                 tmp8 = tmp8 >> 1;      // This seems wrong, as it fills from the top of each byte.  But it works.
+                 tmp8 |= index << 7;
+                 if(!((j+1) % 8)){
+                    *pxptr++ = tmp8;
+                    tmp8     = 0;
+                 }
+                 break;           
+             case U_BCBM_COLOR4:     // 2^4 colors.  bmiColors array has 16 entries                 
+                 tmp8 = tmp8 << 4;
+                 tmp8 |= index;
+                 if(!((j+1) % 2)){
+                    *pxptr++ = tmp8;
+                    tmp8     = 0;
+                 }
+                 break;           
+             case U_BCBM_COLOR8:     // 2^8 colors.  bmiColors array has 256 entries 
+                 tmp8     = index;               
+                 *pxptr++ = tmp8;
+                 break;           
+             case U_BCBM_COLOR16:    // 2^16 colors. (Several different color methods))
+             case U_BCBM_COLOR24:    // 2^24 colors. bmiColors is not used. Pixels are U_RGBTRIPLE.
+             case U_BCBM_COLOR32:    // 2^32 colors. bmiColors is not used. Pixels are U_RGBQUAD.
+             case U_BCBM_EXPLICIT:   // Derinved from JPG or PNG compressed image or ?   
+             default:
+                 return(7);            // This should not be possible, but might happen with memory corruption  
           }
       }
-      if( use_ct && colortype == U_BCBM_MONOCHROME && (j % 8) ){
+      if( colortype == U_BCBM_MONOCHROME && (j % 8) ){
          *pxptr++ = tmp8;                   // Write last few indices
          tmp8 = 0;
       }
-      if( use_ct && colortype == U_BCBM_COLOR4     && (j % 2) ){
+      if( colortype == U_BCBM_COLOR4     && (j % 2) ){
          *pxptr++ = tmp8;                   // Write last few indices
          tmp8 = 0;
       }
@@ -792,6 +1126,19 @@ int RGBA_to_DIB(
          pxptr += pad;
       }
    } 
+   if(rle){
+      if(DIB_to_RLE(*px, w, h, colortype, &rlepx, cbPx)){
+         free(*ct);
+         free(*px);
+         *ct=NULL;
+         *px=NULL;
+         *numCt=0;
+         *cbPx=0;
+         return(4);
+      }
+      free(*px);
+      *px = rlepx;
+   }
    return(0);
 }
 
@@ -856,7 +1203,8 @@ int get_real_color_icount(
     \param offBmiSrc   Offset to the U_BITMAPINFO
     \param px          pointer to DIB pixel array in pEmr
     \param ct          pointer to DIB color table in pEmr
-    \param numCt       DIB color table number of entries, for PNG or JPG returns the number of bytes in the image
+    \param numCt       DIB color table number of entries, for PNG, JPG, RLE8, or RLE4 returns the number of bytes in the image
+                       (for RLE8 and RLE4 ct is also set, get_real_color_count() gives its number of entries)
     \param width       Width of pixel array
     \param height      Height of pixel array (always returned as a positive number)
     \param colortype   DIB BitCount Enumeration
@@ -891,7 +1239,7 @@ int get_DIB_params(
    }
    if(bic == U_BI_RGB){
       *numCt     = get_real_color_count((const char *) Bmih);
-      if( numCt){ *ct = (PU_RGBQUAD) ((char *)Bmi + sizeof(U_BITMAPINFOHEADER)); }
+      if(*numCt){ *ct = (PU_RGBQUAD) ((char *)Bmi + sizeof(U_BITMAPINFOHEADER)); }
       else {      *ct = NULL;                                                    }                                                                                       
    }
    else if(bic == U_BI_BITFIELDS){ /* to date only encountered once, for 32 bit, from PPT*/
@@ -899,6 +1247,10 @@ int get_DIB_params(
       *ct        = NULL;
       bic        = U_BI_RGB;  /* there seems to be no difference, at least for the 32 bit images */
    }
+   else if(bic == U_BI_RLE8 || bic == U_BI_RLE4){ /* color table as for U_BI_RGB, see RLE_to_RGBA() */
+      *numCt     = Bmih->biSizeImage;
+      *ct        = (PU_RGBQUAD) ((char *)Bmi + sizeof(U_BITMAPINFOHEADER));
+   }
    else {
       *numCt     = Bmih->biSizeImage;
       *ct        = NULL;
@@ -908,4520 +1260,8452 @@ int get_DIB_params(
 }
 
 /**
-    \brief Convert one of many different types of DIB pixmaps to an RGBA 32 bit pixmap.
+    \brief Prepare to convert a DIB pixmap to RGBA one row at a time, see DIB_rows_get().
     
-    \return 0 on success, other values on errors.
+    Nothing is allocated, the U_DIBROWS refers to px and ct, which must remain valid while it is used.
+    Only one row of RGBA pixels (4*w bytes) need exist at a time, so bitmaps of any size may be converted.
+    \return 0 on success, other values on errors (the same as DIB_to_RGBA).
+    \param dr         U_DIBROWS to initialize
     \param px         DIB pixel array
     \param ct         DIB color table
     \param numCt      DIB color table number of entries
-    \param rgba_px    U_RGBA pixel array (32 bits), created by this routine, caller must free.
     \param w          Width of pixel array in the record
     \param h          Height of pixel array in the record
     \param colortype  DIB BitCount Enumeration
     \param use_ct     Kept for symmetry with RGBA_to_DIB, should be set to numCt
     \param invert     If DIB rows are in opposite order from RGBA rows
 */
-int DIB_to_RGBA(
+int DIB_rows_init(
+       U_DIBROWS       *dr,
        const char      *px,
        const U_RGBQUAD *ct,
        int              numCt,
-       char           **rgba_px,
        int              w,
        int              h,
        uint32_t         colortype,
        int              use_ct,
        int              invert
    ){
-   uint32_t     cbRgba_px;
-   int          stride;
    int          bs;
-   int          pad;
-   int          i,j;
-   int          istart, iend, iinc;
-   uint8_t      r,g,b,a,tmp8;
-   const char  *pxptr;
-   char        *rptr;
-   int          usedbytes;
-   U_RGBQUAD    color;
-   int32_t      index;
-   
+
    // sanity checking
+   if(!dr)return(1);
+   memset(dr, 0, sizeof(U_DIBROWS));
    if(!w || !h || !colortype || !px)return(1);
    if(use_ct && colortype  >= U_BCBM_COLOR16)return(2);  //color tables not used above 16 bit pixels
    if(!use_ct && colortype < U_BCBM_COLOR16)return(3);   //color tables mandatory for < 16 bit
    if(use_ct && !numCt)return(4);                        //color table not adequately described
 
-   stride    = w * 4;
-   cbRgba_px = stride * h;
    bs = colortype/8;
    if(bs<1){
-      usedbytes = (w*colortype + 7)/8;      // width of line in fully and partially occupied bytes
+      dr->usedbytes = (w*colortype + 7)/8;  // width of line in fully and partially occupied bytes
    }
    else {
-      usedbytes = w*bs;
+      dr->usedbytes = w*bs;
    }
-   pad = UP4(usedbytes) - usedbytes;        // DIB rows must be aligned on 4 byte boundaries, they are padded at the end to accomplish this.;
-   *rgba_px = (char *) malloc(cbRgba_px);
-   if(!rgba_px)return(4);
+   dr->rowbytes  = UP4(dr->usedbytes);      // DIB rows must be aligned on 4 byte boundaries, they are padded at the end to accomplish this.
+   dr->px        = px;
+   dr->ct        = ct;
+   dr->numCt     = numCt;
+   dr->w         = w;
+   dr->h         = h;
+   dr->colortype = colortype;
+   dr->use_ct    = use_ct;
+   dr->invert    = invert;
+   dr->row       = 0;
+#ifndef U_DIB_REFERENCE
+   if(use_ct)dib_palette_lut(dr->lut, ct, numCt);
+#endif
+   return(0);
+}
+
+/**
+    \brief Prepare to convert the DIB in an EMR record to RGBA one row at a time, see DIB_rows_init().
+    
+    The sizes are not checked here.  Check the record first with its _safe function (see DIB_safe()), which makes
+    sure that every row of the bitmap is within the record.
+    \return 0 on success, other values on errors (the same as DIB_rows_init), 8 if the image is not U_BI_RGB (PNG, JPEG, etc.)
+    \param dr          U_DIBROWS to initialize
+    \param record      pointer to EMR record that has a U_BITMAPINFO and bitmap
+    \param offBitsSrc  Offset to the bitmap
+    \param offBmiSrc   Offset to the U_BITMAPINFO
+*/
+int DIB_rows_from_record(
+       U_DIBROWS       *dr,
+       const char      *record,
+       uint32_t         offBitsSrc,
+       uint32_t         offBmiSrc
+   ){
+   const char      *px;
+   const U_RGBQUAD *ct;
+   uint32_t         numCt, width, height, colortype, invert;
+   if(!dr)return(1);
+   memset(dr, 0, sizeof(U_DIBROWS));
+   if(!record)return(1);
+   if(get_DIB_params(record, offBitsSrc, offBmiSrc, &px, &ct, &numCt, &width, &height, &colortype, &invert) != U_BI_RGB)return(8);
+   return(DIB_rows_init(dr, px, ct, numCt, width, height, colortype, numCt, invert));
+}
+
+/**
+    \brief Convert one row of a DIB pixmap to RGBA.
+    
+    \return 0 on success, 1 if row is out of range or dr was not initialized, 7 if the colortype is not supported.
+    \param dr         U_DIBROWS set up by DIB_rows_init() or DIB_rows_from_record()
+    \param row        Row of the RGBA pixmap, 0 to h-1.  Rows are in the order DIB_to_RGBA() would place them.
+    \param rgba_row   Receives the row, 4*w bytes.
+*/
+int DIB_rows_get(
+       const U_DIBROWS *dr,
+       int              row,
+       char            *rgba_row
+   ){
+   int          bs;
+   int          j;
+   uint8_t      r,g,b,a,tmp8;
+   const char  *pxptr;
+   char        *rptr;
+   U_RGBQUAD    color;
+   int32_t      index;
    
-   if(invert){
-     istart = h-1;
-     iend   = -1;
-     iinc   = -1;
+   if(!dr || !dr->px || !rgba_row || row < 0 || row >= dr->h)return(1);
+   bs    = dr->colortype/8;
+   pxptr = dr->px + (size_t) dr->rowbytes * (size_t) (dr->invert ? dr->h - 1 - row : row);
+   rptr  = rgba_row;
+   tmp8  = 0;  // silences a compiler warning, tmp8 always sets when j=0, so never used uninitialized
+   if(!dr->use_ct){
+      j = dib_row_to_rgba((const uint8_t *) pxptr, (uint8_t *) rptr, dr->w, dr->colortype);
+      pxptr += bs*j;
    }
+#ifndef U_DIB_REFERENCE
    else {
-     istart = 0;
-     iend   = h;
-     iinc   = 1;
+      j = dib_palette_to_rgba((const uint8_t *) pxptr, (uint8_t *) rptr, dr->w, dr->colortype, dr->lut);
    }
-
-   pxptr = px;
-   tmp8  = 0;  // silences a compiler warning, tmp8 always sets when j=0, so never used uninitialized
-   for(i=istart; i!=iend; i+=iinc){
-      rptr= *rgba_px + i*stride;
-      for(j=0; j<w; j++){
-          if(use_ct){
-             switch(colortype){
-                case U_BCBM_MONOCHROME: // 2 colors.    bmiColors array has two entries
-                    if(!(j % 8)){ tmp8 = *pxptr++; }
-                    index = 0x80 & tmp8;      // This seems wrong, as lowest position is top bit, but it works.
-                    index = index >> 7;
-                    tmp8 = tmp8 << 1; 
-                    break;           
-                case U_BCBM_COLOR4:     // 2^4 colors.  bmiColors array has 16 entries                 
-                    if(!(j % 2)){  tmp8 = *pxptr++; }
-                    index = 0xF0 & tmp8;
-                    index = index >> 4;
-                    tmp8  = tmp8  << 4;
-                    break;           
-                case U_BCBM_COLOR8:     // 2^8 colors.  bmiColors array has 256 entries 
-                    index    = (uint8_t) *pxptr++;;
-                    break;           
-                case U_BCBM_COLOR16:    // 2^16 colors. (Several different color methods))
-                case U_BCBM_COLOR24:    // 2^24 colors. bmiColors is not used. Pixels are U_RGBTRIPLE.
-                case U_BCBM_COLOR32:    // 2^32 colors. bmiColors is not used. Pixels are U_RGBQUAD.
-                case U_BCBM_EXPLICIT:   // Derinved from JPG or PNG compressed image or ?   
-                default:
-                    return(7);            // This should not be possible, but might happen with memory corruption  
-             }
-             color = ct[index];
-             b = U_BGRAGetB(color);
-             g = U_BGRAGetG(color);
-             r = U_BGRAGetR(color);
-             a = U_BGRAGetA(color);
+#else
+   else { j = 0; }
+#endif
+   rptr += 4*j;
+   for(; j<dr->w; j++){
+       if(dr->use_ct){
+          switch(dr->colortype){
+             case U_BCBM_MONOCHROME: // 2 colors.    bmiColors array has two entries
+                 if(!(j % 8)){ tmp8 = *pxptr++; }
+                 index = 0x80 & tmp8;      // This seems wrong, as lowest position is top bit, but it works.
+                 index = index >> 7;
+                 tmp8 = tmp8 << 1; 
+                 break;           
+             case U_BCBM_COLOR4:     // 2^4 colors.  bmiColors array has 16 entries                 
+                 if(!(j % 2)){  tmp8 = *pxptr++; }
+                 index = 0xF0 & tmp8;
+                 index = index >> 4;
+                 tmp8  = tmp8  << 4;
+                 break;           
+             case U_BCBM_COLOR8:     // 2^8 colors.  bmiColors array has 256 entries 
+                 index    = (uint8_t) *pxptr++;;
+                 break;           
+             case U_BCBM_COLOR16:    // 2^16 colors. (Several different color methods))
+             case U_BCBM_COLOR24:    // 2^24 colors. bmiColors is not used. Pixels are U_RGBTRIPLE.
+             case U_BCBM_COLOR32:    // 2^32 colors. bmiColors is not used. Pixels are U_RGBQUAD.
+             case U_BCBM_EXPLICIT:   // Derinved from JPG or PNG compressed image or ?   
+             default:
+                 return(7);            // This should not be possible, but might happen with memory corruption  
           }
-          else {
-             switch(colortype){
-                case U_BCBM_COLOR16:    // 2^16 colors. (Several different color methods)) 
-                   // Do it in this way because the bytes are always stored Little Endian
-                   tmp8  = *pxptr++;
-                   b = (0x1F & tmp8) <<3;       // 5 bits of b into the top 5 of 8
-                   g = tmp8 >> 5;               //  least significant 3 bits of green
-                   tmp8  = *pxptr++;
-                   r = (0x7C & tmp8) << 1;      // 5 bits of r into the top 5 of 8
-                   g |= (0x3 & tmp8) << 3;      // most  significant 2 bits of green (there are only 5 bits of data)
-                   g = g << 3;                  //  restore intensity (have lost 3 bits of accuracy)
-                   a = 0;
-                   break;           
-                case U_BCBM_COLOR24:    // 2^24 colors. bmiColors is not used. Pixels are U_RGBTRIPLE. 
-                   b = *pxptr++;
-                   g = *pxptr++;
-                   r = *pxptr++;
-                   a = 0;
-                   break;          
-                case U_BCBM_COLOR32:    // 2^32 colors. bmiColors is not used. Pixels are U_RGBQUAD.
-                   b = *pxptr++;
-                   g = *pxptr++;
-                   r = *pxptr++;
-                   a = *pxptr++;
-                   break;           
-                case U_BCBM_MONOCHROME: // 2 colors.    bmiColors array has two entries                
-                case U_BCBM_COLOR4:     // 2^4 colors.  bmiColors array has 16 entries                 
-                case U_BCBM_COLOR8:     // 2^8 colors.  bmiColors array has 256 entries                
-                case U_BCBM_EXPLICIT:   // Derinved from JPG or PNG compressed image or ?   
-                default:
-                  return(7);            // This should not be possible, but might happen with memory corruption  
-             }
+          color = dr->ct[index];
+          b = U_BGRAGetB(color);
+          g = U_BGRAGetG(color);
+          r = U_BGRAGetR(color);
+          a = U_BGRAGetA(color);
+       }
+       else {
+          switch(dr->colortype){
+             case U_BCBM_COLOR16:    // 2^16 colors. (Several different color methods)) 
+                // Do it in this way because the bytes are always stored Little Endian
+                tmp8  = *pxptr++;
+                b = (0x1F & tmp8) <<3;       // 5 bits of b into the top 5 of 8
+                g = tmp8 >> 5;               //  least significant 3 bits of green
+                tmp8  = *pxptr++;
+                r = (0x7C & tmp8) << 1;      // 5 bits of r into the top 5 of 8
+                g |= (0x3 & tmp8) << 3;      // most  significant 2 bits of green (there are only 5 bits of data)
+                g = g << 3;                  //  restore intensity (have lost 3 bits of accuracy)
+                a = 0;
+                break;           
+             case U_BCBM_COLOR24:    // 2^24 colors. bmiColors is not used. Pixels are U_RGBTRIPLE. 
+                b = *pxptr++;
+                g = *pxptr++;
+                r = *pxptr++;
+                a = 0;
+                break;          
+             case U_BCBM_COLOR32:    // 2^32 colors. bmiColors is not used. Pixels are U_RGBQUAD.
+                b = *pxptr++;
+                g = *pxptr++;
+                r = *pxptr++;
+                a = *pxptr++;
+                break;           
+             case U_BCBM_MONOCHROME: // 2 colors.    bmiColors array has two entries                
+             case U_BCBM_COLOR4:     // 2^4 colors.  bmiColors array has 16 entries                 
+             case U_BCBM_COLOR8:     // 2^8 colors.  bmiColors array has 256 entries                
+             case U_BCBM_EXPLICIT:   // Derinved from JPG or PNG compressed image or ?   
+             default:
+               return(7);            // This should not be possible, but might happen with memory corruption  
           }
-          *rptr++ = r;
-          *rptr++ = g;
-          *rptr++ = b;
-          *rptr++ = a;
-      }
-      for(j=0; j<pad; j++){ pxptr++; }  // DIB rows are all 4 byte aligned
-   } 
+       }
+       *rptr++ = r;
+       *rptr++ = g;
+       *rptr++ = b;
+       *rptr++ = a;
+   }
    return(0);
 }
 
 /**
-    \brief Extract a subset of an RGBA bitmap array.
-    Frees the incoming bitmap array IF a subset is extracted, otherwise it is left alone.
-    If the entire array is extracted it just returns the incoming pointer.
-    If the subset requested is partially outside of the bitmap the region is clipped to the
-      bitmap boundaries and extracted.  This seems to be a (very) grey area in EMF files, and
-      even different Microsoft applications do not always do the same thing.  For instance,
-      XP Preview gives some different images for EMR_BITBLT records than does the "import image"
-      (but not unpacked) view in PowerPoint. Since all of these states are probably best viewed
-      as undefined or errors we can only try to do something reasonable and not blow up when
-      encountering one.
+    \brief Convert the next row of a DIB pixmap to RGBA.  Rows are returned from 0 to h-1, see DIB_rows_get().
     
-    \return Pointer to the sub array on success, NULL otherwise.
+    \return 0 on success, 1 when there are no more rows, other values on errors (the same as DIB_rows_get).
+    \param dr         U_DIBROWS set up by DIB_rows_init() or DIB_rows_from_record()
+    \param rgba_row   Receives the row, 4*w bytes.
+*/
+int DIB_rows_next(
+       U_DIBROWS       *dr,
+       char            *rgba_row
+   ){
+   int status;
+   if(!dr)return(1);
+   status = DIB_rows_get(dr, dr->row, rgba_row);
+   if(!status)dr->row++;
+   return(status);
+}
+
+/**
+    \brief Convert one of many different types of DIB pixmaps to an RGBA 32 bit pixmap.
+    
+    To convert a large bitmap without holding all of it as RGBA use DIB_rows_init() and DIB_rows_next() instead.
+    \return 0 on success, other values on errors.
+    \param px         DIB pixel array
+    \param ct         DIB color table
+    \param numCt      DIB color table number of entries
     \param rgba_px    U_RGBA pixel array (32 bits), created by this routine, caller must free.
     \param w          Width of pixel array in the record
     \param h          Height of pixel array in the record
-    \param sl         start left position in the pixel array in the record to start extracting
-    \param st         start top  position in the pixel array in the record to start extracting
-    \param eew        Width of pixel array to extract
-    \param eeh        Height of pixel array to extract
+    \param colortype  DIB BitCount Enumeration
+    \param use_ct     Kept for symmetry with RGBA_to_DIB, should be set to numCt
+    \param invert     If DIB rows are in opposite order from RGBA rows
 */
-char *RGBA_to_RGBA(
-       char        *rgba_px,
-       int          w,
-       int          h,
-       int          sl,
-       int          st,
-       int          *eew,
-       int          *eeh
+int DIB_to_RGBA(
+       const char      *px,
+       const U_RGBQUAD *ct,
+       int              numCt,
+       char           **rgba_px,
+       int              w,
+       int              h,
+       uint32_t         colortype,
+       int              use_ct,
+       int              invert
    ){
+   size_t       stride;
    int          i;
-   char        *sub;
-   char        *sptr;
-   int          ew = *eew;
-   int          eh = *eeh;
+   int          status;
+   U_DIBROWS    dr;
    
-   // sanity checking
-   if(w<=0 || h<=0 || ew<=0 || eh<=0 || !rgba_px)return(NULL);
-
-   if(sl>w || st >h)return(NULL);  // This is hopeless, the start point is outside of the array.
-   if(sl<0){
-      if(sl+ew<=0)return(NULL);    // This is hopeless, the start point is outside of the array.
-      ew += sl;
-      sl = 0;
-   }
-   if(st<0){
-      if(st+eh<=0)return(NULL);    // This is hopeless, the start point is outside of the array.
-      eh += st;
-      st = 0;
-   }
-   if(sl+ew > w)ew=w-sl;
-   if(st+eh > h)eh=h-st;
-   if(!sl && !st && (ew == w) && (eh == h)){
-      sub = rgba_px;
-   }
-   else {
-      sptr = sub = malloc(ew*eh*4);
-      if(!sub)return(NULL);
-      for(i=st; i<st+eh; i++){
-         memcpy(sptr,rgba_px + i*w*4 + sl*4,4*ew);
-         sptr += 4*ew;
+   status = DIB_rows_init(&dr, px, ct, numCt, w, h, colortype, use_ct, invert);
+   if(status)return(status);
+   stride    = (size_t) w * 4;
+   *rgba_px = (char *) malloc(stride * h);
+   if(!*rgba_px)return(4);
+   for(i=0; i<h; i++){
+      status = DIB_rows_get(&dr, i, *rgba_px + i*stride);
+      if(status){
+         free(*rgba_px);
+         *rgba_px = NULL;
+         return(status);
       }
-      free(rgba_px);
    }
-   *eeh = eh;
-   *eew = ew;
-   return(sub);
- }
+   return(0);
+}
 
+//! \cond
+/*  Row bands for DIB_to_RGBA_mt() and RGBA_to_DIB_mt().  The image is split into one band of whole rows per
+    thread.  Every row is converted independently (DIB rows are located from the row number, allowing for the
+    padding and for inverted row order), so the bands need no locking.
+*/
+#define U_DIB_MT_MAX         64             // most threads used
+#define U_DIB_MT_MIN_PIXELS  (1 << 18)      // fewest pixels in a band, smaller images are not worth starting threads
+typedef struct {
+    const U_DIBROWS    *dr;                 // for DIB_to_RGBA_mt(), NULL for RGBA_to_DIB_mt()
+    const char         *rgba_px;            // RGBA pixels (source for RGBA_to_DIB_mt())
+    char               *px;                 // DIB pixels (destination for RGBA_to_DIB_mt())
+    char               *rgba_dst;           // RGBA pixels (destination for DIB_to_RGBA_mt())
+    int                 w;
+    int                 h;
+    int                 stride;             // bytes per RGBA row
+    int                 rowbytes;           // bytes per DIB row, including padding
+    int                 pad;
+    uint32_t            colortype;
+    int                 invert;
+    int                 first;              // rows of the RGBA image in this band are first to last-1
+    int                 last;
+    int                 status;             // 0 on success, else the first error
+} U_DIBBAND;
+
+static void *dib_band_run(void *arg){
+   U_DIBBAND   *band = (U_DIBBAND *) arg;
+   int          i, k;
+   for(i = band->first; i < band->last && !band->status; i++){
+      if(band->dr){
+         band->status = DIB_rows_get(band->dr, i, band->rgba_dst + (size_t) i * band->stride);
+      }
+      else {
+         k = (band->invert ? band->h - 1 - i : i);
+         if(rgba_to_dib_row(band->rgba_px + (size_t) i * band->stride, band->px + (size_t) k * band->rowbytes,
+               band->w, band->colortype, band->pad))band->status = 7;
+      }
+   }
+   return(NULL);
+}
 
-/* **********************************************************************************************
-These functions are for setting up, appending to, and then tearing down an EMF structure, including
-writing the final data structure out to a file.
-*********************************************************************************************** */
+/* Split the rows of proto into bands and convert them, each on its own thread.  Returns the first error, or 0. */
+static int dib_bands_run(const U_DIBBAND *proto, int nthreads){
+   U_DIBBAND    band[U_DIB_MT_MAX];
+   int          n, b, status;
+#ifndef U_NO_THREADS
+   pthread_t    tid[U_DIB_MT_MAX];
+   int          started[U_DIB_MT_MAX];
+#endif
 
-/**
-    \brief Duplicate an EMR record.
-    \param emr record to duplicate
-*/
-char *emr_dup(
-      const char *emr
-   ){
-   char *dup;
-   int   irecsize;
+   if(nthreads <= 0){
+#if !defined(U_NO_THREADS) && defined(_SC_NPROCESSORS_ONLN)
+      nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+      if(nthreads <= 0)nthreads = 1;
+   }
+   n = ((double) proto->w * proto->h) / U_DIB_MT_MIN_PIXELS;
+   if(nthreads > n)nthreads = n;
+   if(nthreads > proto->h)nthreads = proto->h;
+   if(nthreads > U_DIB_MT_MAX)nthreads = U_DIB_MT_MAX;
+   if(nthreads < 1)nthreads = 1;
+#ifdef U_NO_THREADS
+   nthreads = 1;
+#endif
 
-   if(!emr)return(NULL);
-   irecsize = ((PU_EMR)emr)->nSize;
-   dup=malloc(irecsize);
-   if(dup){ memcpy(dup,emr,irecsize); }
-   return(dup);
+   for(b = 0; b < nthreads; b++){
+      band[b]        = *proto;
+      band[b].first  = (int)(((int64_t) proto->h *  b     ) / nthreads);
+      band[b].last   = (int)(((int64_t) proto->h * (b + 1)) / nthreads);
+      band[b].status = 0;
+   }
+#ifndef U_NO_THREADS
+   for(b = 1; b < nthreads; b++){  // the calling thread does band 0
+      started[b] = !pthread_create(&tid[b], NULL, dib_band_run, &band[b]);
+   }
+#endif
+   (void) dib_band_run(&band[0]);
+#ifndef U_NO_THREADS
+   for(b = 1; b < nthreads; b++){
+      if(started[b]){ (void) pthread_join(tid[b], NULL); }
+      else {          (void) dib_band_run(&band[b]);     }  // could not start a thread, do it here
+   }
+#endif
+   for(status = 0, b = 0; b < nthreads && !status; b++){
+      status = band[b].status;
+   }
+   return(status);
 }
-    
+//! \endcond
 
 /**
-    \brief Start constructing an emf in memory. Supply the file name and initial size.
-    \return 0 for success, >=0 for failure.
-    \param name  EMF filename (will be opened)
-    \param initsize Initialize EMF in memory to hold this many bytes
-    \param chunksize When needed increase EMF in memory by this number of bytes
-    \param et EMF in memory
-    
+    \brief Convert one of many different types of DIB pixmaps to an RGBA 32 bit pixmap, using several threads.
     
-*/
-int  emf_start(
-      const char       *name,
-      const uint32_t   initsize,
-      const uint32_t   chunksize,
-      EMFTRACK       **et
+    The result is identical to that of DIB_to_RGBA().  The rows are split into bands which are converted in
+    parallel.  Small images are converted on the calling thread alone.
+    \return 0 on success, other values on errors (the same as DIB_to_RGBA).
+    \param px         DIB pixel array
+    \param ct         DIB color table
+    \param numCt      DIB color table number of entries
+    \param rgba_px    U_RGBA pixel array (32 bits), created by this routine, caller must free.
+    \param w          Width of pixel array in the record
+    \param h          Height of pixel array in the record
+    \param colortype  DIB BitCount Enumeration
+    \param use_ct     Kept for symmetry with RGBA_to_DIB, should be set to numCt
+    \param invert     If DIB rows are in opposite order from RGBA rows
+    \param nthreads   Most threads to use, including the calling one.  0 uses one per processor.
+*/
+int DIB_to_RGBA_mt(
+       const char      *px,
+       const U_RGBQUAD *ct,
+       int              numCt,
+       char           **rgba_px,
+       int              w,
+       int              h,
+       uint32_t         colortype,
+       int              use_ct,
+       int              invert,
+       int              nthreads
    ){
-   FILE *fp;
-   EMFTRACK *etl=NULL;
-
-   if(initsize < 1)return(1);
-   if(chunksize < 1)return(2);
-   if(!name)return(3);
-   etl = (EMFTRACK *) malloc(sizeof(EMFTRACK));
-   if(!etl)return(4);
-   etl->buf = malloc(initsize);  // no need to zero the memory
-   if(!etl->buf){
-      free(etl);
-      return(5);
-   }
-   fp=emf_fopen(name,U_WRITE);
-   if(!fp){
-      free(etl->buf);
-      free(etl);
-      return(6);
+   int          status;
+   U_DIBROWS    dr;
+   U_DIBBAND    proto;
+   
+   status = DIB_rows_init(&dr, px, ct, numCt, w, h, colortype, use_ct, invert);
+   if(status)return(status);
+   *rgba_px = (char *) malloc((size_t) w * 4 * h);
+   if(!*rgba_px)return(4);
+   memset(&proto, 0, sizeof(U_DIBBAND));
+   proto.dr        = &dr;
+   proto.rgba_dst  = *rgba_px;
+   proto.w         = w;
+   proto.h         = h;
+   proto.stride    = w * 4;
+   status = dib_bands_run(&proto, nthreads);
+   if(status){
+      free(*rgba_px);
+      *rgba_px = NULL;
    }
-   etl->fp         =  fp;    
-   etl->allocated  =  initsize;
-   etl->used       =  0;
-   etl->records    =  0;
-   etl->PalEntries =  0;
-   etl->chunk      =  chunksize;
-   *et=etl;
-   return(0);
+   return(status);
 }
 
 /**
-    \brief  Finalize the emf in memory and write it to the file.
-    \return 0 on success, >=1 on failure
-    \param et EMF in memory
-    \param eht  EMF handle table (peak handle number needed)
+    \brief Convert a U_RGBA 32 bit pixmap to one of many different types of DIB pixmaps, using several threads.
+    
+    The result is identical to that of RGBA_to_DIB().  For DIBs without a color table the rows are split into
+    bands which are converted in parallel.  Conversions to DIBs with a color table number the colors in the
+    order they are first seen, which is inherently serial, so these are passed to RGBA_to_DIB().
+    \return 0 on success, other values on errors (the same as RGBA_to_DIB).
+    \param px         DIB pixel array
+    \param cbPx       DIB pixel array size in bytes
+    \param ct         DIB color table
+    \param numCt      DIB color table number of entries
+    \param rgba_px    U_RGBA pixel array (32 bits)
+    \param w          Width of pixel array
+    \param h          Height of pixel array
+    \param stride     Row stride of input pixel array in bytes
+    \param colortype  DIB BitCount Enumeration
+    \param use_ct     U_CT_NO, U_CT_BGRA (use color table, only for 1-16 bit DIBs), or U_CT_QUANTIZE.
+    \param invert     If DIB rows are in opposite order from RGBA rows
+    \param nthreads   Most threads to use, including the calling one.  0 uses one per processor.
 */
-int  emf_finish(
-      EMFTRACK   *et,
-      EMFHANDLES *eht
+int RGBA_to_DIB_mt(
+       char      **px,
+       uint32_t   *cbPx,
+       PU_RGBQUAD *ct,
+       int        *numCt,
+       const char *rgba_px,
+       int         w,
+       int         h,
+       int         stride,
+       uint32_t    colortype,
+       int         use_ct,
+       int         invert,
+       int         nthreads
    ){
-   U_EMRHEADER *record;
+   int          bs;
+   int          usedbytes;
+   int          status;
+   U_DIBBAND    proto;
 
-   if(!et->fp)return(1);   // This could happen if something stomps on memory, otherwise should be caught in emf_start
+   if(use_ct)return(RGBA_to_DIB(px, cbPx, ct, numCt, rgba_px, w, h, stride, colortype, use_ct, invert));
+   *px=NULL;
+   *ct=NULL;
+   *numCt=0;
+   *cbPx=0;
+   // sanity checking
+   if(!w || !h || !stride || !colortype || !rgba_px)return(1);
+   if(colortype < U_BCBM_COLOR16)return(3);   //color tables mandatory for < 16 bit
 
-   // Set the header fields which were unknown up until this point
-  
-   record = (U_EMRHEADER *)et->buf;
-   record->nBytes       = et->used;
-   record->nRecords     = et->records;
-   record->nHandles     = eht->peak + 1;
-   record->nPalEntries  = et->PalEntries;
-  
-#if U_BYTE_SWAP
-    //This is a Big Endian machine, EMF data must be  Little Endian
-    U_emf_endian(et->buf,et->used,1); 
-#endif
+   bs = colortype/8;
+   usedbytes = w*bs;
+   memset(&proto, 0, sizeof(U_DIBBAND));
+   proto.rowbytes  = UP4(usedbytes);          // DIB rows must be aligned on 4 byte boundaries
+   proto.pad       = proto.rowbytes - usedbytes;
+   *cbPx = h * proto.rowbytes;
+   *px = (char *) malloc(*cbPx);  
+   if(!*px){
+      *cbPx = 0;
+      return(4);
+   }
+   proto.rgba_px   = rgba_px;
+   proto.px        = *px;
+   proto.w         = w;
+   proto.h         = h;
+   proto.stride    = stride;
+   proto.colortype = colortype;
+   proto.invert    = invert;
+   status = dib_bands_run(&proto, nthreads);
+   if(status){
+      free(*px);
+      *px  = NULL;
+      *cbPx = 0;
+   }
+   return(status);
+}
 
-   if(1 != fwrite(et->buf,et->used,1,et->fp))return(2);
-   (void) fclose(et->fp);
-   et->fp=NULL;
-   return(0);
+//! \cond
+/* Big Endian 16 and 32 bit values, as in PNG and JPEG headers */
+static uint32_t img_be16(const uint8_t *p){ return(((uint32_t) p[0] << 8) | p[1]); }
+static uint32_t img_be32(const uint8_t *p){ return((img_be16(p) << 16) | img_be16(p + 2)); }
+/* Little Endian 16 and 32 bit values, as in GIF and BMP headers */
+static uint32_t img_le16(const uint8_t *p){ return(((uint32_t) p[1] << 8) | p[0]); }
+static uint32_t img_le32(const uint8_t *p){ return((img_le16(p + 2) << 16) | img_le16(p)); }
+
+/* Find the JPEG SOFn segment and take the dimensions from it.  Returns 0 on success. */
+static int img_jpeg_sof(const uint8_t *p, uint32_t size, U_IMAGEDESC *id){
+   uint32_t  off = 2;    // past SOI
+   uint32_t  len;
+   uint8_t   marker;
+   while(off + 4 <= size){
+      if(p[off] != 0xFF)return(1);
+      marker = p[off + 1];
+      if(marker == 0xFF){ off++; continue; }                    // fill byte
+      if(marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)){ off += 2; continue; }  // no length
+      if(marker == 0xD9 || marker == 0xDA)return(1);            // end of image, start of scan: no SOF
+      len = img_be16(p + off + 2);
+      if(marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC){
+         if(len < 8 || off + 2 + 8 > size)return(1);
+         id->bitcount = p[off + 4] * p[off + 9];                 // precision * components
+         id->height   = img_be16(p + off + 5);
+         id->width    = img_be16(p + off + 7);
+         return(0);
+      }
+      off += 2 + len;
+   }
+   return(1);
 }
+//! \endcond
 
 /**
-    \brief Release memory for an emf structure in memory. Call this after emf_finish().
-    \return 0 on success, >=1 on failure
-    \param et EMF in memory
-*/
-int emf_free(
-      EMFTRACK **et
-   ){    
-   EMFTRACK *etl;
-   if(!et)return(1);
-   etl=*et;
-   if(!etl)return(2);
-   free(etl->buf);
-   free(etl);
-   *et=NULL;
+    \brief Describe a compressed image (PNG, JPEG, GIF, BMP, or TIFF) from its first few bytes, without decoding it.
+    
+    The format is found from the signature, and the dimensions from the PNG IHDR chunk, the JPEG SOFn segment,
+    the GIF logical screen descriptor, or the BMP header.  TIFF dimensions are not found.
+    \return 0 on success, 1 if the format was not recognized (id->format is U_IMG_UNKNOWN), 2 if the image header
+       is truncated (id->format is set, the dimensions are 0).
+    \param data      the image data, as it would be stored in a file
+    \param size      bytes in data
+    \param id        receives the description, data and cbData point at the image data
+*/
+int image_desc_data(
+       const char    *data,
+       uint32_t       size,
+       U_IMAGEDESC   *id
+   ){
+   static const uint8_t png_sig[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+   static const uint8_t png_channels[7] = { 1, 0, 3, 1, 2, 0, 4 };  // by PNG color type
+   const uint8_t *p = (const uint8_t *) data;
+   if(!id)return(1);
+   memset(id, 0, sizeof(U_IMAGEDESC));
+   if(!data)return(1);
+   id->data   = data;
+   id->cbData = size;
+   if(size >= 8 && !memcmp(p, png_sig, 8)){
+      id->format = U_IMG_PNG;
+      if(size < 26 || memcmp(p + 12, "IHDR", 4))return(2);
+      id->width  = img_be32(p + 16);
+      id->height = img_be32(p + 20);
+      if(p[25] < 7)id->bitcount = p[24] * png_channels[p[25]];   // bit depth * channels
+   }
+   else if(size >= 3 && p[0] == 0xFF && p[1] == 0xD8 && p[2] == 0xFF){
+      id->format = U_IMG_JPEG;
+      if(img_jpeg_sof(p, size, id))return(2);
+   }
+   else if(size >= 6 && (!memcmp(p, "GIF87a", 6) || !memcmp(p, "GIF89a", 6))){
+      id->format = U_IMG_GIF;
+      if(size < 11)return(2);
+      id->width    = img_le16(p + 6);
+      id->height   = img_le16(p + 8);
+      id->bitcount = (p[10] & 0x07) + 1;
+   }
+   else if(size >= 2 && p[0] == 'B' && p[1] == 'M'){
+      id->format = U_IMG_BMP;
+      if(size < 30)return(2);
+      if(img_le32(p + 14) == 12){           // BITMAPCOREHEADER
+         id->width    = img_le16(p + 18);
+         id->height   = img_le16(p + 20);
+         id->bitcount = img_le16(p + 24);
+      }
+      else {
+         id->width    = img_le32(p + 18);
+         id->height   = img_le32(p + 22);
+         id->bitcount = img_le16(p + 28);
+         if(id->height < 0){ id->height = -id->height; id->invert = 1; }
+      }
+   }
+   else if(size >= 4 && (!memcmp(p, "II*\0", 4) || !memcmp(p, "MM\0*", 4))){
+      id->format = U_IMG_TIFF;
+   }
+   else {
+      return(1);
+   }
    return(0);
 }
 
 /**
-    \brief wrapper for fopen, works on any platform
-    \return 0 on success, >=1 on failure
-    \param filename file to open (either ASCII or UTF-8)
-    \param mode     U_READ or U_WRITE (these map to  "rb" and "wb")
-*/
-FILE *emf_fopen(
-      const char *filename,
-      const int mode
-   ){    
-   FILE *fp = NULL;
-#ifdef WIN32
-   uint16_t *fn16;
-   uint16_t *md16;
-   if(mode == U_READ){ md16 = U_Utf8ToUtf16le("rb", 0, NULL); }
-   else {              md16 = U_Utf8ToUtf16le("wb", 0, NULL); }
-   fn16 = U_Utf8ToUtf16le(filename, 0, NULL);
-   fp = _wfopen(fn16,md16);
-   free(fn16);
-   free(md16);
-#else
-   if(mode == U_READ){ fp = fopen(filename,"rb"); }
-   else {              fp = fopen(filename,"wb"); }
-#endif
-   return(fp);
+    \brief Describe the image held by a DIB (a U_BITMAPINFOHEADER or U_BITMAPCOREHEADER and its pixels) without decoding it.
+    
+    Uncompressed DIBs are U_IMG_DIB (see DIB_to_RGBA), RLE compressed ones U_IMG_RLE8 or U_IMG_RLE4 (see RLE_to_RGBA), and
+    U_BI_PNG or U_BI_JPEG ones are described by image_desc_data(), falling back to the header for the dimensions.
+    Note, this may be called by WMF code, so it is not safe to assume the data is aligned.
+    \return 0 on success, 1 if the compression type is not supported (id->format is U_IMG_UNKNOWN).
+    \param Bmih      the U_BITMAPINFOHEADER (or U_BITMAPCOREHEADER), immediately followed by the color table, if any
+    \param px        the pixels
+    \param cbPx      bytes of pixel data, or 0 if this is not known, in which case it is calculated or taken from biSizeImage
+    \param id        receives the description
+*/
+int image_desc_dib(
+       const char    *Bmih,
+       const char    *px,
+       uint32_t       cbPx,
+       U_IMAGEDESC   *id
+   ){
+   uint32_t  Size, Compression = U_BI_RGB, SizeImage = 0, ClrUsed = 0;
+   int32_t   Width, Height;
+   uint16_t  utmp2;
+   if(!id)return(1);
+   memset(id, 0, sizeof(U_IMAGEDESC));
+   if(!Bmih || !px)return(1);
+   memcpy(&Size, Bmih, 4);
+   if(Size == 0xC){  // U_BITMAPCOREHEADER
+      memcpy(&utmp2, Bmih + 4,  2);  Width  = utmp2;
+      memcpy(&utmp2, Bmih + 6,  2);  Height = utmp2;
+      memcpy(&utmp2, Bmih + 10, 2);  id->bitcount = utmp2;
+   }
+   else {
+      memcpy(&Width,       Bmih + offsetof(U_BITMAPINFOHEADER,biWidth),       4);
+      memcpy(&Height,      Bmih + offsetof(U_BITMAPINFOHEADER,biHeight),      4);
+      memcpy(&utmp2,       Bmih + offsetof(U_BITMAPINFOHEADER,biBitCount),    2);  id->bitcount = utmp2;
+      memcpy(&Compression, Bmih + offsetof(U_BITMAPINFOHEADER,biCompression), 4);
+      memcpy(&SizeImage,   Bmih + offsetof(U_BITMAPINFOHEADER,biSizeImage),   4);
+      memcpy(&ClrUsed,     Bmih + offsetof(U_BITMAPINFOHEADER,biClrUsed),     4);
+   }
+   if(Height < 0){
+      Height      = -Height;
+      id->invert  = 1;
+   }
+   id->width  = Width;
+   id->height = Height;
+   id->data   = px;
+   switch(Compression){
+      case U_BI_RGB:
+      case U_BI_BITFIELDS:
+         id->format = U_IMG_DIB;
+         id->cbData = UP4(((uint32_t) Width * id->bitcount + 7)/8) * (uint32_t) Height;
+         break;
+      case U_BI_RLE8:
+         id->format = U_IMG_RLE8;
+         id->cbData = SizeImage;
+         break;
+      case U_BI_RLE4:
+         id->format = U_IMG_RLE4;
+         id->cbData = SizeImage;
+         break;
+      case U_BI_JPEG:
+      case U_BI_PNG:
+         (void) image_desc_data(px, (cbPx ? cbPx : SizeImage), id);
+         if(id->format == U_IMG_UNKNOWN){ id->format = (Compression == U_BI_PNG ? U_IMG_PNG : U_IMG_JPEG); }
+         if(!id->width && !id->height){  // the stream could not be parsed, use the header
+            id->width  = Width;
+            id->height = Height;
+         }
+         return(0);
+      default:
+         id->format = U_IMG_UNKNOWN;
+         id->cbData = (cbPx ? cbPx : SizeImage);
+         return(1);
+   }
+   if(cbPx)id->cbData = cbPx;
+   if(id->bitcount <= 8 && Size != 0xC){
+      id->numCt = get_real_color_icount(ClrUsed, id->bitcount, Width, Height);
+      if(id->numCt)id->ct = (const U_RGBQUAD *)(Bmih + Size);
+   }
+   return(0);
 }
 
 /**
-    \brief Retrieve contents of an EMF file by name.
-    \return 0 on success, >=1 on failure
-    \param filename Name of file to open, including the path
-    \param contents Contents of the file.  Buffer must be free()'d by caller.
-    \param length   Number of bytes in Contents
+    \brief Describe the image in an EMR record that has a U_BITMAPINFO and bitmap, without decoding it, see image_desc_dib().
+    
+    \return 0 on success, other values on errors.
+    \param record      pointer to EMR record that has a U_BITMAPINFO and bitmap
+    \param offBitsSrc  Offset to the bitmap
+    \param offBmiSrc   Offset to the U_BITMAPINFO
+    \param cbBitsSrc   Size of the bitmap, or 0 if this is not known
+    \param id          receives the description, which points into the record
 */
-int emf_readdata(
-      const char   *filename,
-      char        **contents,
-      size_t       *length
-   ){    
-   FILE     *fp;
-   int       status=0;
+int get_DIB_desc(
+       const char       *record,
+       uint32_t          offBitsSrc,
+       uint32_t          offBmiSrc,
+       uint32_t          cbBitsSrc,
+       U_IMAGEDESC      *id
+   ){
+   if(!record){
+      if(id)memset(id, 0, sizeof(U_IMAGEDESC));
+      return(1);
+   }
+   return(image_desc_dib(record + offBmiSrc, record + offBitsSrc, cbBitsSrc, id));
+}
 
-   *contents=NULL;
-   fp=emf_fopen(filename,U_READ);
-   if(!fp){ status = 1; }
-   else {
-      // read the entire file into memory
-      fseek(fp, 0, SEEK_END); // move to end
-      *length = ftell(fp);
-      rewind(fp);
-      *contents = (char *) malloc(*length);
-      if(!*contents){ 
-         status = 2; 
+/**
+    \brief Convert a U_BI_RLE8 or U_BI_RLE4 compressed DIB pixmap to an RGBA 32 bit pixmap.
+    
+    The RLE data is decoded in a single pass directly into the RGBA pixmap, no uncompressed DIB is made.
+    Pixels which the RLE data skips over (with a delta, end of line, or end of bitmap) are set to 0,0,0,0.
+    Pixels which the RLE data places outside of the pixmap are ignored.  The end of bitmap marker may be omitted.
+    \return 0 on success, 1 or 2 on invalid arguments, 4 if memory could not be allocated, 5 if an absolute run
+    extends past the end of the data.
+    \param rle          RLE compressed pixel array
+    \param cbRle        Size in bytes of rle (biSizeImage)
+    \param ct           DIB color table
+    \param numCt        DIB color table number of entries, see get_real_color_count()
+    \param rgba_px      U_RGBA pixel array (32 bits), created by this routine, caller must free.
+    \param w            Width of pixel array in the record
+    \param h            Height of pixel array in the record
+    \param compression  U_BI_RLE8 or U_BI_RLE4
+    \param invert       If DIB rows are in opposite order from RGBA rows
+*/
+int RLE_to_RGBA(
+       const char      *rle,
+       uint32_t         cbRle,
+       const U_RGBQUAD *ct,
+       int              numCt,
+       char           **rgba_px,
+       int              w,
+       int              h,
+       uint32_t         compression,
+       int              invert
+   ){
+   const uint8_t *src = (const uint8_t *) rle;
+   const uint8_t *end;
+   uint8_t        lut[256][4];
+   size_t         stride;
+   int            x, y, n, k, nbytes, index;
+   uint8_t        c;
+
+   *rgba_px = NULL;
+   if(!rle || !ct || numCt <= 0 || w <= 0 || h <= 0)return(1);
+   if(compression != U_BI_RLE8 && compression != U_BI_RLE4)return(2);
+   stride   = (size_t) w * 4;
+   *rgba_px = (char *) calloc(h, stride);   // pixels skipped by the RLE data are 0,0,0,0
+   if(!*rgba_px)return(4);
+   dib_palette_lut(lut, ct, numCt);
+
+   end = src + cbRle;
+   x   = y = 0;
+   while(end - src >= 2 && y < h){
+      n = *src++;
+      c = *src++;
+      if(n){                       // encoded run, one color (RLE8) or two alternating colors (RLE4)
+         for(k = 0; k < n && x < w; k++, x++){
+            index = (compression == U_BI_RLE8 ? c : ((k & 1) ? c & 0xF : c >> 4));
+            memcpy(*rgba_px + (size_t)(invert ? h - 1 - y : y) * stride + 4*x, lut[index], 4);
+         }
       }
-      else {
-         size_t inbytes = fread(*contents,*length,1,fp);
-         if(inbytes != 1){
-            free(*contents);
-            status = 3;
+      else if(c == 0){             // end of line
+         x = 0;
+         y++;
+      }
+      else if(c == 1){             // end of bitmap
+         break;
+      }
+      else if(c == 2){             // delta
+         if(end - src < 2)break;
+         x += *src++;
+         y += *src++;
+         if(x > w)x = w;
+      }
+      else {                       // absolute run of c pixels, padded to a 2 byte boundary
+         n      = c;
+         nbytes = (compression == U_BI_RLE8 ? n : (n + 1)/2);
+         if(end - src < nbytes){
+            free(*rgba_px);
+            *rgba_px = NULL;
+            return(5);
          }
-         else {
-#if U_BYTE_SWAP
-            //This is a Big Endian machine, EMF data is Little Endian
-            U_emf_endian(*contents,*length,0);  // LE to BE
-#endif
-          }
+         for(k = 0; k < n && x < w; k++, x++){
+            index = (compression == U_BI_RLE8 ? src[k] : ((k & 1) ? src[k >> 1] & 0xF : src[k >> 1] >> 4));
+            memcpy(*rgba_px + (size_t)(invert ? h - 1 - y : y) * stride + 4*x, lut[index], 4);
+         }
+         src += nbytes + (nbytes & 1);
+         if(src > end)src = end;   // the pad byte may be missing at the very end
       }
-      fclose(fp);
    }
-    return(status);
+   return(0);
 }
 
+//! \cond
+/* Color index of pixel k of an uncompressed 4 or 8 bit DIB row. */
+static uint8_t rle_pixel(const uint8_t *row, int k, int bits){
+   return(bits == 8 ? row[k] : ((k & 1) ? row[k >> 1] & 0xF : row[k >> 1] >> 4));
+}
+//! \endcond
 
 /**
-    \brief Append an EMF record to an emf in memory. This may reallocate buf memory.
-    \return 0 for success, >=1 for failure.
-    \param rec     Record to append to EMF in memory
-    \param et      EMF in memory
-    \param freerec If true, free rec after append    
+    \brief Compress an uncompressed 4 or 8 bit DIB pixmap with U_BI_RLE4 or U_BI_RLE8.
+    
+    Runs of 2 or more pixels of the same color are stored as encoded runs, other pixels in absolute runs.  Every row
+    but the last ends with an end of line, the last with an end of bitmap.  Images with large areas of one color
+    typically compress by a factor of 10 or more, images with few such areas may grow slightly.
+    \return 0 on success, 1 on invalid arguments, 4 if memory could not be allocated.
+    \param px         DIB pixel array, rows padded to 4 bytes as produced by RGBA_to_DIB()
+    \param w          Width of pixel array
+    \param h          Height of pixel array
+    \param colortype  U_BCBM_COLOR8 (compress with U_BI_RLE8) or U_BCBM_COLOR4 (U_BI_RLE4)
+    \param rle        RLE compressed pixel array, created by this routine, caller must free.
+    \param cbRle      Size in bytes of rle, for biSizeImage
 */
-int  emf_append(
-      U_ENHMETARECORD *rec,
-      EMFTRACK        *et,
-      int              freerec
-   ){
-   size_t deficit;
-   
-#ifdef U_VALGRIND
-   printf("\nbefore \n");
-   printf(" probe %d\n",memprobe(rec, U_EMRSIZE(rec)));
-   printf("after \n");
-#endif
-   if(!rec)return(1);
-   if(!et)return(2);
-   if(rec->nSize + et->used > et->allocated){
-      deficit = rec->nSize + et->used - et->allocated;
-      if(deficit < et->chunk)deficit = et->chunk;
-      et->allocated += deficit;
-      et->buf = realloc(et->buf,et->allocated);
-      if(!et->buf)return(3);
-   }
-   memcpy(et->buf + et->used, rec, rec->nSize);
-   et->used += rec->nSize;
-   et->records++;
-   if(rec->iType == U_EMR_EOF){ et->PalEntries = ((U_EMREOF *)rec)->cbPalEntries; }
-   if(freerec){ free(rec); }
+int DIB_to_RLE(
+       const char *px,
+       int         w,
+       int         h,
+       uint32_t    colortype,
+       char      **rle,
+       uint32_t   *cbRle
+   ){
+   const uint8_t *row;
+   uint8_t       *dst;
+   uint8_t       *tmp;
+   size_t         rowbytes, maxsize;
+   int            i, k, n, run;
+   uint8_t        v;
+
+   *rle   = NULL;
+   *cbRle = 0;
+   if(!px || w <= 0 || h <= 0)return(1);
+   if(colortype != U_BCBM_COLOR8 && colortype != U_BCBM_COLOR4)return(1);
+   rowbytes = UP4(((size_t) w * colortype + 7)/8);
+   maxsize  = (size_t) h * (2 * (size_t) w + 2) + 2;   // worst case is every pixel in an encoded run of 1
+   if(maxsize > UINT32_MAX)return(1);
+   dst = (uint8_t *) malloc(maxsize);
+   if(!dst)return(4);
+   *rle = (char *) dst;
+
+   for(i = 0; i < h; i++){
+      row = (const uint8_t *) px + (size_t) i * rowbytes;
+      for(k = 0; k < w; ){
+         v = rle_pixel(row, k, colortype);
+         for(run = 1; k + run < w && run < 255 && rle_pixel(row, k + run, colortype) == v; run++){}
+         if(run >= 2){                     // encoded run
+            *dst++ = run;
+            *dst++ = (colortype == U_BCBM_COLOR8 ? v : (v << 4) | v);
+            k += run;
+            continue;
+         }
+         // pixels up to the next run of 3 or more go into an absolute run
+         for(n = 1; k + n < w && n < 255; n++){
+            if(k + n + 2 < w &&
+               rle_pixel(row, k + n, colortype) == rle_pixel(row, k + n + 1, colortype) &&
+               rle_pixel(row, k + n, colortype) == rle_pixel(row, k + n + 2, colortype))break;
+         }
+         if(n < 3){                        // absolute runs must be at least 3 long, use encoded runs of 1
+            for(; n; n--, k++){
+               v = rle_pixel(row, k, colortype);
+               *dst++ = 1;
+               *dst++ = (colortype == U_BCBM_COLOR8 ? v : v << 4);
+            }
+            continue;
+         }
+         *dst++ = 0;
+         *dst++ = n;
+         if(colortype == U_BCBM_COLOR8){
+            memcpy(dst, row + k, n);
+            dst += n;
+            if(n & 1)*dst++ = 0;
+         }
+         else {
+            for(run = 0; run < n; run += 2){
+               v = rle_pixel(row, k + run, colortype) << 4;
+               if(run + 1 < n)v |= rle_pixel(row, k + run + 1, colortype);
+               *dst++ = v;
+            }
+            if(((n + 1)/2) & 1)*dst++ = 0;
+         }
+         k += n;
+      }
+      *dst++ = 0;
+      *dst++ = (i == h - 1 ? 1 : 0);     // end of bitmap or end of line
+   }
+   *cbRle = dst - (uint8_t *) *rle;
+   tmp = (uint8_t *) realloc(*rle, *cbRle);
+   if(tmp)*rle = (char *) tmp;
    return(0);
 }
 
 /**
-    \brief Create a handle table. Entries filled with 0 are empty, entries >0 hold a handle.
-    \return 0 for success, >=1 for failure.
-    \param initsize Initialize with space for this number of handles
-    \param chunksize When needed increase space by this number of handles
-    \param eht EMF handle table    
+    \brief Extract a subset of an RGBA bitmap array.
+    Frees the incoming bitmap array IF a subset is extracted, otherwise it is left alone.
+    If the entire array is extracted it just returns the incoming pointer.
+    If the subset requested is partially outside of the bitmap the region is clipped to the
+      bitmap boundaries and extracted.  This seems to be a (very) grey area in EMF files, and
+      even different Microsoft applications do not always do the same thing.  For instance,
+      XP Preview gives some different images for EMR_BITBLT records than does the "import image"
+      (but not unpacked) view in PowerPoint. Since all of these states are probably best viewed
+      as undefined or errors we can only try to do something reasonable and not blow up when
+      encountering one.
+    
+    \return Pointer to the sub array on success, NULL otherwise.
+    \param rgba_px    U_RGBA pixel array (32 bits), created by this routine, caller must free.
+    \param w          Width of pixel array in the record
+    \param h          Height of pixel array in the record
+    \param sl         start left position in the pixel array in the record to start extracting
+    \param st         start top  position in the pixel array in the record to start extracting
+    \param eew        Width of pixel array to extract
+    \param eeh        Height of pixel array to extract
 */
-int emf_htable_create(
-      uint32_t     initsize,
-      uint32_t     chunksize,
-      EMFHANDLES **eht
+char *RGBA_to_RGBA(
+       char        *rgba_px,
+       int          w,
+       int          h,
+       int          sl,
+       int          st,
+       int          *eew,
+       int          *eeh
    ){
-   EMFHANDLES *ehtl;
-   unsigned int i;
+   int          i;
+   char        *sub;
+   char        *sptr;
+   int          ew = *eew;
+   int          eh = *eeh;
    
-   if(initsize<1)return(1);
-   if(chunksize<1)return(2);
-   ehtl = (EMFHANDLES *) malloc(sizeof(EMFHANDLES));
-   if(!ehtl)return(3);
-   ehtl->table = malloc(initsize * sizeof(uint32_t));
-   if(!ehtl->table){
-      free(ehtl);
-      return(4);
+   // sanity checking
+   if(w<=0 || h<=0 || ew<=0 || eh<=0 || !rgba_px)return(NULL);
+
+   if(sl>w || st >h)return(NULL);  // This is hopeless, the start point is outside of the array.
+   if(sl<0){
+      if(sl+ew<=0)return(NULL);    // This is hopeless, the start point is outside of the array.
+      ew += sl;
+      sl = 0;
    }
-   ehtl->stack = malloc(initsize * sizeof(uint32_t));
-   if(!ehtl->stack){
-      free(ehtl->table);
-      free(ehtl);
-      return(5);
+   if(st<0){
+      if(st+eh<=0)return(NULL);    // This is hopeless, the start point is outside of the array.
+      eh += st;
+      st = 0;
    }
-   memset(ehtl->table , 0, initsize * sizeof(uint32_t));  // zero all slots in the table
-   for(i=1; i<initsize; i++){ehtl->stack[i]=i;}             // preset the stack
-   ehtl->allocated = initsize;
-   ehtl->chunk     = chunksize;
-   ehtl->table[0]  = 0;         // This slot isn't actually ever used
-   ehtl->stack[0]  = 0;         // This stack position isn't actually ever used
-   ehtl->peak      = 1;
-   ehtl->sptr      = 1;
-   ehtl->top       = 0;
-   *eht            = ehtl;
-   return(0);
-}
+   if(sl+ew > w)ew=w-sl;
+   if(st+eh > h)eh=h-st;
+   if(!sl && !st && (ew == w) && (eh == h)){
+      sub = rgba_px;
+   }
+   else {
+      sptr = sub = malloc(ew*eh*4);
+      if(!sub)return(NULL);
+      for(i=st; i<st+eh; i++){
+         memcpy(sptr,rgba_px + i*w*4 + sl*4,4*ew);
+         sptr += 4*ew;
+      }
+      free(rgba_px);
+   }
+   *eeh = eh;
+   *eew = ew;
+   return(sub);
+ }
+
+
+/* **********************************************************************************************
+These functions are for setting up, appending to, and then tearing down an EMF structure, including
+writing the final data structure out to a file.
+*********************************************************************************************** */
 
 /**
-    \brief Delete an entry from the handle table. Move it back onto the stack. The specified slot is filled with a 0.
-    \return 0 for success, >=1 for failure.
-    \param ih  handle
-    \param eht EMF handle table
-    
+    \brief Duplicate an EMR record.
+    \param emr record to duplicate
 */
-int emf_htable_delete(
-      uint32_t    *ih,
-      EMFHANDLES  *eht
+char *emr_dup(
+      const char *emr
    ){
-   if(!eht)return(1);
-   if(!eht->table)return(2);
-   if(!eht->stack)return(3);
-   if(*ih < 1)return(4);           // invalid handle
-   if(!eht->table[*ih])return(5);  // requested table position was not in use
-   eht->table[*ih]=0;              // remove handle from table
-   while(eht->top>0 && !eht->table[eht->top]){  // adjust top
-     eht->top--;
-   }
-   eht->sptr--;                   // adjust stack
-   eht->stack[eht->sptr]=*ih;      // place handle on stack
-   *ih=0;                         // invalidate handle variable, so a second delete will of it is not possible
-   return(0);
+   char *dup;
+   int   irecsize;
+
+   if(!emr)return(NULL);
+   irecsize = ((PU_EMR)emr)->nSize;
+   dup=malloc(irecsize);
+   if(dup){ memcpy(dup,emr,irecsize); }
+   return(dup);
 }
+    
 
 /**
-    \brief Returns the index of the first free slot.  
-    Call realloc() if needed.  The slot is set to handle (indicates occupied) and the peak value is adjusted.
-    \return 0 for success, >=1 for failure.
-    \param ih  handle
-    \param eht EMF handle table
+    \brief Start constructing an emf in memory. Supply the file name and initial size.
+    \return 0 for success, >=0 for failure.
+    \param name  EMF filename (will be opened)
+    \param initsize Initialize EMF in memory to hold this many bytes
+    \param chunksize When needed increase EMF in memory by at least this number of bytes
+    \param et EMF in memory
+    
+    
 */
-int emf_htable_insert(
-      uint32_t   *ih,
-      EMFHANDLES *eht
+int  emf_start(
+      const char       *name,
+      const uint32_t   initsize,
+      const uint32_t   chunksize,
+      EMFTRACK       **et
    ){
-   unsigned int i;
-   size_t newsize;
+   FILE *fp;
+   EMFTRACK *etl=NULL;
 
-   if(!eht)return(1);
-   if(!eht->table)return(2);
-   if(!eht->stack)return(3);
-   if(!ih)return(4);
-   if(eht->sptr >= eht->allocated - 1){  // need to reallocate
-     newsize=eht->allocated + eht->chunk;
-     eht->table = realloc(eht->table,newsize * sizeof(uint32_t));
-     if(!eht->table)return(5);
-     memset(&eht->table[eht->allocated] , 0, eht->chunk * sizeof(uint32_t));  // zero all NEW slots in the table
- 
-     eht->stack = realloc(eht->stack,newsize * sizeof(uint32_t));
-     if(!eht->stack)return(6);
-     for(i=eht->allocated; i<newsize;i++){ eht->stack[i] = i; }  // init all NEW slots in the stack
-     eht->allocated = newsize;
+   if(initsize < 1)return(1);
+   if(chunksize < 1)return(2);
+   if(!name)return(3);
+   etl = (EMFTRACK *) malloc(sizeof(EMFTRACK));
+   if(!etl)return(4);
+   etl->buf = malloc(initsize);  // no need to zero the memory
+   if(!etl->buf){
+      free(etl);
+      return(5);
    }
-   *ih = eht->stack[eht->sptr];     // handle that is inserted
-   if(eht->table[*ih])return(7);
-   eht->table[*ih] = *ih;           // handle goes into preexisting (but zero) slot in table
-   eht->stack[eht->sptr] = 0;
-   if(*ih > eht->top){        eht->top = *ih;  }
-   if(eht->sptr > eht->peak){ eht->peak = eht->sptr; }
-   eht->sptr++;         // next available handle
+   fp=emf_fopen(name,U_WRITE);
+   if(!fp){
+      free(etl->buf);
+      free(etl);
+      return(6);
+   }
+   etl->fp         =  fp;    
+   etl->allocated  =  initsize;
+   etl->used       =  0;
+   etl->records    =  0;
+   etl->PalEntries =  0;
+   etl->chunk      =  chunksize;
+   etl->stream     =  0;
+   etl->reallocs   =  0;
+   etl->copied     =  0;
+   etl->open       =  0;
+   etl->pmfpack    =  0;
+   *et=etl;
    return(0);
 }
 
 /**
-    \brief Free all memory in an htable.  Sets the pointer to NULL.
-    \return 0 for success, >=1 for failure.
-    \param eht  EMF handle table
+    \brief Start constructing an emf which is written to the file as records are appended, rather
+    than being held in memory until emf_finish().  Only the header record is kept in memory.  
+    emf_finish() seeks back to the start of the file and rewrites the header, so the file must be seekable.
+    Use emf_append(), emf_finish(), and emf_free() exactly as for emf_start().
+    \return 0 for success, >=0 for failure.
+    \param name  EMF filename (will be opened)
+    \param initsize Initial size of the buffer used for the header (and on Big Endian machines for byte swapping records)
+    \param et EMF in memory
 */
-int emf_htable_free(
-      EMFHANDLES **eht
+int  emf_start_stream(
+      const char       *name,
+      const uint32_t   initsize,
+      EMFTRACK       **et
    ){
-   EMFHANDLES *ehtl;
-   if(!eht)return(1);
-   ehtl = *eht;
-   if(!ehtl)return(2);
-   if(!ehtl->table)return(3);
-   if(!ehtl->stack)return(4);
-   free(ehtl->table);
-   free(ehtl->stack);
-   free(ehtl);
-   *eht=NULL;
-   return(0);
+   int status;
+   status = emf_start(name, initsize, initsize, et);
+   if(!status){ (*et)->stream = 1; }
+   return(status);
 }
 
-/* **********************************************************************************************
-These functions create standard structures used in the EMR records.
-*********************************************************************************************** */
-
+//! \cond
+/*  Streaming: write the record held back by emf_append_commit(), if there is one.  Every record
+    which follows it must call this first.  After this the record can no longer be extended. */
+static int emf_flush_open(
+      EMFTRACK        *et
+   ){
+   char  *rec;
+   size_t size = et->open;
+   et->open = 0;
+   if(!et->stream || !size)return(0);
+   rec = et->buf + ((PU_EMR) et->buf)->nSize;
+#if U_BYTE_SWAP
+   //This is a Big Endian machine, EMF data must be  Little Endian.  The staged record is not needed again.
+   (void) U_emf_endian(rec, size, 1);  // one record, so the status is not meaningful
+#endif
+   if(1 != fwrite(rec, size, 1, et->fp))return(4);
+   return(0);
+}
+//! \endcond
 
 /**
-    \brief Set up fields for an EMR_HEADER from the physical device's width and height in mm and dots per millimeter.
-    Typically this is something like 216,279,47.244 (Letter paper, 1200 DPI = 47.244 DPmm)
-    \return 0 for success, >=1 for failure.
-    \param xmm     Device  width in millimeters
-    \param ymm     Device height in millimeters
-    \param dpmm    Dots per millimeter
-    \param szlDev  Device size structure in pixels
-    \param szlMm   Device size structure in mm
+    \brief  Finalize the emf in memory and write it to the file.
+    \return 0 on success, >=1 on failure
+    \param et EMF in memory
+    \param eht  EMF handle table (peak handle number needed)
 */
-int device_size(
-      const int    xmm,
-      const int    ymm,
-      const float  dpmm,
-      U_SIZEL     *szlDev,
-      U_SIZEL     *szlMm
+int  emf_finish(
+      EMFTRACK   *et,
+      EMFHANDLES *eht
    ){
-   if(xmm < 0 || ymm < 0 || dpmm < 0)return(1);
-   szlDev->cx          =  U_ROUND((float) xmm * dpmm);
-   szlDev->cy          =  U_ROUND((float) ymm * dpmm);;
-   szlMm->cx           =  xmm;
-   szlMm->cy           =  ymm;
+   U_EMRHEADER *record;
+   size_t       length;
+
+   if(!et->fp)return(1);   // This could happen if something stomps on memory, otherwise should be caught in emf_start
+   if(et->stream && !et->records)return(3);  // no header was ever written
+   if(emf_flush_open(et))return(2);
+
+   // Set the header fields which were unknown up until this point
+  
+   record = (U_EMRHEADER *)et->buf;
+   record->nBytes       = et->used;
+   record->nRecords     = et->records;
+   record->nHandles     = eht->peak + 1;
+   record->nPalEntries  = et->PalEntries;
+   length = (et->stream ? record->emr.nSize : et->used);  // streaming: only the header is in memory
+  
+#if U_BYTE_SWAP
+    //This is a Big Endian machine, EMF data must be  Little Endian
+    U_emf_endian(et->buf,length,1); 
+#endif
+
+   if(et->stream && fseek(et->fp, 0, SEEK_SET))return(4);
+   if(1 != fwrite(et->buf,length,1,et->fp))return(2);
+   (void) fclose(et->fp);
+   et->fp=NULL;
    return(0);
 }
 
 /**
-    \brief Set up fields for an EMR_HEADER for drawing by physical size in mm and dots per millimeter.
-    Technically rclBounds is supposed to be the extent of the drawing within the EMF, but libUEMF has no way
-    of knowing this since it never actually draws anything.  Instead this is set to the full drawing size.
-    Coordinates are inclusive inclusive, so 297 -> 0,29699.
-    \return 0 for success, >=1 for failure.
-    \param xmm        Drawing  width in millimeters
-    \param ymm        Drawing height in millimeters
-    \param dpmm       Dots per millimeter
-    \param rclBounds  Drawing size structure in pixels
-    \param rclFrame   Drawing size structure in mm
+    \brief Release memory for an emf structure in memory. Call this after emf_finish().
+    \return 0 on success, >=1 on failure
+    \param et EMF in memory
 */
-int drawing_size(
-      const int    xmm,
-      const int    ymm,
-      const float  dpmm,
-      U_RECTL     *rclBounds,
-      U_RECTL     *rclFrame
-   ){
-   if(xmm < 0 || ymm < 0 || dpmm < 0)return(1);
-   rclBounds->left     =  0;
-   rclBounds->top      =  0;
-   rclBounds->right    =  U_ROUND((float) xmm  * dpmm) - 1;  // because coordinate system is 0,0 in upper left, N,M in lower right
-   rclBounds->bottom   =  U_ROUND((float) ymm  * dpmm) - 1;
-   rclFrame->left      =  0;       
-   rclFrame->top       =  0; 
-   rclFrame->right     =  U_ROUND((float) xmm * 100.) - 1; 
-   rclFrame->bottom    =  U_ROUND((float) ymm * 100.) - 1;         
+int emf_free(
+      EMFTRACK **et
+   ){    
+   EMFTRACK *etl;
+   if(!et)return(1);
+   etl=*et;
+   if(!etl)return(2);
+   free(etl->buf);
+   free(etl);
+   *et=NULL;
    return(0);
 }
 
-/** 
-    \brief Set a U_COLORREF value from separate R,G,B values.
-    \param red    Red   component
-    \param green  Green component
-    \param blue   Blue  component
-    
+/**
+    \brief wrapper for fopen, works on any platform
+    \return 0 on success, >=1 on failure
+    \param filename file to open (either ASCII or UTF-8)
+    \param mode     U_READ or U_WRITE (these map to  "rb" and "wb")
 */
-U_COLORREF colorref3_set(
-      uint8_t red,
-      uint8_t green,
-      uint8_t blue
-   ){
-   U_COLORREF cr = (U_COLORREF){red , green, blue, 0};
-   return(cr);
+FILE *emf_fopen(
+      const char *filename,
+      const int mode
+   ){    
+   FILE *fp = NULL;
+#ifdef WIN32
+   uint16_t *fn16;
+   uint16_t *md16;
+   if(mode == U_READ){ md16 = U_Utf8ToUtf16le("rb", 0, NULL); }
+   else {              md16 = U_Utf8ToUtf16le("wb", 0, NULL); }
+   fn16 = U_Utf8ToUtf16le(filename, 0, NULL);
+   fp = _wfopen(fn16,md16);
+   free(fn16);
+   free(md16);
+#else
+   if(mode == U_READ){ fp = fopen(filename,"rb"); }
+   else {              fp = fopen(filename,"wb"); }
+#endif
+   return(fp);
 }
 
-/** 
-    \brief Set a U_COLORREF value from separate R,G,B, and Reserved values.
-    \param red        Red      component
-    \param green      Green    component
-    \param blue       Blue     component
-    \param Reserved   Reserved component
+/**
+    \brief Retrieve contents of an EMF file by name.
+    \return 0 on success, >=1 on failure
+    \param filename Name of file to open, including the path
+    \param contents Contents of the file.  Buffer must be free()'d by caller.
+    \param length   Number of bytes in Contents
+*/
+int emf_readdata(
+      const char   *filename,
+      char        **contents,
+      size_t       *length
+   ){    
+   FILE     *fp;
+   int       status=0;
+
+   *contents=NULL;
+   fp=emf_fopen(filename,U_READ);
+   if(!fp){ status = 1; }
+   else {
+      // read the entire file into memory
+      fseek(fp, 0, SEEK_END); // move to end
+      *length = ftell(fp);
+      rewind(fp);
+      *contents = (char *) malloc(*length);
+      if(!*contents){ 
+         status = 2; 
+      }
+      else {
+         size_t inbytes = fread(*contents,*length,1,fp);
+         if(inbytes != 1){
+            free(*contents);
+            status = 3;
+         }
+         else {
+#if U_BYTE_SWAP
+            //This is a Big Endian machine, EMF data is Little Endian
+            U_emf_endian(*contents,*length,0);  // LE to BE
+#endif
+          }
+      }
+      fclose(fp);
+   }
+    return(status);
+}
+
+
+/**
+    \brief Map the contents of an EMF file by name into memory, without copying it.
     
+    On systems with mmap() the file is mapped read only, so the records may be examined with
+    U_emf_onerec_print(), U_emf_record_safe(), and the like, but NOT modified.  On a Big Endian
+    machine the mapping is private and writable (copy on write), because U_emf_endian() must
+    rearrange the data in place.  On other systems this falls back to emf_readdata().
+    \return 0 on success, >=1 on failure
+    \param filename Name of file to open, including the path
+    \param contents Contents of the file.  Must be released with emf_unmapdata(), NOT free().
+    \param length   Number of bytes in Contents
 */
-U_COLORREF colorref4_set(
-      uint8_t red,
-      uint8_t green,
-      uint8_t blue,
-      uint8_t Reserved
-   ){
-   U_COLORREF cr = (U_COLORREF){red , green, blue, Reserved};
-   return(cr);
+int emf_mapdata(
+      const char   *filename,
+      char        **contents,
+      size_t       *length
+   ){    
+#ifdef WIN32
+   return(emf_readdata(filename, contents, length));
+#else
+   int          fd;
+   struct stat  sb;
+   void        *map;
+   int          status=0;
+
+   *contents=NULL;
+   *length=0;
+   fd=open(filename,O_RDONLY);
+   if(fd == -1){ status = 1; }
+   else {
+      if(fstat(fd, &sb) || sb.st_size <= 0){
+         status = 2;
+      }
+      else {
+#if U_BYTE_SWAP
+         map = mmap(NULL, sb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+#else
+         map = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+#endif
+         if(map == MAP_FAILED){
+            status = 3;
+         }
+         else {
+            *contents = (char *) map;
+            *length   = sb.st_size;
+#if U_BYTE_SWAP
+            //This is a Big Endian machine, EMF data is Little Endian
+            U_emf_endian(*contents,*length,0);  // LE to BE
+#endif
+         }
+      }
+      close(fd);
+   }
+   return(status);
+#endif
 }
 
-/** 
-    \brief Set a U_RGBQUAD value from separate R,G,B, Reserved values.
-    \param red       Red      component
-    \param green     Green    component
-    \param blue      Blue     component
-    \param reserved  Reserved component
+/**
+    \brief Release the contents of an EMF or WMF file obtained from emf_mapdata() or wmf_mapdata().
+    \return 0 on success, >=1 on failure
+    \param contents Contents of the file
+    \param length   Number of bytes in Contents
+*/
+int emf_unmapdata(
+      char         *contents,
+      size_t        length
+   ){    
+   if(!contents)return(1);
+#ifdef WIN32
+   (void) length;
+   free(contents);
+#else
+   if(munmap(contents, length))return(2);
+#endif
+   return(0);
+}
+
+/**
+    \brief Build an index of every record in an EMF in memory, in a single pass.
+    With the index any record, or run of records, may be found directly, see emf_index_record() and emf_index_span().
+    \return 0 on success, 1 on bad arguments, 2 on memory allocation failure, 3 if a record is corrupt
+    \param contents   EMF in memory, in native byte order (as from emf_readdata() or emf_mapdata())
+    \param length     number of bytes in contents
+    \param ei         index, must be released with emf_index_free()
     
+    Indexing stops after the U_EMR_EOF record, or at the end of the data.
+*/
+int emf_index_build(
+      const char   *contents,
+      size_t        length,
+      EMFINDEX    **ei
+   ){
+   EMFINDEX        *index;
+   EMFINDEXREC     *tmp;
+   PU_ENHMETARECORD pEmr;
+   size_t           off = 0;
+   uint32_t         space;
+
+   if(!contents || !ei || length < sizeof(U_EMR) || length > UINT32_MAX)return(1);
+   *ei = NULL;
+   index = (EMFINDEX *) malloc(sizeof(EMFINDEX));
+   if(!index)return(2);
+   index->length = length;
+   index->count  = 0;
+   space         = 1 + length/128;  /* a guess, most records are much smaller than this, grows if needed */
+   index->recs   = (EMFINDEXREC *) malloc(space * sizeof(EMFINDEXREC));
+   if(!index->recs){ free(index); return(2); }
+   while(off + sizeof(U_EMR) <= length){
+      pEmr = (PU_ENHMETARECORD)(contents + off);
+      if(pEmr->nSize < sizeof(U_EMR) || pEmr->nSize % 4 || pEmr->nSize > length - off){
+         emf_index_free(&index);
+         return(3);
+      }
+      if(index->count == space){
+         space *= 2;
+         tmp = (EMFINDEXREC *) realloc(index->recs, space * sizeof(EMFINDEXREC));
+         if(!tmp){ emf_index_free(&index); return(2); }
+         index->recs = tmp;
+      }
+      index->recs[index->count].offset = off;
+      index->recs[index->count].iType  = pEmr->iType;
+      index->recs[index->count].nSize  = pEmr->nSize;
+      index->count++;
+      off += pEmr->nSize;
+      if(pEmr->iType == U_EMR_EOF)break;
+   }
+   *ei = index;
+   return(0);
+}
+
+/**
+    \brief Release memory held by an EMFINDEX.
+    \return 0 on success, 1 on failure
+    \param ei index to release, set to NULL
 */
-U_RGBQUAD rgbquad_set(
-      uint8_t red,
-      uint8_t green,
-      uint8_t blue,
-      uint8_t reserved
+int emf_index_free(
+      EMFINDEX    **ei
    ){
-   U_RGBQUAD cr = (U_RGBQUAD){blue , green, red, reserved};
-   return(cr);
+   if(!ei || !*ei)return(1);
+   free((*ei)->recs);
+   free(*ei);
+   *ei = NULL;
+   return(0);
 }
 
 /**
-    \brief Set rect and rectl objects from Upper Left and Lower Right corner points.
-    \param ul upper left corner of rectangle
-    \param lr lower right corner of rectangle
+    \brief Find a record in an EMF in memory using its index.
+    \return pointer to the record, or NULL if recnum is out of range
+    \param contents   EMF in memory which was indexed
+    \param ei         index
+    \param recnum     record number, the first (U_EMR_HEADER) is 0
 */
-U_RECTL rectl_set(
-      U_POINTL ul,
-      U_POINTL lr
-    ){
-    U_RECTL rct;
-    rct.left     =   ul.x;
-    rct.top      =   ul.y;
-    rct.right    =   lr.x;
-    rct.bottom   =   lr.y;
-    return(rct);
+const char *emf_index_record(
+      const char     *contents,
+      const EMFINDEX *ei,
+      uint32_t        recnum
+   ){
+   if(!contents || !ei || recnum >= ei->count)return(NULL);
+   return(contents + ei->recs[recnum].offset);
 }
 
 /**
-    \brief Set rect and rectl objects from Upper Left and Lower Right corner points.
-    \param array array of rectangles
-    \param index  array entry to fill, numbered from 0
-    \param ul upper left corner of rectangle
-    \param lr lower right corner of rectangle
+    \brief Find the bytes occupied by a run of records, for instance to copy or remove them as one block.
+    \return 0 on success, 1 on failure (bad arguments or records out of range)
+    \param ei         index
+    \param first      first record number in the run
+    \param last       last record number in the run (inclusive)
+    \param offset     offset in bytes of the first record
+    \param length     bytes from the start of the first record to the end of the last record
 */
-void rectli_set(
-      PU_RECTL array,
-      int index,
-      U_POINTL ul,
-      U_POINTL lr
-    ){
-    PU_RECTL rct = &(array[index]);
-    rct->left     =   ul.x;
-    rct->top      =   ul.y;
-    rct->right    =   lr.x;
-    rct->bottom   =   lr.y;
+int emf_index_span(
+      const EMFINDEX *ei,
+      uint32_t        first,
+      uint32_t        last,
+      size_t         *offset,
+      size_t         *length
+   ){
+   if(!ei || !offset || !length || first > last || last >= ei->count)return(1);
+   *offset = ei->recs[first].offset;
+   *length = ei->recs[last].offset + ei->recs[last].nSize - ei->recs[first].offset;
+   return(0);
 }
 
-/**
-    \brief Set sizel objects with X,Y values.
-    \param x X coordinate 
-    \param y Y coordinate
-*/
-U_SIZEL sizel_set(
-       int32_t  x,
-       int32_t  y
-    ){
-    U_SIZEL sz;
-    sz.cx = x;
-    sz.cy = y;
-    return(sz);
-} 
+//! \cond
+/* Sidecar index file layout, all Little Endian uint32_t: "EMFI", version, length, count, then count x (offset, iType, nSize) */
+#define U_EMFINDEX_MAGIC    0x49464D45
+#define U_EMFINDEX_VERSION  1
+static void emf_index_put32(unsigned char *p, uint32_t v){
+   p[0] = v & 0xFF; p[1] = (v >> 8) & 0xFF; p[2] = (v >> 16) & 0xFF; p[3] = (v >> 24) & 0xFF;
+}
+static uint32_t emf_index_get32(const unsigned char *p){
+   return((uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24));
+}
+//! \endcond
 
 /**
-    \brief Set pointl objects with X,Y values.
-    \param x X coordinate 
-    \param y Y coordinate
-*/
-U_POINTL point32_set(
-       int32_t  x,   
-       int32_t  y
-    ){
-    U_POINTL pt;
-    pt.x = x;
-    pt.y = y;
-    return(pt);
-} 
+    \brief Write an index to a sidecar file, so that later runs need not rebuild it.  The file is the same on all platforms.
+    \return 0 on success, 1 on bad arguments, 2 on memory allocation failure, 3 if the file could not be written
+    \param filename  name of the index file
+    \param ei        index to save
+*/
+int emf_index_save(
+      const char     *filename,
+      const EMFINDEX *ei
+   ){
+   FILE          *fp;
+   unsigned char *buf, *p;
+   size_t         bytes;
+   uint32_t       i;
+   int            status = 0;
+
+   if(!filename || !ei)return(1);
+   bytes = 16 + (size_t) ei->count * 12;
+   buf   = (unsigned char *) malloc(bytes);
+   if(!buf)return(2);
+   emf_index_put32(buf,      U_EMFINDEX_MAGIC);
+   emf_index_put32(buf +  4, U_EMFINDEX_VERSION);
+   emf_index_put32(buf +  8, ei->length);
+   emf_index_put32(buf + 12, ei->count);
+   for(p = buf + 16, i = 0; i < ei->count; i++, p += 12){
+      emf_index_put32(p,     ei->recs[i].offset);
+      emf_index_put32(p + 4, ei->recs[i].iType);
+      emf_index_put32(p + 8, ei->recs[i].nSize);
+   }
+   fp = emf_fopen(filename, U_WRITE);
+   if(!fp){ status = 3; }
+   else {
+      if(1 != fwrite(buf, bytes, 1, fp))status = 3;
+      if(fclose(fp))status = 3;
+   }
+   free(buf);
+   return(status);
+}
+
+/**
+    \brief Read an index from a sidecar file written by emf_index_save().
+    The caller should compare ei->length with the size of the EMF to detect a stale index.
+    \return 0 on success, 1 on bad arguments, 2 on memory allocation failure, 3 if the file could not be read, 4 if it is not a valid index
+    \param filename  name of the index file
+    \param ei        index, must be released with emf_index_free()
+*/
+int emf_index_load(
+      const char     *filename,
+      EMFINDEX      **ei
+   ){
+   FILE          *fp;
+   EMFINDEX      *index;
+   unsigned char  head[16];
+   unsigned char *buf, *p;
+   uint32_t       i, count, length, next;
+
+   if(!filename || !ei)return(1);
+   *ei = NULL;
+   fp = emf_fopen(filename, U_READ);
+   if(!fp)return(3);
+   if(1 != fread(head, sizeof(head), 1, fp)){ fclose(fp); return(3); }
+   count  = emf_index_get32(head + 12);
+   length = emf_index_get32(head +  8);
+   if(emf_index_get32(head) != U_EMFINDEX_MAGIC || emf_index_get32(head + 4) != U_EMFINDEX_VERSION || 
+      count > length/sizeof(U_EMR)){ fclose(fp); return(4); }
+   index = (EMFINDEX *) malloc(sizeof(EMFINDEX));
+   buf   = (unsigned char *) malloc(1 + (size_t) count * 12);
+   if(index)index->recs = (EMFINDEXREC *) malloc(1 + count * sizeof(EMFINDEXREC));
+   if(!index || !buf || !index->recs){
+      if(index){ free(index->recs); free(index); }
+      free(buf);
+      fclose(fp);
+      return(2);
+   }
+   index->length = length;
+   index->count  = count;
+   if(count && 1 != fread(buf, (size_t) count * 12, 1, fp)){
+      free(buf);
+      fclose(fp);
+      emf_index_free(&index);
+      return(3);
+   }
+   fclose(fp);
+   /* records must be contiguous and lie within the EMF, so that lookups need no further checks */
+   for(next = 0, p = buf, i = 0; i < count; i++, p += 12){
+      index->recs[i].offset = emf_index_get32(p);
+      index->recs[i].iType  = emf_index_get32(p + 4);
+      index->recs[i].nSize  = emf_index_get32(p + 8);
+      if(index->recs[i].offset != next || index->recs[i].nSize < sizeof(U_EMR) || 
+         index->recs[i].nSize > length - next){
+         free(buf);
+         emf_index_free(&index);
+         return(4);
+      }
+      next += index->recs[i].nSize;
+   }
+   free(buf);
+   *ei = index;
+   return(0);
+}
 
-/**
-    \brief Set point16 objects with 16 bit X,Y values.
-    \param x X coordinate 
-    \param y Y coordinate
-*/
-U_POINT16 point16_set(
-       int16_t  x,
-       int16_t  y
-    ){
-    U_POINT16 pt;
-    pt.x = x;
-    pt.y = y;
-    return(pt);
-} 
+
+//! \cond
+/*  Set the size of buf in an EMFTRACK, keeping the statistics.  On failure buf is unchanged. */
+static int emf_buf_resize(
+      EMFTRACK        *et,
+      size_t           newsize
+   ){
+   char *newbuf;
+   newbuf = realloc(et->buf,newsize);
+   if(!newbuf)return(3);
+   et->buf        = newbuf;
+   et->allocated  = newsize;
+   et->reallocs++;
+   et->copied    += (et->stream ? 0 : et->used);  // streaming: buf holds only the header, which is small
+   return(0);
+}
+
+/*  Make room in buf for size more bytes, growing geometrically, see emf_reserve(). */
+static int emf_grow(
+      EMFTRACK        *et,
+      size_t           size
+   ){
+   size_t deficit;
+   if(size + et->used <= et->allocated)return(0);
+   deficit = size + et->used - et->allocated;
+   if(deficit < et->chunk)deficit = et->chunk;
+   if(deficit < et->allocated/2)deficit = et->allocated/2;  // geometric growth
+   return(emf_buf_resize(et, et->allocated + deficit));
+}
+//! \endcond
 
 /**
-    \brief Find the bounding rectangle from a polyline of a given width.
-    \param count  number of points in the polyline
-    \param pts    the polyline
-    \param width  width of drawn line
+    \brief Make room in an emf in memory for at least size more bytes, so that appending that much
+    will not reallocate buf memory.  Use this when the (approximate) size of the EMF is known in advance.
     
+    When emf_append() needs more space it grows buf geometrically, by half of its current size or by
+    the chunksize given to emf_start(), whichever is larger, so that the number of reallocations,
+    and the bytes they copy (see et->reallocs and et->copied), stay proportional to the final size of the 
+    EMF however small the chunksize is.
+    \return 0 for success, >=1 for failure.
+    \param et      EMF in memory
+    \param size    Number of bytes which will be appended
 */
-U_RECT findbounds(
-      uint32_t count,
-      PU_POINT pts,
-      uint32_t width
+int  emf_reserve(
+      EMFTRACK        *et,
+      size_t           size
    ){
-   U_RECT rect={INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN };
-   unsigned int i;
+   if(!et)return(2);
+   if(et->stream)return(0);    // nothing accumulates in memory
+   if(et->used + size <= et->allocated)return(0);
+   return(emf_buf_resize(et, et->used + size));
+}
 
-   for(i=0; i<count;i++,pts++){
-       if ( pts->x < rect.left )   rect.left   = pts->x;
-       if ( pts->x > rect.right )  rect.right  = pts->x;
-       if ( pts->y < rect.top )    rect.top    = pts->y;
-       if ( pts->y > rect.bottom ) rect.bottom = pts->y;
+/**
+    \brief Append an EMF record to an emf in memory. This may reallocate buf memory.
+    If the emf was started with emf_start_stream() the record is written to the file immediately.
+    \return 0 for success, >=1 for failure.
+    \param rec     Record to append to EMF in memory
+    \param et      EMF in memory
+    \param freerec If true, free rec after append    
+*/
+int  emf_append(
+      U_ENHMETARECORD *rec,
+      EMFTRACK        *et,
+      int              freerec
+   ){
+#if U_BYTE_SWAP
+   size_t hsize;
+#endif
+   
+#ifdef U_VALGRIND
+   printf("\nbefore \n");
+   printf(" probe %d\n",memprobe(rec, U_EMRSIZE(rec)));
+   printf("after \n");
+#endif
+   if(!rec)return(1);
+   if(!et)return(2);
+   if(emf_flush_open(et))return(4);
+   if(et->stream){
+      /* Keep a copy of the header in buf, emf_finish() patches it and writes it again.  On a Big Endian machine
+         each record is swapped in a copy which follows the header in buf, because rec may belong to the caller. */
+      if(!et->records){
+         if(rec->nSize > et->allocated && emf_buf_resize(et, rec->nSize))return(3);
+         memcpy(et->buf, rec, rec->nSize);
+      }
+#if U_BYTE_SWAP
+      //This is a Big Endian machine, EMF data must be  Little Endian
+      hsize = ((PU_EMR) et->buf)->nSize;
+      if(hsize + rec->nSize > et->allocated && emf_buf_resize(et, hsize + rec->nSize))return(3);
+      memcpy(et->buf + hsize, rec, rec->nSize);
+      (void) U_emf_endian(et->buf + hsize, rec->nSize, 1);  // one record, so the status is not meaningful
+      if(1 != fwrite(et->buf + hsize, rec->nSize, 1, et->fp))return(4);
+#else
+      if(1 != fwrite(rec, rec->nSize, 1, et->fp))return(4);
+#endif
    }
-   if(width > 0){
-     rect.left   -= width;
-     rect.right  += width;
-     rect.top    += width;
-     rect.bottom -= width;
+   else {
+      if(emf_grow(et, rec->nSize))return(3);
+      memcpy(et->buf + et->used, rec, rec->nSize);
    }
-   return(rect);
+   et->used += rec->nSize;
+   et->records++;
+   if(rec->iType == U_EMR_EOF){ et->PalEntries = ((U_EMREOF *)rec)->cbPalEntries; }
+   if(freerec){ free(rec); }
+   return(0);
+}
+
+//! \cond
+/*  Streaming: records built in place are staged in buf after the copy of the header, as in emf_append() on
+    Big Endian.  Make room there for size bytes and return the staging area, NULL on error. */
+static char *emf_stage(
+      EMFTRACK        *et,
+      size_t           size
+   ){
+   size_t hsize;
+   size_t need;
+   if(!et->records)return(NULL);  // the header must come first
+   hsize = ((PU_EMR) et->buf)->nSize;
+   if(hsize + size > et->allocated){
+      need = et->allocated + et->allocated/2;
+      if(need < hsize + size)need = hsize + size;
+      if(emf_buf_resize(et, need))return(NULL);
+   }
+   return(et->buf + hsize);
 }
+//! \endcond
 
 /**
-    \brief Find the bounding rectangle from a polyline of a given width.
-    \param count  number of points in the polyline
-    \param pts    the polyline
-    \param width  width of drawn line
-    
+    \brief Get space at the end of an emf in memory in which to build the next record in place, instead of
+    building it in a separate allocation and copying it in with emf_append().  Call this as often as needed
+    while the record is constructed, each time with the number of bytes needed so far, then finish the record
+    with emf_append_commit().
+
+    The space may move when it grows, so keep offsets into it, not pointers.  Bytes already written
+    are preserved.  The record must be built in native byte order, like one passed to emf_append().
+    If the emf was started with emf_start_stream() the header must already have been appended.
+    \return pointer to the start of the space, NULL on error.
+    \param et      EMF in memory
+    \param size    Number of bytes needed, counted from the start of the record
 */
-U_RECT findbounds16(
-      uint32_t count,
-      PU_POINT16 pts,
-      uint32_t width
+char *emf_append_space(
+      EMFTRACK        *et,
+      size_t           size
    ){
-   U_RECT rect={INT16_MAX, INT16_MAX, INT16_MIN, INT16_MIN };
-   unsigned int i;
+   if(!et)return(NULL);
+   if(emf_flush_open(et))return(NULL);  // a new record closes the previous one
+   if(et->stream)return(emf_stage(et, size));
+   if(emf_grow(et, size))return(NULL);
+   return(et->buf + et->used);
+}
 
-   for(i=0; i<count;i++,pts++){
-       if ( pts->x < rect.left )   rect.left   = pts->x;
-       if ( pts->x > rect.right )  rect.right  = pts->x;
-       if ( pts->y < rect.top )    rect.top    = pts->y;
-       if ( pts->y > rect.bottom ) rect.bottom = pts->y;
+/**
+    \brief Append the record built in the space returned by emf_append_space().  Its size is taken
+    from its nSize field, which must be a multiple of 4 and no larger than the space requested.
+
+    The record stays open, that is, it may be extended with emf_extend_space(), until the next record
+    is appended.  If the emf was started with emf_start_stream() it is written to the file at that time.
+    \return 0 for success, >=1 for failure.
+    \param et      EMF in memory
+*/
+int  emf_append_commit(
+      EMFTRACK        *et
+   ){
+   PU_EMR    rec;
+   size_t    avail;
+   uint32_t  size;
+   if(!et)return(2);
+   if(et->stream){
+      if(!et->records)return(1);
+      rec   = (PU_EMR)(et->buf + ((PU_EMR) et->buf)->nSize);
    }
-   if(width > 0){
-     rect.left   -= width;
-     rect.right  += width;
-     rect.top    += width;
-     rect.bottom -= width;
+   else {
+      rec   = (PU_EMR)(et->buf + et->used);
    }
-   return(rect);
+   avail = et->allocated - ((char *) rec - et->buf);
+   size  = rec->nSize;
+   if(size < sizeof(U_EMR) || (size & 3) || size > avail)return(1);
+   if(rec->iType == U_EMR_EOF){ et->PalEntries = ((U_EMREOF *)rec)->cbPalEntries; }
+   et->used += size;
+   et->records++;
+   et->open  = size;
+   return(0);
 }
+
 /**
-    \brief Construct a U_LOGBRUSH structure.
-    \return U_LOGBRUSH structure
-    \param lbStyle   LB_Style Enumeration
-    \param lbColor   Brush color
-    \param lbHatch   HatchStyle Enumertaion
+    \brief Get space to extend the open record, the last one appended with emf_append_commit(), provided
+    that no other record has been appended since.  Write the added data after its current end, then update 
+    its nSize field (and any other fields that depend on its size) and call emf_extend_commit().
+
+    As for emf_append_space() the space may move when it grows.
+    \return pointer to the start of the open record, NULL if there is none or on error.
+    \param et      EMF in memory
+    \param size    Number of bytes needed after the current end of the open record
 */
-U_LOGBRUSH logbrush_set(
-      uint32_t    lbStyle,
-      U_COLORREF  lbColor,
-      int32_t     lbHatch
+char *emf_extend_space(
+      EMFTRACK        *et,
+      size_t           size
    ){
-   U_LOGBRUSH lb;
-   lb.lbStyle = lbStyle;
-   lb.lbColor = lbColor;
-   lb.lbHatch = lbHatch;
-   return(lb);
+   if(!et || !et->open)return(NULL);
+   if(et->stream)return(emf_stage(et, et->open + size));
+   if(emf_grow(et, size))return(NULL);
+   return(et->buf + et->used - et->open);
 }
 
 /**
-    \brief Construct a U_XFORM structure.
-    \return U_XFORM structure
-    \param eM11 Rotation Matrix element
-    \param eM12 Rotation Matrix element
-    \param eM21 Rotation Matrix element
-    \param eM22 Rotation Matrix element
-    \param eDx  Translation element 
-    \param eDy  Translation element 
+    \brief Finish extending the open record, see emf_extend_space().  Its new size is taken from its nSize field,
+    which must be a multiple of 4, not smaller than before, and no larger than the space requested.
+    \return 0 for success, >=1 for failure.
+    \param et      EMF in memory
 */
-U_XFORM xform_set(
-      U_FLOAT eM11,
-      U_FLOAT eM12,
-      U_FLOAT eM21,
-      U_FLOAT eM22,
-      U_FLOAT eDx,
-      U_FLOAT eDy
+int  emf_extend_commit(
+      EMFTRACK        *et
    ){
-   U_XFORM xform;
-   xform.eM11 =  eM11;
-   xform.eM12 =  eM12;
-   xform.eM21 =  eM21;
-   xform.eM22 =  eM22;
-   xform.eDx  =  eDx;
-   xform.eDy  =  eDy;
-   return(xform);
+   PU_EMR    rec;
+   size_t    avail;
+   uint32_t  size;
+   if(!et || !et->open)return(2);
+   if(et->stream){
+      rec   = (PU_EMR)(et->buf + ((PU_EMR) et->buf)->nSize);
+   }
+   else {
+      rec   = (PU_EMR)(et->buf + et->used - et->open);
+   }
+   avail = et->allocated - ((char *) rec - et->buf);
+   size  = rec->nSize;
+   if(size < et->open || (size & 3) || size > avail)return(1);
+   et->used += size - et->open;
+   et->open  = size;
+   return(0);
 }
 
 /**
-    \brief Construct a U_XFORM structure.
-    \return U_XFORM structure
-    \param scale     Scale factor
-    \param ratio     Ratio of minor axis/major axis
-    \param rot       Rotation angle in degrees, positive is counter clockwise from the x axis.
-    \param axisrot   Angle in degrees defining the major axis before rotation, positive is counter clockwise from the x axis.
-    \param eDx       Translation element 
-    \param eDy       Translation element 
-    
-    Operation is:
-      1  Conformal map of points based on scale, axis rotation, and axis ratio,
-      2. Apply rotation
-      3. Apply offset
+    \brief Create a handle table. Entries filled with 0 are empty, entries >0 hold a handle.
+    \return 0 for success, >=1 for failure.
+    \param initsize Initialize with space for this number of handles
+    \param chunksize When needed increase space by this number of handles
+    \param eht EMF handle table    
 */
-U_XFORM xform_alt_set(
-      U_FLOAT scale,
-      U_FLOAT ratio,
-      U_FLOAT rot,
-      U_FLOAT axisrot,
-      U_FLOAT eDx,
-      U_FLOAT eDy
+int emf_htable_create(
+      uint32_t     initsize,
+      uint32_t     chunksize,
+      EMFHANDLES **eht
    ){
-   U_XFORM xform;
-   U_MAT2X2 mat1, mat2;
-   // angles are in degrees, must be in radians
-   rot     *=  (2.0 * U_PI)/360.0;
-   axisrot *= -(2.0 * U_PI)/360.0;
-   mat1.M11 = cos(rot);  // set up the rotation matrix
-   mat1.M12 = -sin(rot);
-   mat1.M21 = sin(rot);
-   mat1.M22 = cos(rot);
-   if(ratio!=1.0){  // set scale/ellipticity matrix
-      mat2.M11 =            scale*( cos(axisrot)*cos(axisrot) + ratio*sin(axisrot)*sin(axisrot) );
-      mat2.M12 = mat2.M21 = scale*( sin(axisrot)*cos(axisrot) * (1.0 - ratio)           );
-      mat2.M22 =            scale*( sin(axisrot)*sin(axisrot) + ratio*cos(axisrot)*cos(axisrot) );
+   EMFHANDLES *ehtl;
+   unsigned int i;
+   
+   if(initsize<1)return(1);
+   if(chunksize<1)return(2);
+   ehtl = (EMFHANDLES *) malloc(sizeof(EMFHANDLES));
+   if(!ehtl)return(3);
+   ehtl->table = malloc(initsize * sizeof(uint32_t));
+   if(!ehtl->table){
+      free(ehtl);
+      return(4);
    }
-   else { // when the ratio is 1.0 then the major axis angle is ignored and only scale matters
-      mat2.M11 = scale;
-      mat2.M12 = 0.0;
-      mat2.M21 = 0.0;
-      mat2.M22 = scale;
+   ehtl->stack = malloc(initsize * sizeof(uint32_t));
+   if(!ehtl->stack){
+      free(ehtl->table);
+      free(ehtl);
+      return(5);
    }
-   xform.eM11 =  mat2.M11 * mat1.M11 + mat2.M12 * mat1.M21;
-   xform.eM12 =  mat2.M11 * mat1.M12 + mat2.M12 * mat1.M22;;
-   xform.eM21 =  mat2.M21 * mat1.M11 + mat2.M22 * mat1.M21;
-   xform.eM22 =  mat2.M21 * mat1.M12 + mat2.M22 * mat1.M22;
-   xform.eDx  =  eDx;
-   xform.eDy  =  eDy;
-   return(xform);
+   memset(ehtl->table , 0, initsize * sizeof(uint32_t));  // zero all slots in the table
+   for(i=1; i<initsize; i++){ehtl->stack[i]=i;}             // preset the stack
+   ehtl->allocated = initsize;
+   ehtl->chunk     = chunksize;
+   ehtl->table[0]  = 0;         // This slot isn't actually ever used
+   ehtl->stack[0]  = 0;         // This stack position isn't actually ever used
+   ehtl->peak      = 1;
+   ehtl->sptr      = 1;
+   ehtl->top       = 0;
+   *eht            = ehtl;
+   return(0);
 }
 
-
 /**
-    \brief Construct a U_LOGCOLORSPACEA structure.
-    \return U_LOGCOLORSPACEA structure
-    \param lcsCSType     LCS_CSType Enumeration
-    \param lcsIntent     LCS_Intent Enumeration
-    \param lcsEndpoints  CIE XYZ color space endpoints
-    \param lcsGammaRGB   Gamma For RGB
-    \param lcsFilename   Could name an external color profile file, otherwise empty string
+    \brief Delete an entry from the handle table. Move it back onto the stack. The specified slot is filled with a 0.
+    \return 0 for success, >=1 for failure.
+    \param ih  handle
+    \param eht EMF handle table
+    
 */
-U_LOGCOLORSPACEA logcolorspacea_set(
-      int32_t             lcsCSType,
-      int32_t             lcsIntent,
-      U_CIEXYZTRIPLE      lcsEndpoints,
-      U_LCS_GAMMARGB      lcsGammaRGB,
-      char                *lcsFilename
+int emf_htable_delete(
+      uint32_t    *ih,
+      EMFHANDLES  *eht
    ){
-   U_LOGCOLORSPACEA lcsa;
-   lcsa.lcsSignature  =    U_LCS_SIGNATURE;
-   lcsa.lcsVersion    =    U_LCS_SIGNATURE;  
-   lcsa.lcsSize       =    sizeof(U_LOGCOLORSPACEA);     
-   lcsa.lcsCSType     =    lcsCSType;   
-   lcsa.lcsIntent     =    lcsIntent;   
-   lcsa.lcsEndpoints  =    lcsEndpoints;
-   lcsa.lcsGammaRGB   =    lcsGammaRGB; 
-   strncpy(lcsa.lcsFilename,lcsFilename,U_MAX_PATH);
-   lcsa.lcsFilename[U_MAX_PATH-1] = '\0';
-   return(lcsa);
+   if(!eht)return(1);
+   if(!eht->table)return(2);
+   if(!eht->stack)return(3);
+   if(*ih < 1)return(4);           // invalid handle
+   if(!eht->table[*ih])return(5);  // requested table position was not in use
+   eht->table[*ih]=0;              // remove handle from table
+   while(eht->top>0 && !eht->table[eht->top]){  // adjust top
+     eht->top--;
+   }
+   eht->sptr--;                   // adjust stack
+   eht->stack[eht->sptr]=*ih;      // place handle on stack
+   *ih=0;                         // invalidate handle variable, so a second delete will of it is not possible
+   return(0);
 }
 
 /**
-
-    \brief Construct a U_LOGCOLORSPACEW structure.
-    \return U_LOGCOLORSPACEW structure
-    \param lcsCSType     LCS_CSType Enumeration                                               
-    \param lcsIntent     LCS_Intent Enumeration                                               
-    \param lcsEndpoints  CIE XYZ color space endpoints                                        
-    \param lcsGammaRGB   Gamma For RGB                                                        
-    \param lcsFilename   Could name an external color profile file, otherwise empty string    
+    \brief Returns the index of the first free slot.  
+    Call realloc() if needed.  The slot is set to handle (indicates occupied) and the peak value is adjusted.
+    \return 0 for success, >=1 for failure.
+    \param ih  handle
+    \param eht EMF handle table
 */
-U_LOGCOLORSPACEW logcolorspacew_set(
-    int32_t             lcsCSType,
-    int32_t             lcsIntent,
-    U_CIEXYZTRIPLE      lcsEndpoints,
-    U_LCS_GAMMARGB      lcsGammaRGB,
-    uint16_t            *lcsFilename
-    ){
-    U_LOGCOLORSPACEW lcsa;
-    lcsa.lcsSignature  =    U_LCS_SIGNATURE;
-    lcsa.lcsVersion    =    U_LCS_SIGNATURE;  
-    lcsa.lcsSize       =    sizeof(U_LOGCOLORSPACEW);     
-    lcsa.lcsCSType     =    lcsCSType;   
-    lcsa.lcsIntent     =    lcsIntent;   
-    lcsa.lcsEndpoints  =    lcsEndpoints;
-    lcsa.lcsGammaRGB   =    lcsGammaRGB; 
-    wchar16strncpypad(lcsa.lcsFilename,lcsFilename,U_MAX_PATH);
-    lcsa.lcsFilename[U_MAX_PATH-1] = '\0';
-    return(lcsa);
+int emf_htable_insert(
+      uint32_t   *ih,
+      EMFHANDLES *eht
+   ){
+   unsigned int i;
+   size_t newsize;
+
+   if(!eht)return(1);
+   if(!eht->table)return(2);
+   if(!eht->stack)return(3);
+   if(!ih)return(4);
+   if(eht->sptr >= eht->allocated - 1){  // need to reallocate
+     newsize=eht->allocated + eht->chunk;
+     eht->table = realloc(eht->table,newsize * sizeof(uint32_t));
+     if(!eht->table)return(5);
+     memset(&eht->table[eht->allocated] , 0, eht->chunk * sizeof(uint32_t));  // zero all NEW slots in the table
+ 
+     eht->stack = realloc(eht->stack,newsize * sizeof(uint32_t));
+     if(!eht->stack)return(6);
+     for(i=eht->allocated; i<newsize;i++){ eht->stack[i] = i; }  // init all NEW slots in the stack
+     eht->allocated = newsize;
+   }
+   *ih = eht->stack[eht->sptr];     // handle that is inserted
+   if(eht->table[*ih])return(7);
+   eht->table[*ih] = *ih;           // handle goes into preexisting (but zero) slot in table
+   eht->stack[eht->sptr] = 0;
+   if(*ih > eht->top){        eht->top = *ih;  }
+   if(eht->sptr > eht->peak){ eht->peak = eht->sptr; }
+   eht->sptr++;         // next available handle
+   return(0);
 }
 
 /**
-
-    \brief Construct a U_PANOSE structure.
-    \return U_PANOSE structure
-    \param bFamilyType      FamilyType Enumeration
-    \param bSerifStyle      SerifType Enumeration
-    \param bWeight          Weight Enumeration
-    \param bProportion      Proportion Enumeration
-    \param bContrast        Contrast Enumeration
-    \param bStrokeVariation StrokeVariation Enumeration
-    \param bArmStyle        ArmStyle Enumeration
-    \param bLetterform      Letterform Enumeration
-    \param bMidline         Midline Enumeration
-    \param bXHeight         XHeight Enumeration
+    \brief Free all memory in an htable.  Sets the pointer to NULL.
+    \return 0 for success, >=1 for failure.
+    \param eht  EMF handle table
 */
-U_PANOSE panose_set(
-      uint8_t bFamilyType,
-      uint8_t bSerifStyle,
-      uint8_t bWeight,
-      uint8_t bProportion,
-      uint8_t bContrast,
-      uint8_t bStrokeVariation,
-      uint8_t bArmStyle,
-      uint8_t bLetterform,
-      uint8_t bMidline,
-      uint8_t bXHeight
-    ){
-    U_PANOSE panose;
-    panose.bFamilyType       = bFamilyType;      
-    panose.bSerifStyle       = bSerifStyle;      
-    panose.bWeight           = bWeight;          
-    panose.bProportion       = bProportion;      
-    panose.bContrast         = bContrast;        
-    panose.bStrokeVariation  = bStrokeVariation; 
-    panose.bArmStyle         = bArmStyle;        
-    panose.bLetterform       = bLetterform;      
-    panose.bMidline          = bMidline;         
-    panose.bXHeight          = bXHeight;
-    return(panose);        
+int emf_htable_free(
+      EMFHANDLES **eht
+   ){
+   EMFHANDLES *ehtl;
+   if(!eht)return(1);
+   ehtl = *eht;
+   if(!ehtl)return(2);
+   if(!ehtl->table)return(3);
+   if(!ehtl->stack)return(4);
+   free(ehtl->table);
+   free(ehtl->stack);
+   free(ehtl);
+   *eht=NULL;
+   return(0);
 }
 
-/**
-    \brief Construct a U_LOGFONT structure.
-    \return U_LOGFONT structure
-    \param lfHeight         Height in Logical units
-    \param lfWidth          Average Width in Logical units
-    \param lfEscapement     Angle in 0.1 degrees betweem escapement vector and X axis
-    \param lfOrientation    Angle in 0.1 degrees between baseline and X axis
-    \param lfWeight         LF_Weight Enumeration
-    \param lfItalic         Italics:   0 or 1
-    \param lfUnderline      Underline: 0 or 1
-    \param lfStrikeOut      Strikeout: 0 or 1
-    \param lfCharSet        LF_CharSet Enumeration
-    \param lfOutPrecision   LF_OutPrecision Enumeration
-    \param lfClipPrecision  LF_ClipPrecision Enumeration
-    \param lfQuality        LF_Quality Enumeration
-    \param lfPitchAndFamily LF_PitchAndFamily Enumeration
-    \param lfFaceName       Name of font. truncates at U_LF_FACESIZE, smaller must be null terminated
+//! \cond
+/*  64 bit hash of a byte array, the xxHash64 algorithm.  Used by the object cache, which only compares hashes
+    made on the same machine, so the native byte order is used when reading the data.  */
+#define U_H64_P1 0x9E3779B185EBCA87ULL
+#define U_H64_P2 0xC2B2AE3D27D4EB4FULL
+#define U_H64_P3 0x165667B19E3779F9ULL
+#define U_H64_P4 0x85EBCA77C2B2AE63ULL
+#define U_H64_P5 0x27D4EB2F165667C5ULL
+
+static uint64_t h64_rotl(uint64_t x, int r){ return((x << r) | (x >> (64 - r))); }
+static uint64_t h64_round(uint64_t acc, uint64_t in){ return(h64_rotl(acc + in * U_H64_P2, 31) * U_H64_P1); }
+static uint64_t h64_merge(uint64_t acc, uint64_t v){ return((acc ^ h64_round(0, v)) * U_H64_P1 + U_H64_P4); }
+
+static uint64_t h64_hash(const uint8_t *p, size_t len, uint64_t seed){
+   uint64_t h, v1, v2, v3, v4, k;
+   uint32_t k4;
+   size_t   left = len;
+
+   if(left >= 32){
+      v1 = seed + U_H64_P1 + U_H64_P2;
+      v2 = seed + U_H64_P2;
+      v3 = seed;
+      v4 = seed - U_H64_P1;
+      for(; left >= 32; left -= 32, p += 32){
+         memcpy(&k, p,      8); v1 = h64_round(v1, k);
+         memcpy(&k, p +  8, 8); v2 = h64_round(v2, k);
+         memcpy(&k, p + 16, 8); v3 = h64_round(v3, k);
+         memcpy(&k, p + 24, 8); v4 = h64_round(v4, k);
+      }
+      h = h64_rotl(v1, 1) + h64_rotl(v2, 7) + h64_rotl(v3, 12) + h64_rotl(v4, 18);
+      h = h64_merge(h, v1);
+      h = h64_merge(h, v2);
+      h = h64_merge(h, v3);
+      h = h64_merge(h, v4);
+   }
+   else {
+      h = seed + U_H64_P5;
+   }
+   h += len;
+   for(; left >= 8; left -= 8, p += 8){
+      memcpy(&k, p, 8);
+      h = h64_rotl(h ^ h64_round(0, k), 27) * U_H64_P1 + U_H64_P4;
+   }
+   if(left >= 4){
+      memcpy(&k4, p, 4);
+      h = h64_rotl(h ^ ((uint64_t) k4 * U_H64_P1), 23) * U_H64_P2 + U_H64_P3;
+      left -= 4; p += 4;
+   }
+   for(; left; left--, p++){
+      h = h64_rotl(h ^ (*p * U_H64_P5), 11) * U_H64_P1;
+   }
+   h ^= h >> 33;  h *= U_H64_P2;
+   h ^= h >> 29;  h *= U_H64_P3;
+   h ^= h >> 32;
+   return(h);
+}
+
+/*  Every record which creates an object holds its handle in the uint32_t which follows the U_EMR, so the hash and the
+    comparisons skip those 4 bytes.  The first 8 bytes (type and size) seed the hash of the rest.  */
+#define U_OBJCACHE_IH  8
+
+static int objcache_type(uint32_t iType){
+   switch(iType){
+      case U_EMR_CREATEPEN:
+      case U_EMR_CREATEBRUSHINDIRECT:
+      case U_EMR_CREATEPALETTE:
+      case U_EMR_EXTCREATEFONTINDIRECTW:
+      case U_EMR_CREATEMONOBRUSH:
+      case U_EMR_CREATEDIBPATTERNBRUSHPT:
+      case U_EMR_EXTCREATEPEN:
+      case U_EMR_CREATECOLORSPACE:
+      case U_EMR_CREATECOLORSPACEW:
+         return(1);
+      default:
+         return(0);
+   }
+}
 
-*/
-U_LOGFONT logfont_set(
-    int32_t    lfHeight,
-    int32_t    lfWidth,
-    int32_t    lfEscapement,
-    int32_t    lfOrientation,
-    int32_t    lfWeight,
-    uint8_t    lfItalic,
-    uint8_t    lfUnderline,
-    uint8_t    lfStrikeOut,
-    uint8_t    lfCharSet,
-    uint8_t    lfOutPrecision,
-    uint8_t    lfClipPrecision,
-    uint8_t    lfQuality,
-    uint8_t    lfPitchAndFamily,
-    uint16_t  *lfFaceName
-    ){
-    U_LOGFONT lf;
-    lf.lfHeight                  = lfHeight;          
-    lf.lfWidth                   = lfWidth;           
-    lf.lfEscapement              = lfEscapement;      
-    lf.lfOrientation             = lfOrientation;     
-    lf.lfWeight                  = lfWeight;          
-    lf.lfItalic                  = lfItalic;          
-    lf.lfUnderline               = lfUnderline;       
-    lf.lfStrikeOut               = lfStrikeOut;       
-    lf.lfCharSet                 = lfCharSet;         
-    lf.lfOutPrecision            = lfOutPrecision;    
-    lf.lfClipPrecision           = lfClipPrecision;   
-    lf.lfQuality                 = lfQuality;         
-    lf.lfPitchAndFamily          = lfPitchAndFamily;  
-    wchar16strncpypad(lf.lfFaceName, lfFaceName, U_LF_FACESIZE); // pad this one as the intial structure was not set to zero
-    lf.lfFaceName[U_LF_FACESIZE-1] = '\0';
-    return(lf);
+static uint64_t objcache_hash(const char *rec, uint32_t nSize){
+   uint64_t seed;
+   memcpy(&seed, rec, 8);
+   return(h64_hash((const uint8_t *) rec + U_OBJCACHE_IH + 4, nSize - U_OBJCACHE_IH - 4, seed));
+}
+
+static int objcache_same(const char *a, const char *b, uint32_t nSize){
+   return(!memcmp(a, b, U_OBJCACHE_IH) && !memcmp(a + U_OBJCACHE_IH + 4, b + U_OBJCACHE_IH + 4, nSize - U_OBJCACHE_IH - 4));
 }
 
+/* Return the slot holding handle ih, or -1 if it is not in the cache. */
+static int64_t objcache_find_ih(EMFOBJCACHE *eoc, uint32_t ih){
+   uint32_t mask = eoc->allocated - 1;
+   uint32_t slot;
+   if(ih < 1 || ih >= eoc->ihallocated)return(-1);
+   for(slot = eoc->ihhash[ih] & mask; eoc->slots[slot].ih; slot = (slot + 1) & mask){
+      if(eoc->slots[slot].ih == ih)return(slot);
+   }
+   return(-1);
+}
+
+/* Empty a slot, moving later entries of the same probe run back so that no search stops early. */
+static void objcache_remove(EMFOBJCACHE *eoc, uint32_t slot){
+   uint32_t mask = eoc->allocated - 1;
+   uint32_t next, home;
+   free(eoc->slots[slot].rec);
+   eoc->ihhash[eoc->slots[slot].ih] = 0;
+   for(next = (slot + 1) & mask; eoc->slots[next].ih; next = (next + 1) & mask){
+      home = eoc->slots[next].hash & mask;
+      if(((next - home) & mask) >= ((next - slot) & mask)){
+         eoc->slots[slot] = eoc->slots[next];
+         slot = next;
+      }
+   }
+   eoc->slots[slot].ih  = 0;
+   eoc->slots[slot].rec = NULL;
+   eoc->used--;
+}
+
+/* Place an entry in the first free slot of its probe run.  The table must have a free slot. */
+static void objcache_place(EMFOBJCACHE *eoc, EMFCACHEENTRY entry){
+   uint32_t mask = eoc->allocated - 1;
+   uint32_t slot;
+   for(slot = entry.hash & mask; eoc->slots[slot].ih; slot = (slot + 1) & mask){}
+   eoc->slots[slot] = entry;
+   eoc->used++;
+}
+
+/* Keep the table at most half full.  Returns 0 on success, 1 if memory could not be allocated. */
+static int objcache_grow(EMFOBJCACHE *eoc){
+   EMFCACHEENTRY *old      = eoc->slots;
+   uint32_t       oldalloc = eoc->allocated;
+   uint32_t       i;
+
+   if(2 * (eoc->used + 1) <= eoc->allocated)return(0);
+   eoc->slots = calloc(2 * oldalloc, sizeof(EMFCACHEENTRY));
+   if(!eoc->slots){
+      eoc->slots = old;
+      return(1);
+   }
+   eoc->allocated = 2 * oldalloc;
+   eoc->used      = 0;
+   for(i = 0; i < oldalloc; i++){
+      if(old[i].ih)objcache_place(eoc, old[i]);
+   }
+   free(old);
+   return(0);
+}
+//! \endcond
 
 /**
-    \brief Construct a U_LOGFONT_PANOSE structure.
-    \return U_LOGFONT_PANOSE structure
-    \param elfLogFont    Basic font attributes
-    \param elfFullName   Font full name, truncates at U_LF_FULLFACESIZE, smaller must be null terminated
-    \param elfStyle      Font style, truncates at U_LF_FULLFACESIZE, smaller must be null terminated
-    \param elfStyleSize  Font hinting starting at this point size, if 0, starts at Height
-    \param elfPanose     Panose Object. If all zero, it is ignored.
-*/
-U_LOGFONT_PANOSE logfont_panose_set(
-      U_LOGFONT   elfLogFont,
-      uint16_t   *elfFullName,
-      uint16_t   *elfStyle,
-      uint32_t    elfStyleSize,
-      U_PANOSE    elfPanose
-    ){
-   U_LOGFONT_PANOSE lfp;
-   memset(&lfp,0,sizeof(U_LOGFONT_PANOSE)); // all fields zero unless needed.  Many should be ignored or must be 0.
-   wchar16strncpy(lfp.elfFullName, elfFullName, U_LF_FULLFACESIZE);
-   lfp.elfFullName[U_LF_FULLFACESIZE-1] = '\0';
-   wchar16strncpy(lfp.elfStyle,    elfStyle,    U_LF_FACESIZE);
-   lfp.elfStyle[U_LF_FACESIZE-1] = '\0';
-   lfp.elfLogFont    =   elfLogFont;
-   lfp.elfStyleSize  =   elfStyleSize;
-   lfp.elfPanose     =   elfPanose;
-   return(lfp);
+    \brief Create an object cache, see emf_objcache_use().
+    \return 0 for success, >=1 for failure.
+    \param initsize Initialize with space for this number of objects, the cache grows as needed
+    \param eoc      EMF object cache
+*/
+int emf_objcache_create(
+      uint32_t      initsize,
+      EMFOBJCACHE **eoc
+   ){
+   EMFOBJCACHE *eocl;
+   uint32_t     size = 16;
+
+   if(!eoc)return(1);
+   while(size < 2 * initsize && size < (1U << 30)){ size *= 2; }
+   eocl = (EMFOBJCACHE *) calloc(1, sizeof(EMFOBJCACHE));
+   if(!eocl)return(2);
+   eocl->slots  = calloc(size, sizeof(EMFCACHEENTRY));
+   eocl->ihhash = calloc(size, sizeof(uint64_t));
+   if(!eocl->slots || !eocl->ihhash){
+      free(eocl->slots);
+      free(eocl->ihhash);
+      free(eocl);
+      return(3);
+   }
+   eocl->allocated   = size;
+   eocl->ihallocated = size;
+   *eoc              = eocl;
+   return(0);
 }
 
 /**
-    \brief Construct a U_BITMAPINFOHEADER structure.
-    \return U_BITMAPINFOHEADER structure
-    \param biWidth         Bitmap width in pixels
-    \param biHeight        Bitmap height in pixels
-    \param biPlanes        Planes (must be 1)
-    \param biBitCount      BitCount Enumeration
-    \param biCompression   BI_Compression Enumeration
-    \param biSizeImage     Size in bytes of image
-    \param biXPelsPerMeter X Resolution in pixels/meter
-    \param biYPelsPerMeter Y Resolution in pixels/meter
-    \param biClrUsed       Number of bmciColors in U_BITMAPCOREINFO
-    \param biClrImportant  Number of bmciColors needed (0 means all). 
+    \brief Reuse the handle of an identical object, if there is one, instead of writing a new object.
+    
+    Call this with the record returned by one of the pen, brush, font, palette, or color space create
+    functions (for instance createpen_set() or createdibpatternbrushpt_set()) before it is appended to the EMF.
+    If an object identical to it, apart from the handle, was passed in before and still exists, the record is
+    freed, *rec is set to NULL, the new handle is deleted from eht, and *ih is set to the existing handle.
+    Otherwise the record is remembered and left unchanged, and the caller appends it as usual.  Either way the
+    caller then selects *ih.  Typical use:
+    
+        rec = createdibpatternbrushpt_set(&ih, eht, U_DIB_RGB_COLORS, Bmi, cbPx, Px);
+        if(emf_objcache_use(eoc, eht, &rec, &ih))error...
+        if(rec && emf_append((PU_ENHMETARECORD)rec, et, 1))error...
+        rec = selectobject_set(ih, eht);
+    
+    Cached objects should only be deleted after calling emf_objcache_forget() for their handles.
+    Objects which were deleted without that are noticed (as long as their handle is not reused by an object
+    which did not go through the cache) and are not reused.
+    \return 0 for success, >=1 for failure.
+    \param eoc EMF object cache
+    \param eht EMF handle table
+    \param rec Record which creates an object, may be replaced by NULL
+    \param ih  Handle of that object, may be replaced by the handle of an identical object
 */
-U_BITMAPINFOHEADER bitmapinfoheader_set(
-      int32_t       biWidth,
-      int32_t       biHeight,
-      uint16_t      biPlanes,
-      uint16_t      biBitCount,
-      uint32_t      biCompression,
-      uint32_t      biSizeImage,
-      int32_t       biXPelsPerMeter,
-      int32_t       biYPelsPerMeter,
-      U_NUM_RGBQUAD biClrUsed,
-      uint32_t      biClrImportant
-    ){
-    U_BITMAPINFOHEADER Bmi;
-    Bmi.biSize          = sizeof(U_BITMAPINFOHEADER);         
-    Bmi.biWidth         = biWidth;        
-    Bmi.biHeight        = biHeight;       
-    Bmi.biPlanes        = biPlanes;       
-    Bmi.biBitCount      = biBitCount;     
-    Bmi.biCompression   = biCompression;  
-    Bmi.biSizeImage     = biSizeImage;    
-    Bmi.biXPelsPerMeter = biXPelsPerMeter;
-    Bmi.biYPelsPerMeter = biYPelsPerMeter;
-    Bmi.biClrUsed       = biClrUsed;      
-    Bmi.biClrImportant  = biClrImportant;
-    return(Bmi); 
-}
+int emf_objcache_use(
+      EMFOBJCACHE *eoc,
+      EMFHANDLES  *eht,
+      char       **rec,
+      uint32_t    *ih
+   ){
+   PU_ENHMETARECORD  pEmr;
+   EMFCACHEENTRY     entry;
+   EMFCACHEENTRY    *e;
+   uint64_t         *ihhash;
+   uint32_t          mask, slot, rih, newsize;
+   int64_t           old;
+
+   if(!eoc || !eht || !rec || !*rec || !ih)return(1);
+   pEmr = (PU_ENHMETARECORD) *rec;
+   if(!objcache_type(pEmr->iType) || pEmr->nSize < U_OBJCACHE_IH + 4)return(2);
+   memcpy(&rih, *rec + U_OBJCACHE_IH, 4);
+   if(rih != *ih || *ih < 1 || *ih >= eht->allocated || eht->table[*ih] != *ih)return(3);
+
+   entry.hash = objcache_hash(*rec, pEmr->nSize);
+   mask = eoc->allocated - 1;
+   for(slot = entry.hash & mask; eoc->slots[slot].ih; slot = (slot + 1) & mask){
+      e = &eoc->slots[slot];
+      if(e->hash != entry.hash)continue;
+      if(((PU_ENHMETARECORD) e->rec)->nSize != pEmr->nSize || !objcache_same(e->rec, *rec, pEmr->nSize))continue;
+      if(e->ih == *ih || e->ih >= eht->allocated || eht->table[e->ih] != e->ih){  // deleted without emf_objcache_forget()
+         objcache_remove(eoc, slot);
+         break;
+      }
+      if(emf_htable_delete(ih, eht))return(4);
+      *ih = e->ih;
+      eoc->hits++;
+      eoc->saved += pEmr->nSize;
+      free(*rec);
+      *rec = NULL;
+      return(0);
+   }
 
+   /* Not found, remember it.  A handle can only hold one object, so drop whatever the cache had for this one. */
+   old = objcache_find_ih(eoc, *ih);
+   if(old >= 0)objcache_remove(eoc, old);
+   if(*ih >= eoc->ihallocated){
+      for(newsize = eoc->ihallocated; newsize <= *ih; newsize *= 2){}
+      ihhash = realloc(eoc->ihhash, newsize * sizeof(uint64_t));
+      if(!ihhash)return(5);
+      memset(ihhash + eoc->ihallocated, 0, (newsize - eoc->ihallocated) * sizeof(uint64_t));
+      eoc->ihhash      = ihhash;
+      eoc->ihallocated = newsize;
+   }
+   if(objcache_grow(eoc))return(5);
+   entry.ih  = *ih;
+   entry.rec = malloc(pEmr->nSize);
+   if(!entry.rec)return(5);
+   memcpy(entry.rec, *rec, pEmr->nSize);
+   objcache_place(eoc, entry);
+   eoc->ihhash[*ih] = entry.hash;
+   return(0);
+}
 
 /**
-    \brief Allocate and construct a U_BITMAPINFO structure.
-    \return Pointer to a U_BITMAPINFO structure
-    \param BmiHeader   Geometry and pixel properties
-    \param BmiColors   Color table (must be NULL for some  values of BmiHeader->biBitCount)
+    \brief Remove an object from the cache, so that its handle may be deleted and reused.
+    \return 0 for success, >=1 for failure.  Handles which are not in the cache are not an error.
+    \param eoc EMF object cache
+    \param ih  Handle of the object
 */
-PU_BITMAPINFO bitmapinfo_set(
-      U_BITMAPINFOHEADER  BmiHeader,
-      PU_RGBQUAD          BmiColors
+int emf_objcache_forget(
+      EMFOBJCACHE *eoc,
+      uint32_t     ih
    ){
-   char *record;
-   int   irecsize;
-   int   cbColors, cbColors4, off;
+   int64_t slot;
+   if(!eoc)return(1);
+   slot = objcache_find_ih(eoc, ih);
+   if(slot >= 0)objcache_remove(eoc, slot);
+   return(0);
+}
 
-   cbColors  = 4*get_real_color_count((char *) &BmiHeader);
-   cbColors4 = UP4(cbColors);
-   irecsize  = sizeof(U_BITMAPINFOHEADER) + cbColors4;
-   record    = malloc(irecsize);
-   if(record){
-     memcpy(record, &BmiHeader, sizeof(U_BITMAPINFOHEADER));
-     if(cbColors){
-        off = sizeof(U_BITMAPINFOHEADER);
-        memcpy(record + off, BmiColors, cbColors);
-        off += cbColors;
-        if(cbColors4 - cbColors){  memset(record + off, 0, cbColors4 - cbColors); }
-     }
+/**
+    \brief Free all memory in an object cache.  Sets the pointer to NULL.
+    \return 0 for success, >=1 for failure.
+    \param eoc EMF object cache
+*/
+int emf_objcache_free(
+      EMFOBJCACHE **eoc
+   ){
+   EMFOBJCACHE *eocl;
+   uint32_t     i;
+   if(!eoc)return(1);
+   eocl = *eoc;
+   if(!eocl)return(2);
+   for(i = 0; i < eocl->allocated; i++){ free(eocl->slots[i].rec); }
+   free(eocl->slots);
+   free(eocl->ihhash);
+   free(eocl);
+   *eoc = NULL;
+   return(0);
+}
+
+//! \cond
+/*  EMF and WMF headers hold the number of handles as a uint16_t, so no valid handle is larger than this.  A
+    corrupt file with a huge handle must not make the table grow without limit.  */
+#define U_OBJTABLE_MAXIH  0xFFFF
+
+/* Make room for handle ih.  Returns 0 on success, 1 if memory could not be allocated or ih is too large. */
+static int objtable_grow(U_OBJTABLE *ot, uint32_t ih){
+   U_OBJENTRY *objects;
+   uint32_t   *heap;
+   uint32_t    newsize = ot->allocated;
+
+   if(ih < ot->allocated)return(0);
+   if(ih > U_OBJTABLE_MAXIH)return(1);
+   while(newsize <= ih){ newsize *= 2; }
+   objects = realloc(ot->objects, (size_t) newsize * sizeof(U_OBJENTRY));
+   if(!objects)return(1);
+   ot->objects = objects;
+   memset(objects + ot->allocated, 0, (size_t)(newsize - ot->allocated) * sizeof(U_OBJENTRY));
+   heap = realloc(ot->free, (size_t) newsize * sizeof(uint32_t));
+   if(!heap)return(1);     // objects is larger than needed, which does no harm
+   ot->free      = heap;
+   ot->allocated = newsize;
+   return(0);
+}
+
+static void objtable_heap_push(U_OBJTABLE *ot, uint32_t ih){
+   uint32_t i = ot->nfree++;
+   uint32_t parent;
+   for(; i; i = parent){
+      parent = (i - 1) / 2;
+      if(ot->free[parent] <= ih)break;
+      ot->free[i] = ot->free[parent];
    }
-   return((PU_BITMAPINFO) record);
+   ot->free[i] = ih;
+}
+
+static uint32_t objtable_heap_pop(U_OBJTABLE *ot){
+   uint32_t top  = ot->free[0];
+   uint32_t last = ot->free[--ot->nfree];
+   uint32_t i    = 0;
+   uint32_t child;
+   while((child = 2 * i + 1) < ot->nfree){
+      if(child + 1 < ot->nfree && ot->free[child + 1] < ot->free[child])child++;
+      if(last <= ot->free[child])break;
+      ot->free[i] = ot->free[child];
+      i = child;
+   }
+   ot->free[i] = last;
+   return(top);
 }
+//! \endcond
 
 /**
-    \brief Allocate and construct a U_EXTLOGPEN structure.
-    \return pointer to U_EXTLOGPEN structure, or NULL on error
-    \param elpPenStyle   PenStyle Enumeration
-    \param elpWidth      Width in logical units (elpPenStyle & U_PS_GEOMETRIC) or 1 (pixel)
-    \param elpBrushStyle LB_Style Enumeration
-    \param elpColor      Pen color
-    \param elpHatch      HatchStyle Enumeration
-    \param elpNumEntries Count of StyleEntry array
-    \param elpStyleEntry Array of StyleEntry (For user specified dot/dash patterns)
+    \brief Create an object table.
+    \return 0 for success, >=1 for failure.
+    \param initsize Initialize with space for this number of handles, the table grows as needed
+    \param ot       object table
 */
-PU_EXTLOGPEN extlogpen_set(
-      uint32_t            elpPenStyle,
-      uint32_t            elpWidth,
-      uint32_t            elpBrushStyle,
-      U_COLORREF          elpColor,
-      int32_t             elpHatch,
-      U_NUM_STYLEENTRY    elpNumEntries,
-      U_STYLEENTRY       *elpStyleEntry
-   ){
-   int irecsize,szSyleArray;
-   char *record;
-   
-   if(elpNumEntries){
-     if(!elpStyleEntry)return(NULL);
-     szSyleArray   = elpNumEntries * sizeof(U_STYLEENTRY);
-     irecsize = sizeof(U_EXTLOGPEN) + szSyleArray - sizeof(U_STYLEENTRY); // first one is in the record
+int U_objtable_create(
+      uint32_t     initsize,
+      U_OBJTABLE **ot
+   ){
+   U_OBJTABLE *otl;
+   if(!ot)return(1);
+   if(initsize < 16)initsize = 16;
+   otl = (U_OBJTABLE *) calloc(1, sizeof(U_OBJTABLE));
+   if(!otl)return(2);
+   otl->objects = calloc(initsize, sizeof(U_OBJENTRY));
+   otl->free    = malloc(initsize * sizeof(uint32_t));
+   if(!otl->objects || !otl->free){
+      free(otl->objects);
+      free(otl->free);
+      free(otl);
+      return(3);
    }
-   else {
-     szSyleArray   = 0;
-     irecsize = sizeof(U_EXTLOGPEN);
+   otl->allocated = initsize;
+   *ot            = otl;
+   return(0);
+}
+
+/**
+    \brief Define the object with handle ih, replacing any object which already had that handle.
+    This is for EMF files, where the creating record holds the handle.  Do not mix with U_objtable_insert().
+    \return 0 for success, >=1 for failure.
+    \param ot     object table
+    \param ih     handle
+    \param type   type of the creating record
+    \param record the creating record
+    \param offset offset of the creating record in the file
+*/
+int U_objtable_set(
+      U_OBJTABLE  *ot,
+      uint32_t     ih,
+      uint32_t     type,
+      const char  *record,
+      uint32_t     offset
+   ){
+   if(!ot || !type)return(1);
+   if(objtable_grow(ot, ih))return(2);
+   if(!ot->objects[ih].type)ot->count++;
+   ot->objects[ih].type   = type;
+   ot->objects[ih].offset = offset;
+   ot->objects[ih].record = record;
+   return(0);
+}
+
+/**
+    \brief Define an object in the lowest free handle, and return that handle.
+    This is for WMF files, where each new object takes the lowest free handle (starting from 0).  Do not mix with U_objtable_set().
+    \return 0 for success, >=1 for failure.
+    \param ot     object table
+    \param type   type of the creating record
+    \param record the creating record
+    \param offset offset of the creating record in the file
+    \param ih     handle assigned to the object
+*/
+int U_objtable_insert(
+      U_OBJTABLE  *ot,
+      uint32_t     type,
+      const char  *record,
+      uint32_t     offset,
+      uint32_t    *ih
+   ){
+   uint32_t ihl;
+   if(!ot || !type || !ih)return(1);
+   if(ot->nfree){
+      ihl = objtable_heap_pop(ot);
    }
-   record   = malloc(irecsize);
-   if(record){
-     ((PU_EXTLOGPEN) record)->elpPenStyle    = elpPenStyle;                             
-     ((PU_EXTLOGPEN) record)->elpWidth       = elpWidth;                                
-     ((PU_EXTLOGPEN) record)->elpBrushStyle  = elpBrushStyle;                           
-     ((PU_EXTLOGPEN) record)->elpColor       = elpColor;                                
-     ((PU_EXTLOGPEN) record)->elpHatch       = elpHatch;                                
-     ((PU_EXTLOGPEN) record)->elpNumEntries  = elpNumEntries;                           
-     if(elpNumEntries){ memcpy(((PU_EXTLOGPEN) record)->elpStyleEntry,elpStyleEntry,szSyleArray);   }
-     else {             memset(((PU_EXTLOGPEN) record)->elpStyleEntry,0,sizeof(U_STYLEENTRY)); }  // not used, but this stops valgrind warnings
+   else {
+      if(objtable_grow(ot, ot->next))return(2);
+      ihl = ot->next++;
    }
-   return((PU_EXTLOGPEN) record);
+   ot->objects[ihl].type   = type;
+   ot->objects[ihl].offset = offset;
+   ot->objects[ihl].record = record;
+   ot->count++;
+   *ih = ihl;
+   return(0);
 }
 
 /**
-    \brief Construct a U_LOGPEN structure.
-    \return U_LOGPEN structure
-    \param lopnStyle PenStyle Enumeration
-    \param lopnWidth Width of pen set by X, Y is ignored
-    \param lopnColor Pen color value
-    
-*/
-U_LOGPEN logpen_set(
-      uint32_t     lopnStyle,
-      U_POINT      lopnWidth,
-      U_COLORREF   lopnColor
-   ){
-   U_LOGPEN lp;
-   lp.lopnStyle = lopnStyle;
-   lp.lopnWidth = lopnWidth;
-   lp.lopnColor = lopnColor;
-   return(lp);
-} 
+    \brief Delete the object with handle ih.
+    \return 0 for success, >=1 for failure.
+    \param ot object table
+    \param ih handle
+*/
+int U_objtable_delete(
+      U_OBJTABLE  *ot,
+      uint32_t     ih
+   ){
+   if(!ot)return(1);
+   if(ih >= ot->allocated || !ot->objects[ih].type)return(2);  // requested handle was not in use
+   memset(&ot->objects[ih], 0, sizeof(U_OBJENTRY));
+   ot->count--;
+   if(ih < ot->next)objtable_heap_push(ot, ih);
+   return(0);
+}
 
 /**
-    \brief Construct a U_LOGPLTNTRY structure.
-    \return U_LOGPLTNTRY structure
-    \param peReserved Ignore
-    \param peRed      Palette entry Red Intensity
-    \param peGreen    Palette entry Green Intensity
-    \param peBlue     Palette entry Blue Intensity
+    \brief Find the object with handle ih.
+    \return pointer to the object, or NULL if no object has that handle.  The pointer is valid until the table is next changed.
+    \param ot object table
+    \param ih handle
 */
-U_LOGPLTNTRY logpltntry_set(
-      uint8_t    peReserved,
-      uint8_t    peRed,
-      uint8_t    peGreen,
-      uint8_t    peBlue
+const U_OBJENTRY *U_objtable_get(
+      const U_OBJTABLE  *ot,
+      uint32_t           ih
    ){
-   U_LOGPLTNTRY lpny;
-   lpny.peReserved = peReserved;
-   lpny.peRed      = peRed;     
-   lpny.peGreen    = peGreen;   
-   lpny.peBlue     = peBlue;
-   return(lpny);     
+   if(!ot || ih >= ot->allocated || !ot->objects[ih].type)return(NULL);
+   return(&ot->objects[ih]);
 }
 
 /**
-    \brief Allocate and construct a U_LOGPALETTE structure.
-    \return pointer to U_LOGPALETTE structure, or NULL on error.
-    \param palNumEntries Number of U_LOGPLTNTRY objects
-    \param palPalEntry   array, PC_Entry Enumeration
+    \brief Free all memory in an object table.  Sets the pointer to NULL.
+    \return 0 for success, >=1 for failure.
+    \param ot object table
 */
-PU_LOGPALETTE logpalette_set(
-      U_NUM_LOGPLTNTRY    palNumEntries,
-      PU_LOGPLTNTRY      *palPalEntry
+int U_objtable_free(
+      U_OBJTABLE **ot
    ){
-   PU_LOGPALETTE record;
-   int cbPalArray,irecsize;
-   
-   if(palNumEntries == 0 || !palPalEntry)return(NULL);
-   cbPalArray = palNumEntries * sizeof(U_LOGPLTNTRY);
-   irecsize = sizeof(U_LOGPALETTE) + cbPalArray - sizeof(U_LOGPLTNTRY);
-   record = (PU_LOGPALETTE) malloc(irecsize);
-   if(irecsize){
-      record->palVersion    = U_LP_VERSION;
-      record->palNumEntries = palNumEntries;
-      memcpy(record->palPalEntry,palPalEntry,cbPalArray);
+   if(!ot || !*ot)return(1);
+   free((*ot)->objects);
+   free((*ot)->free);
+   free(*ot);
+   *ot = NULL;
+   return(0);
+}
+
+/**
+    \brief Update an object table for one EMF record.
+    
+    Call this for each record, in order, while reading an EMF file.  Records which create a pen, brush, font,
+    palette, or color space define the object with their handle, U_EMR_DELETEOBJECT deletes it, and all other
+    records are ignored.  A U_EMR_SELECTOBJECT (or any other record holding a handle) may then be resolved
+    with U_objtable_get().  Stock objects (U_STOCK_OBJECT set in the handle) are never in the table.
+    The record should have been checked with U_emf_record_safe() first.
+    \return 0 for success, >=1 for failure.
+    \param ot     object table
+    \param record EMF record
+    \param offset offset of the record in the file
+*/
+int emf_objtable_record(
+      U_OBJTABLE  *ot,
+      const char  *record,
+      uint32_t     offset
+   ){
+   PU_ENHMETARECORD pEmr = (PU_ENHMETARECORD) record;
+   uint32_t         ih;
+
+   if(!ot || !record)return(1);
+   if(pEmr->iType != U_EMR_DELETEOBJECT && !objcache_type(pEmr->iType))return(0);
+   if(pEmr->nSize < U_OBJCACHE_IH + 4)return(2);
+   memcpy(&ih, record + U_OBJCACHE_IH, 4);
+   if(ih & U_STOCK_OBJECT)return(0);
+   if(pEmr->iType == U_EMR_DELETEOBJECT){
+      if(U_objtable_delete(ot, ih))return(3);
+      return(0);
    }
-   return(record);
+   if(U_objtable_set(ot, ih, pEmr->iType, record, offset))return(4);
+   return(0);
+}
+
+//! \cond
+static void dcstate_noclip(U_DC *dc){
+   dc->clipSet     = 0;
+   dc->clipExact   = 0;
+   dc->clip.left   = U_DC_UNBOUNDED_MIN;
+   dc->clip.top    = U_DC_UNBOUNDED_MIN;
+   dc->clip.right  = U_DC_UNBOUNDED_MAX;
+   dc->clip.bottom = U_DC_UNBOUNDED_MAX;
+}
+
+/* Default state of a device context, as set up by GDI. */
+static void dcstate_default(U_DC *dc){
+   memset(dc, 0, sizeof(U_DC));
+   dc->pen            = U_BLACK_PEN;
+   dc->brush          = U_WHITE_BRUSH;
+   dc->font           = U_SYSTEM_FONT;
+   dc->palette        = U_DEFAULT_PALETTE;
+   dc->mapMode        = U_MM_TEXT;
+   dc->bkMode         = U_OPAQUE;
+   dc->polyFillMode   = U_ALTERNATE;
+   dc->rop2           = U_R2_COPYPEN;
+   dc->stretchMode    = U_BLACKONWHITE;
+   dc->textAlign      = U_TA_DEFAULT;
+   dc->arcDirection   = U_AD_COUNTERCLOCKWISE;
+   dc->miterLimit     = 10;
+   dc->textColor      = colorref_set(0, 0, 0);
+   dc->bkColor        = colorref_set(255, 255, 255);
+   dc->windowExt      = sizel_set(1, 1);
+   dc->viewportExt    = sizel_set(1, 1);
+   dc->worldTransform = xform_set(1.0, 0.0, 0.0, 1.0, 0.0, 0.0);
+   dcstate_noclip(dc);
+}
+
+/* Page transform scale, device units per logical unit, for the map mode. */
+static void dcstate_page_scale(const U_DC_STATE *ds, const U_DC *dc, double *sx, double *sy){
+   double mm;
+   switch(dc->mapMode){
+      case U_MM_LOMETRIC:  mm = 0.1;          break;
+      case U_MM_HIMETRIC:  mm = 0.01;         break;
+      case U_MM_LOENGLISH: mm = 0.254;        break;
+      case U_MM_HIENGLISH: mm = 0.0254;       break;
+      case U_MM_TWIPS:     mm = 25.4/1440.0;  break;
+      case U_MM_ISOTROPIC:
+      case U_MM_ANISOTROPIC:
+         *sx = (dc->windowExt.cx ? (double) dc->viewportExt.cx / (double) dc->windowExt.cx : 1.0);
+         *sy = (dc->windowExt.cy ? (double) dc->viewportExt.cy / (double) dc->windowExt.cy : 1.0);
+         if(dc->mapMode == U_MM_ISOTROPIC){  // same scale on both axes, the smaller one, keeping the directions
+            mm  = (fabs(*sx) < fabs(*sy) ? fabs(*sx) : fabs(*sy));
+            *sx = (*sx < 0 ? -mm : mm);
+            *sy = (*sy < 0 ? -mm : mm);
+         }
+         return;
+      default:             *sx = *sy = 1.0;   return;   // U_MM_TEXT
+   }
+   *sx =  mm * ds->pxPerMmX;
+   *sy = -mm * ds->pxPerMmY;  // metric and english modes have y increasing upward
+}
+
+static int32_t dcstate_clamp(double v){
+   if(v <= (double) INT32_MIN)return(INT32_MIN);
+   if(v >= (double) INT32_MAX)return(INT32_MAX);
+   return((int32_t) v);
+}
+
+/* Device bounds of a logical rectangle.  Sets *exact to 1 if the transformed rectangle is still axis aligned. */
+static U_RECTL dcstate_device_rect(const U_DC_STATE *ds, U_RECTL r, int *exact){
+   U_XFORM xf;
+   U_RECTL out;
+   double  x[4], y[4], l, t, rt, b;
+   int     i;
+
+   (void) emf_dcstate_xform(ds, &xf);
+   x[0] = x[3] = r.left;  x[1] = x[2] = r.right;
+   y[0] = y[1] = r.top;   y[2] = y[3] = r.bottom;
+   l = t = HUGE_VAL;
+   rt = b = -HUGE_VAL;
+   for(i = 0; i < 4; i++){
+      double dx = x[i] * xf.eM11 + y[i] * xf.eM21 + xf.eDx;
+      double dy = x[i] * xf.eM12 + y[i] * xf.eM22 + xf.eDy;
+      if(dx < l)l = dx;
+      if(dx > rt)rt = dx;
+      if(dy < t)t = dy;
+      if(dy > b)b = dy;
+   }
+   out.left   = dcstate_clamp(floor(l));
+   out.top    = dcstate_clamp(floor(t));
+   out.right  = dcstate_clamp(ceil(rt));
+   out.bottom = dcstate_clamp(ceil(b));
+   *exact = (xf.eM12 == 0.0 && xf.eM21 == 0.0);
+   return(out);
+}
+
+/* Combine the clip with a new region having bounds b, for a RegionMode.  exact is 1 if the new region is exactly b. */
+static void dcstate_clip(U_DC *dc, uint32_t iMode, U_RECTL b, int exact){
+   static const U_RECTL all = { U_DC_UNBOUNDED_MIN, U_DC_UNBOUNDED_MIN, U_DC_UNBOUNDED_MAX, U_DC_UNBOUNDED_MAX };
+   U_RECTL old = (dc->clipSet ? dc->clip : all);
+   int     oldexact = (dc->clipSet ? dc->clipExact : 1);
+
+   switch(iMode){
+      case U_RGN_AND:
+         dc->clip.left   = (old.left   > b.left   ? old.left   : b.left);
+         dc->clip.top    = (old.top    > b.top    ? old.top    : b.top);
+         dc->clip.right  = (old.right  < b.right  ? old.right  : b.right);
+         dc->clip.bottom = (old.bottom < b.bottom ? old.bottom : b.bottom);
+         if(dc->clip.right  < dc->clip.left)dc->clip.right  = dc->clip.left;   // empty
+         if(dc->clip.bottom < dc->clip.top )dc->clip.bottom = dc->clip.top;
+         dc->clipExact = oldexact && exact;
+         break;
+      case U_RGN_OR:
+      case U_RGN_XOR:
+         dc->clip.left   = (old.left   < b.left   ? old.left   : b.left);
+         dc->clip.top    = (old.top    < b.top    ? old.top    : b.top);
+         dc->clip.right  = (old.right  > b.right  ? old.right  : b.right);
+         dc->clip.bottom = (old.bottom > b.bottom ? old.bottom : b.bottom);
+         dc->clipExact = 0;
+         break;
+      case U_RGN_DIFF:
+         dc->clip      = old;
+         dc->clipExact = 0;
+         break;
+      default:  // U_RGN_COPY
+         dc->clip      = b;
+         dc->clipExact = exact;
+         break;
+   }
+   dc->clipSet = 1;
+}
+
+/* Set the current position to the last of count points, which are U_POINTL or, if p16, U_POINT16 */
+static void dcstate_last_point(U_DC *dc, const char *points, uint32_t count, int p16){
+   U_POINT16 pt16;
+   if(!count)return;
+   if(p16){
+      memcpy(&pt16, points + (count - 1) * sizeof(U_POINT16), sizeof(U_POINT16));
+      dc->cur = point32_set(pt16.x, pt16.y);
+   }
+   else {
+      memcpy(&dc->cur, points + (count - 1) * sizeof(U_POINTL), sizeof(U_POINTL));
+   }
+}
+
+/* Select object ih, defined by the record which created it, or by nothing for a stock object. */
+static int dcstate_select(U_DC_STATE *ds, uint32_t ih){
+   U_DC             *dc = &ds->dc[ds->level];
+   const U_OBJENTRY *obj;
+   uint32_t          idx;
+
+   if(ih & U_STOCK_OBJECT){
+      idx = ih & ~U_STOCK_OBJECT;
+      if(     idx <= (U_NULL_BRUSH & ~U_STOCK_OBJECT)){ dc->brush   = ih; dc->brushRecord   = NULL; }
+      else if(idx <= (U_NULL_PEN   & ~U_STOCK_OBJECT)){ dc->pen     = ih; dc->penRecord     = NULL; }
+      else if(ih == U_DEFAULT_PALETTE)               { dc->palette = ih; dc->paletteRecord = NULL; }
+      else if(ih >= U_OEM_FIXED_FONT && ih <= U_STOCK_LAST){ dc->font = ih; dc->fontRecord = NULL; }
+      return(0);   // other stock objects are not tracked
+   }
+   obj = U_objtable_get(ds->objects, ih);
+   if(!obj)return(1);  // not defined, or already deleted
+   switch(obj->type){
+      case U_EMR_CREATEPEN:
+      case U_EMR_EXTCREATEPEN:
+         dc->pen     = ih;  dc->penRecord     = obj->record;  break;
+      case U_EMR_CREATEBRUSHINDIRECT:
+      case U_EMR_CREATEMONOBRUSH:
+      case U_EMR_CREATEDIBPATTERNBRUSHPT:
+         dc->brush   = ih;  dc->brushRecord   = obj->record;  break;
+      case U_EMR_EXTCREATEFONTINDIRECTW:
+         dc->font    = ih;  dc->fontRecord    = obj->record;  break;
+      case U_EMR_CREATEPALETTE:
+         dc->palette = ih;  dc->paletteRecord = obj->record;  break;
+      default:
+         break;
+   }
+   return(0);
 }
+//! \endcond
 
 /**
-    \brief Construct a U_RGNDATAHEADER structure.
-    \return U_RGNDATAHEADER structure
-    \param nCount  Number of rectangles in region
-    \param rclBounds Region bounds
-*/
-U_RGNDATAHEADER rgndataheader_set(
-      U_NUM_RECTL         nCount,
-      U_RECTL             rclBounds
-   ){
-   U_RGNDATAHEADER rdh;
-   rdh.dwSize    = U_RDH_OBJSIZE;  
-   rdh.iType     = U_RDH_RECTANGLES;   
-   rdh.nCount    = nCount;  
-   rdh.nRgnSize  = nCount * sizeof(U_RECTL); // Size in bytes of rectangle array
-   rdh.rclBounds = rclBounds; 
-   return(rdh);
+    \brief Create a device context state, for tracking the state while reading an EMF file.  See emf_dcstate_record().
+    \return 0 for success, >=1 for failure.
+    \param ds device context state
+*/
+int emf_dcstate_create(
+      U_DC_STATE **ds
+   ){
+   U_DC_STATE *dsl;
+   if(!ds)return(1);
+   dsl = (U_DC_STATE *) calloc(1, sizeof(U_DC_STATE));
+   if(!dsl)return(2);
+   dsl->allocated = 8;
+   dsl->dc        = (U_DC *) malloc(dsl->allocated * sizeof(U_DC));
+   if(!dsl->dc || U_objtable_create(64, &dsl->objects)){
+      free(dsl->dc);
+      free(dsl);
+      return(3);
+   }
+   dcstate_default(&dsl->dc[0]);
+   dsl->pxPerMmX = 1.0;
+   dsl->pxPerMmY = 1.0;
+   *ds = dsl;
+   return(0);
 }
 
 /**
-    \brief Allocate and construct a U_RGNDATA structure.
-    \return pointer to U_RGNDATA structure, or NULL on error.
-    \param rdh    Data description
-    \param Buffer Array of U_RECTL elements
-*/
-PU_RGNDATA rgndata_set(
-      U_RGNDATAHEADER     rdh,
-      PU_RECTL            Buffer
-   ){
-   char *record;
-   int irecsize;
-   int szRgnArray,off;
-   
-   if(!Buffer || !rdh.nCount || !rdh.nRgnSize)return(NULL);
-   szRgnArray = rdh.nRgnSize;             // size of the U_RECTL array
-   irecsize = sizeof(U_RGNDATA) + szRgnArray - sizeof(U_RECTL);  // core + array - overlap
-   record    = malloc(irecsize);
-   if(record){
-      memcpy(record, &rdh, sizeof(U_RGNDATAHEADER));
-      off =  sizeof(U_RGNDATAHEADER);
-      memcpy(record + off, Buffer, szRgnArray);   
+    \brief Update a device context state for one EMF record.
+    
+    Call this for each record, in order, while reading an EMF file, and look at ds->dc[ds->level] for the state
+    in effect for the next record.  The records which create, select, and delete objects, SAVEDC and RESTOREDC,
+    the SET* records for modes, colors, window and viewport, the world transform records, the clip records,
+    and the records which move the current position are tracked, others are ignored.  Pointers to records
+    are kept, so the EMF must stay in memory while the state is used.
+    
+    The clip is tracked as its bounding rectangle in device units, with clipExact set when the clip is exactly
+    that rectangle (intersections of rectangles, as long as the world transform does not rotate or shear). 
+    Clips which come from a path are not bounded by the path, only by the clip they were combined with.
+    
+    The record should have been checked with U_emf_record_safe() first.
+    \return 0 for success, >=1 for failure.  On failure the record is ignored, except as noted:
+        1 bad arguments, 2 U_EMR_RESTOREDC to a level which was not saved, 3 selection of an object
+        which does not exist, 4 object table error, 5 memory could not be allocated.
+    \param ds     device context state
+    \param record EMF record
+    \param offset offset of the record in the file
+*/
+int emf_dcstate_record(
+      U_DC_STATE  *ds,
+      const char  *record,
+      uint32_t     offset
+   ){
+   PU_ENHMETARECORD  pEmr = (PU_ENHMETARECORD) record;
+   U_DC             *dc;
+   U_DC             *dcs;
+   U_XFORM           xf, w;
+   U_RECTL           b;
+   U_PAIRF           center, start, end, size;
+   double            dx, dy, angle;
+   int               exact, f1;
+   int32_t           iRelative;
+
+   if(!ds || !record)return(1);
+   dc = &ds->dc[ds->level];
+   switch(pEmr->iType){
+      case U_EMR_HEADER:
+         {
+            PU_EMRHEADER pHdr = (PU_EMRHEADER) record;
+            if(pHdr->szlDevice.cx > 0 && pHdr->szlMillimeters.cx > 0){
+               ds->pxPerMmX = (U_FLOAT) pHdr->szlDevice.cx / (U_FLOAT) pHdr->szlMillimeters.cx;
+            }
+            if(pHdr->szlDevice.cy > 0 && pHdr->szlMillimeters.cy > 0){
+               ds->pxPerMmY = (U_FLOAT) pHdr->szlDevice.cy / (U_FLOAT) pHdr->szlMillimeters.cy;
+            }
+         }
+         break;
+      case U_EMR_SAVEDC:
+         if(ds->level + 1 >= ds->allocated){
+            dcs = (U_DC *) realloc(ds->dc, 2 * ds->allocated * sizeof(U_DC));
+            if(!dcs)return(5);
+            ds->dc         = dcs;
+            ds->allocated *= 2;
+         }
+         ds->dc[ds->level + 1] = ds->dc[ds->level];
+         ds->level++;
+         break;
+      case U_EMR_RESTOREDC:
+         iRelative = ((PU_EMRRESTOREDC) record)->iRelative;
+         if(iRelative >= 0 || ds->level + iRelative < 0)return(2);
+         ds->level += iRelative;
+         break;
+      case U_EMR_SELECTOBJECT:
+         if(dcstate_select(ds, ((PU_EMRSELECTOBJECT) record)->ihObject))return(3);
+         break;
+      case U_EMR_SELECTPALETTE:
+         if(dcstate_select(ds, ((PU_EMRSELECTPALETTE) record)->ihPal))return(3);
+         break;
+      case U_EMR_CREATEPEN:
+      case U_EMR_CREATEBRUSHINDIRECT:
+      case U_EMR_CREATEPALETTE:
+      case U_EMR_EXTCREATEFONTINDIRECTW:
+      case U_EMR_CREATEMONOBRUSH:
+      case U_EMR_CREATEDIBPATTERNBRUSHPT:
+      case U_EMR_EXTCREATEPEN:
+      case U_EMR_CREATECOLORSPACE:
+      case U_EMR_CREATECOLORSPACEW:
+      case U_EMR_DELETEOBJECT:
+         if(emf_objtable_record(ds->objects, record, offset))return(4);
+         break;
+      case U_EMR_SETMAPMODE:       dc->mapMode      = ((PU_EMRSETMAPMODE)       record)->iMode;          break;
+      case U_EMR_SETBKMODE:        dc->bkMode       = ((PU_EMRSETBKMODE)        record)->iMode;          break;
+      case U_EMR_SETPOLYFILLMODE:  dc->polyFillMode = ((PU_EMRSETPOLYFILLMODE)  record)->iMode;          break;
+      case U_EMR_SETROP2:          dc->rop2         = ((PU_EMRSETROP2)          record)->iMode;          break;
+      case U_EMR_SETSTRETCHBLTMODE:dc->stretchMode  = ((PU_EMRSETSTRETCHBLTMODE)record)->iMode;          break;
+      case U_EMR_SETTEXTALIGN:     dc->textAlign    = ((PU_EMRSETTEXTALIGN)     record)->iMode;          break;
+      case U_EMR_SETARCDIRECTION:  dc->arcDirection = ((PU_EMRSETARCDIRECTION)  record)->iArcDirection;  break;
+      case U_EMR_SETMITERLIMIT:    dc->miterLimit   = ((PU_EMRSETMITERLIMIT)    record)->eMiterLimit;    break;
+      case U_EMR_SETTEXTCOLOR:     dc->textColor    = ((PU_EMRSETTEXTCOLOR)     record)->crColor;        break;
+      case U_EMR_SETBKCOLOR:       dc->bkColor      = ((PU_EMRSETBKCOLOR)       record)->crColor;        break;
+      case U_EMR_SETWINDOWEXTEX:   dc->windowExt    = ((PU_EMRSETWINDOWEXTEX)   record)->szlExtent;      break;
+      case U_EMR_SETWINDOWORGEX:   dc->windowOrg    = ((PU_EMRSETWINDOWORGEX)   record)->ptlOrigin;      break;
+      case U_EMR_SETVIEWPORTEXTEX: dc->viewportExt  = ((PU_EMRSETVIEWPORTEXTEX) record)->szlExtent;      break;
+      case U_EMR_SETVIEWPORTORGEX: dc->viewportOrg  = ((PU_EMRSETVIEWPORTORGEX) record)->ptlOrigin;      break;
+      case U_EMR_SCALEVIEWPORTEXTEX:
+      case U_EMR_SCALEWINDOWEXTEX:
+         {
+            PU_EMRSCALEVIEWPORTEXTEX pScl = (PU_EMRSCALEVIEWPORTEXTEX) record;
+            U_SIZEL *ext = (pEmr->iType == U_EMR_SCALEVIEWPORTEXTEX ? &dc->viewportExt : &dc->windowExt);
+            if(!pScl->xDenom || !pScl->yDenom)return(1);
+            ext->cx = (int32_t)(((int64_t) ext->cx * pScl->xNum) / pScl->xDenom);
+            ext->cy = (int32_t)(((int64_t) ext->cy * pScl->yNum) / pScl->yDenom);
+         }
+         break;
+      case U_EMR_SETWORLDTRANSFORM:
+         dc->worldTransform = ((PU_EMRSETWORLDTRANSFORM) record)->xform;
+         break;
+      case U_EMR_MODIFYWORLDTRANSFORM:
+         xf = ((PU_EMRMODIFYWORLDTRANSFORM) record)->xform;
+         w  = dc->worldTransform;
+         switch(((PU_EMRMODIFYWORLDTRANSFORM) record)->iMode){
+            case U_MWT_IDENTITY:
+               dc->worldTransform = xform_set(1.0, 0.0, 0.0, 1.0, 0.0, 0.0);
+               break;
+            case U_MWT_LEFTMULTIPLY:   // xf is applied first
+               dc->worldTransform = xform_set(
+                  xf.eM11*w.eM11 + xf.eM12*w.eM21,          xf.eM11*w.eM12 + xf.eM12*w.eM22,
+                  xf.eM21*w.eM11 + xf.eM22*w.eM21,          xf.eM21*w.eM12 + xf.eM22*w.eM22,
+                  xf.eDx*w.eM11  + xf.eDy*w.eM21 + w.eDx,   xf.eDx*w.eM12  + xf.eDy*w.eM22 + w.eDy);
+               break;
+            case U_MWT_RIGHTMULTIPLY:  // xf is applied last
+               dc->worldTransform = xform_set(
+                  w.eM11*xf.eM11 + w.eM12*xf.eM21,          w.eM11*xf.eM12 + w.eM12*xf.eM22,
+                  w.eM21*xf.eM11 + w.eM22*xf.eM21,          w.eM21*xf.eM12 + w.eM22*xf.eM22,
+                  w.eDx*xf.eM11  + w.eDy*xf.eM21 + xf.eDx,  w.eDx*xf.eM12  + w.eDy*xf.eM22 + xf.eDy);
+               break;
+            default:                   // U_MWT_SET (4) is sometimes seen, it is not in the EMF standard
+               dc->worldTransform = xf;
+               break;
+         }
+         break;
+      case U_EMR_MOVETOEX:
+      case U_EMR_LINETO:
+         dc->cur = ((PU_EMRMOVETOEX) record)->ptl;
+         break;
+      case U_EMR_POLYBEZIERTO:
+      case U_EMR_POLYLINETO:
+      case U_EMR_POLYDRAW:
+         dcstate_last_point(dc, (const char *) ((PU_EMRPOLYLINETO) record)->aptl, ((PU_EMRPOLYLINETO) record)->cptl, 0);
+         break;
+      case U_EMR_POLYBEZIERTO16:
+      case U_EMR_POLYLINETO16:
+      case U_EMR_POLYDRAW16:
+         dcstate_last_point(dc, (const char *) ((PU_EMRPOLYLINETO16) record)->apts, ((PU_EMRPOLYLINETO16) record)->cpts, 1);
+         break;
+      case U_EMR_ARCTO:
+         if(emr_arc_points((PU_ENHMETARECORD) record, &f1, (dc->arcDirection == U_AD_COUNTERCLOCKWISE ? 1 : 0),
+               &center, &start, &end, &size))return(1);
+         dc->cur = point32_set((int32_t) U_ROUND(end.x), (int32_t) U_ROUND(end.y));
+         break;
+      case U_EMR_ANGLEARC:
+         {
+            PU_EMRANGLEARC pArc = (PU_EMRANGLEARC) record;
+            angle = (pArc->eStartAngle + pArc->eSweepAngle) * U_PI / 180.0;
+            dx = pArc->ptlCenter.x + (double) pArc->nRadius * cos(angle);
+            dy = pArc->ptlCenter.y - (double) pArc->nRadius * sin(angle);  // y increases downward in logical units
+            dc->cur = point32_set((int32_t) U_ROUND(dx), (int32_t) U_ROUND(dy));
+         }
+         break;
+      case U_EMR_BEGINPATH:
+         ds->inPath = 1;
+         break;
+      case U_EMR_ENDPATH:
+      case U_EMR_ABORTPATH:
+         ds->inPath = 0;
+         break;
+      case U_EMR_INTERSECTCLIPRECT:
+         b = dcstate_device_rect(ds, ((PU_EMRINTERSECTCLIPRECT) record)->rclClip, &exact);
+         dcstate_clip(dc, U_RGN_AND, b, exact);
+         break;
+      case U_EMR_EXCLUDECLIPRECT:
+         b = dcstate_device_rect(ds, ((PU_EMREXCLUDECLIPRECT) record)->rclClip, &exact);
+         dcstate_clip(dc, U_RGN_DIFF, b, exact);
+         break;
+      case U_EMR_SELECTCLIPPATH:   // the bounds of the path are not tracked
+         b.left  = b.top    = U_DC_UNBOUNDED_MIN;
+         b.right = b.bottom = U_DC_UNBOUNDED_MAX;
+         dcstate_clip(dc, ((PU_EMRSELECTCLIPPATH) record)->iMode, b, 0);
+         break;
+      case U_EMR_EXTSELECTCLIPRGN:
+         {
+            PU_EMREXTSELECTCLIPRGN pRgn = (PU_EMREXTSELECTCLIPRGN) record;
+            if(pRgn->cbRgnData < sizeof(U_RGNDATAHEADER)){  // no region, with U_RGN_COPY this removes the clip
+               if(pRgn->iMode == U_RGN_COPY)dcstate_noclip(dc);
+               break;
+            }
+            dcstate_clip(dc, pRgn->iMode, pRgn->RgnData[0].rdh.rclBounds, (pRgn->RgnData[0].rdh.nCount == 1));
+         }
+         break;
+      case U_EMR_OFFSETCLIPRGN:
+         if(dc->clipSet){
+            U_POINTL off = ((PU_EMROFFSETCLIPRGN) record)->ptlOffset;
+            (void) emf_dcstate_xform(ds, &xf);
+            dx = U_ROUND(off.x * xf.eM11 + off.y * xf.eM21);
+            dy = U_ROUND(off.x * xf.eM12 + off.y * xf.eM22);
+            if(dc->clip.left   != U_DC_UNBOUNDED_MIN)dc->clip.left   = dcstate_clamp(dc->clip.left   + dx);
+            if(dc->clip.right  != U_DC_UNBOUNDED_MAX)dc->clip.right  = dcstate_clamp(dc->clip.right  + dx);
+            if(dc->clip.top    != U_DC_UNBOUNDED_MIN)dc->clip.top    = dcstate_clamp(dc->clip.top    + dy);
+            if(dc->clip.bottom != U_DC_UNBOUNDED_MAX)dc->clip.bottom = dcstate_clamp(dc->clip.bottom + dy);
+         }
+         break;
+      default:
+         break;
    }
-   return((PU_RGNDATA) record);
+   return(0);
 }
 
 /**
-    \brief Construct a U_COLORADJUSTMENT structure.
-    \return U_COLORADJUSTMENT structure
-    \param Size            Size of this structure in bytes                                      
-    \param Flags           ColorAdjustment Enumeration                                          
-    \param IlluminantIndex Illuminant Enumeration                                               
-    \param RedGamma        Red   Gamma correction (range:2500:65000, 10000 is no correction)    
-    \param GreenGamma      Green Gamma correction (range:2500:65000, 10000 is no correction)    
-    \param BlueGamma       Blue  Gamma correction (range:2500:65000, 10000 is no correction)    
-    \param ReferenceBlack  Values less than this are black (range:0:4000)                       
-    \param ReferenceWhite  Values more than this are white (range:6000:10000)                   
-    \param Contrast        Contrast     adjustment (range:-100:100, 0 is no correction)         
-    \param Brightness      Brightness   adjustment (range:-100:100, 0 is no correction)         
-    \param Colorfulness    Colorfulness adjustment (range:-100:100, 0 is no correction)         
-    \param RedGreenTint    Tine         adjustment (range:-100:100, 0 is no correction)         
+    \brief Get the transform from logical units to device units for the current state, the world transform followed
+    by the page transform set by the map mode, window, and viewport.  A point (x,y) maps to
+    (x*eM11 + y*eM21 + eDx, x*eM12 + y*eM22 + eDy).
+    \return 0 for success, >=1 for failure.
+    \param ds device context state
+    \param xf transform
+*/
+int emf_dcstate_xform(
+      const U_DC_STATE  *ds,
+      U_XFORM           *xf
+   ){
+   const U_DC *dc;
+   double      sx, sy;
+   if(!ds || !xf)return(1);
+   dc = &ds->dc[ds->level];
+   dcstate_page_scale(ds, dc, &sx, &sy);
+   xf->eM11 = dc->worldTransform.eM11 * sx;
+   xf->eM21 = dc->worldTransform.eM21 * sx;
+   xf->eDx  = (dc->worldTransform.eDx - dc->windowOrg.x) * sx + dc->viewportOrg.x;
+   xf->eM12 = dc->worldTransform.eM12 * sy;
+   xf->eM22 = dc->worldTransform.eM22 * sy;
+   xf->eDy  = (dc->worldTransform.eDy - dc->windowOrg.y) * sy + dc->viewportOrg.y;
+   return(0);
+}
+
+/**
+    \brief Free all memory in a device context state.  Sets the pointer to NULL.
+    \return 0 for success, >=1 for failure.
+    \param ds device context state
 */
-U_COLORADJUSTMENT coloradjustment_set(
-      uint16_t            Size,
-      uint16_t            Flags,
-      uint16_t            IlluminantIndex,
-      uint16_t            RedGamma,
-      uint16_t            GreenGamma,
-      uint16_t            BlueGamma,
-      uint16_t            ReferenceBlack,
-      uint16_t            ReferenceWhite,
-      int16_t             Contrast,
-      int16_t             Brightness,
-      int16_t             Colorfulness,
-      int16_t             RedGreenTint
+int emf_dcstate_free(
+      U_DC_STATE **ds
    ){
-   U_COLORADJUSTMENT ca;
-   ca.caSize            = Size;                     
-   ca.caFlags           = Flags;          
-   ca.caIlluminantIndex = IlluminantIndex;
-   ca.caRedGamma        = U_MNMX(RedGamma,       U_RGB_GAMMA_MIN,       U_RGB_GAMMA_MAX);
-   ca.caGreenGamma      = U_MNMX(GreenGamma,     U_RGB_GAMMA_MIN,       U_RGB_GAMMA_MAX);
-   ca.caBlueGamma       = U_MNMX(BlueGamma,      U_RGB_GAMMA_MIN,       U_RGB_GAMMA_MAX);
-   // Next one is different to eliminate compiler warning -  U_R_B_MIN is 0 and unsigned
-   ca.caReferenceBlack  = U_MAX( ReferenceBlack, U_REFERENCE_BLACK_MAX);
-   ca.caReferenceWhite  = U_MNMX(ReferenceWhite, U_REFERENCE_WHITE_MIN, U_REFERENCE_WHITE_MAX); 
-   ca.caContrast        = U_MNMX(Contrast,       U_COLOR_ADJ_MIN,       U_COLOR_ADJ_MAX); 
-   ca.caBrightness      = U_MNMX(Brightness,     U_COLOR_ADJ_MIN,       U_COLOR_ADJ_MAX); 
-   ca.caColorfulness    = U_MNMX(Colorfulness,   U_COLOR_ADJ_MIN,       U_COLOR_ADJ_MAX); 
-   ca.caRedGreenTint    = U_MNMX(RedGreenTint,   U_COLOR_ADJ_MIN,       U_COLOR_ADJ_MAX);
-   return(ca);
+   if(!ds || !*ds)return(1);
+   (void) U_objtable_free(&(*ds)->objects);
+   free((*ds)->dc);
+   free(*ds);
+   *ds = NULL;
+   return(0);
 }
 
+/* **********************************************************************************************
+These functions create standard structures used in the EMR records.
+*********************************************************************************************** */
+
+
 /**
-    \brief Construct a U_PIXELFORMATDESCRIPTOR structure.
-    \return U_PIXELFORMATDESCRIPTOR structure
-    \param dwFlags         PFD_dwFlags Enumeration
-    \param iPixelType      PFD_iPixelType Enumeration
-    \param cColorBits      RGBA: total bits per pixel
-    \param cRedBits        Red   bits per pixel
-    \param cRedShift       Red   shift to data bits
-    \param cGreenBits      Green bits per pixel
-    \param cGreenShift     Green shift to data bits
-    \param cBlueBits       Blue  bits per pixel
-    \param cBlueShift      Blue  shift to data bits
-    \param cAlphaBits      Alpha bits per pixel
-    \param cAlphaShift     Alpha shift to data bits
-    \param cAccumBits      Accumulator buffer, total bitplanes
-    \param cAccumRedBits   Red   accumulator buffer bitplanes
-    \param cAccumGreenBits Green accumulator buffer bitplanes
-    \param cAccumBlueBits  Blue  accumulator buffer bitplanes
-    \param cAccumAlphaBits Alpha accumulator buffer bitplanes
-    \param cDepthBits      Depth of Z-buffer
-    \param cStencilBits    Depth of stencil buffer
-    \param cAuxBuffers     Depth of auxilliary buffers (not supported)
-    \param iLayerType      PFD_iLayerType Enumeration, may be ignored
-    \param bReserved       Bits 0:3/4:7 are number of Overlay/Underlay planes 
-    \param dwLayerMask     may be ignored
-    \param dwVisibleMask   color or index of underlay plane
-    \param dwDamageMask    may be ignored
+    \brief Set up fields for an EMR_HEADER from the physical device's width and height in mm and dots per millimeter.
+    Typically this is something like 216,279,47.244 (Letter paper, 1200 DPI = 47.244 DPmm)
+    \return 0 for success, >=1 for failure.
+    \param xmm     Device  width in millimeters
+    \param ymm     Device height in millimeters
+    \param dpmm    Dots per millimeter
+    \param szlDev  Device size structure in pixels
+    \param szlMm   Device size structure in mm
 */
-U_PIXELFORMATDESCRIPTOR pixelformatdescriptor_set(
-      uint32_t   dwFlags,
-      uint8_t    iPixelType,
-      uint8_t    cColorBits,
-      uint8_t    cRedBits,
-      uint8_t    cRedShift,
-      uint8_t    cGreenBits,
-      uint8_t    cGreenShift,
-      uint8_t    cBlueBits,
-      uint8_t    cBlueShift,
-      uint8_t    cAlphaBits,
-      uint8_t    cAlphaShift,
-      uint8_t    cAccumBits,
-      uint8_t    cAccumRedBits,
-      uint8_t    cAccumGreenBits,
-      uint8_t    cAccumBlueBits,
-      uint8_t    cAccumAlphaBits,
-      uint8_t    cDepthBits,
-      uint8_t    cStencilBits,
-      uint8_t    cAuxBuffers,
-      uint8_t    iLayerType,
-      uint8_t    bReserved,
-      uint32_t   dwLayerMask,
-      uint32_t   dwVisibleMask,
-      uint32_t   dwDamageMask
+int device_size(
+      const int    xmm,
+      const int    ymm,
+      const float  dpmm,
+      U_SIZEL     *szlDev,
+      U_SIZEL     *szlMm
    ){
-   U_PIXELFORMATDESCRIPTOR pfd;
-   pfd.nSize           = sizeof(U_PIXELFORMATDESCRIPTOR);                  
-   pfd.nVersion        = 1;        
-   pfd.dwFlags         = dwFlags;         
-   pfd.iPixelType      = iPixelType;      
-   pfd.cColorBits      = cColorBits;      
-   pfd.cRedBits        = cRedBits;        
-   pfd.cRedShift       = cRedShift;       
-   pfd.cGreenBits      = cGreenBits;      
-   pfd.cGreenShift     = cGreenShift;     
-   pfd.cBlueBits       = cBlueBits;       
-   pfd.cBlueShift      = cBlueShift;      
-   pfd.cAlphaBits      = cAlphaBits;      
-   pfd.cAlphaShift     = cAlphaShift;     
-   pfd.cAccumBits      = cAccumBits;      
-   pfd.cAccumRedBits   = cAccumRedBits;   
-   pfd.cAccumGreenBits = cAccumGreenBits; 
-   pfd.cAccumBlueBits  = cAccumBlueBits;  
-   pfd.cAccumAlphaBits = cAccumAlphaBits; 
-   pfd.cDepthBits      = cDepthBits;      
-   pfd.cStencilBits    = cStencilBits;    
-   pfd.cAuxBuffers     = cAuxBuffers;     
-   pfd.iLayerType      = iLayerType;      
-   pfd.bReserved       = bReserved;       
-   pfd.dwLayerMask     = dwLayerMask;     
-   pfd.dwVisibleMask   = dwVisibleMask;   
-   pfd.dwDamageMask    = dwDamageMask;
-   return(pfd);    
+   if(xmm < 0 || ymm < 0 || dpmm < 0)return(1);
+   szlDev->cx          =  U_ROUND((float) xmm * dpmm);
+   szlDev->cy          =  U_ROUND((float) ymm * dpmm);;
+   szlMm->cx           =  xmm;
+   szlMm->cy           =  ymm;
+   return(0);
 }
 
 /**
-    \brief Allocate and create a U_EMRTEXT structure followed by its variable pieces via a char* pointer.
-    Dx cannot be NULL, if the calling program has no appropriate values call dx_set() first. 
-    \return char* pointer to U_EMRTEXT structure followed by its variable pieces, or NULL on error
-    \param ptlReference String start coordinates
-    \param NumString    Number of characters in string, does NOT include a terminator
-    \param cbChar       Number of bytes per character
-    \param String       String to write
-    \param fOptions     ExtTextOutOptions Enumeration
-    \param rcl          (Optional, when fOptions & 7) grayed/clipping/opaque rectangle
-    \param Dx           Character spacing array from the start of the RECORD   
+    \brief Set up fields for an EMR_HEADER for drawing by physical size in mm and dots per millimeter.
+    Technically rclBounds is supposed to be the extent of the drawing within the EMF, but libUEMF has no way
+    of knowing this since it never actually draws anything.  Instead this is set to the full drawing size.
+    Coordinates are inclusive inclusive, so 297 -> 0,29699.
+    \return 0 for success, >=1 for failure.
+    \param xmm        Drawing  width in millimeters
+    \param ymm        Drawing height in millimeters
+    \param dpmm       Dots per millimeter
+    \param rclBounds  Drawing size structure in pixels
+    \param rclFrame   Drawing size structure in mm
 */
-char *emrtext_set(
-      U_POINTL         ptlReference,
-      U_NUM_STR        NumString,
-      uint32_t         cbChar,
-      void            *String,
-      uint32_t         fOptions,
-      U_RECTL          rcl,
-      uint32_t        *Dx
+int drawing_size(
+      const int    xmm,
+      const int    ymm,
+      const float  dpmm,
+      U_RECTL     *rclBounds,
+      U_RECTL     *rclFrame
+   ){
+   if(xmm < 0 || ymm < 0 || dpmm < 0)return(1);
+   rclBounds->left     =  0;
+   rclBounds->top      =  0;
+   rclBounds->right    =  U_ROUND((float) xmm  * dpmm) - 1;  // because coordinate system is 0,0 in upper left, N,M in lower right
+   rclBounds->bottom   =  U_ROUND((float) ymm  * dpmm) - 1;
+   rclFrame->left      =  0;       
+   rclFrame->top       =  0; 
+   rclFrame->right     =  U_ROUND((float) xmm * 100.) - 1; 
+   rclFrame->bottom    =  U_ROUND((float) ymm * 100.) - 1;         
+   return(0);
+}
+
+/** 
+    \brief Set a U_COLORREF value from separate R,G,B values.
+    \param red    Red   component
+    \param green  Green component
+    \param blue   Blue  component
+    
+*/
+U_COLORREF colorref3_set(
+      uint8_t red,
+      uint8_t green,
+      uint8_t blue
+   ){
+   U_COLORREF cr = (U_COLORREF){red , green, blue, 0};
+   return(cr);
+}
+
+/** 
+    \brief Set a U_COLORREF value from separate R,G,B, and Reserved values.
+    \param red        Red      component
+    \param green      Green    component
+    \param blue       Blue     component
+    \param Reserved   Reserved component
+    
+*/
+U_COLORREF colorref4_set(
+      uint8_t red,
+      uint8_t green,
+      uint8_t blue,
+      uint8_t Reserved
+   ){
+   U_COLORREF cr = (U_COLORREF){red , green, blue, Reserved};
+   return(cr);
+}
+
+/** 
+    \brief Set a U_RGBQUAD value from separate R,G,B, Reserved values.
+    \param red       Red      component
+    \param green     Green    component
+    \param blue      Blue     component
+    \param reserved  Reserved component
+    
+*/
+U_RGBQUAD rgbquad_set(
+      uint8_t red,
+      uint8_t green,
+      uint8_t blue,
+      uint8_t reserved
+   ){
+   U_RGBQUAD cr = (U_RGBQUAD){blue , green, red, reserved};
+   return(cr);
+}
+
+/**
+    \brief Set rect and rectl objects from Upper Left and Lower Right corner points.
+    \param ul upper left corner of rectangle
+    \param lr lower right corner of rectangle
+*/
+U_RECTL rectl_set(
+      U_POINTL ul,
+      U_POINTL lr
     ){
-    int   irecsize,cbDxArray,cbString4,cbString,off;
-    char *record;
-    uint32_t *loffDx;
+    U_RECTL rct;
+    rct.left     =   ul.x;
+    rct.top      =   ul.y;
+    rct.right    =   lr.x;
+    rct.bottom   =   lr.y;
+    return(rct);
+}
+
+/**
+    \brief Set rect and rectl objects from Upper Left and Lower Right corner points.
+    \param array array of rectangles
+    \param index  array entry to fill, numbered from 0
+    \param ul upper left corner of rectangle
+    \param lr lower right corner of rectangle
+*/
+void rectli_set(
+      PU_RECTL array,
+      int index,
+      U_POINTL ul,
+      U_POINTL lr
+    ){
+    PU_RECTL rct = &(array[index]);
+    rct->left     =   ul.x;
+    rct->top      =   ul.y;
+    rct->right    =   lr.x;
+    rct->bottom   =   lr.y;
+}
+
+/**
+    \brief Set sizel objects with X,Y values.
+    \param x X coordinate 
+    \param y Y coordinate
+*/
+U_SIZEL sizel_set(
+       int32_t  x,
+       int32_t  y
+    ){
+    U_SIZEL sz;
+    sz.cx = x;
+    sz.cy = y;
+    return(sz);
+} 
+
+/**
+    \brief Set pointl objects with X,Y values.
+    \param x X coordinate 
+    \param y Y coordinate
+*/
+U_POINTL point32_set(
+       int32_t  x,   
+       int32_t  y
+    ){
+    U_POINTL pt;
+    pt.x = x;
+    pt.y = y;
+    return(pt);
+} 
+
+/**
+    \brief Set point16 objects with 16 bit X,Y values.
+    \param x X coordinate 
+    \param y Y coordinate
+*/
+U_POINT16 point16_set(
+       int16_t  x,
+       int16_t  y
+    ){
+    U_POINT16 pt;
+    pt.x = x;
+    pt.y = y;
+    return(pt);
+} 
+
+/**
+    \brief Find the bounding rectangle from a polyline of a given width.
+    \param count  number of points in the polyline
+    \param pts    the polyline
+    \param width  width of drawn line
     
-    if(!String)return(NULL);
-    if(!Dx)return(NULL);
-    cbString = cbChar * NumString;                   // size of the string in bytes
-    cbString4 = UP4(cbString);                       // size of the string buffer
-    cbDxArray = sizeof(uint32_t)*NumString;          // size of Dx array storage
-    if(fOptions & U_ETO_PDY)cbDxArray += cbDxArray;  // of the Dx buffer, here do both X and Y coordinates
-    irecsize = sizeof(U_EMRTEXT) + sizeof(uint32_t) + cbString4 + cbDxArray;    // core structure  + offDx + string buf + dx buf
-    if(!(fOptions & U_ETO_NO_RECT)){ irecsize += sizeof(U_RECTL); } // plus variable U_RECTL, when it is present
-    record   = malloc(irecsize);
-    if(record){
-      ((PU_EMRTEXT)record)->ptlReference    = ptlReference;
-      ((PU_EMRTEXT)record)->nChars          = NumString;
-      // pick up ((PU_EMRTEXT)record)->offString later
-      ((PU_EMRTEXT)record)->fOptions        = fOptions;
-      off = sizeof(U_EMRTEXT);              // location where variable pieces will start to be written                
-      if(!(fOptions & U_ETO_NO_RECT)){      // variable field, may or may not be present 
-         memcpy(record + off,&rcl, sizeof(U_RECTL));
-         off += sizeof(U_RECTL);
+*/
+U_RECT findbounds(
+      uint32_t count,
+      PU_POINT pts,
+      uint32_t width
+   ){
+   U_RECT rect={INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN };
+   unsigned int i;
+
+   for(i=0; i<count;i++,pts++){
+       if ( pts->x < rect.left )   rect.left   = pts->x;
+       if ( pts->x > rect.right )  rect.right  = pts->x;
+       if ( pts->y < rect.top )    rect.top    = pts->y;
+       if ( pts->y > rect.bottom ) rect.bottom = pts->y;
+   }
+   if(width > 0){
+     rect.left   -= width;
+     rect.right  += width;
+     rect.top    += width;
+     rect.bottom -= width;
+   }
+   return(rect);
+}
+
+/**
+    \brief Find the bounding rectangle from a polyline of a given width.
+    \param count  number of points in the polyline
+    \param pts    the polyline
+    \param width  width of drawn line
+    
+*/
+U_RECT findbounds16(
+      uint32_t count,
+      PU_POINT16 pts,
+      uint32_t width
+   ){
+   U_RECT rect={INT16_MAX, INT16_MAX, INT16_MIN, INT16_MIN };
+   unsigned int i;
+
+   for(i=0; i<count;i++,pts++){
+       if ( pts->x < rect.left )   rect.left   = pts->x;
+       if ( pts->x > rect.right )  rect.right  = pts->x;
+       if ( pts->y < rect.top )    rect.top    = pts->y;
+       if ( pts->y > rect.bottom ) rect.bottom = pts->y;
+   }
+   if(width > 0){
+     rect.left   -= width;
+     rect.right  += width;
+     rect.top    += width;
+     rect.bottom -= width;
+   }
+   return(rect);
+}
+/**
+    \brief Construct a U_LOGBRUSH structure.
+    \return U_LOGBRUSH structure
+    \param lbStyle   LB_Style Enumeration
+    \param lbColor   Brush color
+    \param lbHatch   HatchStyle Enumertaion
+*/
+U_LOGBRUSH logbrush_set(
+      uint32_t    lbStyle,
+      U_COLORREF  lbColor,
+      int32_t     lbHatch
+   ){
+   U_LOGBRUSH lb;
+   lb.lbStyle = lbStyle;
+   lb.lbColor = lbColor;
+   lb.lbHatch = lbHatch;
+   return(lb);
+}
+
+/**
+    \brief Construct a U_XFORM structure.
+    \return U_XFORM structure
+    \param eM11 Rotation Matrix element
+    \param eM12 Rotation Matrix element
+    \param eM21 Rotation Matrix element
+    \param eM22 Rotation Matrix element
+    \param eDx  Translation element 
+    \param eDy  Translation element 
+*/
+U_XFORM xform_set(
+      U_FLOAT eM11,
+      U_FLOAT eM12,
+      U_FLOAT eM21,
+      U_FLOAT eM22,
+      U_FLOAT eDx,
+      U_FLOAT eDy
+   ){
+   U_XFORM xform;
+   xform.eM11 =  eM11;
+   xform.eM12 =  eM12;
+   xform.eM21 =  eM21;
+   xform.eM22 =  eM22;
+   xform.eDx  =  eDx;
+   xform.eDy  =  eDy;
+   return(xform);
+}
+
+/**
+    \brief Construct a U_XFORM structure.
+    \return U_XFORM structure
+    \param scale     Scale factor
+    \param ratio     Ratio of minor axis/major axis
+    \param rot       Rotation angle in degrees, positive is counter clockwise from the x axis.
+    \param axisrot   Angle in degrees defining the major axis before rotation, positive is counter clockwise from the x axis.
+    \param eDx       Translation element 
+    \param eDy       Translation element 
+    
+    Operation is:
+      1  Conformal map of points based on scale, axis rotation, and axis ratio,
+      2. Apply rotation
+      3. Apply offset
+*/
+U_XFORM xform_alt_set(
+      U_FLOAT scale,
+      U_FLOAT ratio,
+      U_FLOAT rot,
+      U_FLOAT axisrot,
+      U_FLOAT eDx,
+      U_FLOAT eDy
+   ){
+   U_XFORM xform;
+   U_MAT2X2 mat1, mat2;
+   // angles are in degrees, must be in radians
+   rot     *=  (2.0 * U_PI)/360.0;
+   axisrot *= -(2.0 * U_PI)/360.0;
+   mat1.M11 = cos(rot);  // set up the rotation matrix
+   mat1.M12 = -sin(rot);
+   mat1.M21 = sin(rot);
+   mat1.M22 = cos(rot);
+   if(ratio!=1.0){  // set scale/ellipticity matrix
+      mat2.M11 =            scale*( cos(axisrot)*cos(axisrot) + ratio*sin(axisrot)*sin(axisrot) );
+      mat2.M12 = mat2.M21 = scale*( sin(axisrot)*cos(axisrot) * (1.0 - ratio)           );
+      mat2.M22 =            scale*( sin(axisrot)*sin(axisrot) + ratio*cos(axisrot)*cos(axisrot) );
+   }
+   else { // when the ratio is 1.0 then the major axis angle is ignored and only scale matters
+      mat2.M11 = scale;
+      mat2.M12 = 0.0;
+      mat2.M21 = 0.0;
+      mat2.M22 = scale;
+   }
+   xform.eM11 =  mat2.M11 * mat1.M11 + mat2.M12 * mat1.M21;
+   xform.eM12 =  mat2.M11 * mat1.M12 + mat2.M12 * mat1.M22;;
+   xform.eM21 =  mat2.M21 * mat1.M11 + mat2.M22 * mat1.M21;
+   xform.eM22 =  mat2.M21 * mat1.M12 + mat2.M22 * mat1.M22;
+   xform.eDx  =  eDx;
+   xform.eDy  =  eDy;
+   return(xform);
+}
+
+
+/**
+    \brief Construct a U_LOGCOLORSPACEA structure.
+    \return U_LOGCOLORSPACEA structure
+    \param lcsCSType     LCS_CSType Enumeration
+    \param lcsIntent     LCS_Intent Enumeration
+    \param lcsEndpoints  CIE XYZ color space endpoints
+    \param lcsGammaRGB   Gamma For RGB
+    \param lcsFilename   Could name an external color profile file, otherwise empty string
+*/
+U_LOGCOLORSPACEA logcolorspacea_set(
+      int32_t             lcsCSType,
+      int32_t             lcsIntent,
+      U_CIEXYZTRIPLE      lcsEndpoints,
+      U_LCS_GAMMARGB      lcsGammaRGB,
+      char                *lcsFilename
+   ){
+   U_LOGCOLORSPACEA lcsa;
+   lcsa.lcsSignature  =    U_LCS_SIGNATURE;
+   lcsa.lcsVersion    =    U_LCS_SIGNATURE;  
+   lcsa.lcsSize       =    sizeof(U_LOGCOLORSPACEA);     
+   lcsa.lcsCSType     =    lcsCSType;   
+   lcsa.lcsIntent     =    lcsIntent;   
+   lcsa.lcsEndpoints  =    lcsEndpoints;
+   lcsa.lcsGammaRGB   =    lcsGammaRGB; 
+   strncpy(lcsa.lcsFilename,lcsFilename,U_MAX_PATH);
+   lcsa.lcsFilename[U_MAX_PATH-1] = '\0';
+   return(lcsa);
+}
+
+/**
+
+    \brief Construct a U_LOGCOLORSPACEW structure.
+    \return U_LOGCOLORSPACEW structure
+    \param lcsCSType     LCS_CSType Enumeration                                               
+    \param lcsIntent     LCS_Intent Enumeration                                               
+    \param lcsEndpoints  CIE XYZ color space endpoints                                        
+    \param lcsGammaRGB   Gamma For RGB                                                        
+    \param lcsFilename   Could name an external color profile file, otherwise empty string    
+*/
+U_LOGCOLORSPACEW logcolorspacew_set(
+    int32_t             lcsCSType,
+    int32_t             lcsIntent,
+    U_CIEXYZTRIPLE      lcsEndpoints,
+    U_LCS_GAMMARGB      lcsGammaRGB,
+    uint16_t            *lcsFilename
+    ){
+    U_LOGCOLORSPACEW lcsa;
+    lcsa.lcsSignature  =    U_LCS_SIGNATURE;
+    lcsa.lcsVersion    =    U_LCS_SIGNATURE;  
+    lcsa.lcsSize       =    sizeof(U_LOGCOLORSPACEW);     
+    lcsa.lcsCSType     =    lcsCSType;   
+    lcsa.lcsIntent     =    lcsIntent;   
+    lcsa.lcsEndpoints  =    lcsEndpoints;
+    lcsa.lcsGammaRGB   =    lcsGammaRGB; 
+    wchar16strncpypad(lcsa.lcsFilename,lcsFilename,U_MAX_PATH);
+    lcsa.lcsFilename[U_MAX_PATH-1] = '\0';
+    return(lcsa);
+}
+
+/**
+
+    \brief Construct a U_PANOSE structure.
+    \return U_PANOSE structure
+    \param bFamilyType      FamilyType Enumeration
+    \param bSerifStyle      SerifType Enumeration
+    \param bWeight          Weight Enumeration
+    \param bProportion      Proportion Enumeration
+    \param bContrast        Contrast Enumeration
+    \param bStrokeVariation StrokeVariation Enumeration
+    \param bArmStyle        ArmStyle Enumeration
+    \param bLetterform      Letterform Enumeration
+    \param bMidline         Midline Enumeration
+    \param bXHeight         XHeight Enumeration
+*/
+U_PANOSE panose_set(
+      uint8_t bFamilyType,
+      uint8_t bSerifStyle,
+      uint8_t bWeight,
+      uint8_t bProportion,
+      uint8_t bContrast,
+      uint8_t bStrokeVariation,
+      uint8_t bArmStyle,
+      uint8_t bLetterform,
+      uint8_t bMidline,
+      uint8_t bXHeight
+    ){
+    U_PANOSE panose;
+    panose.bFamilyType       = bFamilyType;      
+    panose.bSerifStyle       = bSerifStyle;      
+    panose.bWeight           = bWeight;          
+    panose.bProportion       = bProportion;      
+    panose.bContrast         = bContrast;        
+    panose.bStrokeVariation  = bStrokeVariation; 
+    panose.bArmStyle         = bArmStyle;        
+    panose.bLetterform       = bLetterform;      
+    panose.bMidline          = bMidline;         
+    panose.bXHeight          = bXHeight;
+    return(panose);        
+}
+
+/**
+    \brief Construct a U_LOGFONT structure.
+    \return U_LOGFONT structure
+    \param lfHeight         Height in Logical units
+    \param lfWidth          Average Width in Logical units
+    \param lfEscapement     Angle in 0.1 degrees betweem escapement vector and X axis
+    \param lfOrientation    Angle in 0.1 degrees between baseline and X axis
+    \param lfWeight         LF_Weight Enumeration
+    \param lfItalic         Italics:   0 or 1
+    \param lfUnderline      Underline: 0 or 1
+    \param lfStrikeOut      Strikeout: 0 or 1
+    \param lfCharSet        LF_CharSet Enumeration
+    \param lfOutPrecision   LF_OutPrecision Enumeration
+    \param lfClipPrecision  LF_ClipPrecision Enumeration
+    \param lfQuality        LF_Quality Enumeration
+    \param lfPitchAndFamily LF_PitchAndFamily Enumeration
+    \param lfFaceName       Name of font. truncates at U_LF_FACESIZE, smaller must be null terminated
+
+*/
+U_LOGFONT logfont_set(
+    int32_t    lfHeight,
+    int32_t    lfWidth,
+    int32_t    lfEscapement,
+    int32_t    lfOrientation,
+    int32_t    lfWeight,
+    uint8_t    lfItalic,
+    uint8_t    lfUnderline,
+    uint8_t    lfStrikeOut,
+    uint8_t    lfCharSet,
+    uint8_t    lfOutPrecision,
+    uint8_t    lfClipPrecision,
+    uint8_t    lfQuality,
+    uint8_t    lfPitchAndFamily,
+    uint16_t  *lfFaceName
+    ){
+    U_LOGFONT lf;
+    lf.lfHeight                  = lfHeight;          
+    lf.lfWidth                   = lfWidth;           
+    lf.lfEscapement              = lfEscapement;      
+    lf.lfOrientation             = lfOrientation;     
+    lf.lfWeight                  = lfWeight;          
+    lf.lfItalic                  = lfItalic;          
+    lf.lfUnderline               = lfUnderline;       
+    lf.lfStrikeOut               = lfStrikeOut;       
+    lf.lfCharSet                 = lfCharSet;         
+    lf.lfOutPrecision            = lfOutPrecision;    
+    lf.lfClipPrecision           = lfClipPrecision;   
+    lf.lfQuality                 = lfQuality;         
+    lf.lfPitchAndFamily          = lfPitchAndFamily;  
+    wchar16strncpypad(lf.lfFaceName, lfFaceName, U_LF_FACESIZE); // pad this one as the intial structure was not set to zero
+    lf.lfFaceName[U_LF_FACESIZE-1] = '\0';
+    return(lf);
+}
+
+
+/**
+    \brief Construct a U_LOGFONT_PANOSE structure.
+    \return U_LOGFONT_PANOSE structure
+    \param elfLogFont    Basic font attributes
+    \param elfFullName   Font full name, truncates at U_LF_FULLFACESIZE, smaller must be null terminated
+    \param elfStyle      Font style, truncates at U_LF_FULLFACESIZE, smaller must be null terminated
+    \param elfStyleSize  Font hinting starting at this point size, if 0, starts at Height
+    \param elfPanose     Panose Object. If all zero, it is ignored.
+*/
+U_LOGFONT_PANOSE logfont_panose_set(
+      U_LOGFONT   elfLogFont,
+      uint16_t   *elfFullName,
+      uint16_t   *elfStyle,
+      uint32_t    elfStyleSize,
+      U_PANOSE    elfPanose
+    ){
+   U_LOGFONT_PANOSE lfp;
+   memset(&lfp,0,sizeof(U_LOGFONT_PANOSE)); // all fields zero unless needed.  Many should be ignored or must be 0.
+   wchar16strncpy(lfp.elfFullName, elfFullName, U_LF_FULLFACESIZE);
+   lfp.elfFullName[U_LF_FULLFACESIZE-1] = '\0';
+   wchar16strncpy(lfp.elfStyle,    elfStyle,    U_LF_FACESIZE);
+   lfp.elfStyle[U_LF_FACESIZE-1] = '\0';
+   lfp.elfLogFont    =   elfLogFont;
+   lfp.elfStyleSize  =   elfStyleSize;
+   lfp.elfPanose     =   elfPanose;
+   return(lfp);
+}
+
+/**
+    \brief Construct a U_BITMAPINFOHEADER structure.
+    \return U_BITMAPINFOHEADER structure
+    \param biWidth         Bitmap width in pixels
+    \param biHeight        Bitmap height in pixels
+    \param biPlanes        Planes (must be 1)
+    \param biBitCount      BitCount Enumeration
+    \param biCompression   BI_Compression Enumeration
+    \param biSizeImage     Size in bytes of image
+    \param biXPelsPerMeter X Resolution in pixels/meter
+    \param biYPelsPerMeter Y Resolution in pixels/meter
+    \param biClrUsed       Number of bmciColors in U_BITMAPCOREINFO
+    \param biClrImportant  Number of bmciColors needed (0 means all). 
+*/
+U_BITMAPINFOHEADER bitmapinfoheader_set(
+      int32_t       biWidth,
+      int32_t       biHeight,
+      uint16_t      biPlanes,
+      uint16_t      biBitCount,
+      uint32_t      biCompression,
+      uint32_t      biSizeImage,
+      int32_t       biXPelsPerMeter,
+      int32_t       biYPelsPerMeter,
+      U_NUM_RGBQUAD biClrUsed,
+      uint32_t      biClrImportant
+    ){
+    U_BITMAPINFOHEADER Bmi;
+    Bmi.biSize          = sizeof(U_BITMAPINFOHEADER);         
+    Bmi.biWidth         = biWidth;        
+    Bmi.biHeight        = biHeight;       
+    Bmi.biPlanes        = biPlanes;       
+    Bmi.biBitCount      = biBitCount;     
+    Bmi.biCompression   = biCompression;  
+    Bmi.biSizeImage     = biSizeImage;    
+    Bmi.biXPelsPerMeter = biXPelsPerMeter;
+    Bmi.biYPelsPerMeter = biYPelsPerMeter;
+    Bmi.biClrUsed       = biClrUsed;      
+    Bmi.biClrImportant  = biClrImportant;
+    return(Bmi); 
+}
+
+
+/**
+    \brief Allocate and construct a U_BITMAPINFO structure.
+    \return Pointer to a U_BITMAPINFO structure
+    \param BmiHeader   Geometry and pixel properties
+    \param BmiColors   Color table (must be NULL for some  values of BmiHeader->biBitCount)
+*/
+PU_BITMAPINFO bitmapinfo_set(
+      U_BITMAPINFOHEADER  BmiHeader,
+      PU_RGBQUAD          BmiColors
+   ){
+   char *record;
+   int   irecsize;
+   int   cbColors, cbColors4, off;
+
+   cbColors  = 4*get_real_color_count((char *) &BmiHeader);
+   cbColors4 = UP4(cbColors);
+   irecsize  = sizeof(U_BITMAPINFOHEADER) + cbColors4;
+   record    = malloc(irecsize);
+   if(record){
+     memcpy(record, &BmiHeader, sizeof(U_BITMAPINFOHEADER));
+     if(cbColors){
+        off = sizeof(U_BITMAPINFOHEADER);
+        memcpy(record + off, BmiColors, cbColors);
+        off += cbColors;
+        if(cbColors4 - cbColors){  memset(record + off, 0, cbColors4 - cbColors); }
+     }
+   }
+   return((PU_BITMAPINFO) record);
+}
+
+/**
+    \brief Allocate and construct a U_EXTLOGPEN structure.
+    \return pointer to U_EXTLOGPEN structure, or NULL on error
+    \param elpPenStyle   PenStyle Enumeration
+    \param elpWidth      Width in logical units (elpPenStyle & U_PS_GEOMETRIC) or 1 (pixel)
+    \param elpBrushStyle LB_Style Enumeration
+    \param elpColor      Pen color
+    \param elpHatch      HatchStyle Enumeration
+    \param elpNumEntries Count of StyleEntry array
+    \param elpStyleEntry Array of StyleEntry (For user specified dot/dash patterns)
+*/
+PU_EXTLOGPEN extlogpen_set(
+      uint32_t            elpPenStyle,
+      uint32_t            elpWidth,
+      uint32_t            elpBrushStyle,
+      U_COLORREF          elpColor,
+      int32_t             elpHatch,
+      U_NUM_STYLEENTRY    elpNumEntries,
+      U_STYLEENTRY       *elpStyleEntry
+   ){
+   int irecsize,szSyleArray;
+   char *record;
+   
+   if(elpNumEntries){
+     if(!elpStyleEntry)return(NULL);
+     szSyleArray   = elpNumEntries * sizeof(U_STYLEENTRY);
+     irecsize = sizeof(U_EXTLOGPEN) + szSyleArray - sizeof(U_STYLEENTRY); // first one is in the record
+   }
+   else {
+     szSyleArray   = 0;
+     irecsize = sizeof(U_EXTLOGPEN);
+   }
+   record   = malloc(irecsize);
+   if(record){
+     ((PU_EXTLOGPEN) record)->elpPenStyle    = elpPenStyle;                             
+     ((PU_EXTLOGPEN) record)->elpWidth       = elpWidth;                                
+     ((PU_EXTLOGPEN) record)->elpBrushStyle  = elpBrushStyle;                           
+     ((PU_EXTLOGPEN) record)->elpColor       = elpColor;                                
+     ((PU_EXTLOGPEN) record)->elpHatch       = elpHatch;                                
+     ((PU_EXTLOGPEN) record)->elpNumEntries  = elpNumEntries;                           
+     if(elpNumEntries){ memcpy(((PU_EXTLOGPEN) record)->elpStyleEntry,elpStyleEntry,szSyleArray);   }
+     else {             memset(((PU_EXTLOGPEN) record)->elpStyleEntry,0,sizeof(U_STYLEENTRY)); }  // not used, but this stops valgrind warnings
+   }
+   return((PU_EXTLOGPEN) record);
+}
+
+/**
+    \brief Construct a U_LOGPEN structure.
+    \return U_LOGPEN structure
+    \param lopnStyle PenStyle Enumeration
+    \param lopnWidth Width of pen set by X, Y is ignored
+    \param lopnColor Pen color value
+    
+*/
+U_LOGPEN logpen_set(
+      uint32_t     lopnStyle,
+      U_POINT      lopnWidth,
+      U_COLORREF   lopnColor
+   ){
+   U_LOGPEN lp;
+   lp.lopnStyle = lopnStyle;
+   lp.lopnWidth = lopnWidth;
+   lp.lopnColor = lopnColor;
+   return(lp);
+} 
+
+/**
+    \brief Construct a U_LOGPLTNTRY structure.
+    \return U_LOGPLTNTRY structure
+    \param peReserved Ignore
+    \param peRed      Palette entry Red Intensity
+    \param peGreen    Palette entry Green Intensity
+    \param peBlue     Palette entry Blue Intensity
+*/
+U_LOGPLTNTRY logpltntry_set(
+      uint8_t    peReserved,
+      uint8_t    peRed,
+      uint8_t    peGreen,
+      uint8_t    peBlue
+   ){
+   U_LOGPLTNTRY lpny;
+   lpny.peReserved = peReserved;
+   lpny.peRed      = peRed;     
+   lpny.peGreen    = peGreen;   
+   lpny.peBlue     = peBlue;
+   return(lpny);     
+}
+
+/**
+    \brief Allocate and construct a U_LOGPALETTE structure.
+    \return pointer to U_LOGPALETTE structure, or NULL on error.
+    \param palNumEntries Number of U_LOGPLTNTRY objects
+    \param palPalEntry   array, PC_Entry Enumeration
+*/
+PU_LOGPALETTE logpalette_set(
+      U_NUM_LOGPLTNTRY    palNumEntries,
+      PU_LOGPLTNTRY      *palPalEntry
+   ){
+   PU_LOGPALETTE record;
+   int cbPalArray,irecsize;
+   
+   if(palNumEntries == 0 || !palPalEntry)return(NULL);
+   cbPalArray = palNumEntries * sizeof(U_LOGPLTNTRY);
+   irecsize = sizeof(U_LOGPALETTE) + cbPalArray - sizeof(U_LOGPLTNTRY);
+   record = (PU_LOGPALETTE) malloc(irecsize);
+   if(irecsize){
+      record->palVersion    = U_LP_VERSION;
+      record->palNumEntries = palNumEntries;
+      memcpy(record->palPalEntry,palPalEntry,cbPalArray);
+   }
+   return(record);
+}
+
+/**
+    \brief Construct a U_RGNDATAHEADER structure.
+    \return U_RGNDATAHEADER structure
+    \param nCount  Number of rectangles in region
+    \param rclBounds Region bounds
+*/
+U_RGNDATAHEADER rgndataheader_set(
+      U_NUM_RECTL         nCount,
+      U_RECTL             rclBounds
+   ){
+   U_RGNDATAHEADER rdh;
+   rdh.dwSize    = U_RDH_OBJSIZE;  
+   rdh.iType     = U_RDH_RECTANGLES;   
+   rdh.nCount    = nCount;  
+   rdh.nRgnSize  = nCount * sizeof(U_RECTL); // Size in bytes of rectangle array
+   rdh.rclBounds = rclBounds; 
+   return(rdh);
+}
+
+/**
+    \brief Allocate and construct a U_RGNDATA structure.
+    \return pointer to U_RGNDATA structure, or NULL on error.
+    \param rdh    Data description
+    \param Buffer Array of U_RECTL elements
+*/
+PU_RGNDATA rgndata_set(
+      U_RGNDATAHEADER     rdh,
+      PU_RECTL            Buffer
+   ){
+   char *record;
+   int irecsize;
+   int szRgnArray,off;
+   
+   if(!Buffer || !rdh.nCount || !rdh.nRgnSize)return(NULL);
+   szRgnArray = rdh.nRgnSize;             // size of the U_RECTL array
+   irecsize = sizeof(U_RGNDATA) + szRgnArray - sizeof(U_RECTL);  // core + array - overlap
+   record    = malloc(irecsize);
+   if(record){
+      memcpy(record, &rdh, sizeof(U_RGNDATAHEADER));
+      off =  sizeof(U_RGNDATAHEADER);
+      memcpy(record + off, Buffer, szRgnArray);   
+   }
+   return((PU_RGNDATA) record);
+}
+
+/**
+    \brief Construct a U_COLORADJUSTMENT structure.
+    \return U_COLORADJUSTMENT structure
+    \param Size            Size of this structure in bytes                                      
+    \param Flags           ColorAdjustment Enumeration                                          
+    \param IlluminantIndex Illuminant Enumeration                                               
+    \param RedGamma        Red   Gamma correction (range:2500:65000, 10000 is no correction)    
+    \param GreenGamma      Green Gamma correction (range:2500:65000, 10000 is no correction)    
+    \param BlueGamma       Blue  Gamma correction (range:2500:65000, 10000 is no correction)    
+    \param ReferenceBlack  Values less than this are black (range:0:4000)                       
+    \param ReferenceWhite  Values more than this are white (range:6000:10000)                   
+    \param Contrast        Contrast     adjustment (range:-100:100, 0 is no correction)         
+    \param Brightness      Brightness   adjustment (range:-100:100, 0 is no correction)         
+    \param Colorfulness    Colorfulness adjustment (range:-100:100, 0 is no correction)         
+    \param RedGreenTint    Tine         adjustment (range:-100:100, 0 is no correction)         
+*/
+U_COLORADJUSTMENT coloradjustment_set(
+      uint16_t            Size,
+      uint16_t            Flags,
+      uint16_t            IlluminantIndex,
+      uint16_t            RedGamma,
+      uint16_t            GreenGamma,
+      uint16_t            BlueGamma,
+      uint16_t            ReferenceBlack,
+      uint16_t            ReferenceWhite,
+      int16_t             Contrast,
+      int16_t             Brightness,
+      int16_t             Colorfulness,
+      int16_t             RedGreenTint
+   ){
+   U_COLORADJUSTMENT ca;
+   ca.caSize            = Size;                     
+   ca.caFlags           = Flags;          
+   ca.caIlluminantIndex = IlluminantIndex;
+   ca.caRedGamma        = U_MNMX(RedGamma,       U_RGB_GAMMA_MIN,       U_RGB_GAMMA_MAX);
+   ca.caGreenGamma      = U_MNMX(GreenGamma,     U_RGB_GAMMA_MIN,       U_RGB_GAMMA_MAX);
+   ca.caBlueGamma       = U_MNMX(BlueGamma,      U_RGB_GAMMA_MIN,       U_RGB_GAMMA_MAX);
+   // Next one is different to eliminate compiler warning -  U_R_B_MIN is 0 and unsigned
+   ca.caReferenceBlack  = U_MAX( ReferenceBlack, U_REFERENCE_BLACK_MAX);
+   ca.caReferenceWhite  = U_MNMX(ReferenceWhite, U_REFERENCE_WHITE_MIN, U_REFERENCE_WHITE_MAX); 
+   ca.caContrast        = U_MNMX(Contrast,       U_COLOR_ADJ_MIN,       U_COLOR_ADJ_MAX); 
+   ca.caBrightness      = U_MNMX(Brightness,     U_COLOR_ADJ_MIN,       U_COLOR_ADJ_MAX); 
+   ca.caColorfulness    = U_MNMX(Colorfulness,   U_COLOR_ADJ_MIN,       U_COLOR_ADJ_MAX); 
+   ca.caRedGreenTint    = U_MNMX(RedGreenTint,   U_COLOR_ADJ_MIN,       U_COLOR_ADJ_MAX);
+   return(ca);
+}
+
+/**
+    \brief Construct a U_PIXELFORMATDESCRIPTOR structure.
+    \return U_PIXELFORMATDESCRIPTOR structure
+    \param dwFlags         PFD_dwFlags Enumeration
+    \param iPixelType      PFD_iPixelType Enumeration
+    \param cColorBits      RGBA: total bits per pixel
+    \param cRedBits        Red   bits per pixel
+    \param cRedShift       Red   shift to data bits
+    \param cGreenBits      Green bits per pixel
+    \param cGreenShift     Green shift to data bits
+    \param cBlueBits       Blue  bits per pixel
+    \param cBlueShift      Blue  shift to data bits
+    \param cAlphaBits      Alpha bits per pixel
+    \param cAlphaShift     Alpha shift to data bits
+    \param cAccumBits      Accumulator buffer, total bitplanes
+    \param cAccumRedBits   Red   accumulator buffer bitplanes
+    \param cAccumGreenBits Green accumulator buffer bitplanes
+    \param cAccumBlueBits  Blue  accumulator buffer bitplanes
+    \param cAccumAlphaBits Alpha accumulator buffer bitplanes
+    \param cDepthBits      Depth of Z-buffer
+    \param cStencilBits    Depth of stencil buffer
+    \param cAuxBuffers     Depth of auxilliary buffers (not supported)
+    \param iLayerType      PFD_iLayerType Enumeration, may be ignored
+    \param bReserved       Bits 0:3/4:7 are number of Overlay/Underlay planes 
+    \param dwLayerMask     may be ignored
+    \param dwVisibleMask   color or index of underlay plane
+    \param dwDamageMask    may be ignored
+*/
+U_PIXELFORMATDESCRIPTOR pixelformatdescriptor_set(
+      uint32_t   dwFlags,
+      uint8_t    iPixelType,
+      uint8_t    cColorBits,
+      uint8_t    cRedBits,
+      uint8_t    cRedShift,
+      uint8_t    cGreenBits,
+      uint8_t    cGreenShift,
+      uint8_t    cBlueBits,
+      uint8_t    cBlueShift,
+      uint8_t    cAlphaBits,
+      uint8_t    cAlphaShift,
+      uint8_t    cAccumBits,
+      uint8_t    cAccumRedBits,
+      uint8_t    cAccumGreenBits,
+      uint8_t    cAccumBlueBits,
+      uint8_t    cAccumAlphaBits,
+      uint8_t    cDepthBits,
+      uint8_t    cStencilBits,
+      uint8_t    cAuxBuffers,
+      uint8_t    iLayerType,
+      uint8_t    bReserved,
+      uint32_t   dwLayerMask,
+      uint32_t   dwVisibleMask,
+      uint32_t   dwDamageMask
+   ){
+   U_PIXELFORMATDESCRIPTOR pfd;
+   pfd.nSize           = sizeof(U_PIXELFORMATDESCRIPTOR);                  
+   pfd.nVersion        = 1;        
+   pfd.dwFlags         = dwFlags;         
+   pfd.iPixelType      = iPixelType;      
+   pfd.cColorBits      = cColorBits;      
+   pfd.cRedBits        = cRedBits;        
+   pfd.cRedShift       = cRedShift;       
+   pfd.cGreenBits      = cGreenBits;      
+   pfd.cGreenShift     = cGreenShift;     
+   pfd.cBlueBits       = cBlueBits;       
+   pfd.cBlueShift      = cBlueShift;      
+   pfd.cAlphaBits      = cAlphaBits;      
+   pfd.cAlphaShift     = cAlphaShift;     
+   pfd.cAccumBits      = cAccumBits;      
+   pfd.cAccumRedBits   = cAccumRedBits;   
+   pfd.cAccumGreenBits = cAccumGreenBits; 
+   pfd.cAccumBlueBits  = cAccumBlueBits;  
+   pfd.cAccumAlphaBits = cAccumAlphaBits; 
+   pfd.cDepthBits      = cDepthBits;      
+   pfd.cStencilBits    = cStencilBits;    
+   pfd.cAuxBuffers     = cAuxBuffers;     
+   pfd.iLayerType      = iLayerType;      
+   pfd.bReserved       = bReserved;       
+   pfd.dwLayerMask     = dwLayerMask;     
+   pfd.dwVisibleMask   = dwVisibleMask;   
+   pfd.dwDamageMask    = dwDamageMask;
+   return(pfd);    
+}
+
+/**
+    \brief Allocate and create a U_EMRTEXT structure followed by its variable pieces via a char* pointer.
+    Dx cannot be NULL, if the calling program has no appropriate values call dx_set() first. 
+    \return char* pointer to U_EMRTEXT structure followed by its variable pieces, or NULL on error
+    \param ptlReference String start coordinates
+    \param NumString    Number of characters in string, does NOT include a terminator
+    \param cbChar       Number of bytes per character
+    \param String       String to write
+    \param fOptions     ExtTextOutOptions Enumeration
+    \param rcl          (Optional, when fOptions & 7) grayed/clipping/opaque rectangle
+    \param Dx           Character spacing array from the start of the RECORD   
+*/
+char *emrtext_set(
+      U_POINTL         ptlReference,
+      U_NUM_STR        NumString,
+      uint32_t         cbChar,
+      void            *String,
+      uint32_t         fOptions,
+      U_RECTL          rcl,
+      uint32_t        *Dx
+    ){
+    int   irecsize,cbDxArray,cbString4,cbString,off;
+    char *record;
+    uint32_t *loffDx;
+    
+    if(!String)return(NULL);
+    if(!Dx)return(NULL);
+    cbString = cbChar * NumString;                   // size of the string in bytes
+    cbString4 = UP4(cbString);                       // size of the string buffer
+    cbDxArray = sizeof(uint32_t)*NumString;          // size of Dx array storage
+    if(fOptions & U_ETO_PDY)cbDxArray += cbDxArray;  // of the Dx buffer, here do both X and Y coordinates
+    irecsize = sizeof(U_EMRTEXT) + sizeof(uint32_t) + cbString4 + cbDxArray;    // core structure  + offDx + string buf + dx buf
+    if(!(fOptions & U_ETO_NO_RECT)){ irecsize += sizeof(U_RECTL); } // plus variable U_RECTL, when it is present
+    record   = malloc(irecsize);
+    if(record){
+      ((PU_EMRTEXT)record)->ptlReference    = ptlReference;
+      ((PU_EMRTEXT)record)->nChars          = NumString;
+      // pick up ((PU_EMRTEXT)record)->offString later
+      ((PU_EMRTEXT)record)->fOptions        = fOptions;
+      off = sizeof(U_EMRTEXT);              // location where variable pieces will start to be written                
+      if(!(fOptions & U_ETO_NO_RECT)){      // variable field, may or may not be present 
+         memcpy(record + off,&rcl, sizeof(U_RECTL));
+         off += sizeof(U_RECTL);
+      }
+      loffDx = (uint32_t *)(record + off);                  // offDx will go here, but we do not know with what value yet
+      off += sizeof(uint32_t);
+      memcpy(record + off,String,cbString);                 // copy the string data to its buffer
+      ((PU_EMRTEXT)record)->offString       = off;          // now save offset in the structure
+      off += cbString;
+      if(cbString < cbString4){ 
+        memset(record+off,0,cbString4-cbString); // keeps valgrind happy (initialize padding after string)
+        off += cbString4-cbString;
+      }
+      memcpy(record + off, Dx, cbDxArray);                  // copy the Dx data to its buffer
+      *loffDx = off;                                        // now save offDx to the structure
+    }
+    return(record);
+}
+
+
+
+/* **********************************************************************************************
+These functions are simpler or more convenient ways to generate the specified types of EMR records.  
+Each should be called in preference to the underlying "base" EMR function.
+*********************************************************************************************** */
+
+
+/**
+    \brief Allocate and construct a U_EMRCOMMENT structure with a UTF8 string.
+    A U_EMRCOMMENT contains application specific data, and that may include contain null characters. This function may be used when the
+    comment only incluces UT8 text.
+    \return pointer to U_EMRCOMMENT structure, or NULL on error.
+    \param string  UTF8 string to store in the comment
+
+
+*/
+char *textcomment_set(
+      const char *string
+   ){
+   if(!string)return(NULL);
+   return(U_EMRCOMMENT_set(1 + strlen(string),string));
+}
+
+/**
+    \brief Allocate and construct a U_EMRDELETEOBJECT structure and also delete the requested object from the table.
+    Use this function instead of calling U_EMRDELETEOBJECT_set() directly.
+    \return pointer to U_EMRDELETEOBJECT structure, or NULL on error.
+    \param ihObject  Pointer to handle to delete.  This value is set to 0 if the function succeeds.
+    \param eht       EMF handle table
+    
+    Note that calling this function should always be conditional on the specifed object being defined.  It is easy to
+    write a program where deleteobject_set() is called in a sequence where, at the time, we know that ihObject is defined.
+    Then a later modification, possibly quite far away in the code, causes it to be undefined.  That distant change will
+    result in a failure when this function reutrns.  That problem cannot be handled here because the only  values which
+    may be returned are a valid U_EMRDELETEOBJECT record or a NULL, and other errors could result in the NULL.  
+    So the object must be checked before the call.
+*/
+char *deleteobject_set(
+      uint32_t    *ihObject,
+      EMFHANDLES  *eht
+   ){
+   uint32_t saveObject=*ihObject;
+   if(emf_htable_delete(ihObject,eht))return(NULL);  // invalid handle or other problem, cannot be deleted
+   return(U_EMRDELETEOBJECT_set(saveObject));
+}
+
+/**
+    \brief Allocate and construct a U_EMRSELECTOBJECT structure, checks that the handle specified is one that can actually be selected.
+    Use this function instead of calling U_EMRSELECTOBJECT_set() directly.
+    \return pointer to U_EMRSELECTOBJECT structure, or NULL on error.
+    \param ihObject  handle to select
+    \param eht       EMF handle table
+*/
+char *selectobject_set(
+      uint32_t    ihObject,
+      EMFHANDLES *eht
+   ){
+   if(!(U_STOCK_OBJECT & ihObject)){        // not a stock object, those go straight through
+     if(ihObject > eht->top)return(NULL);   // handle this high is not in the table
+     if(!eht->table[ihObject])return(NULL); // handle is not in the table, so not active, so cannot be selected
+   }
+   return(U_EMRSELECTOBJECT_set(ihObject));
+}
+
+/**
+    \brief Allocate and construct a U_EMREXTCREATEPEN structure, create a handle and return it.
+    Use this function instead of calling U_EMREXTCREATEPEN_set() directly.
+    \return pointer to U_EMREXTCREATEPEN structure, or NULL on error.
+    \param ihPen handle to be used by new object
+    \param eht   EMF handle table 
+    \param Bmi   bitmapbuffer
+    \param cbPx   Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px     pixel array (NULL if cbPx == 0)
+    \param elp   Pen parameters (Size is Variable!!!!)
+*/
+char *extcreatepen_set(
+      uint32_t        *ihPen,
+      EMFHANDLES      *eht,
+      PU_BITMAPINFO    Bmi,
+      const uint32_t   cbPx,
+      char            *Px,
+      PU_EXTLOGPEN     elp
+   ){
+   if(emf_htable_insert(ihPen, eht))return(NULL);
+   return(U_EMREXTCREATEPEN_set(*ihPen, Bmi, cbPx, Px, elp ));
+}
+
+/**
+    \brief Allocate and construct a U_EMRCREATEPEN structure, create a handle and returns it
+    Use this function instead of calling U_EMRCREATEPEN_set() directly.
+    \return pointer to U_EMRCREATEPEN structure, or NULL on error.
+    \param ihPen handle to be used by new object
+    \param eht   EMF handle table 
+    \param lopn  Pen parameters
+*/
+char *createpen_set(
+      uint32_t   *ihPen,
+      EMFHANDLES *eht,
+      U_LOGPEN    lopn
+   ){
+   if(emf_htable_insert(ihPen, eht))return(NULL);
+   return(U_EMRCREATEPEN_set(*ihPen, lopn));
+}
+
+/**
+    \brief Allocate and construct a U_EMRCREATEBRUSHINDIRECT structure, create a handle and returns it
+    Use this function instead of calling U_EMRCREATEBRUSHINDIRECT_set() directly.
+    \return pointer to U_EMRCREATEBRUSHINDIRECT structure, or NULL on error.
+    \param ihBrush handle to be used by new object 
+    \param eht     EMF handle table 
+    \param lb      Brush parameters  
+*/
+char *createbrushindirect_set(
+      uint32_t    *ihBrush,
+      EMFHANDLES  *eht,
+      U_LOGBRUSH   lb
+   ){
+   if(emf_htable_insert(ihBrush, eht))return(NULL);
+   return(U_EMRCREATEBRUSHINDIRECT_set(*ihBrush, lb));
+}
+
+/**
+    \brief Allocate and construct a U_EMRCREATEDIBPATTERNBRUSHPT_set structure, create a handle and returns it
+    Use this function instead of calling U_EMRCREATEDIBPATTERNBRUSHPT_set() directly.
+    \return pointer to U_EMRCREATEDIBPATTERNBRUSHPT_set structure, or NULL on error.
+    \param ihBrush handle to be used by new object 
+    \param eht     EMF handle table 
+    \param iUsage  DIBColors enumeration
+    \param Bmi     Bitmap info
+    \param cbPx    Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px      (Optional) bitmapbuffer (pixel array section )
+*/
+char *createdibpatternbrushpt_set(
+      uint32_t            *ihBrush,
+      EMFHANDLES          *eht,
+      const uint32_t       iUsage, 
+      PU_BITMAPINFO        Bmi,
+      const uint32_t       cbPx,
+      const char          *Px
+      
+   ){
+   if(emf_htable_insert(ihBrush, eht))return(NULL);
+   return(U_EMRCREATEDIBPATTERNBRUSHPT_set(*ihBrush, iUsage, Bmi, cbPx, Px));
+}
+
+/**
+    \brief Allocate and construct a U_EMRCREATEMONOBRUSH_set structure, create a handle and returns it
+    Use this function instead of calling U_EMRCREATEMONOBRUSH_set() directly.
+    \return pointer to U_EMRCREATEMONOBRUSH_set structure, or NULL on error.
+    \param ihBrush handle to be used by new object 
+    \param eht     EMF handle table 
+    \param iUsage  DIBColors enumeration
+    \param Bmi     Bitmap info
+    \param cbPx    Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px      (Optional) bitmapbuffer (pixel array section )
+*/
+char *createmonobrush_set(
+      uint32_t            *ihBrush,
+      EMFHANDLES          *eht,
+      const uint32_t       iUsage, 
+      PU_BITMAPINFO        Bmi,
+      const uint32_t       cbPx,
+      const char          *Px
+      
+   ){
+   if(emf_htable_insert(ihBrush, eht))return(NULL);
+   return(U_EMRCREATEMONOBRUSH_set(*ihBrush, iUsage, Bmi, cbPx, Px));
+}
+
+
+/**
+    \brief Allocate and construct a U_EMRCREATECOLORSPACE structure, create a handle and returns it
+    Use this function instead of calling U_EMRCREATECOLORSPACE_set() directly.
+    \return pointer to U_EMRCREATECOLORSPACE structure, or NULL on error.
+    \param ihCS  ColorSpace handle, will be created and returned
+    \param eht   Pointer to structure holding all EMF handles
+    \param lcs    ColorSpace parameters
+*/
+char *createcolorspace_set(
+      uint32_t          *ihCS,
+      EMFHANDLES         *eht,
+      U_LOGCOLORSPACEA    lcs
+   ){
+   if(emf_htable_insert(ihCS, eht))return(NULL);
+   return(U_EMRCREATECOLORSPACE_set(*ihCS,lcs));
+}
+
+/**
+    \brief Allocate and construct a U_EMRCREATECOLORSPACEW structure, create a handle and returns it
+    Use this function instead of calling U_EMRCREATECOLORSPACEW_set() directly.
+    \return pointer to U_EMRCREATECOLORSPACEW structure, or NULL on error.
+    \param ihCS    ColorSpace handle, will be created and returned
+    \param eht     Pointer to structure holding all EMF handles
+    \param lcs     ColorSpace parameters
+    \param dwFlags If low bit set Data is present
+    \param cbData  Number of bytes of theData field.
+    \param Data    (Optional, dwFlags & 1) color profile data 
+*/
+char *createcolorspacew_set(
+      uint32_t           *ihCS,
+      EMFHANDLES         *eht,
+      U_LOGCOLORSPACEW    lcs,
+      uint32_t            dwFlags,
+      U_CBDATA            cbData,
+      uint8_t            *Data
+   ){
+   if(emf_htable_insert(ihCS, eht))return(NULL);
+   return(U_EMRCREATECOLORSPACEW_set(*ihCS, lcs, dwFlags, cbData, Data));
+}
+
+/**
+    \brief Allocate and construct a U_EMREXTCREATEFONTINDIRECTW structure, create a handle and returns it
+    Use this function instead of calling U_EMREXTCREATEFONTINDIRECTW_set() directly.
+    \return pointer to U_EMREXTCREATEFONTINDIRECTW structure, or NULL on error.
+    \param ihFont  Font handle, will be created and returned
+    \param eht     Pointer to structure holding all EMF handles
+    \param elf     Pointer to Font parameters asPU_LOGFONT
+    \param elfw    Pointer to Font parameters as U_LOGFONT_PANOSE
+*/
+char *extcreatefontindirectw_set(
+      uint32_t   *ihFont,
+      EMFHANDLES *eht,
+      const char *elf,
+      const char *elfw
+   ){
+   if(emf_htable_insert(ihFont, eht))return(NULL);
+   return(U_EMREXTCREATEFONTINDIRECTW_set(*ihFont, elf, elfw));
+}
+
+/**
+    \brief Allocate and construct a U_EMRCREATEPALETTE structure, create a handle and returns it
+    Use this function instead of calling U_EMRCREATEPALETTE_set() directly.
+    \return pointer to U_EMRCREATEPALETTE structure, or NULL on error.
+    \param ihPal  Palette handle, will be created and returned
+    \param eht    Pointer to structure holding all EMF handles
+    \param lgpl   PaletteFont parameters
+*/
+char *createpalette_set(
+      uint32_t     *ihPal,
+      EMFHANDLES   *eht,
+      U_LOGPALETTE  lgpl
+   ){
+  if(emf_htable_insert(ihPal, eht))return(NULL);
+   return(U_EMRCREATEPALETTE_set(*ihPal, lgpl));
+}
+
+/**
+    \brief Allocate and construct a U_EMRSETPALETTEENTRIES structure, create a handle and returns it
+    Use this function instead of calling U_EMRSETPALETTEENTRIES_set() directly.
+    \return pointer to U_EMRSETPALETTEENTRIES structure, or NULL on error.
+    \param ihPal       Palette handle, will be created and returned
+    \param eht         Pointer to structure holding all EMF handles
+    \param iStart      First Palette entry in selected object to set
+    \param cEntries    Number of Palette entries in selected object to set
+    \param aPalEntries Values to set with
+*/
+char *setpaletteentries_set(
+      uint32_t               *ihPal,
+      EMFHANDLES             *eht,
+      const uint32_t         iStart,
+      const U_NUM_LOGPLTNTRY cEntries,
+      const PU_LOGPLTNTRY    aPalEntries
+   ){
+   if(emf_htable_insert(ihPal, eht))return(NULL);
+   return(U_EMRSETPALETTEENTRIES_set(*ihPal, iStart, cEntries, aPalEntries));
+}
+
+/**
+    \brief Allocate and construct a U_EMRFILLRGN structure, create a handle and returns it
+    Use this function instead of calling U_EMRFILLRGN_set() directly.
+    \return pointer to U_EMRFILLRGN structure, or NULL on error.
+    \param ihBrush   Brush handle, will be created and returned
+    \param eht       Pointer to structure holding all EMF handles
+    \param rclBounds Bounding rectangle in device units
+    \param RgnData   Pointer to a U_RGNDATA structure
+*/
+char *fillrgn_set(
+      uint32_t         *ihBrush,
+      EMFHANDLES       *eht,
+      const U_RECTL     rclBounds,
+      const PU_RGNDATA  RgnData
+   ){
+   if(emf_htable_insert(ihBrush, eht))return(NULL);
+   return(U_EMRFILLRGN_set(rclBounds, *ihBrush, RgnData));
+}
+
+/**
+    \brief Allocate and construct a U_EMRFRAMERGN structure, create a handle and returns it
+    Use this function instead of calling U_EMRFRAMERGN_set() directly.
+    \return pointer to U_EMRFRAMERGN structure, or NULL on error.
+    \param ihBrush   Brush handle, will be created and returned
+    \param eht       Pointer to structure holding all EMF handles
+    \param rclBounds Bounding rectangle in device units
+    \param szlStroke W & H of Brush stroke
+    \param RgnData   Pointer to a U_RGNDATA structure
+*/
+char *framergn_set(
+      uint32_t         *ihBrush,
+      EMFHANDLES       *eht,
+      const U_RECTL     rclBounds,
+      const U_SIZEL     szlStroke,
+      const PU_RGNDATA  RgnData
+   ){
+   if(emf_htable_insert(ihBrush, eht))return(NULL);
+   return(U_EMRFRAMERGN_set(rclBounds, *ihBrush, szlStroke, RgnData));
+}
+
+//! \cond
+/*  Kernels for transforming arrays of points, see U_xform_pairs().  Each transforms as many points from the start
+    of the array as it can and returns that number, the scalar code in U_xform_pairs() (the reference implementation)
+    transforms the rest.  The vector versions do the same single precision operations in the same order as the
+    scalar code, and then round in double precision like U_ROUND(), so the results are identical.  Vector versions
+    are picked at run time from those the CPU supports.
+*/
+#if !defined(U_XFORM_REFERENCE) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define U_XFORM_X86 1
+#include <immintrin.h>
+#elif !defined(U_XFORM_REFERENCE) && defined(__aarch64__) && defined(__ARM_NEON)
+#define U_XFORM_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* Min/max of the x and y values in the transformed points, {minX, minY, maxX, maxY} */
+typedef struct {
+   int32_t  i[4];
+   float    f[4];
+} U_XFBOUNDS;
+
+#if U_XFORM_X86
+/* {x,y,x,y,...} -> {x*eM11 + y*eM21 + eDx, x*eM12 + y*eM22 + eDy, ...}, a = {eM11,eM22,...}, b = {eM21,eM12,...}, c = {eDx,eDy,...} */
+__attribute__((target("avx"))) static inline __m256 xf_affine_avx(__m256 v, __m256 a, __m256 b, __m256 c){
+   return(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v, a), _mm256_mul_ps(_mm256_permute_ps(v, 0xB1), b)), c));
+}
+
+/* U_ROUND() of 4 floats, in double precision, as in the scalar code.  |v| + 0.5 is exact for any float. */
+__attribute__((target("avx"))) static inline __m256d xf_round_avx(__m128 f){
+   const __m256d sign = _mm256_set1_pd(-0.0);
+   __m256d d = _mm256_cvtps_pd(f);
+   __m256d r = _mm256_round_pd(_mm256_add_pd(_mm256_andnot_pd(sign, d), _mm256_set1_pd(0.5)), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+   return(_mm256_or_pd(r, _mm256_and_pd(sign, d)));
+}
+
+__attribute__((target("avx"))) static int xf_point_avx(const int32_t *src, int32_t *dst, int count, const U_XFORM *xf, U_XFBOUNDS *bounds){
+   const __m256 a = _mm256_setr_ps(xf->eM11, xf->eM22, xf->eM11, xf->eM22, xf->eM11, xf->eM22, xf->eM11, xf->eM22);
+   const __m256 b = _mm256_setr_ps(xf->eM21, xf->eM12, xf->eM21, xf->eM12, xf->eM21, xf->eM12, xf->eM21, xf->eM12);
+   const __m256 c = _mm256_setr_ps(xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy);
+   __m128i lo, hi, mn = _mm_set1_epi32(INT32_MAX), mx = _mm_set1_epi32(INT32_MIN);
+   __m256  v;
+   int     j;
+   for(j = 0; j + 4 <= count; j += 4){
+      v  = xf_affine_avx(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)(src + 2*j))), a, b, c);
+      lo = _mm256_cvttpd_epi32(xf_round_avx(_mm256_castps256_ps128(v)));
+      hi = _mm256_cvttpd_epi32(xf_round_avx(_mm256_extractf128_ps(v, 1)));
+      _mm_storeu_si128((__m128i *)(dst + 2*j),     lo);
+      _mm_storeu_si128((__m128i *)(dst + 2*j + 4), hi);
+      mn = _mm_min_epi32(mn, _mm_min_epi32(lo, hi));
+      mx = _mm_max_epi32(mx, _mm_max_epi32(lo, hi));
+   }
+   if(bounds && j){
+      mn = _mm_min_epi32(mn, _mm_unpackhi_epi64(mn, mn));
+      mx = _mm_max_epi32(mx, _mm_unpackhi_epi64(mx, mx));
+      bounds->i[0] = _mm_cvtsi128_si32(mn);  bounds->i[1] = _mm_extract_epi32(mn, 1);
+      bounds->i[2] = _mm_cvtsi128_si32(mx);  bounds->i[3] = _mm_extract_epi32(mx, 1);
+   }
+   return(j);
+}
+
+/* The scalar code stores the low 16 bits of the int32 value, so does this. */
+__attribute__((target("avx"))) static int xf_point16_avx(const int16_t *src, int16_t *dst, int count, const U_XFORM *xf, U_XFBOUNDS *bounds){
+   const __m256  a = _mm256_setr_ps(xf->eM11, xf->eM22, xf->eM11, xf->eM22, xf->eM11, xf->eM22, xf->eM11, xf->eM22);
+   const __m256  b = _mm256_setr_ps(xf->eM21, xf->eM12, xf->eM21, xf->eM12, xf->eM21, xf->eM12, xf->eM21, xf->eM12);
+   const __m256  c = _mm256_setr_ps(xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy);
+   const __m128i low16 = _mm_setr_epi8(0,1,4,5,8,9,12,13,-128,-128,-128,-128,-128,-128,-128,-128);
+   __m128i in, lo, hi, out, mn = _mm_set1_epi16(INT16_MAX), mx = _mm_set1_epi16(INT16_MIN);
+   __m256  v;
+   int     j;
+   for(j = 0; j + 4 <= count; j += 4){
+      in  = _mm_loadu_si128((const __m128i *)(src + 2*j));
+      v   = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_cvtepi32_ps(_mm_cvtepi16_epi32(in))),
+               _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_unpackhi_epi64(in, in))), 1);
+      v   = xf_affine_avx(v, a, b, c);
+      lo  = _mm_shuffle_epi8(_mm256_cvttpd_epi32(xf_round_avx(_mm256_castps256_ps128(v))),   low16);
+      hi  = _mm_shuffle_epi8(_mm256_cvttpd_epi32(xf_round_avx(_mm256_extractf128_ps(v, 1))), low16);
+      out = _mm_unpacklo_epi64(lo, hi);
+      _mm_storeu_si128((__m128i *)(dst + 2*j), out);
+      mn  = _mm_min_epi16(mn, out);
+      mx  = _mm_max_epi16(mx, out);
+   }
+   if(bounds && j){
+      mn = _mm_min_epi16(mn, _mm_unpackhi_epi64(mn, mn));
+      mn = _mm_min_epi16(mn, _mm_srli_epi64(mn, 32));
+      mx = _mm_max_epi16(mx, _mm_unpackhi_epi64(mx, mx));
+      mx = _mm_max_epi16(mx, _mm_srli_epi64(mx, 32));
+      bounds->i[0] = (int16_t) _mm_extract_epi16(mn, 0);  bounds->i[1] = (int16_t) _mm_extract_epi16(mn, 1);
+      bounds->i[2] = (int16_t) _mm_extract_epi16(mx, 0);  bounds->i[3] = (int16_t) _mm_extract_epi16(mx, 1);
+   }
+   return(j);
+}
+
+__attribute__((target("avx"))) static int xf_pointf_avx(const float *src, float *dst, int count, const U_XFORM *xf, U_XFBOUNDS *bounds){
+   const __m256 a = _mm256_setr_ps(xf->eM11, xf->eM22, xf->eM11, xf->eM22, xf->eM11, xf->eM22, xf->eM11, xf->eM22);
+   const __m256 b = _mm256_setr_ps(xf->eM21, xf->eM12, xf->eM21, xf->eM12, xf->eM21, xf->eM12, xf->eM21, xf->eM12);
+   const __m256 c = _mm256_setr_ps(xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy);
+   __m128 lo, hi, mn = _mm_set1_ps(HUGE_VALF), mx = _mm_set1_ps(-HUGE_VALF);
+   __m256 v;
+   int    j;
+   for(j = 0; j + 4 <= count; j += 4){
+      v  = xf_affine_avx(_mm256_loadu_ps(src + 2*j), a, b, c);
+      lo = _mm256_cvtpd_ps(xf_round_avx(_mm256_castps256_ps128(v)));
+      hi = _mm256_cvtpd_ps(xf_round_avx(_mm256_extractf128_ps(v, 1)));
+      _mm_storeu_ps(dst + 2*j,     lo);
+      _mm_storeu_ps(dst + 2*j + 4, hi);
+      mn = _mm_min_ps(mn, _mm_min_ps(lo, hi));
+      mx = _mm_max_ps(mx, _mm_max_ps(lo, hi));
+   }
+   if(bounds && j){
+      mn = _mm_min_ps(mn, _mm_movehl_ps(mn, mn));
+      mx = _mm_max_ps(mx, _mm_movehl_ps(mx, mx));
+      _mm_storel_pi((__m64 *) &bounds->f[0], mn);
+      _mm_storel_pi((__m64 *) &bounds->f[2], mx);
+   }
+   return(j);
+}
+
+/* SSE4.1 versions, 2 points at a time */
+__attribute__((target("sse4.1"))) static inline __m128 xf_affine_sse41(__m128 v, __m128 a, __m128 b, __m128 c){
+   return(_mm_add_ps(_mm_add_ps(_mm_mul_ps(v, a), _mm_mul_ps(_mm_shuffle_ps(v, v, 0xB1), b)), c));
+}
+
+__attribute__((target("sse4.1"))) static inline __m128d xf_round_sse41(__m128 f){
+   const __m128d sign = _mm_set1_pd(-0.0);
+   __m128d d = _mm_cvtps_pd(f);
+   __m128d r = _mm_round_pd(_mm_add_pd(_mm_andnot_pd(sign, d), _mm_set1_pd(0.5)), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+   return(_mm_or_pd(r, _mm_and_pd(sign, d)));
+}
+
+__attribute__((target("sse4.1"))) static int xf_point_sse41(const int32_t *src, int32_t *dst, int count, const U_XFORM *xf, U_XFBOUNDS *bounds){
+   const __m128 a = _mm_setr_ps(xf->eM11, xf->eM22, xf->eM11, xf->eM22);
+   const __m128 b = _mm_setr_ps(xf->eM21, xf->eM12, xf->eM21, xf->eM12);
+   const __m128 c = _mm_setr_ps(xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy);
+   __m128i out, mn = _mm_set1_epi32(INT32_MAX), mx = _mm_set1_epi32(INT32_MIN);
+   __m128  v;
+   int     j;
+   for(j = 0; j + 2 <= count; j += 2){
+      v   = xf_affine_sse41(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(src + 2*j))), a, b, c);
+      out = _mm_unpacklo_epi64(_mm_cvttpd_epi32(xf_round_sse41(v)), _mm_cvttpd_epi32(xf_round_sse41(_mm_movehl_ps(v, v))));
+      _mm_storeu_si128((__m128i *)(dst + 2*j), out);
+      mn  = _mm_min_epi32(mn, out);
+      mx  = _mm_max_epi32(mx, out);
+   }
+   if(bounds && j){
+      mn = _mm_min_epi32(mn, _mm_unpackhi_epi64(mn, mn));
+      mx = _mm_max_epi32(mx, _mm_unpackhi_epi64(mx, mx));
+      bounds->i[0] = _mm_cvtsi128_si32(mn);  bounds->i[1] = _mm_extract_epi32(mn, 1);
+      bounds->i[2] = _mm_cvtsi128_si32(mx);  bounds->i[3] = _mm_extract_epi32(mx, 1);
+   }
+   return(j);
+}
+
+__attribute__((target("sse4.1"))) static int xf_point16_sse41(const int16_t *src, int16_t *dst, int count, const U_XFORM *xf, U_XFBOUNDS *bounds){
+   const __m128  a = _mm_setr_ps(xf->eM11, xf->eM22, xf->eM11, xf->eM22);
+   const __m128  b = _mm_setr_ps(xf->eM21, xf->eM12, xf->eM21, xf->eM12);
+   const __m128  c = _mm_setr_ps(xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy);
+   const __m128i low16 = _mm_setr_epi8(0,1,4,5,8,9,12,13,-128,-128,-128,-128,-128,-128,-128,-128);
+   __m128i out, mn = _mm_set1_epi16(INT16_MAX), mx = _mm_set1_epi16(INT16_MIN);
+   __m128  v;
+   int32_t in;
+   int     j;
+   for(j = 0; j + 2 <= count; j += 2){
+      v   = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)(src + 2*j))));
+      v   = xf_affine_sse41(v, a, b, c);
+      out = _mm_shuffle_epi8(_mm_unpacklo_epi64(_mm_cvttpd_epi32(xf_round_sse41(v)), _mm_cvttpd_epi32(xf_round_sse41(_mm_movehl_ps(v, v)))), low16);
+      _mm_storel_epi64((__m128i *)(dst + 2*j), out);
+      mn  = _mm_min_epi16(mn, out);
+      mx  = _mm_max_epi16(mx, out);
+   }
+   if(bounds && j){   // only the low 4 lanes hold points, the others are 0
+      mn = _mm_min_epi16(mn, _mm_srli_epi64(mn, 32));
+      mx = _mm_max_epi16(mx, _mm_srli_epi64(mx, 32));
+      in = _mm_cvtsi128_si32(mn);  bounds->i[0] = (int16_t)(in & 0xFFFF);  bounds->i[1] = (int16_t)((uint32_t) in >> 16);
+      in = _mm_cvtsi128_si32(mx);  bounds->i[2] = (int16_t)(in & 0xFFFF);  bounds->i[3] = (int16_t)((uint32_t) in >> 16);
+   }
+   return(j);
+}
+
+__attribute__((target("sse4.1"))) static int xf_pointf_sse41(const float *src, float *dst, int count, const U_XFORM *xf, U_XFBOUNDS *bounds){
+   const __m128 a = _mm_setr_ps(xf->eM11, xf->eM22, xf->eM11, xf->eM22);
+   const __m128 b = _mm_setr_ps(xf->eM21, xf->eM12, xf->eM21, xf->eM12);
+   const __m128 c = _mm_setr_ps(xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy);
+   __m128 v, out, mn = _mm_set1_ps(HUGE_VALF), mx = _mm_set1_ps(-HUGE_VALF);
+   int    j;
+   for(j = 0; j + 2 <= count; j += 2){
+      v   = xf_affine_sse41(_mm_loadu_ps(src + 2*j), a, b, c);
+      out = _mm_movelh_ps(_mm_cvtpd_ps(xf_round_sse41(v)), _mm_cvtpd_ps(xf_round_sse41(_mm_movehl_ps(v, v))));
+      _mm_storeu_ps(dst + 2*j, out);
+      mn  = _mm_min_ps(mn, out);
+      mx  = _mm_max_ps(mx, out);
+   }
+   if(bounds && j){
+      mn = _mm_min_ps(mn, _mm_movehl_ps(mn, mn));
+      mx = _mm_max_ps(mx, _mm_movehl_ps(mx, mx));
+      _mm_storel_pi((__m64 *) &bounds->f[0], mn);
+      _mm_storel_pi((__m64 *) &bounds->f[2], mx);
+   }
+   return(j);
+}
+#endif /* U_XFORM_X86 */
+
+#if U_XFORM_NEON
+/* vrndaq_f64 rounds half away from zero, which is U_ROUND() for values which came from a float. */
+static inline float32x4_t xf_affine_neon(float32x4_t v, float32x4_t a, float32x4_t b, float32x4_t c){
+   return(vaddq_f32(vaddq_f32(vmulq_f32(v, a), vmulq_f32(vrev64q_f32(v), b)), c));
+}
+
+static int xf_point_neon(const int32_t *src, int32_t *dst, int count, const U_XFORM *xf, U_XFBOUNDS *bounds){
+   const float32x4_t a = { xf->eM11, xf->eM22, xf->eM11, xf->eM22 };
+   const float32x4_t b = { xf->eM21, xf->eM12, xf->eM21, xf->eM12 };
+   const float32x4_t c = { xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy  };
+   int32x4_t   out, mn = vdupq_n_s32(INT32_MAX), mx = vdupq_n_s32(INT32_MIN);
+   float32x4_t v;
+   int         j;
+   for(j = 0; j + 2 <= count; j += 2){
+      v   = xf_affine_neon(vcvtq_f32_s32(vld1q_s32(src + 2*j)), a, b, c);
+      out = vcombine_s32(vmovn_s64(vcvtq_s64_f64(vrndaq_f64(vcvt_f64_f32(vget_low_f32(v))))),
+                         vmovn_s64(vcvtq_s64_f64(vrndaq_f64(vcvt_high_f64_f32(v)))));
+      vst1q_s32(dst + 2*j, out);
+      mn  = vminq_s32(mn, out);
+      mx  = vmaxq_s32(mx, out);
+   }
+   if(bounds && j){
+      int32x2_t m = vmin_s32(vget_low_s32(mn), vget_high_s32(mn));
+      int32x2_t M = vmax_s32(vget_low_s32(mx), vget_high_s32(mx));
+      bounds->i[0] = vget_lane_s32(m, 0);  bounds->i[1] = vget_lane_s32(m, 1);
+      bounds->i[2] = vget_lane_s32(M, 0);  bounds->i[3] = vget_lane_s32(M, 1);
+   }
+   return(j);
+}
+
+static int xf_point16_neon(const int16_t *src, int16_t *dst, int count, const U_XFORM *xf, U_XFBOUNDS *bounds){
+   const float32x4_t a = { xf->eM11, xf->eM22, xf->eM11, xf->eM22 };
+   const float32x4_t b = { xf->eM21, xf->eM12, xf->eM21, xf->eM12 };
+   const float32x4_t c = { xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy  };
+   int16x4_t   out, mn = vdup_n_s16(INT16_MAX), mx = vdup_n_s16(INT16_MIN);
+   float32x4_t v;
+   int         j;
+   for(j = 0; j + 2 <= count; j += 2){
+      v   = xf_affine_neon(vcvtq_f32_s32(vmovl_s16(vld1_s16(src + 2*j))), a, b, c);
+      out = vmovn_s32(vcombine_s32(vmovn_s64(vcvtq_s64_f64(vrndaq_f64(vcvt_f64_f32(vget_low_f32(v))))),
+                                   vmovn_s64(vcvtq_s64_f64(vrndaq_f64(vcvt_high_f64_f32(v))))));
+      vst1_s16(dst + 2*j, out);
+      mn  = vmin_s16(mn, out);
+      mx  = vmax_s16(mx, out);
+   }
+   if(bounds && j){
+      mn = vmin_s16(mn, vext_s16(mn, mn, 2));
+      mx = vmax_s16(mx, vext_s16(mx, mx, 2));
+      bounds->i[0] = vget_lane_s16(mn, 0);  bounds->i[1] = vget_lane_s16(mn, 1);
+      bounds->i[2] = vget_lane_s16(mx, 0);  bounds->i[3] = vget_lane_s16(mx, 1);
+   }
+   return(j);
+}
+
+static int xf_pointf_neon(const float *src, float *dst, int count, const U_XFORM *xf, U_XFBOUNDS *bounds){
+   const float32x4_t a = { xf->eM11, xf->eM22, xf->eM11, xf->eM22 };
+   const float32x4_t b = { xf->eM21, xf->eM12, xf->eM21, xf->eM12 };
+   const float32x4_t c = { xf->eDx,  xf->eDy,  xf->eDx,  xf->eDy  };
+   float32x4_t v, out, mn = vdupq_n_f32(HUGE_VALF), mx = vdupq_n_f32(-HUGE_VALF);
+   int         j;
+   for(j = 0; j + 2 <= count; j += 2){
+      v   = xf_affine_neon(vld1q_f32(src + 2*j), a, b, c);
+      out = vcvt_high_f32_f64(vcvt_f32_f64(vrndaq_f64(vcvt_f64_f32(vget_low_f32(v)))), vrndaq_f64(vcvt_high_f64_f32(v)));
+      vst1q_f32(dst + 2*j, out);
+      mn  = vminq_f32(mn, out);
+      mx  = vmaxq_f32(mx, out);
+   }
+   if(bounds && j){
+      float32x2_t m = vmin_f32(vget_low_f32(mn), vget_high_f32(mn));
+      float32x2_t M = vmax_f32(vget_low_f32(mx), vget_high_f32(mx));
+      bounds->f[0] = vget_lane_f32(m, 0);  bounds->f[1] = vget_lane_f32(m, 1);
+      bounds->f[2] = vget_lane_f32(M, 0);  bounds->f[3] = vget_lane_f32(M, 1);
+   }
+   return(j);
+}
+#endif /* U_XFORM_NEON */
+
+/* Pick the widest kernel for the CPU, returns the number of points done. */
+static int xf_kernel(const void *src, void *dst, int count, int kind, const U_XFORM *xf, U_XFBOUNDS *bounds){
+#if U_XFORM_X86
+   switch(kind){
+      case U_XF_POINT:
+         if(__builtin_cpu_supports("avx"))   return(xf_point_avx(  (const int32_t *) src, (int32_t *) dst, count, xf, bounds));
+         if(__builtin_cpu_supports("sse4.1"))return(xf_point_sse41((const int32_t *) src, (int32_t *) dst, count, xf, bounds));
+         break;
+      case U_XF_POINT16:
+         if(__builtin_cpu_supports("avx"))   return(xf_point16_avx(  (const int16_t *) src, (int16_t *) dst, count, xf, bounds));
+         if(__builtin_cpu_supports("sse4.1"))return(xf_point16_sse41((const int16_t *) src, (int16_t *) dst, count, xf, bounds));
+         break;
+      case U_XF_POINTF:
+         if(__builtin_cpu_supports("avx"))   return(xf_pointf_avx(  (const float *) src, (float *) dst, count, xf, bounds));
+         if(__builtin_cpu_supports("sse4.1"))return(xf_pointf_sse41((const float *) src, (float *) dst, count, xf, bounds));
+         break;
+   }
+#elif U_XFORM_NEON
+   switch(kind){
+      case U_XF_POINT:   return(xf_point_neon(  (const int32_t *) src, (int32_t *) dst, count, xf, bounds));
+      case U_XF_POINT16: return(xf_point16_neon((const int16_t *) src, (int16_t *) dst, count, xf, bounds));
+      case U_XF_POINTF:  return(xf_pointf_neon( (const float *)   src, (float *)   dst, count, xf, bounds));
+   }
+#else
+   (void) src; (void) dst; (void) count; (void) kind; (void) xf; (void) bounds;
+#endif
+   return(0);
+}
+//! \endcond
+
+/**
+    \brief Transform an array of x,y pairs with a U_XFORM, rounding the results as U_ROUND() does.  
+    Used by points_transform_into(), point16_transform_into(), and pointfs_transform_into(), end user code
+    should call those instead.
+    \return 0 for success, >=1 for failure.
+    \param src     source pairs
+    \param dst     transformed pairs, may be the same as src
+    \param count   number of pairs
+    \param kind    U_XF_POINT (int32_t pairs), U_XF_POINT16 (int16_t pairs), or U_XF_POINTF (float pairs)
+    \param xform   U_XFORM to apply
+    \param bounds  if not NULL, receives {minX, minY, maxX, maxY} of the transformed pairs, 0s if count is 0
+*/
+int U_xform_pairs(const void *src, void *dst, int count, int kind, U_XFORM xform, double *bounds){
+   U_XFBOUNDS kb;
+   double     X, Y;
+   float      x, y;
+   int        i, done;
+
+   if(!src || !dst || count < 0 || kind < U_XF_POINT || kind > U_XF_POINTF)return(1);
+   if(bounds){
+      bounds[0] = bounds[1] = HUGE_VAL;
+      bounds[2] = bounds[3] = -HUGE_VAL;
+   }
+   done = xf_kernel(src, dst, count, kind, &xform, (bounds ? &kb : NULL));
+   if(bounds && done){
+      for(i = 0; i < 4; i++){ bounds[i] = (kind == U_XF_POINTF ? (double) kb.f[i] : (double) kb.i[i]); }
+   }
+   for(i = done; i < count; i++){
+      switch(kind){
+         case U_XF_POINT:   x = (float) ((const int32_t *) src)[2*i];  y = (float) ((const int32_t *) src)[2*i + 1];  break;
+         case U_XF_POINT16: x = (float) ((const int16_t *) src)[2*i];  y = (float) ((const int16_t *) src)[2*i + 1];  break;
+         default:           x = ((const float *) src)[2*i];            y = ((const float *) src)[2*i + 1];            break;
+      }
+      X = U_ROUND(x * xform.eM11 + y * xform.eM21 + xform.eDx);
+      Y = U_ROUND(x * xform.eM12 + y * xform.eM22 + xform.eDy);
+      switch(kind){
+         case U_XF_POINT:   ((int32_t *) dst)[2*i] = X;  ((int32_t *) dst)[2*i + 1] = Y;  X = ((int32_t *) dst)[2*i];  Y = ((int32_t *) dst)[2*i + 1];  break;
+         case U_XF_POINT16: ((int16_t *) dst)[2*i] = X;  ((int16_t *) dst)[2*i + 1] = Y;  X = ((int16_t *) dst)[2*i];  Y = ((int16_t *) dst)[2*i + 1];  break;
+         default:           ((float *)   dst)[2*i] = X;  ((float *)   dst)[2*i + 1] = Y;  X = ((float *)   dst)[2*i];  Y = ((float *)   dst)[2*i + 1];  break;
+      }
+      if(bounds){
+         if(X < bounds[0])bounds[0] = X;
+         if(Y < bounds[1])bounds[1] = Y;
+         if(X > bounds[2])bounds[2] = X;
+         if(Y > bounds[3])bounds[3] = Y;
+      }
+   }
+   if(bounds && !count)bounds[0] = bounds[1] = bounds[2] = bounds[3] = 0.0;
+   return(0);
+}
+
+/**
+    \brief Transform an array of U_POINT with a U_XFORM into a caller supplied array, or in place, optionally finding their bounds
+    in the same pass.  The results are the same as from points_transform().
+    \return 0 for success, >=1 for failure.
+    \param src     source U_POINT structures
+    \param dst     transformed U_POINT structures, may be the same as src
+    \param count   number of members in src
+    \param xform   U_XFORM to apply
+    \param bounds  if not NULL, receives the bounding rectangle of the transformed points
+    
+    May also be used to transform U_RECT by doubling the count and casting the pointer, the bounds are then those of the corners.
+*/
+int points_transform_into(const U_POINT *src, U_POINT *dst, int count, U_XFORM xform, PU_RECTL bounds){
+   double b[4];
+   if(U_xform_pairs(src, dst, count, U_XF_POINT, xform, (bounds ? b : NULL)))return(1);
+   if(bounds)*bounds = rectl_set(point32_set(b[0], b[1]), point32_set(b[2], b[3]));
+   return(0);
+}
+
+/**
+    \brief Transform an array of U_POINT16 with a U_XFORM into a caller supplied array, or in place, optionally finding their bounds
+    in the same pass.  The results are the same as from point16_transform().
+    \return 0 for success, >=1 for failure.
+    \param src     source U_POINT16 structures
+    \param dst     transformed U_POINT16 structures, may be the same as src
+    \param count   number of members in src
+    \param xform   U_XFORM to apply
+    \param bounds  if not NULL, receives the bounding rectangle of the transformed points
+*/
+int point16_transform_into(const U_POINT16 *src, U_POINT16 *dst, int count, U_XFORM xform, PU_RECTL bounds){
+   double b[4];
+   if(U_xform_pairs(src, dst, count, U_XF_POINT16, xform, (bounds ? b : NULL)))return(1);
+   if(bounds)*bounds = rectl_set(point32_set(b[0], b[1]), point32_set(b[2], b[3]));
+   return(0);
+}
+
+/**
+    \brief Transform an array of U_TRIVERTEX with a U_XFORM into a caller supplied array, or in place, optionally finding their bounds
+    in the same pass.  The results are the same as from trivertex_transform().
+    \return 0 for success, >=1 for failure.
+    \param src     source U_TRIVERTEX structures
+    \param dst     transformed U_TRIVERTEX structures, may be the same as src but must not otherwise overlap it
+    \param count   number of members in src
+    \param xform   U_XFORM to apply
+    \param bounds  if not NULL, receives the bounding rectangle of the transformed points
+    
+    Gradients have few vertices and the colors are interleaved with the coordinates, so this does not use the vector kernels.
+*/
+int trivertex_transform_into(const U_TRIVERTEX *src, U_TRIVERTEX *dst, int count, U_XFORM xform, PU_RECTL bounds){
+   U_POINT pt;
+   U_RECTL b;
+   int     i;
+   if(!src || !dst || count < 0)return(1);
+   for(i = 0; i < count; i++){
+      pt.x = src[i].x;
+      pt.y = src[i].y;
+      if(dst != src)dst[i] = src[i];
+      (void) points_transform_into(&pt, &pt, 1, xform, (bounds ? &b : NULL));
+      dst[i].x = pt.x;
+      dst[i].y = pt.y;
+      if(bounds){
+         if(!i){ *bounds = b; }
+         else {
+            if(b.left   < bounds->left  )bounds->left   = b.left;
+            if(b.top    < bounds->top   )bounds->top    = b.top;
+            if(b.right  > bounds->right )bounds->right  = b.right;
+            if(b.bottom > bounds->bottom)bounds->bottom = b.bottom;
+         }
+      }
+   }
+   if(bounds && !count)*bounds = rectl_set(point32_set(0, 0), point32_set(0, 0));
+   return(0);
+}
+
+/**
+    \brief Allocate and construct an array of U_POINT objects which has been subjected to a U_XFORM
+    \returns pointer to an array of U_POINT structures.
+    \param points  pointer to the source U_POINT structures
+    \param count   number of members in points
+    \param xform   U_XFORM to apply
+    
+    May also be used to modify U_RECT by doubling the count and casting the pointer.
+*/
+PU_POINT points_transform(PU_POINT points, int count, U_XFORM xform){
+   PU_POINT newpts;
+   newpts = (PU_POINT) malloc(count * sizeof(U_POINT));
+   if(newpts)(void) points_transform_into(points, newpts, count, xform, NULL);
+   return(newpts);
+}
+
+/**
+    \brief Allocate and construct an array of U_POINT16 objects  which has been subjected to a U_XFORM
+    \returns pointer to an array of U_POINT16 structures.
+    \param points  pointer to the source U_POINT16 structures
+    \param count   number of members in points
+    \param xform   U_XFORM to apply
+    
+    Transformed src points {x0,y0} appear at {x0*xscale + x, y0*yscale + y}
+*/
+PU_POINT16 point16_transform(PU_POINT16 points, int count, U_XFORM xform){
+   PU_POINT16 newpts;
+   newpts = (PU_POINT16) malloc(count * sizeof(U_POINT16));
+   if(newpts)(void) point16_transform_into(points, newpts, count, xform, NULL);
+   return(newpts);
+}
+
+/**
+    \brief Allocate and construct an array of U_TRIVERTEX objects  which has been subjected to a U_XFORM
+    \returns pointer to an array of U_TRIVERTEX structures.
+    \param tv  pointer to the source U_TRIVERTEX structures
+    \param count   number of members in points
+    \param xform   U_XFORM to apply
+    
+    Transformed Trivertex points {x0,y0} appear at {x0*xscale + x, y0*yscale + y}
+*/
+PU_TRIVERTEX trivertex_transform(PU_TRIVERTEX tv, int count, U_XFORM xform){
+   PU_TRIVERTEX newtvs;
+   newtvs = (PU_TRIVERTEX) malloc(count * sizeof(U_TRIVERTEX));
+   if(newtvs)(void) trivertex_transform_into(tv, newtvs, count, xform, NULL);
+   return(newtvs);
+}
+
+/**
+    \brief Allocate and construct an array of U_POINT objects from a set of U_POINT16 objects
+    \returns pointer to an array of U_POINT structures.
+    \param points  pointer to the source U_POINT16 structures
+    \param count   number of members in points
+    
+*/
+PU_POINT point16_to_point(PU_POINT16 points, int count){
+   PU_POINT newpts;
+   int i;
+   newpts = (PU_POINT) malloc(count * sizeof(U_POINT));
+   for(i=0; i<count; i++){
+      newpts[i].x = points[i].x;
+      newpts[i].y = points[i].y;
+   }
+   return(newpts);
+}
+
+/**
+    \brief Allocate and construct an array of U_POINT16 objects from a set of U_POINT objects
+    \returns pointer to an array of U_POINT16 structures.
+    \param points  pointer to the source U_POINT structures
+    \param count   number of members in points
+    
+    If a coordinate is out of range it saturates at boundary.
+*/
+PU_POINT16 point_to_point16(PU_POINT points, int count){
+   PU_POINT16 newpts;
+   int i;
+   newpts = (PU_POINT16) malloc(count * sizeof(U_POINT16));
+   for(i=0; i<count; i++){
+      newpts[i].x = U_MNMX(points[i].x, INT16_MIN, INT16_MAX);
+      newpts[i].y = U_MNMX(points[i].y, INT16_MIN, INT16_MAX);
+   }
+   return(newpts);
+}
+
+// hide these from Doxygen
+//! @cond
+/* **********************************************************************************************
+These functions contain shared code used by various U_EMR*_set functions.  These should NEVER be called
+by end user code and to further that end prototypes are NOT provided and they are hidden from Doxygen.
+
+
+   These are (mostly) ordered by U_EMR_* index number.
+   For all _set functions the caller must eventually call free() on the returned pointer.
+   
+    CORE1(uint32_t iType, U_RECTL rclBounds, const uint32_t cptl, const U_POINTL *points){
+    CORE2(uint32_t iType, U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts,const uint32_t cptl, const U_POINTL *points){
+    CORE3(uint32_t iType, uint32_t iMode){       (generic 1 uint)
+    CORE4(uint32_t iType, U_RECTL rclBox){
+    CORE5(uint32_t iType){                       (generic noargs)
+    CORE6(uint32_t iType, U_RECTL rclBounds, const uint32_t cpts, const U_POINT16 *points){  (16bit form of CORE1)
+    CORE7(uint32_t iType, U_PAIR pair){
+    CORE8(uint32_t iType, U_RECTL rclBounds, uint32_t iGraphicsMode, U_FLOAT exScale, U_FLOAT eyScale, PU_EMRTEXT emrtext){ 
+    CORE9(uint32_t iType, U_RECTL rclBox, U_POINTL ptlStart, U_POINTL ptlEnd){
+    CORE10(uint32_t iType, U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts,const uint32_t cpts, const U_POINT16 *points){ (16bit form of CORE2)
+    CORE11(uint32_t iType, PU_RGNDATA RgnData){
+    CORE12(uint32_t iType, uint32_t ihBrush, uint32_t iUsage, PU_BITMAPINFO Bmi){
+    CORE13(uint32_t iType, U_RECTL rclBounds, U_POINTL Dest, U_POINTL cDest, 
+              U_POINTL Src, U_POINTL cSrc, U_XFORM xformSrc, U_COLORREF crBkColorSrc, uint32_t iUsageSrc, 
+              uint32_t Data, PU_BITMAPINFO Bmi);
+              
+   Each CORE function also takes an EMFTRACK as its first argument.  If that is NULL the record is malloc()'d and 
+   returned, otherwise it is constructed directly at the end of the EMF in memory (see the *_emplace functions).
+*********************************************************************************************** */
+
+/* Storage for a record being constructed by a U_EMR_CORE*_set function.  If et is NULL it is malloc()'d,
+   otherwise it is reserved at the end of et->buf (streaming EMFs use a malloc()'d record) and is only
+   added to the EMF by U_EMR_CORE_commit().  */
+static char *U_EMR_CORE_alloc(EMFTRACK *et, int irecsize){
+   if(!et || et->stream)return(malloc(irecsize));
+   if(emf_grow(et, irecsize))return(NULL);
+   return(et->buf + et->used);
+}
+
+/* Finish a record from U_EMR_CORE_alloc(), for et != NULL it is appended to the EMF in memory.  Returns NULL on failure. */
+static char *U_EMR_CORE_commit(EMFTRACK *et, char *record){
+   if(!et || !record)return(record);
+   if(et->stream){
+      if(emf_append((PU_ENHMETARECORD) record, et, U_REC_FREE)){
+         free(record);
+         return(NULL);
+      }
+   }
+   else {
+#ifdef U_VALGRIND
+      printf("\nbefore \n");
+      printf(" probe %d\n",memprobe(record, U_EMRSIZE(record)));
+      printf("after \n");
+#endif
+      et->used += ((PU_EMR) record)->nSize;
+      et->records++;
+      et->open = 0;  // an open record is no longer the last one
+   }
+   return(record);
+}
+
+
+// Functions with the same form starting with U_EMRPOLYBEZIER_set
+char *U_EMR_CORE1_set(EMFTRACK *et, uint32_t iType, U_RECTL rclBounds, const uint32_t cptl, const U_POINTL *points){
+   char *record;
+   int   cbPoints;
+   int   irecsize;
+
+   cbPoints    = sizeof(U_POINTL)*cptl;
+   irecsize = sizeof(U_EMRPOLYBEZIER) + cbPoints - sizeof(U_POINTL); // First instance is in struct
+   record    = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)           record)->iType     = iType;
+      ((PU_EMR)           record)->nSize     = irecsize;
+      ((PU_EMRPOLYBEZIER) record)->rclBounds = rclBounds;
+      ((PU_EMRPOLYBEZIER) record)->cptl      = cptl;
+      memcpy(((PU_EMRPOLYBEZIER) record)->aptl,points,cbPoints);
+   }
+   return(U_EMR_CORE_commit(et, record));
+} 
+
+// Functions with the same form starting with U_EMR_POLYPOLYLINE
+char *U_EMR_CORE2_set(EMFTRACK *et, uint32_t iType, U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts,const uint32_t cptl, const U_POINTL *points){
+   char *record;
+   int   cbPolys,cbPoints,off;
+   int   irecsize;
+
+   cbPoints    = sizeof(U_POINTL)*cptl;
+   cbPolys    = sizeof(uint32_t)*nPolys;
+   irecsize = sizeof(U_EMRPOLYPOLYLINE) + cbPoints + cbPolys - sizeof(uint32_t); // First instance of each is in struct
+   record   = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)             record)->iType     = iType;
+      ((PU_EMR)             record)->nSize     = irecsize;
+      ((PU_EMRPOLYPOLYLINE) record)->rclBounds = rclBounds;
+      ((PU_EMRPOLYPOLYLINE) record)->nPolys    = nPolys;
+      ((PU_EMRPOLYPOLYLINE) record)->cptl      = cptl;
+      memcpy(((PU_EMRPOLYPOLYLINE) record)->aPolyCounts,aPolyCounts,cbPolys); 
+      off = sizeof(U_EMRPOLYPOLYLINE) - 4 + cbPolys;
+      memcpy(record + off,points,cbPoints);   
+   }
+   return(U_EMR_CORE_commit(et, record));
+} 
+
+// Functions with the same form starting with U_EMR_SETMAPMODE_set
+char *U_EMR_CORE3_set(EMFTRACK *et, uint32_t iType, uint32_t iMode){
+   char *record;
+   int   irecsize;
+
+   irecsize = sizeof(U_EMRSETMAPMODE);
+   record   = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)          record)->iType     = iType;
+      ((PU_EMR)          record)->nSize     = irecsize;
+      ((PU_EMRSETMAPMODE)record)->iMode     = iMode;
+   }
+   return(U_EMR_CORE_commit(et, record));
+} 
+
+// Functions taking a single U_RECT or U_RECTL, starting with U_EMRELLIPSE_set, also U_EMRFILLPATH, 
+char *U_EMR_CORE4_set(EMFTRACK *et, uint32_t iType, U_RECTL rclBox){
+   char *record;
+   int   irecsize;
+
+   irecsize = sizeof(U_EMRELLIPSE);
+   record   = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      memset(record,0,irecsize);
+      ((PU_EMR)       record)->iType  = iType;
+      ((PU_EMR)       record)->nSize  = irecsize;
+      ((PU_EMRELLIPSE)record)->rclBox = rclBox;  // bounding rectangle in logical units
+   }
+   return(U_EMR_CORE_commit(et, record));
+} 
+
+// Functions with the same form starting with U_EMRSETMETARGN_set
+char *U_EMR_CORE5_set(EMFTRACK *et, uint32_t iType){
+   char *record;
+   int   irecsize = 8;
+
+   record   = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)       record)->iType  = iType;
+      ((PU_EMR)       record)->nSize  = irecsize;
+   }
+   return(U_EMR_CORE_commit(et, record));
+}
+
+// Functions with the same form starting with U_EMRPOLYBEZIER16_set
+char *U_EMR_CORE6_set(EMFTRACK *et, uint32_t iType, U_RECTL rclBounds, const uint32_t cpts, const U_POINT16 *points){
+   char *record;
+   int   cbPoints,cbPoints4,off;
+   int   irecsize;
+
+   cbPoints   = sizeof(U_POINT16)*cpts;
+   cbPoints4   = UP4(cbPoints);
+   off      = sizeof(U_EMR) + sizeof(U_RECTL) + sizeof(U_NUM_POINT16); // offset to the start of the variable region
+   irecsize = off + cbPoints4; // First instance is in struct
+   record    = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)             record)->iType     = iType;
+      ((PU_EMR)             record)->nSize     = irecsize;
+      ((PU_EMRPOLYBEZIER16) record)->rclBounds = rclBounds;
+      ((PU_EMRPOLYBEZIER16) record)->cpts      = cpts;
+      memcpy(record + off, points, cbPoints);
+      if(cbPoints < cbPoints4){
+         off += cbPoints;
+         memset(record + off, 0, cbPoints4 - cbPoints);
+      }
+   }
+   return(U_EMR_CORE_commit(et, record));
+} 
+
+
+// Functions that take a single struct argument which contains two uint32_t, starting with U_EMRSETWINDOWEXTEX_set
+// these all pass two 32 bit ints and are cast by the caller to U_PAIR
+char *U_EMR_CORE7_set(EMFTRACK *et, uint32_t iType, U_PAIR pair){
+   char *record;
+   int   irecsize = sizeof(U_EMRGENERICPAIR);
+
+   record   = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)           record)->iType   = iType;
+      ((PU_EMR)           record)->nSize   = irecsize;
+      ((PU_EMRGENERICPAIR)record)->pair    = pair;
+   }
+   return(U_EMR_CORE_commit(et, record));
+}
+
+// For U_EMREXTTEXTOUTA and U_EMREXTTEXTOUTW
+char *U_EMR_CORE8_set(
+       EMFTRACK           *et,
+       uint32_t            iType,
+       U_RECTL             rclBounds,          // Bounding rectangle in device units
+       uint32_t            iGraphicsMode,      // Graphics mode Enumeration
+       U_FLOAT             exScale,            // scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
+       U_FLOAT             eyScale,            // scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
+       PU_EMRTEXT          emrtext             // Text parameters
+   ){
+   char *record;
+   int   irecsize,cbString,cbString4,cbDx,cbEmrtext,cbEmrtextAll;
+   uint32_t *loffDx;
+   int  csize;
+   
+   if(     iType == U_EMR_EXTTEXTOUTA){ csize = 1; } // how many bytes per character
+   else if(iType == U_EMR_EXTTEXTOUTW){ csize = 2; }
+   else { return(NULL); }
+ 
+   cbString = csize * emrtext->nChars;
+   cbString4 = UP4(cbString);                                   // size of the string buffer
+   cbEmrtext = sizeof(U_EMRTEXT);                             // size of the constant part of the U_EMRTEXT structure
+   if(!(emrtext->fOptions & U_ETO_NO_RECT)){ cbEmrtext += sizeof(U_RECTL); } // plus the variable U_RECTL, when it is present
+   cbDx = emrtext->nChars * sizeof(int32_t);             // size of Dx buffer
+   if(emrtext->fOptions & U_ETO_PDY)cbDx += cbDx;      // size of Dx buffer when both x and y offsets are used
+   cbEmrtextAll = cbEmrtext + sizeof(uint32_t) + cbString4 + cbDx;   // structure (+- rect) + offDx + string buf + dx buf + offDx
+   
+   /* adjust offset fields in emrtext to match the EMRTEXTOUT* field, currently they match EMRTEXT.
+      This works because the variable pieces have all been moved outside of the U_EMRTEXT and U_EMRTEXTOUTA strutures.
+   */
+   ((PU_EMRTEXT)emrtext)->offString  += sizeof(U_EMREXTTEXTOUTA) - sizeof(U_EMRTEXT);   // adjust offString
+    loffDx = (uint32_t *)((char *)emrtext + cbEmrtext);
+    *loffDx += sizeof(U_EMREXTTEXTOUTA) - sizeof(U_EMRTEXT);
+
+   // final record size is: U_EMREXTTEXTOUTA (includes constant part of U_EMRTEXT) + U_RECTL (if present) + offDx + dx buffer + string buffer
+   irecsize = sizeof(U_EMREXTTEXTOUTA) + cbEmrtextAll - sizeof(U_EMRTEXT); // do not count core emrtext strcture twice
+   record    = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)            record)->iType         = iType;
+      ((PU_EMR)            record)->nSize         = irecsize;
+      ((PU_EMREXTTEXTOUTA) record)->iGraphicsMode = iGraphicsMode;
+      ((PU_EMREXTTEXTOUTA) record)->rclBounds     = rclBounds;
+      ((PU_EMREXTTEXTOUTA) record)->exScale       = exScale;
+      ((PU_EMREXTTEXTOUTA) record)->eyScale       = eyScale;
+      // copy the adjusted U_EMRTEXT into the emrtext part of the full record..
+      memcpy(&(((PU_EMREXTTEXTOUTA) record)->emrtext), emrtext, cbEmrtextAll);
+   }
+   return(U_EMR_CORE_commit(et, record));
+} 
+
+// Functions that take a rect and a pair of points, starting with U_EMRARC_set
+char *U_EMR_CORE9_set(EMFTRACK *et, uint32_t iType, U_RECTL rclBox, U_POINTL ptlStart, U_POINTL ptlEnd){
+   char *record;
+   int   irecsize = sizeof(U_EMRARC);
+
+   record   = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)           record)->iType    = iType;
+      ((PU_EMR)           record)->nSize    = irecsize;
+      ((PU_EMRARC)        record)->rclBox   = rclBox;
+      ((PU_EMRARC)        record)->ptlStart = ptlStart;
+      ((PU_EMRARC)        record)->ptlEnd   = ptlEnd;
+   }
+   return(U_EMR_CORE_commit(et, record));
+}
+
+// Functions with the same form starting with U_EMR_POLYPOLYLINE16
+char *U_EMR_CORE10_set(EMFTRACK *et, uint32_t iType, U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts,const uint32_t cpts, const U_POINT16 *points){
+   char *record;
+   int   cbPoints,cbPolys,off;
+   int   irecsize;
+
+   cbPolys  = sizeof(uint32_t)*nPolys;
+   cbPoints = sizeof(U_POINT16)*cpts;
+   irecsize = sizeof(U_EMRPOLYPOLYLINE16) + cbPoints + cbPolys - sizeof(uint32_t); // First instance of each is in struct
+   record   = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)               record)->iType     = iType;
+      ((PU_EMR)               record)->nSize     = irecsize;
+      ((PU_EMRPOLYPOLYLINE16) record)->rclBounds = rclBounds;
+      ((PU_EMRPOLYPOLYLINE16) record)->nPolys    = nPolys;
+      ((PU_EMRPOLYPOLYLINE16) record)->cpts      = cpts;
+      memcpy(((PU_EMRPOLYPOLYLINE16) record)->aPolyCounts,aPolyCounts,cbPolys); 
+      off = sizeof(U_EMRPOLYPOLYLINE16) - 4 + cbPolys;
+      memcpy(record + off,points,cbPoints);   
+   }
+   return(U_EMR_CORE_commit(et, record));
+} 
+
+// common code for U_EMRINVERTRGN and U_EMRPAINTRGN,
+char *U_EMR_CORE11_set(EMFTRACK *et, uint32_t iType, PU_RGNDATA RgnData){
+   char *record;
+   int   irecsize;
+   int   cbRgns,cbRgns4,rds,rds4,off;
+
+   if(!RgnData)return(NULL);
+   cbRgns   = ((PU_RGNDATAHEADER) RgnData)->nRgnSize;
+   cbRgns4  = UP4(cbRgns);
+   rds      = sizeof(U_RGNDATAHEADER) + cbRgns;
+   rds4     = UP4(rds);
+   irecsize = sizeof(U_EMRINVERTRGN) - sizeof(U_RECTL) + cbRgns4;  // core + array - overlap of one rectL
+   record    = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)           record)->iType     = iType;
+      ((PU_EMR)           record)->nSize     = irecsize;
+      ((PU_EMRINVERTRGN)  record)->rclBounds = ((PU_RGNDATAHEADER) RgnData)->rclBounds;
+      ((PU_EMRINVERTRGN)  record)->cbRgnData = rds;
+      off = sizeof(U_EMRINVERTRGN) - sizeof(U_RGNDATA);
+      memcpy(record + off, RgnData, rds);
+      off += rds;
+      if(rds < rds4){ memset(record + off,0, rds4 - rds); } // clear any unused bytes
+   }
+   return(U_EMR_CORE_commit(et, record));
+} 
+
+
+// common code for U_EMRCREATEMONOBRUSH_set and U_EMRCREATEDIBPATTERNBRUSHPT_set,
+char *U_EMR_CORE12_set(
+       EMFTRACK           *et,
+       uint32_t            iType,
+       uint32_t            ihBrush,            // Index to place object in EMF object table (this entry must not yet exist)
+       uint32_t            iUsage,             // DIBcolors Enumeration
+       PU_BITMAPINFO       Bmi,                // (Optional) bitmapbuffer (U_BITMAPINFO + pixel array)
+       const uint32_t      cbPx,               // Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+       const char         *Px                  // (Optional) bitmapbuffer (pixel array section )
+   ){
+   char *record;
+   int   irecsize;
+   int   cbImage,cbImage4,cbBmi,off;
+
+   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
+   
+   irecsize = sizeof(U_EMRCREATEMONOBRUSH) + cbBmi + cbImage4;
+   record   = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)                      record)->iType   = iType;                        
+      ((PU_EMR)                      record)->nSize   = irecsize;                     
+      ((PU_EMRCREATEMONOBRUSH)       record)->ihBrush = ihBrush;                      
+      ((PU_EMRCREATEMONOBRUSH)       record)->iUsage  = iUsage;                       
+      if(cbBmi){
+         off = sizeof(U_EMRCREATEMONOBRUSH);
+         memcpy(record + off, Bmi, cbBmi);
+         ((PU_EMRCREATEMONOBRUSH)    record)->offBmi  = off;                          
+         ((PU_EMRCREATEMONOBRUSH)    record)->cbBmi   = cbBmi;   
+         off += cbBmi;
+         memcpy(record + off, Px, cbPx);
+         ((PU_EMRCREATEMONOBRUSH)    record)->offBits = off;                        
+         ((PU_EMRCREATEMONOBRUSH)    record)->cbBits  = cbImage;
       }
-      loffDx = (uint32_t *)(record + off);                  // offDx will go here, but we do not know with what value yet
-      off += sizeof(uint32_t);
-      memcpy(record + off,String,cbString);                 // copy the string data to its buffer
-      ((PU_EMRTEXT)record)->offString       = off;          // now save offset in the structure
-      off += cbString;
-      if(cbString < cbString4){ 
-        memset(record+off,0,cbString4-cbString); // keeps valgrind happy (initialize padding after string)
-        off += cbString4-cbString;
+      else {
+         ((PU_EMRCREATEMONOBRUSH)    record)->offBmi  = 0;                            
+         ((PU_EMRCREATEMONOBRUSH)    record)->cbBmi   = 0;                            
+         ((PU_EMRCREATEMONOBRUSH)    record)->offBits = 0;                            
+         ((PU_EMRCREATEMONOBRUSH)    record)->cbBits  = 0;                            
       }
-      memcpy(record + off, Dx, cbDxArray);                  // copy the Dx data to its buffer
-      *loffDx = off;                                        // now save offDx to the structure
-    }
-    return(record);
+   }
+   return(U_EMR_CORE_commit(et, record));
 }
 
+// common code for U_EMRBLEND_set and U_EMRTRANSPARENTBLT_set,
+char *U_EMR_CORE13_set(
+      EMFTRACK            *et,
+      uint32_t             iType,
+      U_RECTL              rclBounds,       // Bounding rectangle in device units
+      U_POINTL             Dest,            // Destination UL corner in logical units
+      U_POINTL             cDest,           // Destination width in logical units
+      U_POINTL             Src,             // Source UL corner in logical units
+      U_POINTL             cSrc,            // Src W & H in logical units
+      U_XFORM              xformSrc,        // Transform to apply to source
+      U_COLORREF           crBkColorSrc,    // Background color
+      uint32_t             iUsageSrc,       // DIBcolors Enumeration
+      uint32_t             Data,            // The meaning and type of this field varies, but it is always 4 bytes
+      const PU_BITMAPINFO  Bmi,             // (Optional) bitmapbuffer (U_BITMAPINFO section)
+      const uint32_t       cbPx,            // Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+      char                *Px               // (Optional) bitmapbuffer (pixel array section )
+   ){
+   char *record;
+   int   irecsize;
+   int   cbImage,cbImage4,cbBmi,off;
 
+   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
+   
+   irecsize = sizeof(U_EMRALPHABLEND) + cbBmi + cbImage4;
+   record   = U_EMR_CORE_alloc(et, irecsize);
+   if(record){
+      ((PU_EMR)                 record)->iType        = iType;
+      ((PU_EMR)                 record)->nSize        = irecsize;
+      ((PU_EMRALPHABLEND)       record)->rclBounds    = rclBounds;
+      ((PU_EMRALPHABLEND)       record)->Dest         = Dest;
+      ((PU_EMRALPHABLEND)       record)->cDest        = cDest;
+      ((PU_EMRALPHABLEND)       record)->Blend        =  *((PU_BLEND)&Data);
+      ((PU_EMRALPHABLEND)       record)->Src          = Src;
+      ((PU_EMRALPHABLEND)       record)->xformSrc     = xformSrc;
+      ((PU_EMRALPHABLEND)       record)->crBkColorSrc = crBkColorSrc;
+      ((PU_EMRALPHABLEND)       record)->iUsageSrc    = iUsageSrc;
+      off = sizeof(U_EMRALPHABLEND);
+      APPEND_PXBMISRC(record, U_EMRALPHABLEND, cbBmi, Bmi, Px, cbImage, cbImage4);
+      ((PU_EMRALPHABLEND)       record)->cSrc         = cSrc;
+   }
+   return(U_EMR_CORE_commit(et, record));
+}
+//! @endcond
 
 /* **********************************************************************************************
-These functions are simpler or more convenient ways to generate the specified types of EMR records.  
-Each should be called in preference to the underlying "base" EMR function.
+These are the core EMR functions, each creates a particular type of record.  
+All return these records via a char* pointer, which is NULL if the call failed.  
+They are listed in order by the corresponding U_EMR_* index number.  
 *********************************************************************************************** */
 
+// U_EMRHEADER_set                     1
+
+/**
+    \brief Allocate and construct a U_EMRHEADER record.
+    \return pointer to U_EMRHEADER record, or NULL on error.
+    \param rclBounds       Bounding rectangle in device units 
+    \param rclFrame        Bounding rectangle in 0.01 mm units
+    \param pfmtDesc        Pointer to a PixelFormatDescriptor
+    \param nDesc           number of characters in Description, will include first three '\0'
+    \param Description     Description, formatted like: text1\0text2\0\0
+    \param szlDevice       Reference device size in pixels  
+    \param szlMillimeters  Reference device size in 0.01 mm
+    \param bOpenGL         nonZero if OpenGL commands are included
+*/
+char *U_EMRHEADER_set( 
+      const U_RECTL                  rclBounds,
+      const U_RECTL                  rclFrame,
+      U_PIXELFORMATDESCRIPTOR* const pfmtDesc,
+      U_CBSTR                        nDesc,
+      uint16_t* const                Description,
+      const U_SIZEL                  szlDevice,
+      const U_SIZEL                  szlMillimeters,
+      const uint32_t                 bOpenGL
+   ){
+
+   char *record; 
+   int cbPFD,cbDesc,cbDesc4;
+   uint32_t off;
+   int irecsize;
+
+   if(pfmtDesc){    cbPFD = sizeof(U_PIXELFORMATDESCRIPTOR); }
+   else  {          cbPFD = 0;                               }
+   if(Description){ cbDesc = 2*nDesc;                         } // also copy the terminator.  Size is in bytes
+   else  {          cbDesc = 0;                               }
+   cbDesc4  = UP4(cbDesc);
+   irecsize = sizeof(U_EMRHEADER) + cbPFD + cbDesc4;
+   record   = malloc(irecsize);
+   if(record){
+      off = sizeof(U_EMRHEADER);
+      ((PU_EMR)           record)->iType             = U_EMR_HEADER;
+      ((PU_EMR)           record)->nSize             = irecsize;
+      ((PU_EMRHEADER)     record)->rclBounds         = rclBounds;
+      ((PU_EMRHEADER)     record)->rclFrame          = rclFrame;
+      ((PU_EMRHEADER)     record)->dSignature        = U_ENHMETA_SIGNATURE;
+      ((PU_EMRHEADER)     record)->nVersion          = U_ENHMETA_VERSION;  
+      ((PU_EMRHEADER)     record)->nBytes            = 0;  // Not known yet
+      ((PU_EMRHEADER)     record)->nRecords          = 0;  // Not known yet
+      ((PU_EMRHEADER)     record)->nHandles          = 0;  // Not known yet
+      ((PU_EMRHEADER)     record)->sReserved         = 0;  // Must be 0
+      ((PU_EMRHEADER)     record)->nDescription      = nDesc;
+      ((PU_EMRHEADER)     record)->offDescription    = 0;  // may change below  
+      ((PU_EMRHEADER)     record)->nPalEntries       = 0;  // Not known yet
+      ((PU_EMRHEADER)     record)->szlDevice         = szlDevice;
+      ((PU_EMRHEADER)     record)->szlMillimeters    = szlMillimeters;
+      ((PU_EMRHEADER)     record)->cbPixelFormat     = cbPFD;
+      ((PU_EMRHEADER)     record)->offPixelFormat    = 0;  // may change below 
+      ((PU_EMRHEADER)     record)->bOpenGL           = bOpenGL;
+      ((PU_EMRHEADER)     record)->szlMicrometers.cx = szlMillimeters.cx*1000;   
+      ((PU_EMRHEADER)     record)->szlMicrometers.cy = szlMillimeters.cy*1000;   
+      if(cbDesc4){
+          ((PU_EMRHEADER) record)->offDescription    = off;
+          memcpy(record + off, Description, cbDesc);
+          off += cbDesc;
+          if(cbDesc < cbDesc4)memset(record + off,0,cbDesc4-cbDesc);  // clear any unused bytes
+          off += cbDesc4 - cbDesc;
+      }
+      if(cbPFD){
+         ((PU_EMRHEADER)  record)->offPixelFormat   = off;
+         memcpy(record+off,pfmtDesc,cbPFD);    
+      }
+   }
+   return(record);
+}
+
+// U_EMRPOLYBEZIER_set                 2
+/**
+    \brief Allocate and construct a U_EMR_POLYBEZIER record.
+    \return pointer to U_EMR_POLYBEZIER record, or NULL on error.
+    \param rclBounds   bounding rectangle in device units
+    \param cptl        Number of points to draw
+    \param points      array of points
+*/
+char *U_EMRPOLYBEZIER_set(
+      const U_RECTL   rclBounds,
+      const uint32_t  cptl,
+      const U_POINTL *points
+   ){
+   return(U_EMR_CORE1_set(NULL, U_EMR_POLYBEZIER, rclBounds, cptl, points));
+} 
+
+// U_EMRPOLYGON_set                    3
+/**
+    \brief Allocate and construct a U_EMR_POLYGON record.
+    \return pointer to U_EMR_POLYGON record, or NULL on error.
+    \param rclBounds   bounding rectangle in device units
+    \param cptl        Number of points to draw
+    \param points      array of points
+*/
+char *U_EMRPOLYGON_set(
+      const U_RECTL   rclBounds,
+      const uint32_t  cptl,
+      const U_POINTL *points
+   ){
+   return(U_EMR_CORE1_set(NULL, U_EMR_POLYGON, rclBounds, cptl, points));
+} 
+
+// U_EMRPOLYLINE_set                   4
+/**
+    \brief Allocate and construct a U_EMR_POLYLINE record.
+    \return pointer to U_EMR_POLYLINE record, or NULL on error.
+    \param rclBounds   bounding rectangle in device units
+    \param cptl        Number of points to draw
+    \param points      array of points
+*/
+char *U_EMRPOLYLINE_set(
+      const U_RECTL   rclBounds,
+      const uint32_t  cptl,
+      const U_POINTL *points
+   ){
+   return(U_EMR_CORE1_set(NULL, U_EMR_POLYLINE, rclBounds, cptl, points));
+} 
+
+// U_EMRPOLYBEZIERTO_set               5
+/**
+    \brief Allocate and construct a U_EMR_POLYBEZIERTO record.
+    \return pointer to U_EMR_POLYBEZIERTO record, or NULL on error.
+    \param rclBounds   bounding rectangle in device units
+    \param cptl        Number of points to draw
+    \param points      array of points
+*/
+char *U_EMRPOLYBEZIERTO_set(
+      const U_RECTL   rclBounds,
+      const uint32_t  cptl,
+      const U_POINTL *points
+   ){
+   return(U_EMR_CORE1_set(NULL, U_EMR_POLYBEZIERTO, rclBounds, cptl, points));
+} 
+
+// U_EMRPOLYLINETO_set                 6
+/**
+    \brief Allocate and construct a U_EMR_POLYLINETO record.
+    \return pointer to U_EMR_POLYLINETO record, or NULL on error.
+    \param rclBounds   bounding rectangle in device units
+    \param cptl        Number of points to draw
+    \param points      array of points
+*/
+char *U_EMRPOLYLINETO_set(
+      const U_RECTL   rclBounds,
+      const uint32_t  cptl,
+      const U_POINTL *points
+   ){
+   return(U_EMR_CORE1_set(NULL, U_EMR_POLYLINETO, rclBounds, cptl, points));
+} 
+
+// U_EMRPOLYPOLYLINE_set               7
+/**
+    \brief Allocate and construct a U_EMR_POLYPOLYLINE record.
+    \return pointer to U_EMR_POLYPOLYLINE record, or NULL on error.
+    \param rclBounds    bounding rectangle in device units
+    \param nPolys       Number of elements in aPolyCounts
+    \param aPolyCounts  Number of points in each poly (sequential)
+    \param cptl         Total number of points (over all poly)
+    \param points       array of points
+*/
+char *U_EMRPOLYPOLYLINE_set(
+      const U_RECTL   rclBounds,
+      const uint32_t  nPolys,
+      const uint32_t *aPolyCounts,
+      const uint32_t  cptl,
+      const U_POINTL *points
+   ){
+   return(U_EMR_CORE2_set(NULL, U_EMR_POLYPOLYLINE, rclBounds, nPolys, aPolyCounts,cptl, points));
+}
+
+// U_EMRPOLYPOLYGON_set                8
+/**
+    \brief Allocate and construct a U_EMR_POLYPOLYGON record.
+    \return pointer to U_EMR_POLYPOLYGON record, or NULL on error.
+    \param rclBounds    bounding rectangle in device units
+    \param nPolys       Number of elements in aPolyCounts
+    \param aPolyCounts  Number of points in each poly (sequential)
+    \param cptl         Total number of points (over all poly)
+    \param points       array of points
+*/
+char *U_EMRPOLYPOLYGON_set(
+      const U_RECTL   rclBounds,
+      const uint32_t  nPolys,
+      const uint32_t *aPolyCounts,
+      const uint32_t  cptl,
+      const U_POINTL *points
+   ){
+   return(U_EMR_CORE2_set(NULL, U_EMR_POLYPOLYGON, rclBounds, nPolys, aPolyCounts,cptl, points));
+}
+
+// U_EMRSETWINDOWEXTEX_set             9
+/** 
+    \brief Allocate and construct a U_EMR_SETWINDOWEXTEX record.
+    \return pointer to U_EMR_SETWINDOWEXTEX record, or NULL on error.
+    \param szlExtent H & V extent in logical units
+*/
+char *U_EMRSETWINDOWEXTEX_set(
+      const U_SIZEL szlExtent 
+   ){
+   U_PAIR temp;
+   temp.x = szlExtent.cx;
+   temp.y = szlExtent.cy;
+   return(U_EMR_CORE7_set(NULL, U_EMR_SETWINDOWEXTEX, temp)); 
+}
 
+// U_EMRSETWINDOWORGEX_set            10
 /**
-    \brief Allocate and construct a U_EMRCOMMENT structure with a UTF8 string.
-    A U_EMRCOMMENT contains application specific data, and that may include contain null characters. This function may be used when the
-    comment only incluces UT8 text.
-    \return pointer to U_EMRCOMMENT structure, or NULL on error.
-    \param string  UTF8 string to store in the comment
+    \brief Allocate and construct a U_EMR_SETWINDOWORGEX record.
+    \return pointer to U_EMR_SETWINDOWORGEX record, or NULL on error.
+    \param ptlOrigin H & V origin in logical units
+*/
+char *U_EMRSETWINDOWORGEX_set(
+      const U_POINTL ptlOrigin
+   ){
+   return(U_EMR_CORE7_set(NULL, U_EMR_SETWINDOWORGEX, ptlOrigin)); // U_PAIR and U_POINTL are the same thing
+}
 
+// U_EMRSETVIEWPORTEXTEX_set          11
+/**
+    \brief Allocate and construct a U_EMR_SETVIEWPORTEXTEX record.
+    \return pointer to U_EMR_SETVIEWPORTEXTEX record, or NULL on error.
+    \param szlExtent  H & V extent in logical units
+*/
+char *U_EMRSETVIEWPORTEXTEX_set(
+      const U_SIZEL szlExtent
+   ){
+   U_PAIR temp;
+   temp.x = szlExtent.cx;
+   temp.y = szlExtent.cy;
+   return(U_EMR_CORE7_set(NULL, U_EMR_SETVIEWPORTEXTEX, temp)); 
+}
 
+// U_EMRSETVIEWPORTORGEX_set          12
+/**
+    \brief Allocate and construct a U_EMR_SETVIEWPORTORGEX record.
+    \return pointer to U_EMR_SETVIEWPORTORGEX record, or NULL on error.
+    \param ptlOrigin  H & V origin in logical units
 */
-char *textcomment_set(
-      const char *string
+char *U_EMRSETVIEWPORTORGEX_set(
+      const U_POINTL ptlOrigin
    ){
-   if(!string)return(NULL);
-   return(U_EMRCOMMENT_set(1 + strlen(string),string));
+   return(U_EMR_CORE7_set(NULL, U_EMR_SETVIEWPORTORGEX, ptlOrigin));  // U_PAIR and U_POINTL are the same thing
 }
 
+// U_EMRSETBRUSHORGEX_set             13
 /**
-    \brief Allocate and construct a U_EMRDELETEOBJECT structure and also delete the requested object from the table.
-    Use this function instead of calling U_EMRDELETEOBJECT_set() directly.
-    \return pointer to U_EMRDELETEOBJECT structure, or NULL on error.
-    \param ihObject  Pointer to handle to delete.  This value is set to 0 if the function succeeds.
-    \param eht       EMF handle table
-    
-    Note that calling this function should always be conditional on the specifed object being defined.  It is easy to
-    write a program where deleteobject_set() is called in a sequence where, at the time, we know that ihObject is defined.
-    Then a later modification, possibly quite far away in the code, causes it to be undefined.  That distant change will
-    result in a failure when this function reutrns.  That problem cannot be handled here because the only  values which
-    may be returned are a valid U_EMRDELETEOBJECT record or a NULL, and other errors could result in the NULL.  
-    So the object must be checked before the call.
+    \brief Allocate and construct a U_EMR_SETBRUSHORGEX record.
+    \return pointer to U_EMR_SETBRUSHORGEX record, or NULL on error.
+    \param ptlOrigin   H & V origin in logical units
 */
-char *deleteobject_set(
-      uint32_t    *ihObject,
-      EMFHANDLES  *eht
+char *U_EMRSETBRUSHORGEX_set(
+      const U_POINTL ptlOrigin
    ){
-   uint32_t saveObject=*ihObject;
-   if(emf_htable_delete(ihObject,eht))return(NULL);  // invalid handle or other problem, cannot be deleted
-   return(U_EMRDELETEOBJECT_set(saveObject));
+   return(U_EMR_CORE7_set(NULL, U_EMR_SETBRUSHORGEX, *((PU_PAIR) & ptlOrigin))); 
 }
 
+// U_EMREOF_set                       14
 /**
-    \brief Allocate and construct a U_EMRSELECTOBJECT structure, checks that the handle specified is one that can actually be selected.
-    Use this function instead of calling U_EMRSELECTOBJECT_set() directly.
-    \return pointer to U_EMRSELECTOBJECT structure, or NULL on error.
-    \param ihObject  handle to select
-    \param eht       EMF handle table
+    \brief Allocate and construct a U_EMR_EOF record.
+    \return pointer to U_EMR_EOF record, or NULL on error.
+    \param cbPalEntries  Number of palette entries
+    \param PalEntries    (optional) array of PalEntries
+    \param et            tracking information, needed for nSizeLast calculation
 */
-char *selectobject_set(
-      uint32_t    ihObject,
-      EMFHANDLES *eht
+char *U_EMREOF_set(
+      const U_CBPLENTRIES  cbPalEntries,
+      const PU_LOGPLTNTRY  PalEntries,
+      EMFTRACK            *et
    ){
-   if(!(U_STOCK_OBJECT & ihObject)){        // not a stock object, those go straight through
-     if(ihObject > eht->top)return(NULL);   // handle this high is not in the table
-     if(!eht->table[ihObject])return(NULL); // handle is not in the table, so not active, so cannot be selected
+   char *record;
+   char *ptr;
+   int  irecsize;
+   int  cbPals;   // space allocated for Palette Entries
+   uint32_t off;
+
+   if(cbPalEntries && !PalEntries)return(NULL);
+   if(!et)return(NULL);
+   cbPals     = cbPalEntries * sizeof(U_LOGPLTNTRY);
+   irecsize  = sizeof(U_EMREOF) + cbPals + sizeof(uint32_t);  //invariant core, variable palette, palette byte count
+   record    = malloc(irecsize);
+   if(record){
+      ((PU_EMR)         record)->iType         = U_EMR_EOF;
+      ((PU_EMR)         record)->nSize         = irecsize;
+      ((PU_EMREOF)      record)->cbPalEntries  = cbPalEntries;
+      ((PU_EMREOF)      record)->offPalEntries = 0;  // May be changed below
+      off = sizeof(U_EMREOF);         //start of the variable region
+      if(cbPals){
+         ((PU_EMREOF)   record)->offPalEntries = off;
+         memcpy(record+off,PalEntries,cbPals);
+         off += cbPals;
+      }
+      ptr = record + off;
+      *(uint32_t *)ptr = irecsize + et->used;  // EMREOF nSizeLast field, not at a fixed position, cannot be accessed by field name
    }
-   return(U_EMRSELECTOBJECT_set(ihObject));
-}
+   et->PalEntries = cbPalEntries;
+   return(record);
+} 
+
 
+// U_EMRSETPIXELV_set                 15
 /**
-    \brief Allocate and construct a U_EMREXTCREATEPEN structure, create a handle and return it.
-    Use this function instead of calling U_EMREXTCREATEPEN_set() directly.
-    \return pointer to U_EMREXTCREATEPEN structure, or NULL on error.
-    \param ihPen handle to be used by new object
-    \param eht   EMF handle table 
-    \param Bmi   bitmapbuffer
-    \param cbPx   Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-    \param Px     pixel array (NULL if cbPx == 0)
-    \param elp   Pen parameters (Size is Variable!!!!)
+    \brief Allocate and construct a U_EMR_SETPIXELV record.
+    \return pointer to U_EMR_SETPIXELV record, or NULL on error.
+    \param ptlPixel Pixel coordinates (logical)
+    \param crColor  Pixel color
 */
-char *extcreatepen_set(
-      uint32_t        *ihPen,
-      EMFHANDLES      *eht,
-      PU_BITMAPINFO    Bmi,
-      const uint32_t   cbPx,
-      char            *Px,
-      PU_EXTLOGPEN     elp
+char *U_EMRSETPIXELV_set(
+      const U_POINTL    ptlPixel,
+      const U_COLORREF  crColor
    ){
-   if(emf_htable_insert(ihPen, eht))return(NULL);
-   return(U_EMREXTCREATEPEN_set(*ihPen, Bmi, cbPx, Px, elp ));
+   char *record;
+   int  irecsize;
+
+   irecsize = sizeof(U_EMRSETPIXELV);
+   record   = malloc(irecsize);
+   if(record){
+      ((PU_EMR)         record)->iType    = U_EMR_SETPIXELV;
+      ((PU_EMR)         record)->nSize    = irecsize;
+      ((PU_EMRSETPIXELV)record)->ptlPixel = ptlPixel;
+      ((PU_EMRSETPIXELV)record)->crColor  = crColor;
+   }
+   return(record);
+} 
+
+
+// U_EMRSETMAPPERFLAGS_set            16
+/**
+    \brief Allocate and construct a U_EMR_SETMAPPERFLAGS record.
+    \return pointer to U_EMR_SETMAPPERFLAGS record, or NULL on error.
+*/
+char *U_EMRSETMAPPERFLAGS_set(void){
+   char *record;
+   int  irecsize;
+
+   irecsize = sizeof(U_EMRSETMAPPERFLAGS);
+   record   = malloc(irecsize);
+   if(record){
+      ((PU_EMR)              record)->iType   = U_EMR_SETMAPPERFLAGS;
+      ((PU_EMR)              record)->nSize   = irecsize;
+      ((PU_EMRSETMAPPERFLAGS)record)->dwFlags = 1;
+   }
+   return(record);
+} 
+
+// U_EMRSETMAPMODE_set                17
+/**
+    \brief Allocate and construct a U_EMR_SETMAPMODE record.
+    \return pointer to U_EMR_SETMAPMODE record, or NULL on error.
+    \param iMode  MapMode Enumeration
+*/
+char *U_EMRSETMAPMODE_set(
+      const uint32_t iMode
+   ){
+   return(U_EMR_CORE3_set(NULL, U_EMR_SETMAPMODE, iMode));
 }
 
+// U_EMRSETBKMODE_set                 18
 /**
-    \brief Allocate and construct a U_EMRCREATEPEN structure, create a handle and returns it
-    Use this function instead of calling U_EMRCREATEPEN_set() directly.
-    \return pointer to U_EMRCREATEPEN structure, or NULL on error.
-    \param ihPen handle to be used by new object
-    \param eht   EMF handle table 
-    \param lopn  Pen parameters
+    \brief Allocate and construct a U_EMR_SETBKMODE record.
+    \return pointer to U_EMR_SETBKMODE record, or NULL on error.
+    \param iMode BackgroundMode Enumeration
 */
-char *createpen_set(
-      uint32_t   *ihPen,
-      EMFHANDLES *eht,
-      U_LOGPEN    lopn
+char *U_EMRSETBKMODE_set( 
+      const uint32_t iMode
    ){
-   if(emf_htable_insert(ihPen, eht))return(NULL);
-   return(U_EMRCREATEPEN_set(*ihPen, lopn));
+  return(U_EMR_CORE3_set(NULL, U_EMR_SETBKMODE, iMode));
 }
 
+// U_EMRSETPOLYFILLMODE_set           19
 /**
-    \brief Allocate and construct a U_EMRCREATEBRUSHINDIRECT structure, create a handle and returns it
-    Use this function instead of calling U_EMRCREATEBRUSHINDIRECT_set() directly.
-    \return pointer to U_EMRCREATEBRUSHINDIRECT structure, or NULL on error.
-    \param ihBrush handle to be used by new object 
-    \param eht     EMF handle table 
-    \param lb      Brush parameters  
+    \brief Allocate and construct a U_EMR_SETPOLYFILLMODE record.
+    \return pointer to U_EMR_SETPOLYFILLMODE record, or NULL on error.
+    \param iMode  PolygonFillMode Enumeration
 */
-char *createbrushindirect_set(
-      uint32_t    *ihBrush,
-      EMFHANDLES  *eht,
-      U_LOGBRUSH   lb
+char *U_EMRSETPOLYFILLMODE_set(
+      const uint32_t iMode
    ){
-   if(emf_htable_insert(ihBrush, eht))return(NULL);
-   return(U_EMRCREATEBRUSHINDIRECT_set(*ihBrush, lb));
+   return(U_EMR_CORE3_set(NULL, U_EMR_SETPOLYFILLMODE, iMode));
 }
 
+// U_EMRSETROP2_set                   20
 /**
-    \brief Allocate and construct a U_EMRCREATEDIBPATTERNBRUSHPT_set structure, create a handle and returns it
-    Use this function instead of calling U_EMRCREATEDIBPATTERNBRUSHPT_set() directly.
-    \return pointer to U_EMRCREATEDIBPATTERNBRUSHPT_set structure, or NULL on error.
-    \param ihBrush handle to be used by new object 
-    \param eht     EMF handle table 
-    \param iUsage  DIBColors enumeration
-    \param Bmi     Bitmap info
-    \param cbPx    Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-    \param Px      (Optional) bitmapbuffer (pixel array section )
+    \brief Allocate and construct a U_EMR_SETROP2 record.
+    \return pointer to U_EMR_SETROP2 record, or NULL on error.
+    \param iMode  RasterOperation2 Enumeration
 */
-char *createdibpatternbrushpt_set(
-      uint32_t            *ihBrush,
-      EMFHANDLES          *eht,
-      const uint32_t       iUsage, 
-      PU_BITMAPINFO        Bmi,
-      const uint32_t       cbPx,
-      const char          *Px
-      
+char *U_EMRSETROP2_set(
+      const uint32_t iMode 
    ){
-   if(emf_htable_insert(ihBrush, eht))return(NULL);
-   return(U_EMRCREATEDIBPATTERNBRUSHPT_set(*ihBrush, iUsage, Bmi, cbPx, Px));
+   return(U_EMR_CORE3_set(NULL, U_EMR_SETROP2, iMode));
 }
 
+// U_EMRSETSTRETCHBLTMODE_set         21
 /**
-    \brief Allocate and construct a U_EMRCREATEMONOBRUSH_set structure, create a handle and returns it
-    Use this function instead of calling U_EMRCREATEMONOBRUSH_set() directly.
-    \return pointer to U_EMRCREATEMONOBRUSH_set structure, or NULL on error.
-    \param ihBrush handle to be used by new object 
-    \param eht     EMF handle table 
-    \param iUsage  DIBColors enumeration
-    \param Bmi     Bitmap info
-    \param cbPx    Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-    \param Px      (Optional) bitmapbuffer (pixel array section )
+    \brief Allocate and construct a U_EMR_SETSTRETCHBLTMODE record.
+    \return pointer to U_EMR_SETSTRETCHBLTMODE record, or NULL on error.
+    \param iMode  StretchMode Enumeration
 */
-char *createmonobrush_set(
-      uint32_t            *ihBrush,
-      EMFHANDLES          *eht,
-      const uint32_t       iUsage, 
-      PU_BITMAPINFO        Bmi,
-      const uint32_t       cbPx,
-      const char          *Px
-      
+char *U_EMRSETSTRETCHBLTMODE_set(
+      const uint32_t iMode
    ){
-   if(emf_htable_insert(ihBrush, eht))return(NULL);
-   return(U_EMRCREATEMONOBRUSH_set(*ihBrush, iUsage, Bmi, cbPx, Px));
+   return(U_EMR_CORE3_set(NULL, U_EMR_SETSTRETCHBLTMODE, iMode));
 }
 
-
+// U_EMRSETTEXTALIGN_set              22
 /**
-    \brief Allocate and construct a U_EMRCREATECOLORSPACE structure, create a handle and returns it
-    Use this function instead of calling U_EMRCREATECOLORSPACE_set() directly.
-    \return pointer to U_EMRCREATECOLORSPACE structure, or NULL on error.
-    \param ihCS  ColorSpace handle, will be created and returned
-    \param eht   Pointer to structure holding all EMF handles
-    \param lcs    ColorSpace parameters
+    \brief Allocate and construct a U_EMR_SETTEXTALIGN record.
+    \return pointer to U_EMR_SETTEXTALIGN record, or NULL on error.
+    \param iMode  TextAlignment Enumeration
 */
-char *createcolorspace_set(
-      uint32_t          *ihCS,
-      EMFHANDLES         *eht,
-      U_LOGCOLORSPACEA    lcs
+char *U_EMRSETTEXTALIGN_set(
+      const uint32_t iMode 
    ){
-   if(emf_htable_insert(ihCS, eht))return(NULL);
-   return(U_EMRCREATECOLORSPACE_set(*ihCS,lcs));
+   return(U_EMR_CORE3_set(NULL, U_EMR_SETTEXTALIGN, iMode));
 }
 
+// U_EMRSETCOLORADJUSTMENT_set        23
 /**
-    \brief Allocate and construct a U_EMRCREATECOLORSPACEW structure, create a handle and returns it
-    Use this function instead of calling U_EMRCREATECOLORSPACEW_set() directly.
-    \return pointer to U_EMRCREATECOLORSPACEW structure, or NULL on error.
-    \param ihCS    ColorSpace handle, will be created and returned
-    \param eht     Pointer to structure holding all EMF handles
-    \param lcs     ColorSpace parameters
-    \param dwFlags If low bit set Data is present
-    \param cbData  Number of bytes of theData field.
-    \param Data    (Optional, dwFlags & 1) color profile data 
+    \brief Allocate and construct a U_EMR_SETCOLORADJUSTMENT record.
+    \return pointer to U_EMR_SETCOLORADJUSTMENT record, or NULL on error.
+    \param ColorAdjustment Color Adjustment
 */
-char *createcolorspacew_set(
-      uint32_t           *ihCS,
-      EMFHANDLES         *eht,
-      U_LOGCOLORSPACEW    lcs,
-      uint32_t            dwFlags,
-      U_CBDATA            cbData,
-      uint8_t            *Data
+char *U_EMRSETCOLORADJUSTMENT_set(
+      const U_COLORADJUSTMENT ColorAdjustment
    ){
-   if(emf_htable_insert(ihCS, eht))return(NULL);
-   return(U_EMRCREATECOLORSPACEW_set(*ihCS, lcs, dwFlags, cbData, Data));
+   char *record;
+   int  irecsize;
+
+   irecsize = sizeof(U_EMRSETCOLORADJUSTMENT);
+   record   = malloc(irecsize);
+   if(record){
+      ((PU_EMR)                   record)->iType           = U_EMR_SETCOLORADJUSTMENT;
+      ((PU_EMR)                   record)->nSize           = irecsize;
+      ((PU_EMRSETCOLORADJUSTMENT) record)->ColorAdjustment = ColorAdjustment;
+   }
+   return(record);
 }
 
+// U_EMRSETTEXTCOLOR_set              24
 /**
-    \brief Allocate and construct a U_EMREXTCREATEFONTINDIRECTW structure, create a handle and returns it
-    Use this function instead of calling U_EMREXTCREATEFONTINDIRECTW_set() directly.
-    \return pointer to U_EMREXTCREATEFONTINDIRECTW structure, or NULL on error.
-    \param ihFont  Font handle, will be created and returned
-    \param eht     Pointer to structure holding all EMF handles
-    \param elf     Pointer to Font parameters asPU_LOGFONT
-    \param elfw    Pointer to Font parameters as U_LOGFONT_PANOSE
+    \brief Allocate and construct a U_EMR_SETTEXTCOLOR record.
+    \return pointer to U_EMR_SETTEXTCOLOR record, or NULL on error.
+    \param crColor  Text Color
 */
-char *extcreatefontindirectw_set(
-      uint32_t   *ihFont,
-      EMFHANDLES *eht,
-      const char *elf,
-      const char *elfw
-   ){
-   if(emf_htable_insert(ihFont, eht))return(NULL);
-   return(U_EMREXTCREATEFONTINDIRECTW_set(*ihFont, elf, elfw));
+char *U_EMRSETTEXTCOLOR_set(
+      const U_COLORREF crColor
+  ){
+  return(U_EMR_CORE3_set(NULL, U_EMR_SETTEXTCOLOR, *(uint32_t *) &crColor));
 }
 
+// U_EMRSETBKCOLOR_set                25
 /**
-    \brief Allocate and construct a U_EMRCREATEPALETTE structure, create a handle and returns it
-    Use this function instead of calling U_EMRCREATEPALETTE_set() directly.
-    \return pointer to U_EMRCREATEPALETTE structure, or NULL on error.
-    \param ihPal  Palette handle, will be created and returned
-    \param eht    Pointer to structure holding all EMF handles
-    \param lgpl   PaletteFont parameters
+    \brief Allocate and construct a U_EMR_SETBKCOLOR record.
+    \return pointer to U_EMR_SETBKCOLOR record, or NULL on error.
+    \param crColor Background Color
 */
-char *createpalette_set(
-      uint32_t     *ihPal,
-      EMFHANDLES   *eht,
-      U_LOGPALETTE  lgpl
-   ){
-  if(emf_htable_insert(ihPal, eht))return(NULL);
-   return(U_EMRCREATEPALETTE_set(*ihPal, lgpl));
+char *U_EMRSETBKCOLOR_set(
+      const U_COLORREF crColor
+  ){
+  return(U_EMR_CORE3_set(NULL, U_EMR_SETBKCOLOR, *(uint32_t *) &crColor));
 }
 
+// U_EMROFFSETCLIPRGN_set             26
 /**
-    \brief Allocate and construct a U_EMRSETPALETTEENTRIES structure, create a handle and returns it
-    Use this function instead of calling U_EMRSETPALETTEENTRIES_set() directly.
-    \return pointer to U_EMRSETPALETTEENTRIES structure, or NULL on error.
-    \param ihPal       Palette handle, will be created and returned
-    \param eht         Pointer to structure holding all EMF handles
-    \param iStart      First Palette entry in selected object to set
-    \param cEntries    Number of Palette entries in selected object to set
-    \param aPalEntries Values to set with
+    \brief Allocate and construct a U_EMR_OFFSETCLIPRGN record.
+    \return pointer to U_EMR_OFFSETCLIPRGN record, or NULL on error.
+    \param ptl Clipping region 
 */
-char *setpaletteentries_set(
-      uint32_t               *ihPal,
-      EMFHANDLES             *eht,
-      const uint32_t         iStart,
-      const U_NUM_LOGPLTNTRY cEntries,
-      const PU_LOGPLTNTRY    aPalEntries
+char *U_EMROFFSETCLIPRGN_set(
+      const U_POINTL ptl
    ){
-   if(emf_htable_insert(ihPal, eht))return(NULL);
-   return(U_EMRSETPALETTEENTRIES_set(*ihPal, iStart, cEntries, aPalEntries));
+  return(U_EMR_CORE7_set(NULL, U_EMR_OFFSETCLIPRGN, ptl));
 }
 
-/**
-    \brief Allocate and construct a U_EMRFILLRGN structure, create a handle and returns it
-    Use this function instead of calling U_EMRFILLRGN_set() directly.
-    \return pointer to U_EMRFILLRGN structure, or NULL on error.
-    \param ihBrush   Brush handle, will be created and returned
-    \param eht       Pointer to structure holding all EMF handles
-    \param rclBounds Bounding rectangle in device units
-    \param RgnData   Pointer to a U_RGNDATA structure
+// U_EMRMOVETOEX_set                  27
+/** 
+    \brief Allocate and construct a U_EMR_MOVETOEX record.
+    \return pointer to U_EMR_MOVETOEX record, or NULL on error.
+    \param ptl Point coordinates
 */
-char *fillrgn_set(
-      uint32_t         *ihBrush,
-      EMFHANDLES       *eht,
-      const U_RECTL     rclBounds,
-      const PU_RGNDATA  RgnData
+char *U_EMRMOVETOEX_set(
+      const U_POINTL ptl
    ){
-   if(emf_htable_insert(ihBrush, eht))return(NULL);
-   return(U_EMRFILLRGN_set(rclBounds, *ihBrush, RgnData));
+   return(U_EMR_CORE7_set(NULL, U_EMR_MOVETOEX, ptl));
 }
 
+// U_EMRSETMETARGN_set                28
 /**
-    \brief Allocate and construct a U_EMRFRAMERGN structure, create a handle and returns it
-    Use this function instead of calling U_EMRFRAMERGN_set() directly.
-    \return pointer to U_EMRFRAMERGN structure, or NULL on error.
-    \param ihBrush   Brush handle, will be created and returned
-    \param eht       Pointer to structure holding all EMF handles
-    \param rclBounds Bounding rectangle in device units
-    \param szlStroke W & H of Brush stroke
-    \param RgnData   Pointer to a U_RGNDATA structure
+    \brief Allocate and construct a U_EMR_SETMETARGN record.
+    \return pointer to U_EMR_SETMETARGN record, or NULL on error.
 */
-char *framergn_set(
-      uint32_t         *ihBrush,
-      EMFHANDLES       *eht,
-      const U_RECTL     rclBounds,
-      const U_SIZEL     szlStroke,
-      const PU_RGNDATA  RgnData
-   ){
-   if(emf_htable_insert(ihBrush, eht))return(NULL);
-   return(U_EMRFRAMERGN_set(rclBounds, *ihBrush, szlStroke, RgnData));
+char *U_EMRSETMETARGN_set(void){
+  return(U_EMR_CORE5_set(NULL, U_EMR_SETMETARGN));
 }
 
+// U_EMREXCLUDECLIPRECT_set           29
 /**
-    \brief Allocate and construct an array of U_POINT objects which has been subjected to a U_XFORM
-    \returns pointer to an array of U_POINT structures.
-    \param points  pointer to the source U_POINT structures
-    \param count   number of members in points
-    \param xform   U_XFORM to apply
-    
-    May also be used to modify U_RECT by doubling the count and casting the pointer.
+    \brief Allocate and construct a U_EMR_EXCLUDECLIPRECT record.
+    \return pointer to U_EMR_EXCLUDECLIPRECT record, or NULL on error.
+    \param rclClip Clipping Region
 */
-PU_POINT points_transform(PU_POINT points, int count, U_XFORM xform){
-   PU_POINT newpts;
-   int i;
-   float x,y;
-   newpts = (PU_POINT) malloc(count * sizeof(U_POINT));
-   for(i=0; i<count; i++){
-      x = (float) points[i].x;
-      y = (float) points[i].y;
-      newpts[i].x = U_ROUND(x * xform.eM11 + y * xform.eM21 + xform.eDx);
-      newpts[i].y = U_ROUND(x * xform.eM12 + y * xform.eM22 + xform.eDy);
-   }
-   return(newpts);
-}
+char *U_EMREXCLUDECLIPRECT_set(
+      const U_RECTL rclClip
+    ){
+    return(U_EMR_CORE4_set(NULL, U_EMR_EXCLUDECLIPRECT,rclClip));
+} 
 
+// U_EMRINTERSECTCLIPRECT_set         30
 /**
-    \brief Allocate and construct an array of U_POINT16 objects  which has been subjected to a U_XFORM
-    \returns pointer to an array of U_POINT16 structures.
-    \param points  pointer to the source U_POINT16 structures
-    \param count   number of members in points
-    \param xform   U_XFORM to apply
-    
-    Transformed src points {x0,y0} appear at {x0*xscale + x, y0*yscale + y}
+    \brief Allocate and construct a U_EMR_INTERSECTCLIPRECT record.
+    \return pointer to U_EMR_INTERSECTCLIPRECT record, or NULL on error.
+    \param rclClip Clipping Region
+*/
+char *U_EMRINTERSECTCLIPRECT_set(
+      const U_RECTL rclClip
+    ){
+    return(U_EMR_CORE4_set(NULL, U_EMR_INTERSECTCLIPRECT,rclClip));
+} 
+
+// U_EMRSCALEVIEWPORTEXTEX_set        31
+/** 
+    \brief Allocate and construct a U_EMR_SCALEVIEWPORTEXTEX record.
+    \return pointer to U_EMR_SCALEVIEWPORTEXTEX record, or NULL on error.
+    \param xNum   Horizontal multiplier (!=0)
+    \param xDenom Horizontal divisor    (!=0)
+    \param yNum   Vertical   multiplier (!=0)
+    \param yDenom Vertical   divisor    (!=0)
+*/
+char *U_EMRSCALEVIEWPORTEXTEX_set(
+    const int32_t  xNum,
+    const int32_t  xDenom,
+    const int32_t  yNum,
+    const int32_t  yDenom
+  ){
+  return(U_EMR_CORE4_set(NULL, U_EMR_SCALEVIEWPORTEXTEX,(U_RECTL){xNum,xDenom,yNum,yDenom}));
+}
+
+
+// U_EMRSCALEWINDOWEXTEX_set          32
+/** 
+    \brief Allocate and construct a U_EMR_SCALEWINDOWEXTEX record.
+    \return pointer to U_EMR_SCALEWINDOWEXTEX record, or NULL on error.
+    \param xNum   Horizontal multiplier (!=0)
+    \param xDenom Horizontal divisor    (!=0)
+    \param yNum   Vertical   multiplier (!=0)
+    \param yDenom Vertical   divisor    (!=0)
 */
-PU_POINT16 point16_transform(PU_POINT16 points, int count, U_XFORM xform){
-   PU_POINT16 newpts;
-   int i;
-   float x,y;
-   newpts = (PU_POINT16) malloc(count * sizeof(U_POINT16));
-   for(i=0; i<count; i++){
-      x = (float) points[i].x;
-      y = (float) points[i].y;
-      newpts[i].x = U_ROUND(x * xform.eM11 + y * xform.eM21 + xform.eDx);
-      newpts[i].y = U_ROUND(x * xform.eM12 + y * xform.eM22 + xform.eDy);
-   }
-   return(newpts);
+char *U_EMRSCALEWINDOWEXTEX_set(
+    const int32_t  xNum,
+    const int32_t  xDenom,
+    const int32_t  yNum,
+    const int32_t  yDenom
+  ){
+  return(U_EMR_CORE4_set(NULL, U_EMR_SCALEWINDOWEXTEX,(U_RECTL){xNum,xDenom,yNum,yDenom}));
 }
 
+// U_EMRSAVEDC_set                    33
 /**
-    \brief Allocate and construct an array of U_TRIVERTEX objects  which has been subjected to a U_XFORM
-    \returns pointer to an array of U_TRIVERTEX structures.
-    \param tv  pointer to the source U_TRIVERTEX structures
-    \param count   number of members in points
-    \param xform   U_XFORM to apply
-    
-    Transformed Trivertex points {x0,y0} appear at {x0*xscale + x, y0*yscale + y}
+    \brief Allocate and construct a U_EMR_SAVEDC record.
+    \return pointer to U_EMR_SAVEDC record, or NULL on error.
 */
-PU_TRIVERTEX trivertex_transform(PU_TRIVERTEX tv, int count, U_XFORM xform){
-   PU_TRIVERTEX newtvs;
-   int i;
-   float x,y;
-   newtvs = (PU_TRIVERTEX) malloc(count * sizeof(U_TRIVERTEX));
-   for(i=0; i<count; i++){
-      x = (float) tv[i].x;
-      y = (float) tv[i].y;
-      newtvs[i]   = tv[i];
-      newtvs[i].x = U_ROUND(x * xform.eM11 + y * xform.eM21 + xform.eDx);
-      newtvs[i].y = U_ROUND(x * xform.eM12 + y * xform.eM22 + xform.eDy);
-   }
-   return(newtvs);
+char *U_EMRSAVEDC_set(void){
+  return(U_EMR_CORE5_set(NULL, U_EMR_SAVEDC));
 }
 
+// U_EMRRESTOREDC_set                 34
 /**
-    \brief Allocate and construct an array of U_POINT objects from a set of U_POINT16 objects
-    \returns pointer to an array of U_POINT structures.
-    \param points  pointer to the source U_POINT16 structures
-    \param count   number of members in points
-    
+    \brief Allocate and construct a U_EMR_RESTOREDC record.
+    \return pointer to U_EMR_RESTOREDC record, or NULL on error.
+    \param iRelative DC to restore. -1 is preceding
 */
-PU_POINT point16_to_point(PU_POINT16 points, int count){
-   PU_POINT newpts;
-   int i;
-   newpts = (PU_POINT) malloc(count * sizeof(U_POINT));
-   for(i=0; i<count; i++){
-      newpts[i].x = points[i].x;
-      newpts[i].y = points[i].y;
-   }
-   return(newpts);
+char *U_EMRRESTOREDC_set(
+    const int32_t iRelative
+  ){
+  return(U_EMR_CORE3_set(NULL, U_EMR_RESTOREDC, (uint32_t) iRelative));
 }
 
+// U_EMRSETWORLDTRANSFORM_set         35
 /**
-    \brief Allocate and construct an array of U_POINT16 objects from a set of U_POINT objects
-    \returns pointer to an array of U_POINT16 structures.
-    \param points  pointer to the source U_POINT structures
-    \param count   number of members in points
-    
-    If a coordinate is out of range it saturates at boundary.
+    \brief Allocate and construct a U_EMR_SETWORLDTRANSFORM record.
+    \return pointer to U_EMR_SETWORLDTRANSFORM record, or NULL on error.
+    \param xform Transform to use
 */
-PU_POINT16 point_to_point16(PU_POINT points, int count){
-   PU_POINT16 newpts;
-   int i;
-   newpts = (PU_POINT16) malloc(count * sizeof(U_POINT16));
-   for(i=0; i<count; i++){
-      newpts[i].x = U_MNMX(points[i].x, INT16_MIN, INT16_MAX);
-      newpts[i].y = U_MNMX(points[i].y, INT16_MIN, INT16_MAX);
-   }
-   return(newpts);
-}
-
-// hide these from Doxygen
-//! @cond
-/* **********************************************************************************************
-These functions contain shared code used by various U_EMR*_set functions.  These should NEVER be called
-by end user code and to further that end prototypes are NOT provided and they are hidden from Doxygen.
-
-
-   These are (mostly) ordered by U_EMR_* index number.
-   For all _set functions the caller must eventually call free() on the returned pointer.
-   
-    CORE1(uint32_t iType, U_RECTL rclBounds, const uint32_t cptl, const U_POINTL *points){
-    CORE2(uint32_t iType, U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts,const uint32_t cptl, const U_POINTL *points){
-    CORE3(uint32_t iType, uint32_t iMode){       (generic 1 uint)
-    CORE4(uint32_t iType, U_RECTL rclBox){
-    CORE5(uint32_t iType){                       (generic noargs)
-    CORE6(uint32_t iType, U_RECTL rclBounds, const uint32_t cpts, const U_POINT16 *points){  (16bit form of CORE1)
-    CORE7(uint32_t iType, U_PAIR pair){
-    CORE8(uint32_t iType, U_RECTL rclBounds, uint32_t iGraphicsMode, U_FLOAT exScale, U_FLOAT eyScale, PU_EMRTEXT emrtext){ 
-    CORE9(uint32_t iType, U_RECTL rclBox, U_POINTL ptlStart, U_POINTL ptlEnd){
-    CORE10(uint32_t iType, U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts,const uint32_t cpts, const U_POINT16 *points){ (16bit form of CORE2)
-    CORE11(uint32_t iType, PU_RGNDATA RgnData){
-    CORE12(uint32_t iType, uint32_t ihBrush, uint32_t iUsage, PU_BITMAPINFO Bmi){
-    CORE13(uint32_t iType, U_RECTL rclBounds, U_POINTL Dest, U_POINTL cDest, 
-              U_POINTL Src, U_POINTL cSrc, U_XFORM xformSrc, U_COLORREF crBkColorSrc, uint32_t iUsageSrc, 
-              uint32_t Data, PU_BITMAPINFO Bmi);
-*********************************************************************************************** */
-
-
-// Functions with the same form starting with U_EMRPOLYBEZIER_set
-char *U_EMR_CORE1_set(uint32_t iType, U_RECTL rclBounds, const uint32_t cptl, const U_POINTL *points){
+char *U_EMRSETWORLDTRANSFORM_set(
+      const U_XFORM xform
+   ){
    char *record;
-   int   cbPoints;
-   int   irecsize;
+   int  irecsize;
 
-   cbPoints    = sizeof(U_POINTL)*cptl;
-   irecsize = sizeof(U_EMRPOLYBEZIER) + cbPoints - sizeof(U_POINTL); // First instance is in struct
-   record    = malloc(irecsize);
+   irecsize = sizeof(U_EMRSETWORLDTRANSFORM);
+   record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)           record)->iType     = iType;
-      ((PU_EMR)           record)->nSize     = irecsize;
-      ((PU_EMRPOLYBEZIER) record)->rclBounds = rclBounds;
-      ((PU_EMRPOLYBEZIER) record)->cptl      = cptl;
-      memcpy(((PU_EMRPOLYBEZIER) record)->aptl,points,cbPoints);
+      ((PU_EMR)                  record)->iType = U_EMR_SETWORLDTRANSFORM;
+      ((PU_EMR)                  record)->nSize = irecsize;
+      ((PU_EMRSETWORLDTRANSFORM) record)->xform = xform;
    }
    return(record);
 } 
 
-// Functions with the same form starting with U_EMR_POLYPOLYLINE
-char *U_EMR_CORE2_set(uint32_t iType, U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts,const uint32_t cptl, const U_POINTL *points){
+// U_EMRMODIFYWORLDTRANSFORM_set      36
+/**
+    \brief Allocate and construct a U_EMR_MODIFYWORLDTRANSFORM record.
+    \return pointer to U_EMR_MODIFYWORLDTRANSFORM record, or NULL on error.
+    \param xform Transform to use
+    \param iMode ModifyWorldTransformMode Enumeration
+*/
+char *U_EMRMODIFYWORLDTRANSFORM_set(
+      const U_XFORM  xform,
+      const uint32_t iMode
+   ){
    char *record;
-   int   cbPolys,cbPoints,off;
-   int   irecsize;
+   int irecsize;
 
-   cbPoints    = sizeof(U_POINTL)*cptl;
-   cbPolys    = sizeof(uint32_t)*nPolys;
-   irecsize = sizeof(U_EMRPOLYPOLYLINE) + cbPoints + cbPolys - sizeof(uint32_t); // First instance of each is in struct
+   irecsize = sizeof(U_EMRMODIFYWORLDTRANSFORM);
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)             record)->iType     = iType;
-      ((PU_EMR)             record)->nSize     = irecsize;
-      ((PU_EMRPOLYPOLYLINE) record)->rclBounds = rclBounds;
-      ((PU_EMRPOLYPOLYLINE) record)->nPolys    = nPolys;
-      ((PU_EMRPOLYPOLYLINE) record)->cptl      = cptl;
-      memcpy(((PU_EMRPOLYPOLYLINE) record)->aPolyCounts,aPolyCounts,cbPolys); 
-      off = sizeof(U_EMRPOLYPOLYLINE) - 4 + cbPolys;
-      memcpy(record + off,points,cbPoints);   
+      ((PU_EMR)                     record)->iType = U_EMR_MODIFYWORLDTRANSFORM;
+      ((PU_EMR)                     record)->nSize = irecsize;
+      ((PU_EMRMODIFYWORLDTRANSFORM) record)->xform = xform;
+      ((PU_EMRMODIFYWORLDTRANSFORM) record)->iMode = iMode;
    }
    return(record);
 } 
 
-// Functions with the same form starting with U_EMR_SETMAPMODE_set
-char *U_EMR_CORE3_set(uint32_t iType, uint32_t iMode){
+// U_EMRSELECTOBJECT_set              37
+/**
+    \brief Allocate and construct a U_EMR_SELECTOBJECT record.
+    Use selectobject_set() instead of calling this function directly.
+    \return pointer to U_EMR_SELECTOBJECT record, or NULL on error.
+    \param ihObject Number of a stock or created object
+*/
+char *U_EMRSELECTOBJECT_set(
+      const uint32_t ihObject 
+   ){
    char *record;
-   int   irecsize;
+   int  irecsize;
 
-   irecsize = sizeof(U_EMRSETMAPMODE);
+   irecsize = sizeof(U_EMRSELECTOBJECT);
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)          record)->iType     = iType;
-      ((PU_EMR)          record)->nSize     = irecsize;
-      ((PU_EMRSETMAPMODE)record)->iMode     = iMode;
+      ((PU_EMR)             record)->iType    = U_EMR_SELECTOBJECT;
+      ((PU_EMR)             record)->nSize    = irecsize;
+      ((PU_EMRSELECTOBJECT) record)->ihObject = ihObject;  // Index of object to SELECT
    }
    return(record);
 } 
 
-// Functions taking a single U_RECT or U_RECTL, starting with U_EMRELLIPSE_set, also U_EMRFILLPATH, 
-char *U_EMR_CORE4_set(uint32_t iType, U_RECTL rclBox){
+// U_EMRCREATEPEN_set                 38
+/**
+    \brief Allocate and construct a U_EMR_CREATEPEN record.
+    Use createpen_set() instead of calling this function directly.
+    \return pointer to U_EMR_CREATEPEN record, or NULL on error.
+    \param ihPen Handle of created pen
+    \param lopn  U_LOGPEN structure describing this pen
+*/
+char *U_EMRCREATEPEN_set(
+      const uint32_t ihPen,
+      const U_LOGPEN lopn
+   ){
    char *record;
-   int   irecsize;
+   int irecsize=sizeof(U_EMRCREATEPEN);
 
-   irecsize = sizeof(U_EMRELLIPSE);
-   record   = malloc(irecsize);
-   memset(record,0,irecsize);
+   record   = malloc(irecsize);    
    if(record){
-      ((PU_EMR)       record)->iType  = iType;
-      ((PU_EMR)       record)->nSize  = irecsize;
-      ((PU_EMRELLIPSE)record)->rclBox = rclBox;  // bounding rectangle in logical units
+      ((PU_EMR)          record)->iType = U_EMR_CREATEPEN;
+      ((PU_EMR)          record)->nSize = irecsize;
+      ((PU_EMRCREATEPEN) record)->ihPen = ihPen;
+      ((PU_EMRCREATEPEN) record)->lopn  = lopn;
    }
    return(record);
-} 
+}
 
-// Functions with the same form starting with U_EMRSETMETARGN_set
-char *U_EMR_CORE5_set(uint32_t iType){
+// U_EMRCREATEBRUSHINDIRECT_set       39
+/**
+    \brief Allocate and construct a U_EMR_CREATEBRUSHINDIRECT record.
+    Use createbrushindirect_set() instead of calling this function directly.
+    \return pointer to U_EMR_CREATEBRUSHINDIRECT record, or NULL on error.
+    \param ihBrush Index to place object in EMF object table (this entry must not yet exist) 
+    \param lb      Brush properties                                                          
+*/
+char *U_EMRCREATEBRUSHINDIRECT_set(
+      const uint32_t   ihBrush,
+      const U_LOGBRUSH lb
+   ){
    char *record;
-   int   irecsize = 8;
+   int  irecsize;
 
+   irecsize = sizeof(U_EMRCREATEBRUSHINDIRECT);
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)       record)->iType  = iType;
-      ((PU_EMR)       record)->nSize  = irecsize;
+      ((PU_EMR)                    record)->iType   = U_EMR_CREATEBRUSHINDIRECT;
+      ((PU_EMR)                    record)->nSize   = irecsize;
+      ((PU_EMRCREATEBRUSHINDIRECT) record)->ihBrush = ihBrush;  // Index to place object in EMF object table (this entry must not yet exist)
+      ((PU_EMRCREATEBRUSHINDIRECT) record)->lb      = lb;
    }
    return(record);
-}
+} 
 
-// Functions with the same form starting with U_EMRPOLYBEZIER16_set
-char *U_EMR_CORE6_set(uint32_t iType, U_RECTL rclBounds, const uint32_t cpts, const U_POINT16 *points){
+// U_EMRDELETEOBJECT_set              40
+/** 
+    \brief Allocate and construct a U_EMR_DELETEOBJECT record.
+    Use deleteobject_set() instead of calling this function directly.
+    \return pointer to U_EMR_DELETEOBJECT record, or NULL on error.
+    \param ihObject Number of a stock or created object
+*/
+char *U_EMRDELETEOBJECT_set(
+      const uint32_t ihObject
+   ){
    char *record;
-   int   cbPoints,cbPoints4,off;
-   int   irecsize;
+   int  irecsize;
 
-   cbPoints   = sizeof(U_POINT16)*cpts;
-   cbPoints4   = UP4(cbPoints);
-   off      = sizeof(U_EMR) + sizeof(U_RECTL) + sizeof(U_NUM_POINT16); // offset to the start of the variable region
-   irecsize = off + cbPoints4; // First instance is in struct
-   record    = malloc(irecsize);
+   irecsize = sizeof(U_EMRDELETEOBJECT);
+   record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)             record)->iType     = iType;
-      ((PU_EMR)             record)->nSize     = irecsize;
-      ((PU_EMRPOLYBEZIER16) record)->rclBounds = rclBounds;
-      ((PU_EMRPOLYBEZIER16) record)->cpts      = cpts;
-      memcpy(record + off, points, cbPoints);
-      if(cbPoints < cbPoints4){
-         off += cbPoints;
-         memset(record + off, 0, cbPoints4 - cbPoints);
-      }
+      ((PU_EMR)             record)->iType    = U_EMR_DELETEOBJECT;
+      ((PU_EMR)             record)->nSize    = irecsize;
+      ((PU_EMRDELETEOBJECT) record)->ihObject = ihObject;  // Index of object to DELETE
    }
    return(record);
 } 
 
-
-// Functions that take a single struct argument which contains two uint32_t, starting with U_EMRSETWINDOWEXTEX_set
-// these all pass two 32 bit ints and are cast by the caller to U_PAIR
-char *U_EMR_CORE7_set(uint32_t iType, U_PAIR pair){
+// U_EMRANGLEARC_set                  41
+/**
+    \brief Allocate and construct a U_EMR_ANGLEARC record.
+    \return pointer to U_EMR_ANGLEARC record, or NULL on error.
+    \param ptlCenter   Center in logical units
+    \param nRadius     Radius in logical units
+    \param eStartAngle Starting angle in degrees (counter clockwise from x axis)
+    \param eSweepAngle Sweep angle in degrees
+*/
+char *U_EMRANGLEARC_set(
+      const U_POINTL  ptlCenter,
+      const uint32_t  nRadius,
+      const U_FLOAT   eStartAngle,
+      const U_FLOAT   eSweepAngle
+   ){
    char *record;
-   int   irecsize = sizeof(U_EMRGENERICPAIR);
+   int  irecsize;
 
+   irecsize = sizeof(U_EMRANGLEARC);
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)           record)->iType   = iType;
-      ((PU_EMR)           record)->nSize   = irecsize;
-      ((PU_EMRGENERICPAIR)record)->pair    = pair;
+      ((PU_EMR)         record)->iType       = U_EMR_ANGLEARC;
+      ((PU_EMR)         record)->nSize       = irecsize;
+      ((PU_EMRANGLEARC) record)->ptlCenter   = ptlCenter;   
+      ((PU_EMRANGLEARC) record)->nRadius     = nRadius;     
+      ((PU_EMRANGLEARC) record)->eStartAngle = eStartAngle; 
+      ((PU_EMRANGLEARC) record)->eSweepAngle = eSweepAngle; 
    }
    return(record);
-}
+} 
 
-// For U_EMREXTTEXTOUTA and U_EMREXTTEXTOUTW
-char *U_EMR_CORE8_set(
-       uint32_t            iType,
-       U_RECTL             rclBounds,          // Bounding rectangle in device units
-       uint32_t            iGraphicsMode,      // Graphics mode Enumeration
-       U_FLOAT             exScale,            // scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
-       U_FLOAT             eyScale,            // scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
-       PU_EMRTEXT          emrtext             // Text parameters
+// U_EMRELLIPSE_set                   42
+/**
+    \brief Allocate and construct a U_EMR_ELLIPSE record.
+    \return pointer to U_EMR_ELLIPSE record, or NULL on error.
+    \param rclBox bounding rectangle in logical units
+*/
+char *U_EMRELLIPSE_set(
+      const U_RECTL rclBox
    ){
-   char *record;
-   int   irecsize,cbString,cbString4,cbDx,cbEmrtext,cbEmrtextAll;
-   uint32_t *loffDx;
-   int  csize;
-   
-   if(     iType == U_EMR_EXTTEXTOUTA){ csize = 1; } // how many bytes per character
-   else if(iType == U_EMR_EXTTEXTOUTW){ csize = 2; }
-   else { return(NULL); }
- 
-   cbString = csize * emrtext->nChars;
-   cbString4 = UP4(cbString);                                   // size of the string buffer
-   cbEmrtext = sizeof(U_EMRTEXT);                             // size of the constant part of the U_EMRTEXT structure
-   if(!(emrtext->fOptions & U_ETO_NO_RECT)){ cbEmrtext += sizeof(U_RECTL); } // plus the variable U_RECTL, when it is present
-   cbDx = emrtext->nChars * sizeof(int32_t);             // size of Dx buffer
-   if(emrtext->fOptions & U_ETO_PDY)cbDx += cbDx;      // size of Dx buffer when both x and y offsets are used
-   cbEmrtextAll = cbEmrtext + sizeof(uint32_t) + cbString4 + cbDx;   // structure (+- rect) + offDx + string buf + dx buf + offDx
-   
-   /* adjust offset fields in emrtext to match the EMRTEXTOUT* field, currently they match EMRTEXT.
-      This works because the variable pieces have all been moved outside of the U_EMRTEXT and U_EMRTEXTOUTA strutures.
-   */
-   ((PU_EMRTEXT)emrtext)->offString  += sizeof(U_EMREXTTEXTOUTA) - sizeof(U_EMRTEXT);   // adjust offString
-    loffDx = (uint32_t *)((char *)emrtext + cbEmrtext);
-    *loffDx += sizeof(U_EMREXTTEXTOUTA) - sizeof(U_EMRTEXT);
+   return(U_EMR_CORE4_set(NULL, U_EMR_ELLIPSE,rclBox));
+} 
 
-   // final record size is: U_EMREXTTEXTOUTA (includes constant part of U_EMRTEXT) + U_RECTL (if present) + offDx + dx buffer + string buffer
-   irecsize = sizeof(U_EMREXTTEXTOUTA) + cbEmrtextAll - sizeof(U_EMRTEXT); // do not count core emrtext strcture twice
-   record    = malloc(irecsize);
-   if(record){
-      ((PU_EMR)            record)->iType         = iType;
-      ((PU_EMR)            record)->nSize         = irecsize;
-      ((PU_EMREXTTEXTOUTA) record)->iGraphicsMode = iGraphicsMode;
-      ((PU_EMREXTTEXTOUTA) record)->rclBounds     = rclBounds;
-      ((PU_EMREXTTEXTOUTA) record)->exScale       = exScale;
-      ((PU_EMREXTTEXTOUTA) record)->eyScale       = eyScale;
-      // copy the adjusted U_EMRTEXT into the emrtext part of the full record..
-      memcpy(&(((PU_EMREXTTEXTOUTA) record)->emrtext), emrtext, cbEmrtextAll);
-   }
-   return(record);
+// U_EMRRECTANGLE_set                 43
+/**
+    \brief Allocate and construct a U_EMR_RECTANGLE record.
+    \return pointer to U_EMR_RECTANGLE record, or NULL on error.
+    \param rclBox bounding rectangle in logical units
+*/
+char *U_EMRRECTANGLE_set(
+      const U_RECTL rclBox
+   ){
+   return(U_EMR_CORE4_set(NULL, U_EMR_RECTANGLE,rclBox));
 } 
 
-// Functions that take a rect and a pair of points, starting with U_EMRARC_set
-char *U_EMR_CORE9_set(uint32_t iType, U_RECTL rclBox, U_POINTL ptlStart, U_POINTL ptlEnd){
+// U_EMRROUNDRECT_set                 44
+/**
+    \brief Allocate and construct a U_EMR_ROUNDRECT record.
+    \return pointer to U_EMR_ROUNDRECT record, or NULL on error.
+    \param rclBox    bounding rectangle in logical units
+    \param szlCorner W & H in logical units of ellipse used to round corner
+*/
+char *U_EMRROUNDRECT_set(
+      const U_RECTL rclBox,
+      const U_SIZEL szlCorner
+   ){
    char *record;
-   int   irecsize = sizeof(U_EMRARC);
+   int  irecsize;
 
+   irecsize = sizeof(U_EMRROUNDRECT);
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)           record)->iType    = iType;
-      ((PU_EMR)           record)->nSize    = irecsize;
-      ((PU_EMRARC)        record)->rclBox   = rclBox;
-      ((PU_EMRARC)        record)->ptlStart = ptlStart;
-      ((PU_EMRARC)        record)->ptlEnd   = ptlEnd;
+      ((PU_EMR)          record)->iType       = U_EMR_ROUNDRECT;
+      ((PU_EMR)          record)->nSize       = irecsize;
+      ((PU_EMRROUNDRECT) record)->rclBox      = rclBox;  
+      ((PU_EMRROUNDRECT) record)->szlCorner   = szlCorner;
    }
    return(record);
+} 
+
+// U_EMRARC_set                       45
+/**
+    \brief Allocate and construct a U_EMR_ARC record.
+    \return pointer to U_EMR_ARC record, or NULL on error.
+    \param rclBox   bounding rectangle in logical units
+    \param ptlStart Start point in logical units
+    \param ptlEnd   End point in logical units
+*/
+char *U_EMRARC_set(
+      const U_RECTL  rclBox,
+      const U_POINTL ptlStart,
+      const U_POINTL ptlEnd
+   ){
+   return(U_EMR_CORE9_set(NULL, U_EMR_ARC,rclBox, ptlStart, ptlEnd));
 }
 
-// Functions with the same form starting with U_EMR_POLYPOLYLINE16
-char *U_EMR_CORE10_set(uint32_t iType, U_RECTL rclBounds, const uint32_t nPolys, const uint32_t *aPolyCounts,const uint32_t cpts, const U_POINT16 *points){
-   char *record;
-   int   cbPoints,cbPolys,off;
-   int   irecsize;
+// U_EMRCHORD_set                     46
+/**
+    \brief Allocate and construct a U_EMR_CHORD record.
+    \return pointer to U_EMR_CHORD record, or NULL on error.
+    \param rclBox   bounding rectangle in logical units
+    \param ptlStart Start point in logical units
+    \param ptlEnd   End point in logical units
+*/
+char *U_EMRCHORD_set(
+      const U_RECTL  rclBox,
+      const U_POINTL ptlStart,
+      const U_POINTL ptlEnd
+   ){
+   return(U_EMR_CORE9_set(NULL, U_EMR_CHORD,rclBox, ptlStart, ptlEnd));
+}
 
-   cbPolys  = sizeof(uint32_t)*nPolys;
-   cbPoints = sizeof(U_POINT16)*cpts;
-   irecsize = sizeof(U_EMRPOLYPOLYLINE16) + cbPoints + cbPolys - sizeof(uint32_t); // First instance of each is in struct
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)               record)->iType     = iType;
-      ((PU_EMR)               record)->nSize     = irecsize;
-      ((PU_EMRPOLYPOLYLINE16) record)->rclBounds = rclBounds;
-      ((PU_EMRPOLYPOLYLINE16) record)->nPolys    = nPolys;
-      ((PU_EMRPOLYPOLYLINE16) record)->cpts      = cpts;
-      memcpy(((PU_EMRPOLYPOLYLINE16) record)->aPolyCounts,aPolyCounts,cbPolys); 
-      off = sizeof(U_EMRPOLYPOLYLINE16) - 4 + cbPolys;
-      memcpy(record + off,points,cbPoints);   
-   }
-   return(record);
-} 
+// U_EMRPIE_set                       47
+/**
+    \brief Allocate and construct a U_EMR_PIE record.
+    \return pointer to U_EMR_PIE record, or NULL on error.
+    \param rclBox   bounding rectangle in logical units
+    \param ptlStart Start point in logical units
+    \param ptlEnd   End point in logical units
+*/
+char *U_EMRPIE_set(
+      const U_RECTL  rclBox,
+      const U_POINTL ptlStart,
+      const U_POINTL ptlEnd
+   ){
+   return(U_EMR_CORE9_set(NULL, U_EMR_PIE,rclBox, ptlStart, ptlEnd));
+}
 
-// common code for U_EMRINVERTRGN and U_EMRPAINTRGN,
-char *U_EMR_CORE11_set(uint32_t iType, PU_RGNDATA RgnData){
+// U_EMRSELECTPALETTE_set             48
+/**
+    \brief Allocate and construct a U_EMR_SELECTPALETTE record.
+    \return pointer to U_EMR_SELECTPALETTE record, or NULL on error.
+    \param ihPal Index of a Palette object in the EMF object table
+*/
+char *U_EMRSELECTPALETTE_set(
+      const uint32_t ihPal
+   ){
+   return(U_EMR_CORE3_set(NULL, U_EMR_SELECTPALETTE, ihPal));
+}
+
+// U_EMRCREATEPALETTE_set             49
+/**
+    \brief Allocate and construct a U_EMR_CREATEPALETTE record.
+    Use createpalette_set() instead of calling this function directly.
+    \return pointer to U_EMR_CREATEPALETTE record, or NULL on error.
+    \param ihPal Index to place object in EMF object table (this entry must not yet exist)
+    \param lgpl   Palette properties
+*/
+char *U_EMRCREATEPALETTE_set(
+      const uint32_t     ihPal,
+      const U_LOGPALETTE lgpl
+   ){
    char *record;
-   int   irecsize;
-   int   cbRgns,cbRgns4,rds,rds4,off;
+   int  irecsize;
 
-   if(!RgnData)return(NULL);
-   cbRgns   = ((PU_RGNDATAHEADER) RgnData)->nRgnSize;
-   cbRgns4  = UP4(cbRgns);
-   rds      = sizeof(U_RGNDATAHEADER) + cbRgns;
-   rds4     = UP4(rds);
-   irecsize = sizeof(U_EMRINVERTRGN) - sizeof(U_RECTL) + cbRgns4;  // core + array - overlap of one rectL
-   record    = malloc(irecsize);
+   irecsize = sizeof(U_EMRCREATEPALETTE);
+   record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)           record)->iType     = iType;
-      ((PU_EMR)           record)->nSize     = irecsize;
-      ((PU_EMRINVERTRGN)  record)->rclBounds = ((PU_RGNDATAHEADER) RgnData)->rclBounds;
-      ((PU_EMRINVERTRGN)  record)->cbRgnData = rds;
-      off = sizeof(U_EMRINVERTRGN) - sizeof(U_RGNDATA);
-      memcpy(record + off, RgnData, rds);
-      off += rds;
-      if(rds < rds4){ memset(record + off,0, rds4 - rds); } // clear any unused bytes
+      ((PU_EMR)              record)->iType   = U_EMR_CREATEPALETTE;
+      ((PU_EMR)              record)->nSize   = irecsize;
+      ((PU_EMRCREATEPALETTE) record)->ihPal   = ihPal;
+      ((PU_EMRCREATEPALETTE) record)->lgpl    = lgpl;
    }
    return(record);
-} 
-
+}
 
-// common code for U_EMRCREATEMONOBRUSH_set and U_EMRCREATEDIBPATTERNBRUSHPT_set,
-char *U_EMR_CORE12_set(
-       uint32_t            iType,
-       uint32_t            ihBrush,            // Index to place object in EMF object table (this entry must not yet exist)
-       uint32_t            iUsage,             // DIBcolors Enumeration
-       PU_BITMAPINFO       Bmi,                // (Optional) bitmapbuffer (U_BITMAPINFO + pixel array)
-       const uint32_t      cbPx,               // Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-       const char         *Px                  // (Optional) bitmapbuffer (pixel array section )
+// U_EMRSETPALETTEENTRIES_set         50
+/**
+    \brief Allocate and construct a U_EMR_SETPALETTEENTRIES record.
+    Use setpaletteentries_set() instead of calling this function directly.
+    \return pointer to U_EMR_SETPALETTEENTRIES record, or NULL on error.
+    \param ihPal        Index of a Palette object in the EMF object table
+    \param iStart       First Palette entry in selected object to set
+    \param cEntries     Number of Palette entries in selected object to set
+    \param aPalEntries  Values to set with
+*/
+char *U_EMRSETPALETTEENTRIES_set(
+      const uint32_t         ihPal,
+      const uint32_t         iStart,
+      const U_NUM_LOGPLTNTRY cEntries,
+      const PU_LOGPLTNTRY    aPalEntries
    ){
    char *record;
-   int   irecsize;
-   int   cbImage,cbImage4,cbBmi,off;
+   int  irecsize;
+   int  cbPals;
 
-   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
-   
-   irecsize = sizeof(U_EMRCREATEMONOBRUSH) + cbBmi + cbImage4;
+   if(!aPalEntries)return(NULL);
+   cbPals    = cEntries * sizeof(U_LOGPLTNTRY);
+   irecsize = sizeof(U_EMRSETPALETTEENTRIES) + cbPals - sizeof(U_LOGPLTNTRY);
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)                      record)->iType   = iType;                        
-      ((PU_EMR)                      record)->nSize   = irecsize;                     
-      ((PU_EMRCREATEMONOBRUSH)       record)->ihBrush = ihBrush;                      
-      ((PU_EMRCREATEMONOBRUSH)       record)->iUsage  = iUsage;                       
-      if(cbBmi){
-         off = sizeof(U_EMRCREATEMONOBRUSH);
-         memcpy(record + off, Bmi, cbBmi);
-         ((PU_EMRCREATEMONOBRUSH)    record)->offBmi  = off;                          
-         ((PU_EMRCREATEMONOBRUSH)    record)->cbBmi   = cbBmi;   
-         off += cbBmi;
-         memcpy(record + off, Px, cbPx);
-         ((PU_EMRCREATEMONOBRUSH)    record)->offBits = off;                        
-         ((PU_EMRCREATEMONOBRUSH)    record)->cbBits  = cbImage;
-      }
-      else {
-         ((PU_EMRCREATEMONOBRUSH)    record)->offBmi  = 0;                            
-         ((PU_EMRCREATEMONOBRUSH)    record)->cbBmi   = 0;                            
-         ((PU_EMRCREATEMONOBRUSH)    record)->offBits = 0;                            
-         ((PU_EMRCREATEMONOBRUSH)    record)->cbBits  = 0;                            
-      }
+      ((PU_EMR)                  record)->iType      = U_EMR_SETPALETTEENTRIES;
+      ((PU_EMR)                  record)->nSize      = irecsize;
+      ((PU_EMRSETPALETTEENTRIES) record)->ihPal      = ihPal;
+      ((PU_EMRSETPALETTEENTRIES) record)->iStart     = iStart;
+      ((PU_EMRSETPALETTEENTRIES) record)->cEntries   = cEntries;
+      memcpy(((PU_EMRSETPALETTEENTRIES) record)->aPalEntries, aPalEntries,cbPals);
    }
    return(record);
 }
 
-// common code for U_EMRBLEND_set and U_EMRTRANSPARENTBLT_set,
-char *U_EMR_CORE13_set(
-      uint32_t             iType,
-      U_RECTL              rclBounds,       // Bounding rectangle in device units
-      U_POINTL             Dest,            // Destination UL corner in logical units
-      U_POINTL             cDest,           // Destination width in logical units
-      U_POINTL             Src,             // Source UL corner in logical units
-      U_POINTL             cSrc,            // Src W & H in logical units
-      U_XFORM              xformSrc,        // Transform to apply to source
-      U_COLORREF           crBkColorSrc,    // Background color
-      uint32_t             iUsageSrc,       // DIBcolors Enumeration
-      uint32_t             Data,            // The meaning and type of this field varies, but it is always 4 bytes
-      const PU_BITMAPINFO  Bmi,             // (Optional) bitmapbuffer (U_BITMAPINFO section)
-      const uint32_t       cbPx,            // Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-      char                *Px               // (Optional) bitmapbuffer (pixel array section )
+// U_EMRRESIZEPALETTE_set             51
+/**
+    \brief Allocate and construct a U_EMR_RESIZEPALETTE record.
+    \return pointer to U_EMR_RESIZEPALETTE record, or NULL on error.
+    \param ihPal    Index of a Palette object in the EMF object table
+    \param cEntries Number to expand or truncate the Palette entry list to
+*/
+char *U_EMRRESIZEPALETTE_set(
+      const uint32_t ihPal,
+      const uint32_t cEntries
+   ){
+   return(U_EMR_CORE7_set(NULL, U_EMR_RESIZEPALETTE, (U_PAIR){ihPal,cEntries}));
+}
+
+// U_EMRREALIZEPALETTE_set            52
+/**
+    \brief Allocate and construct a U_EMR_REALIZEPALETTE record.
+    \return pointer to U_EMR_REALIZEPALETTE record, or NULL on error.
+*/
+char *U_EMRREALIZEPALETTE_set(void){
+  return(U_EMR_CORE5_set(NULL, U_EMR_REALIZEPALETTE));
+}
+
+// U_EMREXTFLOODFILL_set              53
+/**
+    \brief Allocate and construct a U_EMR_EXTFLOODFILL record.
+    \return pointer to U_EMR_EXTFLOODFILL record, or NULL on error.
+    \param ptlStart Start point in logical units
+    \param crColor  Color to fill with
+    \param iMode    FloodFill Enumeration
+*/
+char *U_EMREXTFLOODFILL_set(
+      const U_POINTL   ptlStart,
+      const U_COLORREF crColor,
+      const uint32_t   iMode
    ){
    char *record;
-   int   irecsize;
-   int   cbImage,cbImage4,cbBmi,off;
+   int  irecsize;
 
-   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
-   
-   irecsize = sizeof(U_EMRALPHABLEND) + cbBmi + cbImage4;
+   irecsize = sizeof(U_EMREXTFLOODFILL);
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)                 record)->iType        = iType;
-      ((PU_EMR)                 record)->nSize        = irecsize;
-      ((PU_EMRALPHABLEND)       record)->rclBounds    = rclBounds;
-      ((PU_EMRALPHABLEND)       record)->Dest         = Dest;
-      ((PU_EMRALPHABLEND)       record)->cDest        = cDest;
-      ((PU_EMRALPHABLEND)       record)->Blend        =  *((PU_BLEND)&Data);
-      ((PU_EMRALPHABLEND)       record)->Src          = Src;
-      ((PU_EMRALPHABLEND)       record)->xformSrc     = xformSrc;
-      ((PU_EMRALPHABLEND)       record)->crBkColorSrc = crBkColorSrc;
-      ((PU_EMRALPHABLEND)       record)->iUsageSrc    = iUsageSrc;
-      off = sizeof(U_EMRALPHABLEND);
-      APPEND_PXBMISRC(record, U_EMRALPHABLEND, cbBmi, Bmi, Px, cbImage, cbImage4);
-      ((PU_EMRALPHABLEND)       record)->cSrc         = cSrc;
+      ((PU_EMR)             record)->iType    = U_EMR_EXTFLOODFILL; 
+      ((PU_EMR)             record)->nSize    = irecsize;           
+      ((PU_EMREXTFLOODFILL) record)->ptlStart = ptlStart;           
+      ((PU_EMREXTFLOODFILL) record)->crColor  = crColor;            
+      ((PU_EMREXTFLOODFILL) record)->iMode    = iMode;              
    }
    return(record);
 }
-//! @endcond
-
-/* **********************************************************************************************
-These are the core EMR functions, each creates a particular type of record.  
-All return these records via a char* pointer, which is NULL if the call failed.  
-They are listed in order by the corresponding U_EMR_* index number.  
-*********************************************************************************************** */
 
-// U_EMRHEADER_set                     1
+// U_EMRLINETO_set                    54
+/**
+    \brief Allocate and construct a U_EMR_LINETO record.
+    \return pointer to U_EMR_LINETO record, or NULL on error.
+    \param ptl Point coordinates
+*/
+char *U_EMRLINETO_set(
+      const U_POINTL ptl
+   ){
+   return(U_EMR_CORE7_set(NULL, U_EMR_LINETO, ptl));
+}
 
+// U_EMRARCTO_set                     55
 /**
-    \brief Allocate and construct a U_EMRHEADER record.
-    \return pointer to U_EMRHEADER record, or NULL on error.
-    \param rclBounds       Bounding rectangle in device units 
-    \param rclFrame        Bounding rectangle in 0.01 mm units
-    \param pfmtDesc        Pointer to a PixelFormatDescriptor
-    \param nDesc           number of characters in Description, will include first three '\0'
-    \param Description     Description, formatted like: text1\0text2\0\0
-    \param szlDevice       Reference device size in pixels  
-    \param szlMillimeters  Reference device size in 0.01 mm
-    \param bOpenGL         nonZero if OpenGL commands are included
+    \brief Allocate and construct a U_EMR_ARCTO record.
+    \return pointer to U_EMR_ARCTO record, or NULL on error.
+    \param rclBox   bounding rectangle in logical units
+    \param ptlStart Start point in logical units
+    \param ptlEnd   End point in logical units
+    
+    Note that the draw begins with a line from the current point to ptlStart, which is
+    not indicated in the Microsoft EMF documentation for this record.
 */
-char *U_EMRHEADER_set( 
-      const U_RECTL                  rclBounds,
-      const U_RECTL                  rclFrame,
-      U_PIXELFORMATDESCRIPTOR* const pfmtDesc,
-      U_CBSTR                        nDesc,
-      uint16_t* const                Description,
-      const U_SIZEL                  szlDevice,
-      const U_SIZEL                  szlMillimeters,
-      const uint32_t                 bOpenGL
+char *U_EMRARCTO_set(
+      U_RECTL             rclBox,
+      U_POINTL            ptlStart,
+      U_POINTL            ptlEnd
    ){
+   return(U_EMR_CORE9_set(NULL, U_EMR_ARCTO,rclBox, ptlStart, ptlEnd));
+}
 
-   char *record; 
-   int cbPFD,cbDesc,cbDesc4;
-   uint32_t off;
-   int irecsize;
+// U_EMRPOLYDRAW_set                  56
+/**
+    \brief Allocate and construct a U_EMR_POLYDRAW record.
+    \return pointer to U_EMR_POLYDRAW record, or NULL on error.
+    \param rclBounds Bounding rectangle in device units
+    \param cptl      Number of U_POINTL objects
+    \param aptl      Array of U_POINTL objects
+    \param abTypes   Array of Point Enumeration 
+*/
+char *U_EMRPOLYDRAW_set(
+      const U_RECTL       rclBounds,
+      const U_NUM_POINTL  cptl,
+      const U_POINTL     *aptl,
+      const uint8_t      *abTypes
+   ){
+   char *record;
+   int  irecsize;
+   int  cbPoints, cbAbTypes, cbAbTypes4, off;
 
-   if(pfmtDesc){    cbPFD = sizeof(U_PIXELFORMATDESCRIPTOR); }
-   else  {          cbPFD = 0;                               }
-   if(Description){ cbDesc = 2*nDesc;                         } // also copy the terminator.  Size is in bytes
-   else  {          cbDesc = 0;                               }
-   cbDesc4  = UP4(cbDesc);
-   irecsize = sizeof(U_EMRHEADER) + cbPFD + cbDesc4;
+   if(!cptl || !aptl || !abTypes)return(NULL);
+   cbPoints    = cptl * sizeof(U_POINTL);    // space for aptl
+   cbAbTypes    = cptl;                       // number of abTypes (same array size, 1 byte each)
+   cbAbTypes4    = UP4(cbAbTypes);                // space for abTypes
+   irecsize = sizeof(U_EMRPOLYDRAW) + cbPoints + cbAbTypes4 - sizeof(U_POINTL) - 1;
    record   = malloc(irecsize);
    if(record){
-      off = sizeof(U_EMRHEADER);
-      ((PU_EMR)           record)->iType             = U_EMR_HEADER;
-      ((PU_EMR)           record)->nSize             = irecsize;
-      ((PU_EMRHEADER)     record)->rclBounds         = rclBounds;
-      ((PU_EMRHEADER)     record)->rclFrame          = rclFrame;
-      ((PU_EMRHEADER)     record)->dSignature        = U_ENHMETA_SIGNATURE;
-      ((PU_EMRHEADER)     record)->nVersion          = U_ENHMETA_VERSION;  
-      ((PU_EMRHEADER)     record)->nBytes            = 0;  // Not known yet
-      ((PU_EMRHEADER)     record)->nRecords          = 0;  // Not known yet
-      ((PU_EMRHEADER)     record)->nHandles          = 0;  // Not known yet
-      ((PU_EMRHEADER)     record)->sReserved         = 0;  // Must be 0
-      ((PU_EMRHEADER)     record)->nDescription      = nDesc;
-      ((PU_EMRHEADER)     record)->offDescription    = 0;  // may change below  
-      ((PU_EMRHEADER)     record)->nPalEntries       = 0;  // Not known yet
-      ((PU_EMRHEADER)     record)->szlDevice         = szlDevice;
-      ((PU_EMRHEADER)     record)->szlMillimeters    = szlMillimeters;
-      ((PU_EMRHEADER)     record)->cbPixelFormat     = cbPFD;
-      ((PU_EMRHEADER)     record)->offPixelFormat    = 0;  // may change below 
-      ((PU_EMRHEADER)     record)->bOpenGL           = bOpenGL;
-      ((PU_EMRHEADER)     record)->szlMicrometers.cx = szlMillimeters.cx*1000;   
-      ((PU_EMRHEADER)     record)->szlMicrometers.cy = szlMillimeters.cy*1000;   
-      if(cbDesc4){
-          ((PU_EMRHEADER) record)->offDescription    = off;
-          memcpy(record + off, Description, cbDesc);
-          off += cbDesc;
-          if(cbDesc < cbDesc4)memset(record + off,0,cbDesc4-cbDesc);  // clear any unused bytes
-          off += cbDesc4 - cbDesc;
-      }
-      if(cbPFD){
-         ((PU_EMRHEADER)  record)->offPixelFormat   = off;
-         memcpy(record+off,pfmtDesc,cbPFD);    
-      }
+      ((PU_EMR)         record)->iType       = U_EMR_POLYDRAW;
+      ((PU_EMR)         record)->nSize       = irecsize;
+      ((PU_EMRPOLYDRAW) record)->rclBounds   = rclBounds;
+      ((PU_EMRPOLYDRAW) record)->cptl        = cptl;
+      off = sizeof(U_EMR) + sizeof(U_RECTL) + sizeof(uint32_t);  // offset to first variable part
+      memcpy(record+off,aptl,cbPoints);
+      off += cbPoints;
+      memcpy(record+off,abTypes,cbAbTypes);
+      off += cbAbTypes;
+      if(cbAbTypes4 > cbAbTypes){ memset(record+off,0,cbAbTypes4-cbAbTypes); } // keeps valgrind happy (initialize padding after byte array)
    }
    return(record);
+}   
+
+// U_EMRSETARCDIRECTION_set           57
+/**
+    \brief Allocate and construct a U_EMR_SETARCDIRECTION record.
+    \return pointer to U_EMR_SETARCDIRECTION record, or NULL on error.
+    \param iArcDirection ArcDirection Enumeration
+*/
+char *U_EMRSETARCDIRECTION_set(
+      const uint32_t iArcDirection
+   ){
+   return(U_EMR_CORE3_set(NULL, U_EMR_SETARCDIRECTION, iArcDirection));
+}
+
+// U_EMRSETMITERLIMIT_set             58
+/**
+    \brief Allocate and construct a U_EMR_SETMITERLIMIT record.
+    \return pointer to U_EMR_SETMITERLIMIT record, or NULL on error.
+    \param eMiterLimit MapMode Enumeration
+*/
+char *U_EMRSETMITERLIMIT_set(
+      const uint32_t eMiterLimit
+   ){
+   return(U_EMR_CORE3_set(NULL, U_EMR_SETMITERLIMIT, eMiterLimit));
 }
 
-// U_EMRPOLYBEZIER_set                 2
+
+// U_EMRBEGINPATH_set                 59
 /**
-    \brief Allocate and construct a U_EMR_POLYBEZIER record.
-    \return pointer to U_EMR_POLYBEZIER record, or NULL on error.
-    \param rclBounds   bounding rectangle in device units
-    \param cptl        Number of points to draw
-    \param points      array of points
+    \brief Allocate and construct a U_EMR_BEGINPATH record.
+    \return pointer to U_EMR_BEGINPATH record, or NULL on error.
 */
-char *U_EMRPOLYBEZIER_set(
-      const U_RECTL   rclBounds,
-      const uint32_t  cptl,
-      const U_POINTL *points
-   ){
-   return(U_EMR_CORE1_set(U_EMR_POLYBEZIER, rclBounds, cptl, points));
-} 
+char *U_EMRBEGINPATH_set(void){
+   return(U_EMR_CORE5_set(NULL, U_EMR_BEGINPATH));
+}
 
-// U_EMRPOLYGON_set                    3
+// U_EMRENDPATH_set                   60
 /**
-    \brief Allocate and construct a U_EMR_POLYGON record.
-    \return pointer to U_EMR_POLYGON record, or NULL on error.
-    \param rclBounds   bounding rectangle in device units
-    \param cptl        Number of points to draw
-    \param points      array of points
+    \brief Allocate and construct a U_EMR_ENDPATH record.
+    \return pointer to U_EMR_ENDPATH record, or NULL on error.
 */
-char *U_EMRPOLYGON_set(
-      const U_RECTL   rclBounds,
-      const uint32_t  cptl,
-      const U_POINTL *points
-   ){
-   return(U_EMR_CORE1_set(U_EMR_POLYGON, rclBounds, cptl, points));
-} 
+char *U_EMRENDPATH_set(void){
+   return(U_EMR_CORE5_set(NULL, U_EMR_ENDPATH));
+}
 
-// U_EMRPOLYLINE_set                   4
+// U_EMRCLOSEFIGURE_set               61
 /**
-    \brief Allocate and construct a U_EMR_POLYLINE record.
-    \return pointer to U_EMR_POLYLINE record, or NULL on error.
-    \param rclBounds   bounding rectangle in device units
-    \param cptl        Number of points to draw
-    \param points      array of points
+    \brief Allocate and construct a U_EMR_CLOSEFIGURE record.
+    \return pointer to U_EMR_CLOSEFIGURE record, or NULL on error.
 */
-char *U_EMRPOLYLINE_set(
-      const U_RECTL   rclBounds,
-      const uint32_t  cptl,
-      const U_POINTL *points
+char *U_EMRCLOSEFIGURE_set(void){
+   return(U_EMR_CORE5_set(NULL, U_EMR_CLOSEFIGURE));
+}
+
+// U_EMRFILLPATH_set                  62
+/**
+    \brief Allocate and construct a U_EMR_FILLPATH record.
+    \return pointer to U_EMR_FILLPATH record, or NULL on error.
+    \param rclBox Bounding rectangle in device units
+    
+    U_EMR_FILLPATH closes the open figure before filling.
+*/
+char *U_EMRFILLPATH_set(
+      const U_RECTL rclBox
    ){
-   return(U_EMR_CORE1_set(U_EMR_POLYLINE, rclBounds, cptl, points));
+   return(U_EMR_CORE4_set(NULL, U_EMR_FILLPATH,rclBox));
 } 
 
-// U_EMRPOLYBEZIERTO_set               5
+// U_EMRSTROKEANDFILLPATH_set         63
 /**
-    \brief Allocate and construct a U_EMR_POLYBEZIERTO record.
-    \return pointer to U_EMR_POLYBEZIERTO record, or NULL on error.
-    \param rclBounds   bounding rectangle in device units
-    \param cptl        Number of points to draw
-    \param points      array of points
+    \brief Allocate and construct a U_EMR_STROKEANDFILLPATH record.
+    \return pointer to U_EMR_STROKEANDFILLPATH record, or NULL on error.
+    \param rclBox Bounding rectangle in device units
+
+    U_EMR_STROKEANDFILLPATH closes the open figure before filling and stroking.
+    There appears to be no way to fill an open path while stroking it, as any one
+    of U_EMRFILLPATH, U_EMRSTROKEPATH, or U_EMRSTROKEANDFILEPATH will "use up" the path,
 */
-char *U_EMRPOLYBEZIERTO_set(
-      const U_RECTL   rclBounds,
-      const uint32_t  cptl,
-      const U_POINTL *points
+char *U_EMRSTROKEANDFILLPATH_set(
+      const U_RECTL rclBox
    ){
-   return(U_EMR_CORE1_set(U_EMR_POLYBEZIERTO, rclBounds, cptl, points));
+   return(U_EMR_CORE4_set(NULL, U_EMR_STROKEANDFILLPATH,rclBox));
 } 
 
-// U_EMRPOLYLINETO_set                 6
+// U_EMRSTROKEPATH_set                64
 /**
-    \brief Allocate and construct a U_EMR_POLYLINETO record.
-    \return pointer to U_EMR_POLYLINETO record, or NULL on error.
-    \param rclBounds   bounding rectangle in device units
-    \param cptl        Number of points to draw
-    \param points      array of points
+    \brief Allocate and construct a U_EMR_STROKEPATH record.
+    \return pointer to U_EMR_STROKEPATH record, or NULL on error.
+    \param rclBox Bounding rectangle in device units
+
+    U_EMR_STROKEPATH does NOT close the open figure before stroking it.
 */
-char *U_EMRPOLYLINETO_set(
-      const U_RECTL   rclBounds,
-      const uint32_t  cptl,
-      const U_POINTL *points
+char *U_EMRSTROKEPATH_set(
+      const U_RECTL rclBox
    ){
-   return(U_EMR_CORE1_set(U_EMR_POLYLINETO, rclBounds, cptl, points));
+   return(U_EMR_CORE4_set(NULL, U_EMR_STROKEPATH,rclBox));
 } 
 
-// U_EMRPOLYPOLYLINE_set               7
+// U_EMRFLATTENPATH_set               65
 /**
-    \brief Allocate and construct a U_EMR_POLYPOLYLINE record.
-    \return pointer to U_EMR_POLYPOLYLINE record, or NULL on error.
-    \param rclBounds    bounding rectangle in device units
-    \param nPolys       Number of elements in aPolyCounts
-    \param aPolyCounts  Number of points in each poly (sequential)
-    \param cptl         Total number of points (over all poly)
-    \param points       array of points
+    \brief Allocate and construct a U_EMR_FLATTENPATH record.
+    \return pointer to U_EMR_FLATTENPATH record, or NULL on error.
 */
-char *U_EMRPOLYPOLYLINE_set(
-      const U_RECTL   rclBounds,
-      const uint32_t  nPolys,
-      const uint32_t *aPolyCounts,
-      const uint32_t  cptl,
-      const U_POINTL *points
-   ){
-   return(U_EMR_CORE2_set(U_EMR_POLYPOLYLINE, rclBounds, nPolys, aPolyCounts,cptl, points));
+char *U_EMRFLATTENPATH_set(void){
+   return(U_EMR_CORE5_set(NULL, U_EMR_FLATTENPATH));
 }
 
-// U_EMRPOLYPOLYGON_set                8
+// U_EMRWIDENPATH_set                 66
 /**
-    \brief Allocate and construct a U_EMR_POLYPOLYGON record.
-    \return pointer to U_EMR_POLYPOLYGON record, or NULL on error.
-    \param rclBounds    bounding rectangle in device units
-    \param nPolys       Number of elements in aPolyCounts
-    \param aPolyCounts  Number of points in each poly (sequential)
-    \param cptl         Total number of points (over all poly)
-    \param points       array of points
+    \brief Allocate and construct a U_EMR_WIDENPATH record.
+    \return pointer to U_EMR_WIDENPATH record, or NULL on error.
 */
-char *U_EMRPOLYPOLYGON_set(
-      const U_RECTL   rclBounds,
-      const uint32_t  nPolys,
-      const uint32_t *aPolyCounts,
-      const uint32_t  cptl,
-      const U_POINTL *points
-   ){
-   return(U_EMR_CORE2_set(U_EMR_POLYPOLYGON, rclBounds, nPolys, aPolyCounts,cptl, points));
+char *U_EMRWIDENPATH_set(void){
+   return(U_EMR_CORE5_set(NULL, U_EMR_WIDENPATH));
 }
 
-// U_EMRSETWINDOWEXTEX_set             9
-/** 
-    \brief Allocate and construct a U_EMR_SETWINDOWEXTEX record.
-    \return pointer to U_EMR_SETWINDOWEXTEX record, or NULL on error.
-    \param szlExtent H & V extent in logical units
+// U_EMRSELECTCLIPPATH_set            67
+/**
+    \brief Allocate and construct a U_EMR_SELECTCLIPPATH record.
+    \return pointer to U_EMR_SELECTCLIPPATH record, or NULL on error.
+    \param iMode RegionMode Enumeration
 */
-char *U_EMRSETWINDOWEXTEX_set(
-      const U_SIZEL szlExtent 
-   ){
-   U_PAIR temp;
-   temp.x = szlExtent.cx;
-   temp.y = szlExtent.cy;
-   return(U_EMR_CORE7_set(U_EMR_SETWINDOWEXTEX, temp)); 
+char *U_EMRSELECTCLIPPATH_set(
+      const uint32_t iMode
+   ){ 
+   return(U_EMR_CORE3_set(NULL, U_EMR_SELECTCLIPPATH, iMode));
+}
+
+// U_EMRABORTPATH_set                 68
+/**
+    \brief Allocate and construct a U_EMR_ABORTPATH record.
+    \return pointer to U_EMR_ABORTPATH record, or NULL on error.
+*/
+char *U_EMRABORTPATH_set(void){
+   return(U_EMR_CORE5_set(NULL, U_EMR_ABORTPATH));
 }
 
-// U_EMRSETWINDOWORGEX_set            10
+// U_EMRUNDEF69                       69
+
+// U_EMRCOMMENT_set                   70  Comment (any binary data, interpretation is program specific)
+/**
+    \brief Allocate and construct a U_EMR_COMMENT record.
+    \return pointer to U_EMR_COMMENT record, or NULL on error.
+    \param cbData Number of bytes in comment
+    \param Data   Comment (any binary data, interpretation is program specific)
+*/
+char *U_EMRCOMMENT_set(
+      const U_CBDATA cbData,
+      const char    *Data
+   ){
+   char *record;
+   unsigned int   cbData4;
+   int   irecsize;
+
+   cbData4    = UP4(cbData);
+   irecsize = sizeof(U_EMR) + sizeof(U_CBDATA) + cbData4;
+   record    = malloc(irecsize);
+   if(record){
+      ((PU_EMR)           record)->iType   = U_EMR_COMMENT;
+      ((PU_EMR)           record)->nSize   = irecsize;
+      ((PU_EMRCOMMENT)    record)->cbData  = cbData;
+      memcpy(record + irecsize - cbData4,Data,cbData);
+      if(cbData4 > cbData)memset(record + irecsize - cbData4 + cbData,0,cbData4-cbData);  // clear any unused bytes
+   }
+   return(record);
+} 
+
+// U_EMRFILLRGN_set                   71
+/**
+    \brief Allocate and construct a U_EMR_FILLRGN record.
+    Use fillrgn_set() instead of calling this function directly.
+    \return pointer to U_EMR_FILLRGN record, or NULL on error.
+    \param rclBounds  Bounding rectangle in device units
+    \param ihBrush    Index of a Brush object in the EMF object table
+    \param RgnData    Pointer to a U_RGNDATA structure
+*/
+char *U_EMRFILLRGN_set(
+      const U_RECTL     rclBounds,
+      const uint32_t    ihBrush,
+      const PU_RGNDATA  RgnData
+   ){
+   char *record;
+   int   irecsize;
+   int   cbRgns,cbRgns4,rds,rds4,off;
+
+   if(!RgnData)return(NULL);
+   cbRgns   = ((PU_RGNDATAHEADER) RgnData)->nRgnSize;
+   cbRgns4  = UP4(cbRgns);
+   rds      = sizeof(U_RGNDATAHEADER) + cbRgns;
+   rds4     = UP4(rds);
+   irecsize = sizeof(U_EMRFILLRGN) - sizeof(U_RECTL) + cbRgns4;  // core + array - overlap of one rectL
+   record    = malloc(irecsize);
+   if(record){
+      ((PU_EMR)           record)->iType     = U_EMR_FILLRGN;
+      ((PU_EMR)           record)->nSize     = irecsize;
+      ((PU_EMRFILLRGN)    record)->rclBounds = rclBounds;
+      ((PU_EMRFILLRGN)    record)->cbRgnData = rds;
+      ((PU_EMRFILLRGN)    record)->ihBrush   = ihBrush;
+      off = sizeof(U_EMRFILLRGN) - sizeof(U_RGNDATA);
+      memcpy(record + off, RgnData, rds);
+      off += rds;
+      if(rds < rds4){ memset(record + off,0, rds4 - rds); } // clear any unused bytes
+   }
+   return(record);
+} 
+
+// U_EMRFRAMERGN_set                  72
+/**
+    \brief Allocate and construct a U_EMR_FRAMERGN record.
+    Use framegrn_set() instead of calling this function directly.
+    \return pointer to U_EMR_FRAMERGN record, or NULL on error.
+    \param rclBounds  Bounding rectangle in device units
+    \param ihBrush    Index of a Brush object in the EMF object table
+    \param szlStroke  W & H of Brush stroke
+    \param RgnData    Pointer to a U_RGNDATA structure
+*/
+char *U_EMRFRAMERGN_set(
+      const U_RECTL     rclBounds,
+      const uint32_t    ihBrush,
+      const U_SIZEL     szlStroke,
+      const PU_RGNDATA  RgnData
+   ){
+   char *record;
+   int   irecsize;
+   int   cbRgns,cbRgns4,rds,rds4,off;
+
+   if(!RgnData)return(NULL);
+   cbRgns   = ((PU_RGNDATAHEADER) RgnData)->nRgnSize;
+   cbRgns4  = UP4(cbRgns);
+   rds      = sizeof(U_RGNDATAHEADER) + cbRgns;
+   rds4     = UP4(rds);
+   irecsize = sizeof(U_EMRFRAMERGN) - sizeof(U_RECTL) + cbRgns4;  // core + array - overlap of one rectL
+   record    = malloc(irecsize);
+   if(record){
+      ((PU_EMR)           record)->iType     = U_EMR_FRAMERGN;
+      ((PU_EMR)           record)->nSize     = irecsize;
+      ((PU_EMRFRAMERGN)   record)->rclBounds = rclBounds;
+      ((PU_EMRFRAMERGN)   record)->cbRgnData = rds;
+      ((PU_EMRFRAMERGN)   record)->ihBrush   = ihBrush;
+      ((PU_EMRFRAMERGN)   record)->szlStroke = szlStroke;
+      off = sizeof(U_EMRFRAMERGN) - sizeof(U_RGNDATA);
+      memcpy(record + off, RgnData, rds);
+      off += rds;
+      if(rds < rds4){ memset(record + off,0, rds4 - rds); } // clear any unused bytes
+   }
+   return(record);
+} 
+
+// U_EMRINVERTRGN_set                 73
 /**
-    \brief Allocate and construct a U_EMR_SETWINDOWORGEX record.
-    \return pointer to U_EMR_SETWINDOWORGEX record, or NULL on error.
-    \param ptlOrigin H & V origin in logical units
+    \brief Allocate and construct a U_EMR_INVERTRGN record.
+    \return pointer to U_EMR_INVERTRGN record, or NULL on error.
+    \param RgnData Variable size U_RGNDATA structure
 */
-char *U_EMRSETWINDOWORGEX_set(
-      const U_POINTL ptlOrigin
+char *U_EMRINVERTRGN_set(
+      const PU_RGNDATA RgnData
    ){
-   return(U_EMR_CORE7_set(U_EMR_SETWINDOWORGEX, ptlOrigin)); // U_PAIR and U_POINTL are the same thing
-}
+   return(U_EMR_CORE11_set(NULL, U_EMR_INVERTRGN, RgnData));
+} 
 
-// U_EMRSETVIEWPORTEXTEX_set          11
+// U_EMRPAINTRGN_set                  74
 /**
-    \brief Allocate and construct a U_EMR_SETVIEWPORTEXTEX record.
-    \return pointer to U_EMR_SETVIEWPORTEXTEX record, or NULL on error.
-    \param szlExtent  H & V extent in logical units
+    \brief Allocate and construct a U_EMR_PAINTRGN record.
+    \return pointer to U_EMR_PAINTRGN record, or NULL on error.
+    \param RgnData Variable size U_RGNDATA structure
 */
-char *U_EMRSETVIEWPORTEXTEX_set(
-      const U_SIZEL szlExtent
+char *U_EMRPAINTRGN_set(
+      const PU_RGNDATA RgnData
    ){
-   U_PAIR temp;
-   temp.x = szlExtent.cx;
-   temp.y = szlExtent.cy;
-   return(U_EMR_CORE7_set(U_EMR_SETVIEWPORTEXTEX, temp)); 
-}
+   return(U_EMR_CORE11_set(NULL, U_EMR_PAINTRGN, RgnData));
+} 
 
-// U_EMRSETVIEWPORTORGEX_set          12
+// U_EMREXTSELECTCLIPRGN_set          75
 /**
-    \brief Allocate and construct a U_EMR_SETVIEWPORTORGEX record.
-    \return pointer to U_EMR_SETVIEWPORTORGEX record, or NULL on error.
-    \param ptlOrigin  H & V origin in logical units
+    \brief Allocate and construct a U_EMR_EXTSELECTCLIPRGN record.
+    \return pointer to U_EMR_EXTSELECTCLIPRGN or NULL on error.
+    \param iMode   RegionMode Enumeration       
+    \param RgnData Variable size U_RGNDATA structure
 */
-char *U_EMRSETVIEWPORTORGEX_set(
-      const U_POINTL ptlOrigin
+char *U_EMREXTSELECTCLIPRGN_set(
+      const uint32_t    iMode,
+      const PU_RGNDATA  RgnData
    ){
-   return(U_EMR_CORE7_set(U_EMR_SETVIEWPORTORGEX, ptlOrigin));  // U_PAIR and U_POINTL are the same thing
-}
+   char *record;
+   int   irecsize;
+   int   cbRgns,cbRgns4,rds,rds4,off;
 
-// U_EMRSETBRUSHORGEX_set             13
+   if(!RgnData)return(NULL);
+   cbRgns   = ((PU_RGNDATAHEADER) RgnData)->nRgnSize;
+   cbRgns4  = UP4(cbRgns);
+   rds      = sizeof(U_RGNDATAHEADER) + cbRgns;
+   rds4     = UP4(rds);
+   irecsize = sizeof(U_EMREXTSELECTCLIPRGN) - sizeof(U_RECTL) + cbRgns4;  // core + array - overlap of one rectL
+   record    = malloc(irecsize);
+   if(record){
+      ((PU_EMR)                  record)->iType     = U_EMR_EXTSELECTCLIPRGN;
+      ((PU_EMR)                  record)->nSize     = irecsize;
+      ((PU_EMREXTSELECTCLIPRGN)  record)->cbRgnData = rds;
+      ((PU_EMREXTSELECTCLIPRGN)  record)->iMode     = iMode;
+      off = sizeof(U_EMREXTSELECTCLIPRGN) - sizeof(U_RGNDATA);
+      memcpy(record + off, RgnData, rds);
+      off += rds;
+      if(rds < rds4){ memset(record + off,0, rds4 - rds); } // clear any unused bytes
+   }
+   return(record);
+} 
+
+// U_EMRBITBLT_set                    76
 /**
-    \brief Allocate and construct a U_EMR_SETBRUSHORGEX record.
-    \return pointer to U_EMR_SETBRUSHORGEX record, or NULL on error.
-    \param ptlOrigin   H & V origin in logical units
+    \brief Allocate and construct a U_EMR_BITBLT record.
+    \return pointer to U_EMR_BITBLT record, or NULL on error.
+    \param rclBounds    Bounding rectangle in device units
+    \param Dest         Destination UL corner in logical units
+    \param cDest        Destination width in logical units
+    \param Src          Source rectangle UL corner in logical units
+    \param xformSrc     Source bitmap transform (world to page coordinates)
+    \param crBkColorSrc Source bitmap background color
+    \param iUsageSrc    DIBcolors Enumeration
+    \param dwRop        Ternary Raster Operation enumeration
+    \param Bmi          (Optional) bitmapbuffer (U_BITMAPINFO section)
+    \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px           (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRSETBRUSHORGEX_set(
-      const U_POINTL ptlOrigin
+char *U_EMRBITBLT_set(
+      const U_RECTL        rclBounds,
+      const U_POINTL       Dest,
+      const U_POINTL       cDest,
+      const U_POINTL       Src,
+      const U_XFORM        xformSrc,
+      const U_COLORREF     crBkColorSrc,
+      const uint32_t       iUsageSrc,
+      const uint32_t       dwRop,
+      const PU_BITMAPINFO  Bmi,
+      const uint32_t       cbPx,
+      char                *Px
    ){
-   return(U_EMR_CORE7_set(U_EMR_SETBRUSHORGEX, *((PU_PAIR) & ptlOrigin))); 
+   char *record;
+   int   irecsize;
+   int   cbImage,cbImage4,cbBmi,off;
+
+   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
+   irecsize = sizeof(U_EMRBITBLT) + cbBmi + cbImage4;
+   record   = malloc(irecsize);
+   if(record){
+      ((PU_EMR)             record)->iType        = U_EMR_BITBLT;
+      ((PU_EMR)             record)->nSize        = irecsize;
+      ((PU_EMRBITBLT)       record)->rclBounds    = rclBounds;
+      ((PU_EMRBITBLT)       record)->Dest         = Dest;
+      ((PU_EMRBITBLT)       record)->cDest        = cDest;
+      ((PU_EMRBITBLT)       record)->dwRop        = dwRop;
+      ((PU_EMRBITBLT)       record)->Src          = Src;
+      ((PU_EMRBITBLT)       record)->xformSrc     = xformSrc;
+      ((PU_EMRBITBLT)       record)->crBkColorSrc = crBkColorSrc;
+      ((PU_EMRBITBLT)       record)->iUsageSrc    = iUsageSrc;
+      off = sizeof(U_EMRBITBLT);
+      APPEND_PXBMISRC(record, U_EMRBITBLT, cbBmi, Bmi, Px, cbImage, cbImage4);
+   }
+   return(record);
 }
 
-// U_EMREOF_set                       14
+// U_EMRSTRETCHBLT_set                77
 /**
-    \brief Allocate and construct a U_EMR_EOF record.
-    \return pointer to U_EMR_EOF record, or NULL on error.
-    \param cbPalEntries  Number of palette entries
-    \param PalEntries    (optional) array of PalEntries
-    \param et            tracking information, needed for nSizeLast calculation
+    \brief Allocate and construct a U_EMR_STRETCHBLT record.
+    \return pointer to U_EMR_STRETCHBLT record, or NULL on error.
+    \param rclBounds    Bounding rectangle in device units
+    \param Dest         Destination UL corner in logical units
+    \param cDest        Destination width in logical units
+    \param Src          Source UL corner in logical units
+    \param cSrc         Src W & H in logical units
+    \param xformSrc     Transform to apply to source
+    \param crBkColorSrc Background color
+    \param iUsageSrc    DIBcolors Enumeration
+    \param dwRop        Ternary Raster Operation enumeration
+    \param Bmi          (Optional) bitmapbuffer (U_BITMAPINFO section)
+    \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px           (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMREOF_set(
-      const U_CBPLENTRIES  cbPalEntries,
-      const PU_LOGPLTNTRY  PalEntries,
-      EMFTRACK            *et
+char *U_EMRSTRETCHBLT_set(
+      const U_RECTL        rclBounds,
+      const U_POINTL       Dest,
+      const U_POINTL       cDest,
+      const U_POINTL       Src,
+      const U_POINTL       cSrc,
+      const U_XFORM        xformSrc,
+      const U_COLORREF     crBkColorSrc,
+      const uint32_t       iUsageSrc,
+      const uint32_t       dwRop,
+      const PU_BITMAPINFO  Bmi,
+      const uint32_t       cbPx,
+      char                *Px
    ){
    char *record;
-   char *ptr;
-   int  irecsize;
-   int  cbPals;   // space allocated for Palette Entries
-   uint32_t off;
+   int   irecsize;
+   int   cbImage,cbImage4,cbBmi,off;
 
-   if(cbPalEntries && !PalEntries)return(NULL);
-   if(!et)return(NULL);
-   cbPals     = cbPalEntries * sizeof(U_LOGPLTNTRY);
-   irecsize  = sizeof(U_EMREOF) + cbPals + sizeof(uint32_t);  //invariant core, variable palette, palette byte count
-   record    = malloc(irecsize);
+   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
+   
+   irecsize = sizeof(U_EMRSTRETCHBLT) + cbBmi + cbImage4;
+   record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)         record)->iType         = U_EMR_EOF;
-      ((PU_EMR)         record)->nSize         = irecsize;
-      ((PU_EMREOF)      record)->cbPalEntries  = cbPalEntries;
-      ((PU_EMREOF)      record)->offPalEntries = 0;  // May be changed below
-      off = sizeof(U_EMREOF);         //start of the variable region
-      if(cbPals){
-         ((PU_EMREOF)   record)->offPalEntries = off;
-         memcpy(record+off,PalEntries,cbPals);
-         off += cbPals;
-      }
-      ptr = record + off;
-      *(uint32_t *)ptr = irecsize + et->used;  // EMREOF nSizeLast field, not at a fixed position, cannot be accessed by field name
+      ((PU_EMR)                 record)->iType        = U_EMR_STRETCHBLT;
+      ((PU_EMR)                 record)->nSize        = irecsize;
+      ((PU_EMRSTRETCHBLT)       record)->rclBounds    = rclBounds;
+      ((PU_EMRSTRETCHBLT)       record)->Dest         = Dest;
+      ((PU_EMRSTRETCHBLT)       record)->cDest        = cDest;
+      ((PU_EMRSTRETCHBLT)       record)->dwRop        = dwRop;
+      ((PU_EMRSTRETCHBLT)       record)->Src          = Src;
+      ((PU_EMRSTRETCHBLT)       record)->xformSrc     = xformSrc;
+      ((PU_EMRSTRETCHBLT)       record)->crBkColorSrc = crBkColorSrc;
+      ((PU_EMRSTRETCHBLT)       record)->iUsageSrc    = iUsageSrc;
+      off = sizeof(U_EMRSTRETCHBLT);
+      APPEND_PXBMISRC(record, U_EMRSTRETCHBLT, cbBmi, Bmi, Px, cbImage, cbImage4);
+      ((PU_EMRSTRETCHBLT)       record)->cSrc         = cSrc;
    }
-   et->PalEntries = cbPalEntries;
    return(record);
-} 
-
+}
 
-// U_EMRSETPIXELV_set                 15
+// U_EMRMASKBLT_set                   78
 /**
-    \brief Allocate and construct a U_EMR_SETPIXELV record.
-    \return pointer to U_EMR_SETPIXELV record, or NULL on error.
-    \param ptlPixel Pixel coordinates (logical)
-    \param crColor  Pixel color
+    \brief Allocate and construct a U_EMR_MASKBLT record.
+    \return pointer to U_EMR_MASKBLT record, or NULL on error.
+    \param rclBounds    Bounding rectangle in device units
+    \param Dest         Destination UL corner in logical units
+    \param cDest        Destination width in logical units
+    \param Src          Source UL corner in logical units
+    \param xformSrc     Transform to apply to source
+    \param crBkColorSrc Background color
+    \param iUsageSrc    DIBcolors Enumeration
+    \param Mask         Mask UL corner in logical units
+    \param iUsageMask   DIBcolors Enumeration
+    \param dwRop        Ternary Raster Operation enumeration
+    \param Bmi          (Optional) bitmapbuffer (U_BITMAPINFO section)
+    \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px           (Optional) bitmapbuffer (pixel array section )
+    \param MskBmi       (Optional) bitmapbuffer (U_BITMAPINFO section)
+    \param cbMsk        Size in bytes of mask array (row stride * height, there may be some padding at the end of each row)
+    \param Msk          (Optional) bitmapbuffer (mask section )
 */
-char *U_EMRSETPIXELV_set(
-      const U_POINTL    ptlPixel,
-      const U_COLORREF  crColor
+char *U_EMRMASKBLT_set(
+      const U_RECTL        rclBounds,
+      const U_POINTL       Dest,
+      const U_POINTL       cDest,
+      const U_POINTL       Src,
+      const U_XFORM        xformSrc,
+      const U_COLORREF     crBkColorSrc,
+      const uint32_t       iUsageSrc,
+      const U_POINTL       Mask,
+      const uint32_t       iUsageMask,
+      const uint32_t       dwRop,
+      const PU_BITMAPINFO  Bmi,
+      const uint32_t       cbPx,
+      char                *Px,
+      const PU_BITMAPINFO  MskBmi,
+      const uint32_t       cbMsk,
+      char                *Msk
    ){
    char *record;
-   int  irecsize;
+   int   irecsize;
+   int   cbImage,cbImage4,cbBmi,cbMskImage,cbMskImage4,cbMskBmi,off;
 
-   irecsize = sizeof(U_EMRSETPIXELV);
+   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
+   SET_CB_FROM_PXBMI(Msk,MskBmi,cbMskImage,cbMskImage4,cbMskBmi,cbMsk);
+
+   irecsize = sizeof(U_EMRMASKBLT) + cbBmi + cbImage4 + cbMskBmi + cbMskImage4;
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)         record)->iType    = U_EMR_SETPIXELV;
-      ((PU_EMR)         record)->nSize    = irecsize;
-      ((PU_EMRSETPIXELV)record)->ptlPixel = ptlPixel;
-      ((PU_EMRSETPIXELV)record)->crColor  = crColor;
+      ((PU_EMR)              record)->iType        = U_EMR_MASKBLT;
+      ((PU_EMR)              record)->nSize        = irecsize;
+      ((PU_EMRMASKBLT)       record)->rclBounds    = rclBounds;
+      ((PU_EMRMASKBLT)       record)->Dest         = Dest;
+      ((PU_EMRMASKBLT)       record)->cDest        = cDest;
+      ((PU_EMRMASKBLT)       record)->dwRop        = dwRop;
+      ((PU_EMRMASKBLT)       record)->Src          = Src;
+      ((PU_EMRMASKBLT)       record)->xformSrc     = xformSrc;
+      ((PU_EMRMASKBLT)       record)->crBkColorSrc = crBkColorSrc;
+      ((PU_EMRMASKBLT)       record)->iUsageSrc    = iUsageSrc;
+      ((PU_EMRMASKBLT)       record)->Mask         = Mask;
+      ((PU_EMRMASKBLT)       record)->iUsageMask   = iUsageMask;
+      off = sizeof(U_EMRMASKBLT);
+      APPEND_PXBMISRC(record, U_EMRMASKBLT, cbBmi, Bmi, Px, cbImage, cbImage4);
+      APPEND_MSKBMISRC(record, U_EMRMASKBLT, cbMskBmi, MskBmi, Msk, cbMskImage, cbMskImage4);
    }
    return(record);
-} 
+}
 
+// U_EMRPLGBLT_set                    79
 
-// U_EMRSETMAPPERFLAGS_set            16
 /**
-    \brief Allocate and construct a U_EMR_SETMAPPERFLAGS record.
-    \return pointer to U_EMR_SETMAPPERFLAGS record, or NULL on error.
+    \brief Allocate and construct a U_EMRPLGBLT record.
+    \return U_EMRPLGBLT record.
+    \param rclBounds    Bounding rectangle in device units
+    \param aptlDst      Defines parallelogram, UL, UR, LL corners, LR is derived (3 points)
+    \param Src          Source UL corner in logical units
+    \param cSrc         Source width in logical units
+    \param xformSrc     Transform to apply to source
+    \param crBkColorSrc Background color
+    \param iUsageSrc    DIBcolors Enumeration
+    \param Mask         Mask UL corner in logical units
+    \param iUsageMask   DIBcolors Enumeration
+    \param Bmi          (Optional) bitmapbuffer (U_BITMAPINFO section)
+    \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px           (Optional) bitmapbuffer (pixel array section )
+    \param MskBmi       (Optional) bitmapbuffer (U_BITMAPINFO section)
+    \param cbMsk        Size in bytes of mask array (row stride * height, there may be some padding at the end of each row)
+    \param Msk          (Optional) bitmapbuffer (mask section )
 */
-char *U_EMRSETMAPPERFLAGS_set(void){
+char *U_EMRPLGBLT_set(
+      const U_RECTL       rclBounds,
+      const PU_POINTL     aptlDst,
+      const U_POINTL      Src,
+      const U_POINTL      cSrc,
+      const U_XFORM       xformSrc,
+      const U_COLORREF    crBkColorSrc,
+      const uint32_t      iUsageSrc,
+      const U_POINTL      Mask,
+      const uint32_t      iUsageMask,
+      const PU_BITMAPINFO Bmi,
+      const uint32_t      cbPx,
+      char               *Px,
+      const PU_BITMAPINFO MskBmi,
+      const uint32_t      cbMsk,
+      char               *Msk
+   ){
    char *record;
-   int  irecsize;
+   int   irecsize;
+   int   cbImage,cbImage4,cbBmi,cbMskImage,cbMskImage4,cbMskBmi,off;
 
-   irecsize = sizeof(U_EMRSETMAPPERFLAGS);
+   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
+   SET_CB_FROM_PXBMI(Msk,MskBmi,cbMskImage,cbMskImage4,cbMskBmi,cbMsk);
+
+   irecsize = sizeof(U_EMRPLGBLT) + cbBmi + cbImage4 + cbMskBmi + cbMskImage4;
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)              record)->iType   = U_EMR_SETMAPPERFLAGS;
-      ((PU_EMR)              record)->nSize   = irecsize;
-      ((PU_EMRSETMAPPERFLAGS)record)->dwFlags = 1;
+      ((PU_EMR)             record)->iType        = U_EMR_PLGBLT;
+      ((PU_EMR)             record)->nSize        = irecsize;
+      ((PU_EMRPLGBLT)       record)->rclBounds    = rclBounds;
+      memcpy(((PU_EMRPLGBLT)  record)->aptlDst,aptlDst,3*sizeof(U_POINTL));
+      ((PU_EMRPLGBLT)       record)->Src          = Src;
+      ((PU_EMRPLGBLT)       record)->cSrc         = cSrc;
+      ((PU_EMRPLGBLT)       record)->xformSrc     = xformSrc;
+      ((PU_EMRPLGBLT)       record)->crBkColorSrc = crBkColorSrc;
+      ((PU_EMRPLGBLT)       record)->iUsageSrc    = iUsageSrc;
+      ((PU_EMRPLGBLT)       record)->Mask         = Mask;
+      ((PU_EMRPLGBLT)       record)->iUsageMask   = iUsageMask;
+      off = sizeof(U_EMRPLGBLT);
+      APPEND_PXBMISRC(record, U_EMRPLGBLT, cbBmi, Bmi, Px, cbImage, cbImage4);
+      APPEND_MSKBMISRC(record, U_EMRPLGBLT, cbMskBmi, MskBmi, Msk, cbMskImage, cbMskImage4);
    }
    return(record);
-} 
-
-// U_EMRSETMAPMODE_set                17
-/**
-    \brief Allocate and construct a U_EMR_SETMAPMODE record.
-    \return pointer to U_EMR_SETMAPMODE record, or NULL on error.
-    \param iMode  MapMode Enumeration
-*/
-char *U_EMRSETMAPMODE_set(
-      const uint32_t iMode
-   ){
-   return(U_EMR_CORE3_set(U_EMR_SETMAPMODE, iMode));
-}
-
-// U_EMRSETBKMODE_set                 18
-/**
-    \brief Allocate and construct a U_EMR_SETBKMODE record.
-    \return pointer to U_EMR_SETBKMODE record, or NULL on error.
-    \param iMode BackgroundMode Enumeration
-*/
-char *U_EMRSETBKMODE_set( 
-      const uint32_t iMode
-   ){
-  return(U_EMR_CORE3_set(U_EMR_SETBKMODE, iMode));
-}
-
-// U_EMRSETPOLYFILLMODE_set           19
-/**
-    \brief Allocate and construct a U_EMR_SETPOLYFILLMODE record.
-    \return pointer to U_EMR_SETPOLYFILLMODE record, or NULL on error.
-    \param iMode  PolygonFillMode Enumeration
-*/
-char *U_EMRSETPOLYFILLMODE_set(
-      const uint32_t iMode
-   ){
-   return(U_EMR_CORE3_set(U_EMR_SETPOLYFILLMODE, iMode));
-}
-
-// U_EMRSETROP2_set                   20
-/**
-    \brief Allocate and construct a U_EMR_SETROP2 record.
-    \return pointer to U_EMR_SETROP2 record, or NULL on error.
-    \param iMode  RasterOperation2 Enumeration
-*/
-char *U_EMRSETROP2_set(
-      const uint32_t iMode 
-   ){
-   return(U_EMR_CORE3_set(U_EMR_SETROP2, iMode));
 }
 
-// U_EMRSETSTRETCHBLTMODE_set         21
+// U_EMRSETDIBITSTODEVICE_set         80
 /**
-    \brief Allocate and construct a U_EMR_SETSTRETCHBLTMODE record.
-    \return pointer to U_EMR_SETSTRETCHBLTMODE record, or NULL on error.
-    \param iMode  StretchMode Enumeration
+    \brief Allocate and construct a U_EMR_SETDIBITSTODEVICE record.
+    \return pointer to U_EMR_SETDIBITSTODEVICE record, or NULL on error.
+    \param rclBounds  Bounding rectangle in device units
+    \param Dest       Destination UL corner in logical units
+    \param Src        Source UL corner in logical units
+    \param cSrc       Source W & H in logical units
+    \param iUsageSrc  DIBColors Enumeration
+    \param iStartScan First scan line
+    \param cScans     Number of scan lines
+    \param Bmi        (Optional) bitmapbuffer (U_BITMAPINFO section)
+    \param cbPx       Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px         (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRSETSTRETCHBLTMODE_set(
-      const uint32_t iMode
+char *U_EMRSETDIBITSTODEVICE_set(
+      const U_RECTL        rclBounds,
+      const U_POINTL       Dest,
+      const U_POINTL       Src,
+      const U_POINTL       cSrc,
+      const uint32_t       iUsageSrc,
+      const uint32_t       iStartScan,
+      const uint32_t       cScans,
+      const PU_BITMAPINFO  Bmi,
+      const uint32_t       cbPx,
+      char                *Px
    ){
-   return(U_EMR_CORE3_set(U_EMR_SETSTRETCHBLTMODE, iMode));
-}
+   char *record;
+   int   irecsize;
+   int   cbImage,cbImage4,cbBmi,off;
 
-// U_EMRSETTEXTALIGN_set              22
-/**
-    \brief Allocate and construct a U_EMR_SETTEXTALIGN record.
-    \return pointer to U_EMR_SETTEXTALIGN record, or NULL on error.
-    \param iMode  TextAlignment Enumeration
-*/
-char *U_EMRSETTEXTALIGN_set(
-      const uint32_t iMode 
-   ){
-   return(U_EMR_CORE3_set(U_EMR_SETTEXTALIGN, iMode));
+   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
+  
+   irecsize = sizeof(U_EMRSETDIBITSTODEVICE) + cbBmi + cbImage4;
+   record   = malloc(irecsize);
+   if(record){
+      ((PU_EMR)                       record)->iType      = U_EMR_SETDIBITSTODEVICE;
+      ((PU_EMR)                       record)->nSize      = irecsize;
+      ((PU_EMRSETDIBITSTODEVICE)      record)->rclBounds  = rclBounds;
+      ((PU_EMRSETDIBITSTODEVICE)      record)->Dest       = Dest;
+      ((PU_EMRSETDIBITSTODEVICE)      record)->Src        = Src;
+      ((PU_EMRSETDIBITSTODEVICE)      record)->cSrc       = cSrc;
+      ((PU_EMRSETDIBITSTODEVICE)      record)->iUsageSrc  = iUsageSrc;
+      ((PU_EMRSETDIBITSTODEVICE)      record)->iStartScan = iStartScan;
+      ((PU_EMRSETDIBITSTODEVICE)      record)->cScans     = cScans;
+      off = sizeof(U_EMRSETDIBITSTODEVICE);
+      APPEND_PXBMISRC(record, U_EMRSETDIBITSTODEVICE, cbBmi, Bmi, Px, cbImage, cbImage4);
+   }
+   return(record);
 }
 
-// U_EMRSETCOLORADJUSTMENT_set        23
+// U_EMRSTRETCHDIBITS_set             81
 /**
-    \brief Allocate and construct a U_EMR_SETCOLORADJUSTMENT record.
-    \return pointer to U_EMR_SETCOLORADJUSTMENT record, or NULL on error.
-    \param ColorAdjustment Color Adjustment
+    \brief Allocate and construct a U_EMR_EMRSTRETCHDIBITS record.
+    \return pointer to U_EMR_EMRSTRETCHDIBITS record, or NULL on error.
+    \param rclBounds Bounding rectangle in device units
+    \param Dest      Destination UL corner in logical units
+    \param cDest     Destination W & H in logical units
+    \param Src       Source UL corner in logical units
+    \param cSrc      Source W & H in logical units
+    \param iUsageSrc DIBColors Enumeration
+    \param dwRop     RasterOPeration Enumeration
+    \param Bmi       (Optional) bitmapbuffer (U_BITMAPINFO section)
+    \param cbPx      Size in bytes of pixel array (row STRIDE * height, there may be some padding at the end of each row)
+    \param Px        (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRSETCOLORADJUSTMENT_set(
-      const U_COLORADJUSTMENT ColorAdjustment
+char *U_EMRSTRETCHDIBITS_set(
+      const U_RECTL        rclBounds,
+      const U_POINTL       Dest,
+      const U_POINTL       cDest,
+      const U_POINTL       Src,
+      const U_POINTL       cSrc,
+      const uint32_t       iUsageSrc,
+      const uint32_t       dwRop,
+      const PU_BITMAPINFO  Bmi,
+      const uint32_t       cbPx,
+      char                *Px
    ){
    char *record;
-   int  irecsize;
+   int   irecsize;
+   int   cbImage,cbImage4,cbBmi,off;
 
-   irecsize = sizeof(U_EMRSETCOLORADJUSTMENT);
+   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
+   
+   irecsize = sizeof(U_EMRSTRETCHDIBITS) + cbBmi + cbImage4;
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)                   record)->iType           = U_EMR_SETCOLORADJUSTMENT;
-      ((PU_EMR)                   record)->nSize           = irecsize;
-      ((PU_EMRSETCOLORADJUSTMENT) record)->ColorAdjustment = ColorAdjustment;
+      ((PU_EMR)                    record)->iType      = U_EMR_STRETCHDIBITS;
+      ((PU_EMR)                    record)->nSize      = irecsize;
+      ((PU_EMRSTRETCHDIBITS)       record)->rclBounds  = rclBounds;
+      ((PU_EMRSTRETCHDIBITS)       record)->Dest       = Dest;
+      ((PU_EMRSTRETCHDIBITS)       record)->Src        = Src;
+      ((PU_EMRSTRETCHDIBITS)       record)->cSrc       = cSrc;
+      ((PU_EMRSTRETCHDIBITS)       record)->iUsageSrc  = iUsageSrc;
+      ((PU_EMRSTRETCHDIBITS)       record)->dwRop      = dwRop;
+      ((PU_EMRSTRETCHDIBITS)       record)->cDest      = cDest;
+      off = sizeof(U_EMRSTRETCHDIBITS);
+      APPEND_PXBMISRC(record, U_EMRSTRETCHDIBITS, cbBmi, Bmi, Px, cbImage, cbImage4);
    }
    return(record);
 }
 
-// U_EMRSETTEXTCOLOR_set              24
+// U_EMREXTCREATEFONTINDIRECTW_set    82
 /**
-    \brief Allocate and construct a U_EMR_SETTEXTCOLOR record.
-    \return pointer to U_EMR_SETTEXTCOLOR record, or NULL on error.
-    \param crColor  Text Color
+    \brief Allocate and construct a U_EMR_EXTCREATEFONTINDIRECTW record.
+    Use extcreatefontindirectw_set() instead of calling this function directly.
+    \return pointer to U_EMR_EXTCREATEFONTINDIRECTW record, or NULL on error.
+    \param ihFont Index of the font in the EMF object table
+    \param elf    Font parameters as U_LOGFONT
+    \param elfw   Font parameters as U_LOGFONT_PANOSE
 */
-char *U_EMRSETTEXTCOLOR_set(
-      const U_COLORREF crColor
-  ){
-  return(U_EMR_CORE3_set(U_EMR_SETTEXTCOLOR, *(uint32_t *) &crColor));
-}
+char *U_EMREXTCREATEFONTINDIRECTW_set(
+      const uint32_t               ihFont,
+      const char *                 elf,
+      const char *                 elfw
+   ){
+   char *record;
+   const char *cptr;
+   int   irecsize;
+   int   cbLf,off;
 
-// U_EMRSETBKCOLOR_set                25
-/**
-    \brief Allocate and construct a U_EMR_SETBKCOLOR record.
-    \return pointer to U_EMR_SETBKCOLOR record, or NULL on error.
-    \param crColor Background Color
-*/
-char *U_EMRSETBKCOLOR_set(
-      const U_COLORREF crColor
-  ){
-  return(U_EMR_CORE3_set(U_EMR_SETBKCOLOR, *(uint32_t *) &crColor));
+   if((elf && elfw) || (!elf && !elfw))return(NULL);  // ONE only must be passed
+   if(elf){ cbLf = sizeof(U_LOGFONT);        cptr = elf;  }
+   else {   cbLf = sizeof(U_LOGFONT_PANOSE); cptr = elfw; }
+
+   irecsize = sizeof(U_EMR) + sizeof(uint32_t) + cbLf;
+   record    = malloc(irecsize);
+   if(record){
+      ((PU_EMR)                       record)->iType  = U_EMR_EXTCREATEFONTINDIRECTW;
+      ((PU_EMR)                       record)->nSize  = irecsize;
+      ((PU_EMREXTCREATEFONTINDIRECTW) record)->ihFont = ihFont;
+      off = sizeof(U_EMR) + sizeof(uint32_t);
+      memcpy(record + off, cptr, cbLf);    // No need to add padding for either structure
+   }
+   return(record);
 }
 
-// U_EMROFFSETCLIPRGN_set             26
+// U_EMREXTTEXTOUTA_set               83
 /**
-    \brief Allocate and construct a U_EMR_OFFSETCLIPRGN record.
-    \return pointer to U_EMR_OFFSETCLIPRGN record, or NULL on error.
-    \param ptl Clipping region 
+    \brief Allocate and construct a U_EMR_EXTTEXTOUTA record.
+    \return pointer to U_EMR_EXTTEXTOUTA record, or NULL on error.
+    \param rclBounds     Bounding rectangle in device units
+    \param iGraphicsMode Graphics mode Enumeration
+    \param exScale       scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
+    \param eyScale       scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
+    \param emrtext       Text parameters
 */
-char *U_EMROFFSETCLIPRGN_set(
-      const U_POINTL ptl
+char *U_EMREXTTEXTOUTA_set(
+      const U_RECTL     rclBounds,
+      const uint32_t    iGraphicsMode,
+      const U_FLOAT     exScale,
+      const U_FLOAT     eyScale,
+      const PU_EMRTEXT  emrtext
    ){
-  return(U_EMR_CORE7_set(U_EMR_OFFSETCLIPRGN, ptl));
+   return(U_EMR_CORE8_set(NULL, U_EMR_EXTTEXTOUTA,rclBounds, iGraphicsMode, exScale, eyScale,emrtext));
 }
 
-// U_EMRMOVETOEX_set                  27
-/** 
-    \brief Allocate and construct a U_EMR_MOVETOEX record.
-    \return pointer to U_EMR_MOVETOEX record, or NULL on error.
-    \param ptl Point coordinates
+// U_EMREXTTEXTOUTW_set               84
+/**
+    \brief Allocate and construct a U_EMR_EXTTEXTOUTW record.
+    \return pointer to U_EMR_EXTTEXTOUTW record, or NULL on error.
+    \param rclBounds     Bounding rectangle in device units
+    \param iGraphicsMode Graphics mode Enumeration
+    \param exScale       scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
+    \param eyScale       scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
+    \param emrtext       Text parameters
 */
-char *U_EMRMOVETOEX_set(
-      const U_POINTL ptl
+char *U_EMREXTTEXTOUTW_set(
+      const U_RECTL    rclBounds,
+      const uint32_t   iGraphicsMode,
+      const U_FLOAT    exScale,
+      const U_FLOAT    eyScale,
+      const PU_EMRTEXT emrtext
    ){
-   return(U_EMR_CORE7_set(U_EMR_MOVETOEX, ptl));
+   return(U_EMR_CORE8_set(NULL, U_EMR_EXTTEXTOUTW,rclBounds, iGraphicsMode, exScale, eyScale,emrtext));
 }
 
-// U_EMRSETMETARGN_set                28
+// U_EMRPOLYBEZIER16_set              85
 /**
-    \brief Allocate and construct a U_EMR_SETMETARGN record.
-    \return pointer to U_EMR_SETMETARGN record, or NULL on error.
+    \brief Allocate and construct a U_EMR_POLYBEZIER16 record.
+    \return pointer to U_EMR_POLYBEZIER16 record, or NULL on error.
+    \param rclBounds Bounding rectangle in device units
+    \param cpts      Number of POINT16 in array
+    \param points    Array of POINT16
 */
-char *U_EMRSETMETARGN_set(void){
-  return(U_EMR_CORE5_set(U_EMR_SETMETARGN));
-}
+char *U_EMRPOLYBEZIER16_set(
+      const U_RECTL    rclBounds,
+      const uint32_t   cpts,
+      const U_POINT16 *points
+   ){
+   return(U_EMR_CORE6_set(NULL, U_EMR_POLYBEZIER16, rclBounds, cpts, points));
+} 
 
-// U_EMREXCLUDECLIPRECT_set           29
+// U_EMRPOLYGON16_set                 86
 /**
-    \brief Allocate and construct a U_EMR_EXCLUDECLIPRECT record.
-    \return pointer to U_EMR_EXCLUDECLIPRECT record, or NULL on error.
-    \param rclClip Clipping Region
+    \brief Allocate and construct a U_EMR_POLYGON16 record.
+    \return pointer to U_EMR_POLYGON16 record, or NULL on error.
+    \param rclBounds Bounding rectangle in device units
+    \param cpts      Number of POINT16 in array
+    \param points    Array of POINT16
 */
-char *U_EMREXCLUDECLIPRECT_set(
-      const U_RECTL rclClip
-    ){
-    return(U_EMR_CORE4_set(U_EMR_EXCLUDECLIPRECT,rclClip));
+char *U_EMRPOLYGON16_set(
+      const U_RECTL    rclBounds,
+      const uint32_t   cpts,
+      const U_POINT16 *points
+   ){
+   return(U_EMR_CORE6_set(NULL, U_EMR_POLYGON16, rclBounds, cpts, points));
 } 
 
-// U_EMRINTERSECTCLIPRECT_set         30
+// U_EMRPOLYLINE16_set                87
 /**
-    \brief Allocate and construct a U_EMR_INTERSECTCLIPRECT record.
-    \return pointer to U_EMR_INTERSECTCLIPRECT record, or NULL on error.
-    \param rclClip Clipping Region
+    \brief Allocate and construct a U_EMR_POLYLINE16 record.
+    \return pointer to U_EMR_POLYLINE16 record, or NULL on error.
+    \param rclBounds Bounding rectangle in device units
+    \param cpts      Number of POINT16 in array
+    \param points    Array of POINT16
 */
-char *U_EMRINTERSECTCLIPRECT_set(
-      const U_RECTL rclClip
-    ){
-    return(U_EMR_CORE4_set(U_EMR_INTERSECTCLIPRECT,rclClip));
+char *U_EMRPOLYLINE16_set(
+      const U_RECTL    rclBounds,
+      const uint32_t   cpts,
+      const U_POINT16 *points
+   ){
+   return(U_EMR_CORE6_set(NULL, U_EMR_POLYLINE16, rclBounds, cpts, points));
 } 
 
-// U_EMRSCALEVIEWPORTEXTEX_set        31
-/** 
-    \brief Allocate and construct a U_EMR_SCALEVIEWPORTEXTEX record.
-    \return pointer to U_EMR_SCALEVIEWPORTEXTEX record, or NULL on error.
-    \param xNum   Horizontal multiplier (!=0)
-    \param xDenom Horizontal divisor    (!=0)
-    \param yNum   Vertical   multiplier (!=0)
-    \param yDenom Vertical   divisor    (!=0)
-*/
-char *U_EMRSCALEVIEWPORTEXTEX_set(
-    const int32_t  xNum,
-    const int32_t  xDenom,
-    const int32_t  yNum,
-    const int32_t  yDenom
-  ){
-  return(U_EMR_CORE4_set(U_EMR_SCALEVIEWPORTEXTEX,(U_RECTL){xNum,xDenom,yNum,yDenom}));
-}
-
-
-// U_EMRSCALEWINDOWEXTEX_set          32
-/** 
-    \brief Allocate and construct a U_EMR_SCALEWINDOWEXTEX record.
-    \return pointer to U_EMR_SCALEWINDOWEXTEX record, or NULL on error.
-    \param xNum   Horizontal multiplier (!=0)
-    \param xDenom Horizontal divisor    (!=0)
-    \param yNum   Vertical   multiplier (!=0)
-    \param yDenom Vertical   divisor    (!=0)
-*/
-char *U_EMRSCALEWINDOWEXTEX_set(
-    const int32_t  xNum,
-    const int32_t  xDenom,
-    const int32_t  yNum,
-    const int32_t  yDenom
-  ){
-  return(U_EMR_CORE4_set(U_EMR_SCALEWINDOWEXTEX,(U_RECTL){xNum,xDenom,yNum,yDenom}));
-}
-
-// U_EMRSAVEDC_set                    33
+// U_EMRPOLYBEZIERTO16_set            88
 /**
-    \brief Allocate and construct a U_EMR_SAVEDC record.
-    \return pointer to U_EMR_SAVEDC record, or NULL on error.
+    \brief Allocate and construct a U_EMR_POLYBEZIERTO record.
+    \return pointer to U_EMR_POLYBEZIERTO record, or NULL on error.
+    \param rclBounds Bounding rectangle in device units
+    \param cpts      Number of POINT16 in array
+    \param points    Array of POINT16
 */
-char *U_EMRSAVEDC_set(void){
-  return(U_EMR_CORE5_set(U_EMR_SAVEDC));
-}
+char *U_EMRPOLYBEZIERTO16_set(
+      const U_RECTL    rclBounds,
+      const uint32_t   cpts,
+      const U_POINT16 *points
+   ){
+   return(U_EMR_CORE6_set(NULL, U_EMR_POLYBEZIERTO16, rclBounds, cpts, points));
+} 
 
-// U_EMRRESTOREDC_set                 34
+// U_EMRPOLYLINETO16_set              89
 /**
-    \brief Allocate and construct a U_EMR_RESTOREDC record.
-    \return pointer to U_EMR_RESTOREDC record, or NULL on error.
-    \param iRelative DC to restore. -1 is preceding
+    \brief Allocate and construct a U_EMR_POLYLINETO record.
+    \return pointer to U_EMR_POLYLINETO record, or NULL on error.
+    \param rclBounds Bounding rectangle in device units
+    \param cpts      Number of POINT16 in array
+    \param points    Array of POINT16
 */
-char *U_EMRRESTOREDC_set(
-    const int32_t iRelative
-  ){
-  return(U_EMR_CORE3_set(U_EMR_RESTOREDC, (uint32_t) iRelative));
-}
+char *U_EMRPOLYLINETO16_set(
+      const U_RECTL    rclBounds,
+      const uint32_t   cpts,
+      const U_POINT16 *points
+   ){
+   return(U_EMR_CORE6_set(NULL, U_EMR_POLYLINETO16, rclBounds, cpts, points));
+} 
 
-// U_EMRSETWORLDTRANSFORM_set         35
+// U_EMRPOLYPOLYLINE16_set            90
 /**
-    \brief Allocate and construct a U_EMR_SETWORLDTRANSFORM record.
-    \return pointer to U_EMR_SETWORLDTRANSFORM record, or NULL on error.
-    \param xform Transform to use
+    \brief Allocate and construct a U_EMR_POLYPOLYLINE16 record.
+    \return pointer to U_EMR_POLYPOLYLINE16 record, or NULL on error.
+    \param rclBounds   Bounding rectangle in device units
+    \param nPolys      Number of elements in aPolyCounts
+    \param aPolyCounts Number of points in each poly (sequential)
+    \param cpts        Number of POINT16 in array
+    \param points      Array of POINT16
 */
-char *U_EMRSETWORLDTRANSFORM_set(
-      const U_XFORM xform
+char *U_EMRPOLYPOLYLINE16_set(
+      const U_RECTL    rclBounds,
+      const uint32_t   nPolys,
+      const uint32_t  *aPolyCounts,
+      const uint32_t   cpts,
+      const U_POINT16 *points
    ){
-   char *record;
-   int  irecsize;
-
-   irecsize = sizeof(U_EMRSETWORLDTRANSFORM);
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)                  record)->iType = U_EMR_SETWORLDTRANSFORM;
-      ((PU_EMR)                  record)->nSize = irecsize;
-      ((PU_EMRSETWORLDTRANSFORM) record)->xform = xform;
-   }
-   return(record);
-} 
+   return(U_EMR_CORE10_set(NULL, U_EMR_POLYPOLYLINE16, rclBounds, nPolys, aPolyCounts,cpts, points));
+}
 
-// U_EMRMODIFYWORLDTRANSFORM_set      36
+// U_EMRPOLYPOLYGON16_set             91
 /**
-    \brief Allocate and construct a U_EMR_MODIFYWORLDTRANSFORM record.
-    \return pointer to U_EMR_MODIFYWORLDTRANSFORM record, or NULL on error.
-    \param xform Transform to use
-    \param iMode ModifyWorldTransformMode Enumeration
+    \brief Allocate and construct a U_EMR_POLYPOLYGON16 record.
+    \return pointer to U_EMR_POLYPOLYGON16 record, or NULL on error.
+    \param rclBounds   Bounding rectangle in device units
+    \param nPolys      Number of elements in aPolyCounts
+    \param aPolyCounts Number of points in each poly (sequential)
+    \param cpts        Number of POINT16 in array
+    \param points      Array of POINT16
 */
-char *U_EMRMODIFYWORLDTRANSFORM_set(
-      const U_XFORM  xform,
-      const uint32_t iMode
+char *U_EMRPOLYPOLYGON16_set(
+      const U_RECTL    rclBounds,
+      const uint32_t   nPolys,
+      const uint32_t  *aPolyCounts,
+      const uint32_t   cpts,
+      const U_POINT16 *points
    ){
-   char *record;
-   int irecsize;
+   return(U_EMR_CORE10_set(NULL, U_EMR_POLYPOLYGON16, rclBounds, nPolys, aPolyCounts,cpts, points));
+}
 
-   irecsize = sizeof(U_EMRMODIFYWORLDTRANSFORM);
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)                     record)->iType = U_EMR_MODIFYWORLDTRANSFORM;
-      ((PU_EMR)                     record)->nSize = irecsize;
-      ((PU_EMRMODIFYWORLDTRANSFORM) record)->xform = xform;
-      ((PU_EMRMODIFYWORLDTRANSFORM) record)->iMode = iMode;
-   }
-   return(record);
-} 
 
-// U_EMRSELECTOBJECT_set              37
+// U_EMRPOLYDRAW16_set                92
 /**
-    \brief Allocate and construct a U_EMR_SELECTOBJECT record.
-    Use selectobject_set() instead of calling this function directly.
-    \return pointer to U_EMR_SELECTOBJECT record, or NULL on error.
-    \param ihObject Number of a stock or created object
+    \brief Allocate and construct a U_EMR_POLYDRAW16 record.
+    \return pointer to U_EMR_POLYDRAW16 record, or NULL on error.
+    \param rclBounds Bounding rectangle in device units 
+    \param cpts      Number of U_POINTL objects         
+    \param aptl      Array of U_POINTL objects          
+    \param abTypes   Array of Point Enumeration         
 */
-char *U_EMRSELECTOBJECT_set(
-      const uint32_t ihObject 
+char *U_EMRPOLYDRAW16_set(
+     const U_RECTL        rclBounds,
+     const U_NUM_POINT16  cpts,
+     const U_POINT16     *aptl,
+     const uint8_t       *abTypes
    ){
    char *record;
    int  irecsize;
+   int  cbPoints, cbAbTypes, cbAbTypes4, off;
 
-   irecsize = sizeof(U_EMRSELECTOBJECT);
+   if(!cpts || !aptl || !abTypes)return(NULL);
+   cbPoints    = cpts * sizeof(U_POINT16);  // space for aptl
+   cbAbTypes    = cpts;                     // number of abTypes (same array size, 1 byte each)
+   cbAbTypes4    = UP4(cbAbTypes);          // space for abTypes
+   irecsize = sizeof(U_EMRPOLYDRAW16) + cbPoints + cbAbTypes4 - sizeof(U_POINT16) - 1;
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)             record)->iType    = U_EMR_SELECTOBJECT;
-      ((PU_EMR)             record)->nSize    = irecsize;
-      ((PU_EMRSELECTOBJECT) record)->ihObject = ihObject;  // Index of object to SELECT
+      ((PU_EMR)           record)->iType      = U_EMR_POLYDRAW16; 
+      ((PU_EMR)           record)->nSize      = irecsize;         
+      ((PU_EMRPOLYDRAW16) record)->rclBounds  = rclBounds;        
+      ((PU_EMRPOLYDRAW16) record)->cpts       = cpts;             
+      off = sizeof(U_EMR) + sizeof(U_RECTL) + sizeof(uint32_t);  // offset to first variable part
+      memcpy(record+off,aptl,cbPoints);
+      off += cbPoints;
+      memcpy(record+off,abTypes,cbAbTypes);
+      off += cbAbTypes;
+      if(cbAbTypes4 > cbAbTypes){ memset(record+off,0,cbAbTypes4-cbAbTypes); } // keeps valgrind happy (initialize padding after byte array)
    }
    return(record);
-} 
+}  
 
-// U_EMRCREATEPEN_set                 38
+// U_EMRCREATEMONOBRUSH_set           93
 /**
-    \brief Allocate and construct a U_EMR_CREATEPEN record.
-    Use createpen_set() instead of calling this function directly.
-    \return pointer to U_EMR_CREATEPEN record, or NULL on error.
-    \param ihPen Handle of created pen
-    \param lopn  U_LOGPEN structure describing this pen
+    \brief Allocate and construct a U_EMR_CREATEMONOBRUSH record.
+    \return pointer to U_EMR_CREATEMONOBRUSH record, or NULL on error.
+    \param ihBrush Index to place object in EMF object table (this entry must not yet exist) 
+    \param iUsage  DIBcolors Enumeration                                                     
+    \param Bmi     (Optional) bitmapbuffer (U_BITMAPINFO + pixel array)                      
+    \param cbPx    Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px      (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRCREATEPEN_set(
-      const uint32_t ihPen,
-      const U_LOGPEN lopn
+char *U_EMRCREATEMONOBRUSH_set(
+      const uint32_t            ihBrush,
+      const uint32_t            iUsage,
+      const PU_BITMAPINFO       Bmi,
+      const uint32_t            cbPx,
+      const char               *Px
    ){
-   char *record;
-   int irecsize=sizeof(U_EMRCREATEPEN);
-
-   record   = malloc(irecsize);    
-   if(record){
-      ((PU_EMR)          record)->iType = U_EMR_CREATEPEN;
-      ((PU_EMR)          record)->nSize = irecsize;
-      ((PU_EMRCREATEPEN) record)->ihPen = ihPen;
-      ((PU_EMRCREATEPEN) record)->lopn  = lopn;
-   }
-   return(record);
+   return(U_EMR_CORE12_set(NULL, U_EMR_CREATEMONOBRUSH,ihBrush,iUsage,Bmi,cbPx,Px));
 }
 
-// U_EMRCREATEBRUSHINDIRECT_set       39
+// U_EMRCREATEDIBPATTERNBRUSHPT_set   94
 /**
-    \brief Allocate and construct a U_EMR_CREATEBRUSHINDIRECT record.
-    Use createbrushindirect_set() instead of calling this function directly.
-    \return pointer to U_EMR_CREATEBRUSHINDIRECT record, or NULL on error.
-    \param ihBrush Index to place object in EMF object table (this entry must not yet exist) 
-    \param lb      Brush properties                                                          
+    \brief Allocate and construct a U_EMR_CREATEDIBPATTERNBRUSHPT record.
+    Use createdibpatternbrushpt_set() instead of calling this function directly.
+    \return pointer to U_EMR_CREATEDIBPATTERNBRUSHPT record, or NULL on error.
+    \param ihBrush Index to place object in EMF object table (this entry must not yet exist)
+    \param iUsage  DIBcolors Enumeration
+    \param Bmi     (Optional) bitmapbuffer (U_BITMAPINFO + pixel array)
+    \param cbPx    Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px      (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRCREATEBRUSHINDIRECT_set(
-      const uint32_t   ihBrush,
-      const U_LOGBRUSH lb
+char *U_EMRCREATEDIBPATTERNBRUSHPT_set(
+      const uint32_t            ihBrush,
+      const uint32_t            iUsage,
+      const PU_BITMAPINFO       Bmi,
+      const uint32_t            cbPx,
+      const char               *Px
    ){
-   char *record;
-   int  irecsize;
+    return(U_EMR_CORE12_set(NULL, U_EMR_CREATEDIBPATTERNBRUSHPT,ihBrush,iUsage,Bmi,cbPx,Px));
+}
 
-   irecsize = sizeof(U_EMRCREATEBRUSHINDIRECT);
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)                    record)->iType   = U_EMR_CREATEBRUSHINDIRECT;
-      ((PU_EMR)                    record)->nSize   = irecsize;
-      ((PU_EMRCREATEBRUSHINDIRECT) record)->ihBrush = ihBrush;  // Index to place object in EMF object table (this entry must not yet exist)
-      ((PU_EMRCREATEBRUSHINDIRECT) record)->lb      = lb;
-   }
-   return(record);
-} 
 
-// U_EMRDELETEOBJECT_set              40
-/** 
-    \brief Allocate and construct a U_EMR_DELETEOBJECT record.
-    Use deleteobject_set() instead of calling this function directly.
-    \return pointer to U_EMR_DELETEOBJECT record, or NULL on error.
-    \param ihObject Number of a stock or created object
+// U_EMREXTCREATEPEN_set              95
+/**
+    \brief Allocate and construct a U_EMR_EXTCREATEPEN record.
+    Use extcreatepen_set() instead of calling this function directly.
+    \return pointer to U_EMR_EXTCREATEPEN record, or NULL on error.
+    \param ihPen ihPen Index to place object in EMF object table (this entry must not yet exist)
+    \param Bmi   Bmi   bitmapbuffer
+    \param cbPx  cbPx  Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px    Px    pixel array (NULL if cbPx == 0)
+    \param elp   elp   Pen parameters (Size is Variable!!!!)
 */
-char *U_EMRDELETEOBJECT_set(
-      const uint32_t ihObject
+char *U_EMREXTCREATEPEN_set(
+      const uint32_t      ihPen,
+      const PU_BITMAPINFO Bmi,
+      const uint32_t      cbPx,
+      char               *Px,
+      const PU_EXTLOGPEN  elp
    ){
    char *record;
-   int  irecsize;
+   int   cbImage,cbImage4,cbBmi,off;
+   int   irecsize,cbStyleArray,cbElp;
+   
+   if(!elp)return(NULL);
 
-   irecsize = sizeof(U_EMRDELETEOBJECT);
+   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
+
+   cbStyleArray   = elp->elpNumEntries * sizeof(U_STYLEENTRY);                         // space actually used by penstyle entries
+   // EXTLOGPEN is already included in EMREXTCREATEPEN, including the possibly unused first penstyle entry
+   if(cbStyleArray){
+      cbElp   = sizeof(U_EXTLOGPEN) + cbStyleArray - sizeof(U_STYLEENTRY);  // space actually used by elp
+      irecsize = sizeof(U_EMREXTCREATEPEN) + cbBmi + cbImage4 + cbStyleArray - sizeof(U_STYLEENTRY);
+   }
+   else {
+      cbElp   = sizeof(U_EXTLOGPEN);                                  //    first U_STYLEENTRY is present but unused
+      irecsize = sizeof(U_EMREXTCREATEPEN) + cbBmi + cbImage4;
+   }
    record   = malloc(irecsize);
+
    if(record){
-      ((PU_EMR)             record)->iType    = U_EMR_DELETEOBJECT;
-      ((PU_EMR)             record)->nSize    = irecsize;
-      ((PU_EMRDELETEOBJECT) record)->ihObject = ihObject;  // Index of object to DELETE
+      ((PU_EMR)                 record)->iType      = U_EMR_EXTCREATEPEN;
+      ((PU_EMR)                 record)->nSize      = irecsize;
+      ((PU_EMREXTCREATEPEN)     record)->ihPen      = ihPen;
+      memcpy(&(((PU_EMREXTCREATEPEN) record)->elp),elp,cbElp);
+      if(cbStyleArray){
+         off = sizeof(U_EMREXTCREATEPEN) + cbStyleArray - sizeof(U_STYLEENTRY);
+      }
+      else {
+         off = sizeof(U_EMREXTCREATEPEN);
+      }
+      // Cannot use APPEND_PXBMISRC here because there is no "Src" in the field names 
+      if(cbBmi){
+         memcpy(record + off, Bmi, cbBmi);
+         ((PU_EMREXTCREATEPEN) record)->offBmi     = off;
+         ((PU_EMREXTCREATEPEN) record)->cbBmi      = cbBmi;
+         off += cbBmi; 
+         memcpy(record + off, Px, cbImage);
+         ((PU_EMREXTCREATEPEN) record)->offBits    = off;
+         ((PU_EMREXTCREATEPEN) record)->cbBits     = cbImage;
+         off += cbImage;
+         if(cbImage4 - cbImage){  memset(record + off, 0, cbImage4 - cbImage); }
+      }
+      else {
+         ((PU_EMREXTCREATEPEN) record)->cbBmi      = 0;
+         ((PU_EMREXTCREATEPEN) record)->offBmi     = 0;
+         ((PU_EMREXTCREATEPEN) record)->cbBits     = 0;
+         ((PU_EMREXTCREATEPEN) record)->offBits    = 0;
+      }
    }
    return(record);
-} 
+}
 
-// U_EMRANGLEARC_set                  41
+// U_EMRPOLYTEXTOUTA_set              96 NOT IMPLEMENTED, denigrated after Windows NT
+// U_EMRPOLYTEXTOUTW_set              97 NOT IMPLEMENTED, denigrated after Windows NT
+
+// U_EMRSETICMMODE_set                98
 /**
-    \brief Allocate and construct a U_EMR_ANGLEARC record.
-    \return pointer to U_EMR_ANGLEARC record, or NULL on error.
-    \param ptlCenter   Center in logical units
-    \param nRadius     Radius in logical units
-    \param eStartAngle Starting angle in degrees (counter clockwise from x axis)
-    \param eSweepAngle Sweep angle in degrees
+    \brief Allocate and construct a U_EMR_SETICMMODE record.
+    \return pointer to U_EMR_SETICMMODE record, or NULL on error.
+    \param iMode ICMMode Enumeration
 */
-char *U_EMRANGLEARC_set(
-      const U_POINTL  ptlCenter,
-      const uint32_t  nRadius,
-      const U_FLOAT   eStartAngle,
-      const U_FLOAT   eSweepAngle
+char *U_EMRSETICMMODE_set(
+      const uint32_t iMode
+   ){ 
+   return(U_EMR_CORE3_set(NULL, U_EMR_SETICMMODE, iMode));
+}
+
+// U_EMRCREATECOLORSPACE_set          99
+/**
+    \brief Allocate and construct a U_EMR_CREATECOLORSPACE record.
+    Use createcolorspace_set() instead of calling this function directly.
+    \return pointer to U_EMR_CREATECOLORSPACE record, or NULL on error.
+    \param ihCS Index to place object in EMF object table (this entry must not yet exist)
+    \param lcs  ColorSpace parameters
+*/
+char *U_EMRCREATECOLORSPACE_set(
+      const uint32_t            ihCS,
+      const U_LOGCOLORSPACEA    lcs
    ){
    char *record;
-   int  irecsize;
+   int   irecsize;
 
-   irecsize = sizeof(U_EMRANGLEARC);
+   irecsize = sizeof(U_EMRCREATECOLORSPACE);
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)         record)->iType       = U_EMR_ANGLEARC;
-      ((PU_EMR)         record)->nSize       = irecsize;
-      ((PU_EMRANGLEARC) record)->ptlCenter   = ptlCenter;   
-      ((PU_EMRANGLEARC) record)->nRadius     = nRadius;     
-      ((PU_EMRANGLEARC) record)->eStartAngle = eStartAngle; 
-      ((PU_EMRANGLEARC) record)->eSweepAngle = eSweepAngle; 
+      ((PU_EMR)                 record)->iType = U_EMR_CREATECOLORSPACE;
+      ((PU_EMR)                 record)->nSize = irecsize;
+      ((PU_EMRCREATECOLORSPACE) record)->ihCS  = ihCS;
+      ((PU_EMRCREATECOLORSPACE) record)->lcs   = lcs;
    }
    return(record);
 } 
 
-// U_EMRELLIPSE_set                   42
+// U_EMRSETCOLORSPACE_set            100
 /**
-    \brief Allocate and construct a U_EMR_ELLIPSE record.
-    \return pointer to U_EMR_ELLIPSE record, or NULL on error.
-    \param rclBox bounding rectangle in logical units
+    \brief Allocate and construct a U_EMR_SETCOLORSPACE record.
+    \return pointer to U_EMR_SETCOLORSPACE record, or NULL on error.
+    \param ihCS Index of object in EMF object table
 */
-char *U_EMRELLIPSE_set(
-      const U_RECTL rclBox
+char *U_EMRSETCOLORSPACE_set(
+      const uint32_t             ihCS
    ){
-   return(U_EMR_CORE4_set(U_EMR_ELLIPSE,rclBox));
-} 
+   return(U_EMR_CORE3_set(NULL, U_EMR_SETCOLORSPACE, ihCS));
+}
 
-// U_EMRRECTANGLE_set                 43
-/**
-    \brief Allocate and construct a U_EMR_RECTANGLE record.
-    \return pointer to U_EMR_RECTANGLE record, or NULL on error.
-    \param rclBox bounding rectangle in logical units
+// U_EMRDELETECOLORSPACE_set         101
+/** 
+    \brief Allocate and construct a U_EMR_DELETECOLORSPACE record.
+    \return pointer to U_EMR_DELETECOLORSPACE record, or NULL on error.
+    \param ihCS Index of object in EMF object table
 */
-char *U_EMRRECTANGLE_set(
-      const U_RECTL rclBox
+char *U_EMRDELETECOLORSPACE_set(
+      const uint32_t             ihCS
    ){
-   return(U_EMR_CORE4_set(U_EMR_RECTANGLE,rclBox));
-} 
+   return(U_EMR_CORE3_set(NULL, U_EMR_DELETECOLORSPACE, ihCS));
+}
 
-// U_EMRROUNDRECT_set                 44
+// U_EMRGLSRECORD_set                102  Not implemented
+// U_EMRGLSBOUNDEDRECORD_set         103  Not implemented
+// U_EMRPIXELFORMAT_set              104
 /**
-    \brief Allocate and construct a U_EMR_ROUNDRECT record.
-    \return pointer to U_EMR_ROUNDRECT record, or NULL on error.
-    \param rclBox    bounding rectangle in logical units
-    \param szlCorner W & H in logical units of ellipse used to round corner
+    \brief Allocate and construct a U_EMR_PIXELFORMAT record.
+    \return pointer to U_EMR_PIXELFORMAT record, or NULL on error.
+    \param pfd PixelFormatDescriptor
 */
-char *U_EMRROUNDRECT_set(
-      const U_RECTL rclBox,
-      const U_SIZEL szlCorner
+char *U_EMRPIXELFORMAT_set(
+      const U_PIXELFORMATDESCRIPTOR pfd
    ){
    char *record;
-   int  irecsize;
+   int   irecsize;
 
-   irecsize = sizeof(U_EMRROUNDRECT);
+   irecsize = sizeof(U_EMRPIXELFORMAT);
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)          record)->iType       = U_EMR_ROUNDRECT;
-      ((PU_EMR)          record)->nSize       = irecsize;
-      ((PU_EMRROUNDRECT) record)->rclBox      = rclBox;  
-      ((PU_EMRROUNDRECT) record)->szlCorner   = szlCorner;
+      ((PU_EMR)            record)->iType   = U_EMR_PIXELFORMAT;
+      ((PU_EMR)            record)->nSize   = irecsize;
+      ((PU_EMRPIXELFORMAT) record)->pfd     = pfd;
    }
    return(record);
 } 
+// U_EMRDRAWESCAPE_set               105  Not implemented
+// U_EMREXTESCAPE_set                106  Not implemented
+// U_EMRUNDEF107_set                 107  Not implemented
 
-// U_EMRARC_set                       45
+// U_EMRSMALLTEXTOUT_set             108
 /**
-    \brief Allocate and construct a U_EMR_ARC record.
-    \return pointer to U_EMR_ARC record, or NULL on error.
-    \param rclBox   bounding rectangle in logical units
-    \param ptlStart Start point in logical units
-    \param ptlEnd   End point in logical units
+    \brief Allocate and construct a U_EMR_SMALLTEXTOUT record.
+    \return pointer to U_EMR_SMALLTEXTOUT record, or NULL on error.
+    \param Dest          Where to draw the text
+    \param cChars        Characters in TextString (not null terminated)
+    \param fuOptions     ExtTextOutOptions Enumeration
+    \param iGraphicsMode GraphicsMode Enumeration
+    \param exScale       scale on X axis
+    \param eyScale       scale on Y axis
+    \param rclBounds     OPTIONAL Bounding rectangle (absent when: fuOPtions & ETO_NO_U_RECT)
+    \param TextString    text to output (fuOptions & ETO_SMALL_CHARS ? 8 bit : 16 bit)
 */
-char *U_EMRARC_set(
-      const U_RECTL  rclBox,
-      const U_POINTL ptlStart,
-      const U_POINTL ptlEnd
+char *U_EMRSMALLTEXTOUT_set(
+      const U_POINTL   Dest,
+      const U_NUM_STR  cChars,
+      const uint32_t   fuOptions,
+      const uint32_t   iGraphicsMode,
+      const U_FLOAT    exScale,
+      const U_FLOAT    eyScale,
+      const U_RECTL    rclBounds,
+      const char      *TextString
    ){
-   return(U_EMR_CORE9_set(U_EMR_ARC,rclBox, ptlStart, ptlEnd));
-}
+   char *record;
+   int   irecsize,cbString,cbString4,cbRectl,off;
+   int   csize;
+   
+   if( fuOptions & U_ETO_SMALL_CHARS ){  csize = 1; }         // how many bytes per character
+   else {                                csize = 2; }
+   cbString = csize * cChars;                                   // filled contents of the string buffer
+   cbString4 = UP4(cbString);                                      // size of the variable string buffer
+   if(fuOptions & U_ETO_NO_RECT){ cbRectl = 0;               } // size of the optional U_RECTL field
+   else {                         cbRectl = sizeof(U_RECTL); }
+   
+   irecsize = sizeof(U_EMRSMALLTEXTOUT) + cbString4 + cbRectl;
+   record    = malloc(irecsize);
+   if(record){
+      ((PU_EMR)             record)->iType         = U_EMR_SMALLTEXTOUT;
+      ((PU_EMR)             record)->nSize         = irecsize;
+      ((PU_EMRSMALLTEXTOUT) record)->Dest          = Dest;
+      ((PU_EMRSMALLTEXTOUT) record)->cChars        = cChars;
+      ((PU_EMRSMALLTEXTOUT) record)->fuOptions     = fuOptions;
+      ((PU_EMRSMALLTEXTOUT) record)->iGraphicsMode = iGraphicsMode;
+      ((PU_EMRSMALLTEXTOUT) record)->exScale       = exScale;
+      ((PU_EMRSMALLTEXTOUT) record)->eyScale       = eyScale;
+      off = sizeof(U_EMRSMALLTEXTOUT);  //offset to the start of the variable fields
+      if(cbRectl){
+         memcpy(record + off, &rclBounds, cbRectl);
+         off += cbRectl;
+      }
+      memcpy(record + off, TextString, cbString);
+      if(cbString < cbString4){
+         off += cbString;
+         memset(record + off, 0, cbString4 - cbString);
+      }
+   }
+   return(record);
+} 
 
-// U_EMRCHORD_set                     46
+// U_EMRFORCEUFIMAPPING_set          109  Not implemented
+// U_EMRNAMEDESCAPE_set              110  Not implemented
+// U_EMRCOLORCORRECTPALETTE_set      111  Not implemented
+// U_EMRSETICMPROFILEA_set           112  Not implemented
+// U_EMRSETICMPROFILEW_set           113  Not implemented
+
+// U_EMRALPHABLEND_set               114
 /**
-    \brief Allocate and construct a U_EMR_CHORD record.
-    \return pointer to U_EMR_CHORD record, or NULL on error.
-    \param rclBox   bounding rectangle in logical units
-    \param ptlStart Start point in logical units
-    \param ptlEnd   End point in logical units
+    \brief Allocate and construct a U_EMR_ALPHABLEND record.
+    \return pointer to U_EMR_ALPHABLEND record, or NULL on error.
+    \param rclBounds    Bounding rectangle in device units
+    \param Dest         Destination UL corner in logical units
+    \param cDest        Destination width in logical units
+    \param Src          Source UL corner in logical units
+    \param cSrc         Src W & H in logical units
+    \param xformSrc     Transform to apply to source
+    \param crBkColorSrc Background color
+    \param iUsageSrc    DIBcolors Enumeration
+    \param Blend        Blend function
+    \param Bmi          (Optional) bitmapbuffer (U_BITMAPINFO section)
+    \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px           (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRCHORD_set(
-      const U_RECTL  rclBox,
-      const U_POINTL ptlStart,
-      const U_POINTL ptlEnd
+char *U_EMRALPHABLEND_set(
+      const U_RECTL       rclBounds,
+      const U_POINTL      Dest,
+      const U_POINTL      cDest,
+      const U_POINTL      Src,
+      const U_POINTL      cSrc,
+      const U_XFORM       xformSrc,
+      const U_COLORREF    crBkColorSrc,
+      const uint32_t      iUsageSrc,
+      const U_BLEND       Blend,
+      const PU_BITMAPINFO Bmi,
+      const uint32_t      cbPx,
+      char               *Px
    ){
-   return(U_EMR_CORE9_set(U_EMR_CHORD,rclBox, ptlStart, ptlEnd));
+   return(U_EMR_CORE13_set(NULL, U_EMR_ALPHABLEND,rclBounds,Dest,cDest,Src,cSrc,xformSrc,crBkColorSrc,iUsageSrc,*((uint32_t *) &Blend),Bmi,cbPx,Px));
 }
 
-// U_EMRPIE_set                       47
+// U_EMRSETLAYOUT_set                115
 /**
-    \brief Allocate and construct a U_EMR_PIE record.
-    \return pointer to U_EMR_PIE record, or NULL on error.
-    \param rclBox   bounding rectangle in logical units
-    \param ptlStart Start point in logical units
-    \param ptlEnd   End point in logical units
+    \brief Allocate and construct a U_EMR_SETLAYOUT record.
+    \return pointer to U_EMR_SETLAYOUT record, or NULL on error.
+    \param iMode Mirroring Enumeration
 */
-char *U_EMRPIE_set(
-      const U_RECTL  rclBox,
-      const U_POINTL ptlStart,
-      const U_POINTL ptlEnd
-   ){
-   return(U_EMR_CORE9_set(U_EMR_PIE,rclBox, ptlStart, ptlEnd));
+char *U_EMRSETLAYOUT_set(uint32_t iMode){
+  return(U_EMR_CORE3_set(NULL, U_EMR_SETLAYOUT, iMode));
 }
 
-// U_EMRSELECTPALETTE_set             48
+// U_EMRTRANSPARENTBLT_set           116
 /**
-    \brief Allocate and construct a U_EMR_SELECTPALETTE record.
-    \return pointer to U_EMR_SELECTPALETTE record, or NULL on error.
-    \param ihPal Index of a Palette object in the EMF object table
+    \brief Allocate and construct a U_EMR_TRANSPARENTBLT record.
+    \return pointer to U_EMR_TRANSPARENTBLT record, or NULL on error.
+    \param rclBounds    Bounding rectangle in device units
+    \param Dest         Destination UL corner in logical units
+    \param cDest        Destination width in logical units
+    \param Src          Source UL corner in logical units
+    \param cSrc         Src W & H in logical units
+    \param xformSrc     Transform to apply to source
+    \param crBkColorSrc Background color
+    \param iUsageSrc    DIBcolors Enumeration
+    \param TColor       Bitmap color to be treated as transparent
+    \param Bmi          (Optional) bitmapbuffer (U_BITMAPINFO section)
+    \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
+    \param Px           (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRSELECTPALETTE_set(
-      const uint32_t ihPal
+char *U_EMRTRANSPARENTBLT_set(
+      const U_RECTL       rclBounds,
+      const U_POINTL      Dest,
+      const U_POINTL      cDest,
+      const U_POINTL      Src,
+      const U_POINTL      cSrc,
+      const U_XFORM       xformSrc,
+      const U_COLORREF    crBkColorSrc,
+      const uint32_t      iUsageSrc,
+      const uint32_t      TColor,
+      const PU_BITMAPINFO Bmi,
+      const uint32_t      cbPx,
+      char               *Px
    ){
-   return(U_EMR_CORE3_set(U_EMR_SELECTPALETTE, ihPal));
+   return(U_EMR_CORE13_set(NULL, U_EMR_TRANSPARENTBLT,rclBounds,Dest,cDest,Src,cSrc,xformSrc,crBkColorSrc,iUsageSrc,TColor,Bmi,cbPx,Px));
 }
-
-// U_EMRCREATEPALETTE_set             49
+// U_EMRUNDEF117_set                 117  Not implemented
+// U_EMRGRADIENTFILL_set             118
 /**
-    \brief Allocate and construct a U_EMR_CREATEPALETTE record.
-    Use createpalette_set() instead of calling this function directly.
-    \return pointer to U_EMR_CREATEPALETTE record, or NULL on error.
-    \param ihPal Index to place object in EMF object table (this entry must not yet exist)
-    \param lgpl   Palette properties
+    \brief Allocate and construct a U_EMR_TRANSPARENTBLT record.
+    \return pointer to U_EMR_TRANSPARENTBLT record, or NULL on error.
+    \param rclBounds    Bounding rectangle in device units
+    \param nTriVert     Number of TriVertex objects in TriVert
+    \param nGradObj     Number of gradient triangle/rectangle objects
+    \param ulMode       Gradientfill Enumeration (determines Triangle/Rectangle)
+    \param TriVert      Array of TriVertex objects
+    \param GradObj      Array of gradient objects (each has 2 [rect] or 3 [triangle] indices into TriVert array) 
+
+There is an MS documentation or library problem for this record, as the size of the GradObj must always be set
+as if it was an array of U_GRADIENT3 objects for both rect and triangle.  For horizontal and vertical gradients
+this means that there will be unused bytes at the end of the record.  This is not what the documentation says,
+but it is how MS's libraries work.
+
 */
-char *U_EMRCREATEPALETTE_set(
-      const uint32_t     ihPal,
-      const U_LOGPALETTE lgpl
+char *U_EMRGRADIENTFILL_set(
+      const U_RECTL             rclBounds,
+      const U_NUM_TRIVERTEX     nTriVert,
+      const U_NUM_GRADOBJ       nGradObj,
+      const uint32_t            ulMode,
+      const PU_TRIVERTEX        TriVert,
+      const uint32_t           *GradObj
    ){
    char *record;
-   int  irecsize;
+   unsigned int   cbTriVert,cbGradObj,off;
+   unsigned int   cbGradObjAlloc; /* larger than cbGradObj, because of problem described above */
+   int   irecsize;
 
-   irecsize = sizeof(U_EMRCREATEPALETTE);
+   cbTriVert = sizeof(U_TRIVERTEX) * nTriVert;  // all of the cb's will be a multiple of 4 bytes
+   if(     ulMode == U_GRADIENT_FILL_TRIANGLE){ cbGradObj = sizeof(U_GRADIENT3) * nGradObj; }
+   else if(ulMode == U_GRADIENT_FILL_RECT_H || 
+           ulMode == U_GRADIENT_FILL_RECT_V){   cbGradObj = sizeof(U_GRADIENT4) * nGradObj; }
+   else {                                       return(NULL);                               }
+   cbGradObjAlloc = sizeof(U_GRADIENT3) * nGradObj; 
+
+   irecsize = sizeof(U_EMRGRADIENTFILL) + cbTriVert + cbGradObjAlloc;
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)              record)->iType   = U_EMR_CREATEPALETTE;
-      ((PU_EMR)              record)->nSize   = irecsize;
-      ((PU_EMRCREATEPALETTE) record)->ihPal   = ihPal;
-      ((PU_EMRCREATEPALETTE) record)->lgpl    = lgpl;
+      ((PU_EMR)             record)->iType      = U_EMR_GRADIENTFILL;
+      ((PU_EMR)             record)->nSize      = irecsize;
+      ((PU_EMRGRADIENTFILL) record)->rclBounds  = rclBounds;
+      ((PU_EMRGRADIENTFILL) record)->nTriVert   = nTriVert;
+      ((PU_EMRGRADIENTFILL) record)->nGradObj   = nGradObj;
+      ((PU_EMRGRADIENTFILL) record)->ulMode     = ulMode;
+      off = sizeof(U_EMRGRADIENTFILL); // offset to TriVert field
+      memcpy(record + off, TriVert, cbTriVert);
+      off += cbTriVert;
+      memcpy(record + off, GradObj, cbGradObj);
+      off += cbGradObj;
+      if(cbGradObjAlloc > cbGradObj){
+         memset(record+off,0,cbGradObjAlloc - cbGradObj);
+      }
    }
    return(record);
 }
 
-// U_EMRSETPALETTEENTRIES_set         50
+// U_EMRSETLINKEDUFIS_set            119  Not implemented
+// U_EMRSETTEXTJUSTIFICATION_set     120  Not implemented (denigrated)
+// U_EMRCOLORMATCHTOTARGETW_set      121  Not implemented  
+
+// U_EMRCREATECOLORSPACEW_set        122
 /**
-    \brief Allocate and construct a U_EMR_SETPALETTEENTRIES record.
-    Use setpaletteentries_set() instead of calling this function directly.
-    \return pointer to U_EMR_SETPALETTEENTRIES record, or NULL on error.
-    \param ihPal        Index of a Palette object in the EMF object table
-    \param iStart       First Palette entry in selected object to set
-    \param cEntries     Number of Palette entries in selected object to set
-    \param aPalEntries  Values to set with
+    \brief Allocate and construct a U_EMR_CREATECOLORSPACEW record.
+    Use createcolorspacew_set() instead of calling this function directly.
+    \return pointer to U_EMR_CREATECOLORSPACEW record, or NULL on error.
+    \param ihCS     Index to place object in EMF object table (this entry must not yet exist)
+    \param lcs      ColorSpace parameters
+    \param dwFlags  If low bit set Data is present
+    \param cbData   Number of bytes of theData field.
+    \param Data     (Optional, dwFlags & 1) color profile data 
 */
-char *U_EMRSETPALETTEENTRIES_set(
-      const uint32_t         ihPal,
-      const uint32_t         iStart,
-      const U_NUM_LOGPLTNTRY cEntries,
-      const PU_LOGPLTNTRY    aPalEntries
+char *U_EMRCREATECOLORSPACEW_set(
+      const uint32_t          ihCS,
+      const U_LOGCOLORSPACEW  lcs,
+      const uint32_t          dwFlags,
+      const U_CBDATA          cbData,
+      const uint8_t          *Data
    ){
    char *record;
-   int  irecsize;
-   int  cbPals;
+   unsigned int   cbData4,off;
+   int   irecsize;
 
-   if(!aPalEntries)return(NULL);
-   cbPals    = cEntries * sizeof(U_LOGPLTNTRY);
-   irecsize = sizeof(U_EMRSETPALETTEENTRIES) + cbPals - sizeof(U_LOGPLTNTRY);
+   cbData4 = UP4(cbData);                     // buffer to hold Data
+   irecsize = sizeof(U_EMRCREATECOLORSPACEW) + cbData4;
    record   = malloc(irecsize);
    if(record){
-      ((PU_EMR)                  record)->iType      = U_EMR_SETPALETTEENTRIES;
-      ((PU_EMR)                  record)->nSize      = irecsize;
-      ((PU_EMRSETPALETTEENTRIES) record)->ihPal      = ihPal;
-      ((PU_EMRSETPALETTEENTRIES) record)->iStart     = iStart;
-      ((PU_EMRSETPALETTEENTRIES) record)->cEntries   = cEntries;
-      memcpy(((PU_EMRSETPALETTEENTRIES) record)->aPalEntries, aPalEntries,cbPals);
+      ((PU_EMR)                  record)->iType   = U_EMR_CREATECOLORSPACEW;
+      ((PU_EMR)                  record)->nSize   = irecsize;
+      ((PU_EMRCREATECOLORSPACEW) record)->ihCS    = ihCS;
+      ((PU_EMRCREATECOLORSPACEW) record)->lcs     = lcs;
+      ((PU_EMRCREATECOLORSPACEW) record)->dwFlags = dwFlags;
+      ((PU_EMRCREATECOLORSPACEW) record)->cbData  = cbData;
+      off = sizeof(U_EMR) + sizeof(uint32_t) + sizeof(U_LOGCOLORSPACEW) + sizeof(uint32_t) + sizeof(U_CBDATA); // offset to Data field
+      memcpy(record + off, Data, cbData);
+      if(cbData < cbData4){
+        off += cbData;
+        memset(record + off,0,cbData4-cbData);
+      }
    }
    return(record);
-}
+} 
+
+
+/* **********************************************************************************************
+These functions construct a record directly at the end of an EMF in memory.  Each takes the same
+arguments as the corresponding U_EMR*_set function, preceded by the EMFTRACK.  In stream mode the
+record is built and written out as with emf_append().  They are only provided for records which
+are produced by the shared U_EMR_CORE* code.
+All return 0 on success and >=1 on failure.  There is nothing for the caller to free().
+*********************************************************************************************** */
 
-// U_EMRRESIZEPALETTE_set             51
 /**
-    \brief Allocate and construct a U_EMR_RESIZEPALETTE record.
-    \return pointer to U_EMR_RESIZEPALETTE record, or NULL on error.
-    \param ihPal    Index of a Palette object in the EMF object table
-    \param cEntries Number to expand or truncate the Palette entry list to
+    \brief Construct a U_EMR_POLYBEZIER record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYBEZIER_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBounds   bounding rectangle in device units
+    \param cptl        Number of points to draw
+    \param points      array of points
 */
-char *U_EMRRESIZEPALETTE_set(
-      const uint32_t ihPal,
-      const uint32_t cEntries
+int U_EMRPOLYBEZIER_emplace(
+      EMFTRACK       *et,
+      const U_RECTL   rclBounds,
+      const uint32_t  cptl,
+      const U_POINTL *points
    ){
-   return(U_EMR_CORE7_set(U_EMR_RESIZEPALETTE, (U_PAIR){ihPal,cEntries}));
+   return(U_EMR_CORE1_set(et, U_EMR_POLYBEZIER, rclBounds, cptl, points) ? 0 : 1);
 }
 
-// U_EMRREALIZEPALETTE_set            52
 /**
-    \brief Allocate and construct a U_EMR_REALIZEPALETTE record.
-    \return pointer to U_EMR_REALIZEPALETTE record, or NULL on error.
+    \brief Construct a U_EMR_POLYGON record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYGON_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBounds   bounding rectangle in device units
+    \param cptl        Number of points to draw
+    \param points      array of points
 */
-char *U_EMRREALIZEPALETTE_set(void){
-  return(U_EMR_CORE5_set(U_EMR_REALIZEPALETTE));
+int U_EMRPOLYGON_emplace(
+      EMFTRACK       *et,
+      const U_RECTL   rclBounds,
+      const uint32_t  cptl,
+      const U_POINTL *points
+   ){
+   return(U_EMR_CORE1_set(et, U_EMR_POLYGON, rclBounds, cptl, points) ? 0 : 1);
 }
 
-// U_EMREXTFLOODFILL_set              53
 /**
-    \brief Allocate and construct a U_EMR_EXTFLOODFILL record.
-    \return pointer to U_EMR_EXTFLOODFILL record, or NULL on error.
-    \param ptlStart Start point in logical units
-    \param crColor  Color to fill with
-    \param iMode    FloodFill Enumeration
+    \brief Construct a U_EMR_POLYLINE record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYLINE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBounds   bounding rectangle in device units
+    \param cptl        Number of points to draw
+    \param points      array of points
 */
-char *U_EMREXTFLOODFILL_set(
-      const U_POINTL   ptlStart,
-      const U_COLORREF crColor,
-      const uint32_t   iMode
+int U_EMRPOLYLINE_emplace(
+      EMFTRACK       *et,
+      const U_RECTL   rclBounds,
+      const uint32_t  cptl,
+      const U_POINTL *points
    ){
-   char *record;
-   int  irecsize;
-
-   irecsize = sizeof(U_EMREXTFLOODFILL);
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)             record)->iType    = U_EMR_EXTFLOODFILL; 
-      ((PU_EMR)             record)->nSize    = irecsize;           
-      ((PU_EMREXTFLOODFILL) record)->ptlStart = ptlStart;           
-      ((PU_EMREXTFLOODFILL) record)->crColor  = crColor;            
-      ((PU_EMREXTFLOODFILL) record)->iMode    = iMode;              
-   }
-   return(record);
+   return(U_EMR_CORE1_set(et, U_EMR_POLYLINE, rclBounds, cptl, points) ? 0 : 1);
 }
 
-// U_EMRLINETO_set                    54
 /**
-    \brief Allocate and construct a U_EMR_LINETO record.
-    \return pointer to U_EMR_LINETO record, or NULL on error.
-    \param ptl Point coordinates
+    \brief Construct a U_EMR_POLYBEZIERTO record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYBEZIERTO_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBounds   bounding rectangle in device units
+    \param cptl        Number of points to draw
+    \param points      array of points
 */
-char *U_EMRLINETO_set(
-      const U_POINTL ptl
+int U_EMRPOLYBEZIERTO_emplace(
+      EMFTRACK       *et,
+      const U_RECTL   rclBounds,
+      const uint32_t  cptl,
+      const U_POINTL *points
    ){
-   return(U_EMR_CORE7_set(U_EMR_LINETO, ptl));
+   return(U_EMR_CORE1_set(et, U_EMR_POLYBEZIERTO, rclBounds, cptl, points) ? 0 : 1);
 }
 
-// U_EMRARCTO_set                     55
 /**
-    \brief Allocate and construct a U_EMR_ARCTO record.
-    \return pointer to U_EMR_ARCTO record, or NULL on error.
-    \param rclBox   bounding rectangle in logical units
-    \param ptlStart Start point in logical units
-    \param ptlEnd   End point in logical units
-    
-    Note that the draw begins with a line from the current point to ptlStart, which is
-    not indicated in the Microsoft EMF documentation for this record.
+    \brief Construct a U_EMR_POLYLINETO record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYLINETO_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBounds   bounding rectangle in device units
+    \param cptl        Number of points to draw
+    \param points      array of points
 */
-char *U_EMRARCTO_set(
-      U_RECTL             rclBox,
-      U_POINTL            ptlStart,
-      U_POINTL            ptlEnd
+int U_EMRPOLYLINETO_emplace(
+      EMFTRACK       *et,
+      const U_RECTL   rclBounds,
+      const uint32_t  cptl,
+      const U_POINTL *points
    ){
-   return(U_EMR_CORE9_set(U_EMR_ARCTO,rclBox, ptlStart, ptlEnd));
+   return(U_EMR_CORE1_set(et, U_EMR_POLYLINETO, rclBounds, cptl, points) ? 0 : 1);
 }
 
-// U_EMRPOLYDRAW_set                  56
 /**
-    \brief Allocate and construct a U_EMR_POLYDRAW record.
-    \return pointer to U_EMR_POLYDRAW record, or NULL on error.
-    \param rclBounds Bounding rectangle in device units
-    \param cptl      Number of U_POINTL objects
-    \param aptl      Array of U_POINTL objects
-    \param abTypes   Array of Point Enumeration 
+    \brief Construct a U_EMR_POLYPOLYLINE record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYPOLYLINE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBounds    bounding rectangle in device units
+    \param nPolys       Number of elements in aPolyCounts
+    \param aPolyCounts  Number of points in each poly (sequential)
+    \param cptl         Total number of points (over all poly)
+    \param points       array of points
 */
-char *U_EMRPOLYDRAW_set(
-      const U_RECTL       rclBounds,
-      const U_NUM_POINTL  cptl,
-      const U_POINTL     *aptl,
-      const uint8_t      *abTypes
+int U_EMRPOLYPOLYLINE_emplace(
+      EMFTRACK       *et,
+      const U_RECTL   rclBounds,
+      const uint32_t  nPolys,
+      const uint32_t *aPolyCounts,
+      const uint32_t  cptl,
+      const U_POINTL *points
    ){
-   char *record;
-   int  irecsize;
-   int  cbPoints, cbAbTypes, cbAbTypes4, off;
+   return(U_EMR_CORE2_set(et, U_EMR_POLYPOLYLINE, rclBounds, nPolys, aPolyCounts,cptl, points) ? 0 : 1);
+}
 
-   if(!cptl || !aptl || !abTypes)return(NULL);
-   cbPoints    = cptl * sizeof(U_POINTL);    // space for aptl
-   cbAbTypes    = cptl;                       // number of abTypes (same array size, 1 byte each)
-   cbAbTypes4    = UP4(cbAbTypes);                // space for abTypes
-   irecsize = sizeof(U_EMRPOLYDRAW) + cbPoints + cbAbTypes4 - sizeof(U_POINTL) - 1;
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)         record)->iType       = U_EMR_POLYDRAW;
-      ((PU_EMR)         record)->nSize       = irecsize;
-      ((PU_EMRPOLYDRAW) record)->rclBounds   = rclBounds;
-      ((PU_EMRPOLYDRAW) record)->cptl        = cptl;
-      off = sizeof(U_EMR) + sizeof(U_RECTL) + sizeof(uint32_t);  // offset to first variable part
-      memcpy(record+off,aptl,cbPoints);
-      off += cbPoints;
-      memcpy(record+off,abTypes,cbAbTypes);
-      off += cbAbTypes;
-      if(cbAbTypes4 > cbAbTypes){ memset(record+off,0,cbAbTypes4-cbAbTypes); } // keeps valgrind happy (initialize padding after byte array)
-   }
-   return(record);
-}   
+/**
+    \brief Construct a U_EMR_POLYPOLYGON record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYPOLYGON_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBounds    bounding rectangle in device units
+    \param nPolys       Number of elements in aPolyCounts
+    \param aPolyCounts  Number of points in each poly (sequential)
+    \param cptl         Total number of points (over all poly)
+    \param points       array of points
+*/
+int U_EMRPOLYPOLYGON_emplace(
+      EMFTRACK       *et,
+      const U_RECTL   rclBounds,
+      const uint32_t  nPolys,
+      const uint32_t *aPolyCounts,
+      const uint32_t  cptl,
+      const U_POINTL *points
+   ){
+   return(U_EMR_CORE2_set(et, U_EMR_POLYPOLYGON, rclBounds, nPolys, aPolyCounts,cptl, points) ? 0 : 1);
+}
 
-// U_EMRSETARCDIRECTION_set           57
-/**
-    \brief Allocate and construct a U_EMR_SETARCDIRECTION record.
-    \return pointer to U_EMR_SETARCDIRECTION record, or NULL on error.
-    \param iArcDirection ArcDirection Enumeration
+/** 
+    \brief Construct a U_EMR_SETWINDOWEXTEX record directly at the end of an EMF in memory.
+    Same as U_EMRSETWINDOWEXTEX_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param szlExtent H & V extent in logical units
 */
-char *U_EMRSETARCDIRECTION_set(
-      const uint32_t iArcDirection
+int U_EMRSETWINDOWEXTEX_emplace(
+      EMFTRACK     *et,
+      const U_SIZEL szlExtent 
    ){
-   return(U_EMR_CORE3_set(U_EMR_SETARCDIRECTION, iArcDirection));
+   U_PAIR temp;
+   temp.x = szlExtent.cx;
+   temp.y = szlExtent.cy;
+   return(U_EMR_CORE7_set(et, U_EMR_SETWINDOWEXTEX, temp) ? 0 : 1); 
 }
 
-// U_EMRSETMITERLIMIT_set             58
 /**
-    \brief Allocate and construct a U_EMR_SETMITERLIMIT record.
-    \return pointer to U_EMR_SETMITERLIMIT record, or NULL on error.
-    \param eMiterLimit MapMode Enumeration
+    \brief Construct a U_EMR_SETWINDOWORGEX record directly at the end of an EMF in memory.
+    Same as U_EMRSETWINDOWORGEX_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param ptlOrigin H & V origin in logical units
 */
-char *U_EMRSETMITERLIMIT_set(
-      const uint32_t eMiterLimit
+int U_EMRSETWINDOWORGEX_emplace(
+      EMFTRACK      *et,
+      const U_POINTL ptlOrigin
    ){
-   return(U_EMR_CORE3_set(U_EMR_SETMITERLIMIT, eMiterLimit));
+   return(U_EMR_CORE7_set(et, U_EMR_SETWINDOWORGEX, ptlOrigin) ? 0 : 1); // U_PAIR and U_POINTL are the same thing
 }
 
+/**
+    \brief Construct a U_EMR_SETVIEWPORTEXTEX record directly at the end of an EMF in memory.
+    Same as U_EMRSETVIEWPORTEXTEX_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param szlExtent  H & V extent in logical units
+*/
+int U_EMRSETVIEWPORTEXTEX_emplace(
+      EMFTRACK     *et,
+      const U_SIZEL szlExtent
+   ){
+   U_PAIR temp;
+   temp.x = szlExtent.cx;
+   temp.y = szlExtent.cy;
+   return(U_EMR_CORE7_set(et, U_EMR_SETVIEWPORTEXTEX, temp) ? 0 : 1); 
+}
 
-// U_EMRBEGINPATH_set                 59
 /**
-    \brief Allocate and construct a U_EMR_BEGINPATH record.
-    \return pointer to U_EMR_BEGINPATH record, or NULL on error.
+    \brief Construct a U_EMR_SETVIEWPORTORGEX record directly at the end of an EMF in memory.
+    Same as U_EMRSETVIEWPORTORGEX_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param ptlOrigin  H & V origin in logical units
 */
-char *U_EMRBEGINPATH_set(void){
-   return(U_EMR_CORE5_set(U_EMR_BEGINPATH));
+int U_EMRSETVIEWPORTORGEX_emplace(
+      EMFTRACK      *et,
+      const U_POINTL ptlOrigin
+   ){
+   return(U_EMR_CORE7_set(et, U_EMR_SETVIEWPORTORGEX, ptlOrigin) ? 0 : 1);  // U_PAIR and U_POINTL are the same thing
 }
 
-// U_EMRENDPATH_set                   60
 /**
-    \brief Allocate and construct a U_EMR_ENDPATH record.
-    \return pointer to U_EMR_ENDPATH record, or NULL on error.
+    \brief Construct a U_EMR_SETBRUSHORGEX record directly at the end of an EMF in memory.
+    Same as U_EMRSETBRUSHORGEX_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param ptlOrigin   H & V origin in logical units
 */
-char *U_EMRENDPATH_set(void){
-   return(U_EMR_CORE5_set(U_EMR_ENDPATH));
+int U_EMRSETBRUSHORGEX_emplace(
+      EMFTRACK      *et,
+      const U_POINTL ptlOrigin
+   ){
+   return(U_EMR_CORE7_set(et, U_EMR_SETBRUSHORGEX, *((PU_PAIR) & ptlOrigin)) ? 0 : 1); 
 }
 
-// U_EMRCLOSEFIGURE_set               61
 /**
-    \brief Allocate and construct a U_EMR_CLOSEFIGURE record.
-    \return pointer to U_EMR_CLOSEFIGURE record, or NULL on error.
+    \brief Construct a U_EMR_SETMAPMODE record directly at the end of an EMF in memory.
+    Same as U_EMRSETMAPMODE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param iMode  MapMode Enumeration
 */
-char *U_EMRCLOSEFIGURE_set(void){
-   return(U_EMR_CORE5_set(U_EMR_CLOSEFIGURE));
+int U_EMRSETMAPMODE_emplace(
+      EMFTRACK      *et,
+      const uint32_t iMode
+   ){
+   return(U_EMR_CORE3_set(et, U_EMR_SETMAPMODE, iMode) ? 0 : 1);
 }
 
-// U_EMRFILLPATH_set                  62
 /**
-    \brief Allocate and construct a U_EMR_FILLPATH record.
-    \return pointer to U_EMR_FILLPATH record, or NULL on error.
-    \param rclBox Bounding rectangle in device units
-    
-    U_EMR_FILLPATH closes the open figure before filling.
+    \brief Construct a U_EMR_SETBKMODE record directly at the end of an EMF in memory.
+    Same as U_EMRSETBKMODE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param iMode BackgroundMode Enumeration
 */
-char *U_EMRFILLPATH_set(
-      const U_RECTL rclBox
+int U_EMRSETBKMODE_emplace(
+      EMFTRACK      *et, 
+      const uint32_t iMode
    ){
-   return(U_EMR_CORE4_set(U_EMR_FILLPATH,rclBox));
-} 
+  return(U_EMR_CORE3_set(et, U_EMR_SETBKMODE, iMode) ? 0 : 1);
+}
 
-// U_EMRSTROKEANDFILLPATH_set         63
 /**
-    \brief Allocate and construct a U_EMR_STROKEANDFILLPATH record.
-    \return pointer to U_EMR_STROKEANDFILLPATH record, or NULL on error.
-    \param rclBox Bounding rectangle in device units
+    \brief Construct a U_EMR_SETPOLYFILLMODE record directly at the end of an EMF in memory.
+    Same as U_EMRSETPOLYFILLMODE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param iMode  PolygonFillMode Enumeration
+*/
+int U_EMRSETPOLYFILLMODE_emplace(
+      EMFTRACK      *et,
+      const uint32_t iMode
+   ){
+   return(U_EMR_CORE3_set(et, U_EMR_SETPOLYFILLMODE, iMode) ? 0 : 1);
+}
 
-    U_EMR_STROKEANDFILLPATH closes the open figure before filling and stroking.
-    There appears to be no way to fill an open path while stroking it, as any one
-    of U_EMRFILLPATH, U_EMRSTROKEPATH, or U_EMRSTROKEANDFILEPATH will "use up" the path,
+/**
+    \brief Construct a U_EMR_SETROP2 record directly at the end of an EMF in memory.
+    Same as U_EMRSETROP2_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param iMode  RasterOperation2 Enumeration
 */
-char *U_EMRSTROKEANDFILLPATH_set(
-      const U_RECTL rclBox
+int U_EMRSETROP2_emplace(
+      EMFTRACK      *et,
+      const uint32_t iMode 
    ){
-   return(U_EMR_CORE4_set(U_EMR_STROKEANDFILLPATH,rclBox));
-} 
+   return(U_EMR_CORE3_set(et, U_EMR_SETROP2, iMode) ? 0 : 1);
+}
 
-// U_EMRSTROKEPATH_set                64
 /**
-    \brief Allocate and construct a U_EMR_STROKEPATH record.
-    \return pointer to U_EMR_STROKEPATH record, or NULL on error.
-    \param rclBox Bounding rectangle in device units
+    \brief Construct a U_EMR_SETSTRETCHBLTMODE record directly at the end of an EMF in memory.
+    Same as U_EMRSETSTRETCHBLTMODE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param iMode  StretchMode Enumeration
+*/
+int U_EMRSETSTRETCHBLTMODE_emplace(
+      EMFTRACK      *et,
+      const uint32_t iMode
+   ){
+   return(U_EMR_CORE3_set(et, U_EMR_SETSTRETCHBLTMODE, iMode) ? 0 : 1);
+}
 
-    U_EMR_STROKEPATH does NOT close the open figure before stroking it.
+/**
+    \brief Construct a U_EMR_SETTEXTALIGN record directly at the end of an EMF in memory.
+    Same as U_EMRSETTEXTALIGN_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param iMode  TextAlignment Enumeration
 */
-char *U_EMRSTROKEPATH_set(
-      const U_RECTL rclBox
+int U_EMRSETTEXTALIGN_emplace(
+      EMFTRACK      *et,
+      const uint32_t iMode 
    ){
-   return(U_EMR_CORE4_set(U_EMR_STROKEPATH,rclBox));
-} 
+   return(U_EMR_CORE3_set(et, U_EMR_SETTEXTALIGN, iMode) ? 0 : 1);
+}
 
-// U_EMRFLATTENPATH_set               65
 /**
-    \brief Allocate and construct a U_EMR_FLATTENPATH record.
-    \return pointer to U_EMR_FLATTENPATH record, or NULL on error.
+    \brief Construct a U_EMR_SETTEXTCOLOR record directly at the end of an EMF in memory.
+    Same as U_EMRSETTEXTCOLOR_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param crColor  Text Color
 */
-char *U_EMRFLATTENPATH_set(void){
-   return(U_EMR_CORE5_set(U_EMR_FLATTENPATH));
+int U_EMRSETTEXTCOLOR_emplace(
+      EMFTRACK        *et,
+      const U_COLORREF crColor
+  ){
+  return(U_EMR_CORE3_set(et, U_EMR_SETTEXTCOLOR, *(uint32_t *) &crColor) ? 0 : 1);
 }
 
-// U_EMRWIDENPATH_set                 66
 /**
-    \brief Allocate and construct a U_EMR_WIDENPATH record.
-    \return pointer to U_EMR_WIDENPATH record, or NULL on error.
+    \brief Construct a U_EMR_SETBKCOLOR record directly at the end of an EMF in memory.
+    Same as U_EMRSETBKCOLOR_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param crColor Background Color
 */
-char *U_EMRWIDENPATH_set(void){
-   return(U_EMR_CORE5_set(U_EMR_WIDENPATH));
+int U_EMRSETBKCOLOR_emplace(
+      EMFTRACK        *et,
+      const U_COLORREF crColor
+  ){
+  return(U_EMR_CORE3_set(et, U_EMR_SETBKCOLOR, *(uint32_t *) &crColor) ? 0 : 1);
 }
 
-// U_EMRSELECTCLIPPATH_set            67
 /**
-    \brief Allocate and construct a U_EMR_SELECTCLIPPATH record.
-    \return pointer to U_EMR_SELECTCLIPPATH record, or NULL on error.
-    \param iMode RegionMode Enumeration
+    \brief Construct a U_EMR_OFFSETCLIPRGN record directly at the end of an EMF in memory.
+    Same as U_EMROFFSETCLIPRGN_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param ptl Clipping region 
 */
-char *U_EMRSELECTCLIPPATH_set(
-      const uint32_t iMode
-   ){ 
-   return(U_EMR_CORE3_set(U_EMR_SELECTCLIPPATH, iMode));
+int U_EMROFFSETCLIPRGN_emplace(
+      EMFTRACK      *et,
+      const U_POINTL ptl
+   ){
+  return(U_EMR_CORE7_set(et, U_EMR_OFFSETCLIPRGN, ptl) ? 0 : 1);
+}
+
+/** 
+    \brief Construct a U_EMR_MOVETOEX record directly at the end of an EMF in memory.
+    Same as U_EMRMOVETOEX_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param ptl Point coordinates
+*/
+int U_EMRMOVETOEX_emplace(
+      EMFTRACK      *et,
+      const U_POINTL ptl
+   ){
+   return(U_EMR_CORE7_set(et, U_EMR_MOVETOEX, ptl) ? 0 : 1);
 }
 
-// U_EMRABORTPATH_set                 68
 /**
-    \brief Allocate and construct a U_EMR_ABORTPATH record.
-    \return pointer to U_EMR_ABORTPATH record, or NULL on error.
+    \brief Construct a U_EMR_SETMETARGN record directly at the end of an EMF in memory.
+    Same as U_EMRSETMETARGN_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
 */
-char *U_EMRABORTPATH_set(void){
-   return(U_EMR_CORE5_set(U_EMR_ABORTPATH));
+int U_EMRSETMETARGN_emplace(EMFTRACK *et){
+  return(U_EMR_CORE5_set(et, U_EMR_SETMETARGN) ? 0 : 1);
 }
 
-// U_EMRUNDEF69                       69
+/**
+    \brief Construct a U_EMR_EXCLUDECLIPRECT record directly at the end of an EMF in memory.
+    Same as U_EMREXCLUDECLIPRECT_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclClip Clipping Region
+*/
+int U_EMREXCLUDECLIPRECT_emplace(
+      EMFTRACK     *et,
+      const U_RECTL rclClip
+    ){
+    return(U_EMR_CORE4_set(et, U_EMR_EXCLUDECLIPRECT,rclClip) ? 0 : 1);
+}
 
-// U_EMRCOMMENT_set                   70  Comment (any binary data, interpretation is program specific)
 /**
-    \brief Allocate and construct a U_EMR_COMMENT record.
-    \return pointer to U_EMR_COMMENT record, or NULL on error.
-    \param cbData Number of bytes in comment
-    \param Data   Comment (any binary data, interpretation is program specific)
+    \brief Construct a U_EMR_INTERSECTCLIPRECT record directly at the end of an EMF in memory.
+    Same as U_EMRINTERSECTCLIPRECT_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclClip Clipping Region
 */
-char *U_EMRCOMMENT_set(
-      const U_CBDATA cbData,
-      const char    *Data
-   ){
-   char *record;
-   unsigned int   cbData4;
-   int   irecsize;
+int U_EMRINTERSECTCLIPRECT_emplace(
+      EMFTRACK     *et,
+      const U_RECTL rclClip
+    ){
+    return(U_EMR_CORE4_set(et, U_EMR_INTERSECTCLIPRECT,rclClip) ? 0 : 1);
+}
 
-   cbData4    = UP4(cbData);
-   irecsize = sizeof(U_EMR) + sizeof(U_CBDATA) + cbData4;
-   record    = malloc(irecsize);
-   if(record){
-      ((PU_EMR)           record)->iType   = U_EMR_COMMENT;
-      ((PU_EMR)           record)->nSize   = irecsize;
-      ((PU_EMRCOMMENT)    record)->cbData  = cbData;
-      memcpy(record + irecsize - cbData4,Data,cbData);
-      if(cbData4 > cbData)memset(record + irecsize - cbData4 + cbData,0,cbData4-cbData);  // clear any unused bytes
-   }
-   return(record);
-} 
+/** 
+    \brief Construct a U_EMR_SCALEVIEWPORTEXTEX record directly at the end of an EMF in memory.
+    Same as U_EMRSCALEVIEWPORTEXTEX_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param xNum   Horizontal multiplier (!=0)
+    \param xDenom Horizontal divisor    (!=0)
+    \param yNum   Vertical   multiplier (!=0)
+    \param yDenom Vertical   divisor    (!=0)
+*/
+int U_EMRSCALEVIEWPORTEXTEX_emplace(
+    EMFTRACK      *et,
+    const int32_t  xNum,
+    const int32_t  xDenom,
+    const int32_t  yNum,
+    const int32_t  yDenom
+  ){
+  return(U_EMR_CORE4_set(et, U_EMR_SCALEVIEWPORTEXTEX,(U_RECTL){xNum,xDenom,yNum,yDenom}) ? 0 : 1);
+}
+
+/** 
+    \brief Construct a U_EMR_SCALEWINDOWEXTEX record directly at the end of an EMF in memory.
+    Same as U_EMRSCALEWINDOWEXTEX_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param xNum   Horizontal multiplier (!=0)
+    \param xDenom Horizontal divisor    (!=0)
+    \param yNum   Vertical   multiplier (!=0)
+    \param yDenom Vertical   divisor    (!=0)
+*/
+int U_EMRSCALEWINDOWEXTEX_emplace(
+    EMFTRACK      *et,
+    const int32_t  xNum,
+    const int32_t  xDenom,
+    const int32_t  yNum,
+    const int32_t  yDenom
+  ){
+  return(U_EMR_CORE4_set(et, U_EMR_SCALEWINDOWEXTEX,(U_RECTL){xNum,xDenom,yNum,yDenom}) ? 0 : 1);
+}
 
-// U_EMRFILLRGN_set                   71
 /**
-    \brief Allocate and construct a U_EMR_FILLRGN record.
-    Use fillrgn_set() instead of calling this function directly.
-    \return pointer to U_EMR_FILLRGN record, or NULL on error.
-    \param rclBounds  Bounding rectangle in device units
-    \param ihBrush    Index of a Brush object in the EMF object table
-    \param RgnData    Pointer to a U_RGNDATA structure
+    \brief Construct a U_EMR_SAVEDC record directly at the end of an EMF in memory.
+    Same as U_EMRSAVEDC_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
 */
-char *U_EMRFILLRGN_set(
-      const U_RECTL     rclBounds,
-      const uint32_t    ihBrush,
-      const PU_RGNDATA  RgnData
-   ){
-   char *record;
-   int   irecsize;
-   int   cbRgns,cbRgns4,rds,rds4,off;
+int U_EMRSAVEDC_emplace(EMFTRACK *et){
+  return(U_EMR_CORE5_set(et, U_EMR_SAVEDC) ? 0 : 1);
+}
 
-   if(!RgnData)return(NULL);
-   cbRgns   = ((PU_RGNDATAHEADER) RgnData)->nRgnSize;
-   cbRgns4  = UP4(cbRgns);
-   rds      = sizeof(U_RGNDATAHEADER) + cbRgns;
-   rds4     = UP4(rds);
-   irecsize = sizeof(U_EMRFILLRGN) - sizeof(U_RECTL) + cbRgns4;  // core + array - overlap of one rectL
-   record    = malloc(irecsize);
-   if(record){
-      ((PU_EMR)           record)->iType     = U_EMR_FILLRGN;
-      ((PU_EMR)           record)->nSize     = irecsize;
-      ((PU_EMRFILLRGN)    record)->rclBounds = rclBounds;
-      ((PU_EMRFILLRGN)    record)->cbRgnData = rds;
-      ((PU_EMRFILLRGN)    record)->ihBrush   = ihBrush;
-      off = sizeof(U_EMRFILLRGN) - sizeof(U_RGNDATA);
-      memcpy(record + off, RgnData, rds);
-      off += rds;
-      if(rds < rds4){ memset(record + off,0, rds4 - rds); } // clear any unused bytes
-   }
-   return(record);
-} 
+/**
+    \brief Construct a U_EMR_RESTOREDC record directly at the end of an EMF in memory.
+    Same as U_EMRRESTOREDC_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param iRelative DC to restore. -1 is preceding
+*/
+int U_EMRRESTOREDC_emplace(
+    EMFTRACK     *et,
+    const int32_t iRelative
+  ){
+  return(U_EMR_CORE3_set(et, U_EMR_RESTOREDC, (uint32_t) iRelative) ? 0 : 1);
+}
 
-// U_EMRFRAMERGN_set                  72
 /**
-    \brief Allocate and construct a U_EMR_FRAMERGN record.
-    Use framegrn_set() instead of calling this function directly.
-    \return pointer to U_EMR_FRAMERGN record, or NULL on error.
-    \param rclBounds  Bounding rectangle in device units
-    \param ihBrush    Index of a Brush object in the EMF object table
-    \param szlStroke  W & H of Brush stroke
-    \param RgnData    Pointer to a U_RGNDATA structure
+    \brief Construct a U_EMR_ELLIPSE record directly at the end of an EMF in memory.
+    Same as U_EMRELLIPSE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBox bounding rectangle in logical units
 */
-char *U_EMRFRAMERGN_set(
-      const U_RECTL     rclBounds,
-      const uint32_t    ihBrush,
-      const U_SIZEL     szlStroke,
-      const PU_RGNDATA  RgnData
+int U_EMRELLIPSE_emplace(
+      EMFTRACK     *et,
+      const U_RECTL rclBox
    ){
-   char *record;
-   int   irecsize;
-   int   cbRgns,cbRgns4,rds,rds4,off;
+   return(U_EMR_CORE4_set(et, U_EMR_ELLIPSE,rclBox) ? 0 : 1);
+}
 
-   if(!RgnData)return(NULL);
-   cbRgns   = ((PU_RGNDATAHEADER) RgnData)->nRgnSize;
-   cbRgns4  = UP4(cbRgns);
-   rds      = sizeof(U_RGNDATAHEADER) + cbRgns;
-   rds4     = UP4(rds);
-   irecsize = sizeof(U_EMRFRAMERGN) - sizeof(U_RECTL) + cbRgns4;  // core + array - overlap of one rectL
-   record    = malloc(irecsize);
-   if(record){
-      ((PU_EMR)           record)->iType     = U_EMR_FRAMERGN;
-      ((PU_EMR)           record)->nSize     = irecsize;
-      ((PU_EMRFRAMERGN)   record)->rclBounds = rclBounds;
-      ((PU_EMRFRAMERGN)   record)->cbRgnData = rds;
-      ((PU_EMRFRAMERGN)   record)->ihBrush   = ihBrush;
-      ((PU_EMRFRAMERGN)   record)->szlStroke = szlStroke;
-      off = sizeof(U_EMRFRAMERGN) - sizeof(U_RGNDATA);
-      memcpy(record + off, RgnData, rds);
-      off += rds;
-      if(rds < rds4){ memset(record + off,0, rds4 - rds); } // clear any unused bytes
-   }
-   return(record);
-} 
+/**
+    \brief Construct a U_EMR_RECTANGLE record directly at the end of an EMF in memory.
+    Same as U_EMRRECTANGLE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBox bounding rectangle in logical units
+*/
+int U_EMRRECTANGLE_emplace(
+      EMFTRACK     *et,
+      const U_RECTL rclBox
+   ){
+   return(U_EMR_CORE4_set(et, U_EMR_RECTANGLE,rclBox) ? 0 : 1);
+}
 
-// U_EMRINVERTRGN_set                 73
 /**
-    \brief Allocate and construct a U_EMR_INVERTRGN record.
-    \return pointer to U_EMR_INVERTRGN record, or NULL on error.
-    \param RgnData Variable size U_RGNDATA structure
+    \brief Construct a U_EMR_ARC record directly at the end of an EMF in memory.
+    Same as U_EMRARC_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBox   bounding rectangle in logical units
+    \param ptlStart Start point in logical units
+    \param ptlEnd   End point in logical units
 */
-char *U_EMRINVERTRGN_set(
-      const PU_RGNDATA RgnData
+int U_EMRARC_emplace(
+      EMFTRACK      *et,
+      const U_RECTL  rclBox,
+      const U_POINTL ptlStart,
+      const U_POINTL ptlEnd
    ){
-   return(U_EMR_CORE11_set(U_EMR_INVERTRGN, RgnData));
-} 
+   return(U_EMR_CORE9_set(et, U_EMR_ARC,rclBox, ptlStart, ptlEnd) ? 0 : 1);
+}
 
-// U_EMRPAINTRGN_set                  74
 /**
-    \brief Allocate and construct a U_EMR_PAINTRGN record.
-    \return pointer to U_EMR_PAINTRGN record, or NULL on error.
-    \param RgnData Variable size U_RGNDATA structure
+    \brief Construct a U_EMR_CHORD record directly at the end of an EMF in memory.
+    Same as U_EMRCHORD_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBox   bounding rectangle in logical units
+    \param ptlStart Start point in logical units
+    \param ptlEnd   End point in logical units
 */
-char *U_EMRPAINTRGN_set(
-      const PU_RGNDATA RgnData
+int U_EMRCHORD_emplace(
+      EMFTRACK      *et,
+      const U_RECTL  rclBox,
+      const U_POINTL ptlStart,
+      const U_POINTL ptlEnd
    ){
-   return(U_EMR_CORE11_set(U_EMR_PAINTRGN, RgnData));
-} 
+   return(U_EMR_CORE9_set(et, U_EMR_CHORD,rclBox, ptlStart, ptlEnd) ? 0 : 1);
+}
 
-// U_EMREXTSELECTCLIPRGN_set          75
 /**
-    \brief Allocate and construct a U_EMR_EXTSELECTCLIPRGN record.
-    \return pointer to U_EMR_EXTSELECTCLIPRGN or NULL on error.
-    \param iMode   RegionMode Enumeration       
-    \param RgnData Variable size U_RGNDATA structure
+    \brief Construct a U_EMR_PIE record directly at the end of an EMF in memory.
+    Same as U_EMRPIE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBox   bounding rectangle in logical units
+    \param ptlStart Start point in logical units
+    \param ptlEnd   End point in logical units
 */
-char *U_EMREXTSELECTCLIPRGN_set(
-      const uint32_t    iMode,
-      const PU_RGNDATA  RgnData
+int U_EMRPIE_emplace(
+      EMFTRACK      *et,
+      const U_RECTL  rclBox,
+      const U_POINTL ptlStart,
+      const U_POINTL ptlEnd
    ){
-   char *record;
-   int   irecsize;
-   int   cbRgns,cbRgns4,rds,rds4,off;
+   return(U_EMR_CORE9_set(et, U_EMR_PIE,rclBox, ptlStart, ptlEnd) ? 0 : 1);
+}
 
-   if(!RgnData)return(NULL);
-   cbRgns   = ((PU_RGNDATAHEADER) RgnData)->nRgnSize;
-   cbRgns4  = UP4(cbRgns);
-   rds      = sizeof(U_RGNDATAHEADER) + cbRgns;
-   rds4     = UP4(rds);
-   irecsize = sizeof(U_EMREXTSELECTCLIPRGN) - sizeof(U_RECTL) + cbRgns4;  // core + array - overlap of one rectL
-   record    = malloc(irecsize);
-   if(record){
-      ((PU_EMR)                  record)->iType     = U_EMR_EXTSELECTCLIPRGN;
-      ((PU_EMR)                  record)->nSize     = irecsize;
-      ((PU_EMREXTSELECTCLIPRGN)  record)->cbRgnData = rds;
-      ((PU_EMREXTSELECTCLIPRGN)  record)->iMode     = iMode;
-      off = sizeof(U_EMREXTSELECTCLIPRGN) - sizeof(U_RGNDATA);
-      memcpy(record + off, RgnData, rds);
-      off += rds;
-      if(rds < rds4){ memset(record + off,0, rds4 - rds); } // clear any unused bytes
-   }
-   return(record);
-} 
+/**
+    \brief Construct a U_EMR_SELECTPALETTE record directly at the end of an EMF in memory.
+    Same as U_EMRSELECTPALETTE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param ihPal Index of a Palette object in the EMF object table
+*/
+int U_EMRSELECTPALETTE_emplace(
+      EMFTRACK      *et,
+      const uint32_t ihPal
+   ){
+   return(U_EMR_CORE3_set(et, U_EMR_SELECTPALETTE, ihPal) ? 0 : 1);
+}
 
-// U_EMRBITBLT_set                    76
 /**
-    \brief Allocate and construct a U_EMR_BITBLT record.
-    \return pointer to U_EMR_BITBLT record, or NULL on error.
-    \param rclBounds    Bounding rectangle in device units
-    \param Dest         Destination UL corner in logical units
-    \param cDest        Destination width in logical units
-    \param Src          Source rectangle UL corner in logical units
-    \param xformSrc     Source bitmap transform (world to page coordinates)
-    \param crBkColorSrc Source bitmap background color
-    \param iUsageSrc    DIBcolors Enumeration
-    \param dwRop        Ternary Raster Operation enumeration
-    \param Bmi          (Optional) bitmapbuffer (U_BITMAPINFO section)
-    \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-    \param Px           (Optional) bitmapbuffer (pixel array section )
+    \brief Construct a U_EMR_RESIZEPALETTE record directly at the end of an EMF in memory.
+    Same as U_EMRRESIZEPALETTE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param ihPal    Index of a Palette object in the EMF object table
+    \param cEntries Number to expand or truncate the Palette entry list to
 */
-char *U_EMRBITBLT_set(
-      const U_RECTL        rclBounds,
-      const U_POINTL       Dest,
-      const U_POINTL       cDest,
-      const U_POINTL       Src,
-      const U_XFORM        xformSrc,
-      const U_COLORREF     crBkColorSrc,
-      const uint32_t       iUsageSrc,
-      const uint32_t       dwRop,
-      const PU_BITMAPINFO  Bmi,
-      const uint32_t       cbPx,
-      char                *Px
+int U_EMRRESIZEPALETTE_emplace(
+      EMFTRACK      *et,
+      const uint32_t ihPal,
+      const uint32_t cEntries
    ){
-   char *record;
-   int   irecsize;
-   int   cbImage,cbImage4,cbBmi,off;
+   return(U_EMR_CORE7_set(et, U_EMR_RESIZEPALETTE, (U_PAIR){ihPal,cEntries}) ? 0 : 1);
+}
 
-   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
-   irecsize = sizeof(U_EMRBITBLT) + cbBmi + cbImage4;
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)             record)->iType        = U_EMR_BITBLT;
-      ((PU_EMR)             record)->nSize        = irecsize;
-      ((PU_EMRBITBLT)       record)->rclBounds    = rclBounds;
-      ((PU_EMRBITBLT)       record)->Dest         = Dest;
-      ((PU_EMRBITBLT)       record)->cDest        = cDest;
-      ((PU_EMRBITBLT)       record)->dwRop        = dwRop;
-      ((PU_EMRBITBLT)       record)->Src          = Src;
-      ((PU_EMRBITBLT)       record)->xformSrc     = xformSrc;
-      ((PU_EMRBITBLT)       record)->crBkColorSrc = crBkColorSrc;
-      ((PU_EMRBITBLT)       record)->iUsageSrc    = iUsageSrc;
-      off = sizeof(U_EMRBITBLT);
-      APPEND_PXBMISRC(record, U_EMRBITBLT, cbBmi, Bmi, Px, cbImage, cbImage4);
-   }
-   return(record);
+/**
+    \brief Construct a U_EMR_REALIZEPALETTE record directly at the end of an EMF in memory.
+    Same as U_EMRREALIZEPALETTE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+*/
+int U_EMRREALIZEPALETTE_emplace(EMFTRACK *et){
+  return(U_EMR_CORE5_set(et, U_EMR_REALIZEPALETTE) ? 0 : 1);
 }
 
-// U_EMRSTRETCHBLT_set                77
 /**
-    \brief Allocate and construct a U_EMR_STRETCHBLT record.
-    \return pointer to U_EMR_STRETCHBLT record, or NULL on error.
-    \param rclBounds    Bounding rectangle in device units
-    \param Dest         Destination UL corner in logical units
-    \param cDest        Destination width in logical units
-    \param Src          Source UL corner in logical units
-    \param cSrc         Src W & H in logical units
-    \param xformSrc     Transform to apply to source
-    \param crBkColorSrc Background color
-    \param iUsageSrc    DIBcolors Enumeration
-    \param dwRop        Ternary Raster Operation enumeration
-    \param Bmi          (Optional) bitmapbuffer (U_BITMAPINFO section)
-    \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-    \param Px           (Optional) bitmapbuffer (pixel array section )
+    \brief Construct a U_EMR_LINETO record directly at the end of an EMF in memory.
+    Same as U_EMRLINETO_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param ptl Point coordinates
 */
-char *U_EMRSTRETCHBLT_set(
-      const U_RECTL        rclBounds,
-      const U_POINTL       Dest,
-      const U_POINTL       cDest,
-      const U_POINTL       Src,
-      const U_POINTL       cSrc,
-      const U_XFORM        xformSrc,
-      const U_COLORREF     crBkColorSrc,
-      const uint32_t       iUsageSrc,
-      const uint32_t       dwRop,
-      const PU_BITMAPINFO  Bmi,
-      const uint32_t       cbPx,
-      char                *Px
+int U_EMRLINETO_emplace(
+      EMFTRACK      *et,
+      const U_POINTL ptl
    ){
-   char *record;
-   int   irecsize;
-   int   cbImage,cbImage4,cbBmi,off;
+   return(U_EMR_CORE7_set(et, U_EMR_LINETO, ptl) ? 0 : 1);
+}
 
-   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
-   
-   irecsize = sizeof(U_EMRSTRETCHBLT) + cbBmi + cbImage4;
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)                 record)->iType        = U_EMR_STRETCHBLT;
-      ((PU_EMR)                 record)->nSize        = irecsize;
-      ((PU_EMRSTRETCHBLT)       record)->rclBounds    = rclBounds;
-      ((PU_EMRSTRETCHBLT)       record)->Dest         = Dest;
-      ((PU_EMRSTRETCHBLT)       record)->cDest        = cDest;
-      ((PU_EMRSTRETCHBLT)       record)->dwRop        = dwRop;
-      ((PU_EMRSTRETCHBLT)       record)->Src          = Src;
-      ((PU_EMRSTRETCHBLT)       record)->xformSrc     = xformSrc;
-      ((PU_EMRSTRETCHBLT)       record)->crBkColorSrc = crBkColorSrc;
-      ((PU_EMRSTRETCHBLT)       record)->iUsageSrc    = iUsageSrc;
-      off = sizeof(U_EMRSTRETCHBLT);
-      APPEND_PXBMISRC(record, U_EMRSTRETCHBLT, cbBmi, Bmi, Px, cbImage, cbImage4);
-      ((PU_EMRSTRETCHBLT)       record)->cSrc         = cSrc;
-   }
-   return(record);
+/**
+    \brief Construct a U_EMR_ARCTO record directly at the end of an EMF in memory.
+    Same as U_EMRARCTO_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBox   bounding rectangle in logical units
+    \param ptlStart Start point in logical units
+    \param ptlEnd   End point in logical units
+    
+    Note that the draw begins with a line from the current point to ptlStart, which is
+    not indicated in the Microsoft EMF documentation for this record.
+*/
+int U_EMRARCTO_emplace(
+      EMFTRACK           *et,
+      U_RECTL             rclBox,
+      U_POINTL            ptlStart,
+      U_POINTL            ptlEnd
+   ){
+   return(U_EMR_CORE9_set(et, U_EMR_ARCTO,rclBox, ptlStart, ptlEnd) ? 0 : 1);
+}
+
+/**
+    \brief Construct a U_EMR_SETARCDIRECTION record directly at the end of an EMF in memory.
+    Same as U_EMRSETARCDIRECTION_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param iArcDirection ArcDirection Enumeration
+*/
+int U_EMRSETARCDIRECTION_emplace(
+      EMFTRACK      *et,
+      const uint32_t iArcDirection
+   ){
+   return(U_EMR_CORE3_set(et, U_EMR_SETARCDIRECTION, iArcDirection) ? 0 : 1);
 }
 
-// U_EMRMASKBLT_set                   78
 /**
-    \brief Allocate and construct a U_EMR_MASKBLT record.
-    \return pointer to U_EMR_MASKBLT record, or NULL on error.
-    \param rclBounds    Bounding rectangle in device units
-    \param Dest         Destination UL corner in logical units
-    \param cDest        Destination width in logical units
-    \param Src          Source UL corner in logical units
-    \param xformSrc     Transform to apply to source
-    \param crBkColorSrc Background color
-    \param iUsageSrc    DIBcolors Enumeration
-    \param Mask         Mask UL corner in logical units
-    \param iUsageMask   DIBcolors Enumeration
-    \param dwRop        Ternary Raster Operation enumeration
-    \param Bmi          (Optional) bitmapbuffer (U_BITMAPINFO section)
-    \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-    \param Px           (Optional) bitmapbuffer (pixel array section )
-    \param MskBmi       (Optional) bitmapbuffer (U_BITMAPINFO section)
-    \param cbMsk        Size in bytes of mask array (row stride * height, there may be some padding at the end of each row)
-    \param Msk          (Optional) bitmapbuffer (mask section )
+    \brief Construct a U_EMR_SETMITERLIMIT record directly at the end of an EMF in memory.
+    Same as U_EMRSETMITERLIMIT_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param eMiterLimit MapMode Enumeration
 */
-char *U_EMRMASKBLT_set(
-      const U_RECTL        rclBounds,
-      const U_POINTL       Dest,
-      const U_POINTL       cDest,
-      const U_POINTL       Src,
-      const U_XFORM        xformSrc,
-      const U_COLORREF     crBkColorSrc,
-      const uint32_t       iUsageSrc,
-      const U_POINTL       Mask,
-      const uint32_t       iUsageMask,
-      const uint32_t       dwRop,
-      const PU_BITMAPINFO  Bmi,
-      const uint32_t       cbPx,
-      char                *Px,
-      const PU_BITMAPINFO  MskBmi,
-      const uint32_t       cbMsk,
-      char                *Msk
+int U_EMRSETMITERLIMIT_emplace(
+      EMFTRACK      *et,
+      const uint32_t eMiterLimit
    ){
-   char *record;
-   int   irecsize;
-   int   cbImage,cbImage4,cbBmi,cbMskImage,cbMskImage4,cbMskBmi,off;
+   return(U_EMR_CORE3_set(et, U_EMR_SETMITERLIMIT, eMiterLimit) ? 0 : 1);
+}
 
-   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
-   SET_CB_FROM_PXBMI(Msk,MskBmi,cbMskImage,cbMskImage4,cbMskBmi,cbMsk);
+/**
+    \brief Construct a U_EMR_BEGINPATH record directly at the end of an EMF in memory.
+    Same as U_EMRBEGINPATH_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+*/
+int U_EMRBEGINPATH_emplace(EMFTRACK *et){
+   return(U_EMR_CORE5_set(et, U_EMR_BEGINPATH) ? 0 : 1);
+}
 
-   irecsize = sizeof(U_EMRMASKBLT) + cbBmi + cbImage4 + cbMskBmi + cbMskImage4;
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)              record)->iType        = U_EMR_MASKBLT;
-      ((PU_EMR)              record)->nSize        = irecsize;
-      ((PU_EMRMASKBLT)       record)->rclBounds    = rclBounds;
-      ((PU_EMRMASKBLT)       record)->Dest         = Dest;
-      ((PU_EMRMASKBLT)       record)->cDest        = cDest;
-      ((PU_EMRMASKBLT)       record)->dwRop        = dwRop;
-      ((PU_EMRMASKBLT)       record)->Src          = Src;
-      ((PU_EMRMASKBLT)       record)->xformSrc     = xformSrc;
-      ((PU_EMRMASKBLT)       record)->crBkColorSrc = crBkColorSrc;
-      ((PU_EMRMASKBLT)       record)->iUsageSrc    = iUsageSrc;
-      ((PU_EMRMASKBLT)       record)->Mask         = Mask;
-      ((PU_EMRMASKBLT)       record)->iUsageMask   = iUsageMask;
-      off = sizeof(U_EMRMASKBLT);
-      APPEND_PXBMISRC(record, U_EMRMASKBLT, cbBmi, Bmi, Px, cbImage, cbImage4);
-      APPEND_MSKBMISRC(record, U_EMRMASKBLT, cbMskBmi, MskBmi, Msk, cbMskImage, cbMskImage4);
-   }
-   return(record);
+/**
+    \brief Construct a U_EMR_ENDPATH record directly at the end of an EMF in memory.
+    Same as U_EMRENDPATH_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+*/
+int U_EMRENDPATH_emplace(EMFTRACK *et){
+   return(U_EMR_CORE5_set(et, U_EMR_ENDPATH) ? 0 : 1);
 }
 
-// U_EMRPLGBLT_set                    79
+/**
+    \brief Construct a U_EMR_CLOSEFIGURE record directly at the end of an EMF in memory.
+    Same as U_EMRCLOSEFIGURE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+*/
+int U_EMRCLOSEFIGURE_emplace(EMFTRACK *et){
+   return(U_EMR_CORE5_set(et, U_EMR_CLOSEFIGURE) ? 0 : 1);
+}
 
 /**
-    \brief Allocate and construct a U_EMRPLGBLT record.
-    \return U_EMRPLGBLT record.
-    \param rclBounds    Bounding rectangle in device units
-    \param aptlDst      Defines parallelogram, UL, UR, LL corners, LR is derived (3 points)
-    \param Src          Source UL corner in logical units
-    \param cSrc         Source width in logical units
-    \param xformSrc     Transform to apply to source
-    \param crBkColorSrc Background color
-    \param iUsageSrc    DIBcolors Enumeration
-    \param Mask         Mask UL corner in logical units
-    \param iUsageMask   DIBcolors Enumeration
-    \param Bmi          (Optional) bitmapbuffer (U_BITMAPINFO section)
-    \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-    \param Px           (Optional) bitmapbuffer (pixel array section )
-    \param MskBmi       (Optional) bitmapbuffer (U_BITMAPINFO section)
-    \param cbMsk        Size in bytes of mask array (row stride * height, there may be some padding at the end of each row)
-    \param Msk          (Optional) bitmapbuffer (mask section )
+    \brief Construct a U_EMR_FILLPATH record directly at the end of an EMF in memory.
+    Same as U_EMRFILLPATH_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBox Bounding rectangle in device units
+    
+    U_EMR_FILLPATH closes the open figure before filling.
 */
-char *U_EMRPLGBLT_set(
-      const U_RECTL       rclBounds,
-      const PU_POINTL     aptlDst,
-      const U_POINTL      Src,
-      const U_POINTL      cSrc,
-      const U_XFORM       xformSrc,
-      const U_COLORREF    crBkColorSrc,
-      const uint32_t      iUsageSrc,
-      const U_POINTL      Mask,
-      const uint32_t      iUsageMask,
-      const PU_BITMAPINFO Bmi,
-      const uint32_t      cbPx,
-      char               *Px,
-      const PU_BITMAPINFO MskBmi,
-      const uint32_t      cbMsk,
-      char               *Msk
+int U_EMRFILLPATH_emplace(
+      EMFTRACK     *et,
+      const U_RECTL rclBox
    ){
-   char *record;
-   int   irecsize;
-   int   cbImage,cbImage4,cbBmi,cbMskImage,cbMskImage4,cbMskBmi,off;
+   return(U_EMR_CORE4_set(et, U_EMR_FILLPATH,rclBox) ? 0 : 1);
+}
 
-   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
-   SET_CB_FROM_PXBMI(Msk,MskBmi,cbMskImage,cbMskImage4,cbMskBmi,cbMsk);
+/**
+    \brief Construct a U_EMR_STROKEANDFILLPATH record directly at the end of an EMF in memory.
+    Same as U_EMRSTROKEANDFILLPATH_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBox Bounding rectangle in device units
 
-   irecsize = sizeof(U_EMRPLGBLT) + cbBmi + cbImage4 + cbMskBmi + cbMskImage4;
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)             record)->iType        = U_EMR_PLGBLT;
-      ((PU_EMR)             record)->nSize        = irecsize;
-      ((PU_EMRPLGBLT)       record)->rclBounds    = rclBounds;
-      memcpy(((PU_EMRPLGBLT)  record)->aptlDst,aptlDst,3*sizeof(U_POINTL));
-      ((PU_EMRPLGBLT)       record)->Src          = Src;
-      ((PU_EMRPLGBLT)       record)->cSrc         = cSrc;
-      ((PU_EMRPLGBLT)       record)->xformSrc     = xformSrc;
-      ((PU_EMRPLGBLT)       record)->crBkColorSrc = crBkColorSrc;
-      ((PU_EMRPLGBLT)       record)->iUsageSrc    = iUsageSrc;
-      ((PU_EMRPLGBLT)       record)->Mask         = Mask;
-      ((PU_EMRPLGBLT)       record)->iUsageMask   = iUsageMask;
-      off = sizeof(U_EMRPLGBLT);
-      APPEND_PXBMISRC(record, U_EMRPLGBLT, cbBmi, Bmi, Px, cbImage, cbImage4);
-      APPEND_MSKBMISRC(record, U_EMRPLGBLT, cbMskBmi, MskBmi, Msk, cbMskImage, cbMskImage4);
-   }
-   return(record);
+    U_EMR_STROKEANDFILLPATH closes the open figure before filling and stroking.
+    There appears to be no way to fill an open path while stroking it, as any one
+    of U_EMRFILLPATH, U_EMRSTROKEPATH, or U_EMRSTROKEANDFILEPATH will "use up" the path,
+*/
+int U_EMRSTROKEANDFILLPATH_emplace(
+      EMFTRACK     *et,
+      const U_RECTL rclBox
+   ){
+   return(U_EMR_CORE4_set(et, U_EMR_STROKEANDFILLPATH,rclBox) ? 0 : 1);
 }
 
-// U_EMRSETDIBITSTODEVICE_set         80
 /**
-    \brief Allocate and construct a U_EMR_SETDIBITSTODEVICE record.
-    \return pointer to U_EMR_SETDIBITSTODEVICE record, or NULL on error.
-    \param rclBounds  Bounding rectangle in device units
-    \param Dest       Destination UL corner in logical units
-    \param Src        Source UL corner in logical units
-    \param cSrc       Source W & H in logical units
-    \param iUsageSrc  DIBColors Enumeration
-    \param iStartScan First scan line
-    \param cScans     Number of scan lines
-    \param Bmi        (Optional) bitmapbuffer (U_BITMAPINFO section)
-    \param cbPx       Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-    \param Px         (Optional) bitmapbuffer (pixel array section )
+    \brief Construct a U_EMR_STROKEPATH record directly at the end of an EMF in memory.
+    Same as U_EMRSTROKEPATH_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param rclBox Bounding rectangle in device units
+
+    U_EMR_STROKEPATH does NOT close the open figure before stroking it.
 */
-char *U_EMRSETDIBITSTODEVICE_set(
-      const U_RECTL        rclBounds,
-      const U_POINTL       Dest,
-      const U_POINTL       Src,
-      const U_POINTL       cSrc,
-      const uint32_t       iUsageSrc,
-      const uint32_t       iStartScan,
-      const uint32_t       cScans,
-      const PU_BITMAPINFO  Bmi,
-      const uint32_t       cbPx,
-      char                *Px
+int U_EMRSTROKEPATH_emplace(
+      EMFTRACK     *et,
+      const U_RECTL rclBox
    ){
-   char *record;
-   int   irecsize;
-   int   cbImage,cbImage4,cbBmi,off;
-
-   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
-  
-   irecsize = sizeof(U_EMRSETDIBITSTODEVICE) + cbBmi + cbImage4;
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)                       record)->iType      = U_EMR_SETDIBITSTODEVICE;
-      ((PU_EMR)                       record)->nSize      = irecsize;
-      ((PU_EMRSETDIBITSTODEVICE)      record)->rclBounds  = rclBounds;
-      ((PU_EMRSETDIBITSTODEVICE)      record)->Dest       = Dest;
-      ((PU_EMRSETDIBITSTODEVICE)      record)->Src        = Src;
-      ((PU_EMRSETDIBITSTODEVICE)      record)->cSrc       = cSrc;
-      ((PU_EMRSETDIBITSTODEVICE)      record)->iUsageSrc  = iUsageSrc;
-      ((PU_EMRSETDIBITSTODEVICE)      record)->iStartScan = iStartScan;
-      ((PU_EMRSETDIBITSTODEVICE)      record)->cScans     = cScans;
-      off = sizeof(U_EMRSETDIBITSTODEVICE);
-      APPEND_PXBMISRC(record, U_EMRSETDIBITSTODEVICE, cbBmi, Bmi, Px, cbImage, cbImage4);
-   }
-   return(record);
+   return(U_EMR_CORE4_set(et, U_EMR_STROKEPATH,rclBox) ? 0 : 1);
 }
 
-// U_EMRSTRETCHDIBITS_set             81
 /**
-    \brief Allocate and construct a U_EMR_EMRSTRETCHDIBITS record.
-    \return pointer to U_EMR_EMRSTRETCHDIBITS record, or NULL on error.
-    \param rclBounds Bounding rectangle in device units
-    \param Dest      Destination UL corner in logical units
-    \param cDest     Destination W & H in logical units
-    \param Src       Source UL corner in logical units
-    \param cSrc      Source W & H in logical units
-    \param iUsageSrc DIBColors Enumeration
-    \param dwRop     RasterOPeration Enumeration
-    \param Bmi       (Optional) bitmapbuffer (U_BITMAPINFO section)
-    \param cbPx      Size in bytes of pixel array (row STRIDE * height, there may be some padding at the end of each row)
-    \param Px        (Optional) bitmapbuffer (pixel array section )
+    \brief Construct a U_EMR_FLATTENPATH record directly at the end of an EMF in memory.
+    Same as U_EMRFLATTENPATH_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
 */
-char *U_EMRSTRETCHDIBITS_set(
-      const U_RECTL        rclBounds,
-      const U_POINTL       Dest,
-      const U_POINTL       cDest,
-      const U_POINTL       Src,
-      const U_POINTL       cSrc,
-      const uint32_t       iUsageSrc,
-      const uint32_t       dwRop,
-      const PU_BITMAPINFO  Bmi,
-      const uint32_t       cbPx,
-      char                *Px
-   ){
-   char *record;
-   int   irecsize;
-   int   cbImage,cbImage4,cbBmi,off;
+int U_EMRFLATTENPATH_emplace(EMFTRACK *et){
+   return(U_EMR_CORE5_set(et, U_EMR_FLATTENPATH) ? 0 : 1);
+}
 
-   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
-   
-   irecsize = sizeof(U_EMRSTRETCHDIBITS) + cbBmi + cbImage4;
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)                    record)->iType      = U_EMR_STRETCHDIBITS;
-      ((PU_EMR)                    record)->nSize      = irecsize;
-      ((PU_EMRSTRETCHDIBITS)       record)->rclBounds  = rclBounds;
-      ((PU_EMRSTRETCHDIBITS)       record)->Dest       = Dest;
-      ((PU_EMRSTRETCHDIBITS)       record)->Src        = Src;
-      ((PU_EMRSTRETCHDIBITS)       record)->cSrc       = cSrc;
-      ((PU_EMRSTRETCHDIBITS)       record)->iUsageSrc  = iUsageSrc;
-      ((PU_EMRSTRETCHDIBITS)       record)->dwRop      = dwRop;
-      ((PU_EMRSTRETCHDIBITS)       record)->cDest      = cDest;
-      off = sizeof(U_EMRSTRETCHDIBITS);
-      APPEND_PXBMISRC(record, U_EMRSTRETCHDIBITS, cbBmi, Bmi, Px, cbImage, cbImage4);
-   }
-   return(record);
+/**
+    \brief Construct a U_EMR_WIDENPATH record directly at the end of an EMF in memory.
+    Same as U_EMRWIDENPATH_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+*/
+int U_EMRWIDENPATH_emplace(EMFTRACK *et){
+   return(U_EMR_CORE5_set(et, U_EMR_WIDENPATH) ? 0 : 1);
 }
 
-// U_EMREXTCREATEFONTINDIRECTW_set    82
 /**
-    \brief Allocate and construct a U_EMR_EXTCREATEFONTINDIRECTW record.
-    Use extcreatefontindirectw_set() instead of calling this function directly.
-    \return pointer to U_EMR_EXTCREATEFONTINDIRECTW record, or NULL on error.
-    \param ihFont Index of the font in the EMF object table
-    \param elf    Font parameters as U_LOGFONT
-    \param elfw   Font parameters as U_LOGFONT_PANOSE
+    \brief Construct a U_EMR_SELECTCLIPPATH record directly at the end of an EMF in memory.
+    Same as U_EMRSELECTCLIPPATH_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param iMode RegionMode Enumeration
 */
-char *U_EMREXTCREATEFONTINDIRECTW_set(
-      const uint32_t               ihFont,
-      const char *                 elf,
-      const char *                 elfw
+int U_EMRSELECTCLIPPATH_emplace(
+      EMFTRACK      *et,
+      const uint32_t iMode
    ){
-   char *record;
-   const char *cptr;
-   int   irecsize;
-   int   cbLf,off;
+   return(U_EMR_CORE3_set(et, U_EMR_SELECTCLIPPATH, iMode) ? 0 : 1);
+}
 
-   if((elf && elfw) || (!elf && !elfw))return(NULL);  // ONE only must be passed
-   if(elf){ cbLf = sizeof(U_LOGFONT);        cptr = elf;  }
-   else {   cbLf = sizeof(U_LOGFONT_PANOSE); cptr = elfw; }
+/**
+    \brief Construct a U_EMR_ABORTPATH record directly at the end of an EMF in memory.
+    Same as U_EMRABORTPATH_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+*/
+int U_EMRABORTPATH_emplace(EMFTRACK *et){
+   return(U_EMR_CORE5_set(et, U_EMR_ABORTPATH) ? 0 : 1);
+}
 
-   irecsize = sizeof(U_EMR) + sizeof(uint32_t) + cbLf;
-   record    = malloc(irecsize);
-   if(record){
-      ((PU_EMR)                       record)->iType  = U_EMR_EXTCREATEFONTINDIRECTW;
-      ((PU_EMR)                       record)->nSize  = irecsize;
-      ((PU_EMREXTCREATEFONTINDIRECTW) record)->ihFont = ihFont;
-      off = sizeof(U_EMR) + sizeof(uint32_t);
-      memcpy(record + off, cptr, cbLf);    // No need to add padding for either structure
-   }
-   return(record);
+/**
+    \brief Construct a U_EMR_INVERTRGN record directly at the end of an EMF in memory.
+    Same as U_EMRINVERTRGN_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param RgnData Variable size U_RGNDATA structure
+*/
+int U_EMRINVERTRGN_emplace(
+      EMFTRACK        *et,
+      const PU_RGNDATA RgnData
+   ){
+   return(U_EMR_CORE11_set(et, U_EMR_INVERTRGN, RgnData) ? 0 : 1);
 }
 
-// U_EMREXTTEXTOUTA_set               83
 /**
-    \brief Allocate and construct a U_EMR_EXTTEXTOUTA record.
-    \return pointer to U_EMR_EXTTEXTOUTA record, or NULL on error.
+    \brief Construct a U_EMR_PAINTRGN record directly at the end of an EMF in memory.
+    Same as U_EMRPAINTRGN_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param RgnData Variable size U_RGNDATA structure
+*/
+int U_EMRPAINTRGN_emplace(
+      EMFTRACK        *et,
+      const PU_RGNDATA RgnData
+   ){
+   return(U_EMR_CORE11_set(et, U_EMR_PAINTRGN, RgnData) ? 0 : 1);
+}
+
+/**
+    \brief Construct a U_EMR_EXTTEXTOUTA record directly at the end of an EMF in memory.
+    Same as U_EMREXTTEXTOUTA_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds     Bounding rectangle in device units
     \param iGraphicsMode Graphics mode Enumeration
     \param exScale       scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
     \param eyScale       scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
     \param emrtext       Text parameters
 */
-char *U_EMREXTTEXTOUTA_set(
+int U_EMREXTTEXTOUTA_emplace(
+      EMFTRACK         *et,
       const U_RECTL     rclBounds,
       const uint32_t    iGraphicsMode,
       const U_FLOAT     exScale,
       const U_FLOAT     eyScale,
       const PU_EMRTEXT  emrtext
    ){
-   return(U_EMR_CORE8_set(U_EMR_EXTTEXTOUTA,rclBounds, iGraphicsMode, exScale, eyScale,emrtext));
+   return(U_EMR_CORE8_set(et, U_EMR_EXTTEXTOUTA,rclBounds, iGraphicsMode, exScale, eyScale,emrtext) ? 0 : 1);
 }
 
-// U_EMREXTTEXTOUTW_set               84
 /**
-    \brief Allocate and construct a U_EMR_EXTTEXTOUTW record.
-    \return pointer to U_EMR_EXTTEXTOUTW record, or NULL on error.
+    \brief Construct a U_EMR_EXTTEXTOUTW record directly at the end of an EMF in memory.
+    Same as U_EMREXTTEXTOUTW_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds     Bounding rectangle in device units
     \param iGraphicsMode Graphics mode Enumeration
     \param exScale       scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
     \param eyScale       scale to 0.01 mm units ( only if iGraphicsMode & GM_COMPATIBLE)
     \param emrtext       Text parameters
 */
-char *U_EMREXTTEXTOUTW_set(
+int U_EMREXTTEXTOUTW_emplace(
+      EMFTRACK        *et,
       const U_RECTL    rclBounds,
       const uint32_t   iGraphicsMode,
       const U_FLOAT    exScale,
       const U_FLOAT    eyScale,
       const PU_EMRTEXT emrtext
    ){
-   return(U_EMR_CORE8_set(U_EMR_EXTTEXTOUTW,rclBounds, iGraphicsMode, exScale, eyScale,emrtext));
+   return(U_EMR_CORE8_set(et, U_EMR_EXTTEXTOUTW,rclBounds, iGraphicsMode, exScale, eyScale,emrtext) ? 0 : 1);
 }
 
-// U_EMRPOLYBEZIER16_set              85
 /**
-    \brief Allocate and construct a U_EMR_POLYBEZIER16 record.
-    \return pointer to U_EMR_POLYBEZIER16 record, or NULL on error.
+    \brief Construct a U_EMR_POLYBEZIER16 record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYBEZIER16_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds Bounding rectangle in device units
     \param cpts      Number of POINT16 in array
     \param points    Array of POINT16
 */
-char *U_EMRPOLYBEZIER16_set(
+int U_EMRPOLYBEZIER16_emplace(
+      EMFTRACK        *et,
       const U_RECTL    rclBounds,
       const uint32_t   cpts,
       const U_POINT16 *points
    ){
-   return(U_EMR_CORE6_set(U_EMR_POLYBEZIER16, rclBounds, cpts, points));
-} 
+   return(U_EMR_CORE6_set(et, U_EMR_POLYBEZIER16, rclBounds, cpts, points) ? 0 : 1);
+}
 
-// U_EMRPOLYGON16_set                 86
 /**
-    \brief Allocate and construct a U_EMR_POLYGON16 record.
-    \return pointer to U_EMR_POLYGON16 record, or NULL on error.
+    \brief Construct a U_EMR_POLYGON16 record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYGON16_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds Bounding rectangle in device units
     \param cpts      Number of POINT16 in array
     \param points    Array of POINT16
 */
-char *U_EMRPOLYGON16_set(
+int U_EMRPOLYGON16_emplace(
+      EMFTRACK        *et,
       const U_RECTL    rclBounds,
       const uint32_t   cpts,
       const U_POINT16 *points
    ){
-   return(U_EMR_CORE6_set(U_EMR_POLYGON16, rclBounds, cpts, points));
-} 
+   return(U_EMR_CORE6_set(et, U_EMR_POLYGON16, rclBounds, cpts, points) ? 0 : 1);
+}
 
-// U_EMRPOLYLINE16_set                87
 /**
-    \brief Allocate and construct a U_EMR_POLYLINE16 record.
-    \return pointer to U_EMR_POLYLINE16 record, or NULL on error.
+    \brief Construct a U_EMR_POLYLINE16 record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYLINE16_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds Bounding rectangle in device units
     \param cpts      Number of POINT16 in array
     \param points    Array of POINT16
 */
-char *U_EMRPOLYLINE16_set(
+int U_EMRPOLYLINE16_emplace(
+      EMFTRACK        *et,
       const U_RECTL    rclBounds,
       const uint32_t   cpts,
       const U_POINT16 *points
    ){
-   return(U_EMR_CORE6_set(U_EMR_POLYLINE16, rclBounds, cpts, points));
-} 
+   return(U_EMR_CORE6_set(et, U_EMR_POLYLINE16, rclBounds, cpts, points) ? 0 : 1);
+}
 
-// U_EMRPOLYBEZIERTO16_set            88
 /**
-    \brief Allocate and construct a U_EMR_POLYBEZIERTO record.
-    \return pointer to U_EMR_POLYBEZIERTO record, or NULL on error.
+    \brief Construct a U_EMR_POLYBEZIERTO record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYBEZIERTO16_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds Bounding rectangle in device units
     \param cpts      Number of POINT16 in array
     \param points    Array of POINT16
 */
-char *U_EMRPOLYBEZIERTO16_set(
+int U_EMRPOLYBEZIERTO16_emplace(
+      EMFTRACK        *et,
       const U_RECTL    rclBounds,
       const uint32_t   cpts,
       const U_POINT16 *points
    ){
-   return(U_EMR_CORE6_set(U_EMR_POLYBEZIERTO16, rclBounds, cpts, points));
-} 
+   return(U_EMR_CORE6_set(et, U_EMR_POLYBEZIERTO16, rclBounds, cpts, points) ? 0 : 1);
+}
 
-// U_EMRPOLYLINETO16_set              89
 /**
-    \brief Allocate and construct a U_EMR_POLYLINETO record.
-    \return pointer to U_EMR_POLYLINETO record, or NULL on error.
+    \brief Construct a U_EMR_POLYLINETO record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYLINETO16_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds Bounding rectangle in device units
     \param cpts      Number of POINT16 in array
     \param points    Array of POINT16
 */
-char *U_EMRPOLYLINETO16_set(
+int U_EMRPOLYLINETO16_emplace(
+      EMFTRACK        *et,
       const U_RECTL    rclBounds,
       const uint32_t   cpts,
       const U_POINT16 *points
    ){
-   return(U_EMR_CORE6_set(U_EMR_POLYLINETO16, rclBounds, cpts, points));
-} 
+   return(U_EMR_CORE6_set(et, U_EMR_POLYLINETO16, rclBounds, cpts, points) ? 0 : 1);
+}
 
-// U_EMRPOLYPOLYLINE16_set            90
 /**
-    \brief Allocate and construct a U_EMR_POLYPOLYLINE16 record.
-    \return pointer to U_EMR_POLYPOLYLINE16 record, or NULL on error.
+    \brief Construct a U_EMR_POLYPOLYLINE16 record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYPOLYLINE16_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds   Bounding rectangle in device units
     \param nPolys      Number of elements in aPolyCounts
     \param aPolyCounts Number of points in each poly (sequential)
     \param cpts        Number of POINT16 in array
     \param points      Array of POINT16
 */
-char *U_EMRPOLYPOLYLINE16_set(
+int U_EMRPOLYPOLYLINE16_emplace(
+      EMFTRACK        *et,
       const U_RECTL    rclBounds,
       const uint32_t   nPolys,
       const uint32_t  *aPolyCounts,
       const uint32_t   cpts,
       const U_POINT16 *points
    ){
-   return(U_EMR_CORE10_set(U_EMR_POLYPOLYLINE16, rclBounds, nPolys, aPolyCounts,cpts, points));
+   return(U_EMR_CORE10_set(et, U_EMR_POLYPOLYLINE16, rclBounds, nPolys, aPolyCounts,cpts, points) ? 0 : 1);
 }
 
-// U_EMRPOLYPOLYGON16_set             91
 /**
-    \brief Allocate and construct a U_EMR_POLYPOLYGON16 record.
-    \return pointer to U_EMR_POLYPOLYGON16 record, or NULL on error.
+    \brief Construct a U_EMR_POLYPOLYGON16 record directly at the end of an EMF in memory.
+    Same as U_EMRPOLYPOLYGON16_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds   Bounding rectangle in device units
     \param nPolys      Number of elements in aPolyCounts
     \param aPolyCounts Number of points in each poly (sequential)
     \param cpts        Number of POINT16 in array
     \param points      Array of POINT16
 */
-char *U_EMRPOLYPOLYGON16_set(
+int U_EMRPOLYPOLYGON16_emplace(
+      EMFTRACK        *et,
       const U_RECTL    rclBounds,
       const uint32_t   nPolys,
       const uint32_t  *aPolyCounts,
       const uint32_t   cpts,
       const U_POINT16 *points
    ){
-   return(U_EMR_CORE10_set(U_EMR_POLYPOLYGON16, rclBounds, nPolys, aPolyCounts,cpts, points));
+   return(U_EMR_CORE10_set(et, U_EMR_POLYPOLYGON16, rclBounds, nPolys, aPolyCounts,cpts, points) ? 0 : 1);
 }
 
-
-// U_EMRPOLYDRAW16_set                92
-/**
-    \brief Allocate and construct a U_EMR_POLYDRAW16 record.
-    \return pointer to U_EMR_POLYDRAW16 record, or NULL on error.
-    \param rclBounds Bounding rectangle in device units 
-    \param cpts      Number of U_POINTL objects         
-    \param aptl      Array of U_POINTL objects          
-    \param abTypes   Array of Point Enumeration         
-*/
-char *U_EMRPOLYDRAW16_set(
-     const U_RECTL        rclBounds,
-     const U_NUM_POINT16  cpts,
-     const U_POINT16     *aptl,
-     const uint8_t       *abTypes
-   ){
-   char *record;
-   int  irecsize;
-   int  cbPoints, cbAbTypes, cbAbTypes4, off;
-
-   if(!cpts || !aptl || !abTypes)return(NULL);
-   cbPoints    = cpts * sizeof(U_POINT16);  // space for aptl
-   cbAbTypes    = cpts;                     // number of abTypes (same array size, 1 byte each)
-   cbAbTypes4    = UP4(cbAbTypes);          // space for abTypes
-   irecsize = sizeof(U_EMRPOLYDRAW16) + cbPoints + cbAbTypes4 - sizeof(U_POINT16) - 1;
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)           record)->iType      = U_EMR_POLYDRAW16; 
-      ((PU_EMR)           record)->nSize      = irecsize;         
-      ((PU_EMRPOLYDRAW16) record)->rclBounds  = rclBounds;        
-      ((PU_EMRPOLYDRAW16) record)->cpts       = cpts;             
-      off = sizeof(U_EMR) + sizeof(U_RECTL) + sizeof(uint32_t);  // offset to first variable part
-      memcpy(record+off,aptl,cbPoints);
-      off += cbPoints;
-      memcpy(record+off,abTypes,cbAbTypes);
-      off += cbAbTypes;
-      if(cbAbTypes4 > cbAbTypes){ memset(record+off,0,cbAbTypes4-cbAbTypes); } // keeps valgrind happy (initialize padding after byte array)
-   }
-   return(record);
-}  
-
-// U_EMRCREATEMONOBRUSH_set           93
 /**
-    \brief Allocate and construct a U_EMR_CREATEMONOBRUSH record.
-    \return pointer to U_EMR_CREATEMONOBRUSH record, or NULL on error.
+    \brief Construct a U_EMR_CREATEMONOBRUSH record directly at the end of an EMF in memory.
+    Same as U_EMRCREATEMONOBRUSH_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param ihBrush Index to place object in EMF object table (this entry must not yet exist) 
     \param iUsage  DIBcolors Enumeration                                                     
     \param Bmi     (Optional) bitmapbuffer (U_BITMAPINFO + pixel array)                      
     \param cbPx    Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
     \param Px      (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRCREATEMONOBRUSH_set(
+int U_EMRCREATEMONOBRUSH_emplace(
+      EMFTRACK                 *et,
       const uint32_t            ihBrush,
       const uint32_t            iUsage,
       const PU_BITMAPINFO       Bmi,
       const uint32_t            cbPx,
       const char               *Px
    ){
-   return(U_EMR_CORE12_set(U_EMR_CREATEMONOBRUSH,ihBrush,iUsage,Bmi,cbPx,Px));
+   return(U_EMR_CORE12_set(et, U_EMR_CREATEMONOBRUSH,ihBrush,iUsage,Bmi,cbPx,Px) ? 0 : 1);
 }
 
-// U_EMRCREATEDIBPATTERNBRUSHPT_set   94
 /**
-    \brief Allocate and construct a U_EMR_CREATEDIBPATTERNBRUSHPT record.
+    \brief Construct a U_EMR_CREATEDIBPATTERNBRUSHPT record directly at the end of an EMF in memory.
+    Same as U_EMRCREATEDIBPATTERNBRUSHPT_set() followed by emf_append(), without the malloc(), memcpy(), and free().
     Use createdibpatternbrushpt_set() instead of calling this function directly.
-    \return pointer to U_EMR_CREATEDIBPATTERNBRUSHPT record, or NULL on error.
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param ihBrush Index to place object in EMF object table (this entry must not yet exist)
     \param iUsage  DIBcolors Enumeration
     \param Bmi     (Optional) bitmapbuffer (U_BITMAPINFO + pixel array)
     \param cbPx    Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
     \param Px      (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRCREATEDIBPATTERNBRUSHPT_set(
-      const uint32_t            ihBrush,
-      const uint32_t            iUsage,
-      const PU_BITMAPINFO       Bmi,
-      const uint32_t            cbPx,
-      const char               *Px
-   ){
-    return(U_EMR_CORE12_set(U_EMR_CREATEDIBPATTERNBRUSHPT,ihBrush,iUsage,Bmi,cbPx,Px));
-}
-
-
-// U_EMREXTCREATEPEN_set              95
-/**
-    \brief Allocate and construct a U_EMR_EXTCREATEPEN record.
-    Use extcreatepen_set() instead of calling this function directly.
-    \return pointer to U_EMR_EXTCREATEPEN record, or NULL on error.
-    \param ihPen ihPen Index to place object in EMF object table (this entry must not yet exist)
-    \param Bmi   Bmi   bitmapbuffer
-    \param cbPx  cbPx  Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
-    \param Px    Px    pixel array (NULL if cbPx == 0)
-    \param elp   elp   Pen parameters (Size is Variable!!!!)
-*/
-char *U_EMREXTCREATEPEN_set(
-      const uint32_t      ihPen,
-      const PU_BITMAPINFO Bmi,
-      const uint32_t      cbPx,
-      char               *Px,
-      const PU_EXTLOGPEN  elp
-   ){
-   char *record;
-   int   cbImage,cbImage4,cbBmi,off;
-   int   irecsize,cbStyleArray,cbElp;
-   
-   if(!elp)return(NULL);
-
-   SET_CB_FROM_PXBMI(Px,Bmi,cbImage,cbImage4,cbBmi,cbPx);
-
-   cbStyleArray   = elp->elpNumEntries * sizeof(U_STYLEENTRY);                         // space actually used by penstyle entries
-   // EXTLOGPEN is already included in EMREXTCREATEPEN, including the possibly unused first penstyle entry
-   if(cbStyleArray){
-      cbElp   = sizeof(U_EXTLOGPEN) + cbStyleArray - sizeof(U_STYLEENTRY);  // space actually used by elp
-      irecsize = sizeof(U_EMREXTCREATEPEN) + cbBmi + cbImage4 + cbStyleArray - sizeof(U_STYLEENTRY);
-   }
-   else {
-      cbElp   = sizeof(U_EXTLOGPEN);                                  //    first U_STYLEENTRY is present but unused
-      irecsize = sizeof(U_EMREXTCREATEPEN) + cbBmi + cbImage4;
-   }
-   record   = malloc(irecsize);
-
-   if(record){
-      ((PU_EMR)                 record)->iType      = U_EMR_EXTCREATEPEN;
-      ((PU_EMR)                 record)->nSize      = irecsize;
-      ((PU_EMREXTCREATEPEN)     record)->ihPen      = ihPen;
-      memcpy(&(((PU_EMREXTCREATEPEN) record)->elp),elp,cbElp);
-      if(cbStyleArray){
-         off = sizeof(U_EMREXTCREATEPEN) + cbStyleArray - sizeof(U_STYLEENTRY);
-      }
-      else {
-         off = sizeof(U_EMREXTCREATEPEN);
-      }
-      // Cannot use APPEND_PXBMISRC here because there is no "Src" in the field names 
-      if(cbBmi){
-         memcpy(record + off, Bmi, cbBmi);
-         ((PU_EMREXTCREATEPEN) record)->offBmi     = off;
-         ((PU_EMREXTCREATEPEN) record)->cbBmi      = cbBmi;
-         off += cbBmi; 
-         memcpy(record + off, Px, cbImage);
-         ((PU_EMREXTCREATEPEN) record)->offBits    = off;
-         ((PU_EMREXTCREATEPEN) record)->cbBits     = cbImage;
-         off += cbImage;
-         if(cbImage4 - cbImage){  memset(record + off, 0, cbImage4 - cbImage); }
-      }
-      else {
-         ((PU_EMREXTCREATEPEN) record)->cbBmi      = 0;
-         ((PU_EMREXTCREATEPEN) record)->offBmi     = 0;
-         ((PU_EMREXTCREATEPEN) record)->cbBits     = 0;
-         ((PU_EMREXTCREATEPEN) record)->offBits    = 0;
-      }
-   }
-   return(record);
-}
-
-// U_EMRPOLYTEXTOUTA_set              96 NOT IMPLEMENTED, denigrated after Windows NT
-// U_EMRPOLYTEXTOUTW_set              97 NOT IMPLEMENTED, denigrated after Windows NT
-
-// U_EMRSETICMMODE_set                98
-/**
-    \brief Allocate and construct a U_EMR_SETICMMODE record.
-    \return pointer to U_EMR_SETICMMODE record, or NULL on error.
-    \param iMode ICMMode Enumeration
-*/
-char *U_EMRSETICMMODE_set(
-      const uint32_t iMode
-   ){ 
-   return(U_EMR_CORE3_set(U_EMR_SETICMMODE, iMode));
+int U_EMRCREATEDIBPATTERNBRUSHPT_emplace(
+      EMFTRACK                 *et,
+      const uint32_t            ihBrush,
+      const uint32_t            iUsage,
+      const PU_BITMAPINFO       Bmi,
+      const uint32_t            cbPx,
+      const char               *Px
+   ){
+    return(U_EMR_CORE12_set(et, U_EMR_CREATEDIBPATTERNBRUSHPT,ihBrush,iUsage,Bmi,cbPx,Px) ? 0 : 1);
 }
 
-// U_EMRCREATECOLORSPACE_set          99
 /**
-    \brief Allocate and construct a U_EMR_CREATECOLORSPACE record.
-    Use createcolorspace_set() instead of calling this function directly.
-    \return pointer to U_EMR_CREATECOLORSPACE record, or NULL on error.
-    \param ihCS Index to place object in EMF object table (this entry must not yet exist)
-    \param lcs  ColorSpace parameters
+    \brief Construct a U_EMR_SETICMMODE record directly at the end of an EMF in memory.
+    Same as U_EMRSETICMMODE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
+    \param iMode ICMMode Enumeration
 */
-char *U_EMRCREATECOLORSPACE_set(
-      const uint32_t            ihCS,
-      const U_LOGCOLORSPACEA    lcs
+int U_EMRSETICMMODE_emplace(
+      EMFTRACK      *et,
+      const uint32_t iMode
    ){
-   char *record;
-   int   irecsize;
-
-   irecsize = sizeof(U_EMRCREATECOLORSPACE);
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)                 record)->iType = U_EMR_CREATECOLORSPACE;
-      ((PU_EMR)                 record)->nSize = irecsize;
-      ((PU_EMRCREATECOLORSPACE) record)->ihCS  = ihCS;
-      ((PU_EMRCREATECOLORSPACE) record)->lcs   = lcs;
-   }
-   return(record);
-} 
+   return(U_EMR_CORE3_set(et, U_EMR_SETICMMODE, iMode) ? 0 : 1);
+}
 
-// U_EMRSETCOLORSPACE_set            100
 /**
-    \brief Allocate and construct a U_EMR_SETCOLORSPACE record.
-    \return pointer to U_EMR_SETCOLORSPACE record, or NULL on error.
+    \brief Construct a U_EMR_SETCOLORSPACE record directly at the end of an EMF in memory.
+    Same as U_EMRSETCOLORSPACE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param ihCS Index of object in EMF object table
 */
-char *U_EMRSETCOLORSPACE_set(
+int U_EMRSETCOLORSPACE_emplace(
+      EMFTRACK                  *et,
       const uint32_t             ihCS
    ){
-   return(U_EMR_CORE3_set(U_EMR_SETCOLORSPACE, ihCS));
+   return(U_EMR_CORE3_set(et, U_EMR_SETCOLORSPACE, ihCS) ? 0 : 1);
 }
 
-// U_EMRDELETECOLORSPACE_set         101
 /** 
-    \brief Allocate and construct a U_EMR_DELETECOLORSPACE record.
-    \return pointer to U_EMR_DELETECOLORSPACE record, or NULL on error.
+    \brief Construct a U_EMR_DELETECOLORSPACE record directly at the end of an EMF in memory.
+    Same as U_EMRDELETECOLORSPACE_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param ihCS Index of object in EMF object table
 */
-char *U_EMRDELETECOLORSPACE_set(
+int U_EMRDELETECOLORSPACE_emplace(
+      EMFTRACK                  *et,
       const uint32_t             ihCS
    ){
-   return(U_EMR_CORE3_set(U_EMR_DELETECOLORSPACE, ihCS));
+   return(U_EMR_CORE3_set(et, U_EMR_DELETECOLORSPACE, ihCS) ? 0 : 1);
 }
 
-// U_EMRGLSRECORD_set                102  Not implemented
-// U_EMRGLSBOUNDEDRECORD_set         103  Not implemented
-// U_EMRPIXELFORMAT_set              104
-/**
-    \brief Allocate and construct a U_EMR_PIXELFORMAT record.
-    \return pointer to U_EMR_PIXELFORMAT record, or NULL on error.
-    \param pfd PixelFormatDescriptor
-*/
-char *U_EMRPIXELFORMAT_set(
-      const U_PIXELFORMATDESCRIPTOR pfd
-   ){
-   char *record;
-   int   irecsize;
-
-   irecsize = sizeof(U_EMRPIXELFORMAT);
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)            record)->iType   = U_EMR_PIXELFORMAT;
-      ((PU_EMR)            record)->nSize   = irecsize;
-      ((PU_EMRPIXELFORMAT) record)->pfd     = pfd;
-   }
-   return(record);
-} 
-// U_EMRDRAWESCAPE_set               105  Not implemented
-// U_EMREXTESCAPE_set                106  Not implemented
-// U_EMRUNDEF107_set                 107  Not implemented
-
-// U_EMRSMALLTEXTOUT_set             108
-/**
-    \brief Allocate and construct a U_EMR_SMALLTEXTOUT record.
-    \return pointer to U_EMR_SMALLTEXTOUT record, or NULL on error.
-    \param Dest          Where to draw the text
-    \param cChars        Characters in TextString (not null terminated)
-    \param fuOptions     ExtTextOutOptions Enumeration
-    \param iGraphicsMode GraphicsMode Enumeration
-    \param exScale       scale on X axis
-    \param eyScale       scale on Y axis
-    \param rclBounds     OPTIONAL Bounding rectangle (absent when: fuOPtions & ETO_NO_U_RECT)
-    \param TextString    text to output (fuOptions & ETO_SMALL_CHARS ? 8 bit : 16 bit)
-*/
-char *U_EMRSMALLTEXTOUT_set(
-      const U_POINTL   Dest,
-      const U_NUM_STR  cChars,
-      const uint32_t   fuOptions,
-      const uint32_t   iGraphicsMode,
-      const U_FLOAT    exScale,
-      const U_FLOAT    eyScale,
-      const U_RECTL    rclBounds,
-      const char      *TextString
-   ){
-   char *record;
-   int   irecsize,cbString,cbString4,cbRectl,off;
-   int   csize;
-   
-   if( fuOptions & U_ETO_SMALL_CHARS ){  csize = 1; }         // how many bytes per character
-   else {                                csize = 2; }
-   cbString = csize * cChars;                                   // filled contents of the string buffer
-   cbString4 = UP4(cbString);                                      // size of the variable string buffer
-   if(fuOptions & U_ETO_NO_RECT){ cbRectl = 0;               } // size of the optional U_RECTL field
-   else {                         cbRectl = sizeof(U_RECTL); }
-   
-   irecsize = sizeof(U_EMRSMALLTEXTOUT) + cbString4 + cbRectl;
-   record    = malloc(irecsize);
-   if(record){
-      ((PU_EMR)             record)->iType         = U_EMR_SMALLTEXTOUT;
-      ((PU_EMR)             record)->nSize         = irecsize;
-      ((PU_EMRSMALLTEXTOUT) record)->Dest          = Dest;
-      ((PU_EMRSMALLTEXTOUT) record)->cChars        = cChars;
-      ((PU_EMRSMALLTEXTOUT) record)->fuOptions     = fuOptions;
-      ((PU_EMRSMALLTEXTOUT) record)->iGraphicsMode = iGraphicsMode;
-      ((PU_EMRSMALLTEXTOUT) record)->exScale       = exScale;
-      ((PU_EMRSMALLTEXTOUT) record)->eyScale       = eyScale;
-      off = sizeof(U_EMRSMALLTEXTOUT);  //offset to the start of the variable fields
-      if(cbRectl){
-         memcpy(record + off, &rclBounds, cbRectl);
-         off += cbRectl;
-      }
-      memcpy(record + off, TextString, cbString);
-      if(cbString < cbString4){
-         off += cbString;
-         memset(record + off, 0, cbString4 - cbString);
-      }
-   }
-   return(record);
-} 
-
-// U_EMRFORCEUFIMAPPING_set          109  Not implemented
-// U_EMRNAMEDESCAPE_set              110  Not implemented
-// U_EMRCOLORCORRECTPALETTE_set      111  Not implemented
-// U_EMRSETICMPROFILEA_set           112  Not implemented
-// U_EMRSETICMPROFILEW_set           113  Not implemented
-
-// U_EMRALPHABLEND_set               114
 /**
-    \brief Allocate and construct a U_EMR_ALPHABLEND record.
-    \return pointer to U_EMR_ALPHABLEND record, or NULL on error.
+    \brief Construct a U_EMR_ALPHABLEND record directly at the end of an EMF in memory.
+    Same as U_EMRALPHABLEND_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds    Bounding rectangle in device units
     \param Dest         Destination UL corner in logical units
     \param cDest        Destination width in logical units
@@ -5435,7 +9719,8 @@ char *U_EMRSMALLTEXTOUT_set(
     \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
     \param Px           (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRALPHABLEND_set(
+int U_EMRALPHABLEND_emplace(
+      EMFTRACK           *et,
       const U_RECTL       rclBounds,
       const U_POINTL      Dest,
       const U_POINTL      cDest,
@@ -5449,23 +9734,25 @@ char *U_EMRALPHABLEND_set(
       const uint32_t      cbPx,
       char               *Px
    ){
-   return(U_EMR_CORE13_set(U_EMR_ALPHABLEND,rclBounds,Dest,cDest,Src,cSrc,xformSrc,crBkColorSrc,iUsageSrc,*((uint32_t *) &Blend),Bmi,cbPx,Px));
+   return(U_EMR_CORE13_set(et, U_EMR_ALPHABLEND,rclBounds,Dest,cDest,Src,cSrc,xformSrc,crBkColorSrc,iUsageSrc,*((uint32_t *) &Blend),Bmi,cbPx,Px) ? 0 : 1);
 }
 
-// U_EMRSETLAYOUT_set                115
 /**
-    \brief Allocate and construct a U_EMR_SETLAYOUT record.
-    \return pointer to U_EMR_SETLAYOUT record, or NULL on error.
+    \brief Construct a U_EMR_SETLAYOUT record directly at the end of an EMF in memory.
+    Same as U_EMRSETLAYOUT_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param iMode Mirroring Enumeration
 */
-char *U_EMRSETLAYOUT_set(uint32_t iMode){
-  return(U_EMR_CORE3_set(U_EMR_SETLAYOUT, iMode));
+int U_EMRSETLAYOUT_emplace(EMFTRACK *et, uint32_t iMode){
+  return(U_EMR_CORE3_set(et, U_EMR_SETLAYOUT, iMode) ? 0 : 1);
 }
 
-// U_EMRTRANSPARENTBLT_set           116
 /**
-    \brief Allocate and construct a U_EMR_TRANSPARENTBLT record.
-    \return pointer to U_EMR_TRANSPARENTBLT record, or NULL on error.
+    \brief Construct a U_EMR_TRANSPARENTBLT record directly at the end of an EMF in memory.
+    Same as U_EMRTRANSPARENTBLT_set() followed by emf_append(), without the malloc(), memcpy(), and free().
+    \return 0 for success, >=1 for failure.
+    \param et          EMF in memory
     \param rclBounds    Bounding rectangle in device units
     \param Dest         Destination UL corner in logical units
     \param cDest        Destination width in logical units
@@ -5479,7 +9766,8 @@ char *U_EMRSETLAYOUT_set(uint32_t iMode){
     \param cbPx         Size in bytes of pixel array (row stride * height, there may be some padding at the end of each row)
     \param Px           (Optional) bitmapbuffer (pixel array section )
 */
-char *U_EMRTRANSPARENTBLT_set(
+int U_EMRTRANSPARENTBLT_emplace(
+      EMFTRACK           *et,
       const U_RECTL       rclBounds,
       const U_POINTL      Dest,
       const U_POINTL      cDest,
@@ -5493,113 +9781,9 @@ char *U_EMRTRANSPARENTBLT_set(
       const uint32_t      cbPx,
       char               *Px
    ){
-   return(U_EMR_CORE13_set(U_EMR_TRANSPARENTBLT,rclBounds,Dest,cDest,Src,cSrc,xformSrc,crBkColorSrc,iUsageSrc,TColor,Bmi,cbPx,Px));
-}
-// U_EMRUNDEF117_set                 117  Not implemented
-// U_EMRGRADIENTFILL_set             118
-/**
-    \brief Allocate and construct a U_EMR_TRANSPARENTBLT record.
-    \return pointer to U_EMR_TRANSPARENTBLT record, or NULL on error.
-    \param rclBounds    Bounding rectangle in device units
-    \param nTriVert     Number of TriVertex objects in TriVert
-    \param nGradObj     Number of gradient triangle/rectangle objects
-    \param ulMode       Gradientfill Enumeration (determines Triangle/Rectangle)
-    \param TriVert      Array of TriVertex objects
-    \param GradObj      Array of gradient objects (each has 2 [rect] or 3 [triangle] indices into TriVert array) 
-
-There is an MS documentation or library problem for this record, as the size of the GradObj must always be set
-as if it was an array of U_GRADIENT3 objects for both rect and triangle.  For horizontal and vertical gradients
-this means that there will be unused bytes at the end of the record.  This is not what the documentation says,
-but it is how MS's libraries work.
-
-*/
-char *U_EMRGRADIENTFILL_set(
-      const U_RECTL             rclBounds,
-      const U_NUM_TRIVERTEX     nTriVert,
-      const U_NUM_GRADOBJ       nGradObj,
-      const uint32_t            ulMode,
-      const PU_TRIVERTEX        TriVert,
-      const uint32_t           *GradObj
-   ){
-   char *record;
-   unsigned int   cbTriVert,cbGradObj,off;
-   unsigned int   cbGradObjAlloc; /* larger than cbGradObj, because of problem described above */
-   int   irecsize;
-
-   cbTriVert = sizeof(U_TRIVERTEX) * nTriVert;  // all of the cb's will be a multiple of 4 bytes
-   if(     ulMode == U_GRADIENT_FILL_TRIANGLE){ cbGradObj = sizeof(U_GRADIENT3) * nGradObj; }
-   else if(ulMode == U_GRADIENT_FILL_RECT_H || 
-           ulMode == U_GRADIENT_FILL_RECT_V){   cbGradObj = sizeof(U_GRADIENT4) * nGradObj; }
-   else {                                       return(NULL);                               }
-   cbGradObjAlloc = sizeof(U_GRADIENT3) * nGradObj; 
-
-   irecsize = sizeof(U_EMRGRADIENTFILL) + cbTriVert + cbGradObjAlloc;
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)             record)->iType      = U_EMR_GRADIENTFILL;
-      ((PU_EMR)             record)->nSize      = irecsize;
-      ((PU_EMRGRADIENTFILL) record)->rclBounds  = rclBounds;
-      ((PU_EMRGRADIENTFILL) record)->nTriVert   = nTriVert;
-      ((PU_EMRGRADIENTFILL) record)->nGradObj   = nGradObj;
-      ((PU_EMRGRADIENTFILL) record)->ulMode     = ulMode;
-      off = sizeof(U_EMRGRADIENTFILL); // offset to TriVert field
-      memcpy(record + off, TriVert, cbTriVert);
-      off += cbTriVert;
-      memcpy(record + off, GradObj, cbGradObj);
-      off += cbGradObj;
-      if(cbGradObjAlloc > cbGradObj){
-         memset(record+off,0,cbGradObjAlloc - cbGradObj);
-      }
-   }
-   return(record);
+   return(U_EMR_CORE13_set(et, U_EMR_TRANSPARENTBLT,rclBounds,Dest,cDest,Src,cSrc,xformSrc,crBkColorSrc,iUsageSrc,TColor,Bmi,cbPx,Px) ? 0 : 1);
 }
 
-// U_EMRSETLINKEDUFIS_set            119  Not implemented
-// U_EMRSETTEXTJUSTIFICATION_set     120  Not implemented (denigrated)
-// U_EMRCOLORMATCHTOTARGETW_set      121  Not implemented  
-
-// U_EMRCREATECOLORSPACEW_set        122
-/**
-    \brief Allocate and construct a U_EMR_CREATECOLORSPACEW record.
-    Use createcolorspacew_set() instead of calling this function directly.
-    \return pointer to U_EMR_CREATECOLORSPACEW record, or NULL on error.
-    \param ihCS     Index to place object in EMF object table (this entry must not yet exist)
-    \param lcs      ColorSpace parameters
-    \param dwFlags  If low bit set Data is present
-    \param cbData   Number of bytes of theData field.
-    \param Data     (Optional, dwFlags & 1) color profile data 
-*/
-char *U_EMRCREATECOLORSPACEW_set(
-      const uint32_t          ihCS,
-      const U_LOGCOLORSPACEW  lcs,
-      const uint32_t          dwFlags,
-      const U_CBDATA          cbData,
-      const uint8_t          *Data
-   ){
-   char *record;
-   unsigned int   cbData4,off;
-   int   irecsize;
-
-   cbData4 = UP4(cbData);                     // buffer to hold Data
-   irecsize = sizeof(U_EMRCREATECOLORSPACEW) + cbData4;
-   record   = malloc(irecsize);
-   if(record){
-      ((PU_EMR)                  record)->iType   = U_EMR_CREATECOLORSPACEW;
-      ((PU_EMR)                  record)->nSize   = irecsize;
-      ((PU_EMRCREATECOLORSPACEW) record)->ihCS    = ihCS;
-      ((PU_EMRCREATECOLORSPACEW) record)->lcs     = lcs;
-      ((PU_EMRCREATECOLORSPACEW) record)->dwFlags = dwFlags;
-      ((PU_EMRCREATECOLORSPACEW) record)->cbData  = cbData;
-      off = sizeof(U_EMR) + sizeof(uint32_t) + sizeof(U_LOGCOLORSPACEW) + sizeof(uint32_t) + sizeof(U_CBDATA); // offset to Data field
-      memcpy(record + off, Data, cbData);
-      if(cbData < cbData4){
-        off += cbData;
-        memset(record + off,0,cbData4-cbData);
-      }
-   }
-   return(record);
-} 
-
 
 #ifdef __cplusplus
 }
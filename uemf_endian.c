@@ -43,28 +43,146 @@ extern "C" {
    These functions convert standard objects used in the EMR records.
 *********************************************************************************************** */
 
+/*  Byte swapping kernels.
+    Most calls swap a few fields, and those use the scalar code.  Arrays of at least U_SWAP_VECTOR_MIN elements
+    (point lists, Dx arrays, EMF+ serial arrays, etc.) use a vector kernel picked at run time from those the
+    CPU supports.  Nothing is cached, so there is no shared state.  Data need not be aligned.
+*/
+#define U_SWAP_VECTOR_MIN  16
+
+#if defined(__GNUC__)
+#define U_BSWAP16(A) __builtin_bswap16(A)
+#define U_BSWAP32(A) __builtin_bswap32(A)
+#else
+#define U_BSWAP16(A) ((uint16_t)(((A) << 8) | ((A) >> 8)))
+#define U_BSWAP32(A) ((((A) & 0xFF) << 24) | (((A) & 0xFF00) << 8) | (((A) >> 8) & 0xFF00) | ((A) >> 24))
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define U_SWAP_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define U_SWAP_NEON 1
+#include <arm_neon.h>
+#endif
+
+static void U_swap2_scalar(uint8_t *cl, unsigned int count){
+   uint16_t  v;
+   for(; count; count--,cl+=2){
+      memcpy(&v, cl, 2);
+      v = U_BSWAP16(v);
+      memcpy(cl, &v, 2);
+   }
+}
+
+static void U_swap4_scalar(uint8_t *cl, unsigned int count){
+   uint32_t  v;
+   for(; count; count--,cl+=4){
+      memcpy(&v, cl, 4);
+      v = U_BSWAP32(v);
+      memcpy(cl, &v, 4);
+   }
+}
+
+#if U_SWAP_X86
+/* Each returns the number of elements it did NOT swap, the caller finishes those with the scalar code. */
+__attribute__((target("avx2"))) static unsigned int U_swap2_avx2(uint8_t *cl, unsigned int count){
+   const __m256i mask = _mm256_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14,1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+   for(; count >= 16; count -= 16, cl += 32){
+      _mm256_storeu_si256((__m256i *) cl, _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i *) cl), mask));
+   }
+   return(count);
+}
+
+__attribute__((target("avx2"))) static unsigned int U_swap4_avx2(uint8_t *cl, unsigned int count){
+   const __m256i mask = _mm256_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12,3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+   for(; count >= 8; count -= 8, cl += 32){
+      _mm256_storeu_si256((__m256i *) cl, _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i *) cl), mask));
+   }
+   return(count);
+}
+
+__attribute__((target("ssse3"))) static unsigned int U_swap2_ssse3(uint8_t *cl, unsigned int count){
+   const __m128i mask = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+   for(; count >= 8; count -= 8, cl += 16){
+      _mm_storeu_si128((__m128i *) cl, _mm_shuffle_epi8(_mm_loadu_si128((__m128i *) cl), mask));
+   }
+   return(count);
+}
+
+__attribute__((target("ssse3"))) static unsigned int U_swap4_ssse3(uint8_t *cl, unsigned int count){
+   const __m128i mask = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+   for(; count >= 4; count -= 4, cl += 16){
+      _mm_storeu_si128((__m128i *) cl, _mm_shuffle_epi8(_mm_loadu_si128((__m128i *) cl), mask));
+   }
+   return(count);
+}
+
+__attribute__((target("sse2"))) static unsigned int U_swap2_sse2(uint8_t *cl, unsigned int count){
+   __m128i v;
+   for(; count >= 8; count -= 8, cl += 16){
+      v = _mm_loadu_si128((__m128i *) cl);
+      _mm_storeu_si128((__m128i *) cl, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+   }
+   return(count);
+}
+
+__attribute__((target("sse2"))) static unsigned int U_swap4_sse2(uint8_t *cl, unsigned int count){
+   __m128i v;
+   for(; count >= 4; count -= 4, cl += 16){
+      v = _mm_loadu_si128((__m128i *) cl);
+      v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);  /* swap the 16 bit halves */
+      _mm_storeu_si128((__m128i *) cl, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+   }
+   return(count);
+}
+#endif /* U_SWAP_X86 */
+
+#if U_SWAP_NEON
+static unsigned int U_swap2_neon(uint8_t *cl, unsigned int count){
+   for(; count >= 8; count -= 8, cl += 16){ vst1q_u8(cl, vrev16q_u8(vld1q_u8(cl))); }
+   return(count);
+}
+
+static unsigned int U_swap4_neon(uint8_t *cl, unsigned int count){
+   for(; count >= 4; count -= 4, cl += 16){ vst1q_u8(cl, vrev32q_u8(vld1q_u8(cl))); }
+   return(count);
+}
+#endif /* U_SWAP_NEON */
+
 void U_swap2(void *ul, unsigned int count){
-   uint8_t   ctmp;
    uint8_t  *cl = (uint8_t *) ul;
-   for(; count; count--,cl+=2){
-      ctmp            = *cl;
-      *cl             = *(cl+1);
-      *(cl+1)         = ctmp;
+   if(count >= U_SWAP_VECTOR_MIN){
+      unsigned int left = count;
+#if U_SWAP_X86
+      if(     __builtin_cpu_supports("avx2")){  left = U_swap2_avx2(cl, count);  }
+      else if(__builtin_cpu_supports("ssse3")){ left = U_swap2_ssse3(cl, count); }
+      else if(__builtin_cpu_supports("sse2")){  left = U_swap2_sse2(cl, count);  }
+#elif U_SWAP_NEON
+      left = U_swap2_neon(cl, count);
+#endif
+      cl   += 2*(count - left);
+      count = left;
    }
+   U_swap2_scalar(cl, count);
 }
 
 /* Note: U_swap4 is also used by uwmf_endian.c, in cases where the 32 bit data is not aligned on a 4 byte boundary */
 void U_swap4(void *ul, unsigned int count){
-   uint8_t   ctmp;
    uint8_t  *cl = (uint8_t *) ul;
-   for(; count; count--,cl+=4){
-      ctmp    = *(cl+0);
-      *(cl+0) = *(cl+3);
-      *(cl+3) = ctmp;
-      ctmp    = *(cl+1);
-      *(cl+1) = *(cl+2);
-      *(cl+2) = ctmp;
+   if(count >= U_SWAP_VECTOR_MIN){
+      unsigned int left = count;
+#if U_SWAP_X86
+      if(     __builtin_cpu_supports("avx2")){  left = U_swap4_avx2(cl, count);  }
+      else if(__builtin_cpu_supports("ssse3")){ left = U_swap4_ssse3(cl, count); }
+      else if(__builtin_cpu_supports("sse2")){  left = U_swap4_sse2(cl, count);  }
+#elif U_SWAP_NEON
+      left = U_swap4_neon(cl, count);
+#endif
+      cl   += 4*(count - left);
+      count = left;
    }
+   U_swap4_scalar(cl, count);
 }
 
 /** 
@@ -22,6 +22,7 @@ extern "C" {
 #include <stddef.h> /* for offsetof() macro */
 #include <string.h>
 #include "uemf.h"
+#include "uemf_print.h"
 #include "upmf_print.h"
 #include "uemf_safe.h"
 
@@ -32,6 +33,9 @@ extern "C" {
 
 /* one needed prototype */
 void U_swap4(void *ul, unsigned int count);
+
+/* EMF+ parse state used by the non re-entrant U_emf_onerec_print() and U_EMRCOMMENT_print() */
+static U_PMF_PARSE_CTX U_emf_print_ctx={{NULL,0,0,0,0},0};
 //! \endcond
 
 /** 
@@ -1734,18 +1738,30 @@ void U_EMRABORTPATH_print(const char *contents){
 // U_EMRCOMMENT              70  Comment (any binary data, interpretation is program specific)
 /**
     \brief Print a pointer to a U_EMR_COMMENT record.
+    EMF+ state is kept in an internal U_PMF_PARSE_CTX, so this is not re-entrant, see U_EMRCOMMENT_print_r().
     \param contents   pointer to a location in memory holding the comment record
     \param off        offset in bytes to the first byte in this record (needed for EMF+ record printing)
 
     EMF+ records, if any, are stored in EMF comment records.
 */
 void U_EMRCOMMENT_print(const char *contents, size_t off){
+   U_EMRCOMMENT_print_r(&U_emf_print_ctx, contents, off);
+}
+
+/**
+    \brief Print a pointer to a U_EMR_COMMENT record, re-entrant version of U_EMRCOMMENT_print().
+    \param ctx        EMF+ parse state for this file, from U_PCTX_init()
+    \param contents   pointer to a location in memory holding the comment record
+    \param off        offset in bytes to the first byte in this record (needed for EMF+ record printing)
+
+    EMF+ records, if any, are stored in EMF comment records.
+*/
+void U_EMRCOMMENT_print_r(U_PMF_PARSE_CTX *ctx, const char *contents, size_t off){
    char *string;
    char *src;
    uint32_t cIdent,cIdent2,cbData;
    size_t loff;
    int    recsize;
-   static int recnum=0;
 
    PU_EMRCOMMENT pEmr = (PU_EMRCOMMENT)(contents);
    if(pEmr->emr.nSize < sizeof(U_EMRCOMMENT)){
@@ -1795,7 +1811,7 @@ void U_EMRCOMMENT_print(const char *contents, size_t off){
          src = (char *)&(pEmrpl->Data);
          loff = 16;  /* Header size of the header part of an EMF+ comment record */
          while(loff < cbData + 12){  // EMF+ records may not fill the entire comment, cbData value includes cIdent, but not U_EMR or cbData
-            recsize =  U_pmf_onerec_print(src, blimit, recnum, loff + off);
+            recsize =  U_pmf_onerec_print_r(ctx, src, blimit, ctx->recnum, loff + off);
             if(recsize==0){ break; }
             else if(recsize<0){
                printf("   record corruption HERE\n");
@@ -1803,7 +1819,7 @@ void U_EMRCOMMENT_print(const char *contents, size_t off){
             }
             loff += recsize;
             src  += recsize;
-            recnum++;
+            ctx->recnum++;
          }
          return;
       }
@@ -2526,6 +2542,8 @@ void U_EMRCREATECOLORSPACEW_print(const char *contents){
 
 /**
     \brief Print any record in an emf
+    EMF+ state is kept in an internal U_PMF_PARSE_CTX, so this is not re-entrant.  Use U_emf_onerec_print_r()
+    to print more than one file at a time.
     \returns record length for a normal record, 0 for EMREOF, -1 for a bad record
     \param contents   pointer to a buffer holding all EMR records
     \param blimit     pointer to the byte after the last byte in the buffer holding all EMR records
@@ -2533,6 +2551,19 @@ void U_EMRCREATECOLORSPACEW_print(const char *contents){
     \param off        offset to this record in contents
 */
 int U_emf_onerec_print(const char *contents, const char *blimit, int recnum, size_t off){
+   return(U_emf_onerec_print_r(&U_emf_print_ctx, contents, blimit, recnum, off));
+}
+
+/**
+    \brief Print any record in an emf, re-entrant version of U_emf_onerec_print().
+    \returns record length for a normal record, 0 for EMREOF, -1 for a bad record
+    \param ctx        EMF+ parse state for this file, from U_PCTX_init()
+    \param contents   pointer to a buffer holding all EMR records
+    \param blimit     pointer to the byte after the last byte in the buffer holding all EMR records
+    \param recnum     number of this record in contents
+    \param off        offset to this record in contents
+*/
+int U_emf_onerec_print_r(U_PMF_PARSE_CTX *ctx, const char *contents, const char *blimit, int recnum, size_t off){
     PU_ENHMETARECORD  lpEMFR  = (PU_ENHMETARECORD)(contents + off);
     uint32_t nSize;
     uint32_t iType;
@@ -2640,7 +2671,7 @@ int U_emf_onerec_print(const char *contents, const char *blimit, int recnum, siz
         case U_EMR_SELECTCLIPPATH:          U_EMRSELECTCLIPPATH_print(record);          break;
         case U_EMR_ABORTPATH:               U_EMRABORTPATH_print(record);               break;
         case U_EMR_UNDEF69:                 U_EMRUNDEF69_print(record);                 break;
-        case U_EMR_COMMENT:                 U_EMRCOMMENT_print(record, off);            break;
+        case U_EMR_COMMENT:                 U_EMRCOMMENT_print_r(ctx, record, off);     break;
         case U_EMR_FILLRGN:                 U_EMRFILLRGN_print(record);                 break;
         case U_EMR_FRAMERGN:                U_EMRFRAMERGN_print(record);                break;
         case U_EMR_INVERTRGN:               U_EMRINVERTRGN_print(record);               break;
@@ -30,8 +30,15 @@ extern "C" {
 #include <stdio.h>
 #include <string.h>
 #include <stddef.h> /* for offsetof() macro */
+#include <errno.h>
+#ifdef WIN32
+#include <io.h>       // for _read()
+#else
+#include <unistd.h>   // for read()
+#endif
 #include "uemf.h"
 #include "uemf_endian.h" // for u_emf_record_sizeok
+#include "uemf_safe.h"
 
 // hide almost everuything in here from Doxygen
 //! \cond
@@ -137,7 +144,8 @@ int DIB_safe(
    const char      *px      = NULL;     // DIB pixels
    const U_RGBQUAD *ct      = NULL;     // DIB color table
    int              bs;
-   int              usedbytes;
+   uint64_t         usedbytes;
+   uint64_t         bmbytes;
 
    if(!cbBmi)return(1);  // No DIB in a record where it is optional
    if(IS_MEM_UNSAFE(record, offBmi + cbBmi, blimit))return(0);
@@ -154,15 +162,21 @@ int DIB_safe(
        if(!numCt && colortype < U_BCBM_COLOR16)return(0);   //color tables mandatory for < 16 bit
  
        if(dibparams ==U_BI_RGB){  
-           // this is the only DIB type where we can calculate how big it should be when stored in the EMF file
+           // this is the only DIB type where we can calculate how big it should be when stored in the EMF file.
+           // Every row must be present, so that DIB_rows_from_record() and the like cannot read past the record,
+           // but the last one need not be padded.
            bs = colortype/8;
            if(bs<1){
-              usedbytes = (width*colortype + 7)/8;      // width of line in fully and partially occupied bytes
+              usedbytes = ((uint64_t) width*colortype + 7)/8;      // width of line in fully and partially occupied bytes
            }
            else {
-              usedbytes = width*bs;
+              usedbytes = (uint64_t) width*bs;
            }
-           if(IS_MEM_UNSAFE(record+offBits, usedbytes, blimit))return(0);
+           bmbytes = (height ? (uint64_t)(height - 1) * UP4(usedbytes) + usedbytes : 0);
+           if(bmbytes > INT32_MAX || IS_MEM_UNSAFE(record+offBits, (int) bmbytes, blimit))return(0);
+       }
+       else if(dibparams == U_BI_RLE8 || dibparams == U_BI_RLE4){
+           if(IS_MEM_UNSAFE(record+offBits, numCt, blimit))return(0);  // numCt holds the size of the RLE data
        }
    }
    return(1);
@@ -1198,6 +1212,214 @@ int U_emf_record_safe(const char *record){
     return(rstatus);
 }
 
+/* **********************************************************************************************
+These functions read an EMF file one record at a time, in bounded memory, validating each record
+with U_emf_record_sizeok() and U_emf_record_safe() before it is handed to the caller.
+*********************************************************************************************** */
+
+//! \cond
+/*  Common code for emf_reader_open() and emf_reader_fdopen(). */
+static int emf_reader_create(
+      FILE        *fp,
+      int          fd,
+      size_t       chunksize,
+      size_t       maxrecsize,
+      EMFREADER  **er
+   ){
+   EMFREADER *erl;
+
+   if(!er)return(1);
+   *er = NULL;
+   if(chunksize < sizeof(U_EMR))chunksize = sizeof(U_EMR);
+   if(!maxrecsize)maxrecsize = UINT32_MAX;
+   erl = (EMFREADER *) malloc(sizeof(EMFREADER));
+   if(!erl)return(2);
+   erl->buf = malloc(chunksize);  // no need to zero the memory
+   if(!erl->buf){
+      free(erl);
+      return(3);
+   }
+   erl->fp        = fp;
+   erl->fd        = fd;
+   erl->allocated = chunksize;
+   erl->used      = 0;
+   erl->next      = 0;
+   erl->maxrec    = maxrecsize;
+   erl->foffset   = 0;
+   erl->offset    = 0;
+   erl->recnum    = 0;
+   erl->status    = 0;
+   *er = erl;
+   return(0);
+}
+
+/*  Make at least need bytes, starting at the next record, available in the buffer.
+    Returns 1 on success, 0 if the file ends first, -1 if memory could not be allocated or the read failed. */
+static int emf_reader_fill(
+      EMFREADER   *er,
+      size_t       need
+   ){
+   size_t  avail = er->used - er->next;
+   size_t  got;
+   char   *newbuf;
+#ifdef WIN32
+   int     iret;
+#else
+   ssize_t iret;
+#endif
+
+   if(avail >= need)return(1);
+   if(er->next){  // slide the unconsumed bytes to the front of the buffer
+      memmove(er->buf, er->buf + er->next, avail);
+      er->foffset += er->next;
+      er->used     = avail;
+      er->next     = 0;
+   }
+   if(need > er->allocated){  // buffer is only ever as large as the largest record (or the initial chunk)
+      newbuf = realloc(er->buf, need);
+      if(!newbuf)return(-1);
+      er->buf       = newbuf;
+      er->allocated = need;
+   }
+   while(er->used < need){
+      if(er->fp){
+         got = fread(er->buf + er->used, 1, er->allocated - er->used, er->fp);
+         if(!got)return(ferror(er->fp) ? -1 : 0);
+      }
+      else {
+#ifdef WIN32
+         iret = _read(er->fd, er->buf + er->used, er->allocated - er->used);
+#else
+         iret = read(er->fd, er->buf + er->used, er->allocated - er->used);
+#endif
+         if(iret < 0){
+            if(errno == EINTR)continue;
+            return(-1);
+         }
+         if(!iret)return(0);
+         got = iret;
+      }
+      er->used += got;
+   }
+   return(1);
+}
+//! \endcond
+
+/**
+    \brief Prepare to read an EMF file one record at a time from an open FILE.
+    \return 0 on success, >=1 on failure
+    \param fp          File to read, opened (for instance by emf_fopen()) in binary mode and positioned at the U_EMRHEADER.  Not closed by emf_reader_close().
+    \param chunksize   Number of bytes to read from the file at a time.
+    \param maxrecsize  Largest record which will be accepted, 0 for no limit.  This bounds the memory used.
+    \param er          EMF reader state.
+*/
+int emf_reader_open(
+      FILE        *fp,
+      size_t       chunksize,
+      size_t       maxrecsize,
+      EMFREADER  **er
+   ){
+   if(!fp)return(4);
+   return(emf_reader_create(fp, -1, chunksize, maxrecsize, er));
+}
+
+/**
+    \brief Prepare to read an EMF file one record at a time from an open file descriptor.
+    \return 0 on success, >=1 on failure
+    \param fd          File descriptor to read, positioned at the U_EMRHEADER.  Not closed by emf_reader_close().
+    \param chunksize   Number of bytes to read from the file at a time.
+    \param maxrecsize  Largest record which will be accepted, 0 for no limit.  This bounds the memory used.
+    \param er          EMF reader state.
+*/
+int emf_reader_fdopen(
+      int          fd,
+      size_t       chunksize,
+      size_t       maxrecsize,
+      EMFREADER  **er
+   ){
+   if(fd < 0)return(4);
+   return(emf_reader_create(NULL, fd, chunksize, maxrecsize, er));
+}
+
+/**
+    \brief Retrieve the next record from an EMF file opened with emf_reader_open() or emf_reader_fdopen().
+    
+    The record has passed U_emf_record_sizeok() and U_emf_record_safe(), and on a Big Endian machine it
+    has been converted to the local byte order.  It remains valid only until the next call.
+    Its offset in the file is er->offset and its record number is er->recnum - 1.
+    
+    \return 0 if a record was returned, 1 if there are no more records (U_EMR_EOF was already returned, or
+      the file ended on a record boundary), 2 on a programming error, 3 if the file ended within a record,
+      4 if the record size is invalid, 5 on a memory or read error, 6 if the record is not safe to use.
+    \param er      EMF reader state
+    \param record  Next record, or NULL if none is returned
+*/
+int emf_reader_next(
+      EMFREADER   *er,
+      char       **record
+   ){
+   const unsigned char *p;
+   char     *rec;
+   uint32_t  nSize;
+   uint32_t  iType;
+   int       fstatus;
+
+   if(!record)return(2);
+   *record = NULL;
+   if(!er)return(2);
+   if(er->status)return(er->status);
+
+   fstatus = emf_reader_fill(er, sizeof(U_EMR));
+   if(fstatus < 0){      er->status = 5;                               }
+   else if(!fstatus){    er->status = (er->used == er->next ? 1 : 3);  }
+   else {
+      p = (const unsigned char *)(er->buf + er->next + offsetof(U_EMR,nSize));
+      nSize = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);   // always Little Endian in the file
+      if(nSize < sizeof(U_EMR) || nSize > er->maxrec){ er->status = 4; }
+      else {
+         fstatus = emf_reader_fill(er, nSize);
+         if(fstatus < 0){      er->status = 5; }
+         else if(!fstatus){    er->status = 3; }
+         else {
+            rec = er->buf + er->next;
+#if U_BYTE_SWAP
+            //This is a Big Endian machine, EMF data is Little Endian
+            (void) U_emf_endian(rec, nSize, 0);  // LE to BE, one record, so the status is not meaningful
+#endif
+            if(!U_emf_record_sizeok(rec, rec + nSize, &nSize, &iType, 1)){ er->status = 4; }
+            else if(!U_emf_record_safe(rec)){                              er->status = 6; }
+            else {
+               er->offset = er->foffset + er->next;
+               er->next  += nSize;
+               er->recnum++;
+               if(iType == U_EMR_EOF)er->status = 1;  // returned now, 1 on the next call
+               *record = rec;
+               return(0);
+            }
+         }
+      }
+   }
+   return(er->status);
+}
+
+/**
+    \brief Release an EMF reader.  The FILE or file descriptor it was reading is NOT closed.
+    \return 0 on success, >=1 on failure
+    \param er  EMF reader state.  Set to NULL.
+*/
+int emf_reader_close(
+      EMFREADER  **er
+   ){
+   EMFREADER *erl;
+   if(!er)return(1);
+   erl = *er;
+   if(!erl)return(2);
+   free(erl->buf);
+   free(erl);
+   *er = NULL;
+   return(0);
+}
+
 
 #ifdef __cplusplus
 }
@@ -8,6 +8,13 @@
   uninitialized data.
   
   Compile with "SOL8" defined for Solaris 8 or 9 (Sparc).
+
+  Compile with "U_NO_THREADS" defined if POSIX threads are not available.  The iconv descriptors which
+  U_Utf_convert() keeps for transliteration are then not locked, so it must only be called from one thread.
+  Those descriptors are closed by U_Utf_cleanup().
+
+  Compile with "U_UTF_REFERENCE" defined to convert runs of ASCII in U_Utf_convert() one character at a time,
+  without the vector kernels.
 */
 
 /*
@@ -32,6 +39,9 @@ extern "C" {
 #include <string.h>
 #include <limits.h> // for INT_MAX, INT_MIN
 #include <math.h>   // for U_ROUND()
+#ifndef U_NO_THREADS
+#include <pthread.h>  // to share the iconv descriptors used by U_Utf_convert()
+#endif
 #include "uemf_utf.h"
 
 //! \cond
@@ -208,11 +218,385 @@ void   wchar16strncpypad(
    }
 }
 
-/*  For the following converstion functions, remember that iconv() modifies ALL of its parameters,
-    so save a pointer to the destination buffer!!!!
-    It isn't clear that terminators are being
-    copied properly, so be sure allocated space is a bit larger and cleared.
+/* **********************************************************************************************
+Character set conversions.  U_Utf_convert() does the work, converting directly between Latin1, UTF-8, 
+UTF-16LE, and UTF-32LE into a buffer supplied by the caller.  Runs of ASCII, which is most of the text in 
+most EMF and WMF files, are copied by unit size conversion, a vector at a time where that is supported. 
+iconv() is only used for the one thing which is not done here, transliteration to Latin1 of characters 
+which it does not contain.  The functions which follow it return the converted string in new memory.
+*********************************************************************************************** */
+
+/** \cond */
+#if !defined(U_UTF_REFERENCE) && defined(__SSE2__)
+#  define U_UTF_SSE2 1
+#  include <emmintrin.h>  // x86 is Little Endian, so UTF-16LE and UTF-32LE units are native there
+#endif
+
+#define U_UTF_BAD  0xFFFFFFFF   // utf_decode() result for an invalid or incomplete sequence
+
+/* Size in bytes of one code unit of a U_UTF_* encoding, 0 if it is not one */
+static int utf_unit(int code){
+   switch(code){
+      case U_UTF_LATIN1:
+      case U_UTF_8:      return(1);
+      case U_UTF_16LE:   return(2);
+      case U_UTF_32LE:   return(4);
+      default:           return(0);
+   }
+}
+
+/* Number of code units of size bytes before the terminator */
+static size_t utf_units(const void *src, int size){
+   switch(size){
+      case 1:  return(strlen((const char *) src));
+      case 2:  return(wchar16len((const uint16_t *) src));
+      default: return(wchar32len((const uint32_t *) src));
+   }
+}
+
+/* Read or write one Little Endian code unit of size bytes, whatever the byte order of the machine */
+static uint32_t utf_get(const uint8_t *p, int size){
+   switch(size){
+      case 1:  return(p[0]);
+      case 2:  return(p[0] | (p[1] << 8));
+      default: return(p[0] | (p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24));
+   }
+}
+
+static void utf_put(uint8_t *p, int size, uint32_t val){
+   p[0] = val;
+   if(size > 1){
+      p[1] = val >> 8;
+      if(size > 2){
+         p[2] = val >> 16;
+         p[3] = val >> 24;
+      }
+   }
+}
+
+/* Copy the leading run of ASCII (code units below 0x80), at most n units, from src with units of ssize bytes
+   to dst with units of dsize bytes.  If dst is NULL only count them.  Returns the number of units copied. */
+static size_t utf_ascii(uint8_t *dst, int dsize, const uint8_t *src, int ssize, size_t n){
+   size_t   i = 0;
+   uint32_t val;
+#ifdef U_UTF_SSE2
+   const __m128i zero = _mm_setzero_si128();
+   __m128i       a, b;
+   if(ssize == 1){                       // 16 characters at a time
+      for(; i + 16 <= n; i += 16){
+         a = _mm_loadu_si128((const __m128i *)(src + i));
+         if(_mm_movemask_epi8(a))break;
+         if(!dst)continue;
+         if(dsize == 1){
+            _mm_storeu_si128((__m128i *)(dst + i), a);
+         }
+         else if(dsize == 2){
+            _mm_storeu_si128((__m128i *)(dst + 2*i),      _mm_unpacklo_epi8(a, zero));
+            _mm_storeu_si128((__m128i *)(dst + 2*i + 16), _mm_unpackhi_epi8(a, zero));
+         }
+         else {
+            b = _mm_unpacklo_epi8(a, zero);
+            _mm_storeu_si128((__m128i *)(dst + 4*i),      _mm_unpacklo_epi16(b, zero));
+            _mm_storeu_si128((__m128i *)(dst + 4*i + 16), _mm_unpackhi_epi16(b, zero));
+            b = _mm_unpackhi_epi8(a, zero);
+            _mm_storeu_si128((__m128i *)(dst + 4*i + 32), _mm_unpacklo_epi16(b, zero));
+            _mm_storeu_si128((__m128i *)(dst + 4*i + 48), _mm_unpackhi_epi16(b, zero));
+         }
+      }
+   }
+   else if(ssize == 2){                  // 16 characters at a time
+      const __m128i high = _mm_set1_epi16((short) 0xFF80);
+      for(; i + 16 <= n; i += 16){
+         a = _mm_loadu_si128((const __m128i *)(src + 2*i));
+         b = _mm_loadu_si128((const __m128i *)(src + 2*i + 16));
+         if(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), high), zero)) != 0xFFFF)break;
+         if(!dst)continue;
+         if(dsize == 1){
+            _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(a, b));
+         }
+         else if(dsize == 2){
+            _mm_storeu_si128((__m128i *)(dst + 2*i),      a);
+            _mm_storeu_si128((__m128i *)(dst + 2*i + 16), b);
+         }
+         else {
+            _mm_storeu_si128((__m128i *)(dst + 4*i),      _mm_unpacklo_epi16(a, zero));
+            _mm_storeu_si128((__m128i *)(dst + 4*i + 16), _mm_unpackhi_epi16(a, zero));
+            _mm_storeu_si128((__m128i *)(dst + 4*i + 32), _mm_unpacklo_epi16(b, zero));
+            _mm_storeu_si128((__m128i *)(dst + 4*i + 48), _mm_unpackhi_epi16(b, zero));
+         }
+      }
+   }
+   else {                                // 8 characters at a time
+      const __m128i high = _mm_set1_epi32((int) 0xFFFFFF80);
+      for(; i + 8 <= n; i += 8){
+         a = _mm_loadu_si128((const __m128i *)(src + 4*i));
+         b = _mm_loadu_si128((const __m128i *)(src + 4*i + 16));
+         if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(a, b), high), zero)) != 0xFFFF)break;
+         if(!dst)continue;
+         if(dsize == 4){
+            _mm_storeu_si128((__m128i *)(dst + 4*i),      a);
+            _mm_storeu_si128((__m128i *)(dst + 4*i + 16), b);
+         }
+         else {
+            a = _mm_packs_epi32(a, b);   // all values are < 0x80, so no saturation
+            if(dsize == 2){ _mm_storeu_si128((__m128i *)(dst + 2*i), a); }
+            else {          _mm_storel_epi64((__m128i *)(dst + i), _mm_packus_epi16(a, zero)); }
+         }
+      }
+   }
+#else
+   uint64_t w;
+   size_t   j;
+   if(ssize == 1){                       // 8 characters at a time
+      for(; i + 8 <= n; i += 8){
+         memcpy(&w, src + i, 8);
+         if(w & UINT64_C(0x8080808080808080))break;
+         if(!dst)continue;
+         if(dsize == 1){ memcpy(dst + i, src + i, 8); }
+         else {          for(j = i; j < i + 8; j++){ utf_put(dst + j*dsize, dsize, src[j]); } }
+      }
+   }
+#endif
+   for(; i < n; i++){
+      val = utf_get(src + i*ssize, ssize);
+      if(val >= 0x80)break;
+      if(dst)utf_put(dst + i*dsize, dsize, val);
+   }
+   return(i);
+}
+
+/* Decode the character which starts at code unit *i of src, which holds n units, and advance *i past it. 
+   Returns the character, or U_UTF_BAD if the sequence is invalid or incomplete. */
+static uint32_t utf_decode(const uint8_t *src, int code, size_t n, size_t *i){
+   uint32_t c, c2;
+   int      more, k;
+   switch(code){
+      case U_UTF_LATIN1:
+         return(src[(*i)++]);
+      case U_UTF_8:
+         c = src[(*i)++];
+         if(c < 0x80){        return(c);                     }
+         else if(c < 0xC2){   return(U_UTF_BAD);             }  // continuation byte, or overlong 2 byte form
+         else if(c < 0xE0){   more = 1; c &= 0x1F;           }
+         else if(c < 0xF0){   more = 2; c &= 0x0F;           }
+         else if(c < 0xF5){   more = 3; c &= 0x07;           }
+         else {               return(U_UTF_BAD);             }
+         if(n - *i < (size_t) more)return(U_UTF_BAD);
+         for(k = 0; k < more; k++){
+            c2 = src[(*i)++];
+            if((c2 & 0xC0) != 0x80)return(U_UTF_BAD);
+            c = (c << 6) | (c2 & 0x3F);
+         }
+         if((more == 2 && c < 0x800) || (more == 3 && c < 0x10000))return(U_UTF_BAD);  // overlong
+         if((c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF)return(U_UTF_BAD);
+         return(c);
+      case U_UTF_16LE:
+         c = utf_get(src + 2*(*i)++, 2);
+         if(c < 0xD800 || c > 0xDFFF)return(c);
+         if(c > 0xDBFF || *i >= n)return(U_UTF_BAD);          // unpaired surrogate
+         c2 = utf_get(src + 2*(*i), 2);
+         if(c2 < 0xDC00 || c2 > 0xDFFF)return(U_UTF_BAD);
+         (*i)++;
+         return(0x10000 + ((c - 0xD800) << 10) + (c2 - 0xDC00));
+      default:
+         c = utf_get(src + 4*(*i)++, 4);
+         if((c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF)return(U_UTF_BAD);
+         return(c);
+   }
+}
+
+/* Encode the character c at dst.  Returns the number of code units, or 0 if the encoding cannot represent it. */
+static int utf_encode(uint8_t *dst, int code, uint32_t c){
+   switch(code){
+      case U_UTF_LATIN1:
+         if(c > 0xFF)return(0);
+         dst[0] = c;
+         return(1);
+      case U_UTF_8:
+         if(c < 0x80){     dst[0] = c;                                        return(1); }
+         if(c < 0x800){    dst[0] = 0xC0 | (c >> 6);  dst[1] = 0x80 | (c & 0x3F); return(2); }
+         if(c < 0x10000){  dst[0] = 0xE0 | (c >> 12); dst[1] = 0x80 | ((c >> 6) & 0x3F);
+                           dst[2] = 0x80 | (c & 0x3F);                        return(3); }
+         dst[0] = 0xF0 | (c >> 18);          dst[1] = 0x80 | ((c >> 12) & 0x3F);
+         dst[2] = 0x80 | ((c >> 6) & 0x3F);  dst[3] = 0x80 | (c & 0x3F);
+         return(4);
+      case U_UTF_16LE:
+         if(c < 0x10000){ utf_put(dst, 2, c); return(1); }
+         utf_put(dst,     2, 0xD800 + ((c - 0x10000) >> 10));
+         utf_put(dst + 2, 2, 0xDC00 + ((c - 0x10000) & 0x3FF));
+         return(2);
+      default:
+         utf_put(dst, 4, c);
+         return(1);
+   }
+}
+
+/* For transliteration to Latin1, with a descriptor for each source encoding which is opened when first needed */
+static const char *utf_iconv_from[3] = { "UTF-8", "UTF-16LE", "UTF-32LE" };
+static iconv_t     utf_iconv_cd[3];
+static int         utf_iconv_ok[3];
+#ifndef U_NO_THREADS
+static pthread_mutex_t utf_iconv_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* U_Utf_convert() to Latin1 when src holds characters which Latin1 does not, using iconv() to substitute
+   similar ones, as "LATIN1//TRANSLIT" does.  srcbytes is the length of src in bytes. */
+static int utf_translit(char *dst, size_t dstmax, size_t *dstlen, int srccode, const char *src, size_t srcbytes){
+   char    buf[256];
+   char   *in = (char *) src;
+   char   *out;
+   size_t  outleft;
+   size_t  count = 0;
+   int     slot  = (srccode == U_UTF_8 ? 0 : (srccode == U_UTF_16LE ? 1 : 2));
+   int     rc    = 0;
+#ifndef U_NO_THREADS
+   pthread_mutex_lock(&utf_iconv_lock);
+#endif
+   if(!utf_iconv_ok[slot]){
+      utf_iconv_cd[slot] = iconv_open("LATIN1//TRANSLIT", utf_iconv_from[slot]);
+      utf_iconv_ok[slot] = (utf_iconv_cd[slot] != (iconv_t) -1);
+   }
+   if(!utf_iconv_ok[slot]){
+      rc = 4;
+   }
+   else {
+      (void) iconv(utf_iconv_cd[slot], NULL, NULL, NULL, NULL);  // back to the initial state
+      while(srcbytes && !rc){
+         out     = (dst ? dst + count : buf);   // when only measuring, reuse buf
+         outleft = (dst ? dstmax - 1 - count : sizeof(buf));
+         if(iconv(utf_iconv_cd[slot], ICONV_CAST &in, &srcbytes, &out, &outleft) == (size_t) -1){
+            if(errno != E2BIG){ rc = 2; }
+            else if(dst){       rc = 3; }
+         }
+         count = (dst ? (size_t)(out - dst) : count + (size_t)(out - buf));
+      }
+   }
+#ifndef U_NO_THREADS
+   pthread_mutex_unlock(&utf_iconv_lock);
+#endif
+   if(rc)return(rc);
+   if(dst)dst[count] = '\0';
+   if(dstlen)*dstlen = count;
+   return(0);
+}
+/** \endcond */
+
+/**
+    \brief Close the iconv descriptors which U_Utf_convert() and the functions built on it open, the first time
+    each is needed, to transliterate to Latin1.
+    
+    Call this when done with the text functions, for instance before the program exits, so that nothing is
+    left allocated.  It is safe to call at any time, and more than once.  A later transliteration opens the
+    descriptors again.
 */
+void U_Utf_cleanup(void){
+   int slot;
+#ifndef U_NO_THREADS
+   pthread_mutex_lock(&utf_iconv_lock);
+#endif
+   for(slot = 0; slot < 3; slot++){
+      if(utf_iconv_ok[slot])(void) iconv_close(utf_iconv_cd[slot]);
+      utf_iconv_ok[slot] = 0;
+   }
+#ifndef U_NO_THREADS
+   pthread_mutex_unlock(&utf_iconv_lock);
+#endif
+}
+
+/**
+    \brief Convert a string from one text encoding to another, into a buffer supplied by the caller.
+    \return 0 on success, 1 if an argument is invalid, 2 if src is not valid in srccode (or ends in the middle of
+    a character), 3 if dst is too small, 4 if a character must be transliterated and iconv() cannot do it.
+    \param dstcode  encoding of dst, U_UTF_LATIN1, U_UTF_8, U_UTF_16LE, or U_UTF_32LE
+    \param dst      buffer for the converted string and a terminator, or NULL to only find its length
+    \param dstmax   size of dst in code units (bytes for Latin1 and UTF-8), including room for the terminator
+    \param dstlen   if not NULL receives the number of code units in the converted string, NOT including the terminator
+    \param srccode  encoding of src, U_UTF_LATIN1, U_UTF_8, U_UTF_16LE, or U_UTF_32LE
+    \param src      string to convert
+    \param max      number of code units in src to convert, if 0, until the terminator
+
+    The conversion does no memory allocation.  Characters which Latin1 cannot hold are transliterated
+    with iconv() to similar ones, or '?', as in U_Utf8ToLatin1().  A buffer of 1 + max units, with 
+    max the length of src, is large enough for any conversion except:
+    to UTF-8 from UTF-16LE (3*max) or UTF-32LE (4*max) or Latin1 (2*max), to UTF-16LE from UTF-32LE (2*max),
+    and transliteration.
+*/
+int U_Utf_convert(
+      int          dstcode,
+      void        *dst,
+      size_t       dstmax,
+      size_t      *dstlen,
+      int          srccode,
+      const void  *src,
+      size_t       max
+   ){
+   const uint8_t *s     = (const uint8_t *) src;
+   uint8_t       *d     = (uint8_t *) dst;
+   int            ssize = utf_unit(srccode);
+   int            dsize = utf_unit(dstcode);
+   uint8_t        tmp[4];
+   size_t         n, i = 0, o = 0, k, room;
+   uint32_t       c;
+   int            m;
+   if(!src || !ssize || !dsize)return(1);
+   if(d && !dstmax)return(3);
+   n = (max ? max : utf_units(src, ssize));
+   while(i < n){
+      room = (d ? dstmax - 1 - o : n - i);  // units left in dst before the terminator
+      k = utf_ascii((d ? d + o*dsize : NULL), dsize, s + i*ssize, ssize, (n - i < room ? n - i : room));
+      i += k;
+      o += k;
+      if(i >= n)break;
+      c = utf_decode(s, srccode, n, &i);
+      if(c == U_UTF_BAD)return(2);
+      m = utf_encode(tmp, dstcode, c);
+      if(!m)return(utf_translit((char *) dst, dstmax, dstlen, srccode, (const char *) src, n*ssize));
+      if(d){
+         if(o + m > dstmax - 1)return(3);
+         memcpy(d + o*dsize, tmp, m*dsize);
+      }
+      o += m;
+   }
+   if(d)utf_put(d + o*dsize, dsize, 0);
+   if(dstlen)*dstlen = o;
+   return(0);
+}
+
+//! \cond
+/*  U_Utf_convert() into new memory, used by the conversion functions below.  mult is the most code units
+    that dst can need per unit of src.  Returns the new string, NULL on error. */
+static void *utf_new(int dstcode, int srccode, const void *src, size_t max, size_t mult, size_t *len){
+   void   *dst, *tmp;
+   size_t  n, count, size;
+   int     dsize = utf_unit(dstcode);
+   int     rc;
+   if(!src)return(NULL);
+   n = (max ? max : utf_units(src, utf_unit(srccode)));
+   if(n >= ((size_t) -1)/(4*mult) - 4)return(NULL);
+   size = 1 + mult*n;
+   dst  = malloc(size * dsize);
+   if(!dst)return(NULL);
+   rc = U_Utf_convert(dstcode, dst, size, &count, srccode, src, n);
+   if(rc == 3 && !U_Utf_convert(dstcode, NULL, 0, &count, srccode, src, n)){  // transliteration can grow
+      tmp = realloc(dst, (count + 1) * dsize);
+      if(tmp){
+         dst  = tmp;
+         size = count + 1;
+         rc   = U_Utf_convert(dstcode, dst, size, &count, srccode, src, n);
+      }
+   }
+   if(rc){
+      free(dst);
+      return(NULL);
+   }
+   if(size > 2*(count + 1)){                        // do not hold on to much more than the worst case needed
+      tmp = realloc(dst, (count + 1) * dsize);
+      if(tmp)dst = tmp;
+   }
+   if(len){ *len = (max ? utf_units(dst, dsize) : count); }  // src may hold terminators if max was given
+   return(dst);
+}
+//! \endcond
 
 /** 
     \brief Convert a UTF32LE string to a UTF16LE string.
@@ -226,35 +610,7 @@ uint16_t *U_Utf32leToUtf16le(
       size_t          max,
       size_t         *len
    ){
-   char *dst,*dst2;
-   char *src2 = (char *) src;
-   size_t srclen,dstlen,status;
-
-   if(!src)return(NULL);
-   if(max){ srclen = 4*max; }
-   else {   srclen = 4 + 4*wchar32len(src); } //include terminator, length in BYTES
-   
-   dstlen = 2 + srclen;                     // this will always work, but may waste space
-   dst2  = dst = calloc(dstlen,1);          // so there will be at least one terminator
-   if(dst){
-      iconv_t conv = iconv_open("UTF-16LE", "UTF-32LE");
-      if ( conv == (iconv_t) -1){
-         free(dst2);
-         dst2=NULL;
-      }
-      else {
-         status = iconv(conv, ICONV_CAST &src2, &srclen, &dst, &dstlen);
-         iconv_close(conv);
-         if(status == (size_t) -1){
-            free(dst2);
-            dst2 = NULL;
-         }
-         else if(len){
-            *len=wchar16len((uint16_t *)dst2);
-         }
-      }
-   }
-   return((uint16_t *)dst2);
+   return((uint16_t *) utf_new(U_UTF_16LE, U_UTF_32LE, src, max, 2, len));
 }
 
 /**
@@ -269,34 +625,7 @@ uint32_t *U_Utf16leToUtf32le(
       size_t          max,
       size_t         *len
    ){
-   char *dst,*dst2;
-   char *src2 = (char *) src;
-   size_t srclen,dstlen,status;
-
-   if(!src)return(NULL);
-   if(max){ srclen = 2*max; }
-   else {   srclen = 2*wchar16len(src)+2; } // include terminator, length in BYTES
-   dstlen = 2*(2 + srclen);                 // This should always work
-   dst2 = dst = calloc(dstlen,1);
-   if(dst){
-      iconv_t conv = iconv_open("UTF-32LE",   "UTF-16LE");
-      if ( conv == (iconv_t) -1){
-         free(dst2);
-         dst2=NULL;
-      }
-      else {
-         status = iconv(conv, ICONV_CAST &src2, &srclen, &dst, &dstlen);
-         iconv_close(conv);
-         if(status == (size_t) -1){
-            free(dst2);
-            dst2 = NULL;
-         }
-         else if(len){
-            *len=wchar32len((uint32_t *)dst2);
-         }
-      }
-   }
-   return((uint32_t *) dst2);
+   return((uint32_t *) utf_new(U_UTF_32LE, U_UTF_16LE, src, max, 1, len));
 }
 
 /**
@@ -317,34 +646,7 @@ uint32_t *U_Latin1ToUtf32le(
       size_t      max,
       size_t     *len
    ){
-   char *dst,*dst2;
-   char *src2 = (char *) src;
-   size_t srclen,dstlen,status;
-
-   if(!src)return(NULL);
-   if(max){ srclen = max; }
-   else {   srclen = strlen(src)+1; }       // include terminator, length in BYTES
-   dstlen = sizeof(uint32_t)*(1 + srclen);  // This should always work but might waste some space
-   dst2 = dst = calloc(dstlen,1);
-   if(dst){
-      iconv_t conv = iconv_open("UTF-32LE",   "LATIN1");
-      if ( conv == (iconv_t) -1){
-         free(dst2);
-         dst2=NULL;
-      }
-      else {
-         status = iconv(conv, ICONV_CAST &src2, &srclen, &dst, &dstlen);
-         iconv_close(conv);
-         if(status == (size_t) -1){
-            free(dst2);
-            dst2 = NULL;
-         }
-         else if(len){
-            *len=wchar32len((uint32_t *)dst2);
-         }
-      }
-   }
-   return((uint32_t *) dst2);
+   return((uint32_t *) utf_new(U_UTF_32LE, U_UTF_LATIN1, src, max, 1, len));
 }
 
 /**
@@ -359,34 +661,7 @@ uint32_t *U_Utf8ToUtf32le(
       size_t      max,
       size_t     *len
    ){
-   char *dst,*dst2;
-   char *src2 = (char *) src;
-   size_t srclen,dstlen,status;
-
-   if(!src)return(NULL);
-   if(max){ srclen = max; }
-   else {   srclen = strlen(src)+1; }       // include terminator, length in BYTES
-   dstlen = sizeof(uint32_t)*(1 + srclen);  // This should always work but might waste some space
-   dst2 = dst = calloc(dstlen,1);
-   if(dst){
-      iconv_t conv = iconv_open("UTF-32LE",   "UTF-8");
-      if ( conv == (iconv_t) -1){
-         free(dst2);
-         dst2=NULL;
-      }
-      else {
-         status = iconv(conv, ICONV_CAST &src2, &srclen, &dst, &dstlen);
-         iconv_close(conv);
-         if(status == (size_t) -1){
-            free(dst2);
-            dst2 = NULL;
-         }
-         else if(len){
-            *len=wchar32len((uint32_t *)dst2);
-         }
-      }
-   }
-   return((uint32_t *) dst2);
+   return((uint32_t *) utf_new(U_UTF_32LE, U_UTF_8, src, max, 1, len));
 }
 
 /**
@@ -401,34 +676,7 @@ char *U_Utf32leToUtf8(
       size_t          max,
       size_t         *len
    ){
-   char *dst,*dst2;
-   char *src2 = (char *) src;
-   size_t srclen,dstlen,status;
-
-   if(!src)return(NULL);
-   if(max){ srclen = 4*max; }
-   else {   srclen = 4*(1 + wchar32len(src)); } //include terminator, length in BYTES
-   dstlen = 1 + srclen;                         // This should always work but might waste some space
-   dst2 = dst = calloc(dstlen,1);
-   if(dst){
-      iconv_t conv = iconv_open("UTF-8",   "UTF-32LE");
-      if ( conv == (iconv_t) -1){
-         free(dst2);
-         dst2=NULL;
-      }
-      else {
-         status = iconv(conv, ICONV_CAST &src2, &srclen, &dst, &dstlen);
-         iconv_close(conv);
-         if(status == (size_t) -1){
-            free(dst2);
-            dst2 = NULL;
-         }
-         else if(len){
-            *len=strlen(dst2);
-         }
-      }
-   }
-   return(dst2);
+   return((char *) utf_new(U_UTF_8, U_UTF_32LE, src, max, 4, len));
 }
 
 /**
@@ -443,34 +691,7 @@ uint16_t *U_Utf8ToUtf16le(
       size_t        max,
       size_t       *len
    ){
-   char *dst,*dst2;
-   char *src2 = (char *) src;
-   size_t srclen,dstlen,status;
-
-   if(!src)return(NULL);
-   if(max){ srclen = max; }
-   else {   srclen = strlen(src)+1; }       // include terminator, length in BYTES
-   dstlen = 2 * (1 + srclen);               // this will always work, but may waste space
-   dst2 = dst =calloc(dstlen,1);            // so there will always be a terminator
-   if(dst){
-      iconv_t conv = iconv_open("UTF-16LE", "UTF-8");
-      if ( conv == (iconv_t) -1){
-         free(dst2);
-         dst2=NULL;
-      }
-      else {
-         status = iconv(conv, ICONV_CAST &src2, &srclen, &dst, &dstlen);
-         iconv_close(conv);
-         if(status == (size_t) -1){
-            free(dst2);
-            dst2 = NULL;
-         }
-         else if(len){
-            *len=wchar16len((uint16_t *)dst2);
-         }
-      }
-   }
-   return((uint16_t *)dst2);
+   return((uint16_t *) utf_new(U_UTF_16LE, U_UTF_8, src, max, 1, len));
 }
 
 /**
@@ -485,38 +706,7 @@ char *U_Utf16leToUtf8(
       size_t          max,
       size_t         *len
    ){
-   char *dst, *dst2;
-   char *src2 = (char *) src;
-   size_t srclen,dstlen,status;
-
-   if(!src)return(NULL);
-   if(max){ srclen = 2*max; }
-   else {   srclen = 2*(1 +wchar16len(src)); } //include terminator, length in BYTES
-   dstlen = 1 + 2*srclen;                      // this will always work, but may waste space
-                                               // worst case is all glyphs (==max) need 4 UTF-8 encoded bytes + terminator.
-   dst2 = dst = (char *) calloc(dstlen,1);
-   if(dst){
-      iconv_t conv = iconv_open("UTF-8", "UTF-16LE");
-      if ( conv == (iconv_t) -1){
-         free(dst2);
-         dst2=NULL;
-      }
-      else {
-         status = iconv(conv, ICONV_CAST &src2, &srclen, &dst, &dstlen);
-         iconv_close(conv);
-         if(status == (size_t) -1){
-            free(dst2);
-            dst2 = NULL;
-         }
-         else if(len){
-            *len=strlen(dst2);
-            dst = dst2;
-            dst2 = U_strdup(dst); // make a string of exactly the right size
-            free(dst);            // free the one which was probably too big
-         }
-      }
-   }
-   return(dst2);
+   return((char *) utf_new(U_UTF_8, U_UTF_16LE, src, max, 3, len));
 }
 
 /**
@@ -531,37 +721,7 @@ char *U_Utf16leToLatin1(
       size_t          max,
       size_t         *len
    ){
-   char *dst, *dst2;
-   char *src2 = (char *) src;
-   size_t srclen,dstlen,status;
-
-   if(!src)return(NULL);
-   if(max){ srclen = 2*max; }
-   else {   srclen = 2*(1 +wchar16len(src)); } //include terminator, length in BYTES
-   dstlen = 1 + srclen;                        // this will always work as latin1 is always 1 byte/character
-   dst2 = dst = (char *) calloc(dstlen,1);
-   if(dst){
-      iconv_t conv = iconv_open("LATIN1//TRANSLIT",   "UTF-16LE");
-      if ( conv == (iconv_t) -1){
-         free(dst2);
-         dst2=NULL;
-      }
-      else {
-         status = iconv(conv, ICONV_CAST &src2, &srclen, &dst, &dstlen);
-         iconv_close(conv);
-         if(status == (size_t) -1){
-            free(dst2);
-            dst2 = NULL;
-         }
-         else if(len){
-            *len=strlen(dst2);
-            dst = dst2;
-            dst2 = U_strdup(dst); // make a string of exactly the right size
-            free(dst);            // free the one which was probably too big
-         }
-      }
-   }
-   return(dst2);
+   return((char *) utf_new(U_UTF_LATIN1, U_UTF_16LE, src, max, 2, len));  // transliteration may need more than 1
 }
 /**
     \brief Put a single 16 bit character into UTF-16LE form.
@@ -597,32 +757,7 @@ char *U_Utf8ToLatin1(
       size_t      max,
       size_t     *len
    ){
-   char *dst,*dst2;
-   char *src2 = (char *) src;
-   size_t srclen,dstlen,status;
-   if(max){ srclen = max; }
-   else {   srclen = strlen(src)+1; }       // include terminator, length in BYTES
-   dstlen = (1 + srclen);                   // This should always work but might waste some space
-   dst2 = dst = calloc(dstlen,1);
-   if(dst){
-      iconv_t conv = iconv_open("LATIN1//TRANSLIT",   "UTF-8"); // translate what can be, fill in with something close for the rest
-      if ( conv == (iconv_t) -1){
-         free(dst2);
-         dst2=NULL;
-      }
-      else {
-         status = iconv(conv, ICONV_CAST &src2, &srclen, &dst, &dstlen);
-         iconv_close(conv);
-         if(status == (size_t) -1){
-            free(dst2);
-            dst2 = NULL;
-         }
-         else if(len){
-            *len=strlen(dst2);
-         }
-      }
-   }
-   return((char *) dst2);
+   return((char *) utf_new(U_UTF_LATIN1, U_UTF_8, src, max, 1, len));
 }
 
 /**
@@ -641,32 +776,7 @@ char *U_Latin1ToUtf8(
       size_t      max,
       size_t     *len
    ){
-   char *dst,*dst2;
-   char *src2 = (char *) src;
-   size_t srclen,dstlen,status;
-   if(max){ srclen = max; }
-   else {   srclen = strlen(src)+1; }       // include terminator, will waste some space
-   dstlen = (1 + 2*srclen);                 // This should always work because all latin1 convert to 1 or 2 byte UTF8, it might waste some space
-   dst2 = dst = calloc(dstlen,1);
-   if(dst){
-      iconv_t conv = iconv_open("UTF-8", "LATIN1"); // everything should translate
-      if ( conv == (iconv_t) -1){
-         free(dst2);
-         dst2=NULL;
-      }
-      else {
-         status = iconv(conv, ICONV_CAST &src2, &srclen, &dst, &dstlen);
-         iconv_close(conv);
-         if(status == (size_t) -1){
-            free(dst2);
-            dst2 = NULL;
-         }
-         else if(len){
-            *len=strlen(dst2);
-         }
-      }
-   }
-   return((char *) dst2);
+   return((char *) utf_new(U_UTF_8, U_UTF_LATIN1, src, max, 2, len));
 }
 
 /**
@@ -68,29 +68,105 @@ void U_swap2(void *ul, unsigned int count);
 void U_swap4(void *ul, unsigned int count);
 //! \endcond
 
+//! \cond
+/*  Get space in the EMF output for Size bytes of EMF+ records, the first of which has record type Type.  If packing
+    is enabled (see U_PMR_pack()) and the last EMF record is an EMF+ comment with room for them, they go at its end,
+    otherwise a new EMF+ comment is started.  Returns the comment, with *Off set to the offset in it at which to write,
+    or NULL on error.  Write the records, then call pmr_comment_commit().  The header and end of file records
+    always get a comment of their own. */
+static char *pmr_comment_space(EMFTRACK *et, uint32_t Type, size_t Size, size_t *Off){
+   char          *rec;
+   PU_EMRCOMMENT  pEmr;
+   uint16_t       First;
+   if(Size > UINT32_MAX - U_SIZE_EMRCOMMENT - 4 - 3)return(NULL);
+   Type &= U_PMR_TYPE_MASK;
+   if(et->pmfpack && et->open && Type != U_PMR_HEADER && Type != U_PMR_ENDOFFILE &&
+      et->open + UP4(Size) <= et->pmfpack && (rec = emf_extend_space(et, UP4(Size)))){
+      pEmr = (PU_EMRCOMMENT) rec;
+      memcpy(&First, rec + U_SIZE_EMRCOMMENT + 4, 2);  /* type of the first EMF+ record in the comment, LE */
+      if(U_IS_BE){ U_swap2(&First, 1); }
+      if(pEmr->emr.iType == U_EMR_COMMENT && pEmr->emr.nSize == U_SIZE_EMRCOMMENT + UP4(pEmr->cbData) &&
+         pEmr->cbData >= 4 + 12 && !memcmp(rec + U_SIZE_EMRCOMMENT, "EMF+", 4) &&
+         (First & U_PMR_TYPE_MASK) != U_PMR_HEADER){
+         *Off = pEmr->emr.nSize;                            /* after the padding of the last EMF+ record         */
+         return(rec);
+      }
+   }
+   rec = emf_append_space(et, U_SIZE_EMRCOMMENT + 4 + UP4(Size));
+   if(!rec)return(NULL);
+   pEmr             = (PU_EMRCOMMENT) rec;
+   pEmr->emr.iType  = U_EMR_COMMENT;
+   pEmr->emr.nSize  = 0;                                    /* marks a new comment for pmr_comment_commit()     */
+   memcpy(rec + U_SIZE_EMRCOMMENT, "EMF+", 4);             /* indicates that this comment holds an EMF+ record */
+   *Off = U_SIZE_EMRCOMMENT + 4;
+   return(rec);
+}
+
+/*  Finish the comment from pmr_comment_space() after Size bytes of EMF+ records were written at Off.  Pads
+    them to a multiple of 4 and appends or extends the comment.  Returns 1 on success, 0 on error. */
+static int pmr_comment_commit(EMFTRACK *et, char *rec, size_t Off, size_t Size){
+   PU_EMRCOMMENT  pEmr = (PU_EMRCOMMENT) rec;
+   int            New  = !pEmr->emr.nSize;
+   if(UP4(Size) > Size){ memset(rec + Off + Size, 0, UP4(Size) - Size); }
+   pEmr->cbData     = Off - U_SIZE_EMRCOMMENT + Size;      /* "EMF+" and all of the EMF+ records */
+   pEmr->emr.nSize  = U_SIZE_EMRCOMMENT + UP4(pEmr->cbData);
+   if(New ? emf_append_commit(et) : emf_extend_commit(et))return(0);
+   return(1);
+}
+//! \endcond
+
 /**
     \brief  Utility function for writing one or more EMF+ records in a PseudoObject to the EMF output file
     \return 1 on success, 0 on error.
-    \param  po          U_PSEUDO_OBJ to write, it is deleted after it is written
-    \param  sum         U_PSEUDO_OBJ to use for scratch space
+    \param  po          U_PSEUDO_OBJ to write, it is always deleted, even on error
+    \param  sum         Not used, retained for compatibility, may be NULL
     \param  et          EMFTRACK used to write records to EMF file
+
+    The U_EMRCOMMENT which holds the EMF+ records is built directly in the EMF output buffer, see emf_append_space().
+    If U_PMR_pack() was called the records may be added to the end of the preceding U_EMRCOMMENT instead.
+    Use U_PMR_SERIAL_write() to also skip the PseudoObject for the EMF+ record.
 */
 int U_PMR_write(U_PSEUDO_OBJ *po, U_PSEUDO_OBJ *sum, EMFTRACK *et){
-   char *rec;
-   int status = 0;
-   sum->Used = 0;                                          /* clean it out, retaining allocated memory         */
-   sum       = U_PO_append(sum, "EMF+", 4);                /* indicates that this comment holds an EMF+ record */
-   if(!sum)goto end;
-   sum       = U_PO_append(sum,  po->Data, po->Used);      /* the EMF+ record itself                           */
-   if(!sum)goto end;
-   U_PO_free(&po);                                         /* delete the PseudoObject                          */
-   rec       = U_EMRCOMMENT_set(sum->Used, sum->Data);     /* stuff it into the EMF comment                    */
-   if(!emf_append((PU_ENHMETARECORD)rec, et, 1))goto end;  /* write it to the EMF file, delete the record, check status */
-   status = 1;
-end:
+   char         *rec;
+   size_t        Off;
+   uint16_t      Type = 0;
+   int           status = 0;
+   (void) sum;
+   if(!po)return(0);
+   if(et){
+      if(po->Used >= 2){
+         memcpy(&Type, po->Data, 2);                       /* type of the (first) EMF+ record, LE              */
+         if(U_IS_BE){ U_swap2(&Type, 1); }
+      }
+      rec = pmr_comment_space(et, Type, po->Used, &Off);
+      if(rec){
+         memcpy(rec + Off, po->Data, po->Used);
+         status = pmr_comment_commit(et, rec, Off, po->Used);
+      }
+   }
+   U_PO_free(&po);                                         /* delete the PseudoObject, whether or not it was written */
    return(status);
 }
 
+/**
+    \brief  Pack consecutive EMF+ records into shared EMF comments when they are written to the EMF output file
+    \return 1 on success, 0 on error.
+    \param  et          EMFTRACK used to write records to EMF file
+    \param  MaxSize     Largest U_EMRCOMMENT to create by packing, in bytes.  0 (the default) puts each EMF+ record,
+                         or each PseudoObject passed to U_PMR_write(), in a comment of its own.
+
+    By default every EMF+ record costs a 16 byte U_EMRCOMMENT header and an EMF record.  EMF+ allows an EMF comment 
+    to hold any number of EMF+ records, so with packing on U_PMR_write() and U_PMR_SERIAL_write() add each record
+    to the end of the preceding EMF+ comment if the result is no larger than MaxSize, typically 65536 or so.  Any
+    other EMF record ends the comment.  Records which alone are larger than MaxSize are not split, they get a comment
+    of their own.  The EMF+ header and end of file records are never packed.
+*/
+int U_PMR_pack(EMFTRACK *et, uint32_t MaxSize){
+   if(!et)return(0);
+   et->pmfpack = MaxSize;
+   return(1);
+}
+
 /**
     \brief  Utility function to draw a line.
     \return 1 on success, 0 on error.
@@ -264,6 +340,78 @@ U_PMF_POINT *POINTF_To_POINT16_LE(U_PMF_POINTF *points, int count){
    return(newpts);
 }
 
+//! \cond
+/*  Find the smallest encoding which holds Elements points exactly: U_PMF_POINT_OID (int16) if every coordinate is an
+    integer in the int16 range, U_PMF_POINTR_OID (int7/int15 offsets from the preceding point) if that is allowed,
+    every offset fits in an int15, and it is smaller after padding to 4 bytes, otherwise U_PMF_POINTF_OID.
+    *Bytes receives the size of the encoded coordinates, without the Elements count or any padding.
+*/
+static uint32_t points_encoding(uint32_t Elements, const U_PMF_POINTF *Coords, int AllowRel, size_t *Bytes){
+   size_t   rel = 0;
+   int32_t  prev[2] = {0, 0};
+   int32_t  v, d;
+   float    c;
+   uint32_t i;
+   int      k;
+   for(i = 0; i < Elements; i++){
+      for(k = 0; k < 2; k++){
+         c = (k ? Coords[i].Y : Coords[i].X);
+         if(!(c >= INT16_MIN && c <= INT16_MAX)){ *Bytes = 8 * (size_t) Elements; return(U_PMF_POINTF_OID); } /* also catches NaN */
+         v = (int32_t) c;
+         if((float) v != c){                      *Bytes = 8 * (size_t) Elements; return(U_PMF_POINTF_OID); }
+         if(AllowRel){
+            d = v - prev[k];
+            if(d < -16384 || d > 16383){ AllowRel = 0; }
+            else { rel += ((d >= -64 && d <= 63) ? 1 : 2); }
+            prev[k] = v;
+         }
+      }
+   }
+   if(AllowRel && ((rel + 3) & ~(size_t) 3) < 4 * (size_t) Elements){ *Bytes = rel; return(U_PMF_POINTR_OID); }
+   *Bytes = 4 * (size_t) Elements;
+   return(U_PMF_POINT_OID);
+}
+
+/*  Store Elements points as int16 X,Y pairs in LE byte order at dst, saturating at the int16 limits.
+    Returns the position after the last byte written.
+*/
+static char *point16_encode(char *dst, uint32_t Elements, const U_PMF_POINTF *Coords){
+   int16_t  xy[2];
+   for(; Elements; Elements--, Coords++, dst += 4){
+      xy[0] = U_MNMX(Coords->X, INT16_MIN, INT16_MAX);
+      xy[1] = U_MNMX(Coords->Y, INT16_MIN, INT16_MAX);
+      memcpy(dst, xy, 4);
+      if(U_BYTE_SWAP){ U_swap2(dst, 2); }
+   }
+   return(dst);
+}
+
+/*  Store Elements points as U_PMF_INTEGER7/U_PMF_INTEGER15 offsets from the preceding point (the first from 0,0) at dst.
+    Coordinates are rounded and offsets which do not fit in an int15 saturate, later offsets are from where the
+    saturated point landed, so errors do not accumulate.  At most 4 bytes per point are written.
+    Returns the position after the last byte written.
+*/
+static char *pointr_encode(char *dst, uint32_t Elements, const U_PMF_POINTF *Coords){
+   int64_t  prev[2] = {0, 0};
+   int32_t  d;
+   double   c;
+   int      k;
+   for(; Elements; Elements--, Coords++){
+      for(k = 0; k < 2; k++){
+         c = U_ROUND(k ? Coords->Y : Coords->X) - (double) prev[k];
+         d = (c >= 16383 ? 16383 : (c >= -16384 ? (int32_t) c : -16384)); /* NaN goes to -16384 */
+         prev[k] += d;
+         if(d >= -64 && d <= 63){ *dst++ = (char)(d & U_MASK_INT7); }
+         else {
+            *dst++ = (char)(((d >> 8) & 0x7F) | U_TEST_INT7);   /* U_PMF_INTEGER15 is big endian */
+            *dst++ = (char)(d & 0xFF);
+         }
+      }
+   }
+   return(dst);
+}
+//! \endcond
+
 /**
     \brief Look up the name of the EMR+ record by type.  Returns U_EMR_INVALID if out of range.
         
@@ -490,6 +638,29 @@ int U_OA_release(U_OBJ_ACCUM *oa){
    return(0);
 }
 
+/**
+    \brief Initialize an U_PMF_PARSE_CTX structure before the first record of a file is processed.
+    \param ctx   pointer to the U_PMF_PARSE_CTX structure
+    \returns 0 on success, !0 on error.
+*/
+int U_PCTX_init(U_PMF_PARSE_CTX *ctx){
+   if(!ctx)return(2);
+   memset(ctx, 0, sizeof(U_PMF_PARSE_CTX));
+   return(0);
+}
+
+/**
+    \brief Release an U_PMF_PARSE_CTX structure.  Any partially accumulated object is free'd and the counters reset.
+    \param ctx   pointer to the U_PMF_PARSE_CTX structure
+    \returns 0 on success, !0 on error.
+*/
+int U_PCTX_release(U_PMF_PARSE_CTX *ctx){
+   if(!ctx)return(2);
+   (void) U_OA_release(&(ctx->ObjCont));
+   ctx->recnum = 0;
+   return(0);
+}
+
 /**
     \brief Create and set an U_PSEUDO_OBJ
     \returns pointer to the U_PSEUDO_OBJ, NULL on error
@@ -526,6 +697,32 @@ U_PSEUDO_OBJ *U_PO_create(char *Data, size_t Size, size_t Use, uint32_t Type){
    return(po);
 }
 
+/**
+    \brief Make room in a U_PSEUDO_OBJ for at least Size more bytes after the Used ones
+    \returns 1 on success, 0 on error.  On error the PseudoObject is unchanged.
+    \param po    PseudoObject to grow.  Cannot be NULL.
+    \param Size  Number of bytes which will be appended
+    
+    When Data must grow its allocation is at least doubled, so that building a PseudoObject with many small
+    appends copies each byte only a few times.  Size then becomes larger than Used.
+*/
+int U_PO_reserve(U_PSEUDO_OBJ *po, size_t Size){
+   size_t newSize;
+   char  *newData;
+   if(!po){                                     return(0); }
+   if(Size > SIZE_MAX - po->Used){              return(0); }
+   if(po->Data && po->Used + Size <= po->Size){ return(1); }
+   newSize = (po->Data ? po->Size : 0);
+   newSize = (newSize > SIZE_MAX/2 ? SIZE_MAX : 2*newSize);
+   if(newSize < po->Used + Size){ newSize = po->Used + Size; }
+   if(!newSize){                  newSize = 1;               }
+   newData = realloc(po->Data, newSize);
+   if(!newData){                                return(0); }
+   po->Data = newData;
+   po->Size = newSize;
+   return(1);
+}
+
 /**
     \brief Append data to a U_PSEUDO_OBJ object and return it
     \returns pointer to the U_PSEUDO_OBJ object, NULL on error
@@ -536,16 +733,8 @@ U_PSEUDO_OBJ *U_PO_create(char *Data, size_t Size, size_t Use, uint32_t Type){
 U_PSEUDO_OBJ *U_PO_append(U_PSEUDO_OBJ *po, const char *Data, size_t Size){
    /* po cannot be NULL,as in U_PO_po_append(), because there would be no way to determine the TYPE of the resulting PO */
    if(po){
-      if(!po->Data || po->Used + Size > po->Size){
-         po->Size = po->Used + Size;
-         char *newData = realloc(po->Data, po->Size);
-         if(!newData){
-            po->Size -= Size; /* put it back the way it was*/
-            po=NULL;          /* skip the rest of the actions, does not affect po in caller */
-         }
-         else {
-            po->Data = newData;
-         }
+      if(!U_PO_reserve(po, Size)){
+         po=NULL;          /* skip the rest of the actions, does not affect po in caller */
       }
       if(po){ /* po->Data ready to append new data */
          if(Data){ memcpy(po->Data + po->Used, Data, Size); }
@@ -574,15 +763,9 @@ U_PSEUDO_OBJ *U_PO_po_append(U_PSEUDO_OBJ *po, U_PSEUDO_OBJ *Src, int StripE){
       ipo = U_PO_create(NULL, 0, 0, Src->Type); /* create an empty pseudoobject */
    }
    if(ipo){
-      if(!ipo->Data || ipo->Used + Size > ipo->Size){
-         ipo->Size = ipo->Used + Size;
-         char *newData = realloc(ipo->Data, ipo->Size);
-         if(!newData){
-            if(ipo != po)U_PO_free(&ipo);
-         }
-         else {
-            ipo->Data = newData;
-         }
+      if(!U_PO_reserve(ipo, Size)){
+         if(ipo != po){ U_PO_free(&ipo); }
+         else {         ipo = NULL;      }
       }
       if(ipo){
          if(Data){
@@ -610,6 +793,22 @@ int U_PO_free(U_PSEUDO_OBJ **po){
    return(1);
 }
 
+//! \cond
+/*  Copy the data fields of one U_SERIAL_DESC element to Dst in its target byte order, returns the position after them.
+    Used by U_PMF_SERIAL_set() and U_PMR_SERIAL_write(), which have already checked the element. */
+static char *pmf_serial_put(char *Dst, const U_SERIAL_DESC *lptr){
+   char   *hptr  = Dst;
+   size_t  FSize = lptr->Units * lptr->Reps;
+   if(lptr->TE & U_RP){  U_PMF_REPCPY_DSTSHIFT(&Dst, lptr->Ptr, lptr->Units, lptr->Reps); }
+   else {                U_PMF_MEMCPY_DSTSHIFT(&Dst, lptr->Ptr, FSize);                   }
+   if(((lptr->TE & U_LE) && U_IS_BE) || ((lptr->TE & U_BE) && U_IS_LE)){
+      if(lptr->Units==2){      U_swap2(hptr,lptr->Reps); }
+      else if(lptr->Units==4){ U_swap4(hptr,lptr->Reps); }
+   }
+   return(Dst);
+}
+//! \endcond
+
 /** \brief create a PseudoObject with data in the correct byte order for an EMF+ file.
     \returns The PseudoObject on success, NULL on error.
 
@@ -647,7 +846,6 @@ U_PSEUDO_OBJ *U_PMF_SERIAL_set(uint32_t Type, const U_SERIAL_DESC *List){
    size_t               Total=0;
    size_t               FSize;
    char                *cptr;
-   char                *hptr;
    const U_SERIAL_DESC *lptr;
    if(!List)return(NULL);
    for(lptr=List; lptr->TE != U_XX; lptr++){
@@ -659,21 +857,62 @@ U_PSEUDO_OBJ *U_PMF_SERIAL_set(uint32_t Type, const U_SERIAL_DESC *List){
    if(po){
       cptr = po->Data;
       for(lptr=List; lptr->TE != U_XX; lptr++){
-         FSize = lptr->Units * lptr->Reps;
-         if(FSize){ /* Ptr is not NULL, that would have been detected already */
-            hptr = cptr;
-            if(lptr->TE & U_RP){  U_PMF_REPCPY_DSTSHIFT(&cptr, lptr->Ptr, lptr->Units, lptr->Reps); }
-            else {                U_PMF_MEMCPY_DSTSHIFT(&cptr, lptr->Ptr, FSize);                   }
-            if(((lptr->TE & U_LE) && U_IS_BE) || ((lptr->TE & U_BE) && U_IS_LE)){
-               if(lptr->Units==2){      U_swap2(hptr,lptr->Reps); }
-               else if(lptr->Units==4){ U_swap4(hptr,lptr->Reps); }
-            }
-         }
+         if(lptr->Units * lptr->Reps != 0){ cptr = pmf_serial_put(cptr, lptr); }
       }
    }
    return(po);
 }
 
+/**
+    \brief  Write one EMF+ record, described by a list of its parts, to the EMF output file
+    \return 1 on success, 0 on error.
+    \param  Type   EMF+ record type, like U_PMR_DRAWLINES (the record type, NOT the PseudoObject Type)
+    \param  Flags  Flags for the record's U_PMF_CMN_HDR
+    \param  List   an array of U_SERIAL_DESC structures describing the record's data, not including the U_PMF_CMN_HDR
+    \param  et     EMFTRACK used to write records to EMF file
+
+    This is U_PMR_CMN_HDR_set(), U_PMF_SERIAL_set(), and U_PMR_write() in one step.  The U_EMRCOMMENT header,
+    the EMF+ header, and the data are written straight into the EMF output buffer (see emf_append_space()),
+    so no PseudoObjects are created and the data is copied once.  List follows the rules given for U_PMF_SERIAL_set().
+    If U_PMR_pack() was called the record may be added to the end of the preceding U_EMRCOMMENT instead.
+    On error nothing is written.
+*/
+int U_PMR_SERIAL_write(uint32_t Type, uint16_t Flags, const U_SERIAL_DESC *List, EMFTRACK *et){
+   size_t                Off;
+   size_t                FSize;
+   size_t                Total = 0;
+   uint32_t              DataSize;
+   uint32_t              Size;
+   uint16_t              utmp16;
+   char                 *rec;
+   const U_SERIAL_DESC  *lptr;
+   if(!List || !et)return(0);
+   for(lptr=List; lptr->TE != U_XX; lptr++){  /* sizes only, so that the record can be placed, see U_PMR_pack() */
+      FSize = lptr->Units * lptr->Reps;
+      if(!FSize && lptr->Ptr)return(0);
+      Total += FSize;
+   }
+   if(Total > UINT32_MAX - 64)return(0);
+   DataSize = Total;
+   Size     = 12 + UP4(DataSize);  /* PMR records must be a multiple of 4 */
+   if(!(rec = pmr_comment_space(et, Type, Size, &Off)))return(0);
+
+   utmp16 = Type | U_PMR_RECFLAG;
+   const U_SERIAL_DESC Hdr[] = {
+      {&utmp16,   2, 1, U_LE},
+      {&Flags,    2, 1, U_LE},    /* same as U_PMR_CMN_HDR_set() */
+      {&Size,     4, 1, U_LE},
+      {&DataSize, 4, 1, U_LE},
+      {NULL,0,0,U_XX}
+   };
+   char *cptr = rec + Off;
+   for(lptr=Hdr;  lptr->TE != U_XX; lptr++){ cptr = pmf_serial_put(cptr, lptr); }
+   for(lptr=List; lptr->TE != U_XX; lptr++){
+      if(lptr->Units * lptr->Reps != 0){ cptr = pmf_serial_put(cptr, lptr); }
+   }
+   return(pmr_comment_commit(et, rec, Off, 12 + DataSize));
+}
+
 /**
     \brief Create U_DPSEUDO_OBJ's for the Points and Types of a path
     \param Elements Number of elements in Points.  May be zero, which creates an empty path.
@@ -740,6 +979,71 @@ int U_DPO_clear(U_DPSEUDO_OBJ *dpo){
    return(1);
 }
 
+//! \cond
+/*  Append Elements points and their PathPointType bytes to a path, writing them directly into the path's
+    PseudoObjects.  The types are taken from Types if it is not NULL, otherwise First is used for the first point
+    and Others for the rest.  Nothing is changed on error.  Returns 1 on success, 0 on error.
+*/
+static int path_append(U_DPSEUDO_OBJ *Path, uint32_t Elements, const U_PMF_POINTF *Points, const uint8_t *Types, uint8_t First, uint8_t Others){
+   char *dst;
+   if(!Path || !Path->poPoints || !Path->poTypes || !Points){ return(0); }
+   if(Elements > UINT32_MAX - Path->Elements){                 return(0); }
+   if(!U_PATH_reserve(Path, Elements)){                        return(0); }
+
+   dst = Path->poPoints->Data + Path->poPoints->Used;
+   memcpy(dst, Points, Elements * sizeof(U_PMF_POINTF));
+   if(U_IS_BE){ U_swap4(dst, 2*Elements); } /* stored LE */
+   Path->poPoints->Used += Elements * sizeof(U_PMF_POINTF);
+
+   dst = Path->poTypes->Data + Path->poTypes->Used;
+   if(Types){ memcpy(dst, Types, Elements); }
+   else {
+      dst[0] = First;
+      if(Elements > 1){ memset(dst + 1, Others, Elements - 1); }
+   }
+   Path->poTypes->Used += Elements;
+
+   Path->Elements += Elements;
+   return(1);
+}
+//! \endcond
+
+/**
+    \brief Make room in a path for Elements more points, so that appending them does not need to reallocate
+    \param Path      Address of a DoublePseudoObject holding the path.
+    \param Elements  Number of points which will be appended.
+    \returns 1 on success, 0 on error.
+*/
+int U_PATH_reserve(U_DPSEUDO_OBJ *Path, uint32_t Elements){
+   size_t Bytes = (size_t) Elements * sizeof(U_PMF_POINTF);
+   if(!Path || !Path->poPoints || !Path->poTypes){                               return(0); }
+   if(Bytes / sizeof(U_PMF_POINTF) != Elements){                                 return(0); }  // overflow, only possible with a 32 bit size_t
+   if(!U_PO_reserve(Path->poPoints, Bytes)){                                     return(0); }
+   if(!U_PO_reserve(Path->poTypes,  Elements)){                                  return(0); }
+   return(1);
+}
+
+/**
+    \brief Append a set of points with their PathPointType bytes to a path.
+    \param Path      Address of a DoublePseudoObject holding the path to append to.
+    \param Elements  number of Points and Types
+    \param Points    Points, in native byte order.
+    \param Types     PathPointType bytes, one per point, lower 4 bits hold the PathPointType enumeration, upper 4 bits hold the PathPointType flags.
+    \returns 1 on success, 0 on error.  On error the path is unchanged.
+    
+    This is the fastest way to build a long path, the points and types are copied straight into the path.
+    If the path is empty, or its last point closes a subpath, the first type must be U_PPT_Start.
+*/
+int U_PATH_append(U_DPSEUDO_OBJ *Path, uint32_t Elements, const U_PMF_POINTF *Points, const uint8_t *Types){
+   if(!Path || !Points || !Types || !Path->poTypes){ return(0); }
+   if(!Elements){ return(1); } /* harmless - do nothing */
+   if((Types[0] & U_PPT_MASK) != U_PPT_Start){
+      if(!Path->Elements){                                                     return(0); }
+      if(Path->poTypes->Data[Path->Elements - 1] & U_PTP_CloseSubpath){        return(0); }
+   }
+   return(path_append(Path, Elements, Points, Types, 0, 0));
+}
+
 /**
     \brief Append a "moveto" point to a path
     \param Path   Address of a DoublePseudoObject holding the path to append to.
@@ -749,27 +1053,8 @@ int U_DPO_clear(U_DPSEUDO_OBJ *dpo){
 */
 int U_PATH_moveto(U_DPSEUDO_OBJ *Path, U_PMF_POINTF Point, uint8_t Flags){
    if(!Path){ return(0); }
-   U_PSEUDO_OBJ *tpo;
-   U_PSEUDO_OBJ *tpo2;
    uint8_t Type = (Flags & U_PTP_NotClose) | U_PPT_Start;
-
-   tpo = U_PMF_POINTF_set(1, &Point);
-   if(!tpo){ return(0); }
-   tpo2 = U_PO_po_append(Path->poPoints, tpo, U_PMF_DROP_ELEMENTS);
-   U_PO_free(&tpo);
-   if(!tpo2)return(0);
-   Path->poPoints = tpo2;
-   
-
-   tpo  = U_PMF_PATHPOINTTYPE_set(1, &Type);
-   if(!tpo){ return(0); }
-   tpo2= U_PO_po_append(Path->poTypes, tpo, U_PMF_DROP_ELEMENTS);
-   U_PO_free(&tpo);
-   if(!tpo2)return(0);
-   Path->poTypes = tpo2;
-
-   Path->Elements++;
-   return(1);
+   return(path_append(Path, 1, &Point, NULL, Type, Type));
 }
 
 /**
@@ -782,26 +1067,8 @@ int U_PATH_moveto(U_DPSEUDO_OBJ *Path, U_PMF_POINTF Point, uint8_t Flags){
 int U_PATH_lineto(U_DPSEUDO_OBJ *Path,  U_PMF_POINTF Point, uint8_t Flags){
    if(!Path || !Path->Elements){ return(0); }  /* must be at least one point to extend from */
    if(Path->poTypes->Data[Path->Elements - 1] & U_PTP_CloseSubpath){ return(0); }  /* cannot extend a closed subpath */
-   U_PSEUDO_OBJ *tpo;
-   U_PSEUDO_OBJ *tpo2;
    uint8_t Type = (Flags & U_PTP_NotClose) | U_PPT_Line;
-   tpo = U_PMF_POINTF_set(1, &Point);
-   if(!tpo){ return(0); }
-   tpo2 = U_PO_po_append(Path->poPoints, tpo, U_PMF_DROP_ELEMENTS);
-   U_PO_free(&tpo);
-   if(!tpo2)return(0);
-   Path->poPoints  = tpo2;
-   
-
-   tpo  = U_PMF_PATHPOINTTYPE_set(1, &Type);
-   if(!tpo){ return(0); }
-   tpo2 = U_PO_po_append(Path->poTypes, tpo, U_PMF_DROP_ELEMENTS);
-   U_PO_free(&tpo);
-   if(!tpo2)return(0);
-   Path->poTypes  = tpo2;
-
-   Path->Elements++;
-   return(1);
+   return(path_append(Path, 1, &Point, NULL, Type, Type));
 }
 
 /**
@@ -810,7 +1077,7 @@ int U_PATH_lineto(U_DPSEUDO_OBJ *Path,  U_PMF_POINTF Point, uint8_t Flags){
     \returns 1 on success, 0 on error.
 */
 int U_PATH_closepath(U_DPSEUDO_OBJ *Path){
-   if(!Path || !Path->poTypes){ return(0); }
+   if(!Path || !Path->poTypes || !Path->Elements){ return(0); }
    uint32_t Elements = Path->Elements;
    uint8_t  *Type    = (uint8_t *)(Path->poTypes->Data) + Elements - 1;
    if(*Type & U_PPT_Start){ return(0); } /* single point closed path makes no sense */
@@ -830,28 +1097,12 @@ int U_PATH_closepath(U_DPSEUDO_OBJ *Path){
 int U_PATH_polylineto(U_DPSEUDO_OBJ *Path, uint32_t Elements, const U_PMF_POINTF *Points, uint8_t Flags, uint8_t StartSeg){
    if(!Path || !Points){ return(0); }
    if(!Elements){ return(1); } /* harmless - do nothing */
-   U_PSEUDO_OBJ *tpo;
-   U_PSEUDO_OBJ *tpo2;
    uint8_t First, Others;
 
-   tpo = U_PMF_POINTF_set(Elements, Points);
-   tpo2 = U_PO_po_append(Path->poPoints, tpo, U_PMF_DROP_ELEMENTS);
-   U_PO_free(&tpo);
-   if(!tpo2)return(0);
-   Path->poPoints = tpo2;
-   
    if(StartSeg){ First  = (Flags & U_PTP_NotClose) | U_PPT_Start; }
    else {        First  = (Flags & U_PTP_NotClose) | U_PPT_Line;  }
                  Others = (Flags & U_PTP_NotClose) | U_PPT_Line;  
-   tpo  = U_PMF_PATHPOINTTYPE_set2(Elements, First, Others);
-   if(!tpo){ return(0); }
-   tpo2 = U_PO_po_append(Path->poTypes, tpo, U_PMF_DROP_ELEMENTS);
-   U_PO_free(&tpo);
-   if(!tpo2)return(0);
-   Path->poTypes = tpo2;
-
-   Path->Elements += Elements;
-   return(1);
+   return(path_append(Path, Elements, Points, NULL, First, Others));
 }
 
 
@@ -876,28 +1127,12 @@ int U_PATH_polybezierto(U_DPSEUDO_OBJ *Path, uint32_t Elements, const U_PMF_POIN
    }
    if(StartSeg  && ((Elements - 1) % 3)){ return(0); }    /* new segment    must be 1 + N*3 points */
    if(!StartSeg && (Elements % 3)){       return(0); }    /* extend segment must be     N*3 points */
-   U_PSEUDO_OBJ *tpo;
-   U_PSEUDO_OBJ *tpo2;
    uint8_t First, Others;
 
-   tpo = U_PMF_POINTF_set(Elements, Points);
-   tpo2 = U_PO_po_append(Path->poPoints, tpo, U_PMF_DROP_ELEMENTS);
-   U_PO_free(&tpo);
-   if(!tpo2)return(0);
-   Path->poPoints = tpo2;
- 
    if(StartSeg){ First  = (Flags & U_PTP_NotClose) | U_PPT_Start;  }
    else {        First  = (Flags & U_PTP_NotClose) | U_PPT_Bezier; }
                  Others = (Flags & U_PTP_NotClose) | U_PPT_Bezier;
-   tpo  = U_PMF_PATHPOINTTYPE_set2(Elements, First, Others);
-   if(!tpo){ return(0); }
-   tpo2 = U_PO_po_append(Path->poTypes, tpo, U_PMF_DROP_ELEMENTS);
-   U_PO_free(&tpo);
-   if(!tpo2)return(0);
-   Path->poTypes = tpo2;
-
-   Path->Elements += Elements;
-   return(1);
+   return(path_append(Path, Elements, Points, NULL, First, Others));
 }
 
 /**
@@ -1030,6 +1265,28 @@ int U_PATH_arcto(U_DPSEUDO_OBJ *Path, U_FLOAT Start, U_FLOAT Sweep, U_FLOAT Rot,
    return(1);
 }
 
+/**
+    \brief Transform an array of U_PMF_POINTF with a U_XFORM into a caller supplied array, or in place, optionally finding their bounds
+    in the same pass.  The results are the same as from pointfs_transform().
+    \return 1 on success, 0 on error.
+    \param Src     source U_PMF_POINTF structures
+    \param Dst     transformed U_PMF_POINTF structures, may be the same as Src
+    \param Count   number of members in Src
+    \param Xform   U_XFORM to apply
+    \param Bounds  if not NULL, receives the rectangle holding the transformed points
+*/
+int pointfs_transform_into(const U_PMF_POINTF *Src, U_PMF_POINTF *Dst, int Count, U_XFORM Xform, U_PMF_RECTF *Bounds){
+   double b[4];
+   if(U_xform_pairs(Src, Dst, Count, U_XF_POINTF, Xform, (Bounds ? b : NULL)))return(0);
+   if(Bounds){
+      Bounds->X      = b[0];
+      Bounds->Y      = b[1];
+      Bounds->Width  = b[2] - b[0];
+      Bounds->Height = b[3] - b[1];
+   }
+   return(1);
+}
+
 /**
     \brief Allocate and construct an array of U_PMF_POINTF objects which have been subjected to a U_XFORM
     \returns pointer to an array of U_PMF_POINTF structures.
@@ -1040,20 +1297,32 @@ int U_PATH_arcto(U_DPSEUDO_OBJ *Path, U_FLOAT Start, U_FLOAT Sweep, U_FLOAT Rot,
 */
 U_PMF_POINTF *pointfs_transform(U_PMF_POINTF *points, int count, U_XFORM xform){
    U_PMF_POINTF *newpts=NULL;;
-   int i;
-   float X,Y;
    newpts = (U_PMF_POINTF *) malloc(count * sizeof(U_PMF_POINTF));
-   if(newpts){
-      for(i=0; i<count; i++){
-         X = points[i].X;
-         Y = points[i].Y;
-         newpts[i].X = U_ROUND(X * xform.eM11 + Y * xform.eM21 + xform.eDx);
-         newpts[i].Y = U_ROUND(X * xform.eM12 + Y * xform.eM22 + xform.eDy);
-      }
-   }
+   if(newpts)(void) pointfs_transform_into(points, newpts, count, xform, NULL);
    return(newpts);
 }
 
+/**
+    \brief Transform an array of U_PMF_RECTF with a U_XFORM into a caller supplied array, or in place.
+    The results are the same as from rectfs_transform().
+    \return 1 on success, 0 on error.
+    \param Src     source U_PMF_RECTF structures
+    \param Dst     transformed U_PMF_RECTF structures, may be the same as Src
+    \param Count   number of members in Src
+    \param Xform   U_XFORM to apply.  Rotation is ignored, only translation is applied.
+*/
+int rectfs_transform_into(const U_PMF_RECTF *Src, U_PMF_RECTF *Dst, int Count, U_XFORM Xform){
+   int i;
+   if(!Src || !Dst || Count < 0)return(0);
+   for(i=0; i<Count; i++){
+      Dst[i].X      = U_ROUND(Src[i].X + Xform.eDx);
+      Dst[i].Y      = U_ROUND(Src[i].Y + Xform.eDy);
+      Dst[i].Width  = U_ROUND(Src[i].Width);
+      Dst[i].Height = U_ROUND(Src[i].Height);
+   }
+   return(1);
+}
+
 /**
     \brief Allocate and construct an array of U_PMF_RECTF objects which have been subjected to a U_XFORM
     \returns pointer to an array of U_PMF_RECTF structures.
@@ -1064,16 +1333,8 @@ U_PMF_POINTF *pointfs_transform(U_PMF_POINTF *points, int count, U_XFORM xform){
 */
 U_PMF_RECTF *rectfs_transform(U_PMF_RECTF *Rects, int Count, U_XFORM Xform){
    U_PMF_RECTF *newRects;
-   int i;
    newRects = (U_PMF_RECTF *) malloc(Count * sizeof(U_PMF_RECTF));
-   if(newRects){
-      for(i=0; i<Count; i++){
-         newRects[i].X      = U_ROUND(Rects[i].X + Xform.eDx);
-         newRects[i].Y      = U_ROUND(Rects[i].Y + Xform.eDy);
-         newRects[i].Width  = U_ROUND(Rects[i].Width);
-         newRects[i].Height = U_ROUND(Rects[i].Height);
-      }
-   }
+   if(newRects)(void) rectfs_transform_into(Rects, newRects, Count, Xform);
    return(newRects);
 }
 
@@ -1796,6 +2057,63 @@ U_PSEUDO_OBJ *U_PMF_PATH_set3(uint32_t Version, const U_DPSEUDO_OBJ *Path){
    return(po);
 }
 
+/**
+    \brief  Create and set a U_PMF_PATH PseudoObject using the smallest coordinate encoding which holds the points exactly
+    \return Pointer to PseudoObject, NULL on error
+    \param  Version    EmfPlusGraphicsVersion object
+    \param  Path       U_DPSEUDO_OBJ containing a path.
+    \param  AllowRel   If set, relative U_PMF_POINTR coordinates may be used.
+
+    Uses U_PMF_POINT (int 16) coordinates, or relative U_PMF_POINTR coordinates, when every coordinate is an integer in the int16
+    range, otherwise U_PMF_POINTF coordinates as U_PMF_PATH_set2() does.  See U_PMF_POINTS_set().
+
+    EMF+ manual 2.2.1.6, Microsoft name: EmfPlusPath Object
+*/
+U_PSEUDO_OBJ *U_PMF_PATH_set4(uint32_t Version, const U_DPSEUDO_OBJ *Path, int AllowRel){
+   if(!Path || !Path->Elements){return(NULL);  }
+   const U_PMF_POINTF *Points = (const U_PMF_POINTF *)Path->poPoints->Data;
+   U_PMF_POINTF       *Native = NULL;
+   U_PSEUDO_OBJ       *po     = NULL;
+   char               *Coded;
+   size_t              Bytes;
+   uint32_t            Enc;
+   uint16_t            Flags;
+   int                 pad;
+   if(U_BYTE_SWAP){ /* path points are stored LE */
+      Native = (U_PMF_POINTF *) malloc(Path->Elements * sizeof(U_PMF_POINTF));
+      if(!Native){ return(NULL); }
+      memcpy(Native, Points, Path->Elements * sizeof(U_PMF_POINTF));
+      U_swap4(Native, 2*Path->Elements);
+      Points = Native;
+   }
+   Enc = points_encoding(Path->Elements, Points, AllowRel, &Bytes);
+   if(Enc == U_PMF_POINTF_OID){
+      free(Native);
+      return(U_PMF_PATH_set2(Version, Path));
+   }
+   Coded = (char *) malloc(Bytes);
+   if(Coded){
+      if(Enc == U_PMF_POINTR_OID){ (void) pointr_encode( Coded, Path->Elements, Points); Flags = U_PPF_P; }
+      else {                       (void) point16_encode(Coded, Path->Elements, Points); Flags = U_PPF_C; }
+      pad = (0x3 & (Bytes + Path->Elements));
+      if(pad){ pad = 4 - pad; }
+      const U_SERIAL_DESC List[] = {
+         {&Version,               4,                1,               U_LE               },
+         {&Path->Elements,        4,                1,               U_LE               },
+         {&Flags,                 2,                1,               U_LE               },
+         {NULL,                   2,                1,               U_LE               }, /*  Reserved field */
+         {Coded,                  Bytes,            1,               U_XE               }, /*  already in file byte order */
+         {Path->poTypes->Data,    1,                Path->Elements,  U_XE               }, /*  raw data, so no leading Elements to omit */
+         {NULL,                   pad,              (pad ? 1 : 0),   (pad ? U_XE : U_XX)}, /* if no padding is needed the Units will be zero and nothing will happen */
+         {NULL,0,0,U_XX}
+      };
+      po = U_PMF_SERIAL_set(U_PMF_PATH_OID, List);
+      free(Coded);
+   }
+   free(Native);
+   return(po);
+}
+
 /**
     \brief  Create and set a U_PMF_PEN PseudoObject
     \return Pointer to PseudoObject, NULL on error
@@ -3064,57 +3382,60 @@ U_PSEUDO_OBJ *U_PMF_POINTF_set(uint32_t Elements, const U_PMF_POINTF *Coords){
     \param  Elements     Number of pairs of points in Coords
     \param  Coords       Array of X,Y pairs.  These are absolute coordinates, they are converted to Relative here.
 
+    Coordinates are rounded to integers.  An offset from one point to the next which does not fit in a U_PMF_INTEGER15
+    (-16384 to 16383) saturates.
+
     EMF+ manual 2.2.2.37, Microsoft name: EmfPlusPointR Object
 */
 U_PSEUDO_OBJ *U_PMF_POINTR_set(uint32_t Elements, const U_PMF_POINTF *Coords){
-   int X,Y;
-   U_FLOAT Xf,Yf;
-   U_PSEUDO_OBJ *poi;
    /* Worst case scenario it is 4 bytes per coord, plus the count  */
-   U_PSEUDO_OBJ *po =  U_PO_create(NULL, 4 + 4*Elements, 0, U_PMF_POINTR_OID); /* not exactly an array, so no U_PMF_ARRAY_OID */
-   U_PSEUDO_OBJ *holdpo = po;
-   if(!po)goto end;
-
-   poi = U_PMF_4NUM_set(Elements);
-   po = U_PO_append(po, poi->Data, poi->Used);      
-   U_PO_free(&poi);
-   if(!po)goto end;
-
-   for(Xf = Yf = 0.0 ;Elements; Elements--, Coords++){
-      Xf = U_ROUND(Coords->X) - Xf;
-      Yf = U_ROUND(Coords->Y) - Yf;
-      X = ( Xf >= UINT16_MAX ? UINT16_MAX : ( Xf <= INT16_MIN ? INT16_MIN : Xf));
-      Y = ( Yf >= UINT16_MAX ? UINT16_MAX : ( Yf <= INT16_MIN ? INT16_MIN : Yf));
-      Xf = U_ROUND(Coords->X);
-      Yf = U_ROUND(Coords->Y);
-      
-      /* this is not a very efficient method, too much mucking around with memory */
-
-      poi = U_PMF_INTEGER7_set(X);
-      if(!poi)poi = U_PMF_INTEGER15_set(X); /* This one must work because of the range checking, above */
-      po = U_PO_append(po, poi->Data, poi->Used);      
-      U_PO_free(&poi);
-      if(!po)goto end;
-
-      poi = U_PMF_INTEGER7_set(Y);
-      if(!poi)poi = U_PMF_INTEGER15_set(Y); /* This one must work because of the range checking, above */
-      po = U_PO_append(po, poi->Data, poi->Used);      
-      U_PO_free(&poi);
-      if(!po)goto end;
-   }
+   size_t Bytes = 4 + 4*(size_t)Elements;
+   if(Elements && !Coords){                     return(NULL); }
+   if((Bytes - 4)/4 != Elements){               return(NULL); }  // overflow, only possible with a 32 bit size_t
+   U_PSEUDO_OBJ *po =  U_PO_create(NULL, Bytes, 0, U_PMF_POINTR_OID); /* not exactly an array, so no U_PMF_ARRAY_OID */
+   if(!po){                                     return(NULL); }
+   memcpy(po->Data, &Elements, 4);
+   if(U_BYTE_SWAP){ U_swap4(po->Data, 1); }
+   po->Used = pointr_encode(po->Data + 4, Elements, Coords) - po->Data;
    /* Because the values stored were some unpredictable combination of 1 and 2 bytes, the last byte may not end
-   on a 4 byte boundary.  Make it do so by padding with up to 3 zero bytes.  */
+   on a 4 byte boundary.  Make it do so by padding with up to 3 zero bytes, which U_PO_create() already cleared.  */
+   po->Used = (po->Used + 3) & ~(size_t) 3;
+   return(po);
+}
 
-   int residual;
-   residual = 3 & po->Used;
-   if(residual){ 
-      po = U_PO_append(po, NULL, (4 - residual));
-      if(!po)goto end;     
-   }
+/**
+    \brief  Create and set an ARRAY of points in the smallest encoding which holds them exactly
+    \return Pointer to PseudoObject, NULL on error
+    \param  Elements     Number of pairs of points in Coords
+    \param  Coords       Array of X,Y pairs, absolute coordinates.
+    \param  AllowRel     If set, relative U_PMF_POINTR coordinates may be used.  Only some records accept them, see the record's _set function.
 
-end:
-   if(!po)U_PO_free(&holdpo);
-   return(holdpo);
+    The result is what U_PMF_POINT_set(), U_PMF_POINTR_set(), or U_PMF_POINTF_set() would produce, and may be passed to any
+    record _set function which accepts all of those, which then sets the U_PPF_C and U_PPF_P flags to match.  Points whose
+    coordinates are all integers in the int16 range take 4 bytes each as U_PMF_POINT, or usually 2-3 bytes each as
+    U_PMF_POINTR when neighboring points are close together, instead of 8 bytes as U_PMF_POINTF.
+*/
+U_PSEUDO_OBJ *U_PMF_POINTS_set(uint32_t Elements, const U_PMF_POINTF *Coords, int AllowRel){
+   size_t        Bytes;
+   U_PSEUDO_OBJ *po;
+   if(!Elements || !Coords){ return(NULL); }
+   switch(points_encoding(Elements, Coords, AllowRel, &Bytes)){
+      case U_PMF_POINTR_OID:
+         po = U_PMF_POINTR_set(Elements, Coords);
+         break;
+      case U_PMF_POINT_OID:
+         po = U_PO_create(NULL, 4 + Bytes, 4 + Bytes, U_PMF_POINT_OID | U_PMF_ARRAY_OID);
+         if(po){
+            memcpy(po->Data, &Elements, 4);
+            if(U_BYTE_SWAP){ U_swap4(po->Data, 1); }
+            (void) point16_encode(po->Data + 4, Elements, Coords);
+         }
+         break;
+      default:
+         po = U_PMF_POINTF_set(Elements, Coords);
+         break;
+   }
+   return(po);
 }
 
 /**
@@ -4326,6 +4647,29 @@ U_PSEUDO_OBJ *U_PMR_DRAWLINES_set(uint32_t PenID, int dtype, const U_PSEUDO_OBJ
    return(po);
 }
 
+/**
+    \brief  Write a U_PMR_DRAWLINES record directly to the EMF output file, see U_PMR_SERIAL_write()
+    \return 1 on success, 0 on error.
+    \param  PenID       U_PMF_PEN object in the EMF+ object table (0-63, inclusive)
+    \param  dtype       Set: path must be closed, Clear: path is open
+    \param  Elements    Number of members in Points, must be at least 1
+    \param  Points      Array of U_PMF_POINTF, stored as absolute floating point coordinates
+    \param  et          EMFTRACK used to write records to EMF file
+
+    Writes the same record as U_PMR_DRAWLINES_set() given a U_PMF_POINTF array, without creating any PseudoObjects.
+*/
+int U_PMR_DRAWLINES_write(uint32_t PenID, int dtype, uint32_t Elements, const U_PMF_POINTF *Points, EMFTRACK *et){
+   if(PenID>63){                                                      return(0); }
+   if(!Elements || !Points || Elements > UINT32_MAX/8 - 1){          return(0); }
+   uint16_t utmp16 =  (dtype ? U_PPF_D : 0) | (PenID & U_FF_MASK_OID8) << U_FF_SHFT_OID8;
+   const U_SERIAL_DESC List[] = {
+      {&Elements,  4, 1,            U_LE},
+      {Points,     4, 2*Elements,   U_LE},
+      {NULL,0,0,U_XX}
+   };
+   return(U_PMR_SERIAL_write(U_PMR_DRAWLINES, utmp16, List, et));
+}
+
 /**
     \brief  Create and set a U_PMR_DRAWPATH PseudoObject
     \return Pointer to PseudoObject, NULL on error
@@ -4664,6 +5008,30 @@ U_PSEUDO_OBJ *U_PMR_FILLPOLYGON_set(const U_PSEUDO_OBJ *BrushID, const U_PSEUDO_
    return(po);
 }
 
+/**
+    \brief  Write a U_PMR_FILLPOLYGON record directly to the EMF output file, see U_PMR_SERIAL_write()
+    \return 1 on success, 0 on error.
+    \param  Color       Solid fill color, or NULL to fill with BrushID
+    \param  BrushID     U_PMF_BRUSH object in the EMF+ object table (0-63, inclusive), ignored if Color is not NULL
+    \param  Elements    Number of members in Points, must be at least 1
+    \param  Points      Array of U_PMF_POINTF, stored as absolute floating point coordinates
+    \param  et          EMFTRACK used to write records to EMF file
+
+    Writes the same record as U_PMR_FILLPOLYGON_set() given a U_PMF_POINTF array, without creating any PseudoObjects.
+*/
+int U_PMR_FILLPOLYGON_write(const U_PMF_ARGB *Color, uint32_t BrushID, uint32_t Elements, const U_PMF_POINTF *Points, EMFTRACK *et){
+   if(!Color && BrushID>63){                                          return(0); }
+   if(!Elements || !Points || Elements > UINT32_MAX/8 - 2){          return(0); }
+   uint16_t utmp16 =  (Color ? U_PPF_B : 0);
+   const U_SERIAL_DESC List[] = {
+      {(Color ? (const void *) Color : (const void *) &BrushID),  4, 1, (Color ? U_XE : U_LE)},
+      {&Elements,  4, 1,            U_LE},
+      {Points,     4, 2*Elements,   U_LE},
+      {NULL,0,0,U_XX}
+   };
+   return(U_PMR_SERIAL_write(U_PMR_FILLPOLYGON, utmp16, List, et));
+}
+
 /**
     \brief  Create and set a U_PMR_FILLRECTS PseudoObject
     \return Pointer to PseudoObject, NULL on error
@@ -5505,6 +5873,63 @@ int U_PMF_IMAGE_get(const char *contents, uint32_t *Version, uint32_t *Type, con
     return(1);
 }
 
+/**
+    \brief Describe the image in a U_PMF_IMAGE object without decoding it
+    \return 1 on success, 0 on error
+    \param  contents   Record from which to extract data
+    \param  id         receives the description, which points into the record
+    \param  blimit     one byte past the end of data
+
+    Compressed bitmaps (PNG, JPEG, GIF, etc.) are described by image_desc_data().  Uncompressed bitmaps are
+    U_IMG_PMFPIXELS, with the bit count from the PixelFormat and the palette, if any, in ct (U_PMF_ARGB has
+    the same layout as U_RGBQUAD).  Metafiles are U_IMG_EMF or U_IMG_WMF, with no dimensions.
+*/
+int U_PMF_IMAGE_desc(const char *contents, U_IMAGEDESC *id, const char *blimit){
+    uint32_t       Version, Type, MfType, MfSize;
+    const char    *Data, *BmData, *Colors, *Pixels;
+    U_PMF_BITMAP   Bs;
+    U_PMF_PALETTE  Ps;
+    if(!id){ return(0); }
+    memset(id, 0, sizeof(U_IMAGEDESC));
+    if(!U_PMF_IMAGE_get(contents, &Version, &Type, &Data, blimit))return(0);
+    if(Type == U_IDT_Bitmap){
+        if(!U_PMF_BITMAP_get(Data, &Bs, &BmData, blimit))return(0);
+        if(BmData >= blimit)return(0);
+        if(Bs.Type == U_BDT_Compressed){
+            (void) image_desc_data(BmData, blimit - BmData, id);
+            if(!id->width && !id->height){ id->width = Bs.Width; id->height = Bs.Height; }
+        }
+        else {
+            id->format   = U_IMG_PMFPIXELS;
+            id->width    = Bs.Width;
+            id->height   = (Bs.Height < 0 ? -Bs.Height : Bs.Height);
+            id->bitcount = (Bs.PxFormat >> 8) & 0xFF;
+            if(Bs.PxFormat & 0x00010000){  // uses a LUT, so a palette precedes the pixels
+                if(!U_PMF_BITMAPDATA_get(BmData, &Ps, &Colors, &Pixels, blimit))return(0);
+                if(Ps.Elements > 256 || IS_MEM_UNSAFE(Colors, Ps.Elements * sizeof(U_PMF_ARGB), blimit))return(0);
+                id->ct    = (const U_RGBQUAD *) Colors;
+                id->numCt = Ps.Elements;
+                BmData    = Pixels;
+            }
+            id->data   = BmData;
+            id->cbData = (BmData < blimit ? blimit - BmData : 0);
+        }
+    }
+    else if(Type == U_IDT_Metafile){
+        if(IS_MEM_UNSAFE(Data, sizeof(U_PMF_METAFILE), blimit))return(0);
+        U_PMF_SERIAL_get(&Data, &MfType, 4, 1, U_LE);
+        U_PMF_SERIAL_get(&Data, &MfSize, 4, 1, U_LE);
+        if(IS_MEM_UNSAFE(Data, MfSize, blimit))return(0);
+        id->format = ((MfType == U_MDT_Wmf || MfType == U_MDT_WmfPlaceable) ? U_IMG_WMF : U_IMG_EMF);
+        id->data   = Data;
+        id->cbData = MfSize;
+    }
+    else {
+        return(0);
+    }
+    return(1);
+}
+
 /**
     \brief Get data from a U_PMF_IMAGEATTRIBUTES object
     \return 1 on success, 0 on error
@@ -5553,8 +5978,9 @@ int U_PMF_PATH_get(const char *contents, uint32_t *Version, uint32_t *Count, uin
     contents+=2; /* reserved */
     uint32_t sizeP, sizeT;
     if(*Flags      & U_PPF_P){ 
-       sizeP  = U_PMF_LEN_REL715(contents,*Count); //DEBUG
-       printf("DEBUG U_PMF_PATH_get count:%d LENREL715:%d\n",*Count,sizeP);fflush(stdout);
+       const char *end = contents;
+       if(!U_PMF_POINTR_array_get(&end, *Count, NULL, blimit))return(0);
+       sizeP  = end - contents;
     }
     else if(*Flags & U_PPF_C){ sizeP = *Count * sizeof(U_PMF_POINT);   }
     else {                     sizeP = *Count * sizeof(U_PMF_POINTF);  }
@@ -6544,6 +6970,52 @@ int U_PMF_POINTR_get(const char **contents, U_FLOAT *X, U_FLOAT *Y, const char *
     return(size);
 }
 
+/**
+    \brief Get data from an array of U_PMF_POINTR objects, converting them to absolute coordinates
+    \return 1 on success, 0 on error
+    \param  contents   Record from which to extract data.  On success the position is advanced past the array (not past any padding).
+    \param  Elements   Number of points in the array
+    \param  Points     Array of Elements U_PMF_POINTF, receives the absolute coordinates.  May be NULL to just find the end of the array.
+    \param  blimit     one byte past the end of data
+
+    The first point is relative to 0,0, each of the others is relative to the point before it.
+
+    EMF+ manual 2.2.2.37, Microsoft name: EmfPlusPointR Object
+*/
+int U_PMF_POINTR_array_get(const char **contents, uint32_t Elements, U_PMF_POINTF *Points, const char *blimit){
+    if(!contents || !*contents || !blimit || *contents > blimit){ return(0); }
+    const uint8_t *p   = (const uint8_t *) *contents;
+    const uint8_t *end = (const uint8_t *) blimit;
+    int64_t        pos[2] = {0, 0};
+    int32_t        d;
+    int            k;
+
+    for(; Elements; Elements--){
+       for(k = 0; k < 2; k++){
+          if(p >= end){ return(0); }
+          if(*p & U_TEST_INT7){  /* U_PMF_INTEGER15, big endian */
+             if(end - p < 2){ return(0); }
+             d = ((p[0] & U_MASK_INT7) << 8) | p[1];
+             if(d & U_SIGN_INT15){ d -= 0x8000; }
+             p += 2;
+          }
+          else {                 /* U_PMF_INTEGER7 */
+             d = p[0];
+             if(d & U_SIGN_INT7){  d -= 0x80;   }
+             p += 1;
+          }
+          pos[k] += d;
+       }
+       if(Points){
+          Points->X = pos[0];
+          Points->Y = pos[1];
+          Points++;
+       }
+    }
+    *contents = (const char *) p;
+    return(1);
+}
+
 /**
     \brief Get data from a variable POINTS object, which may be U_PMF_POINTS, U_PMF_POINTF, or U_PMF_POINTR.
     \return 1 on success, 0 on error
@@ -6557,25 +7029,18 @@ int U_PMF_POINTR_get(const char **contents, U_FLOAT *X, U_FLOAT *Y, const char *
 */
 int U_PMF_VARPOINTS_get(const char *contents, uint16_t Flags, int Elements, U_PMF_POINTF **Points, const char *blimit){
    int status = 0;
-   if(!contents  || !Points || !Elements || !blimit){ return(status); }
+   if(!contents  || !Points || Elements <= 0 || !blimit){ return(status); }
    U_PMF_POINTF *pts = (U_PMF_POINTF *)malloc(Elements * sizeof(U_PMF_POINTF));
    if(!pts){ return(status); }
    *Points = pts;
    U_FLOAT XF, YF;
-   U_FLOAT XFS, YFS;
    
    if(Flags & U_PPF_P){ 
-      for(XFS = YFS = 0.0; Elements; Elements--, pts++){
-         if(!U_PMF_POINTR_get(&contents, &XF, &YF, blimit))return(0); /* this should never happen */
-         XFS      += XF; /* position relative to previous point, first point is always 0,0 */
-         YFS      += YF;
-         pts->X    = XFS;
-         pts->Y    = YFS; 
-      }
+      if(U_PMF_POINTR_array_get(&contents, Elements, pts, blimit)){ Elements = 0; }
    }
    else if(Flags & U_PPF_C){
       for(XF = YF = 0.0; Elements; Elements--, pts++){
-         if(!U_PMF_POINT_get(&contents, &XF, &XF, blimit))break; /* this should never happen */
+         if(!U_PMF_POINT_get(&contents, &XF, &YF, blimit))break; /* this should never happen */
          pts->X    = XF;
          pts->Y    = YF; 
       }
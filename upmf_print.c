@@ -118,7 +118,9 @@ int U_PMF_VARBRUSHID_print(int btype, uint32_t BrushID){
 //! \endcond
 
 /**
-    \brief Print any EMF+ record
+    \brief Print any EMF+ record.
+    Objects continued across records are tracked in a single internal U_PMF_PARSE_CTX, so this is
+    not re-entrant.  Use U_pmf_onerec_print_r() to process more than one file at a time.
     \returns record length for a normal record, 0 for EMREOF or , -1 for a bad record
     \param contents   pointer to a buffer holding this EMF+ record
     \param blimit     one byte after this EMF+ record
@@ -126,10 +128,23 @@ int U_PMF_VARBRUSHID_print(int btype, uint32_t BrushID){
     \param off        Offset from the beginning of the EMF+ file to the start of this record.
 */
 int U_pmf_onerec_print(const char *contents, const char *blimit, int recnum, int off){
+   static U_PMF_PARSE_CTX ctx={{NULL,0,0,0,0},0};
+   return(U_pmf_onerec_print_r(&ctx, contents, blimit, recnum, off));
+}
+
+/**
+    \brief Print any EMF+ record, re-entrant version of U_pmf_onerec_print().
+    \returns record length for a normal record, 0 for EMREOF or , -1 for a bad record
+    \param ctx        parse state for this file, from U_PCTX_init()
+    \param contents   pointer to a buffer holding this EMF+ record
+    \param blimit     one byte after this EMF+ record
+    \param recnum     EMF number of this record in contents
+    \param off        Offset from the beginning of the EMF+ file to the start of this record.
+*/
+int U_pmf_onerec_print_r(U_PMF_PARSE_CTX *ctx, const char *contents, const char *blimit, int recnum, int off){
    int status;
    int rstatus;
-   static  U_OBJ_ACCUM ObjCont={NULL,0,0,0,0};           /* for keeping track of object continuation. These may
-                                                            be split across multiple EMF Comment records */
+   U_OBJ_ACCUM *ObjCont;  /* for keeping track of object continuation. These may be split across multiple EMF Comment records */
    U_PMF_CMN_HDR Header;
    const char *contemp = contents;
    
@@ -137,6 +152,8 @@ int U_pmf_onerec_print(const char *contents, const char *blimit, int recnum, int
        this is either a corrupt EMF or one engineered to cause a buffer overflow.  Pointer math
        could wrap so check both sides of the range.
    */
+   if(!ctx)return(-1);
+   ObjCont = &(ctx->ObjCont);
    if(IS_MEM_UNSAFE(contents, sizeof(U_PMF_CMN_HDR), blimit))return(-1);
    if(!U_PMF_CMN_HDR_get(&contemp, &Header)){return(-1);}
 
@@ -146,8 +163,8 @@ int U_pmf_onerec_print(const char *contents, const char *blimit, int recnum, int
 
    /* Buggy EMF+ can set the continue bit and then do something else. In that case, force out the pending
       Object.  Side effect - clears the pending object. */
-   if((type != U_PMR_OBJECT) && (ObjCont.used > 0)){
-         U_PMR_OBJECT_print(contents, blimit, &ObjCont, 1);
+   if((type != U_PMR_OBJECT) && (ObjCont->used > 0)){
+         U_PMR_OBJECT_print(contents, blimit, ObjCont, 1);
    }
 
    /* Check that the record size is OK, abort if not. */
@@ -157,13 +174,13 @@ int U_pmf_onerec_print(const char *contents, const char *blimit, int recnum, int
    switch(type){  
       case (U_PMR_HEADER):                   rstatus = U_PMR_HEADER_print(contents);                       break;                     
       case (U_PMR_ENDOFFILE):                rstatus = U_PMR_ENDOFFILE_print(contents);
-                                                       U_OA_release(&ObjCont);                             break;
+                                                       U_OA_release(ObjCont);                              break;
       case (U_PMR_COMMENT):                  rstatus = U_PMR_COMMENT_print(contents);                      break;
       case (U_PMR_GETDC):                    rstatus = U_PMR_GETDC_print(contents);                        break;
       case (U_PMR_MULTIFORMATSTART):         rstatus = U_PMR_MULTIFORMATSTART_print(contents);             break;
       case (U_PMR_MULTIFORMATSECTION):       rstatus = U_PMR_MULTIFORMATSECTION_print(contents);           break;
       case (U_PMR_MULTIFORMATEND):           rstatus = U_PMR_MULTIFORMATEND_print(contents);               break;
-      case (U_PMR_OBJECT):                   rstatus = U_PMR_OBJECT_print(contents,blimit,&ObjCont,0);     break;
+      case (U_PMR_OBJECT):                   rstatus = U_PMR_OBJECT_print(contents,blimit,ObjCont,0);      break;
       case (U_PMR_CLEAR):                    rstatus = U_PMR_CLEAR_print(contents);                        break;
       case (U_PMR_FILLRECTS):                rstatus = U_PMR_FILLRECTS_print(contents);                    break;
       case (U_PMR_DRAWRECTS):                rstatus = U_PMR_DRAWRECTS_print(contents);                    break;
@@ -40,6 +40,13 @@ extern "C" {
 #include <string.h>
 #include <limits.h> // for INT_MAX, INT_MIN
 #include <math.h>   // for U_ROUND()
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h> // for wmf_mapdata()
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #if 0
 #include <windef.h>    //Not actually used, looking for collisions
 #include <winnt.h>    //Not actually used, looking for collisions
@@ -672,6 +679,7 @@ const char *U_wmr_escnames(int idx){
 /* one prototype from uwmf_endian.  Put it here because end user should never need to see it, so
 not in uemf.h or uwmf_endian.h */
 void U_swap2(void *ul, unsigned int count);
+int  wmfheader_swap(char *contents, int torev);
 
 /**
     \brief Check that the bitmap in the specified packed DIB is compatible with the record size
@@ -715,6 +723,9 @@ int packed_DIB_safe(
        }
        if(IS_MEM_UNSAFE(px, usedbytes, blimit))return(0);
    }
+   else if(dibparams == U_BI_RLE8 || dibparams == U_BI_RLE4){
+       if(IS_MEM_UNSAFE(px, numCt, blimit))return(0);  // numCt holds the size of the RLE data
+   }
    return(1);
 }
 
@@ -1158,285 +1169,276 @@ int16_t *dx16_set(
 /**
     \brief Look up the properties (a bit map) of a type of WMR record.
           Bits that may be set are defined in "Draw Properties" in uemf.h, they are U_DRAW_NOTEMPTY, etc..
-    \return bitmap of WMR record properties, or U_WMR_INVALID on error or release of all memory.
-    \param type WMR record type.  If U_WMR_INVALID release memory. (There is no U_WMR_INVALID WMR record type)
+          The table is constant, so this may be called from any thread and nothing needs to be released.
+    \return bitmap of WMR record properties, or U_WMR_INVALID if type is out of range.
+    \param type WMR record type.  (There is no U_WMR_INVALID WMR record type, passing it is harmless.)
     
 */
 uint32_t U_wmr_properties(uint32_t type){
-   static uint32_t *table=NULL;
-   uint32_t result = U_WMR_INVALID;  // initialized to indicate an error (on a lookup) or nothing (on a memory release) 
-   if(type == U_WMR_INVALID){
-      if(table)free(table);
-      table=NULL;
-   }
-   else if(type<=U_WMR_MAX){ // type is uint so always >=0, no need to test U_WMR_MIN, which is 0.
-      if(!table){
-         table = (uint32_t *) malloc(sizeof(uint32_t)*(1 + U_WMR_MAX));
-         if(!table)return(result); 
+   static const uint16_t table[1 + U_WMR_MAX] = {
    //                                                              0x200  0x100  0x80 0x40 0x20 0x10 0x08 0x04 0x02 0x01
    //                      properties (U_DRAW_*)                                 TEXT      ALTERS    ONLYTO    VISIBLE   
    //                                                              NOFILL OBJECT      PATH      FORCE     CLOSED    NOTEMPTY
    //                               Record Type
-         table[0x00] = 0x0A0;    // U_WMREOF                        0      0      1    0    1    0    0    0    0    0  Force out any pending draw
-         table[0x01] = 0x020;    // U_WMRSETBKCOLOR                 0      0      0    0    1    0    0    0    0    0
-         table[0x02] = 0x020;    // U_WMRSETBKMODE                  0      0      0    0    1    0    0    0    0    0
-         table[0x03] = 0x0A0;    // U_WMRSETMAPMODE                 0      0      1    0    1    0    0    0    0    0
-         table[0x04] = 0x0A0;    // U_WMRSETROP2                    0      0      1    0    1    0    0    0    0    0
-         table[0x05] = 0x000;    // U_WMRSETRELABS                  0      0      0    0    0    0    0    0    0    0  No idea what this is supposed to do
-         table[0x06] = 0x0A0;    // U_WMRSETPOLYFILLMODE            0      0      1    0    1    0    0    0    0    0
-         table[0x07] = 0x0A0;    // U_WMRSETSTRETCHBLTMODE          0      0      1    0    1    0    0    0    0    0
-         table[0x08] = 0x000;    // U_WMRSETTEXTCHAREXTRA           0      0      0    0    0    0    0    0    0    0
-         table[0x09] = 0x020;    // U_WMRSETTEXTCOLOR               0      0      0    0    1    0    0    0    0    0
-         table[0x0A] = 0x020;    // U_WMRSETTEXTJUSTIFICATION       0      0      0    0    1    0    0    0    0    0
-         table[0x0B] = 0x0A0;    // U_WMRSETWINDOWORG               0      0      1    0    1    0    0    0    0    0
-         table[0x0C] = 0x0A0;    // U_WMRSETWINDOWEXT               0      0      1    0    1    0    0    0    0    0
-         table[0x0D] = 0x0A0;    // U_WMRSETVIEWPORTORG             0      0      1    0    1    0    0    0    0    0
-         table[0x0E] = 0x0A0;    // U_WMRSETVIEWPORTEXT             0      0      1    0    1    0    0    0    0    0
-         table[0x0F] = 0x000;    // U_WMROFFSETWINDOWORG            0      0      0    0    0    0    0    0    0    0
-         table[0x10] = 0x000;    // U_WMRSCALEWINDOWEXT             0      0      0    0    0    0    0    0    0    0
-         table[0x11] = 0x0A0;    // U_WMROFFSETVIEWPORTORG          0      0      1    0    1    0    0    0    0    0
-         table[0x12] = 0x0A0;    // U_WMRSCALEVIEWPORTEXT           0      0      1    0    1    0    0    0    0    0
-         table[0x13] = 0x28B;    // U_WMRLINETO                     1      0      1    0    0    0    1    0    1    1
-         table[0x14] = 0x289;    // U_WMRMOVETO                     1      0      1    0    0    0    1    0    0    1
-         table[0x15] = 0x0A0;    // U_WMREXCLUDECLIPRECT            0      0      1    0    1    0    0    0    0    0
-         table[0x16] = 0x0A0;    // U_WMRINTERSECTCLIPRECT          0      0      1    0    1    0    0    0    0    0
-         table[0x17] = 0x283;    // U_WMRARC                        1      0      1    0    0    0    0    0    1    1
-         table[0x18] = 0x087;    // U_WMRELLIPSE                    0      0      1    0    0    0    0    1    1    1
-         table[0x19] = 0x082;    // U_WMRFLOODFILL                  0      0      1    0    0    0    0    0    1    0
-         table[0x1A] = 0x087;    // U_WMRPIE                        0      0      1    0    0    0    0    1    1    1
-         table[0x1B] = 0x087;    // U_WMRRECTANGLE                  0      0      1    0    0    0    0    1    1    1
-         table[0x1C] = 0x087;    // U_WMRROUNDRECT                  0      0      1    0    0    0    0    1    1    1
-         table[0x1D] = 0x000;    // U_WMRPATBLT                     0      0      1    0    0    0    0    1    1    1
-         table[0x1E] = 0x0A0;    // U_WMRSAVEDC                     0      0      1    0    1    0    0    0    0    0
-         table[0x1F] = 0x082;    // U_WMRSETPIXEL                   0      0      1    0    0    0    0    0    1    0
-         table[0x20] = 0x0A0;    // U_WMROFFSETCLIPRGN              0      0      1    0    1    0    0    0    0    0
-         table[0x21] = 0x002;    // U_WMRTEXTOUT                    0      0      0    0    0    0    0    0    1    0
-         table[0x22] = 0x082;    // U_WMRBITBLT                     0      0      1    0    0    0    0    0    1    0
-         table[0x23] = 0x082;    // U_WMRSTRETCHBLT                 0      0      1    0    0    0    0    0    1    0
-         table[0x24] = 0x083;    // U_WMRPOLYGON                    0      0      1    0    0    0    0    0    1    1
-         table[0x25] = 0x283;    // U_WMRPOLYLINE                   1      0      1    0    0    0    0    0    1    1
-         table[0x26] = 0x0A0;    // U_WMRESCAPE                     0      0      1    0    1    0    0    0    0    0
-         table[0x27] = 0x0A0;    // U_WMRRESTOREDC                  0      0      1    0    1    0    0    0    0    0
-         table[0x28] = 0x082;    // U_WMRFILLREGION                 0      0      1    0    0    0    0    0    1    0
-         table[0x29] = 0x082;    // U_WMRFRAMEREGION                0      0      1    0    0    0    0    0    1    0
-         table[0x2A] = 0x082;    // U_WMRINVERTREGION               0      0      1    0    0    0    0    0    1    0
-         table[0x2B] = 0x082;    // U_WMRPAINTREGION                0      0      1    0    0    0    0    0    1    0
-         table[0x2C] = 0x0A0;    // U_WMRSELECTCLIPREGION           0      0      1    0    1    0    0    0    0    0
-         table[0x2D] = 0x020;    // U_WMRSELECTOBJECT               0      0      0    0    1    0    0    0    0    0
-         table[0x2E] = 0x020;    // U_WMRSETTEXTALIGN               0      0      0    0    1    0    0    0    0    0
-         table[0x2F] = 0x002;    // U_WMRDRAWTEXT                   0      0      0    0    0    0    0    0    1    0 no idea what this is supposed to do
-         table[0x30] = 0x087;    // U_WMRCHORD                      0      0      1    0    0    0    0    1    1    1
-         table[0x31] = 0x0A0;    // U_WMRSETMAPPERFLAGS             0      0      1    0    1    0    0    0    0    0
-         table[0x32] = 0x002;    // U_WMREXTTEXTOUT                 0      0      0    0    0    0    0    0    1    0
-         table[0x33] = 0x000;    // U_WMRSETDIBTODEV                0      0      0    0    0    0    0    0    0    0
-         table[0x34] = 0x0A0;    // U_WMRSELECTPALETTE              0      0      1    0    1    0    0    0    0    0
-         table[0x35] = 0x0A0;    // U_WMRREALIZEPALETTE             0      0      1    0    1    0    0    0    0    0
-         table[0x36] = 0x0A0;    // U_WMRANIMATEPALETTE             0      0      1    0    1    0    0    0    0    0
-         table[0x37] = 0x0A0;    // U_WMRSETPALENTRIES              0      0      1    0    1    0    0    0    0    0
-         table[0x38] = 0x087;    // U_WMRPOLYPOLYGON                0      0      1    0    0    0    0    1    1    1
-         table[0x39] = 0x0A0;    // U_WMRRESIZEPALETTE              0      0      1    0    1    0    0    0    0    0
-         table[0x3A] = 0x000;    // U_WMR3A                         0      0      0    0    0    0    0    0    0    0
-         table[0x3B] = 0x000;    // U_WMR3B                         0      0      0    0    0    0    0    0    0    0
-         table[0x3C] = 0x000;    // U_WMR3C                         0      0      0    0    0    0    0    0    0    0
-         table[0x3D] = 0x000;    // U_WMR3D                         0      0      0    0    0    0    0    0    0    0
-         table[0x3E] = 0x000;    // U_WMR3E                         0      0      0    0    0    0    0    0    0    0
-         table[0x3F] = 0x000;    // U_WMR3F                         0      0      0    0    0    0    0    0    0    0
-         table[0x40] = 0x0A0;    // U_WMRDIBBITBLT                  0      0      1    0    1    0    0    0    0    0
-         table[0x41] = 0x0A0;    // U_WMRDIBSTRETCHBLT              0      0      1    0    1    0    0    0    0    0
-         table[0x42] = 0x080;    // U_WMRDIBCREATEPATTERNBRUSH      0      0      1    0    0    0    0    0    0    0  Not selected yet, so no change in drawing conditions
-         table[0x43] = 0x0A0;    // U_WMRSTRETCHDIB                 0      0      1    0    1    0    0    0    0    0
-         table[0x44] = 0x000;    // U_WMR44                         0      0      0    0    0    0    0    0    0    0
-         table[0x45] = 0x000;    // U_WMR45                         0      0      0    0    0    0    0    0    0    0
-         table[0x46] = 0x000;    // U_WMR46                         0      0      0    0    0    0    0    0    0    0
-         table[0x47] = 0x000;    // U_WMR47                         0      0      0    0    0    0    0    0    0    0
-         table[0x48] = 0x082;    // U_WMREXTFLOODFILL               0      0      1    0    0    0    0    0    1    0
-         table[0x49] = 0x000;    // U_WMR49                         0      0      0    0    0    0    0    0    0    0
-         table[0x4A] = 0x000;    // U_WMR4A                         0      0      0    0    0    0    0    0    0    0
-         table[0x4B] = 0x000;    // U_WMR4B                         0      0      0    0    0    0    0    0    0    0
-         table[0x4C] = 0x000;    // U_WMR4C                         0      0      0    0    0    0    0    0    0    0
-         table[0x4D] = 0x000;    // U_WMR4D                         0      0      0    0    0    0    0    0    0    0
-         table[0x4E] = 0x000;    // U_WMR4E                         0      0      0    0    0    0    0    0    0    0
-         table[0x4F] = 0x000;    // U_WMR4F                         0      0      0    0    0    0    0    0    0    0
-         table[0x50] = 0x000;    // U_WMR50                         0      0      0    0    0    0    0    0    0    0
-         table[0x51] = 0x000;    // U_WMR51                         0      0      0    0    0    0    0    0    0    0
-         table[0x52] = 0x000;    // U_WMR52                         0      0      0    0    0    0    0    0    0    0
-         table[0x53] = 0x000;    // U_WMR53                         0      0      0    0    0    0    0    0    0    0
-         table[0x54] = 0x000;    // U_WMR54                         0      0      0    0    0    0    0    0    0    0
-         table[0x55] = 0x000;    // U_WMR55                         0      0      0    0    0    0    0    0    0    0
-         table[0x56] = 0x000;    // U_WMR56                         0      0      0    0    0    0    0    0    0    0
-         table[0x57] = 0x000;    // U_WMR57                         0      0      0    0    0    0    0    0    0    0
-         table[0x58] = 0x000;    // U_WMR58                         0      0      0    0    0    0    0    0    0    0
-         table[0x59] = 0x000;    // U_WMR59                         0      0      0    0    0    0    0    0    0    0
-         table[0x5A] = 0x000;    // U_WMR5A                         0      0      0    0    0    0    0    0    0    0
-         table[0x5B] = 0x000;    // U_WMR5B                         0      0      0    0    0    0    0    0    0    0
-         table[0x5C] = 0x000;    // U_WMR5C                         0      0      0    0    0    0    0    0    0    0
-         table[0x5D] = 0x000;    // U_WMR5D                         0      0      0    0    0    0    0    0    0    0
-         table[0x5E] = 0x000;    // U_WMR5E                         0      0      0    0    0    0    0    0    0    0
-         table[0x5F] = 0x000;    // U_WMR5F                         0      0      0    0    0    0    0    0    0    0
-         table[0x60] = 0x000;    // U_WMR60                         0      0      0    0    0    0    0    0    0    0
-         table[0x61] = 0x000;    // U_WMR61                         0      0      0    0    0    0    0    0    0    0
-         table[0x62] = 0x000;    // U_WMR62                         0      0      0    0    0    0    0    0    0    0
-         table[0x63] = 0x000;    // U_WMR63                         0      0      0    0    0    0    0    0    0    0
-         table[0x64] = 0x000;    // U_WMR64                         0      0      0    0    0    0    0    0    0    0
-         table[0x65] = 0x000;    // U_WMR65                         0      0      0    0    0    0    0    0    0    0
-         table[0x66] = 0x000;    // U_WMR66                         0      0      0    0    0    0    0    0    0    0
-         table[0x67] = 0x000;    // U_WMR67                         0      0      0    0    0    0    0    0    0    0
-         table[0x68] = 0x000;    // U_WMR68                         0      0      0    0    0    0    0    0    0    0
-         table[0x69] = 0x000;    // U_WMR69                         0      0      0    0    0    0    0    0    0    0
-         table[0x6A] = 0x000;    // U_WMR6A                         0      0      0    0    0    0    0    0    0    0
-         table[0x6B] = 0x000;    // U_WMR6B                         0      0      0    0    0    0    0    0    0    0
-         table[0x6C] = 0x000;    // U_WMR6C                         0      0      0    0    0    0    0    0    0    0
-         table[0x6D] = 0x000;    // U_WMR6D                         0      0      0    0    0    0    0    0    0    0
-         table[0x6E] = 0x000;    // U_WMR6E                         0      0      0    0    0    0    0    0    0    0
-         table[0x6F] = 0x000;    // U_WMR6F                         0      0      0    0    0    0    0    0    0    0
-         table[0x70] = 0x000;    // U_WMR70                         0      0      0    0    0    0    0    0    0    0
-         table[0x71] = 0x000;    // U_WMR71                         0      0      0    0    0    0    0    0    0    0
-         table[0x72] = 0x000;    // U_WMR72                         0      0      0    0    0    0    0    0    0    0
-         table[0x73] = 0x000;    // U_WMR73                         0      0      0    0    0    0    0    0    0    0
-         table[0x74] = 0x000;    // U_WMR74                         0      0      0    0    0    0    0    0    0    0
-         table[0x75] = 0x000;    // U_WMR75                         0      0      0    0    0    0    0    0    0    0
-         table[0x76] = 0x000;    // U_WMR76                         0      0      0    0    0    0    0    0    0    0
-         table[0x77] = 0x000;    // U_WMR77                         0      0      0    0    0    0    0    0    0    0
-         table[0x78] = 0x000;    // U_WMR78                         0      0      0    0    0    0    0    0    0    0
-         table[0x79] = 0x000;    // U_WMR79                         0      0      0    0    0    0    0    0    0    0
-         table[0x7A] = 0x000;    // U_WMR7A                         0      0      0    0    0    0    0    0    0    0
-         table[0x7B] = 0x000;    // U_WMR7B                         0      0      0    0    0    0    0    0    0    0
-         table[0x7C] = 0x000;    // U_WMR7C                         0      0      0    0    0    0    0    0    0    0
-         table[0x7D] = 0x000;    // U_WMR7D                         0      0      0    0    0    0    0    0    0    0
-         table[0x7E] = 0x000;    // U_WMR7E                         0      0      0    0    0    0    0    0    0    0
-         table[0x7F] = 0x000;    // U_WMR7F                         0      0      0    0    0    0    0    0    0    0
-         table[0x80] = 0x000;    // U_WMR80                         0      0      0    0    0    0    0    0    0    0
-         table[0x81] = 0x000;    // U_WMR81                         0      0      0    0    0    0    0    0    0    0
-         table[0x82] = 0x000;    // U_WMR82                         0      0      0    0    0    0    0    0    0    0
-         table[0x83] = 0x000;    // U_WMR83                         0      0      0    0    0    0    0    0    0    0
-         table[0x84] = 0x000;    // U_WMR84                         0      0      0    0    0    0    0    0    0    0
-         table[0x85] = 0x000;    // U_WMR85                         0      0      0    0    0    0    0    0    0    0
-         table[0x86] = 0x000;    // U_WMR86                         0      0      0    0    0    0    0    0    0    0
-         table[0x87] = 0x000;    // U_WMR87                         0      0      0    0    0    0    0    0    0    0
-         table[0x88] = 0x000;    // U_WMR88                         0      0      0    0    0    0    0    0    0    0
-         table[0x89] = 0x000;    // U_WMR89                         0      0      0    0    0    0    0    0    0    0
-         table[0x8A] = 0x000;    // U_WMR8A                         0      0      0    0    0    0    0    0    0    0
-         table[0x8B] = 0x000;    // U_WMR8B                         0      0      0    0    0    0    0    0    0    0
-         table[0x8C] = 0x000;    // U_WMR8C                         0      0      0    0    0    0    0    0    0    0
-         table[0x8D] = 0x000;    // U_WMR8D                         0      0      0    0    0    0    0    0    0    0
-         table[0x8E] = 0x000;    // U_WMR8E                         0      0      0    0    0    0    0    0    0    0
-         table[0x8F] = 0x000;    // U_WMR8F                         0      0      0    0    0    0    0    0    0    0
-         table[0x90] = 0x000;    // U_WMR90                         0      0      0    0    0    0    0    0    0    0
-         table[0x91] = 0x000;    // U_WMR91                         0      0      0    0    0    0    0    0    0    0
-         table[0x92] = 0x000;    // U_WMR92                         0      0      0    0    0    0    0    0    0    0
-         table[0x93] = 0x000;    // U_WMR93                         0      0      0    0    0    0    0    0    0    0
-         table[0x94] = 0x000;    // U_WMR94                         0      0      0    0    0    0    0    0    0    0
-         table[0x95] = 0x000;    // U_WMR95                         0      0      0    0    0    0    0    0    0    0
-         table[0x96] = 0x000;    // U_WMR96                         0      0      0    0    0    0    0    0    0    0
-         table[0x97] = 0x000;    // U_WMR97                         0      0      0    0    0    0    0    0    0    0
-         table[0x98] = 0x000;    // U_WMR98                         0      0      0    0    0    0    0    0    0    0
-         table[0x99] = 0x000;    // U_WMR99                         0      0      0    0    0    0    0    0    0    0
-         table[0x9A] = 0x000;    // U_WMR9A                         0      0      0    0    0    0    0    0    0    0
-         table[0x9B] = 0x000;    // U_WMR9B                         0      0      0    0    0    0    0    0    0    0
-         table[0x9C] = 0x000;    // U_WMR9C                         0      0      0    0    0    0    0    0    0    0
-         table[0x9D] = 0x000;    // U_WMR9D                         0      0      0    0    0    0    0    0    0    0
-         table[0x9E] = 0x000;    // U_WMR9E                         0      0      0    0    0    0    0    0    0    0
-         table[0x9F] = 0x000;    // U_WMR9F                         0      0      0    0    0    0    0    0    0    0
-         table[0xA0] = 0x000;    // U_WMRA0                         0      0      0    0    0    0    0    0    0    0
-         table[0xA1] = 0x000;    // U_WMRA1                         0      0      0    0    0    0    0    0    0    0
-         table[0xA2] = 0x000;    // U_WMRA2                         0      0      0    0    0    0    0    0    0    0
-         table[0xA3] = 0x000;    // U_WMRA3                         0      0      0    0    0    0    0    0    0    0
-         table[0xA4] = 0x000;    // U_WMRA4                         0      0      0    0    0    0    0    0    0    0
-         table[0xA5] = 0x000;    // U_WMRA5                         0      0      0    0    0    0    0    0    0    0
-         table[0xA6] = 0x000;    // U_WMRA6                         0      0      0    0    0    0    0    0    0    0
-         table[0xA7] = 0x000;    // U_WMRA7                         0      0      0    0    0    0    0    0    0    0
-         table[0xA8] = 0x000;    // U_WMRA8                         0      0      0    0    0    0    0    0    0    0
-         table[0xA9] = 0x000;    // U_WMRA9                         0      0      0    0    0    0    0    0    0    0
-         table[0xAA] = 0x000;    // U_WMRAA                         0      0      0    0    0    0    0    0    0    0
-         table[0xAB] = 0x000;    // U_WMRAB                         0      0      0    0    0    0    0    0    0    0
-         table[0xAC] = 0x000;    // U_WMRAC                         0      0      0    0    0    0    0    0    0    0
-         table[0xAD] = 0x000;    // U_WMRAD                         0      0      0    0    0    0    0    0    0    0
-         table[0xAE] = 0x000;    // U_WMRAE                         0      0      0    0    0    0    0    0    0    0
-         table[0xAF] = 0x000;    // U_WMRAF                         0      0      0    0    0    0    0    0    0    0
-         table[0xB0] = 0x000;    // U_WMRB0                         0      0      0    0    0    0    0    0    0    0
-         table[0xB1] = 0x000;    // U_WMRB1                         0      0      0    0    0    0    0    0    0    0
-         table[0xB2] = 0x000;    // U_WMRB2                         0      0      0    0    0    0    0    0    0    0
-         table[0xB3] = 0x000;    // U_WMRB3                         0      0      0    0    0    0    0    0    0    0
-         table[0xB4] = 0x000;    // U_WMRB4                         0      0      0    0    0    0    0    0    0    0
-         table[0xB5] = 0x000;    // U_WMRB5                         0      0      0    0    0    0    0    0    0    0
-         table[0xB6] = 0x000;    // U_WMRB6                         0      0      0    0    0    0    0    0    0    0
-         table[0xB7] = 0x000;    // U_WMRB7                         0      0      0    0    0    0    0    0    0    0
-         table[0xB8] = 0x000;    // U_WMRB8                         0      0      0    0    0    0    0    0    0    0
-         table[0xB9] = 0x000;    // U_WMRB9                         0      0      0    0    0    0    0    0    0    0
-         table[0xBA] = 0x000;    // U_WMRBA                         0      0      0    0    0    0    0    0    0    0
-         table[0xBB] = 0x000;    // U_WMRBB                         0      0      0    0    0    0    0    0    0    0
-         table[0xBC] = 0x000;    // U_WMRBC                         0      0      0    0    0    0    0    0    0    0
-         table[0xBD] = 0x000;    // U_WMRBD                         0      0      0    0    0    0    0    0    0    0
-         table[0xBE] = 0x000;    // U_WMRBE                         0      0      0    0    0    0    0    0    0    0
-         table[0xBF] = 0x000;    // U_WMRBF                         0      0      0    0    0    0    0    0    0    0
-         table[0xC0] = 0x000;    // U_WMRC0                         0      0      0    0    0    0    0    0    0    0
-         table[0xC1] = 0x000;    // U_WMRC1                         0      0      0    0    0    0    0    0    0    0
-         table[0xC2] = 0x000;    // U_WMRC2                         0      0      0    0    0    0    0    0    0    0
-         table[0xC3] = 0x000;    // U_WMRC3                         0      0      0    0    0    0    0    0    0    0
-         table[0xC4] = 0x000;    // U_WMRC4                         0      0      0    0    0    0    0    0    0    0
-         table[0xC5] = 0x000;    // U_WMRC5                         0      0      0    0    0    0    0    0    0    0
-         table[0xC6] = 0x000;    // U_WMRC6                         0      0      0    0    0    0    0    0    0    0
-         table[0xC7] = 0x000;    // U_WMRC7                         0      0      0    0    0    0    0    0    0    0
-         table[0xC8] = 0x000;    // U_WMRC8                         0      0      0    0    0    0    0    0    0    0
-         table[0xC9] = 0x000;    // U_WMRC9                         0      0      0    0    0    0    0    0    0    0
-         table[0xCA] = 0x000;    // U_WMRCA                         0      0      0    0    0    0    0    0    0    0
-         table[0xCB] = 0x000;    // U_WMRCB                         0      0      0    0    0    0    0    0    0    0
-         table[0xCC] = 0x000;    // U_WMRCC                         0      0      0    0    0    0    0    0    0    0
-         table[0xCD] = 0x000;    // U_WMRCD                         0      0      0    0    0    0    0    0    0    0
-         table[0xCE] = 0x000;    // U_WMRCE                         0      0      0    0    0    0    0    0    0    0
-         table[0xCF] = 0x000;    // U_WMRCF                         0      0      0    0    0    0    0    0    0    0
-         table[0xD0] = 0x000;    // U_WMRD0                         0      0      0    0    0    0    0    0    0    0
-         table[0xD1] = 0x000;    // U_WMRD1                         0      0      0    0    0    0    0    0    0    0
-         table[0xD2] = 0x000;    // U_WMRD2                         0      0      0    0    0    0    0    0    0    0
-         table[0xD3] = 0x000;    // U_WMRD3                         0      0      0    0    0    0    0    0    0    0
-         table[0xD4] = 0x000;    // U_WMRD4                         0      0      0    0    0    0    0    0    0    0
-         table[0xD5] = 0x000;    // U_WMRD5                         0      0      0    0    0    0    0    0    0    0
-         table[0xD6] = 0x000;    // U_WMRD6                         0      0      0    0    0    0    0    0    0    0
-         table[0xD7] = 0x000;    // U_WMRD7                         0      0      0    0    0    0    0    0    0    0
-         table[0xD8] = 0x000;    // U_WMRD8                         0      0      0    0    0    0    0    0    0    0
-         table[0xD9] = 0x000;    // U_WMRD9                         0      0      0    0    0    0    0    0    0    0
-         table[0xDA] = 0x000;    // U_WMRDA                         0      0      0    0    0    0    0    0    0    0
-         table[0xDB] = 0x000;    // U_WMRDB                         0      0      0    0    0    0    0    0    0    0
-         table[0xDC] = 0x000;    // U_WMRDC                         0      0      0    0    0    0    0    0    0    0
-         table[0xDD] = 0x000;    // U_WMRDD                         0      0      0    0    0    0    0    0    0    0
-         table[0xDE] = 0x000;    // U_WMRDE                         0      0      0    0    0    0    0    0    0    0
-         table[0xDF] = 0x000;    // U_WMRDF                         0      0      0    0    0    0    0    0    0    0
-         table[0xE0] = 0x000;    // U_WMRE0                         0      0      0    0    0    0    0    0    0    0
-         table[0xE1] = 0x000;    // U_WMRE1                         0      0      0    0    0    0    0    0    0    0
-         table[0xE2] = 0x000;    // U_WMRE2                         0      0      0    0    0    0    0    0    0    0
-         table[0xE3] = 0x000;    // U_WMRE3                         0      0      0    0    0    0    0    0    0    0
-         table[0xE4] = 0x000;    // U_WMRE4                         0      0      0    0    0    0    0    0    0    0
-         table[0xE5] = 0x000;    // U_WMRE5                         0      0      0    0    0    0    0    0    0    0
-         table[0xE6] = 0x000;    // U_WMRE6                         0      0      0    0    0    0    0    0    0    0
-         table[0xE7] = 0x000;    // U_WMRE7                         0      0      0    0    0    0    0    0    0    0
-         table[0xE8] = 0x000;    // U_WMRE8                         0      0      0    0    0    0    0    0    0    0
-         table[0xE9] = 0x000;    // U_WMRE9                         0      0      0    0    0    0    0    0    0    0
-         table[0xEA] = 0x000;    // U_WMREA                         0      0      0    0    0    0    0    0    0    0
-         table[0xEB] = 0x000;    // U_WMREB                         0      0      0    0    0    0    0    0    0    0
-         table[0xEC] = 0x000;    // U_WMREC                         0      0      0    0    0    0    0    0    0    0
-         table[0xED] = 0x000;    // U_WMRED                         0      0      0    0    0    0    0    0    0    0
-         table[0xEE] = 0x000;    // U_WMREE                         0      0      0    0    0    0    0    0    0    0
-         table[0xEF] = 0x000;    // U_WMREF                         0      0      0    0    0    0    0    0    0    0
-         table[0xF0] = 0x020;    // U_WMRDELETEOBJECT               0      0      0    0    1    0    0    0    0    0
-         table[0xF1] = 0x000;    // U_WMRF1                         0      0      0    0    0    0    0    0    0    0
-         table[0xF2] = 0x000;    // U_WMRF2                         0      0      0    0    0    0    0    0    0    0
-         table[0xF3] = 0x000;    // U_WMRF3                         0      0      0    0    0    0    0    0    0    0
-         table[0xF4] = 0x000;    // U_WMRF4                         0      0      0    0    0    0    0    0    0    0
-         table[0xF5] = 0x000;    // U_WMRF5                         0      0      0    0    0    0    0    0    0    0
-         table[0xF6] = 0x000;    // U_WMRF6                         0      0      0    0    0    0    0    0    0    0
-         table[0xF7] = 0x120;    // U_WMRCREATEPALETTE              0      1      0    0    1    0    0    0    0    0 Not selected yet, so no change in drawing conditions
-         table[0xF8] = 0x120;    // U_WMRCREATEBRUSH                0      1      0    0    1    0    0    0    0    0 "
-         table[0xF9] = 0x120;    // U_WMRCREATEPATTERNBRUSH         0      1      0    0    1    0    0    0    0    0 "
-         table[0xFA] = 0x120;    // U_WMRCREATEPENINDIRECT          0      1      0    0    1    0    0    0    0    0 "
-         table[0xFB] = 0x120;    // U_WMRCREATEFONTINDIRECT         0      1      0    0    1    0    0    0    0    0 "
-         table[0xFC] = 0x120;    // U_WMRCREATEBRUSHINDIRECT        0      1      0    0    1    0    0    0    0    0 "
-         table[0xFD] = 0x020;    // U_WMRCREATEBITMAPINDIRECT       0      0      0    0    1    0    0    0    0    0 "
-         table[0xFE] = 0x020;    // U_WMRCREATEBITMAP               0      0      0    0    1    0    0    0    0    0 "
-         table[0xFF] = 0x120;    // U_WMRCREATEREGION               0      1      0    0    1    0    0    0    0    0 "
-      }
-      result = table[type];
-   }
-   return(result);
+      [0x00] = 0x0A0,    // U_WMREOF                        0      0      1    0    1    0    0    0    0    0  Force out any pending draw
+      [0x01] = 0x020,    // U_WMRSETBKCOLOR                 0      0      0    0    1    0    0    0    0    0
+      [0x02] = 0x020,    // U_WMRSETBKMODE                  0      0      0    0    1    0    0    0    0    0
+      [0x03] = 0x0A0,    // U_WMRSETMAPMODE                 0      0      1    0    1    0    0    0    0    0
+      [0x04] = 0x0A0,    // U_WMRSETROP2                    0      0      1    0    1    0    0    0    0    0
+      [0x05] = 0x000,    // U_WMRSETRELABS                  0      0      0    0    0    0    0    0    0    0  No idea what this is supposed to do
+      [0x06] = 0x0A0,    // U_WMRSETPOLYFILLMODE            0      0      1    0    1    0    0    0    0    0
+      [0x07] = 0x0A0,    // U_WMRSETSTRETCHBLTMODE          0      0      1    0    1    0    0    0    0    0
+      [0x08] = 0x000,    // U_WMRSETTEXTCHAREXTRA           0      0      0    0    0    0    0    0    0    0
+      [0x09] = 0x020,    // U_WMRSETTEXTCOLOR               0      0      0    0    1    0    0    0    0    0
+      [0x0A] = 0x020,    // U_WMRSETTEXTJUSTIFICATION       0      0      0    0    1    0    0    0    0    0
+      [0x0B] = 0x0A0,    // U_WMRSETWINDOWORG               0      0      1    0    1    0    0    0    0    0
+      [0x0C] = 0x0A0,    // U_WMRSETWINDOWEXT               0      0      1    0    1    0    0    0    0    0
+      [0x0D] = 0x0A0,    // U_WMRSETVIEWPORTORG             0      0      1    0    1    0    0    0    0    0
+      [0x0E] = 0x0A0,    // U_WMRSETVIEWPORTEXT             0      0      1    0    1    0    0    0    0    0
+      [0x0F] = 0x000,    // U_WMROFFSETWINDOWORG            0      0      0    0    0    0    0    0    0    0
+      [0x10] = 0x000,    // U_WMRSCALEWINDOWEXT             0      0      0    0    0    0    0    0    0    0
+      [0x11] = 0x0A0,    // U_WMROFFSETVIEWPORTORG          0      0      1    0    1    0    0    0    0    0
+      [0x12] = 0x0A0,    // U_WMRSCALEVIEWPORTEXT           0      0      1    0    1    0    0    0    0    0
+      [0x13] = 0x28B,    // U_WMRLINETO                     1      0      1    0    0    0    1    0    1    1
+      [0x14] = 0x289,    // U_WMRMOVETO                     1      0      1    0    0    0    1    0    0    1
+      [0x15] = 0x0A0,    // U_WMREXCLUDECLIPRECT            0      0      1    0    1    0    0    0    0    0
+      [0x16] = 0x0A0,    // U_WMRINTERSECTCLIPRECT          0      0      1    0    1    0    0    0    0    0
+      [0x17] = 0x283,    // U_WMRARC                        1      0      1    0    0    0    0    0    1    1
+      [0x18] = 0x087,    // U_WMRELLIPSE                    0      0      1    0    0    0    0    1    1    1
+      [0x19] = 0x082,    // U_WMRFLOODFILL                  0      0      1    0    0    0    0    0    1    0
+      [0x1A] = 0x087,    // U_WMRPIE                        0      0      1    0    0    0    0    1    1    1
+      [0x1B] = 0x087,    // U_WMRRECTANGLE                  0      0      1    0    0    0    0    1    1    1
+      [0x1C] = 0x087,    // U_WMRROUNDRECT                  0      0      1    0    0    0    0    1    1    1
+      [0x1D] = 0x000,    // U_WMRPATBLT                     0      0      1    0    0    0    0    1    1    1
+      [0x1E] = 0x0A0,    // U_WMRSAVEDC                     0      0      1    0    1    0    0    0    0    0
+      [0x1F] = 0x082,    // U_WMRSETPIXEL                   0      0      1    0    0    0    0    0    1    0
+      [0x20] = 0x0A0,    // U_WMROFFSETCLIPRGN              0      0      1    0    1    0    0    0    0    0
+      [0x21] = 0x002,    // U_WMRTEXTOUT                    0      0      0    0    0    0    0    0    1    0
+      [0x22] = 0x082,    // U_WMRBITBLT                     0      0      1    0    0    0    0    0    1    0
+      [0x23] = 0x082,    // U_WMRSTRETCHBLT                 0      0      1    0    0    0    0    0    1    0
+      [0x24] = 0x083,    // U_WMRPOLYGON                    0      0      1    0    0    0    0    0    1    1
+      [0x25] = 0x283,    // U_WMRPOLYLINE                   1      0      1    0    0    0    0    0    1    1
+      [0x26] = 0x0A0,    // U_WMRESCAPE                     0      0      1    0    1    0    0    0    0    0
+      [0x27] = 0x0A0,    // U_WMRRESTOREDC                  0      0      1    0    1    0    0    0    0    0
+      [0x28] = 0x082,    // U_WMRFILLREGION                 0      0      1    0    0    0    0    0    1    0
+      [0x29] = 0x082,    // U_WMRFRAMEREGION                0      0      1    0    0    0    0    0    1    0
+      [0x2A] = 0x082,    // U_WMRINVERTREGION               0      0      1    0    0    0    0    0    1    0
+      [0x2B] = 0x082,    // U_WMRPAINTREGION                0      0      1    0    0    0    0    0    1    0
+      [0x2C] = 0x0A0,    // U_WMRSELECTCLIPREGION           0      0      1    0    1    0    0    0    0    0
+      [0x2D] = 0x020,    // U_WMRSELECTOBJECT               0      0      0    0    1    0    0    0    0    0
+      [0x2E] = 0x020,    // U_WMRSETTEXTALIGN               0      0      0    0    1    0    0    0    0    0
+      [0x2F] = 0x002,    // U_WMRDRAWTEXT                   0      0      0    0    0    0    0    0    1    0 no idea what this is supposed to do
+      [0x30] = 0x087,    // U_WMRCHORD                      0      0      1    0    0    0    0    1    1    1
+      [0x31] = 0x0A0,    // U_WMRSETMAPPERFLAGS             0      0      1    0    1    0    0    0    0    0
+      [0x32] = 0x002,    // U_WMREXTTEXTOUT                 0      0      0    0    0    0    0    0    1    0
+      [0x33] = 0x000,    // U_WMRSETDIBTODEV                0      0      0    0    0    0    0    0    0    0
+      [0x34] = 0x0A0,    // U_WMRSELECTPALETTE              0      0      1    0    1    0    0    0    0    0
+      [0x35] = 0x0A0,    // U_WMRREALIZEPALETTE             0      0      1    0    1    0    0    0    0    0
+      [0x36] = 0x0A0,    // U_WMRANIMATEPALETTE             0      0      1    0    1    0    0    0    0    0
+      [0x37] = 0x0A0,    // U_WMRSETPALENTRIES              0      0      1    0    1    0    0    0    0    0
+      [0x38] = 0x087,    // U_WMRPOLYPOLYGON                0      0      1    0    0    0    0    1    1    1
+      [0x39] = 0x0A0,    // U_WMRRESIZEPALETTE              0      0      1    0    1    0    0    0    0    0
+      [0x3A] = 0x000,    // U_WMR3A                         0      0      0    0    0    0    0    0    0    0
+      [0x3B] = 0x000,    // U_WMR3B                         0      0      0    0    0    0    0    0    0    0
+      [0x3C] = 0x000,    // U_WMR3C                         0      0      0    0    0    0    0    0    0    0
+      [0x3D] = 0x000,    // U_WMR3D                         0      0      0    0    0    0    0    0    0    0
+      [0x3E] = 0x000,    // U_WMR3E                         0      0      0    0    0    0    0    0    0    0
+      [0x3F] = 0x000,    // U_WMR3F                         0      0      0    0    0    0    0    0    0    0
+      [0x40] = 0x0A0,    // U_WMRDIBBITBLT                  0      0      1    0    1    0    0    0    0    0
+      [0x41] = 0x0A0,    // U_WMRDIBSTRETCHBLT              0      0      1    0    1    0    0    0    0    0
+      [0x42] = 0x080,    // U_WMRDIBCREATEPATTERNBRUSH      0      0      1    0    0    0    0    0    0    0  Not selected yet, so no change in drawing conditions
+      [0x43] = 0x0A0,    // U_WMRSTRETCHDIB                 0      0      1    0    1    0    0    0    0    0
+      [0x44] = 0x000,    // U_WMR44                         0      0      0    0    0    0    0    0    0    0
+      [0x45] = 0x000,    // U_WMR45                         0      0      0    0    0    0    0    0    0    0
+      [0x46] = 0x000,    // U_WMR46                         0      0      0    0    0    0    0    0    0    0
+      [0x47] = 0x000,    // U_WMR47                         0      0      0    0    0    0    0    0    0    0
+      [0x48] = 0x082,    // U_WMREXTFLOODFILL               0      0      1    0    0    0    0    0    1    0
+      [0x49] = 0x000,    // U_WMR49                         0      0      0    0    0    0    0    0    0    0
+      [0x4A] = 0x000,    // U_WMR4A                         0      0      0    0    0    0    0    0    0    0
+      [0x4B] = 0x000,    // U_WMR4B                         0      0      0    0    0    0    0    0    0    0
+      [0x4C] = 0x000,    // U_WMR4C                         0      0      0    0    0    0    0    0    0    0
+      [0x4D] = 0x000,    // U_WMR4D                         0      0      0    0    0    0    0    0    0    0
+      [0x4E] = 0x000,    // U_WMR4E                         0      0      0    0    0    0    0    0    0    0
+      [0x4F] = 0x000,    // U_WMR4F                         0      0      0    0    0    0    0    0    0    0
+      [0x50] = 0x000,    // U_WMR50                         0      0      0    0    0    0    0    0    0    0
+      [0x51] = 0x000,    // U_WMR51                         0      0      0    0    0    0    0    0    0    0
+      [0x52] = 0x000,    // U_WMR52                         0      0      0    0    0    0    0    0    0    0
+      [0x53] = 0x000,    // U_WMR53                         0      0      0    0    0    0    0    0    0    0
+      [0x54] = 0x000,    // U_WMR54                         0      0      0    0    0    0    0    0    0    0
+      [0x55] = 0x000,    // U_WMR55                         0      0      0    0    0    0    0    0    0    0
+      [0x56] = 0x000,    // U_WMR56                         0      0      0    0    0    0    0    0    0    0
+      [0x57] = 0x000,    // U_WMR57                         0      0      0    0    0    0    0    0    0    0
+      [0x58] = 0x000,    // U_WMR58                         0      0      0    0    0    0    0    0    0    0
+      [0x59] = 0x000,    // U_WMR59                         0      0      0    0    0    0    0    0    0    0
+      [0x5A] = 0x000,    // U_WMR5A                         0      0      0    0    0    0    0    0    0    0
+      [0x5B] = 0x000,    // U_WMR5B                         0      0      0    0    0    0    0    0    0    0
+      [0x5C] = 0x000,    // U_WMR5C                         0      0      0    0    0    0    0    0    0    0
+      [0x5D] = 0x000,    // U_WMR5D                         0      0      0    0    0    0    0    0    0    0
+      [0x5E] = 0x000,    // U_WMR5E                         0      0      0    0    0    0    0    0    0    0
+      [0x5F] = 0x000,    // U_WMR5F                         0      0      0    0    0    0    0    0    0    0
+      [0x60] = 0x000,    // U_WMR60                         0      0      0    0    0    0    0    0    0    0
+      [0x61] = 0x000,    // U_WMR61                         0      0      0    0    0    0    0    0    0    0
+      [0x62] = 0x000,    // U_WMR62                         0      0      0    0    0    0    0    0    0    0
+      [0x63] = 0x000,    // U_WMR63                         0      0      0    0    0    0    0    0    0    0
+      [0x64] = 0x000,    // U_WMR64                         0      0      0    0    0    0    0    0    0    0
+      [0x65] = 0x000,    // U_WMR65                         0      0      0    0    0    0    0    0    0    0
+      [0x66] = 0x000,    // U_WMR66                         0      0      0    0    0    0    0    0    0    0
+      [0x67] = 0x000,    // U_WMR67                         0      0      0    0    0    0    0    0    0    0
+      [0x68] = 0x000,    // U_WMR68                         0      0      0    0    0    0    0    0    0    0
+      [0x69] = 0x000,    // U_WMR69                         0      0      0    0    0    0    0    0    0    0
+      [0x6A] = 0x000,    // U_WMR6A                         0      0      0    0    0    0    0    0    0    0
+      [0x6B] = 0x000,    // U_WMR6B                         0      0      0    0    0    0    0    0    0    0
+      [0x6C] = 0x000,    // U_WMR6C                         0      0      0    0    0    0    0    0    0    0
+      [0x6D] = 0x000,    // U_WMR6D                         0      0      0    0    0    0    0    0    0    0
+      [0x6E] = 0x000,    // U_WMR6E                         0      0      0    0    0    0    0    0    0    0
+      [0x6F] = 0x000,    // U_WMR6F                         0      0      0    0    0    0    0    0    0    0
+      [0x70] = 0x000,    // U_WMR70                         0      0      0    0    0    0    0    0    0    0
+      [0x71] = 0x000,    // U_WMR71                         0      0      0    0    0    0    0    0    0    0
+      [0x72] = 0x000,    // U_WMR72                         0      0      0    0    0    0    0    0    0    0
+      [0x73] = 0x000,    // U_WMR73                         0      0      0    0    0    0    0    0    0    0
+      [0x74] = 0x000,    // U_WMR74                         0      0      0    0    0    0    0    0    0    0
+      [0x75] = 0x000,    // U_WMR75                         0      0      0    0    0    0    0    0    0    0
+      [0x76] = 0x000,    // U_WMR76                         0      0      0    0    0    0    0    0    0    0
+      [0x77] = 0x000,    // U_WMR77                         0      0      0    0    0    0    0    0    0    0
+      [0x78] = 0x000,    // U_WMR78                         0      0      0    0    0    0    0    0    0    0
+      [0x79] = 0x000,    // U_WMR79                         0      0      0    0    0    0    0    0    0    0
+      [0x7A] = 0x000,    // U_WMR7A                         0      0      0    0    0    0    0    0    0    0
+      [0x7B] = 0x000,    // U_WMR7B                         0      0      0    0    0    0    0    0    0    0
+      [0x7C] = 0x000,    // U_WMR7C                         0      0      0    0    0    0    0    0    0    0
+      [0x7D] = 0x000,    // U_WMR7D                         0      0      0    0    0    0    0    0    0    0
+      [0x7E] = 0x000,    // U_WMR7E                         0      0      0    0    0    0    0    0    0    0
+      [0x7F] = 0x000,    // U_WMR7F                         0      0      0    0    0    0    0    0    0    0
+      [0x80] = 0x000,    // U_WMR80                         0      0      0    0    0    0    0    0    0    0
+      [0x81] = 0x000,    // U_WMR81                         0      0      0    0    0    0    0    0    0    0
+      [0x82] = 0x000,    // U_WMR82                         0      0      0    0    0    0    0    0    0    0
+      [0x83] = 0x000,    // U_WMR83                         0      0      0    0    0    0    0    0    0    0
+      [0x84] = 0x000,    // U_WMR84                         0      0      0    0    0    0    0    0    0    0
+      [0x85] = 0x000,    // U_WMR85                         0      0      0    0    0    0    0    0    0    0
+      [0x86] = 0x000,    // U_WMR86                         0      0      0    0    0    0    0    0    0    0
+      [0x87] = 0x000,    // U_WMR87                         0      0      0    0    0    0    0    0    0    0
+      [0x88] = 0x000,    // U_WMR88                         0      0      0    0    0    0    0    0    0    0
+      [0x89] = 0x000,    // U_WMR89                         0      0      0    0    0    0    0    0    0    0
+      [0x8A] = 0x000,    // U_WMR8A                         0      0      0    0    0    0    0    0    0    0
+      [0x8B] = 0x000,    // U_WMR8B                         0      0      0    0    0    0    0    0    0    0
+      [0x8C] = 0x000,    // U_WMR8C                         0      0      0    0    0    0    0    0    0    0
+      [0x8D] = 0x000,    // U_WMR8D                         0      0      0    0    0    0    0    0    0    0
+      [0x8E] = 0x000,    // U_WMR8E                         0      0      0    0    0    0    0    0    0    0
+      [0x8F] = 0x000,    // U_WMR8F                         0      0      0    0    0    0    0    0    0    0
+      [0x90] = 0x000,    // U_WMR90                         0      0      0    0    0    0    0    0    0    0
+      [0x91] = 0x000,    // U_WMR91                         0      0      0    0    0    0    0    0    0    0
+      [0x92] = 0x000,    // U_WMR92                         0      0      0    0    0    0    0    0    0    0
+      [0x93] = 0x000,    // U_WMR93                         0      0      0    0    0    0    0    0    0    0
+      [0x94] = 0x000,    // U_WMR94                         0      0      0    0    0    0    0    0    0    0
+      [0x95] = 0x000,    // U_WMR95                         0      0      0    0    0    0    0    0    0    0
+      [0x96] = 0x000,    // U_WMR96                         0      0      0    0    0    0    0    0    0    0
+      [0x97] = 0x000,    // U_WMR97                         0      0      0    0    0    0    0    0    0    0
+      [0x98] = 0x000,    // U_WMR98                         0      0      0    0    0    0    0    0    0    0
+      [0x99] = 0x000,    // U_WMR99                         0      0      0    0    0    0    0    0    0    0
+      [0x9A] = 0x000,    // U_WMR9A                         0      0      0    0    0    0    0    0    0    0
+      [0x9B] = 0x000,    // U_WMR9B                         0      0      0    0    0    0    0    0    0    0
+      [0x9C] = 0x000,    // U_WMR9C                         0      0      0    0    0    0    0    0    0    0
+      [0x9D] = 0x000,    // U_WMR9D                         0      0      0    0    0    0    0    0    0    0
+      [0x9E] = 0x000,    // U_WMR9E                         0      0      0    0    0    0    0    0    0    0
+      [0x9F] = 0x000,    // U_WMR9F                         0      0      0    0    0    0    0    0    0    0
+      [0xA0] = 0x000,    // U_WMRA0                         0      0      0    0    0    0    0    0    0    0
+      [0xA1] = 0x000,    // U_WMRA1                         0      0      0    0    0    0    0    0    0    0
+      [0xA2] = 0x000,    // U_WMRA2                         0      0      0    0    0    0    0    0    0    0
+      [0xA3] = 0x000,    // U_WMRA3                         0      0      0    0    0    0    0    0    0    0
+      [0xA4] = 0x000,    // U_WMRA4                         0      0      0    0    0    0    0    0    0    0
+      [0xA5] = 0x000,    // U_WMRA5                         0      0      0    0    0    0    0    0    0    0
+      [0xA6] = 0x000,    // U_WMRA6                         0      0      0    0    0    0    0    0    0    0
+      [0xA7] = 0x000,    // U_WMRA7                         0      0      0    0    0    0    0    0    0    0
+      [0xA8] = 0x000,    // U_WMRA8                         0      0      0    0    0    0    0    0    0    0
+      [0xA9] = 0x000,    // U_WMRA9                         0      0      0    0    0    0    0    0    0    0
+      [0xAA] = 0x000,    // U_WMRAA                         0      0      0    0    0    0    0    0    0    0
+      [0xAB] = 0x000,    // U_WMRAB                         0      0      0    0    0    0    0    0    0    0
+      [0xAC] = 0x000,    // U_WMRAC                         0      0      0    0    0    0    0    0    0    0
+      [0xAD] = 0x000,    // U_WMRAD                         0      0      0    0    0    0    0    0    0    0
+      [0xAE] = 0x000,    // U_WMRAE                         0      0      0    0    0    0    0    0    0    0
+      [0xAF] = 0x000,    // U_WMRAF                         0      0      0    0    0    0    0    0    0    0
+      [0xB0] = 0x000,    // U_WMRB0                         0      0      0    0    0    0    0    0    0    0
+      [0xB1] = 0x000,    // U_WMRB1                         0      0      0    0    0    0    0    0    0    0
+      [0xB2] = 0x000,    // U_WMRB2                         0      0      0    0    0    0    0    0    0    0
+      [0xB3] = 0x000,    // U_WMRB3                         0      0      0    0    0    0    0    0    0    0
+      [0xB4] = 0x000,    // U_WMRB4                         0      0      0    0    0    0    0    0    0    0
+      [0xB5] = 0x000,    // U_WMRB5                         0      0      0    0    0    0    0    0    0    0
+      [0xB6] = 0x000,    // U_WMRB6                         0      0      0    0    0    0    0    0    0    0
+      [0xB7] = 0x000,    // U_WMRB7                         0      0      0    0    0    0    0    0    0    0
+      [0xB8] = 0x000,    // U_WMRB8                         0      0      0    0    0    0    0    0    0    0
+      [0xB9] = 0x000,    // U_WMRB9                         0      0      0    0    0    0    0    0    0    0
+      [0xBA] = 0x000,    // U_WMRBA                         0      0      0    0    0    0    0    0    0    0
+      [0xBB] = 0x000,    // U_WMRBB                         0      0      0    0    0    0    0    0    0    0
+      [0xBC] = 0x000,    // U_WMRBC                         0      0      0    0    0    0    0    0    0    0
+      [0xBD] = 0x000,    // U_WMRBD                         0      0      0    0    0    0    0    0    0    0
+      [0xBE] = 0x000,    // U_WMRBE                         0      0      0    0    0    0    0    0    0    0
+      [0xBF] = 0x000,    // U_WMRBF                         0      0      0    0    0    0    0    0    0    0
+      [0xC0] = 0x000,    // U_WMRC0                         0      0      0    0    0    0    0    0    0    0
+      [0xC1] = 0x000,    // U_WMRC1                         0      0      0    0    0    0    0    0    0    0
+      [0xC2] = 0x000,    // U_WMRC2                         0      0      0    0    0    0    0    0    0    0
+      [0xC3] = 0x000,    // U_WMRC3                         0      0      0    0    0    0    0    0    0    0
+      [0xC4] = 0x000,    // U_WMRC4                         0      0      0    0    0    0    0    0    0    0
+      [0xC5] = 0x000,    // U_WMRC5                         0      0      0    0    0    0    0    0    0    0
+      [0xC6] = 0x000,    // U_WMRC6                         0      0      0    0    0    0    0    0    0    0
+      [0xC7] = 0x000,    // U_WMRC7                         0      0      0    0    0    0    0    0    0    0
+      [0xC8] = 0x000,    // U_WMRC8                         0      0      0    0    0    0    0    0    0    0
+      [0xC9] = 0x000,    // U_WMRC9                         0      0      0    0    0    0    0    0    0    0
+      [0xCA] = 0x000,    // U_WMRCA                         0      0      0    0    0    0    0    0    0    0
+      [0xCB] = 0x000,    // U_WMRCB                         0      0      0    0    0    0    0    0    0    0
+      [0xCC] = 0x000,    // U_WMRCC                         0      0      0    0    0    0    0    0    0    0
+      [0xCD] = 0x000,    // U_WMRCD                         0      0      0    0    0    0    0    0    0    0
+      [0xCE] = 0x000,    // U_WMRCE                         0      0      0    0    0    0    0    0    0    0
+      [0xCF] = 0x000,    // U_WMRCF                         0      0      0    0    0    0    0    0    0    0
+      [0xD0] = 0x000,    // U_WMRD0                         0      0      0    0    0    0    0    0    0    0
+      [0xD1] = 0x000,    // U_WMRD1                         0      0      0    0    0    0    0    0    0    0
+      [0xD2] = 0x000,    // U_WMRD2                         0      0      0    0    0    0    0    0    0    0
+      [0xD3] = 0x000,    // U_WMRD3                         0      0      0    0    0    0    0    0    0    0
+      [0xD4] = 0x000,    // U_WMRD4                         0      0      0    0    0    0    0    0    0    0
+      [0xD5] = 0x000,    // U_WMRD5                         0      0      0    0    0    0    0    0    0    0
+      [0xD6] = 0x000,    // U_WMRD6                         0      0      0    0    0    0    0    0    0    0
+      [0xD7] = 0x000,    // U_WMRD7                         0      0      0    0    0    0    0    0    0    0
+      [0xD8] = 0x000,    // U_WMRD8                         0      0      0    0    0    0    0    0    0    0
+      [0xD9] = 0x000,    // U_WMRD9                         0      0      0    0    0    0    0    0    0    0
+      [0xDA] = 0x000,    // U_WMRDA                         0      0      0    0    0    0    0    0    0    0
+      [0xDB] = 0x000,    // U_WMRDB                         0      0      0    0    0    0    0    0    0    0
+      [0xDC] = 0x000,    // U_WMRDC                         0      0      0    0    0    0    0    0    0    0
+      [0xDD] = 0x000,    // U_WMRDD                         0      0      0    0    0    0    0    0    0    0
+      [0xDE] = 0x000,    // U_WMRDE                         0      0      0    0    0    0    0    0    0    0
+      [0xDF] = 0x000,    // U_WMRDF                         0      0      0    0    0    0    0    0    0    0
+      [0xE0] = 0x000,    // U_WMRE0                         0      0      0    0    0    0    0    0    0    0
+      [0xE1] = 0x000,    // U_WMRE1                         0      0      0    0    0    0    0    0    0    0
+      [0xE2] = 0x000,    // U_WMRE2                         0      0      0    0    0    0    0    0    0    0
+      [0xE3] = 0x000,    // U_WMRE3                         0      0      0    0    0    0    0    0    0    0
+      [0xE4] = 0x000,    // U_WMRE4                         0      0      0    0    0    0    0    0    0    0
+      [0xE5] = 0x000,    // U_WMRE5                         0      0      0    0    0    0    0    0    0    0
+      [0xE6] = 0x000,    // U_WMRE6                         0      0      0    0    0    0    0    0    0    0
+      [0xE7] = 0x000,    // U_WMRE7                         0      0      0    0    0    0    0    0    0    0
+      [0xE8] = 0x000,    // U_WMRE8                         0      0      0    0    0    0    0    0    0    0
+      [0xE9] = 0x000,    // U_WMRE9                         0      0      0    0    0    0    0    0    0    0
+      [0xEA] = 0x000,    // U_WMREA                         0      0      0    0    0    0    0    0    0    0
+      [0xEB] = 0x000,    // U_WMREB                         0      0      0    0    0    0    0    0    0    0
+      [0xEC] = 0x000,    // U_WMREC                         0      0      0    0    0    0    0    0    0    0
+      [0xED] = 0x000,    // U_WMRED                         0      0      0    0    0    0    0    0    0    0
+      [0xEE] = 0x000,    // U_WMREE                         0      0      0    0    0    0    0    0    0    0
+      [0xEF] = 0x000,    // U_WMREF                         0      0      0    0    0    0    0    0    0    0
+      [0xF0] = 0x020,    // U_WMRDELETEOBJECT               0      0      0    0    1    0    0    0    0    0
+      [0xF1] = 0x000,    // U_WMRF1                         0      0      0    0    0    0    0    0    0    0
+      [0xF2] = 0x000,    // U_WMRF2                         0      0      0    0    0    0    0    0    0    0
+      [0xF3] = 0x000,    // U_WMRF3                         0      0      0    0    0    0    0    0    0    0
+      [0xF4] = 0x000,    // U_WMRF4                         0      0      0    0    0    0    0    0    0    0
+      [0xF5] = 0x000,    // U_WMRF5                         0      0      0    0    0    0    0    0    0    0
+      [0xF6] = 0x000,    // U_WMRF6                         0      0      0    0    0    0    0    0    0    0
+      [0xF7] = 0x120,    // U_WMRCREATEPALETTE              0      1      0    0    1    0    0    0    0    0 Not selected yet, so no change in drawing conditions
+      [0xF8] = 0x120,    // U_WMRCREATEBRUSH                0      1      0    0    1    0    0    0    0    0 "
+      [0xF9] = 0x120,    // U_WMRCREATEPATTERNBRUSH         0      1      0    0    1    0    0    0    0    0 "
+      [0xFA] = 0x120,    // U_WMRCREATEPENINDIRECT          0      1      0    0    1    0    0    0    0    0 "
+      [0xFB] = 0x120,    // U_WMRCREATEFONTINDIRECT         0      1      0    0    1    0    0    0    0    0 "
+      [0xFC] = 0x120,    // U_WMRCREATEBRUSHINDIRECT        0      1      0    0    1    0    0    0    0    0 "
+      [0xFD] = 0x020,    // U_WMRCREATEBITMAPINDIRECT       0      0      0    0    1    0    0    0    0    0 "
+      [0xFE] = 0x020,    // U_WMRCREATEBITMAP               0      0      0    0    1    0    0    0    0    0 "
+      [0xFF] = 0x120,    // U_WMRCREATEREGION               0      1      0    0    1    0    0    0    0    0 "
+   };
+   if(type<=U_WMR_MAX)return(table[type]); // type is uint so always >=0, no need to test U_WMR_MIN, which is 0.
+   return(U_WMR_INVALID);  // out of range, including U_WMR_INVALID
 }
 
 /* **********************************************************************************************
@@ -1470,7 +1472,7 @@ char *wmr_dup(
     \return 0 for success, >=0 for failure.
     \param name  WMF filename (will be opened)
     \param initsize Initialize WMF in memory to hold this many bytes
-    \param chunksize When needed increase WMF in memory by this number of bytes
+    \param chunksize When needed increase WMF in memory by at least this number of bytes
     \param wt WMF in memory
     
     
@@ -1508,11 +1510,35 @@ int  wmf_start(
    wtl->chunk      =  chunksize;
    wtl->largest    =  0;            /* only used by WMF */
    wtl->sumObjects =  0;            /* only used by WMF */
+   wtl->stream     =  0;
+   wtl->reallocs   =  0;
+   wtl->copied     =  0;
    (void) wmf_highwater(U_HIGHWATER_CLEAR);
    *wt=wtl;
    return(0);
 }
 
+/**
+    \brief Start constructing a wmf which is written to the file as records are appended, rather
+    than being held in memory until wmf_finish().  Only the header is kept in memory.  
+    wmf_finish() seeks back to the start of the file and rewrites the header, so the file must be seekable.
+    Use wmf_header_append(), wmf_append(), wmf_finish(), and wmf_free() exactly as for wmf_start().
+    \return 0 for success, >=0 for failure.
+    \param name  WMF filename (will be opened)
+    \param initsize Initial size of the buffer used for the header (and on Big Endian machines for byte swapping records)
+    \param wt WMF in memory
+*/
+int  wmf_start_stream(
+      const char       *name,
+      const uint32_t   initsize,
+      WMFTRACK       **wt
+   ){
+   int status;
+   status = wmf_start(name, initsize, initsize, wt);
+   if(!status){ (*wt)->stream = 1; }
+   return(status);
+}
+
 /**
     \brief Release memory for an wmf structure in memory. Call this after wmf_finish().
     \return 0 on success, >=1 on failure
@@ -1544,8 +1570,10 @@ int  wmf_finish(
    int off;
    uint32_t tmp;
    uint16_t tmp16;
+   size_t length;
 
    if(!wt->fp)return(1);   // This could happen if something stomps on memory, otherwise should be caught in wmf_start
+   if(wt->stream && !wt->used)return(4);  // no header was ever written
 
    // Set the header fields which were unknown up until this point
   
@@ -1562,14 +1590,26 @@ int  wmf_finish(
    if(maxobj > UINT16_MAX)return(3);
    tmp16 = maxobj;
    memcpy(record + offsetof(U_WMRHEADER,nObjects), &tmp16, 2);   /*  Total number of brushes, pens, and other graphics objects defined in this file */
+   /* The placeable header Checksum does not cover these fields, so it need not be recalculated. */
   
+   if(wt->stream){
+      /* only the header is in memory, the records are already in the file */
+      length = off + U_SIZE_WMRHEADER;
+#if U_BYTE_SWAP
+      //This is a Big Endian machine, WMF data must be  Little Endian
+      (void) wmfheader_swap(wt->buf,1);  // BE to LE, header only
+#endif
+   }
+   else {
+      length = wt->used;
 #if U_BYTE_SWAP
-    //This is a Big Endian machine, WMF data must be  Little Endian
-    U_wmf_endian(wt->buf,wt->used,1,0);  // BE to LE, entire file
+      //This is a Big Endian machine, WMF data must be  Little Endian
+      U_wmf_endian(wt->buf,wt->used,1,0);  // BE to LE, entire file
 #endif
+   }
 
-   (void) U_wmr_properties(U_WMR_INVALID);     /* force the release of the lookup table memory, returned value is irrelevant */
-   if(1 != fwrite(wt->buf,wt->used,1,wt->fp))return(2);
+   if(wt->stream && fseek(wt->fp, 0, SEEK_SET))return(5);
+   if(1 != fwrite(wt->buf,length,1,wt->fp))return(2);
    (void) fclose(wt->fp);
    wt->fp=NULL;
    return(0);
@@ -1620,8 +1660,98 @@ int wmf_readdata(
     return(status);
 }
 
+/**
+    \brief Map the contents of an WMF file by name into memory, without copying it.
+    
+    Same as emf_mapdata(), except that on a Big Endian machine U_wmf_endian() is applied to the
+    (copy on write) mapping.
+    \return 0 on success, >=1 on failure
+    \param filename Name of file to open, including the path
+    \param contents Contents of the file.  Must be released with wmf_unmapdata(), NOT free().
+    \param length   Number of bytes in Contents
+*/
+int wmf_mapdata(
+      const char   *filename,
+      char        **contents,
+      size_t       *length
+   ){    
+#ifdef WIN32
+   return(wmf_readdata(filename, contents, length));
+#else
+   int          fd;
+   struct stat  sb;
+   void        *map;
+   int          status=0;
+
+   *contents=NULL;
+   *length=0;
+   fd=open(filename,O_RDONLY);
+   if(fd == -1){ status = 1; }
+   else {
+      if(fstat(fd, &sb) || sb.st_size <= 0){
+         status = 2;
+      }
+      else {
+#if U_BYTE_SWAP
+         map = mmap(NULL, sb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+#else
+         map = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+#endif
+         if(map == MAP_FAILED){
+            status = 3;
+         }
+         else {
+            *contents = (char *) map;
+            *length   = sb.st_size;
+#if U_BYTE_SWAP
+            //This is a Big Endian machine, WMF data is Little Endian
+            U_wmf_endian(*contents,*length,0,0);  // LE to BE, entire file
+#endif
+         }
+      }
+      close(fd);
+   }
+   return(status);
+#endif
+}
+
+//! \cond
+/*  Set the size of buf in a WMFTRACK, keeping the statistics.  On failure buf is unchanged. */
+static int wmf_buf_resize(
+      WMFTRACK        *wt,
+      size_t           newsize
+   ){
+   char *newbuf;
+   newbuf = realloc(wt->buf,newsize);
+   if(!newbuf)return(3);
+   wt->buf        = newbuf;
+   wt->allocated  = newsize;
+   wt->reallocs++;
+   wt->copied    += (wt->stream ? 0 : wt->used);  // streaming: buf holds only the header, which is small
+   return(0);
+}
+//! \endcond
+
+/**
+    \brief Make room in a wmf in memory for at least size more bytes, so that appending that much
+    will not reallocate buf memory.  Growth in wmf_append() is geometric, as described for emf_reserve().
+    \return 0 for success, >=1 for failure.
+    \param wt      WMF in memory
+    \param size    Number of bytes which will be appended
+*/
+int  wmf_reserve(
+      WMFTRACK        *wt,
+      size_t           size
+   ){
+   if(!wt)return(2);
+   if(wt->stream)return(0);    // nothing accumulates in memory
+   if(wt->used + size <= wt->allocated)return(0);
+   return(wmf_buf_resize(wt, wt->used + size));
+}
+
 /**
     \brief Append an WMF record to a wmf in memory. This may reallocate buf memory.
+    If the wmf was started with wmf_start_stream() the record is written to the file immediately.
     \return 0 for success, >=1 for failure.
     \param rec     Record to append to WMF in memory
     \param wt      WMF in memory
@@ -1635,6 +1765,9 @@ int  wmf_append(
    size_t deficit;
    uint32_t wp;
    uint32_t size;
+#if U_BYTE_SWAP
+   size_t hsize;
+#endif
    
    size = U_wmr_size(rec);
 #ifdef U_VALGRIND
@@ -1644,14 +1777,28 @@ int  wmf_append(
 #endif
    if(!rec)return(1);
    if(!wt)return(2);
-   if(size + wt->used > wt->allocated){
-      deficit = size + wt->used - wt->allocated;
-      if(deficit < wt->chunk)deficit = wt->chunk;
-      wt->allocated += deficit;
-      wt->buf = realloc(wt->buf,wt->allocated);
-      if(!wt->buf)return(3);
+   if(wt->stream){
+#if U_BYTE_SWAP
+      /* This is a Big Endian machine, WMF data must be  Little Endian.  Swap a copy, which follows the header 
+         in buf, because rec may belong to the caller. */
+      hsize = (((U_WMRPLACEABLE *) wt->buf)->Key == 0x9AC6CDD7 ? U_SIZE_WMRHEADER + U_SIZE_WMRPLACEABLE: U_SIZE_WMRHEADER);
+      if(hsize + size > wt->allocated && wmf_buf_resize(wt, hsize + size))return(3);
+      memcpy(wt->buf + hsize, rec, size);
+      (void) U_wmf_endian(wt->buf + hsize, size, 1, 1);  // BE to LE, one record
+      if(1 != fwrite(wt->buf + hsize, size, 1, wt->fp))return(4);
+#else
+      if(1 != fwrite(rec, size, 1, wt->fp))return(4);
+#endif
+   }
+   else {
+      if(size + wt->used > wt->allocated){
+         deficit = size + wt->used - wt->allocated;
+         if(deficit < wt->chunk)deficit = wt->chunk;
+         if(deficit < wt->allocated/2)deficit = wt->allocated/2;  // geometric growth
+         if(wmf_buf_resize(wt, wt->allocated + deficit))return(3);
+      }
+      memcpy(wt->buf + wt->used, rec, size);
    }
-   memcpy(wt->buf + wt->used, rec, size);
    wt->used += size;
    wt->records++;
    if(wt->largest < size)wt->largest=size;
@@ -1688,14 +1835,23 @@ int  wmf_header_append(
 #endif
    if(!rec)return(1);
    if(!wt)return(2);
-   if(U_wmr_size(rec) + wt->used > wt->allocated){
+   if(hsize + wt->used > wt->allocated){
       deficit = hsize + wt->used - wt->allocated;
       if(deficit < wt->chunk)deficit = wt->chunk;
-      wt->allocated += deficit;
-      wt->buf = realloc(wt->buf,wt->allocated);
-      if(!wt->buf)return(3);
+      if(wmf_buf_resize(wt, wt->allocated + deficit))return(3);
    }
    memcpy(wt->buf + wt->used, rec, hsize);
+   if(wt->stream){  /* write a placeholder, wmf_finish() rewrites the header with the final values */
+#if U_BYTE_SWAP
+      //This is a Big Endian machine, WMF data must be  Little Endian
+      if(2*hsize > wt->allocated && wmf_buf_resize(wt, 2*hsize))return(3);
+      memcpy(wt->buf + hsize, rec, hsize);
+      (void) wmfheader_swap(wt->buf + hsize,1);  // BE to LE, header only
+      if(1 != fwrite(wt->buf + hsize, hsize, 1, wt->fp))return(4);
+#else
+      if(1 != fwrite(rec, hsize, 1, wt->fp))return(4);
+#endif
+   }
    wt->used += hsize;
    /* do NOT increment records count, this is not strictly a record */
    if(wt->largest < hsize)wt->largest=hsize;
@@ -1840,6 +1996,48 @@ int wmf_htable_free(
    return(0);
 }
 
+/**
+    \brief Update an object table for one WMF record.
+    
+    Call this for each record following the header, in order, while reading a WMF file.  Records which create
+    a pen, brush, font, palette, or region define the object in the lowest free handle, U_WMR_DELETEOBJECT deletes
+    it, and all other records are ignored.  A U_WMR_SELECTOBJECT (or any other record holding an object index) may
+    then be resolved with U_objtable_get().
+    \return 0 for success, >=1 for failure.
+    \param ot     object table
+    \param record WMF record
+    \param offset offset of the record in the file
+*/
+int wmf_objtable_record(
+      U_OBJTABLE  *ot,
+      const char  *record,
+      uint32_t     offset
+   ){
+   uint32_t  type, ih;
+   uint16_t  Object;
+
+   if(!ot || !record)return(1);
+   type = U_WMRTYPE(record);
+   switch(type){
+      case U_WMR_CREATEPALETTE:
+      case U_WMR_CREATEPATTERNBRUSH:
+      case U_WMR_CREATEPENINDIRECT:
+      case U_WMR_CREATEFONTINDIRECT:
+      case U_WMR_CREATEBRUSHINDIRECT:
+      case U_WMR_CREATEREGION:
+      case U_WMR_DIBCREATEPATTERNBRUSH:
+         if(U_objtable_insert(ot, type, record, offset, &ih))return(2);
+         break;
+      case U_WMR_DELETEOBJECT:
+         if(!U_WMRDELETEOBJECT_get(record, &Object))return(3);
+         if(U_objtable_delete(ot, Object))return(4);
+         break;
+      default:
+         break;
+   }
+   return(0);
+}
+
 
 /* **********************************************************************************************
 These functions create standard structures used in the WMR records.
@@ -4789,9 +4987,11 @@ void U_BITMAPINFOHEADER_get(
     
     \return BI_Compression Enumeration.  For anything other than U_BI_RGB values other than px may not be valid.
     \param dib         pointer to the start of the DIB in the record
-    \param px          pointer to DIB pixel array
+    \param px          pointer to DIB pixel array.  For RLE8 and RLE4 this is the RLE data, which follows the color
+                       table (earlier versions left px pointing at the color table for these)
     \param ct          pointer to DIB color table
-    \param numCt       DIB color table number of entries, for PNG or JPG returns the number of bytes in the image
+    \param numCt       DIB color table number of entries, for PNG, JPG, RLE8, or RLE4 returns the number of bytes in the image
+                       (for RLE8 and RLE4 ct is also set, get_real_color_count() gives its number of entries)
     \param width       Width of pixel array
     \param height      Height of pixel array (always returned as a positive number)
     \param colortype   DIB BitCount Enumeration
@@ -4835,6 +5035,11 @@ int wget_DIB_params(
       }
       else {      *ct = NULL;                                            }
    }
+   else if(bic == U_BI_RLE8 || bic == U_BI_RLE4){  // color table as for U_BI_RGB, see RLE_to_RGBA()
+      *ct  = (U_RGBQUAD *) (dib + U_SIZE_BITMAPINFOHEADER); 
+      *px += U_SIZE_COLORREF * get_real_color_count(dib);
+      memcpy(numCt,  dib + offsetof(U_BITMAPINFOHEADER,biSizeImage),    4);
+   }
    else {
       memcpy(numCt,  dib + offsetof(U_BITMAPINFOHEADER,biSizeImage),    4);
       *ct        = NULL;
@@ -4842,6 +5047,29 @@ int wget_DIB_params(
    return(bic);
 }
 
+/**
+    \brief Assume a packed DIB and describe the image in it without decoding it, see image_desc_dib().
+    
+    \return 0 on success, other values on errors.
+    \param dib         pointer to the start of the DIB in the record
+    \param id          receives the description, which points into the record
+*/
+int wget_DIB_desc(
+       const char   *dib,
+       U_IMAGEDESC  *id
+   ){
+   const char       *px;
+   const U_RGBQUAD  *ct;
+   uint32_t          numCt;
+   int32_t           width, height, colortype, invert;
+   if(!dib){
+      if(id)memset(id, 0, sizeof(U_IMAGEDESC));
+      return(1);
+   }
+   (void) wget_DIB_params(dib, &px, &ct, &numCt, &width, &height, &colortype, &invert);  // for px
+   return(image_desc_dib(dib, px, 0, id));
+}
+
 
 
 /* **********************************************************************************************